@@ -147,6 +147,22 @@ public:
     Impl::Store(&this->m_Object, static_cast<typename Impl::ValueType>(val));
   }
 
+  /** Atomically replace the value by desired if it equals expected.
+   * Returns true on success; otherwise expected is updated to the
+   * current value and false is returned. */
+  bool compare_exchange_strong(T & expected, T desired)
+  {
+    const T current = static_cast<T>(Impl::CompareAndSwap(&this->m_Object,
+      static_cast<typename Impl::ValueType>(expected),
+      static_cast<typename Impl::ValueType>(desired)));
+    if( current == expected )
+      {
+      return true;
+      }
+    expected = current;
+    return false;
+  }
+
 private:
   typename Impl::AtomicType m_Object;
 };
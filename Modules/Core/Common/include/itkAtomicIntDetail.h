@@ -105,14 +105,24 @@ public:
     return __sync_fetch_and_sub(ref, 1);
   }
 
+  static ValueType CompareAndSwap(ValueType *ref, ValueType expected, ValueType desired)
+  {
+    return __sync_val_compare_and_swap(ref, expected, desired);
+  }
+
+  // The fences on both sides keep the compiler from moving ordinary
+  // memory accesses across the volatile access.
   static ValueType Load(const ValueType *ref)
   {
     __sync_synchronize();
-    return *static_cast<const volatile ValueType *>(ref);
+    const ValueType val = *static_cast<const volatile ValueType *>(ref);
+    __sync_synchronize();
+    return val;
   }
 
   static void Store(ValueType *ref, ValueType val)
   {
+    __sync_synchronize();
     *static_cast<volatile ValueType*>(ref) = val;
     __sync_synchronize();
   }
@@ -165,6 +175,23 @@ public:
     return ++val;
   }
 
+  static int64_t CompareAndSwap(int64_t *ref, int64_t expected, int64_t desired)
+  {
+    // Retry until either the swap succeeds or the value observed differs
+    // from the expected one, so that the returned value is the one that
+    // made the swap fail.
+    while( !OSAtomicCompareAndSwap64Barrier(expected, desired, ref) )
+      {
+      OSMemoryBarrier();
+      const int64_t current = *static_cast<const volatile int64_t*>(ref);
+      if( current != expected )
+        {
+        return current;
+        }
+      }
+    return expected;
+  }
+
   static int64_t Load(const int64_t *ref);
   {
     OSMemoryBarrier();
@@ -204,6 +231,7 @@ public:
   static int64_t PreDecrement(AtomicType *ref);
   static int64_t PostIncrement(AtomicType *ref);
   static int64_t PostDecrement(AtomicType *ref);
+  static int64_t CompareAndSwap(AtomicType *ref, int64_t expected, int64_t desired);
   static int64_t Load(const AtomicType *ref);
   static void Store(AtomicType *ref, int64_t val);
 };
@@ -255,6 +283,23 @@ public:
     return ++val;
   }
 
+  static int32_t CompareAndSwap(int32_t *ref, int32_t expected, int32_t desired)
+  {
+    // Retry until either the swap succeeds or the value observed differs
+    // from the expected one, so that the returned value is the one that
+    // made the swap fail.
+    while( !OSAtomicCompareAndSwap32Barrier(expected, desired, ref) )
+      {
+      OSMemoryBarrier();
+      const int32_t current = *static_cast<const volatile int32_t*>(ref);
+      if( current != expected )
+        {
+        return current;
+        }
+      }
+    return expected;
+  }
+
   static int32_t Load(const int32_t *ref);
   {
     OSMemoryBarrier();
@@ -293,6 +338,7 @@ public:
   static int32_t PreDecrement(AtomicType *ref);
   static int32_t PostIncrement(AtomicType *ref);
   static int32_t PostDecrement(AtomicType *ref);
+  static int32_t CompareAndSwap(AtomicType *ref, int32_t expected, int32_t desired);
   static int32_t Load(const AtomicType *ref);
   static void Store(AtomicType *ref, int32_t val);
 };
@@ -23,6 +23,7 @@
 #include "itkBSplineKernelFunction.h"
 #include "itkArray.h"
 #include "itkArray2D.h"
+#include "itkMatrix.h"
 
 namespace itk
 {
@@ -76,6 +77,10 @@ public:
   /** OutputType typedef support. */
   typedef Array< double > WeightsType;
 
+  /** Weights of each dimension, whose tensor product gives the weights
+   * over the support region. */
+  typedef Matrix< double, VSpaceDimension, VSplineOrder + 1 > SeparableWeightsType;
+
   /** Index and size typedef support. */
   typedef Index< VSpaceDimension > IndexType;
   typedef Size< VSpaceDimension >  SizeType;
@@ -98,6 +103,17 @@ public:
   virtual void Evaluate(const ContinuousIndexType & index,
                         WeightsType & weights, IndexType & startIndex) const;
 
+  /** Evaluate the weights of each dimension at specified ContinousIndex
+   * position. The weight of the support region offset (k_0, ..., k_n) is
+   * the product of the weights[j][k_j]. This is (SplineOrder + 1) *
+   * SpaceDimension values instead of (SplineOrder + 1)^(SpaceDimension),
+   * for the callers which store the weights of many positions.
+   * On return, startIndex contains the start index of the
+   * support region over which the weights are defined.
+   */
+  void EvaluateSeparableWeights(const ContinuousIndexType & index,
+                                SeparableWeightsType & weights, IndexType & startIndex) const;
+
   /** Get support region size. */
   itkGetConstMacro(SupportSize, SizeType);
 
@@ -20,7 +20,6 @@
 
 #include "itkBSplineInterpolationWeightFunction.h"
 #include "itkImage.h"
-#include "itkMatrix.h"
 #include "itkMath.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 
@@ -113,34 +112,47 @@ void BSplineInterpolationWeightFunction< TCoordRep, VSpaceDimension,
 {
   unsigned int j, k;
 
+  SeparableWeightsType weights1D;
+  this->EvaluateSeparableWeights(index, weights1D, startIndex);
+
+  for ( k = 0; k < m_NumberOfWeights; k++ )
+    {
+    weights[k] = 1.0;
+
+    for ( j = 0; j < SpaceDimension; j++ )
+      {
+      weights[k] *= weights1D[j][m_OffsetToIndexTable[k][j]];
+      }
+    }
+}
+
+/** Compute the weights of each dimension at continuous index position */
+template< typename TCoordRep, unsigned int VSpaceDimension,
+          unsigned int VSplineOrder >
+void BSplineInterpolationWeightFunction< TCoordRep, VSpaceDimension,
+                                         VSplineOrder >
+::EvaluateSeparableWeights(
+  const ContinuousIndexType & index,
+  SeparableWeightsType & weights,
+  IndexType & startIndex) const
+{
   // Find the starting index of the support region
-  for ( j = 0; j < SpaceDimension; j++ )
+  for ( unsigned int j = 0; j < SpaceDimension; j++ )
     {
     startIndex[j] = Math::Floor< IndexValueType >(index[j] - static_cast< double >( SplineOrder - 1 ) / 2.0);
     }
 
   // Compute the weights
-  Matrix< double, SpaceDimension, SplineOrder + 1 > weights1D;
-  for ( j = 0; j < SpaceDimension; j++ )
+  for ( unsigned int j = 0; j < SpaceDimension; j++ )
     {
     double x = index[j] - static_cast< double >( startIndex[j] );
 
-    for ( k = 0; k <= SplineOrder; k++ )
+    for ( unsigned int k = 0; k <= SplineOrder; k++ )
       {
-      weights1D[j][k] = m_Kernel->Evaluate(x);
+      weights[j][k] = m_Kernel->Evaluate(x);
       x -= 1.0;
       }
     }
-
-  for ( k = 0; k < m_NumberOfWeights; k++ )
-    {
-    weights[k] = 1.0;
-
-    for ( j = 0; j < SpaceDimension; j++ )
-      {
-      weights[k] *= weights1D[j][m_OffsetToIndexTable[k][j]];
-      }
-    }
 }
 } // end namespace itk
 
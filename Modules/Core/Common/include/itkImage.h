@@ -242,6 +242,16 @@ public:
    * DataObject to be modified. */
   void SetPixelContainer(PixelContainer *container);
 
+  /** Set the allocator of the pixel container used by the next calls
+   * to Allocate(). */
+  virtual void SetPixelBufferAllocator(PixelBufferAllocator *allocator) ITK_OVERRIDE
+  {
+    if ( m_Buffer )
+      {
+      m_Buffer->SetPixelBufferAllocator(allocator);
+      }
+  }
+
   /** Graft the data and information from one image to another. This
    * is a convenience method to setup a second image with all the meta
    * information of another image and use the same pixel
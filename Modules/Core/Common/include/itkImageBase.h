@@ -37,6 +37,7 @@
 #include "itkFixedArray.h"
 #include "itkImageHelper.h"
 #include "itkFloatTypes.h"
+#include "itkPixelBufferAllocator.h"
 
 //HACK:  vnl/vnl_matrix_fixed.txx is needed here?
 //      to avoid undefined symbol vnl_matrix_fixed<double, 8u, 8u>::set_identity()", referenced from
@@ -236,6 +237,13 @@ public:
    */
   virtual void Allocate(bool initialize=false);
 
+  /** Set the allocator of the pixel buffer used by the next calls to
+   * Allocate(). ImageSource::AllocateOutputs() calls it with the
+   * allocator of the filter, if any. Images without a pixel buffer
+   * ignore it.
+   * \sa PixelBufferAllocator */
+  virtual void SetPixelBufferAllocator(PixelBufferAllocator *itkNotUsed(allocator)) {}
+
   /** Set the region object that defines the size and starting index
    * for the largest possible region this image could represent.  This
    * is used in determining how much memory would be needed to load an
@@ -213,10 +213,41 @@ public:
   virtual ProcessObject::DataObjectPointer MakeOutput(ProcessObject::DataObjectPointerArraySizeType idx) ITK_OVERRIDE;
   virtual ProcessObject::DataObjectPointer MakeOutput(const ProcessObject::DataObjectIdentifierType &) ITK_OVERRIDE;
 
+  /** Set/Get the number of pieces the requested region is split into for
+   * each thread. With a value larger than one, the MultiThreader
+   * schedules the pieces with work stealing, so that threads which
+   * finish early take over pieces from threads slowed down by costly
+   * parts of the image. ThreadedGenerateData() is then called once per
+   * piece, possibly several times with the same threadId, which only
+   * filters reporting GetSupportsWorkStealing() allow; other filters
+   * ignore this setting. Defaults to 1. */
+  itkSetClampMacro(NumberOfWorkUnitsPerThread, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfWorkUnitsPerThread, unsigned int);
+
+  /** Whether ThreadedGenerateData() may be called for several pieces
+   * of the output with the same threadId. */
+  itkGetConstMacro(SupportsWorkStealing, bool);
+
+  /** Set/Get the allocator of the pixel buffers of the outputs, used
+   * by AllocateOutputs(). Filters of iterative pipelines can use a
+   * PoolPixelBufferAllocator to recycle the buffers released at each
+   * execution. When none is set, the default, the outputs use
+   * PixelBufferAllocator::GetGlobalDefault().
+   * \sa PixelBufferAllocator */
+  itkSetObjectMacro(PixelBufferAllocator, PixelBufferAllocator);
+  itkGetModifiableObjectMacro(PixelBufferAllocator, PixelBufferAllocator);
+
 protected:
   ImageSource();
   virtual ~ImageSource() {}
 
+  /** Subclasses whose ThreadedGenerateData() keeps no per-thread state
+   * across calls enable this in their constructor so that
+   * NumberOfWorkUnitsPerThread is honored. */
+  itkSetMacro(SupportsWorkStealing, bool);
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
   /** A version of GenerateData() specific for image processing
    * filters.  This implementation will split the processing across
    * multiple threads. The buffer is allocated by this method. Then
@@ -343,6 +374,11 @@ protected:
 private:
   ImageSource(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
+
+  unsigned int m_NumberOfWorkUnitsPerThread;
+  bool         m_SupportsWorkStealing;
+
+  PixelBufferAllocator::Pointer m_PixelBufferAllocator;
 };
 } // end namespace itk
 
@@ -41,7 +41,9 @@ namespace itk
  */
 template< typename TOutputImage >
 ImageSource< TOutputImage >
-::ImageSource()
+::ImageSource() :
+  m_NumberOfWorkUnitsPerThread(1),
+  m_SupportsWorkStealing(false)
 {
   // Create the output. We use static_cast<> here because we know the default
   // output must be of type TOutputImage
@@ -217,6 +219,10 @@ ImageSource< TOutputImage >
 
     if ( outputPtr )
       {
+      if ( m_PixelBufferAllocator )
+        {
+        outputPtr->SetPixelBufferAllocator( m_PixelBufferAllocator );
+        }
       outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
       outputPtr->Allocate();
       }
@@ -250,6 +256,15 @@ ImageSource< TOutputImage >
   this->GetMultiThreader()->SetNumberOfThreads( validThreads );
   this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
 
+  // Over-decompose the requested region so that idle threads can steal
+  // pieces from busy ones
+  if ( m_SupportsWorkStealing && m_NumberOfWorkUnitsPerThread > 1 )
+    {
+    const unsigned int validWorkUnits =
+      splitter->GetNumberOfSplits( outputPtr->GetRequestedRegion(), validThreads * m_NumberOfWorkUnitsPerThread );
+    this->GetMultiThreader()->SetNumberOfWorkUnits( validWorkUnits );
+    }
+
   // multithread the execution
   this->GetMultiThreader()->SingleMethodExecute();
 
@@ -280,6 +295,19 @@ ImageSource< TOutputImage >
   throw e_;
 }
 
+//----------------------------------------------------------------------------
+template< typename TOutputImage >
+void
+ImageSource< TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfWorkUnitsPerThread: " << m_NumberOfWorkUnitsPerThread << std::endl;
+  os << indent << "SupportsWorkStealing: " << m_SupportsWorkStealing << std::endl;
+  itkPrintSelfObjectMacro( PixelBufferAllocator );
+}
+
 // Callback routine used by the threading library. This routine just calls
 // the ThreadedGenerateData method after setting the correct region for this
 // thread.
@@ -289,20 +317,22 @@ ImageSource< TOutputImage >
 ::ThreaderCallback(void *arg)
 {
   ThreadStruct *str;
-  ThreadIdType  total, threadId, threadCount;
+  ThreadIdType  total, threadId, workUnitId, workUnitCount;
 
   threadId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
-  threadCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfThreads;
+  workUnitId = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->WorkUnitID;
+  workUnitCount = ( (MultiThreader::ThreadInfoStruct *)( arg ) )->NumberOfWorkUnits;
 
   str = (ThreadStruct *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
 
   // execute the actual method with appropriate output region
   // first find out how many pieces extent can be split into.
+  // Without work stealing there is one piece per thread.
   typename TOutputImage::RegionType splitRegion;
-  total = str->Filter->SplitRequestedRegion(threadId, threadCount,
+  total = str->Filter->SplitRequestedRegion(workUnitId, workUnitCount,
                                             splitRegion);
 
-  if ( threadId < total )
+  if ( workUnitId < total )
     {
     str->Filter->ThreadedGenerateData(splitRegion, threadId);
     }
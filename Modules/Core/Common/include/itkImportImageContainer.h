@@ -20,6 +20,7 @@
 
 #include "itkObject.h"
 #include "itkObjectFactory.h"
+#include "itkPixelBufferAllocator.h"
 #include <utility>
 
 namespace itk
@@ -135,6 +136,14 @@ public:
   itkGetConstMacro(ContainerManageMemory, bool);
   itkBooleanMacro(ContainerManageMemory);
 
+  /** Set/Get the allocator of the memory of the elements. It applies to
+   * the next allocations: the current elements are released with the
+   * allocator that allocated them. Without allocator the elements are
+   * allocated with new[]. Defaults to
+   * PixelBufferAllocator::GetGlobalDefault(). */
+  itkSetObjectMacro(PixelBufferAllocator, PixelBufferAllocator);
+  itkGetModifiableObjectMacro(PixelBufferAllocator, PixelBufferAllocator);
+
 protected:
   ImportImageContainer();
   virtual ~ImportImageContainer();
@@ -183,6 +192,10 @@ private:
   TElementIdentifier m_Size;
   TElementIdentifier m_Capacity;
   bool               m_ContainerManageMemory;
+
+  PixelBufferAllocator::Pointer m_PixelBufferAllocator;
+  // allocator of m_ImportPointer, if the container manages its memory
+  PixelBufferAllocator::Pointer m_ElementsAllocator;
 };
 } // end namespace itk
 
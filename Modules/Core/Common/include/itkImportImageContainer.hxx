@@ -29,6 +29,7 @@
 #define itkImportImageContainer_hxx
 
 #include "itkImportImageContainer.h"
+#include <new>
 
 namespace itk
 {
@@ -40,6 +41,7 @@ ImportImageContainer< TElementIdentifier, TElement >
   m_ContainerManageMemory = true;
   m_Capacity = 0;
   m_Size = 0;
+  m_PixelBufferAllocator = PixelBufferAllocator::GetGlobalDefault();
 }
 
 template< typename TElementIdentifier, typename TElement >
@@ -74,6 +76,7 @@ ImportImageContainer< TElementIdentifier, TElement >
       DeallocateManagedMemory();
 
       m_ImportPointer = temp;
+      m_ElementsAllocator = m_PixelBufferAllocator;
       m_ContainerManageMemory = true;
       m_Capacity = size;
       m_Size = size;
@@ -88,6 +91,7 @@ ImportImageContainer< TElementIdentifier, TElement >
   else
     {
     m_ImportPointer = this->AllocateElements(size, UseDefaultConstructor);
+    m_ElementsAllocator = m_PixelBufferAllocator;
     m_Capacity = size;
     m_Size = size;
     m_ContainerManageMemory = true;
@@ -117,6 +121,7 @@ ImportImageContainer< TElementIdentifier, TElement >
       DeallocateManagedMemory();
 
       m_ImportPointer = temp;
+      m_ElementsAllocator = m_PixelBufferAllocator;
       m_ContainerManageMemory = true;
       m_Capacity = size;
       m_Size = size;
@@ -175,6 +180,25 @@ TElement *ImportImageContainer< TElementIdentifier, TElement >
   // Encapsulate all image memory allocation here to throw an
   // exception when memory allocation fails even when the compiler
   // does not do this by default.
+  if ( m_PixelBufferAllocator )
+    {
+    // the allocator throws when it fails
+    TElement *data = static_cast< TElement * >(
+      m_PixelBufferAllocator->Allocate( static_cast< SizeValueType >( size ) * sizeof( TElement ) ) );
+    for ( ElementIdentifier i = 0; i < size; ++i )
+      {
+      if ( UseDefaultConstructor )
+        {
+        new ( data + i ) TElement(); //POD types initialized to 0, others use default constructor.
+        }
+      else
+        {
+        new ( data + i ) TElement; //Faster but uninitialized
+        }
+      }
+    return data;
+    }
+
   TElement *data;
 
   try
@@ -210,8 +234,21 @@ void ImportImageContainer< TElementIdentifier, TElement >
   // Encapsulate all image memory deallocation here
   if ( m_ContainerManageMemory )
     {
-    delete[] m_ImportPointer;
+    if ( m_ElementsAllocator )
+      {
+      for ( ElementIdentifier i = 0; i < m_Capacity; ++i )
+        {
+        m_ImportPointer[i].~TElement();
+        }
+      m_ElementsAllocator->Deallocate( m_ImportPointer,
+                                       static_cast< SizeValueType >( m_Capacity ) * sizeof( TElement ) );
+      }
+    else
+      {
+      delete[] m_ImportPointer;
+      }
     }
+  m_ElementsAllocator = ITK_NULLPTR;
   m_ImportPointer = ITK_NULLPTR;
   m_Capacity = 0;
   m_Size = 0;
@@ -229,6 +266,15 @@ ImportImageContainer< TElementIdentifier, TElement >
      << ( m_ContainerManageMemory ? "true" : "false" ) << std::endl;
   os << indent << "Size: " << m_Size << std::endl;
   os << indent << "Capacity: " << m_Capacity << std::endl;
+  os << indent << "PixelBufferAllocator: ";
+  if ( m_PixelBufferAllocator.IsNotNull() )
+    {
+    os << m_PixelBufferAllocator->GetNameOfClass() << " (" << m_PixelBufferAllocator.GetPointer() << ")" << std::endl;
+    }
+  else
+    {
+    os << "(none)" << std::endl;
+    }
 }
 } // end namespace itk
 
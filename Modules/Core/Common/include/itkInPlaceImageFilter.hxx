@@ -135,6 +135,10 @@ InPlaceImageFilter< TInputImage, TOutputImage >
 
       if ( nthOutputPtr )
         {
+        if ( this->GetPixelBufferAllocator() )
+          {
+          nthOutputPtr->SetPixelBufferAllocator( this->GetModifiablePixelBufferAllocator() );
+          }
         nthOutputPtr->SetBufferedRegion( nthOutputPtr->GetRequestedRegion() );
         nthOutputPtr->Allocate();
         }
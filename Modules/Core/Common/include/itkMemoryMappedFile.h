@@ -0,0 +1,121 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMemoryMappedFile_h
+#define itkMemoryMappedFile_h
+
+#include "itkLightObject.h"
+#include "itkObjectFactory.h"
+#include "itkIntTypes.h"
+#include <string>
+
+namespace itk
+{
+/** \class MemoryMappedFile
+ * \brief Portable read-only or copy-on-write mapping of a file in memory.
+ *
+ * MemoryMappedFile maps a range of bytes of a file in the address space
+ * of the process, with mmap on POSIX systems and MapViewOfFile on
+ * Windows. The pages are loaded by the operating system when they are
+ * first accessed, so mapping a file is cheap and only the accessed data
+ * is ever read.
+ *
+ * With the ReadOnly mode the mapped memory must not be written. With
+ * the CopyOnWrite mode it can be written, and the modified pages are
+ * private copies: the file is never modified.
+ *
+ * The mapping is released by Unmap() or when the object is destroyed.
+ *
+ * \sa MemoryMappedImportImageContainer
+ *
+ * \ingroup OSSystemObjects
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT MemoryMappedFile:public LightObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryMappedFile           Self;
+  typedef LightObject                Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MemoryMappedFile, LightObject);
+
+  /** Access granted to the mapped memory. */
+  typedef enum { ReadOnly, CopyOnWrite } MappingModeType;
+
+  typedef ::itk::uintmax_t OffsetType;
+  typedef ::itk::uintmax_t LengthType;
+
+  /** Map length bytes of the file, starting at the given offset in
+   * bytes. The offset does not need to be aligned on a page. A
+   * previous mapping is released first. An exception is thrown if the
+   * file cannot be mapped or is too short. */
+  void Map(const std::string & fileName, OffsetType offset, LengthType length,
+           MappingModeType mode = ReadOnly);
+
+  /** Release the mapping, if any. */
+  void Unmap();
+
+  /** Pointer to the first mapped byte of the file, that is the byte at
+   * the offset given to Map(), or a null pointer if nothing is mapped. */
+  void * GetPointer() const
+  {
+    return m_Pointer;
+  }
+
+  LengthType GetLength() const
+  {
+    return m_Length;
+  }
+
+  MappingModeType GetMappingMode() const
+  {
+    return m_MappingMode;
+  }
+
+  const std::string & GetFileName() const
+  {
+    return m_FileName;
+  }
+
+protected:
+  MemoryMappedFile();
+  ~MemoryMappedFile();
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+private:
+  MemoryMappedFile(const Self &); //purposely not implemented
+  void operator=(const Self &);   //purposely not implemented
+
+  // Start and size of the mapped view, which begins on a page boundary
+  void *          m_View;
+  LengthType      m_ViewLength;
+
+  void *          m_Pointer;
+  LengthType      m_Length;
+  MappingModeType m_MappingMode;
+  std::string     m_FileName;
+};
+} // end namespace itk
+
+#endif
@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMemoryMappedImportImageContainer_h
+#define itkMemoryMappedImportImageContainer_h
+
+#include "itkImportImageContainer.h"
+#include "itkMemoryMappedFile.h"
+
+namespace itk
+{
+/** \class MemoryMappedImportImageContainer
+ *  \brief ImportImageContainer whose elements are mapped from a file.
+ *
+ * The elements of the container are the bytes of a file mapped in
+ * memory by a MemoryMappedFile, so no memory is allocated and no data
+ * is read until the elements are accessed. The file must store the
+ * elements contiguously, uncompressed and in the byte order of the
+ * machine.
+ *
+ * With the MemoryMappedFile::CopyOnWrite mode the elements can be
+ * modified without changing the file. With the MemoryMappedFile::ReadOnly
+ * mode, which shares the pages with the operating system cache, the
+ * elements must not be modified, neither directly nor by a filter
+ * running in place.
+ *
+ * Reserving more elements than mapped, or Squeeze(), copies the
+ * elements in a newly allocated buffer and releases the mapping.
+ *
+ * \sa ImageFileReader::SetUseMemoryMapping
+ *
+ * \ingroup ImageObjects
+ * \ingroup ITKCommon
+ */
+template< typename TElementIdentifier, typename TElement >
+class MemoryMappedImportImageContainer:
+  public ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MemoryMappedImportImageContainer                     Self;
+  typedef ImportImageContainer< TElementIdentifier, TElement > Superclass;
+  typedef SmartPointer< Self >                                 Pointer;
+  typedef SmartPointer< const Self >                           ConstPointer;
+
+  /** Save the template parameters. */
+  typedef TElementIdentifier ElementIdentifier;
+  typedef TElement           Element;
+
+  typedef MemoryMappedFile::MappingModeType MappingModeType;
+  typedef MemoryMappedFile::OffsetType      OffsetType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Standard part of every itk Object. */
+  itkTypeMacro(MemoryMappedImportImageContainer, ImportImageContainer);
+
+  /** Map "num" elements of the file, starting at the given offset in
+   * bytes, which should be a multiple of the size of the components of
+   * the elements. The previous elements of the container are released.
+   * An exception is thrown if the file cannot be mapped. */
+  void MapFile(const std::string & fileName, OffsetType offset, ElementIdentifier num,
+               MappingModeType mode = MemoryMappedFile::CopyOnWrite);
+
+  /** Return whether the elements are currently mapped from a file. */
+  bool IsMapped() const
+  {
+    return m_MappedFile.IsNotNull();
+  }
+
+  /** Get the mapping of the file, or a null pointer if the elements
+   * are not mapped. */
+  const MemoryMappedFile * GetMappedFile() const
+  {
+    return m_MappedFile.GetPointer();
+  }
+
+protected:
+  MemoryMappedImportImageContainer() {}
+  virtual ~MemoryMappedImportImageContainer();
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  /** Release the mapping together with the elements. */
+  virtual void DeallocateManagedMemory() ITK_OVERRIDE;
+
+private:
+  MemoryMappedImportImageContainer(const Self &); //purposely not implemented
+  void operator=(const Self &);                   //purposely not implemented
+
+  MemoryMappedFile::Pointer m_MappedFile;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMemoryMappedImportImageContainer.hxx"
+#endif
+
+#endif
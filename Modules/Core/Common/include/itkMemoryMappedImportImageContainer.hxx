@@ -0,0 +1,77 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMemoryMappedImportImageContainer_hxx
+#define itkMemoryMappedImportImageContainer_hxx
+
+#include "itkMemoryMappedImportImageContainer.h"
+
+namespace itk
+{
+template< typename TElementIdentifier, typename TElement >
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::~MemoryMappedImportImageContainer()
+{
+  // the destructor of the superclass does not call the override
+  this->DeallocateManagedMemory();
+}
+
+template< typename TElementIdentifier, typename TElement >
+void
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::MapFile(const std::string & fileName, OffsetType offset, ElementIdentifier num,
+          MappingModeType mode)
+{
+  // map the new file before releasing the current elements, so that
+  // the container is unchanged if mapping fails
+  MemoryMappedFile::Pointer mappedFile = MemoryMappedFile::New();
+  mappedFile->Map(fileName, offset, static_cast< MemoryMappedFile::LengthType >( num ) * sizeof( TElement ), mode);
+
+  this->SetImportPointer(static_cast< TElement * >( mappedFile->GetPointer() ), num, false);
+  m_MappedFile = mappedFile;
+}
+
+template< typename TElementIdentifier, typename TElement >
+void
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::DeallocateManagedMemory()
+{
+  Superclass::DeallocateManagedMemory();
+  m_MappedFile = ITK_NULLPTR;
+}
+
+template< typename TElementIdentifier, typename TElement >
+void
+MemoryMappedImportImageContainer< TElementIdentifier, TElement >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "MappedFile: ";
+  if ( m_MappedFile.IsNotNull() )
+    {
+    os << std::endl;
+    m_MappedFile->Print( os, indent.GetNextIndent() );
+    }
+  else
+    {
+    os << "(none)" << std::endl;
+    }
+}
+} // end namespace itk
+
+#endif
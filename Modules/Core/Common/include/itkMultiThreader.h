@@ -29,6 +29,7 @@
 #define itkMultiThreader_h
 
 #include "itkMutexLock.h"
+#include "itkSimpleFastMutexLock.h"
 #include "itkThreadSupport.h"
 #include "itkIntTypes.h"
 
@@ -97,6 +98,21 @@ public:
 
   static ThreadIdType  GetGlobalDefaultNumberOfThreads();
 
+  /** Set/Get the number of work units SingleMethodExecute() distributes
+   * over the threads. When it is larger than m_NumberOfThreads, the
+   * SingleMethod is invoked once per work unit instead of once per thread:
+   * each thread starts with a contiguous share of the work units, and a
+   * thread that runs out of work steals half of the remaining work units of
+   * the busiest thread. The ThreadInfoStruct passed to the SingleMethod then
+   * holds the WorkUnitID and NumberOfWorkUnits, while ThreadID still
+   * identifies the executing thread, so the same ThreadID can be seen
+   * several times. A value of zero (the default) means one work unit per
+   * thread. SetSingleMethod() resets this value to zero, so it has to be set
+   * after the SingleMethod. */
+  void SetNumberOfWorkUnits(ThreadIdType numberOfWorkUnits);
+
+  itkGetConstMacro(NumberOfWorkUnits, ThreadIdType);
+
   /** Execute the SingleMethod (as define by SetSingleMethod) using
    * m_NumberOfThreads threads. As a side effect the m_NumberOfThreads will be
    * checked against the current m_GlobalMaximumNumberOfThreads and clamped if
@@ -151,7 +167,11 @@ public:
    * indicates the id of this thread. The NumberOfThreads is
    * this->NumberOfThreads for threads created from
    * SingleMethodExecute or MultipleMethodExecute, and it is 1 for
-   * threads created from SpawnThread.  The UserData is the (void
+   * threads created from SpawnThread. The WorkUnitID is a number
+   * between 0 and NumberOfWorkUnits-1 that indicates the piece of work
+   * assigned to a SingleMethod invocation; unless work units have been
+   * requested with SetNumberOfWorkUnits(), they are equal to ThreadID and
+   * NumberOfThreads.  The UserData is the (void
    * *)arg passed into the SetSingleMethod, SetMultipleMethod, or
    * SpawnThread method. */
 #ifdef ThreadInfoStruct
@@ -161,6 +181,8 @@ public:
     {
     ThreadIdType ThreadID;
     ThreadIdType NumberOfThreads;
+    ThreadIdType WorkUnitID;
+    ThreadIdType NumberOfWorkUnits;
     int *ActiveFlag;
     MutexLock::Pointer ActiveFlagLock;
     void *UserData;
@@ -183,6 +205,10 @@ private:
   // choose whether to use Spawn or ThreadPool methods
   bool m_UseThreadPool;
 
+  /** Completion of the jobs handed to the thread pool by
+   * SingleMethodExecute(): a single wait covers all threads. */
+  ThreadPool::JobBatch m_ThreadPoolJobBatch;
+
   /** An array of thread info containing a thread id
    *  (0, 1, 2, .. ITK_MAX_THREADS-1), the thread count, and a pointer
    *  to void so that user data can be passed to each thread. */
@@ -203,6 +229,21 @@ private:
   void *m_SingleData;
   void *m_MultipleData[ITK_MAX_THREADS];
 
+  /** The number of work units SingleMethodExecute() distributes over
+   *  the threads, zero meaning one work unit per thread. */
+  ThreadIdType m_NumberOfWorkUnits;
+
+  /** The range [Begin, End) of work units still owned by a thread
+   *  during a work stealing SingleMethodExecute(). The owner takes work
+   *  units from the front, thieves take them from the back. */
+  struct WorkUnitRange
+    {
+    ThreadIdType        Begin;
+    ThreadIdType        End;
+    SimpleFastMutexLock Lock;
+    };
+  WorkUnitRange m_WorkUnitRanges[ITK_MAX_THREADS];
+
   /** Global variable defining the maximum number of threads that can be used.
    *  The m_GlobalMaximumNumberOfThreads must always be less than or equal to
    *  ITK_MAX_THREADS and greater than zero. */
@@ -244,10 +285,23 @@ private:
    * exceptions thrown by the threads. */
   static ITK_THREAD_RETURN_TYPE SingleMethodProxy(void *arg);
 
-  /** Assign work to a thread in the thread pool */
+  /** Static function used in place of the SingleMethod when work units
+   * are scheduled with work stealing. It invokes the SingleMethod for
+   * every work unit the thread obtains from GetNextWorkUnit(). */
+  static ITK_THREAD_RETURN_TYPE WorkStealingProxy(void *arg);
+
+  /** Fill in the fields of the ThreadInfoStruct used to run the
+   * SingleMethod on one thread. */
+  void InitializeSingleMethodThreadInfo(ThreadInfoStruct & threadInfo);
+
+  /** Obtain the next work unit for the given thread, stealing from the
+   * thread with the most remaining work units when the thread's own range
+   * is exhausted. Returns false when no work units are left. */
+  bool GetNextWorkUnit(ThreadIdType threadId, ThreadIdType & workUnit);
+
+  /** Assign work to a thread in the thread pool. The job is part of
+   * m_ThreadPoolJobBatch, which is waited for as a whole. */
   ThreadProcessIdType ThreadPoolDispatchSingleMethodThread(ThreadInfoStruct *);
-  /** wait for a thread in the threadpool to finish work */
-  void ThreadPoolWaitForSingleMethodThread(ThreadProcessIdType);
 
   /** spawn a new thread for the SingleMethod */
   ThreadProcessIdType SpawnDispatchSingleMethodThread(ThreadInfoStruct *);
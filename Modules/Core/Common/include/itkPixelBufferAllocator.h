@@ -0,0 +1,108 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPixelBufferAllocator_h
+#define itkPixelBufferAllocator_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkIntTypes.h"
+
+namespace itk
+{
+/** \class PixelBufferAllocator
+ * \brief Allocates aligned memory for the pixel buffers of images.
+ *
+ * By default the pixel buffers of images are allocated by
+ * ImportImageContainer with new[]. A PixelBufferAllocator set on the
+ * container, on the ImageSource producing the image, or as the global
+ * default, allocates them instead.
+ *
+ * The buffers are aligned on Alignment bytes, 64 by default so that
+ * they start on a cache line and can be accessed with aligned vector
+ * loads. With UseHugePages, buffers of at least 2 MiB are aligned on
+ * 2 MiB and the operating system is advised to back them with huge
+ * pages, which reduces the TLB misses of large images. This is
+ * currently only supported on Linux, and ignored elsewhere.
+ *
+ * Subclasses can override Allocate() and Deallocate(), see
+ * PoolPixelBufferAllocator. The methods can be called concurrently.
+ *
+ * \sa ImportImageContainer::SetPixelBufferAllocator
+ * \sa ImageSource::SetPixelBufferAllocator
+ *
+ * \ingroup ImageObjects
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT PixelBufferAllocator:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef PixelBufferAllocator       Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PixelBufferAllocator, Object);
+
+  /** Set/Get the alignment of the buffers in bytes. It must be a power
+   * of two, and should not be changed once buffers are allocated.
+   * Defaults to 64. */
+  itkSetMacro(Alignment, SizeValueType);
+  itkGetConstMacro(Alignment, SizeValueType);
+
+  /** Set/Get whether large buffers are backed with huge pages when the
+   * platform supports it. Defaults to false. */
+  itkSetMacro(UseHugePages, bool);
+  itkGetConstMacro(UseHugePages, bool);
+  itkBooleanMacro(UseHugePages);
+
+  /** Allocate an uninitialized buffer of numberOfBytes bytes. A
+   * MemoryAllocationError is thrown on failure. */
+  virtual void * Allocate(SizeValueType numberOfBytes);
+
+  /** Release a buffer returned by Allocate() for the same number of
+   * bytes. */
+  virtual void Deallocate(void *buffer, SizeValueType numberOfBytes);
+
+  /** Set/Get the allocator used by the pixel containers created
+   * afterwards. When none is set, the default, the pixel buffers are
+   * allocated with new[]. */
+  static void SetGlobalDefault(Self *allocator);
+  static Self * GetGlobalDefault();
+
+protected:
+  PixelBufferAllocator();
+  virtual ~PixelBufferAllocator();
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+private:
+  PixelBufferAllocator(const Self &); //purposely not implemented
+  void operator=(const Self &);       //purposely not implemented
+
+  SizeValueType m_Alignment;
+  bool          m_UseHugePages;
+
+  static Pointer m_GlobalDefault;
+};
+} // end namespace itk
+
+#endif
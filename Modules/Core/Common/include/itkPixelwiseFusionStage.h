@@ -0,0 +1,118 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPixelwiseFusionStage_h
+#define itkPixelwiseFusionStage_h
+
+#include "itkProcessObject.h"
+#include "itkIndex.h"
+
+namespace itk
+{
+/** \class PixelwiseFusionStage
+ * \brief Interface of the pixel-wise filters which can compute their
+ * output one scanline at a time for a downstream filter.
+ *
+ * A chain of pixel-wise filters normally allocates and traverses a full
+ * intermediate image at each step. When a pixel-wise filter has its
+ * PixelwiseFusion flag on, which states that its output does not have to
+ * be kept, the pixel-wise filter which consumes that output fuses it: it
+ * does not update that input, but asks the upstream filter for the
+ * scanlines of its output as it needs them, in a small per-thread
+ * buffer. The upstream filter may itself fuse its own inputs, so that a
+ * whole chain executes in a single pass over the data. The chain stops
+ * at the first filter which is not pixel-wise, or whose PixelwiseFusion
+ * flag is off; that output is updated as usual.
+ *
+ * The fused filters do not execute: they do not invoke StartEvent,
+ * ProgressEvent or EndEvent, and their outputs are not generated. These
+ * outputs are released once the fused execution is finished, so that a
+ * filter which shares them, or a user who updates them, gets them
+ * generated by a normal execution instead of stale data.
+ *
+ * UnaryFunctorImageFilter, BinaryFunctorImageFilter and
+ * ShiftScaleImageFilter implement this interface, and fuse their inputs
+ * in ProcessObject::UpdateInputs().
+ *
+ * \ingroup DataProcessing
+ * \ingroup ITKCommon
+ */
+template< unsigned int VDimension >
+class PixelwiseFusionStage
+{
+public:
+  typedef PixelwiseFusionStage  Self;
+  typedef Index< VDimension >   IndexType;
+
+  virtual ~PixelwiseFusionStage() {}
+
+  /** Return the filter which can generate the scanlines of input, if
+   * input has to be generated and is the primary output of a pixel-wise
+   * filter which can be fused and has its PixelwiseFusion flag on.
+   * Return ITK_NULLPTR otherwise. */
+  static Self * GetFusableSource(DataObject *input)
+  {
+    if ( input == ITK_NULLPTR )
+      {
+      return ITK_NULLPTR;
+      }
+    // an input which is already up to date is read as is
+    if ( input->GetUpdateMTime() >= input->GetPipelineMTime() && !input->GetDataReleased()
+         && !input->RequestedRegionIsOutsideOfTheBufferedRegion() )
+      {
+      return ITK_NULLPTR;
+      }
+    ProcessObject::Pointer source( input->GetSource() );
+    Self *                 stage = dynamic_cast< Self * >( source.GetPointer() );
+    if ( stage == ITK_NULLPTR || input->GetSourceOutputIndex() != 0 || !stage->GetPixelwiseFusion()
+         || !stage->CanBeFused() )
+      {
+      return ITK_NULLPTR;
+      }
+    return stage;
+  }
+
+  /** Whether the user allows the filter to be fused into the filter
+   * which consumes its output. */
+  virtual bool GetPixelwiseFusion() const = 0;
+
+  /** Whether the filter can be fused into the downstream filter: it
+   * computes each output pixel from the input pixels at the same index
+   * only, and its images have contiguous scanlines. */
+  virtual bool CanBeFused() const = 0;
+
+  /** Update the inputs of the fused filter, fusing its own fusable
+   * inputs. Called in place of updating its output. */
+  virtual void UpdateFusedInputs() = 0;
+
+  /** Prepare the fused filter to generate scanlines of at most
+   * maximumLength pixels from numberOfThreads threads. */
+  virtual void PrepareFusedExecution(ThreadIdType numberOfThreads, SizeValueType maximumLength) = 0;
+
+  /** Generate the length output pixels starting at index into scanline,
+   * an array of the output pixel type. Called concurrently, with
+   * distinct threadId, by the threads of the downstream filter. */
+  virtual void GenerateFusedScanline(const IndexType & index, SizeValueType length,
+                                     void *scanline, ThreadIdType threadId) = 0;
+
+  /** Release the buffers of the fused execution, the inputs whose
+   * ReleaseDataFlag is set, and the output, which was not generated. */
+  virtual void FinishFusedExecution() = 0;
+};
+} // end namespace itk
+
+#endif
@@ -0,0 +1,121 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPoolPixelBufferAllocator_h
+#define itkPoolPixelBufferAllocator_h
+
+#include "itkPixelBufferAllocator.h"
+#include "itkSimpleFastMutexLock.h"
+#include <map>
+#include <vector>
+
+namespace itk
+{
+/** \class PoolPixelBufferAllocator
+ * \brief Recycles the pixel buffers of images of the same size.
+ *
+ * Pipelines that execute repeatedly, like the levels and iterations of
+ * a multi-resolution registration, release and allocate buffers of
+ * the same few sizes over and over. Instead of returning a released
+ * buffer to the system, PoolPixelBufferAllocator keeps it in a pool
+ * keyed by its size in bytes and by the Alignment and UseHugePages
+ * it was allocated with, and hands it out again for the next
+ * allocation with the same size and settings. Recycled buffers are not
+ * initialized: containers initialize their elements when asked to.
+ *
+ * At most MaximumPoolSize bytes are kept; beyond, released buffers are
+ * returned to the system. ReleaseMemory() empties the pool.
+ *
+ * \ingroup ImageObjects
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT PoolPixelBufferAllocator:public PixelBufferAllocator
+{
+public:
+  /** Standard class typedefs. */
+  typedef PoolPixelBufferAllocator   Self;
+  typedef PixelBufferAllocator       Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PoolPixelBufferAllocator, PixelBufferAllocator);
+
+  /** Set/Get the maximum number of bytes kept in the pool. Defaults to
+   * 1 GiB. */
+  itkSetMacro(MaximumPoolSize, SizeValueType);
+  itkGetConstMacro(MaximumPoolSize, SizeValueType);
+
+  /** Get the number of bytes currently kept in the pool. */
+  SizeValueType GetPoolSize() const;
+
+  /** Get the number of allocations served from the pool. */
+  SizeValueType GetNumberOfReusedBuffers() const;
+
+  /** Return the buffers kept in the pool to the system. */
+  void ReleaseMemory();
+
+  virtual void * Allocate(SizeValueType numberOfBytes) ITK_OVERRIDE;
+
+  virtual void Deallocate(void *buffer, SizeValueType numberOfBytes) ITK_OVERRIDE;
+
+protected:
+  PoolPixelBufferAllocator();
+  virtual ~PoolPixelBufferAllocator();
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+private:
+  PoolPixelBufferAllocator(const Self &); //purposely not implemented
+  void operator=(const Self &);           //purposely not implemented
+
+  /** Size and settings a buffer was allocated with. */
+  struct BufferKey
+    {
+    SizeValueType NumberOfBytes;
+    SizeValueType Alignment;
+    bool          UseHugePages;
+
+    bool operator<(const BufferKey & other) const
+    {
+      if ( NumberOfBytes != other.NumberOfBytes )
+        {
+        return NumberOfBytes < other.NumberOfBytes;
+        }
+      if ( Alignment != other.Alignment )
+        {
+        return Alignment < other.Alignment;
+        }
+      return UseHugePages < other.UseHugePages;
+    }
+    };
+
+  typedef std::map< BufferKey, std::vector< void * > > PoolType;
+  typedef std::map< void *, BufferKey >                BufferKeyMapType;
+
+  PoolType                    m_Pool;
+  BufferKeyMapType            m_AllocatedBuffers;
+  SizeValueType               m_PoolSize;
+  SizeValueType               m_MaximumPoolSize;
+  SizeValueType               m_NumberOfReusedBuffers;
+  mutable SimpleFastMutexLock m_Mutex;
+};
+} // end namespace itk
+
+#endif
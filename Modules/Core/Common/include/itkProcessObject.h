@@ -762,6 +762,16 @@ protected:
    */
   virtual void ReleaseInputs();
 
+  /** Bring the inputs up to date before the filter generates its data.
+   * The implementation here calls UpdateOutputData() on every input.
+   * Pixel-wise filters override it to compute some of their inputs
+   * themselves, scanline by scanline, instead of having the upstream
+   * filters produce them.
+   *
+   * \sa UnaryFunctorImageFilter
+   * \sa PixelwiseFusionStage */
+  virtual void UpdateInputs();
+
   /**
    * Cache the state of any ReleaseDataFlag's on the inputs. While the
    * filter is executing, we need to set the ReleaseDataFlag's on the
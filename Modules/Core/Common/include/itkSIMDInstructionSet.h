@@ -0,0 +1,84 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSIMDInstructionSet_h
+#define itkSIMDInstructionSet_h
+
+#include "itkMacro.h"
+
+/** Code compiled for a given x86 instruction set extension, selected at
+ * run time by SIMDInstructionSet. Only GCC and Clang can compile a
+ * function for an instruction set not enabled on the command line. */
+#if ( ( defined( __GNUC__ ) && __GNUC__ >= 5 ) || defined( __clang__ ) ) \
+  && !defined( __INTEL_COMPILER ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define ITK_HAS_SIMD_TARGET_DISPATCH
+#define itkSIMDTargetMacro(instructions) __attribute__( ( target( instructions ) ) )
+#define itkSIMDInlineMacro inline __attribute__( ( always_inline ) )
+#else
+#define itkSIMDTargetMacro(instructions)
+#define itkSIMDInlineMacro inline
+#endif
+
+namespace itk
+{
+/** \class SIMDInstructionSet
+ * \brief Selects at run time the vector instructions used by the
+ * vectorized kernels.
+ *
+ * Scalar disables the vectorized kernels: the filters iterate over the
+ * pixels as they always did. Baseline runs the kernels compiled with the
+ * instructions enabled by the compiler flags, SSE2 on x86-64. AVX2 and
+ * AVX512 run the kernels compiled for these extensions, when the
+ * processor and the compiler support them.
+ *
+ * SetMaximumInstructionSet() restricts the instruction set used, for
+ * instance to compare the vectorized and scalar paths.
+ *
+ * \sa ScanlineFunctorKernels
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT SIMDInstructionSet
+{
+public:
+  typedef enum { Scalar = 0, Baseline, AVX2, AVX512 } InstructionSetType;
+
+  /** Get the best instruction set supported by the processor and the
+   * compiler. */
+  static InstructionSetType GetSupportedInstructionSet();
+
+  /** Set/Get the best instruction set that may be used. Defaults to
+   * AVX512, that is no restriction. */
+  static void SetMaximumInstructionSet(InstructionSetType instructionSet);
+  static InstructionSetType GetMaximumInstructionSet();
+
+  /** Get the instruction set used by the kernels: the supported one,
+   * limited to the maximum. */
+  static InstructionSetType GetInstructionSet()
+  {
+    const InstructionSetType supported = GetSupportedInstructionSet();
+    return m_MaximumInstructionSet < supported ? m_MaximumInstructionSet : supported;
+  }
+
+  /** Get the name of an instruction set. */
+  static const char * GetInstructionSetName(InstructionSetType instructionSet);
+
+private:
+  static InstructionSetType m_MaximumInstructionSet;
+};
+} // end namespace itk
+
+#endif
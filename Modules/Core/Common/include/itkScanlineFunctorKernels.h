@@ -0,0 +1,551 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkScanlineFunctorKernels_h
+#define itkScanlineFunctorKernels_h
+
+#include "itkImage.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkProgressReporter.h"
+#include "itkSIMDInstructionSet.h"
+#include <limits>
+
+namespace itk
+{
+/** \class ScanlineImageTraits
+ * \brief Tells whether the scanlines of an image type are contiguous
+ * arrays of arithmetic pixels, and gives access to them.
+ *
+ * Only itk::Image of arithmetic pixel types qualifies: the pixels of
+ * the other image types are either not stored as PixelType, like the
+ * ones of VectorImage, or accessed through a pixel accessor.
+ *
+ * \sa ScanlineFunctorKernels
+ * \ingroup ITKCommon
+ */
+template< typename TImage >
+struct ScanlineImageTraits
+{
+  static const bool IsContiguousArithmetic = false;
+
+  static const typename TImage::PixelType * GetScanline(const TImage *, const typename TImage::IndexType &)
+  {
+    return ITK_NULLPTR;
+  }
+
+  static typename TImage::PixelType * GetScanline(TImage *, const typename TImage::IndexType &)
+  {
+    return ITK_NULLPTR;
+  }
+};
+
+template< typename TPixel, unsigned int VDimension >
+struct ScanlineImageTraits< Image< TPixel, VDimension > >
+{
+  static const bool IsContiguousArithmetic = std::numeric_limits< TPixel >::is_specialized;
+
+  static const TPixel * GetScanline(const Image< TPixel, VDimension > *image, const Index< VDimension > & index)
+  {
+    return image->GetBufferPointer() + image->ComputeOffset(index);
+  }
+
+  static TPixel * GetScanline(Image< TPixel, VDimension > *image, const Index< VDimension > & index)
+  {
+    return image->GetBufferPointer() + image->ComputeOffset(index);
+  }
+};
+
+/** \class ScanlineFunctorKernels
+ * \brief Applies a pixel functor to whole scanlines of contiguous
+ * buffers, with the vector instructions selected at run time.
+ *
+ * The functor filters call a functor per pixel through image iterators,
+ * which keeps the compiler from vectorizing the loop. When all the
+ * images are itk::Image of arithmetic pixel types, the scanlines are
+ * contiguous arrays, and the functor can be applied by a plain loop over
+ * pointers that the compiler vectorizes. The loop is compiled for the
+ * baseline instructions and, with GCC and Clang on x86, for AVX2 and
+ * AVX-512; SIMDInstructionSet selects the variant run.
+ *
+ * Each method returns false, without doing anything, when the images
+ * are not suitable or when SIMDInstructionSet::GetInstructionSet() is
+ * Scalar, in which case the caller iterates over the pixels itself. One
+ * pixel of progress is reported per scanline.
+ *
+ * The results are the ones of the scalar path, except that the compiler
+ * may contract floating point multiply-adds with the instructions of
+ * AVX-512.
+ *
+ * \sa UnaryFunctorImageFilter
+ * \sa BinaryFunctorImageFilter
+ * \sa TernaryFunctorImageFilter
+ * \ingroup ITKCommon
+ */
+class ScanlineFunctorKernels
+{
+public:
+  /** Apply a unary functor from an input region to an output region of
+   * the same size along the first dimension. */
+  template< typename TFunctor, typename TInputImage, typename TOutputImage >
+  static bool Unary(TFunctor &, const TInputImage *, const typename TInputImage::RegionType &,
+                    TOutputImage *, const typename TOutputImage::RegionType &, ProgressReporter &)
+  {
+    return false;
+  }
+
+  template< typename TFunctor, typename TInputPixel, unsigned int VInputDimension,
+            typename TOutputPixel, unsigned int VOutputDimension >
+  static bool Unary(TFunctor & functor,
+                    const Image< TInputPixel, VInputDimension > *input,
+                    const ImageRegion< VInputDimension > & inputRegion,
+                    Image< TOutputPixel, VOutputDimension > *output,
+                    const ImageRegion< VOutputDimension > & outputRegion,
+                    ProgressReporter & progress)
+  {
+    if ( !IsArithmetic< TInputPixel >() || !IsArithmetic< TOutputPixel >() )
+      {
+      return false;
+      }
+    if ( SIMDInstructionSet::GetInstructionSet() == SIMDInstructionSet::Scalar )
+      {
+      return false;
+      }
+    void ( *line )(TFunctor &, const TInputPixel *, TOutputPixel *, SizeValueType);
+    SelectUnaryLine(line);
+
+    ImageScanlineConstIterator< Image< TInputPixel, VInputDimension > >   inputIt(input, inputRegion);
+    ImageScanlineConstIterator< Image< TOutputPixel, VOutputDimension > > outputIt(output, outputRegion);
+    const SizeValueType length = outputRegion.GetSize(0);
+    while ( !outputIt.IsAtEnd() )
+      {
+      line( functor,
+            input->GetBufferPointer() + input->ComputeOffset( inputIt.GetIndex() ),
+            output->GetBufferPointer() + output->ComputeOffset( outputIt.GetIndex() ),
+            length );
+      inputIt.NextLine();
+      outputIt.NextLine();
+      progress.CompletedPixel(); // potential exception thrown here
+      }
+    return true;
+  }
+
+  /** Apply a binary functor to two input images. All the images share
+   * the region. */
+  template< typename TFunctor, typename TInputImage1, typename TInputImage2, typename TOutputImage >
+  static bool Binary(TFunctor &, const TInputImage1 *, const TInputImage2 *,
+                     TOutputImage *, const typename TOutputImage::RegionType &, ProgressReporter &)
+  {
+    return false;
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2,
+            typename TOutputPixel, unsigned int VDimension >
+  static bool Binary(TFunctor & functor,
+                     const Image< TInputPixel1, VDimension > *input1,
+                     const Image< TInputPixel2, VDimension > *input2,
+                     Image< TOutputPixel, VDimension > *output,
+                     const ImageRegion< VDimension > & region,
+                     ProgressReporter & progress)
+  {
+    if ( !IsArithmetic< TInputPixel1 >() || !IsArithmetic< TInputPixel2 >() || !IsArithmetic< TOutputPixel >() )
+      {
+      return false;
+      }
+    if ( SIMDInstructionSet::GetInstructionSet() == SIMDInstructionSet::Scalar )
+      {
+      return false;
+      }
+    void ( *line )(TFunctor &, const TInputPixel1 *, const TInputPixel2 *, TOutputPixel *, SizeValueType);
+    SelectBinaryLine(line);
+
+    ImageScanlineConstIterator< Image< TOutputPixel, VDimension > > it(output, region);
+    const SizeValueType length = region.GetSize(0);
+    while ( !it.IsAtEnd() )
+      {
+      const typename Image< TOutputPixel, VDimension >::IndexType & index = it.GetIndex();
+      line( functor,
+            input1->GetBufferPointer() + input1->ComputeOffset(index),
+            input2->GetBufferPointer() + input2->ComputeOffset(index),
+            output->GetBufferPointer() + output->ComputeOffset(index),
+            length );
+      it.NextLine();
+      progress.CompletedPixel(); // potential exception thrown here
+      }
+    return true;
+  }
+
+  /** Apply a binary functor to an input image, as second operand, and a
+   * constant first operand. */
+  template< typename TFunctor, typename TInputPixel1, typename TInputImage2, typename TOutputImage >
+  static bool BinaryWithConstant1(TFunctor &, const TInputPixel1 &, const TInputImage2 *,
+                                  TOutputImage *, const typename TOutputImage::RegionType &, ProgressReporter &)
+  {
+    return false;
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2,
+            typename TOutputPixel, unsigned int VDimension >
+  static bool BinaryWithConstant1(TFunctor & functor,
+                                  const TInputPixel1 & constant1,
+                                  const Image< TInputPixel2, VDimension > *input2,
+                                  Image< TOutputPixel, VDimension > *output,
+                                  const ImageRegion< VDimension > & region,
+                                  ProgressReporter & progress)
+  {
+    if ( !IsArithmetic< TInputPixel1 >() || !IsArithmetic< TInputPixel2 >() || !IsArithmetic< TOutputPixel >() )
+      {
+      return false;
+      }
+    if ( SIMDInstructionSet::GetInstructionSet() == SIMDInstructionSet::Scalar )
+      {
+      return false;
+      }
+    void ( *line )(TFunctor &, const TInputPixel1 &, const TInputPixel2 *, TOutputPixel *, SizeValueType);
+    SelectBinaryWithConstant1Line(line);
+
+    ImageScanlineConstIterator< Image< TOutputPixel, VDimension > > it(output, region);
+    const SizeValueType length = region.GetSize(0);
+    while ( !it.IsAtEnd() )
+      {
+      const typename Image< TOutputPixel, VDimension >::IndexType & index = it.GetIndex();
+      line( functor,
+            constant1,
+            input2->GetBufferPointer() + input2->ComputeOffset(index),
+            output->GetBufferPointer() + output->ComputeOffset(index),
+            length );
+      it.NextLine();
+      progress.CompletedPixel(); // potential exception thrown here
+      }
+    return true;
+  }
+
+  /** Apply a binary functor to an input image, as first operand, and a
+   * constant second operand. */
+  template< typename TFunctor, typename TInputImage1, typename TInputPixel2, typename TOutputImage >
+  static bool BinaryWithConstant2(TFunctor &, const TInputImage1 *, const TInputPixel2 &,
+                                  TOutputImage *, const typename TOutputImage::RegionType &, ProgressReporter &)
+  {
+    return false;
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2,
+            typename TOutputPixel, unsigned int VDimension >
+  static bool BinaryWithConstant2(TFunctor & functor,
+                                  const Image< TInputPixel1, VDimension > *input1,
+                                  const TInputPixel2 & constant2,
+                                  Image< TOutputPixel, VDimension > *output,
+                                  const ImageRegion< VDimension > & region,
+                                  ProgressReporter & progress)
+  {
+    if ( !IsArithmetic< TInputPixel1 >() || !IsArithmetic< TInputPixel2 >() || !IsArithmetic< TOutputPixel >() )
+      {
+      return false;
+      }
+    if ( SIMDInstructionSet::GetInstructionSet() == SIMDInstructionSet::Scalar )
+      {
+      return false;
+      }
+    void ( *line )(TFunctor &, const TInputPixel1 *, const TInputPixel2 &, TOutputPixel *, SizeValueType);
+    SelectBinaryWithConstant2Line(line);
+
+    ImageScanlineConstIterator< Image< TOutputPixel, VDimension > > it(output, region);
+    const SizeValueType length = region.GetSize(0);
+    while ( !it.IsAtEnd() )
+      {
+      const typename Image< TOutputPixel, VDimension >::IndexType & index = it.GetIndex();
+      line( functor,
+            input1->GetBufferPointer() + input1->ComputeOffset(index),
+            constant2,
+            output->GetBufferPointer() + output->ComputeOffset(index),
+            length );
+      it.NextLine();
+      progress.CompletedPixel(); // potential exception thrown here
+      }
+    return true;
+  }
+
+  /** Apply a ternary functor to three input images. All the images share
+   * the region. */
+  template< typename TFunctor, typename TInputImage1, typename TInputImage2,
+            typename TInputImage3, typename TOutputImage >
+  static bool Ternary(TFunctor &, const TInputImage1 *, const TInputImage2 *, const TInputImage3 *,
+                      TOutputImage *, const typename TOutputImage::RegionType &, ProgressReporter &)
+  {
+    return false;
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TInputPixel3,
+            typename TOutputPixel, unsigned int VDimension >
+  static bool Ternary(TFunctor & functor,
+                      const Image< TInputPixel1, VDimension > *input1,
+                      const Image< TInputPixel2, VDimension > *input2,
+                      const Image< TInputPixel3, VDimension > *input3,
+                      Image< TOutputPixel, VDimension > *output,
+                      const ImageRegion< VDimension > & region,
+                      ProgressReporter & progress)
+  {
+    if ( !IsArithmetic< TInputPixel1 >() || !IsArithmetic< TInputPixel2 >()
+         || !IsArithmetic< TInputPixel3 >() || !IsArithmetic< TOutputPixel >() )
+      {
+      return false;
+      }
+    if ( SIMDInstructionSet::GetInstructionSet() == SIMDInstructionSet::Scalar )
+      {
+      return false;
+      }
+    void ( *line )(TFunctor &, const TInputPixel1 *, const TInputPixel2 *, const TInputPixel3 *,
+                   TOutputPixel *, SizeValueType);
+    SelectTernaryLine(line);
+
+    ImageScanlineConstIterator< Image< TOutputPixel, VDimension > > it(output, region);
+    const SizeValueType length = region.GetSize(0);
+    while ( !it.IsAtEnd() )
+      {
+      const typename Image< TOutputPixel, VDimension >::IndexType & index = it.GetIndex();
+      line( functor,
+            input1->GetBufferPointer() + input1->ComputeOffset(index),
+            input2->GetBufferPointer() + input2->ComputeOffset(index),
+            input3->GetBufferPointer() + input3->ComputeOffset(index),
+            output->GetBufferPointer() + output->ComputeOffset(index),
+            length );
+      it.NextLine();
+      progress.CompletedPixel(); // potential exception thrown here
+      }
+    return true;
+  }
+
+  /** Select the loop applying a functor to a scanline, for the
+   * instruction set returned by SIMDInstructionSet::GetInstructionSet().
+   * The baseline loop is selected for Scalar. */
+  template< typename TFunctor, typename TInputPixel, typename TOutputPixel >
+  static void SelectUnaryLine(void ( * &line )(TFunctor &, const TInputPixel *, TOutputPixel *, SizeValueType))
+  {
+    line = &UnaryLoop< TFunctor, TInputPixel, TOutputPixel >;
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+    switch ( SIMDInstructionSet::GetInstructionSet() )
+      {
+      case SIMDInstructionSet::AVX2:
+        line = &UnaryAVX2< TFunctor, TInputPixel, TOutputPixel >;
+        break;
+      case SIMDInstructionSet::AVX512:
+        line = &UnaryAVX512< TFunctor, TInputPixel, TOutputPixel >;
+        break;
+      default:
+        break;
+      }
+#endif
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >
+  static void SelectBinaryLine(void ( * &line )(TFunctor &, const TInputPixel1 *, const TInputPixel2 *,
+                                                TOutputPixel *, SizeValueType))
+  {
+    line = &BinaryLoop< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+    switch ( SIMDInstructionSet::GetInstructionSet() )
+      {
+      case SIMDInstructionSet::AVX2:
+        line = &BinaryAVX2< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+        break;
+      case SIMDInstructionSet::AVX512:
+        line = &BinaryAVX512< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+        break;
+      default:
+        break;
+      }
+#endif
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >
+  static void SelectBinaryWithConstant1Line(void ( * &line )(TFunctor &, const TInputPixel1 &, const TInputPixel2 *,
+                                                             TOutputPixel *, SizeValueType))
+  {
+    line = &BinaryWithConstant1Loop< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+    switch ( SIMDInstructionSet::GetInstructionSet() )
+      {
+      case SIMDInstructionSet::AVX2:
+        line = &BinaryWithConstant1AVX2< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+        break;
+      case SIMDInstructionSet::AVX512:
+        line = &BinaryWithConstant1AVX512< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+        break;
+      default:
+        break;
+      }
+#endif
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >
+  static void SelectBinaryWithConstant2Line(void ( * &line )(TFunctor &, const TInputPixel1 *, const TInputPixel2 &,
+                                                             TOutputPixel *, SizeValueType))
+  {
+    line = &BinaryWithConstant2Loop< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+    switch ( SIMDInstructionSet::GetInstructionSet() )
+      {
+      case SIMDInstructionSet::AVX2:
+        line = &BinaryWithConstant2AVX2< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+        break;
+      case SIMDInstructionSet::AVX512:
+        line = &BinaryWithConstant2AVX512< TFunctor, TInputPixel1, TInputPixel2, TOutputPixel >;
+        break;
+      default:
+        break;
+      }
+#endif
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TInputPixel3,
+            typename TOutputPixel >
+  static void SelectTernaryLine(void ( * &line )(TFunctor &, const TInputPixel1 *, const TInputPixel2 *,
+                                                 const TInputPixel3 *, TOutputPixel *, SizeValueType))
+  {
+    line = &TernaryLoop< TFunctor, TInputPixel1, TInputPixel2, TInputPixel3, TOutputPixel >;
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+    switch ( SIMDInstructionSet::GetInstructionSet() )
+      {
+      case SIMDInstructionSet::AVX2:
+        line = &TernaryAVX2< TFunctor, TInputPixel1, TInputPixel2, TInputPixel3, TOutputPixel >;
+        break;
+      case SIMDInstructionSet::AVX512:
+        line = &TernaryAVX512< TFunctor, TInputPixel1, TInputPixel2, TInputPixel3, TOutputPixel >;
+        break;
+      default:
+        break;
+      }
+#endif
+  }
+
+private:
+  template< typename T >
+  static bool IsArithmetic()
+  {
+    return std::numeric_limits< T >::is_specialized;
+  }
+
+  /** The loops, inlined in each variant so that they are vectorized
+   * with its instructions. The output may be one of the inputs. */
+  template< typename TFunctor, typename TInputPixel, typename TOutputPixel >
+  static itkSIMDInlineMacro void UnaryLoop(TFunctor & functor, const TInputPixel *input,
+                                           TOutputPixel *output, SizeValueType length)
+  {
+    for ( SizeValueType i = 0; i < length; ++i )
+      {
+      output[i] = functor(input[i]);
+      }
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >
+  static itkSIMDInlineMacro void BinaryLoop(TFunctor & functor, const TInputPixel1 *input1,
+                                            const TInputPixel2 *input2, TOutputPixel *output,
+                                            SizeValueType length)
+  {
+    for ( SizeValueType i = 0; i < length; ++i )
+      {
+      output[i] = functor(input1[i], input2[i]);
+      }
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >
+  static itkSIMDInlineMacro void BinaryWithConstant1Loop(TFunctor & functor, const TInputPixel1 & constant1,
+                                                         const TInputPixel2 *input2, TOutputPixel *output,
+                                                         SizeValueType length)
+  {
+    const TInputPixel1 value1 = constant1;
+    for ( SizeValueType i = 0; i < length; ++i )
+      {
+      output[i] = functor(value1, input2[i]);
+      }
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >
+  static itkSIMDInlineMacro void BinaryWithConstant2Loop(TFunctor & functor, const TInputPixel1 *input1,
+                                                         const TInputPixel2 & constant2, TOutputPixel *output,
+                                                         SizeValueType length)
+  {
+    const TInputPixel2 value2 = constant2;
+    for ( SizeValueType i = 0; i < length; ++i )
+      {
+      output[i] = functor(input1[i], value2);
+      }
+  }
+
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TInputPixel3,
+            typename TOutputPixel >
+  static itkSIMDInlineMacro void TernaryLoop(TFunctor & functor, const TInputPixel1 *input1,
+                                             const TInputPixel2 *input2, const TInputPixel3 *input3,
+                                             TOutputPixel *output, SizeValueType length)
+  {
+    for ( SizeValueType i = 0; i < length; ++i )
+      {
+      output[i] = functor(input1[i], input2[i], input3[i]);
+      }
+  }
+
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+#define itkScanlineFunctorKernelsVariantsMacro(suffix, instructions)                                           \
+  template< typename TFunctor, typename TInputPixel, typename TOutputPixel >                                   \
+  itkSIMDTargetMacro(instructions) static void Unary##suffix(TFunctor & functor, const TInputPixel *input,     \
+                                                             TOutputPixel *output, SizeValueType length)      \
+  {                                                                                                            \
+    UnaryLoop(functor, input, output, length);                                                                 \
+  }                                                                                                            \
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >           \
+  itkSIMDTargetMacro(instructions) static void Binary##suffix(TFunctor & functor, const TInputPixel1 *input1,  \
+                                                              const TInputPixel2 *input2,                      \
+                                                              TOutputPixel *output, SizeValueType length)      \
+  {                                                                                                            \
+    BinaryLoop(functor, input1, input2, output, length);                                                       \
+  }                                                                                                            \
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >           \
+  itkSIMDTargetMacro(instructions) static void BinaryWithConstant1##suffix(TFunctor & functor,                 \
+                                                                           const TInputPixel1 & constant1,     \
+                                                                           const TInputPixel2 *input2,         \
+                                                                           TOutputPixel *output,               \
+                                                                           SizeValueType length)               \
+  {                                                                                                            \
+    BinaryWithConstant1Loop(functor, constant1, input2, output, length);                                       \
+  }                                                                                                            \
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TOutputPixel >           \
+  itkSIMDTargetMacro(instructions) static void BinaryWithConstant2##suffix(TFunctor & functor,                 \
+                                                                           const TInputPixel1 *input1,         \
+                                                                           const TInputPixel2 & constant2,     \
+                                                                           TOutputPixel *output,               \
+                                                                           SizeValueType length)               \
+  {                                                                                                            \
+    BinaryWithConstant2Loop(functor, input1, constant2, output, length);                                       \
+  }                                                                                                            \
+  template< typename TFunctor, typename TInputPixel1, typename TInputPixel2, typename TInputPixel3,            \
+            typename TOutputPixel >                                                                            \
+  itkSIMDTargetMacro(instructions) static void Ternary##suffix(TFunctor & functor, const TInputPixel1 *input1, \
+                                                               const TInputPixel2 *input2,                     \
+                                                               const TInputPixel3 *input3,                     \
+                                                               TOutputPixel *output, SizeValueType length)     \
+  {                                                                                                            \
+    TernaryLoop(functor, input1, input2, input3, output, length);                                              \
+  }
+
+  itkScanlineFunctorKernelsVariantsMacro(AVX2, "avx2")
+  itkScanlineFunctorKernelsVariantsMacro(AVX512, "avx512f,avx512bw,avx512dq,avx512vl")
+
+#undef itkScanlineFunctorKernelsVariantsMacro
+#endif
+};
+} // end namespace itk
+
+#endif
@@ -237,6 +237,16 @@ public:
    * DataObject to be modified. */
   void SetPixelContainer(PixelContainer *container);
 
+  /** Set the allocator of the pixel container used by the next calls
+   * to Allocate(). */
+  virtual void SetPixelBufferAllocator(PixelBufferAllocator *allocator) ITK_OVERRIDE
+  {
+    if ( m_Buffer )
+      {
+      m_Buffer->SetPixelBufferAllocator(allocator);
+      }
+  }
+
   /** Return the Pixel Accessor object */
   AccessorType GetPixelAccessor(void) { return AccessorType(); }
 
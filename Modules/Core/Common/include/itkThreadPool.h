@@ -39,14 +39,12 @@
 #include <mach/task_info.h>
 #endif
 
-#include <map>
-#include <set>
-
 #include "itkThreadJob.h"
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkSimpleFastMutexLock.h"
 #include "itkMutexLockHolder.h"
+#include "itkAtomicInt.h"
 
 namespace itk
 {
@@ -55,17 +53,19 @@ namespace itk
 * \class ThreadPool
 * \brief Thread pool manages the threads for itk.
 *
-*  Thread pool is called and initialized from within the MultiThreader.
-*  Initially the thread pool is started with zero threads.
-* Threads are added as job(s) are submitted to the thread pool and if it cannot be
-* executed right away. For example : If the thread pool has three threads and all are
-* busy. If a new job is submitted to the thread pool, the thread pool checks to see if
-* any threads are free. If not, it adds a new thread and executed the job right away.
-* The ThreadJob class is used to submit jobs to the thread pool. The ThreadJob's
-* necessary members need to be set and then the ThreadJob can be passed to the
-* ThreaadPool by calling its AssignWork Method which returns the thread id on which
-* the job is being executed. One can then wait for the job using the thread id and
-* calling the WaitForJob method on the thread pool.
+* Thread pool is called and initialized from within the MultiThreader.
+* Initially the thread pool is started with zero threads. Threads are
+* added as jobs are submitted, so that there is always one thread for
+* every job that is queued or running; once created, the threads persist
+* and wait for further jobs.
+*
+* Jobs are submitted with AddWork(). They are stored in a bounded,
+* lock-free multi-producer/multi-consumer queue, and the idle threads
+* sleep on a single counting semaphore that is posted once per job. A
+* JobBatch groups the jobs of one parallel section: every job decrements
+* the batch counter when it is done, and only the last one wakes the
+* submitter, so that waiting for N jobs costs a single wait.
+*
 * \ingroup OSSystemObjects
 * \ingroup ITKCommon
 */
@@ -96,189 +96,149 @@ public:
    */
   static Pointer GetInstance();
 
-  /** This method is called to assign a job to the thread pool */
-  ThreadProcessIdType AssignWork(ThreadJob worker);
+  /**
+   * \class Semaphore
+   * \brief Counting semaphore on top of the native primitive of the platform.
+   * \ingroup ITKCommon
+   */
+  class ITKCommon_EXPORT Semaphore
+  {
+  public:
+    Semaphore();
+    ~Semaphore();
 
-  /** Can call this method if we want to pre-start maxThreads in the thread pool
-    */
-  void InitializeThreads(ThreadCountType maxThreads);
+    /** Block until the count is positive, then decrement it. */
+    void Wait();
 
-  /** This method blocks until the given (job) id has finished executing */
-  bool WaitForJobOnThreadHandle(ThreadProcessIdType handle);
+    /** Increment the count, waking up one waiting thread. */
+    void Post();
+
+  private:
+    Semaphore(const Semaphore &);       // purposely not implemented
+    void operator=(const Semaphore &);  // purposely not implemented
 
-protected:
-  class ThreadSemaphorePair
-  {
-  public:
-    ThreadSemaphorePair(const ThreadProcessIdType & tph);
-    int SemaphoreWait();
-    int SemaphorePost();
 #if defined(__APPLE__)
-    semaphore_t           m_Semaphore;
+    semaphore_t m_Semaphore;
 #elif defined(_WIN32) || defined(_WIN64)
-    HANDLE               m_Semaphore;
+    HANDLE      m_Semaphore;
 #elif defined(ITK_USE_PTHREADS)
-    sem_t                m_Semaphore;
+    sem_t       m_Semaphore;
 #endif
-
-    ThreadProcessIdType  m_ThreadProcessHandle;
-
-  private:
-    static int m_SemaphoreCount;
-    ThreadSemaphorePair(); //purposefully not implemented.
   };
 
-  ThreadPool();  // Protected so that only the GetThreadPool can create a thread
-                 // pool
-  virtual ~ThreadPool();
-
-private:
-  ThreadPool(ThreadPool const &); // purposely not implemented
+  /**
+   * \class JobBatch
+   * \brief Tracks the completion of a group of jobs submitted together.
+   *
+   * Reset() sets the number of jobs of the batch before they are handed
+   * to AddWork(). Wait() returns once all of them have executed. The
+   * waiting thread sleeps on a semaphore that is posted only by the last
+   * job, so a batch needs a single wake-up whatever its size.
+   * \ingroup ITKCommon
+   */
+  class ITKCommon_EXPORT JobBatch
+  {
+  public:
+    JobBatch();
 
-  ThreadPool & operator=(ThreadPool const &); // purposely not implemented
+    /** Start a new batch of numberOfJobs jobs. Must not be called while
+     * jobs of the previous batch are pending. */
+    void Reset(int32_t numberOfJobs);
 
-  /** Set when the thread pool is to be stopped */
-  bool m_ScheduleForDestruction;
+    /** Called by the thread pool when a job of the batch has executed.
+     * Also used to account for jobs that could not be submitted. */
+    void JobDone();
 
-  /** Maintains count of threads */
-  ThreadCountType m_ThreadCount;
+    /** Block until all jobs of the batch are done. */
+    void Wait();
 
-  /** To lock on m_NumberOfPendingJobsToBeRun */
-  static SimpleFastMutexLock m_NumberOfPendingJobsToBeRunMutex;
+  private:
+    JobBatch(const JobBatch &);        // purposely not implemented
+    void operator=(const JobBatch &);  // purposely not implemented
 
-  /** counter to assign job ids */
-  unsigned int m_IdCounter;
+    int32_t              m_NumberOfJobs;
+    AtomicInt< int32_t > m_PendingJobs;
+    Semaphore            m_Done;
+  };
 
-  /** set if exception occurs */
-  bool m_ExceptionOccurred;
+  /** Queue a job for execution by one of the threads of the pool. If a
+   * batch is given, its JobDone() is called once the job has executed.
+   * Threads are added to the pool as needed, so the job never waits for
+   * another job to finish before it starts. */
+  void AddWork(const ThreadJob & job, JobBatch *batch = ITK_NULLPTR);
 
-  typedef std::map<ThreadJobIdType,ThreadJob> ThreadJobContainerType;
+  /** Can call this method if we want to pre-start maxThreads in the thread pool
+    */
+  void InitializeThreads(ThreadCountType maxThreads);
 
-  typedef std::pair<ThreadJobIdType,ThreadJob>          ThreadJobContainerPairType;
+  /** Return the number of threads currently owned by the pool. */
+  ThreadCountType GetNumberOfThreads() const;
 
-  typedef std::set<ThreadJobIdType>      ThreadJobIdsContainerType;
+protected:
+  ThreadPool();  // Protected so that only the GetThreadPool can create a thread
+                 // pool
+  virtual ~ThreadPool();
 
-  typedef std::set<ThreadProcessIdType>  ThreadProcessIdContainerType;
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
-  /** this is a list of jobs(ThreadJob) submitted to the thread pool
-      this is the only place where the jobs are submitted.
-      We need a worker queue because the thread pool assigns work to a
-      thread which is free. So when a job is submitted, it has to be stored
-      somewhere*/
-  ThreadJobContainerType m_WorkerQueue;
-  /** To lock on m_WorkerQueue */
-  static SimpleFastMutexLock m_WorkerQueueMutex;
+private:
+  ThreadPool(ThreadPool const &); // purposely not implemented
 
-  /** Vector to hold all active thread handles */
-  ThreadProcessIdContainerType m_ThreadHandles;
+  ThreadPool & operator=(ThreadPool const &); // purposely not implemented
 
-  /** Vector of pairs that hold job ids and their corresponding thread handles
-    */
-  enum {
-    JOB_THREADHANDLE_JUST_ADDED=-3, //means thread just added
-    JOB_THREADHANDLE_IS_FREE=-2,    // means this particular threadhandle
-                                    // (thread) is free
-    JOB_THREADHANDLE_IS_DONE=-1     // means the thread finished with the
-                                    // assigned job and is waiting until
-                                    // WaitForJobOnThreadHandle method is called
-                                    // otherwise threadhandle is actively
-                                    // running a job.
-    };
+  /** Number of cells of the job queue, a power of two. AddWork() yields
+   * while the queue is full. */
+  itkStaticConstMacro(QueueCapacity, uint32_t, 1024);
 
-  /**
-   * \class ThreadProcessIdentifiers
-   * \ingroup ITKCommon
-   * This provides an association between the internal
-   * thread id, the PThreads/Win Thread Id, and on Windows,
-   * the DWORD thread Id.
-   */
-  class ThreadProcessIdentifiers
+  /** A cell of the bounded MPMC queue (D. Vyukov's algorithm). The
+   * sequence number tells producers and consumers whether the cell is
+   * free for the enqueue position or holds the job for the dequeue
+   * position; a single compare-and-swap on the position claims it. */
+  struct QueueCell
   {
-public:
-#if defined(ITK_USE_WIN32_THREADS)
-    typedef DWORD WinThreadIdType;
-#else
-    typedef unsigned long WinThreadIdType;
-#endif
-    ThreadProcessIdentifiers(const int tnid,
-                            const ThreadProcessIdType tph,
-                            const WinThreadIdType winThreadId) :
-      m_ThreadNumericId(tnid),
-      m_ThreadProcessHandle(tph),
-      m_WinThreadId(winThreadId)
-    {
-    }
-
-    int                 m_ThreadNumericId;
-    ThreadProcessIdType m_ThreadProcessHandle;
-    WinThreadIdType     m_WinThreadId;
-private:
-    ThreadProcessIdentifiers(); //purposefully not implemented.
+    AtomicInt< uint32_t > m_Sequence;
+    ThreadJob             m_Job;
+    JobBatch             *m_Batch;
   };
 
-  // the ThreadProcessIdentifiersVector ThreadSemHandlePairingQueue and
-  // ThreadSemHandlePairingForWaitQueue really want to be STL
-  // containers with more efficient searchability than O(N) But the
-  // pthread_t type isn't guaranteed to be an integral type so it
-  // can't be used as a Key on a keyed STL container.
-  typedef std::vector<ThreadProcessIdentifiers> ThreadProcessIdentifiersVecType;
-  ThreadProcessIdentifiersVecType m_ThreadProcessIdentifiersVector;
-
-  //ThreadSemaphorePair *m_ThreadSemHandlePairingQueue;
-  typedef std::vector<ThreadSemaphorePair *> ThreadSemHandlePairingQueueType;
-
-  ThreadSemHandlePairingQueueType m_ThreadSemHandlePairingQueue;
-  ThreadSemHandlePairingQueueType m_ThreadSemHandlePairingForWaitQueue;
-
-  /** To lock on the vectors */
-  static SimpleFastMutexLock m_ThreadProcessIdentifiersVectorMutex;
-
-  /** This function is called by the threads to get jobs to be executed.
-      This method is the "first" call from the threads in the thread pool.
-      Now this method blocks the thread until a job is available for the thread to execute.
-      Once a job is available(known from m_ThreadProcessIdentifiersVector), it gets it from the worker queue and
-      returns it   */
-  const ThreadJob &FetchWork(ThreadProcessIdType t);
-
-  /** Used to remove an active job id from the queue because it is done.
-      This method is called by the threads once they are done with the job.
-      This method removes the job id from m_ActiveJobIds, marks the thread as free
-      by setting appropriate values in the m_ThreadProcessIdentifiersVector vector and removes the
-      job from m_WorkerQueue  */
-  void RemoveActiveId(ThreadJobIdType id);
-
-  /** Called to add a thread to the thread pool.
-      This method add a thread to the thread pool and pushes the thread handle
-      into the m_ThreadHandles set*/
-  void AddThread();
+  /** Try to append a job, returning false if the queue is full. */
+  bool Enqueue(const ThreadJob & job, JobBatch *batch);
 
-  /** To check if the thread pool has to add a thread.
-      This method checks if any threads in the thread pool
-      are free. If so, it returns false else returns true */
-  ThreadProcessIdentifiers *FindThreadToRun();
+  /** Try to take the oldest job, returning false if none is published. */
+  bool Dequeue(ThreadJob & job, JobBatch * & batch);
 
-  static Pointer m_ThreadPoolInstance;
-  /** To lock on m_ThreadPoolInstance */
-  static SimpleFastMutexLock m_ThreadPoolInstanceMutex;
+  /** Called to add a thread to the thread pool. */
+  void AddThread();
 
-  ThreadSemaphorePair* GetSemaphore(ThreadSemHandlePairingQueueType &q,ThreadProcessIdType threadHandle);
+  /** Give up the processor while waiting on another thread. */
+  static void YieldThread();
 
-  ThreadSemaphorePair* GetSemaphoreForThread(ThreadProcessIdType threadHandle);
+  /** thread function */
+  static void * ThreadExecute(void *param);
 
-  ThreadSemaphorePair* GetSemaphoreForThreadWait(ThreadProcessIdType threadHandle);
+  QueueCell             m_Queue[QueueCapacity];
+  AtomicInt< uint32_t > m_EnqueuePosition;
+  AtomicInt< uint32_t > m_DequeuePosition;
 
-  void DeallocateThreadSemSet(ThreadSemHandlePairingQueueType &q);
+  /** Posted once for every queued job */
+  Semaphore m_JobsAvailable;
 
-  /** thread function */
-  static void * ThreadExecute(void *param);
+  /** Jobs that are queued or running. The pool grows whenever this
+   * exceeds the number of threads. */
+  AtomicInt< int32_t > m_ActiveJobs;
 
-  /** Method to compare thread handles - true for same false for different */
-  static bool CompareThreadHandles(ThreadProcessIdType t1, ThreadProcessIdType t2);
+  /** Maintains count of threads */
+  AtomicInt< int32_t > m_ThreadCount;
 
-  /** Used under windows - gets the thread handle associated with thread id */
-  ThreadProcessIdType GetThreadHandleForThreadId(ThreadIdType id);
+  /** To serialize the creation of threads */
+  SimpleFastMutexLock m_AddThreadMutex;
 
+  /** Set when the thread pool is to be stopped */
+  bool m_ScheduleForDestruction;
 
+  static Pointer m_ThreadPoolInstance;
+  /** To lock on m_ThreadPoolInstance */
+  static SimpleFastMutexLock m_ThreadPoolInstanceMutex;
 };
 
 }
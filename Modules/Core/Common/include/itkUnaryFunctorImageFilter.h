@@ -20,6 +20,8 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkPixelwiseFusionStage.h"
+#include <vector>
 
 namespace itk
 {
@@ -35,7 +37,18 @@ namespace itk
  * UnaryFunctorImageFilter (like the CastImageFilter) can be used
  * to promote a 2D image to a 3D image, etc.
  *
+ * When the input and output are itk::Image of arithmetic pixel types,
+ * the functor is applied to whole scanlines by a loop vectorized with
+ * the instructions selected at run time by SIMDInstructionSet.
+ *
+ * When the input is the output of another pixel-wise filter which has
+ * its PixelwiseFusion flag on, the upstream filter is fused: its output
+ * scanlines are computed on demand instead of being stored in an
+ * intermediate image. Subclasses are fused only when they override
+ * IsPixelwise() to return true.
+ *
  * \sa BinaryFunctorImageFilter TernaryFunctorImageFilter
+ * \sa ScanlineFunctorKernels PixelwiseFusionStage
  *
  * \ingroup   IntensityImageFilters     MultiThreaded
  * \ingroup ITKCommon
@@ -45,7 +58,8 @@ namespace itk
  * \endwiki
  */
 template< typename TInputImage, typename TOutputImage, typename TFunction >
-class UnaryFunctorImageFilter:public InPlaceImageFilter< TInputImage, TOutputImage >
+class UnaryFunctorImageFilter:public InPlaceImageFilter< TInputImage, TOutputImage >,
+  public PixelwiseFusionStage< TOutputImage::ImageDimension >
 {
 public:
   /** Standard class typedefs. */
@@ -95,10 +109,55 @@ public:
       }
   }
 
+  /** Set/Get whether the filter may be fused into the pixel-wise filter
+   * which consumes its output. The fused filter does not execute: it
+   * invokes no StartEvent, ProgressEvent or EndEvent, and its output is
+   * left released, so that it executes normally if its output is then
+   * requested by another filter. Off by default.
+   * \sa PixelwiseFusionStage */
+  itkSetMacro(PixelwiseFusion, bool);
+  itkGetConstMacro(PixelwiseFusion, bool);
+  itkBooleanMacro(PixelwiseFusion);
+
+  /** The filter does not run in place while it fuses its input. */
+  virtual bool CanRunInPlace() const ITK_OVERRIDE;
+
 protected:
   UnaryFunctorImageFilter();
   virtual ~UnaryFunctorImageFilter() {}
 
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  typedef PixelwiseFusionStage< TOutputImage::ImageDimension > FusionStageType;
+  typedef PixelwiseFusionStage< TInputImage::ImageDimension >  InputFusionStageType;
+
+  /** Whether each output pixel only depends on the input pixel at the
+   * same index, through the functor, so that the filter can be fused.
+   * True for UnaryFunctorImageFilter itself. Subclasses which compute
+   * with the whole input, like RescaleIntensityImageFilter, or which
+   * override ThreadedGenerateData(), must not return true. */
+  virtual bool IsPixelwise() const;
+
+  /** Whether the input is fused during the current execution. */
+  bool HasFusedInput() const
+  {
+    return m_FusedInput != ITK_NULLPTR;
+  }
+
+  /** Fuse the input when possible, and update it otherwise. */
+  virtual void UpdateInputs() ITK_OVERRIDE;
+
+  /** Prepare the fused input around the execution. */
+  virtual void GenerateData() ITK_OVERRIDE;
+
+  /** PixelwiseFusionStage interface. */
+  virtual bool CanBeFused() const ITK_OVERRIDE;
+  virtual void UpdateFusedInputs() ITK_OVERRIDE;
+  virtual void PrepareFusedExecution(ThreadIdType numberOfThreads, SizeValueType maximumLength) ITK_OVERRIDE;
+  virtual void GenerateFusedScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                                     void *scanline, ThreadIdType threadId) ITK_OVERRIDE;
+  virtual void FinishFusedExecution() ITK_OVERRIDE;
+
   /** UnaryFunctorImageFilter can produce an image which is a different
    * resolution than its input image.  As such, UnaryFunctorImageFilter
    * needs to provide an implementation for
@@ -126,7 +185,18 @@ private:
   UnaryFunctorImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);          //purposely not implemented
 
+  void PrepareFusedInput(ThreadIdType numberOfThreads, SizeValueType maximumLength);
+
+  void FinishFusedInput();
+
+  void GenerateScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                        OutputImagePixelType *scanline, ThreadIdType threadId);
+
   FunctorType m_Functor;
+
+  bool                                              m_PixelwiseFusion;
+  InputFusionStageType *                            m_FusedInput;
+  std::vector< std::vector< InputImagePixelType > > m_FusedInputScanlines;
 };
 } // end namespace itk
 
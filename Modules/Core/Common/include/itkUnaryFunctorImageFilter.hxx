@@ -20,7 +20,9 @@
 
 #include "itkUnaryFunctorImageFilter.h"
 #include "itkImageScanlineIterator.h"
+#include "itkScanlineFunctorKernels.h"
 #include "itkProgressReporter.h"
+#include <typeinfo>
 
 namespace itk
 {
@@ -29,7 +31,9 @@ namespace itk
  */
 template< typename TInputImage, typename TOutputImage, typename TFunction  >
 UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
-::UnaryFunctorImageFilter()
+::UnaryFunctorImageFilter() :
+  m_PixelwiseFusion(false),
+  m_FusedInput(ITK_NULLPTR)
 {
   this->SetNumberOfRequiredInputs(1);
   this->InPlaceOff();
@@ -170,6 +174,29 @@ UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
   const size_t numberOfLinesToProcess = outputRegionForThread.GetNumberOfPixels() / regionSize[0];
   ProgressReporter progress( this, threadId, numberOfLinesToProcess );
 
+  // The scanlines of a fused input are computed by the upstream filter
+  if ( m_FusedInput )
+    {
+    ImageScanlineConstIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
+    while ( !outputIt.IsAtEnd() )
+      {
+      this->GenerateScanline( outputIt.GetIndex(), regionSize[0],
+                              ScanlineImageTraits< TOutputImage >::GetScanline( outputPtr, outputIt.GetIndex() ),
+                              threadId );
+      outputIt.NextLine();
+      progress.CompletedPixel(); // potential exception thrown here
+      }
+    return;
+    }
+
+  // Contiguous scanlines of arithmetic pixels are processed by a
+  // vectorized loop
+  if ( ScanlineFunctorKernels::Unary( m_Functor, inputPtr, inputRegionForThread,
+                                      outputPtr, outputRegionForThread, progress ) )
+    {
+    return;
+    }
+
   // Define the iterators
   ImageScanlineConstIterator< TInputImage > inputIt(inputPtr, inputRegionForThread);
   ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
@@ -189,6 +216,201 @@ UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
     progress.CompletedPixel();  // potential exception thrown here
     }
 }
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+bool
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::CanRunInPlace() const
+{
+  return Superclass::CanRunInPlace() && m_FusedInput == ITK_NULLPTR;
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+bool
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::IsPixelwise() const
+{
+  return typeid( *this ) == typeid( Self );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+bool
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::CanBeFused() const
+{
+  return (unsigned int)Superclass::InputImageDimension == (unsigned int)Superclass::OutputImageDimension
+         && ScanlineImageTraits< TInputImage >::IsContiguousArithmetic
+         && ScanlineImageTraits< TOutputImage >::IsContiguousArithmetic
+         && this->IsPixelwise();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::UpdateInputs()
+{
+  m_FusedInput = ITK_NULLPTR;
+  if ( this->CanBeFused() )
+    {
+    m_FusedInput = InputFusionStageType::GetFusableSource( this->ProcessObject::GetInput(0) );
+    }
+  if ( !m_FusedInput )
+    {
+    Superclass::UpdateInputs();
+    return;
+    }
+
+  try
+    {
+    // the other inputs, like the thresholds of BinaryThresholdImageFilter,
+    // are updated as usual
+    const typename Superclass::NameArray names = this->GetInputNames();
+    for ( typename Superclass::NameArray::const_iterator it = names.begin(); it != names.end(); ++it )
+      {
+      DataObject *input = this->ProcessObject::GetInput(*it);
+      if ( input && input != this->ProcessObject::GetInput(0) )
+        {
+        input->PropagateRequestedRegion();
+        input->UpdateOutputData();
+        }
+      }
+    m_FusedInput->UpdateFusedInputs();
+    }
+  catch ( ... )
+    {
+    this->FinishFusedInput();
+    throw;
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::GenerateData()
+{
+  if ( !m_FusedInput )
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  // the fused input is released even if the execution fails
+  try
+    {
+    this->PrepareFusedInput( this->GetNumberOfThreads(), this->GetOutput()->GetRequestedRegion().GetSize(0) );
+    Superclass::GenerateData();
+    }
+  catch ( ... )
+    {
+    this->FinishFusedInput();
+    throw;
+    }
+  this->FinishFusedInput();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::UpdateFusedInputs()
+{
+  this->UpdateInputs();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::PrepareFusedExecution(ThreadIdType numberOfThreads, SizeValueType maximumLength)
+{
+  this->PrepareFusedInput(numberOfThreads, maximumLength);
+  // the functor may be set up from the parameters of the filter
+  this->BeforeThreadedGenerateData();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::GenerateFusedScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                        void *scanline, ThreadIdType threadId)
+{
+  this->GenerateScanline( index, length, static_cast< OutputImagePixelType * >( scanline ), threadId );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::FinishFusedExecution()
+{
+  this->FinishFusedInput();
+  this->ProcessObject::ReleaseInputs();
+  // the output was not generated: mark it released, so that it is
+  // updated normally when another consumer requests it
+  this->GetOutput()->ReleaseData();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::PrepareFusedInput(ThreadIdType numberOfThreads, SizeValueType maximumLength)
+{
+  if ( m_FusedInput )
+    {
+    m_FusedInput->PrepareFusedExecution(numberOfThreads, maximumLength);
+    m_FusedInputScanlines.assign( numberOfThreads, std::vector< InputImagePixelType >(maximumLength) );
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::FinishFusedInput()
+{
+  if ( m_FusedInput )
+    {
+    m_FusedInput->FinishFusedExecution();
+    m_FusedInput = ITK_NULLPTR;
+    std::vector< std::vector< InputImagePixelType > >().swap(m_FusedInputScanlines);
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::GenerateScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                   OutputImagePixelType *scanline, ThreadIdType threadId)
+{
+  // the dimensions match when the filter is fused
+  typename TInputImage::IndexType inputIndex;
+  inputIndex.Fill(0);
+  for ( unsigned int i = 0; i < Superclass::InputImageDimension && i < Superclass::OutputImageDimension; ++i )
+    {
+    inputIndex[i] = index[i];
+    }
+
+  const InputImagePixelType *input;
+  if ( m_FusedInput )
+    {
+    InputImagePixelType *inputScanline = &m_FusedInputScanlines[threadId][0];
+    m_FusedInput->GenerateFusedScanline(inputIndex, length, inputScanline, threadId);
+    input = inputScanline;
+    }
+  else
+    {
+    input = ScanlineImageTraits< TInputImage >::GetScanline(this->GetInput(), inputIndex);
+    }
+
+  void ( *line )(FunctorType &, const InputImagePixelType *, OutputImagePixelType *, SizeValueType);
+  ScanlineFunctorKernels::SelectUnaryLine(line);
+  line(m_Functor, input, scanline, length);
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunction >
+void
+UnaryFunctorImageFilter< TInputImage, TOutputImage, TFunction >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "PixelwiseFusion: " << ( m_PixelwiseFusion ? "On" : "Off" ) << std::endl;
+}
 } // end namespace itk
 
 #endif
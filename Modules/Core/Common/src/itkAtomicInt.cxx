@@ -151,6 +151,21 @@ int64_t AtomicOps<8>::PostDecrement(AtomicType *ref)
 #endif
 }
 
+int64_t AtomicOps<8>::CompareAndSwap(AtomicType *ref, int64_t expected, int64_t desired)
+{
+#if defined(ITK_WINDOWS_ATOMICS_64)
+  return InterlockedCompareExchange64(ref, desired, expected);
+#else
+  MutexLockHolder<SimpleFastMutexLock> mutexHolder(*ref->mutex);
+  const int64_t current = ref->var;
+  if( current == expected )
+    {
+    ref->var = desired;
+    }
+  return current;
+#endif
+}
+
 int64_t AtomicOps<8>::Load(const AtomicType *ref)
 {
 #if defined(ITK_WINDOWS_ATOMICS_64)
@@ -248,6 +263,21 @@ int32_t AtomicOps<4>::PostDecrement(AtomicType *ref)
 #endif
 }
 
+int32_t AtomicOps<4>::CompareAndSwap(AtomicType *ref, int32_t expected, int32_t desired)
+{
+#if defined(ITK_WINDOWS_ATOMICS_32)
+  return InterlockedCompareExchange(reinterpret_cast<long*>(ref), desired, expected);
+#else
+  MutexLockHolder<SimpleFastMutexLock> mutexHolder(*ref->mutex);
+  const int32_t current = ref->var;
+  if( current == expected )
+    {
+    ref->var = desired;
+    }
+  return current;
+#endif
+}
+
 int32_t AtomicOps<4>::Load(const AtomicType *ref)
 {
 #if defined(ITK_WINDOWS_ATOMICS_32)
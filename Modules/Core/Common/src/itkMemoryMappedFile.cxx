@@ -0,0 +1,172 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkMemoryMappedFile.h"
+
+#if defined( _WIN32 )
+#include "itkWindows.h"
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+MemoryMappedFile::MemoryMappedFile() :
+  m_View(ITK_NULLPTR),
+  m_ViewLength(0),
+  m_Pointer(ITK_NULLPTR),
+  m_Length(0),
+  m_MappingMode(ReadOnly)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Unmap();
+}
+
+void
+MemoryMappedFile
+::Map(const std::string & fileName, OffsetType offset, LengthType length, MappingModeType mode)
+{
+  this->Unmap();
+
+  if ( length == 0 )
+    {
+    itkExceptionMacro( "Cannot map an empty range of " << fileName );
+    }
+
+#if defined( _WIN32 )
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  // views must start on a multiple of the allocation granularity
+  const OffsetType viewOffset = offset - offset % systemInfo.dwAllocationGranularity;
+  const LengthType viewLength = length + ( offset - viewOffset );
+
+  HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, ITK_NULLPTR,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, ITK_NULLPTR);
+  if ( file == INVALID_HANDLE_VALUE )
+    {
+    itkExceptionMacro( "Cannot open " << fileName << " for mapping" );
+    }
+  LARGE_INTEGER fileSize;
+  if ( !GetFileSizeEx(file, &fileSize)
+       || static_cast< OffsetType >( fileSize.QuadPart ) < offset + length )
+    {
+    CloseHandle(file);
+    itkExceptionMacro( "File " << fileName << " is too short to map "
+                       << length << " bytes at offset " << offset );
+    }
+
+  // the mapping object and the view keep the file open
+  HANDLE mapping = CreateFileMappingA(file, ITK_NULLPTR,
+                                      mode == CopyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY,
+                                      0, 0, ITK_NULLPTR);
+  CloseHandle(file);
+  if ( mapping == ITK_NULLPTR )
+    {
+    itkExceptionMacro( "Cannot create a mapping of " << fileName );
+    }
+  void *view = MapViewOfFile(mapping,
+                             mode == CopyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ,
+                             static_cast< DWORD >( viewOffset >> 32 ),
+                             static_cast< DWORD >( viewOffset & 0xFFFFFFFF ),
+                             static_cast< SIZE_T >( viewLength ));
+  CloseHandle(mapping);
+  if ( view == ITK_NULLPTR )
+    {
+    itkExceptionMacro( "Cannot map " << length << " bytes of " << fileName
+                       << " at offset " << offset );
+    }
+#else
+  // mmap requires an offset multiple of the page size
+  const OffsetType pageSize = static_cast< OffsetType >( sysconf(_SC_PAGESIZE) );
+  const OffsetType viewOffset = offset - offset % pageSize;
+  const LengthType viewLength = length + ( offset - viewOffset );
+
+  const int file = open(fileName.c_str(), O_RDONLY);
+  if ( file < 0 )
+    {
+    itkExceptionMacro( "Cannot open " << fileName << " for mapping" );
+    }
+  // accessing a page beyond the end of the file raises SIGBUS
+  struct stat fileStatus;
+  if ( fstat(file, &fileStatus) != 0
+       || static_cast< OffsetType >( fileStatus.st_size ) < offset + length )
+    {
+    close(file);
+    itkExceptionMacro( "File " << fileName << " is too short to map "
+                       << length << " bytes at offset " << offset );
+    }
+
+  // the mapping keeps a reference to the file
+  void *view = mmap(ITK_NULLPTR, static_cast< size_t >( viewLength ),
+                    mode == CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ,
+                    mode == CopyOnWrite ? MAP_PRIVATE : MAP_SHARED,
+                    file, static_cast< off_t >( viewOffset ));
+  close(file);
+  if ( view == MAP_FAILED )
+    {
+    itkExceptionMacro( "Cannot map " << length << " bytes of " << fileName
+                       << " at offset " << offset );
+    }
+#endif
+
+  m_View = view;
+  m_ViewLength = viewLength;
+  m_Pointer = static_cast< char * >( view ) + ( offset - viewOffset );
+  m_Length = length;
+  m_MappingMode = mode;
+  m_FileName = fileName;
+}
+
+void
+MemoryMappedFile
+::Unmap()
+{
+  if ( m_View )
+    {
+#if defined( _WIN32 )
+    UnmapViewOfFile(m_View);
+#else
+    munmap(m_View, static_cast< size_t >( m_ViewLength ));
+#endif
+    }
+  m_View = ITK_NULLPTR;
+  m_ViewLength = 0;
+  m_Pointer = ITK_NULLPTR;
+  m_Length = 0;
+  m_FileName = "";
+}
+
+void
+MemoryMappedFile
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FileName: " << m_FileName << std::endl;
+  os << indent << "Pointer: " << m_Pointer << std::endl;
+  os << indent << "Length: " << m_Length << std::endl;
+  os << indent << "MappingMode: "
+     << ( m_MappingMode == CopyOnWrite ? "CopyOnWrite" : "ReadOnly" ) << std::endl;
+}
+} // end namespace itk
@@ -243,6 +243,8 @@ MultiThreader::MultiThreader() :
   for( ThreadIdType i = 0; i < ITK_MAX_THREADS; ++i )
     {
     m_ThreadInfoArray[i].ThreadID           = i;
+    m_ThreadInfoArray[i].WorkUnitID         = i;
+    m_ThreadInfoArray[i].NumberOfWorkUnits  = 0;
     m_ThreadInfoArray[i].ActiveFlag         = ITK_NULLPTR;
     m_ThreadInfoArray[i].ActiveFlagLock     = ITK_NULLPTR;
 
@@ -252,10 +254,16 @@ MultiThreader::MultiThreader() :
     m_SpawnedThreadActiveFlag[i]            = 0;
     m_SpawnedThreadActiveFlagLock[i]        = ITK_NULLPTR;
     m_SpawnedThreadInfoArray[i].ThreadID    = i;
+    m_SpawnedThreadInfoArray[i].WorkUnitID  = 0;
+    m_SpawnedThreadInfoArray[i].NumberOfWorkUnits = 1;
+
+    m_WorkUnitRanges[i].Begin               = 0;
+    m_WorkUnitRanges[i].End                 = 0;
     }
 
   m_SingleMethod = ITK_NULLPTR;
   m_SingleData = ITK_NULLPTR;
+  m_NumberOfWorkUnits = 0;
   m_NumberOfThreads = this->GetGlobalDefaultNumberOfThreads();
 
 }
@@ -270,6 +278,15 @@ void MultiThreader::SetSingleMethod(ThreadFunctionType f, void *data)
 {
   m_SingleMethod = f;
   m_SingleData   = data;
+
+  // A new SingleMethod is not necessarily aware of work units, so fall
+  // back to one invocation per thread until work units are requested.
+  m_NumberOfWorkUnits = 0;
+}
+
+void MultiThreader::SetNumberOfWorkUnits(ThreadIdType numberOfWorkUnits)
+{
+  m_NumberOfWorkUnits = numberOfWorkUnits;
 }
 
 // Set one of the user defined methods that will be run on NumberOfThreads
@@ -304,6 +321,19 @@ void MultiThreader::SingleMethodExecute()
   // obey the global maximum number of threads limit
   m_NumberOfThreads = vcl_min( m_GlobalMaximumNumberOfThreads, m_NumberOfThreads );
 
+  // When over-decomposed, give each thread a contiguous share of the
+  // work units to start with; the remainder is balanced by stealing.
+  if( m_NumberOfWorkUnits > m_NumberOfThreads )
+    {
+    for( thread_loop = 0; thread_loop < m_NumberOfThreads; ++thread_loop )
+      {
+      m_WorkUnitRanges[thread_loop].Begin = static_cast< ThreadIdType >(
+        static_cast< SizeValueType >( thread_loop ) * m_NumberOfWorkUnits / m_NumberOfThreads );
+      m_WorkUnitRanges[thread_loop].End = static_cast< ThreadIdType >(
+        static_cast< SizeValueType >( thread_loop + 1 ) * m_NumberOfWorkUnits / m_NumberOfThreads );
+      }
+    }
+
   // Spawn a set of threads through the SingleMethodProxy. Exceptions
   // thrown from a thread will be caught by the SingleMethodProxy. A
   // naive mechanism is in place for determining whether a thread
@@ -313,13 +343,15 @@ void MultiThreader::SingleMethodExecute()
   // exceptions thrown by threads.
   bool        exceptionOccurred = false;
   std::string exceptionDetails;
+  if( m_UseThreadPool )
+    {
+    m_ThreadPoolJobBatch.Reset( m_NumberOfThreads - 1 );
+    }
   try
     {
     for( thread_loop = 1; thread_loop < m_NumberOfThreads; ++thread_loop )
       {
-      m_ThreadInfoArray[thread_loop].UserData    = m_SingleData;
-      m_ThreadInfoArray[thread_loop].NumberOfThreads = m_NumberOfThreads;
-      m_ThreadInfoArray[thread_loop].ThreadFunction = m_SingleMethod;
+      this->InitializeSingleMethodThreadInfo(m_ThreadInfoArray[thread_loop]);
 
       process_id[thread_loop] =
         this->DispatchSingleMethodThread(&m_ThreadInfoArray[thread_loop]);
@@ -339,20 +371,31 @@ void MultiThreader::SingleMethodExecute()
     // threads are correctly cleaned
     exceptionOccurred = true;
     }
+  if( m_UseThreadPool )
+    {
+    // Jobs that could not be handed to the pool will never complete
+    for( ThreadIdType notDispatched = thread_loop; notDispatched < m_NumberOfThreads; ++notDispatched )
+      {
+      m_ThreadPoolJobBatch.JobDone();
+      }
+    }
 
   // Now, the parent thread calls this->SingleMethod() itself
   //
   //
   try
     {
-    m_ThreadInfoArray[0].UserData = m_SingleData;
-    m_ThreadInfoArray[0].NumberOfThreads = m_NumberOfThreads;
-    m_SingleMethod( (void *)( &m_ThreadInfoArray[0] ) );
+    this->InitializeSingleMethodThreadInfo(m_ThreadInfoArray[0]);
+    ( *m_ThreadInfoArray[0].ThreadFunction )( (void *)( &m_ThreadInfoArray[0] ) );
     }
   catch( ProcessAborted & )
     {
     // Need cleanup and rethrow ProcessAborted
     // close down other threads
+    if( m_UseThreadPool )
+      {
+      m_ThreadPoolJobBatch.Wait();
+      }
     for( thread_loop = 1; thread_loop < m_NumberOfThreads; ++thread_loop )
       {
       try
@@ -381,7 +424,12 @@ void MultiThreader::SingleMethodExecute()
     exceptionOccurred = true;
     }
   // The parent thread has finished this->SingleMethod() - so now it
-  // waits for each of the other processes to exit
+  // waits for each of the other processes to exit. The jobs handed to
+  // the thread pool are all waited for at once.
+  if( m_UseThreadPool )
+    {
+    m_ThreadPoolJobBatch.Wait();
+    }
   for( thread_loop = 1; thread_loop < m_NumberOfThreads; ++thread_loop )
     {
     try
@@ -456,6 +504,117 @@ MultiThreader
   return ITK_THREAD_RETURN_VALUE;
 }
 
+void
+MultiThreader
+::InitializeSingleMethodThreadInfo(ThreadInfoStruct & threadInfo)
+{
+  threadInfo.NumberOfThreads = m_NumberOfThreads;
+  if( m_NumberOfWorkUnits > m_NumberOfThreads )
+    {
+    // The proxy finds the SingleMethod and its data through the threader
+    threadInfo.UserData = this;
+    threadInfo.ThreadFunction = &MultiThreader::WorkStealingProxy;
+    threadInfo.WorkUnitID = threadInfo.ThreadID;
+    threadInfo.NumberOfWorkUnits = m_NumberOfWorkUnits;
+    }
+  else
+    {
+    threadInfo.UserData = m_SingleData;
+    threadInfo.ThreadFunction = m_SingleMethod;
+    threadInfo.WorkUnitID = threadInfo.ThreadID;
+    threadInfo.NumberOfWorkUnits = m_NumberOfThreads;
+    }
+}
+
+ITK_THREAD_RETURN_TYPE
+MultiThreader
+::WorkStealingProxy(void *arg)
+{
+  const MultiThreader::ThreadInfoStruct *threadInfoStruct =
+    reinterpret_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  MultiThreader *threader = reinterpret_cast< MultiThreader * >( threadInfoStruct->UserData );
+
+  // The SingleMethod sees the user data, not the threader
+  MultiThreader::ThreadInfoStruct workUnitInfo = *threadInfoStruct;
+  workUnitInfo.UserData = threader->m_SingleData;
+  workUnitInfo.ThreadFunction = threader->m_SingleMethod;
+
+  // Exceptions are left to the caller: the remaining work units of a
+  // failing thread are stolen by the others.
+  while( threader->GetNextWorkUnit(workUnitInfo.ThreadID, workUnitInfo.WorkUnitID) )
+    {
+    ( *workUnitInfo.ThreadFunction )( (void *)( &workUnitInfo ) );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+bool
+MultiThreader
+::GetNextWorkUnit(ThreadIdType threadId, ThreadIdType & workUnit)
+{
+  WorkUnitRange & ownRange = m_WorkUnitRanges[threadId];
+
+    {
+    MutexLockHolder< SimpleFastMutexLock > lock(ownRange.Lock);
+    if( ownRange.Begin < ownRange.End )
+      {
+      workUnit = ownRange.Begin++;
+      return true;
+      }
+    }
+
+  // Only one lock is held at any time, so threads stealing from each
+  // other cannot deadlock. The scan is repeated if another thief emptied
+  // the chosen victim in between.
+  while( true )
+    {
+    ThreadIdType victim = threadId;
+    ThreadIdType mostRemaining = 0;
+    for( ThreadIdType t = 0; t < m_NumberOfThreads; ++t )
+      {
+      if( t == threadId )
+        {
+        continue;
+        }
+      MutexLockHolder< SimpleFastMutexLock > lock(m_WorkUnitRanges[t].Lock);
+      const ThreadIdType remaining = m_WorkUnitRanges[t].End - m_WorkUnitRanges[t].Begin;
+      if( remaining > mostRemaining )
+        {
+        mostRemaining = remaining;
+        victim = t;
+        }
+      }
+    if( mostRemaining == 0 )
+      {
+      return false;
+      }
+
+    ThreadIdType stolenBegin;
+    ThreadIdType stolenEnd;
+      {
+      WorkUnitRange & victimRange = m_WorkUnitRanges[victim];
+      MutexLockHolder< SimpleFastMutexLock > lock(victimRange.Lock);
+      const ThreadIdType remaining = victimRange.End - victimRange.Begin;
+      if( remaining == 0 )
+        {
+        continue;
+        }
+      // Take the upper half, leaving the victim the work units next to
+      // the one it is currently processing.
+      stolenEnd = victimRange.End;
+      stolenBegin = victimRange.End - ( remaining + 1 ) / 2;
+      victimRange.End = stolenBegin;
+      }
+
+    MutexLockHolder< SimpleFastMutexLock > lock(ownRange.Lock);
+    ownRange.Begin = stolenBegin + 1;
+    ownRange.End = stolenEnd;
+    workUnit = stolenBegin;
+    return true;
+    }
+}
+
 ThreadProcessIdType
 MultiThreader
 ::DispatchSingleMethodThread(ThreadInfoStruct *info)
@@ -471,11 +630,9 @@ void
 MultiThreader
 ::WaitForSingleMethodThread(ThreadProcessIdType threadHandle)
 {
-  if(this->m_UseThreadPool)
-    {
-    this->ThreadPoolWaitForSingleMethodThread(threadHandle);
-    }
-  else
+  // Jobs handed to the thread pool are waited for as a batch by
+  // SingleMethodExecute()
+  if( !this->m_UseThreadPool )
     {
     this->SpawnWaitForSingleMethodThread(threadHandle);
     }
@@ -487,6 +644,7 @@ void MultiThreader::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Thread Count: " << m_NumberOfThreads << "\n";
+  os << indent << "Number Of Work Units: " << m_NumberOfWorkUnits << "\n";
   os << indent << "Global Maximum Number Of Threads: "
      << m_GlobalMaximumNumberOfThreads << std::endl;
   os << indent << "Global Default Number Of Threads: "
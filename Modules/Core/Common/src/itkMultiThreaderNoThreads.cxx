@@ -126,14 +126,6 @@ void MultiThreader::TerminateThread(ThreadIdType ThreadID)
   m_SpawnedThreadActiveFlagLock[ThreadID] = 0;
 }
 
-void
-MultiThreader
-::ThreadPoolWaitForSingleMethodThread(ThreadProcessIdType threadHandle)
-{
-  // No threading library specified.  Do nothing.  No joining or waiting
-  // necessary.
-}
-
 ThreadProcessIdType
 MultiThreader
 ::ThreadPoolDispatchSingleMethodThread(MultiThreader::ThreadInfoStruct *threadInfo)
@@ -210,25 +210,16 @@ void MultiThreader::TerminateThread(ThreadIdType ThreadID)
   m_SpawnedThreadActiveFlagLock[ThreadID] = ITK_NULLPTR;
 }
 
-void
-MultiThreader
-::ThreadPoolWaitForSingleMethodThread(ThreadProcessIdType threadHandle)
-{
-  itkDebugMacro(<<  std::endl << "For wait : threadhandle :" << threadHandle << std::endl );
-  m_ThreadPool->WaitForJobOnThreadHandle(threadHandle);
-}
-
 ThreadProcessIdType
 MultiThreader
 ::ThreadPoolDispatchSingleMethodThread(MultiThreader::ThreadInfoStruct *threadInfo)
 {
-
   ThreadJob threadJob;
   threadJob.m_ThreadFunction =  reinterpret_cast<c_void_cast>(this->SingleMethodProxy);
   threadJob.m_UserData = (void *) threadInfo;
-  ThreadProcessIdType returnHandle = m_ThreadPool->AssignWork(threadJob);
-  itkDebugMacro(<< std::endl << "Got handle :" << returnHandle );
-  return returnHandle;
+  m_ThreadPool->AddWork(threadJob, &m_ThreadPoolJobBatch);
+  // The pool has no per-job handle; the job is waited for through the batch
+  return ThreadProcessIdType();
 }
 
 void
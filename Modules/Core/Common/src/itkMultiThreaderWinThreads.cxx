@@ -175,15 +175,6 @@ void MultiThreader::TerminateThread(ThreadIdType ThreadID)
   m_SpawnedThreadActiveFlagLock[ThreadID] = 0;
 }
 
-void
-MultiThreader
-::ThreadPoolWaitForSingleMethodThread(ThreadProcessIdType threadHandle)
-{
-  // We are now using thread pool
-  itkDebugMacro(<<  std::endl << "For wait : threadhandle :" << threadHandle << std::endl );
-  m_ThreadPool->WaitForJobOnThreadHandle(threadHandle);
-}
-
 ThreadProcessIdType
 MultiThreader
 ::ThreadPoolDispatchSingleMethodThread(MultiThreader::ThreadInfoStruct *threadInfo)
@@ -191,11 +182,11 @@ MultiThreader
   ThreadJob threadJob;
   threadJob.m_ThreadFunction = (this->SingleMethodProxy);
   threadJob.m_UserData = (void *) threadInfo;
-  HANDLE returnHandle = m_ThreadPool->AssignWork(threadJob);
-  itkDebugMacro(<< std::endl << "Got handle :" << returnHandle );
-  return returnHandle;
-
+  m_ThreadPool->AddWork(threadJob, &m_ThreadPoolJobBatch);
+  // The pool has no per-job handle; the job is waited for through the batch
+  return ITK_NULLPTR;
 }
+
 void
 MultiThreader
 ::SpawnWaitForSingleMethodThread(ThreadProcessIdType threadHandle)
@@ -19,15 +19,16 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
+#include <sched.h>
 
 namespace itk
 {
 
 
 ThreadPool
-::ThreadSemaphorePair
-::ThreadSemaphorePair(const ThreadProcessIdType & tph) :
-  m_ThreadProcessHandle(tph)
+::Semaphore
+::Semaphore()
 {
 #if defined(__APPLE__)
   if( semaphore_create(current_task(), &m_Semaphore, SYNC_POLICY_FIFO, 0) != KERN_SUCCESS)
@@ -35,46 +36,58 @@ ThreadPool
     itkGenericExceptionMacro(<<std::endl<<"m_Semaphore cannot be initialized. " << strerror(errno));
     }
 #else
-  sem_init(&m_Semaphore, 0, 0);
+  if( sem_init(&m_Semaphore, 0, 0) != 0 )
+    {
+    itkGenericExceptionMacro(<<std::endl<<"m_Semaphore cannot be initialized. " << strerror(errno));
+    }
 #endif
 }
 
-int
 ThreadPool
-::ThreadSemaphorePair
-::SemaphoreWait()
+::Semaphore
+::~Semaphore()
 {
 #if defined(__APPLE__)
-  if(semaphore_wait(m_Semaphore) == KERN_SUCCESS)
-    {
-    return 0;
-    }
-  else
-    {
-    return -1;
-    }
+  semaphore_destroy(current_task(), m_Semaphore);
 #else
-  return sem_wait(&m_Semaphore);
+  sem_destroy(&m_Semaphore);
 #endif
 }
 
-int
+void
 ThreadPool
-::ThreadSemaphorePair
-::SemaphorePost()
+::Semaphore
+::Wait()
 {
 #if defined(__APPLE__)
-  if(semaphore_signal(m_Semaphore) == KERN_SUCCESS)
+  while( semaphore_wait(m_Semaphore) == KERN_ABORTED )
     {
-    return 0;
     }
-  else
+#else
+  // Retry when interrupted by a signal
+  while( sem_wait(&m_Semaphore) != 0 )
     {
-    return -1;
+    if( errno != EINTR )
+      {
+      itkGenericExceptionMacro(<< "Error in semaphore wait. " << strerror(errno));
+      }
     }
+#endif
+}
+
+void
+ThreadPool
+::Semaphore
+::Post()
+{
+#if defined(__APPLE__)
+  if( semaphore_signal(m_Semaphore) != KERN_SUCCESS )
 #else
-  return sem_post(&m_Semaphore);
+  if( sem_post(&m_Semaphore) != 0 )
 #endif
+    {
+    itkGenericExceptionMacro(<< "Error in semaphore post");
+    }
 }
 
 void
@@ -88,85 +101,27 @@ ThreadPool
 #if !defined( __CYGWIN__ )
   pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
 #endif
-
-  SimpleFastMutexLock tcLock;
-  tcLock.Lock();
-  tcLock.Unlock();
+  // The threads live as long as the process and are never joined
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
 
   pthread_t newlyAddedThreadHandle;
   const int rc = pthread_create(&newlyAddedThreadHandle, &attr, &ThreadPool::ThreadExecute, (void *)this );
+  pthread_attr_destroy(&attr);
   if( rc )
     {
     itkDebugStatement(std::cerr << "ERROR; return code from pthread_create() is " << rc << std::endl);
     itkExceptionMacro(<< "Cannot create thread. Error in return code from pthread_create()");
     }
-  else
-    {
-
-    m_ThreadHandles.insert(newlyAddedThreadHandle);
-    m_ThreadProcessIdentifiersVector.push_back(ThreadProcessIdentifiers(JOB_THREADHANDLE_JUST_ADDED,
-                                                                   newlyAddedThreadHandle,
-                                                                   0));
-
-    m_ThreadSemHandlePairingForWaitQueue.push_back(new ThreadSemaphorePair(newlyAddedThreadHandle));
-    m_ThreadSemHandlePairingQueue.push_back(new ThreadSemaphorePair(newlyAddedThreadHandle));
-
-    itkDebugMacro(<< "Thread created with handle :" << newlyAddedThreadHandle << std::endl );
-    }
 
+  ++m_ThreadCount;
+  itkDebugMacro(<< "Thread created with handle :" << newlyAddedThreadHandle << std::endl );
 }
 
-bool
-ThreadPool
-::CompareThreadHandles(ThreadProcessIdType t1, ThreadProcessIdType t2)
-{
-  return (pthread_equal(t1, t2) == 0 ? false : true);
-}
-
-// Thread function
-void *
+void
 ThreadPool
-::ThreadExecute(void *param)
+::YieldThread()
 {
-  // get the parameters passed in
-  ThreadPool *pThreadPool = reinterpret_cast<ThreadPool *>(param);
-  if(pThreadPool == ITK_NULLPTR)
-    {
-    itkGenericExceptionMacro(<< "param can't be converted to ThreadPool type");
-    }
-  // TODO: What is proper action if pThreadPool is 0?
-#if !defined(__ANDROID__)
-  const int s = pthread_setcancelstate(PTHREAD_CANCEL_ASYNCHRONOUS, ITK_NULLPTR);
-#else
-  const int s = 0;
-#endif
-
-  if( s != 0 )
-    {
-    //TODO: What is proper action if s != 0?
-    itkGenericExceptionMacro(<< "Cannot pthread_setcancelstate" << std::endl );
-    }
-
-  while( !pThreadPool->m_ScheduleForDestruction )
-    {
-    //TODO: Replace in both Pthread and WinThread  the return value of
-    // FetchWork.
-    const ThreadJob &currentPThreadJob = pThreadPool->FetchWork(pthread_self() );
-    if(currentPThreadJob.m_Assigned == false )
-      {
-      itkDebugStatement(std::cerr << "\n Empty job returned from FetchWork so ignoring and continuing ..\n\n");
-      continue;
-      }
-    currentPThreadJob.m_ThreadFunction(currentPThreadJob.m_UserData);
-    pThreadPool->RemoveActiveId(currentPThreadJob.m_Id );
-
-    //signal that current job is done
-    if(pThreadPool->GetSemaphoreForThreadWait(pthread_self())->SemaphorePost() != 0)
-      {
-      itkGenericExceptionMacro(<<"******************************Error in semaphore post");
-      }
-    }
-  pthread_exit(ITK_NULLPTR);
+  sched_yield();
 }
 
 }
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkPixelBufferAllocator.h"
+
+#if defined( _WIN32 )
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#if defined( __linux__ )
+#include <sys/mman.h>
+#endif
+#endif
+
+namespace itk
+{
+namespace
+{
+// size of the huge pages of x86-64 and of most aarch64 configurations
+const SizeValueType HugePageSize = 2 * 1024 * 1024;
+}
+
+PixelBufferAllocator::Pointer PixelBufferAllocator::m_GlobalDefault;
+
+PixelBufferAllocator::PixelBufferAllocator() :
+  m_Alignment(64),
+  m_UseHugePages(false)
+{
+}
+
+PixelBufferAllocator::~PixelBufferAllocator()
+{
+}
+
+void
+PixelBufferAllocator
+::SetGlobalDefault(Self *allocator)
+{
+  m_GlobalDefault = allocator;
+}
+
+PixelBufferAllocator *
+PixelBufferAllocator
+::GetGlobalDefault()
+{
+  return m_GlobalDefault.GetPointer();
+}
+
+void *
+PixelBufferAllocator
+::Allocate(SizeValueType numberOfBytes)
+{
+  SizeValueType alignment = m_Alignment;
+  if ( alignment < sizeof( void * ) || ( alignment & ( alignment - 1 ) ) != 0 )
+    {
+    itkExceptionMacro( "Alignment " << alignment << " is not a power of two multiple of "
+                       << sizeof( void * ) );
+    }
+  // keep a valid, unique pointer for empty buffers, as new[] does
+  const SizeValueType size = numberOfBytes > 0 ? numberOfBytes : 1;
+
+  const bool hugePages = m_UseHugePages && size >= HugePageSize;
+  if ( hugePages && alignment < HugePageSize )
+    {
+    alignment = HugePageSize;
+    }
+
+  void *buffer = ITK_NULLPTR;
+#if defined( _WIN32 )
+  buffer = _aligned_malloc(size, alignment);
+#else
+  if ( posix_memalign(&buffer, alignment, size) != 0 )
+    {
+    buffer = ITK_NULLPTR;
+    }
+#endif
+  if ( !buffer )
+    {
+    // We cannot construct an error string here because we may be out
+    // of memory.  Do not use the exception macro.
+    throw MemoryAllocationError(__FILE__, __LINE__,
+                                "Failed to allocate memory for image.",
+                                ITK_LOCATION);
+    }
+
+#if defined( __linux__ ) && defined( MADV_HUGEPAGE )
+  if ( hugePages )
+    {
+    // only a hint: the buffer is still usable without huge pages
+    madvise(buffer, size - size % HugePageSize, MADV_HUGEPAGE);
+    }
+#else
+  (void)hugePages;
+#endif
+
+  return buffer;
+}
+
+void
+PixelBufferAllocator
+::Deallocate(void *buffer, SizeValueType itkNotUsed(numberOfBytes))
+{
+#if defined( _WIN32 )
+  _aligned_free(buffer);
+#else
+  free(buffer);
+#endif
+}
+
+void
+PixelBufferAllocator
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Alignment: " << m_Alignment << std::endl;
+  os << indent << "UseHugePages: " << ( m_UseHugePages ? "On" : "Off" ) << std::endl;
+}
+} // end namespace itk
@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkPoolPixelBufferAllocator.h"
+#include "itkMutexLockHolder.h"
+
+namespace itk
+{
+PoolPixelBufferAllocator::PoolPixelBufferAllocator() :
+  m_PoolSize(0),
+  m_MaximumPoolSize(1024 * 1024 * 1024),
+  m_NumberOfReusedBuffers(0)
+{
+}
+
+PoolPixelBufferAllocator::~PoolPixelBufferAllocator()
+{
+  this->ReleaseMemory();
+}
+
+void *
+PoolPixelBufferAllocator
+::Allocate(SizeValueType numberOfBytes)
+{
+  BufferKey key;
+  key.NumberOfBytes = numberOfBytes;
+  key.Alignment = this->GetAlignment();
+  key.UseHugePages = this->GetUseHugePages();
+    {
+    MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Mutex);
+    PoolType::iterator bucket = m_Pool.find(key);
+    if ( bucket != m_Pool.end() && !bucket->second.empty() )
+      {
+      void *buffer = bucket->second.back();
+      bucket->second.pop_back();
+      m_PoolSize -= numberOfBytes;
+      ++m_NumberOfReusedBuffers;
+      m_AllocatedBuffers[buffer] = key;
+      return buffer;
+      }
+    }
+  void *buffer = Superclass::Allocate(numberOfBytes);
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Mutex);
+  m_AllocatedBuffers[buffer] = key;
+  return buffer;
+}
+
+void
+PoolPixelBufferAllocator
+::Deallocate(void *buffer, SizeValueType numberOfBytes)
+{
+  if ( buffer == ITK_NULLPTR )
+    {
+    return;
+    }
+    {
+    MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Mutex);
+    // the buffer is pooled with the settings it was allocated with, which
+    // may have changed since
+    BufferKeyMapType::iterator allocated = m_AllocatedBuffers.find(buffer);
+    if ( allocated != m_AllocatedBuffers.end() )
+      {
+      const BufferKey key = allocated->second;
+      m_AllocatedBuffers.erase(allocated);
+      if ( key.NumberOfBytes == numberOfBytes && m_PoolSize + numberOfBytes <= m_MaximumPoolSize )
+        {
+        m_Pool[key].push_back(buffer);
+        m_PoolSize += numberOfBytes;
+        return;
+        }
+      }
+    }
+  Superclass::Deallocate(buffer, numberOfBytes);
+}
+
+void
+PoolPixelBufferAllocator
+::ReleaseMemory()
+{
+  PoolType pool;
+    {
+    MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Mutex);
+    pool.swap(m_Pool);
+    m_PoolSize = 0;
+    }
+  for ( PoolType::iterator bucket = pool.begin(); bucket != pool.end(); ++bucket )
+    {
+    for ( std::vector< void * >::iterator it = bucket->second.begin(); it != bucket->second.end(); ++it )
+      {
+      Superclass::Deallocate(*it, bucket->first.NumberOfBytes);
+      }
+    }
+}
+
+SizeValueType
+PoolPixelBufferAllocator
+::GetPoolSize() const
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Mutex);
+  return m_PoolSize;
+}
+
+SizeValueType
+PoolPixelBufferAllocator
+::GetNumberOfReusedBuffers() const
+{
+  MutexLockHolder< SimpleFastMutexLock > mutexHolder(m_Mutex);
+  return m_NumberOfReusedBuffers;
+}
+
+void
+PoolPixelBufferAllocator
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "MaximumPoolSize: " << m_MaximumPoolSize << std::endl;
+  os << indent << "PoolSize: " << this->GetPoolSize() << std::endl;
+  os << indent << "NumberOfReusedBuffers: " << this->GetNumberOfReusedBuffers() << std::endl;
+}
+} // end namespace itk
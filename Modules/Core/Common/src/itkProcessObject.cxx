@@ -1669,6 +1669,31 @@ ProcessObject
 }
 
 
+void
+ProcessObject
+::UpdateInputs()
+{
+  if ( m_Inputs.size() == 1 )
+    {
+    if ( this->GetPrimaryInput() )
+      {
+      this->GetPrimaryInput()->UpdateOutputData();
+      }
+    }
+  else
+    {
+    for ( DataObjectPointerMap::iterator it=m_Inputs.begin(); it != m_Inputs.end(); ++it )
+      {
+      if ( it->second )
+        {
+        it->second->PropagateRequestedRegion();
+        it->second->UpdateOutputData();
+        }
+      }
+    }
+}
+
+
 void
 ProcessObject
 ::UpdateOutputData( DataObject * itkNotUsed(output) )
@@ -1693,24 +1718,7 @@ ProcessObject
    * inputs since they may lead back to the same data object.
    */
   m_Updating = true;
-  if ( m_Inputs.size() == 1 )
-    {
-    if ( this->GetPrimaryInput() )
-      {
-      this->GetPrimaryInput()->UpdateOutputData();
-      }
-    }
-  else
-    {
-    for ( DataObjectPointerMap::iterator it=m_Inputs.begin(); it != m_Inputs.end(); ++it )
-      {
-      if ( it->second )
-        {
-        it->second->PropagateRequestedRegion();
-        it->second->UpdateOutputData();
-        }
-      }
-    }
+  this->UpdateInputs();
 
   /**
    * Cache the state of any ReleaseDataFlag's on the inputs. While the
@@ -0,0 +1,85 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSIMDInstructionSet.h"
+
+namespace itk
+{
+namespace
+{
+SIMDInstructionSet::InstructionSetType DetectInstructionSet()
+{
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+  // may run before the constructors of libgcc
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+       && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl") )
+    {
+    return SIMDInstructionSet::AVX512;
+    }
+  if ( __builtin_cpu_supports("avx2") )
+    {
+    return SIMDInstructionSet::AVX2;
+    }
+#endif
+  return SIMDInstructionSet::Baseline;
+}
+
+const SIMDInstructionSet::InstructionSetType SupportedInstructionSet = DetectInstructionSet();
+}
+
+SIMDInstructionSet::InstructionSetType SIMDInstructionSet::m_MaximumInstructionSet = SIMDInstructionSet::AVX512;
+
+SIMDInstructionSet::InstructionSetType
+SIMDInstructionSet
+::GetSupportedInstructionSet()
+{
+  return SupportedInstructionSet;
+}
+
+void
+SIMDInstructionSet
+::SetMaximumInstructionSet(InstructionSetType instructionSet)
+{
+  m_MaximumInstructionSet = instructionSet;
+}
+
+SIMDInstructionSet::InstructionSetType
+SIMDInstructionSet
+::GetMaximumInstructionSet()
+{
+  return m_MaximumInstructionSet;
+}
+
+const char *
+SIMDInstructionSet
+::GetInstructionSetName(InstructionSetType instructionSet)
+{
+  switch ( instructionSet )
+    {
+    case Scalar:
+      return "Scalar";
+    case Baseline:
+      return "Baseline";
+    case AVX2:
+      return "AVX2";
+    case AVX512:
+      return "AVX512";
+    }
+  return "Unknown";
+}
+} // end namespace itk
@@ -19,11 +19,8 @@
 
 #include "itkThreadPool.h"
 
-#include <algorithm>
-
 namespace itk
 {
-SimpleFastMutexLock ThreadPool::m_ThreadProcessIdentifiersVectorMutex;
 SimpleFastMutexLock ThreadPool::m_ThreadPoolInstanceMutex;
 
 ThreadPool::Pointer ThreadPool::m_ThreadPoolInstance;
@@ -59,11 +56,18 @@ ThreadPool
 
 ThreadPool
 ::ThreadPool() :
-  m_ScheduleForDestruction(false),
+  m_EnqueuePosition(0),
+  m_DequeuePosition(0),
+  m_ActiveJobs(0),
   m_ThreadCount(0),
-  m_IdCounter(1),
-  m_ExceptionOccurred(false)
+  m_ScheduleForDestruction(false)
 {
+  // Cell i is initially free for the enqueue position i
+  for( uint32_t i = 0; i < QueueCapacity; ++i )
+    {
+    m_Queue[i].m_Sequence = i;
+    m_Queue[i].m_Batch = ITK_NULLPTR;
+    }
 }
 
 void ThreadPool
@@ -73,9 +77,10 @@ void ThreadPool
     {
     maximumThreads = 1;
     }
-  for( unsigned int i = 0; i < maximumThreads; ++i )
+  MutexLockHolder<SimpleFastMutexLock> addThreadHolder(m_AddThreadMutex);
+  while( static_cast< unsigned int >( m_ThreadCount.load() ) < maximumThreads )
     {
-    AddThread();
+    this->AddThread();
     }
 }
 
@@ -85,273 +90,196 @@ ThreadPool
   itkDebugMacro(<< std::endl << "Thread pool being destroyed" << std::endl);
 }
 
-/*
-  Once wait thread is called we will look for the threadhandle's job id
-  if it is JOB_THREADHANDLE_IS_FREE it means it is done -
-  if it is +ve it means it is running
+ThreadPool::ThreadCountType
+ThreadPool
+::GetNumberOfThreads() const
+{
+  return static_cast< ThreadCountType >( m_ThreadCount.load() );
+}
 
-  if it is JOB_THREADHANDLE_IS_FREE / done set the jid to
-  JOB_THREADHANDLE_IS_DONE which means that now assign work can
-  assign further work to this thread
-  */
-bool
+void
 ThreadPool
-::WaitForJobOnThreadHandle(ThreadProcessIdType threadHandle)
+::AddWork(const ThreadJob & job, JobBatch *batch)
 {
-  try
+  // Make sure a thread is available for this job before it is queued, so
+  // that a failure to create a thread leaves the queue untouched. Jobs
+  // that wait for other jobs (nested parallel sections) therefore never
+  // starve the pool.
+  const int32_t activeJobs = ++m_ActiveJobs;
+  if( activeJobs > m_ThreadCount.load() )
     {
-    itkDebugMacro(<< "Waiting for thread with threadHandle " << threadHandle);
-
-    if(GetSemaphoreForThreadWait(threadHandle)->SemaphoreWait() != 0 )
+    try
       {
-      itkExceptionMacro(<<"Error in semaphore wait");
-      }
-
-    MutexLockHolder<SimpleFastMutexLock> threadStructMutexHolder(m_ThreadProcessIdentifiersVectorMutex);
-    ThreadProcessIdentifiersVecType::const_iterator tpIter = m_ThreadProcessIdentifiersVector.begin();
-    ThreadProcessIdentifiersVecType::const_iterator end = m_ThreadProcessIdentifiersVector.end();
-    for(;tpIter != end; ++tpIter)
-      {
-      if(CompareThreadHandles(tpIter->m_ThreadProcessHandle, threadHandle))
+      MutexLockHolder<SimpleFastMutexLock> addThreadHolder(m_AddThreadMutex);
+      while( m_ThreadCount.load() < activeJobs )
         {
-        if(tpIter->m_ThreadNumericId == JOB_THREADHANDLE_IS_FREE)
-          {
-          itkDebugMacro(<< "Wait ended for thread with threadHandle " << threadHandle);
-          break;
-          }
+        this->AddThread();
         }
       }
-    if(tpIter == end)
+    catch( ... )
       {
-      itkExceptionMacro(<< "can't find ThreadIdHandlePairing object for thread handle"
-                        << threadHandle);
+      --m_ActiveJobs;
+      throw;
       }
     }
-  catch( std::exception & itkDebugStatement( e ) )
+
+  while( !this->Enqueue(job, batch) )
     {
-    m_ExceptionOccurred = true;
-    itkDebugMacro(<< "Exception occured while waiting for thread with threadHandle : "
-                  << threadHandle << std::endl << e.what());
+    YieldThread();
     }
-  return true;
+  m_JobsAvailable.Post();
 }
 
-void
+bool
 ThreadPool
-::RemoveActiveId(int id)
+::Enqueue(const ThreadJob & job, JobBatch *batch)
 {
-  try
+  uint32_t   position = m_EnqueuePosition.load();
+  QueueCell *cell;
+  while( true )
     {
-    MutexLockHolder<SimpleFastMutexLock> vMutex(m_ThreadProcessIdentifiersVectorMutex);
-    // setting ThreadJobStruct
-    for(ThreadProcessIdentifiersVecType::iterator it =
-          m_ThreadProcessIdentifiersVector.begin(),
-          end = m_ThreadProcessIdentifiersVector.end();
-        it != end; ++it)
+    cell = &m_Queue[position & ( QueueCapacity - 1 )];
+    const int32_t difference = static_cast< int32_t >( cell->m_Sequence.load() - position );
+    if( difference == 0 )
       {
-      if( it->m_ThreadNumericId == id )
+      // The cell is free for this position: try to claim it
+      if( m_EnqueuePosition.compare_exchange_strong(position, position + 1) )
         {
-        // set this to JOB_THREADHANDLE_IS_DONE so that now the thread
-        // is in wait state
-        it->m_ThreadNumericId = JOB_THREADHANDLE_IS_FREE;
         break;
         }
       }
-
-    // Delete from worker queue
-    ThreadJobContainerType::iterator newJob = this->m_WorkerQueue.find(id);
-    if(newJob == this->m_WorkerQueue.end())
+    else if( difference < 0 )
       {
-      itkExceptionMacro(<< "Error occured, couldnt find id in WorkerQueue to mark executed. Id is : "
-                        << id << std::endl );
+      // The cell still holds the job of the previous round: full
+      return false;
       }
-    this->m_WorkerQueue.erase(newJob);
-    }
-  catch( std::exception & e )
-    {
-    itkExceptionMacro(<< e.what() );
-    }
-}
-
-ThreadPool::ThreadSemaphorePair*
-ThreadPool
-::GetSemaphore(ThreadSemHandlePairingQueueType &q, ThreadProcessIdType threadHandle)
-{
-  MutexLockHolder<SimpleFastMutexLock> threadStructMutexHolder(m_ThreadProcessIdentifiersVectorMutex);
-  ThreadSemHandlePairingQueueType::iterator it = q.begin();
-  ThreadSemHandlePairingQueueType::iterator end = q.end();
-  for(; it != end; ++it)
-    {
-    if(CompareThreadHandles((*it)->m_ThreadProcessHandle, threadHandle))
+    else
       {
-      break;
+      position = m_EnqueuePosition.load();
       }
     }
-  if(it == end)
-    {
-    itkExceptionMacro(<< "Error occured finding semaphore for thread handle " << threadHandle);
-    }
-  return *it;
 
+  cell->m_Job = job;
+  cell->m_Batch = batch;
+  // Publish the job to the consumers
+  cell->m_Sequence = position + 1;
+  return true;
 }
 
-ThreadProcessIdType
-ThreadPool::
-GetThreadHandleForThreadId(ThreadIdType id)
+bool
+ThreadPool
+::Dequeue(ThreadJob & job, JobBatch * & batch)
 {
-  MutexLockHolder<SimpleFastMutexLock> threadStructMutexHolder(m_ThreadProcessIdentifiersVectorMutex);
-  for (ThreadProcessIdentifiersVecType::iterator tpIt = m_ThreadProcessIdentifiersVector.begin(),
-         end = m_ThreadProcessIdentifiersVector.end(); tpIt != end; ++tpIt)
+  uint32_t   position = m_DequeuePosition.load();
+  QueueCell *cell;
+  while( true )
     {
-    if (tpIt->m_ThreadNumericId)
+    cell = &m_Queue[position & ( QueueCapacity - 1 )];
+    const int32_t difference = static_cast< int32_t >( cell->m_Sequence.load() - ( position + 1 ) );
+    if( difference == 0 )
       {
-      return tpIt->m_ThreadProcessHandle;
+      // The job for this position is published: try to claim it
+      if( m_DequeuePosition.compare_exchange_strong(position, position + 1) )
+        {
+        break;
+        }
+      }
+    else if( difference < 0 )
+      {
+      // Nothing published yet at this position
+      return false;
+      }
+    else
+      {
+      position = m_DequeuePosition.load();
       }
     }
-  itkExceptionMacro(<< "Error occured finding thread handle for thread id " << id);
-}
-
-ThreadPool::ThreadSemaphorePair *
-ThreadPool
-::GetSemaphoreForThreadWait(ThreadProcessIdType threadHandle)
-{
-  return this->GetSemaphore(this->m_ThreadSemHandlePairingForWaitQueue, threadHandle);
-}
 
-ThreadPool::ThreadSemaphorePair *
-ThreadPool
-::GetSemaphoreForThread(ThreadProcessIdType threadHandle)
-{
-  return this->GetSemaphore(m_ThreadSemHandlePairingQueue,threadHandle);
+  job = cell->m_Job;
+  batch = cell->m_Batch;
+  // Free the cell for the enqueue position of the next round
+  cell->m_Sequence = position + QueueCapacity;
+  return true;
 }
 
-// TODO: Do we want to return a reference to the job in the work queue
-//      This is returning a copy of the ThreadJob from the Queue rather
-//      than a reference to the the job on the Queue.
-const ThreadJob &
+// Thread function
+void *
 ThreadPool
-::FetchWork(ThreadProcessIdType threadHandle)
+::ThreadExecute(void *param)
 {
-  int  workId = JOB_THREADHANDLE_IS_DONE;
+  ThreadPool *pool = reinterpret_cast<ThreadPool *>(param);
 
-  ThreadJobContainerType::iterator newJob;
-  if(GetSemaphoreForThread(threadHandle)->SemaphoreWait() != 0 )
+  ThreadJob job;
+  JobBatch *batch;
+  while( !pool->m_ScheduleForDestruction )
     {
-    itkExceptionMacro(<<"Error in semaphore wait");
-    }
+    pool->m_JobsAvailable.Wait();
 
-  {
-  MutexLockHolder<SimpleFastMutexLock> threadStructMutexHolder(m_ThreadProcessIdentifiersVectorMutex);
+    // A post guarantees a job, but a producer may have claimed an
+    // earlier cell and not published it yet.
+    while( !pool->Dequeue(job, batch) )
+      {
+      YieldThread();
+      }
 
-  ThreadProcessIdentifiersVecType::const_iterator tpIter = m_ThreadProcessIdentifiersVector.begin();
-  ThreadProcessIdentifiersVecType::iterator end = m_ThreadProcessIdentifiersVector.end();
-  for(; tpIter != end; ++tpIter)
-    {
-    if(CompareThreadHandles(tpIter->m_ThreadProcessHandle,threadHandle))
+    job.m_ThreadFunction(job.m_UserData);
+
+    --pool->m_ActiveJobs;
+    if( batch != ITK_NULLPTR )
       {
-      break;
+      batch->JobDone();
       }
     }
-  if(tpIter == end)
-    {
-    itkExceptionMacro(<< "Can't find thread with handle "
-                      << threadHandle);
-    }
+  return ITK_NULLPTR;
+}
 
-  workId = tpIter->m_ThreadNumericId;
-  newJob = this->m_WorkerQueue.find(workId);
+ThreadPool::JobBatch
+::JobBatch() :
+  m_NumberOfJobs(0),
+  m_PendingJobs(0)
+{
+}
 
-  if(newJob != this->m_WorkerQueue.end())
-    {
-    newJob->second.m_Assigned = true;
-    newJob->second.m_Id = workId;
-    }
-  } // mutex
+void
+ThreadPool::JobBatch
+::Reset(int32_t numberOfJobs)
+{
+  m_NumberOfJobs = numberOfJobs;
+  m_PendingJobs = numberOfJobs;
+}
 
-  if(newJob == this->m_WorkerQueue.end())
+void
+ThreadPool::JobBatch
+::JobDone()
+{
+  if( --m_PendingJobs == 0 )
     {
-    itkExceptionMacro(<< "no job found to run " << std::endl );
+    m_Done.Post();
     }
-  return newJob->second;
 }
 
-ThreadPool::ThreadProcessIdentifiers *
-ThreadPool
-::FindThreadToRun()
+void
+ThreadPool::JobBatch
+::Wait()
 {
-  ThreadProcessIdentifiers *returnValue(ITK_NULLPTR);
-  //
-  // loop twice, if necesary.
-  // 1st pass, find free thread. if none
-  // found, add thread.
-  // second pass if thread was added, find just-added thread.
-  // if AddThread fails, end outer loop and throw exception.
-  for(unsigned j = 0; j < 2 && returnValue == ITK_NULLPTR; ++j)
-    {
-    for(ThreadProcessIdentifiersVecType::iterator tpIter = m_ThreadProcessIdentifiersVector.begin(),
-          end = m_ThreadProcessIdentifiersVector.end();
-        tpIter != end; ++tpIter)
-      {
-      // only if it is JOB_THREADHANDLE_IS_FREE or just added thread you
-      // assign it a job
-      if( tpIter->m_ThreadNumericId <= JOB_THREADHANDLE_IS_FREE )
-        {
-        // assign the job id to the thread now
-        returnValue = &(*tpIter);
-        break;  // break because we dont want to keep assigning
-        }
-      }
-    if(returnValue == ITK_NULLPTR)
-      {
-      this->AddThread();
-      itkDebugMacro(<< "Added a new thread"  );
-      }
-    }
-  if(returnValue == ITK_NULLPTR)
+  if( m_NumberOfJobs == 0 )
     {
-    itkExceptionMacro(<< "Unable to find thread to run");
+    return;
     }
-  return returnValue;
+
+  // The last job posts exactly once per batch.
+  m_Done.Wait();
+  m_NumberOfJobs = 0;
 }
 
-ThreadProcessIdType
+void
 ThreadPool
-::AssignWork(ThreadJob threadJob)
+::PrintSelf(std::ostream & os, Indent indent) const
 {
-#if defined(__APPLE__)
-  ThreadProcessIdType returnValue = ITK_NULLPTR; // TODO:  This is being returned
-#elif defined(_WIN32) || defined(_WIN64)
-  ThreadProcessIdType returnValue = ITK_NULLPTR; // TODO:  This is being returned
-#else
-  ThreadProcessIdType returnValue = pthread_self();
-#endif
-  try
-    {
-      {
-      MutexLockHolder<SimpleFastMutexLock> mutexHolderSync(m_ThreadProcessIdentifiersVectorMutex);
-      ThreadProcessIdentifiers *threadToRun = this->FindThreadToRun();
+  Superclass::PrintSelf(os, indent);
 
-      // adding to queue
-      threadJob.m_Id = this->m_IdCounter++;
-      ThreadJobContainerPairType toInsert(threadJob.m_Id,threadJob);
-      this->m_WorkerQueue.insert(toInsert);
-
-      // now put the job id in the ThreadJobStruct vector
-      threadToRun->m_ThreadNumericId = threadJob.m_Id;
-      returnValue = threadToRun->m_ThreadProcessHandle;
-      }
-    if(GetSemaphoreForThread(returnValue)->SemaphorePost() != 0 )
-      {
-      itkExceptionMacro(<<"Error in semaphore post");
-      }
-    }
-  catch( std::exception& e )
-    {
-    itkDebugMacro(<< std::endl << "Failed to assign work. \n" << e.what() << std::endl );
-    m_ExceptionOccurred = true;
-    itkExceptionMacro(<< e.what() );
-    }
-  return returnValue;
+  os << indent << "NumberOfThreads: " << m_ThreadCount.load() << std::endl;
+  os << indent << "ActiveJobs: " << m_ActiveJobs.load() << std::endl;
 }
 
 }
@@ -21,15 +21,13 @@ namespace itk
 {
 
 ThreadPool
-::ThreadSemaphorePair
-::ThreadSemaphorePair(const ThreadProcessIdType & tph) :
-  m_ThreadProcessHandle(tph)
+::Semaphore
+::Semaphore()
 {
-
   m_Semaphore = CreateSemaphore(
     ITK_NULLPTR,     // default security attributes
-    0,        // initial count
-    1000, // maximum count
+    0,               // initial count
+    0x7fffffff,      // maximum count
     ITK_NULLPTR);    // unnamed semaphore
   if (m_Semaphore == ITK_NULLPTR)
     {
@@ -37,41 +35,37 @@ ThreadPool
     }
 }
 
+ThreadPool
+::Semaphore
+::~Semaphore()
+{
+  CloseHandle(m_Semaphore);
+}
 
-int
+void
 ThreadPool
-::ThreadSemaphorePair
-::SemaphoreWait()
+::Semaphore
+::Wait()
 {
   DWORD dwWaitResult = WaitForSingleObject(m_Semaphore,       // handle to semaphore
                                            INFINITE);
-  switch( dwWaitResult )
+  if( dwWaitResult != WAIT_OBJECT_0 )
     {
-    // The thread got ownership of the mutex
-    case WAIT_OBJECT_0:
-      return 0; //success
-      break;
-    case WAIT_ABANDONED:
-      return -1;
-    case WAIT_FAILED:
-      return -1;
-    default:
-      return -1;
+    itkGenericExceptionMacro(<< "Error in semaphore wait" << GetLastError());
     }
 }
 
-int
+void
 ThreadPool
-::ThreadSemaphorePair::SemaphorePost()
+::Semaphore::Post()
 {
   if(!ReleaseSemaphore(
        m_Semaphore,   // handle to semaphore
        1,               // increase count by one
        ITK_NULLPTR))
     {
-    return -1;
+    itkGenericExceptionMacro(<< "Error in semaphore post" << GetLastError());
     }
-  return 0;
 }
 
 
@@ -79,11 +73,8 @@ void
 ThreadPool
 ::AddThread()
 {
-  m_ThreadCount++;
-  HANDLE newlyAddedThreadHandle;
-  ThreadProcessIdentifiers::WinThreadIdType  dwThreadId;
-
-  newlyAddedThreadHandle = CreateThread(
+  DWORD  dwThreadId;
+  HANDLE newlyAddedThreadHandle = CreateThread(
     ITK_NULLPTR,
     0,
     (LPTHREAD_START_ROUTINE) ThreadPool::ThreadExecute,     // thread function
@@ -95,81 +86,16 @@ ThreadPool
     itkDebugMacro(<< "ERROR; adding thread to thread pool");
     itkExceptionMacro(<< "Cannot create thread.");
     }
-  else
-    {
-
-    m_ThreadHandles.insert(newlyAddedThreadHandle);
-    m_ThreadProcessIdentifiersVector.push_back(ThreadProcessIdentifiers(JOB_THREADHANDLE_JUST_ADDED,
-                                                                   newlyAddedThreadHandle,dwThreadId) );
-
-    m_ThreadSemHandlePairingForWaitQueue.push_back(new ThreadSemaphorePair(newlyAddedThreadHandle));
-    m_ThreadSemHandlePairingQueue.push_back(new ThreadSemaphorePair(newlyAddedThreadHandle));
-    }
-
+  // The threads live as long as the process; the handle is not needed
+  CloseHandle(newlyAddedThreadHandle);
+  ++m_ThreadCount;
 }
 
-bool
-ThreadPool
-::CompareThreadHandles(ThreadProcessIdType t1, ThreadProcessIdType t2)
-{
-  if (t1 == t2) return true;
-  return false;
-}
-
-void *
+void
 ThreadPool
-::ThreadExecute(void *param)
+::YieldThread()
 {
-  // get the parameters passed inf
-  //ThreadPool *winThreadPool = (ThreadPool *)param;
-  //ThreadPool::ThreadArgStruct *threadStruct = (ThreadPool::ThreadArgStruct *)param;
-  ThreadPool *winThreadPool = (ThreadPool *)param;
-  ThreadIdType myId;
-  ThreadProcessIdentifiers::WinThreadIdType threadId = GetCurrentThreadId();
-  ThreadProcessIdentifiersVecType::iterator tpIter =
-    winThreadPool->m_ThreadProcessIdentifiersVector.begin(),
-    end = winThreadPool->m_ThreadProcessIdentifiersVector.end();
-  bool threadIdFound(false);
-  for (; tpIter != end; ++tpIter)
-    {
-    if (tpIter->m_WinThreadId == threadId)
-      {
-      myId = tpIter->m_ThreadNumericId;
-      threadIdFound = true;
-      break;
-      }
-    }
-  if(!threadIdFound)
-    {
-    std::cerr << "Can't find thread ID " << threadId << std::endl
-              << "candidates are:" << std::endl;
-    for(tpIter = winThreadPool->m_ThreadProcessIdentifiersVector.begin(); tpIter != end; ++tpIter)
-      {
-      std::cerr << tpIter->m_WinThreadId << std::endl;
-      }
-    std::cerr.flush();
-    abort();
-    }
-  HANDLE handle = winThreadPool->GetThreadHandleForThreadId(myId);
-
-  while( !winThreadPool->m_ScheduleForDestruction )
-    {
-    const ThreadJob &currentWinJob = winThreadPool->FetchWork( handle);
-    if( currentWinJob.m_Id < 0 || currentWinJob.m_Assigned == false )
-      {
-      itkDebugStatement(std::cerr << "In thread pool thread : Empty job returned from FetchWork so ignoring and continuing .."
-                        << std::endl);
-      continue;
-      }
-    currentWinJob.m_ThreadFunction(currentWinJob.m_UserData);
-    winThreadPool->RemoveActiveId(currentWinJob.m_Id);
-    //signal that current job is done
-    if(winThreadPool->GetSemaphoreForThreadWait(handle )->SemaphorePost() != 0)
-      {
-      itkGenericExceptionMacro(<<"******************************Error in semaphore post");
-      }
-    }
-  return 0;
+  SwitchToThread();
 }
 
 }
@@ -0,0 +1,143 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkMutexLockHolder.h"
+#include <vector>
+
+namespace
+{
+
+struct WorkUnitRecord
+{
+  itk::SimpleFastMutexLock    Lock;
+  std::vector< unsigned int > TimesProcessed;
+  itk::ThreadIdType           NumberOfThreads;
+  itk::ThreadIdType           NumberOfWorkUnits;
+  unsigned int                Calls;
+  bool                        Consistent;
+};
+
+ITK_THREAD_RETURN_TYPE WorkUnitMethod(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  WorkUnitRecord *record = static_cast< WorkUnitRecord * >( info->UserData );
+
+  // Make the first work units much more expensive, so that the threads
+  // owning the last ones run out of work and have to steal.
+  volatile double sum = 0.0;
+  const unsigned int iterations = ( info->WorkUnitID < info->NumberOfWorkUnits / 4 ) ? 200000 : 1000;
+  for( unsigned int i = 0; i < iterations; ++i )
+    {
+    sum += i;
+    }
+
+  itk::MutexLockHolder< itk::SimpleFastMutexLock > lock(record->Lock);
+  ++record->Calls;
+  if( info->ThreadID >= info->NumberOfThreads
+      || info->NumberOfThreads != record->NumberOfThreads
+      || info->NumberOfWorkUnits != record->NumberOfWorkUnits
+      || info->WorkUnitID >= record->TimesProcessed.size() )
+    {
+    record->Consistent = false;
+    return ITK_THREAD_RETURN_VALUE;
+    }
+  ++record->TimesProcessed[info->WorkUnitID];
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+bool RunWorkUnits(itk::MultiThreader *threader, itk::ThreadIdType numberOfThreads, itk::ThreadIdType numberOfWorkUnits)
+{
+  threader->SetNumberOfThreads(numberOfThreads);
+
+  WorkUnitRecord record;
+  record.NumberOfThreads = threader->GetNumberOfThreads();
+  // Without over-decomposition there is one work unit per thread
+  record.NumberOfWorkUnits = ( numberOfWorkUnits > record.NumberOfThreads ) ? numberOfWorkUnits : record.NumberOfThreads;
+  record.TimesProcessed.resize(record.NumberOfWorkUnits, 0);
+  record.Calls = 0;
+  record.Consistent = true;
+
+  threader->SetSingleMethod(WorkUnitMethod, &record);
+  threader->SetNumberOfWorkUnits(numberOfWorkUnits);
+  threader->SingleMethodExecute();
+
+  if( !record.Consistent )
+    {
+    std::cerr << "Inconsistent ThreadInfoStruct with " << numberOfThreads
+              << " threads and " << numberOfWorkUnits << " work units" << std::endl;
+    return false;
+    }
+  if( record.Calls != record.NumberOfWorkUnits )
+    {
+    std::cerr << "Expected " << record.NumberOfWorkUnits << " calls, got "
+              << record.Calls << std::endl;
+    return false;
+    }
+  for( unsigned int i = 0; i < record.TimesProcessed.size(); ++i )
+    {
+    if( record.TimesProcessed[i] != 1 )
+      {
+      std::cerr << "Work unit " << i << " processed " << record.TimesProcessed[i]
+                << " times with " << numberOfThreads << " threads and "
+                << numberOfWorkUnits << " work units" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int itkMultiThreaderWorkStealingTest(int, char* [])
+{
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+
+  bool result = true;
+
+  // One work unit per thread, the legacy behavior
+  result &= RunWorkUnits( threader, 4, 0 );
+  result &= RunWorkUnits( threader, 4, 4 );
+
+  // Over-decomposed execution
+  result &= RunWorkUnits( threader, 1, 10 );
+  result &= RunWorkUnits( threader, 2, 3 );
+  result &= RunWorkUnits( threader, 4, 37 );
+  result &= RunWorkUnits( threader, 8, 1000 );
+
+  // Work units must not leak into the next SingleMethod
+  threader->SetNumberOfWorkUnits( 20 );
+  threader->SetSingleMethod( WorkUnitMethod, ITK_NULLPTR );
+  if( threader->GetNumberOfWorkUnits() != 0 )
+    {
+    std::cerr << "SetSingleMethod did not reset the number of work units" << std::endl;
+    result = false;
+    }
+
+  if( !result )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
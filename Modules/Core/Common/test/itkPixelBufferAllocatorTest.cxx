@@ -0,0 +1,297 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPoolPixelBufferAllocator.h"
+#include "itkImageSource.h"
+#include "itkVectorImage.h"
+#include "itkImageRegionIterator.h"
+
+namespace
+{
+
+// Counts the constructed and destroyed elements
+struct CountedPixel
+{
+  CountedPixel() : Value(3) { ++Constructed; }
+  CountedPixel(const CountedPixel & other) : Value(other.Value) { ++Constructed; }
+  ~CountedPixel() { ++Destroyed; }
+  int        Value;
+  static int Constructed;
+  static int Destroyed;
+};
+int CountedPixel::Constructed = 0;
+int CountedPixel::Destroyed = 0;
+
+// Produces an image filled with the number of executions
+template< typename TImage >
+class CountingImageSource:public itk::ImageSource< TImage >
+{
+public:
+  typedef CountingImageSource            Self;
+  typedef itk::ImageSource< TImage >     Superclass;
+  typedef itk::SmartPointer< Self >      Pointer;
+  typedef typename TImage::RegionType    RegionType;
+
+  itkNewMacro(Self);
+  itkTypeMacro(CountingImageSource, ImageSource);
+
+  unsigned int m_Executions;
+  RegionType   m_Region;
+
+protected:
+  CountingImageSource() : m_Executions(0) {}
+
+  virtual void GenerateOutputInformation() ITK_OVERRIDE
+  {
+    this->GetOutput()->SetLargestPossibleRegion( m_Region );
+  }
+
+  virtual void BeforeThreadedGenerateData() ITK_OVERRIDE
+  {
+    ++m_Executions;
+  }
+
+  virtual void ThreadedGenerateData(const RegionType & region, itk::ThreadIdType) ITK_OVERRIDE
+  {
+    itk::ImageRegionIterator< TImage > it( this->GetOutput(), region );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( m_Executions );
+      }
+  }
+};
+
+bool IsAligned( const void *pointer, itk::SizeValueType alignment )
+{
+  return reinterpret_cast< size_t >( pointer ) % alignment == 0;
+}
+
+}
+
+int itkPixelBufferAllocatorTest( int, char* [] )
+{
+  typedef itk::Image< float, 3 >         ImageType;
+  typedef itk::VectorImage< short, 2 >   VectorImageType;
+  typedef itk::Image< CountedPixel, 2 >  CountedImageType;
+
+  bool passed = true;
+
+  // aligned buffers
+  itk::PixelBufferAllocator::Pointer aligned = itk::PixelBufferAllocator::New();
+  const itk::SizeValueType alignments[] = { 64, 4096 };
+  for( unsigned int a = 0; a < 2; ++a )
+    {
+    aligned->SetAlignment( alignments[a] );
+    for( unsigned int s = 1; s < 40; s += 7 )
+      {
+      ImageType::SizeType size;
+      size.Fill( s );
+      ImageType::Pointer image = ImageType::New();
+      image->SetRegions( size );
+      image->SetPixelBufferAllocator( aligned );
+      image->Allocate( true );
+      if( !IsAligned( image->GetBufferPointer(), alignments[a] ) )
+        {
+        std::cerr << "Buffer of " << size << " not aligned on " << alignments[a] << std::endl;
+        passed = false;
+        }
+      itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+      for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        if( it.Get() != 0.0f )
+          {
+          std::cerr << "Pixels not initialized" << std::endl;
+          passed = false;
+          break;
+          }
+        }
+      }
+    }
+  aligned->SetAlignment( 64 );
+  aligned->UseHugePagesOn();
+  VectorImageType::SizeType vectorSize;
+  vectorSize.Fill( 1000 );
+  VectorImageType::Pointer vectorImage = VectorImageType::New();
+  vectorImage->SetRegions( vectorSize );
+  vectorImage->SetNumberOfComponentsPerPixel( 3 );
+  vectorImage->SetPixelBufferAllocator( aligned );
+  vectorImage->Allocate();
+  if( !IsAligned( vectorImage->GetBufferPointer(), 64 ) )
+    {
+    std::cerr << "VectorImage buffer not aligned" << std::endl;
+    passed = false;
+    }
+  vectorImage = ITK_NULLPTR;
+
+  // elements are constructed and destroyed, also when the buffer grows
+  CountedPixel::Constructed = 0;
+  CountedPixel::Destroyed = 0;
+    {
+    CountedImageType::SizeType size;
+    size.Fill( 10 );
+    CountedImageType::Pointer image = CountedImageType::New();
+    image->SetPixelBufferAllocator( aligned );
+    image->SetRegions( size );
+    image->Allocate( true );
+    if( image->GetPixel( CountedImageType::IndexType() ).Value != 3 )
+      {
+      std::cerr << "Pixels not constructed" << std::endl;
+      passed = false;
+      }
+    size.Fill( 20 );
+    image->SetRegions( size );
+    image->Allocate( true );
+    }
+  if( CountedPixel::Constructed != CountedPixel::Destroyed )
+    {
+    std::cerr << CountedPixel::Constructed << " pixels constructed but "
+              << CountedPixel::Destroyed << " destroyed" << std::endl;
+    passed = false;
+    }
+
+  // a released buffer is reused for the next buffer of the same size
+  itk::PoolPixelBufferAllocator::Pointer pool = itk::PoolPixelBufferAllocator::New();
+  ImageType::SizeType size;
+  size.Fill( 17 );
+  const itk::SizeValueType bufferSize = 17 * 17 * 17 * sizeof( float );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetPixelBufferAllocator( pool );
+  image->Allocate();
+  const float *firstBuffer = image->GetBufferPointer();
+  image->Initialize();
+  if( pool->GetPoolSize() != bufferSize )
+    {
+    std::cerr << "Pool size is " << pool->GetPoolSize() << " instead of " << bufferSize << std::endl;
+    passed = false;
+    }
+  image->SetRegions( size );
+  image->SetPixelBufferAllocator( pool );
+  image->Allocate();
+  if( image->GetBufferPointer() != firstBuffer || pool->GetNumberOfReusedBuffers() != 1
+      || pool->GetPoolSize() != 0 )
+    {
+    std::cerr << "Buffer not reused" << std::endl;
+    passed = false;
+    }
+  image = ITK_NULLPTR;
+
+  // a buffer pooled with a smaller alignment is not reused after the
+  // alignment changes, and is reused again with the same alignment
+  pool->SetAlignment( 4096 );
+  image = ImageType::New();
+  image->SetRegions( size );
+  image->SetPixelBufferAllocator( pool );
+  image->Allocate();
+  if( reinterpret_cast< size_t >( image->GetBufferPointer() ) % 4096 != 0
+      || pool->GetNumberOfReusedBuffers() != 1 || pool->GetPoolSize() != bufferSize )
+    {
+    std::cerr << "Buffer with the previous alignment reused" << std::endl;
+    passed = false;
+    }
+  image = ITK_NULLPTR;
+  pool->SetAlignment( 64 );
+  image = ImageType::New();
+  image->SetRegions( size );
+  image->SetPixelBufferAllocator( pool );
+  image->Allocate();
+  if( pool->GetNumberOfReusedBuffers() != 2 )
+    {
+    std::cerr << "Buffer with the same alignment not reused" << std::endl;
+    passed = false;
+    }
+  image = ITK_NULLPTR;
+  pool->ReleaseMemory();
+
+  // no more than MaximumPoolSize bytes are kept
+  pool->SetMaximumPoolSize( bufferSize + bufferSize / 2 );
+    {
+    ImageType::Pointer image1 = ImageType::New();
+    image1->SetRegions( size );
+    image1->SetPixelBufferAllocator( pool );
+    image1->Allocate();
+    ImageType::Pointer image2 = ImageType::New();
+    image2->SetRegions( size );
+    image2->SetPixelBufferAllocator( pool );
+    image2->Allocate();
+    }
+  if( pool->GetPoolSize() != bufferSize )
+    {
+    std::cerr << "Pool size is " << pool->GetPoolSize() << " instead of " << bufferSize << std::endl;
+    passed = false;
+    }
+  pool->ReleaseMemory();
+  if( pool->GetPoolSize() != 0 )
+    {
+    std::cerr << "Pool not empty after ReleaseMemory" << std::endl;
+    passed = false;
+    }
+
+  // per filter: the output buffers released before each execution are
+  // recycled
+  pool->SetMaximumPoolSize( 1024 * 1024 );
+  typedef CountingImageSource< ImageType > SourceType;
+  SourceType::Pointer source = SourceType::New();
+  source->m_Region.SetSize( size );
+  source->SetPixelBufferAllocator( pool );
+  source->ReleaseDataBeforeUpdateFlagOn();
+  const itk::SizeValueType reusedBefore = pool->GetNumberOfReusedBuffers();
+  for( unsigned int i = 0; i < 5; ++i )
+    {
+    source->Modified();
+    source->Update();
+    if( source->GetOutput()->GetPixel( ImageType::IndexType() ) != static_cast< float >( i + 1 ) )
+      {
+      std::cerr << "Wrong output at execution " << i << std::endl;
+      passed = false;
+      }
+    }
+  if( pool->GetNumberOfReusedBuffers() - reusedBefore != 4 )
+    {
+    std::cerr << pool->GetNumberOfReusedBuffers() - reusedBefore
+              << " buffers reused by the filter instead of 4" << std::endl;
+    passed = false;
+    }
+
+  // global default
+  itk::PixelBufferAllocator::SetGlobalDefault( pool );
+  ImageType::Pointer globalImage = ImageType::New();
+  if( globalImage->GetPixelContainer()->GetPixelBufferAllocator() != pool.GetPointer() )
+    {
+    std::cerr << "Global default allocator not used" << std::endl;
+    passed = false;
+    }
+  itk::PixelBufferAllocator::SetGlobalDefault( ITK_NULLPTR );
+  globalImage = ImageType::New();
+  if( globalImage->GetPixelContainer()->GetPixelBufferAllocator() != ITK_NULLPTR )
+    {
+    std::cerr << "Global default allocator not reset" << std::endl;
+    passed = false;
+    }
+
+  pool->Print( std::cout );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMultiThreader.h"
+#include "itkRealTimeClock.h"
+#include "itkAtomicInt.h"
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+
+namespace
+{
+
+ITK_THREAD_RETURN_TYPE EmptyMethod(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info =
+    static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+  itk::AtomicInt< int > *calls = static_cast< itk::AtomicInt< int > * >( info->UserData );
+  ++( *calls );
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+}
+
+/** Measures the time taken by MultiThreader::SingleMethodExecute to
+ * dispatch an empty method to the thread pool and wait for the batch to
+ * complete, and checks that every thread ran the method. The latencies
+ * are only printed, since they depend on the load of the machine. */
+int itkThreadPoolDispatchLatencyTest(int, char* [])
+{
+  const unsigned int numberOfDispatches = 2000;
+  const unsigned int numberOfWarmUpDispatches = 100;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetUseThreadPool( true );
+  threader->SetNumberOfThreads( 4 );
+  const itk::ThreadIdType numberOfThreads = threader->GetNumberOfThreads();
+
+  itk::RealTimeClock::Pointer clock = itk::RealTimeClock::New();
+  std::vector< double >       latencies;
+  latencies.reserve( numberOfDispatches );
+
+  itk::AtomicInt< int > calls;
+  calls = 0;
+  for( unsigned int i = 0; i < numberOfWarmUpDispatches + numberOfDispatches; ++i )
+    {
+    threader->SetSingleMethod( EmptyMethod, &calls );
+    const itk::RealTimeClock::TimeStampType start = clock->GetTimeInSeconds();
+    threader->SingleMethodExecute();
+    const itk::RealTimeClock::TimeStampType stop = clock->GetTimeInSeconds();
+    if( i >= numberOfWarmUpDispatches )
+      {
+      latencies.push_back( ( stop - start ) * 1.0e6 );
+      }
+    }
+
+  const int expectedCalls = static_cast< int >( ( numberOfWarmUpDispatches + numberOfDispatches ) * numberOfThreads );
+  if( calls != expectedCalls )
+    {
+    std::cerr << "Expected " << expectedCalls << " calls, got " << calls << std::endl;
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::sort( latencies.begin(), latencies.end() );
+  const double median = latencies[latencies.size() / 2];
+  std::cout << "Threads: " << numberOfThreads << std::endl;
+  std::cout << "Minimum dispatch latency: " << latencies.front() << " us" << std::endl;
+  std::cout << "Median dispatch latency: " << median << " us" << std::endl;
+  std::cout << "90th percentile dispatch latency: " << latencies[( latencies.size() * 9 ) / 10] << " us" << std::endl;
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -189,6 +189,12 @@ public:
   /** Allocate the image memory. Dimension and Size must be set a priori. */
   virtual void Allocate(bool initialize = false) ITK_OVERRIDE;
 
+  /** Set the allocator of the pixel buffer of the adapted image. */
+  virtual void SetPixelBufferAllocator(PixelBufferAllocator *allocator) ITK_OVERRIDE
+  {
+    m_Image->SetPixelBufferAllocator(allocator);
+  }
+
   /** Restore the data object to its initial state. This means releasing
    * memory. */
   virtual void Initialize() ITK_OVERRIDE;
@@ -0,0 +1,196 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTestingImageIOHelpers_h
+#define itkTestingImageIOHelpers_h
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkPipelineMonitorImageFilter.h"
+#include "itkRGBPixel.h"
+#include "itkStreamingImageFilter.h"
+#include "itkVector.h"
+
+/** \file itkTestingImageIOHelpers.h
+ * Helpers shared by the tests which write an image with an ImageIO and
+ * read it back by regions.
+ *
+ * \ingroup ITKTestKernel
+ */
+
+namespace itk
+{
+namespace Testing
+{
+
+/** Set a pixel to a value which depends on its position in the image. */
+template< typename TPixel >
+void SetTestPixelValue( TPixel & pixel, unsigned int value )
+{
+  pixel = static_cast< TPixel >( value % 251 );
+}
+
+template< typename TValue, unsigned int VLength >
+void SetTestPixelValue( Vector< TValue, VLength > & pixel, unsigned int value )
+{
+  for( unsigned int c = 0; c < VLength; ++c )
+    {
+    pixel[c] = static_cast< TValue >( value * VLength + c );
+    }
+}
+
+template< typename TValue >
+void SetTestPixelValue( RGBPixel< TValue > & pixel, unsigned int value )
+{
+  for( unsigned int c = 0; c < 3; ++c )
+    {
+    pixel[c] = static_cast< TValue >( ( value * 3 + c ) % 251 );
+    }
+}
+
+/** Create an image of 23x17x11... pixels, each set by SetTestPixelValue()
+ * to its offset in the buffer. */
+template< typename TImage >
+typename TImage::Pointer CreateTestImage()
+{
+  typename TImage::SizeType size;
+  size.Fill( 11 );
+  size[0] = 23;
+  size[1] = 17;
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions( size );
+  image->Allocate();
+  ImageRegionIteratorWithIndex< TImage > it( image, image->GetLargestPossibleRegion() );
+  unsigned int value = 0;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    typename TImage::PixelType pixel = it.Get();
+    SetTestPixelValue( pixel, value++ );
+    it.Set( pixel );
+    }
+  return image;
+}
+
+/** Check that the region is buffered in the test image, with the pixels of
+ * the baseline image converted to the pixel type of the test image. */
+template< typename TImage, typename TBaseline >
+bool SameRegion( const TImage *test, const TBaseline *baseline, const typename TImage::RegionType & region )
+{
+  if( !test->GetBufferedRegion().IsInside( region ) )
+    {
+    std::cerr << "Buffered region " << test->GetBufferedRegion()
+              << " does not contain " << region << std::endl;
+    return false;
+    }
+  ImageRegionConstIteratorWithIndex< TImage > it( test, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if( it.Get() != static_cast< typename TImage::PixelType >( baseline->GetPixel( it.GetIndex() ) ) )
+      {
+      std::cerr << "Different pixel at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+/** Write a test image with a copy of the ImageIO, then read it back by
+ * pieces and by region, checking that only the requested regions are
+ * read, or that the whole image is read once if the file cannot be
+ * streamed. */
+template< typename TImage >
+bool StreamedRead( const std::string & fileName, const ImageIOBase *imageIO,
+                   bool canStream = true, bool useCompression = false )
+{
+  typename TImage::Pointer image = CreateTestImage< TImage >();
+
+  typedef ImageFileWriter< TImage > WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName );
+  writer->SetInput( image );
+  writer->SetImageIO( dynamic_cast< ImageIOBase * >( imageIO->CreateAnother().GetPointer() ) );
+  writer->SetUseCompression( useCompression );
+  writer->Update();
+
+  typedef ImageFileReader< TImage > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+  reader->SetImageIO( dynamic_cast< ImageIOBase * >( imageIO->CreateAnother().GetPointer() ) );
+  reader->SetUseStreaming( true );
+
+  typedef PipelineMonitorImageFilter< TImage > MonitorType;
+  typename MonitorType::Pointer monitor = MonitorType::New();
+  monitor->SetInput( reader->GetOutput() );
+
+  const unsigned int numberOfDataPieces = 4;
+  typedef StreamingImageFilter< TImage, TImage > StreamingType;
+  typename StreamingType::Pointer streamer = StreamingType::New();
+  streamer->SetInput( monitor->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( numberOfDataPieces );
+  streamer->Update();
+
+  if( canStream && !monitor->VerifyAllInputCanStream( numberOfDataPieces ) )
+    {
+    std::cerr << fileName << " was not read by pieces" << std::endl;
+    return false;
+    }
+  if( !canStream
+      && !( monitor->VerifyInputFilterExecutedStreaming( 1 ) && monitor->VerifyInputFilterRequestedLargestRegion() ) )
+    {
+    std::cerr << fileName << " was not read as a whole" << std::endl;
+    return false;
+    }
+  if( !SameRegion( streamer->GetOutput(), image.GetPointer(), image->GetLargestPossibleRegion() ) )
+    {
+    std::cerr << fileName << " read by pieces differs" << std::endl;
+    return false;
+    }
+
+  typename TImage::RegionType region = image->GetLargestPossibleRegion();
+  for( unsigned int d = 0; d < TImage::ImageDimension; ++d )
+    {
+    region.SetIndex( d, 3 + d );
+    region.SetSize( d, region.GetSize( d ) - 7 - d );
+    }
+  typename ReaderType::Pointer regionReader = ReaderType::New();
+  regionReader->SetFileName( fileName );
+  regionReader->SetImageIO( dynamic_cast< ImageIOBase * >( imageIO->CreateAnother().GetPointer() ) );
+  regionReader->SetUseStreaming( true );
+  regionReader->UpdateOutputInformation();
+  regionReader->GetOutput()->SetRequestedRegion( region );
+  regionReader->Update();
+
+  const typename TImage::RegionType expectedRegion = canStream ? region : image->GetLargestPossibleRegion();
+  if( regionReader->GetOutput()->GetBufferedRegion() != expectedRegion )
+    {
+    std::cerr << fileName << ": read " << regionReader->GetOutput()->GetBufferedRegion()
+              << " instead of " << expectedRegion << std::endl;
+    return false;
+    }
+  if( !SameRegion( regionReader->GetOutput(), image.GetPointer(), region ) )
+    {
+    std::cerr << fileName << " region differs" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end namespace Testing
+} // end namespace itk
+
+#endif
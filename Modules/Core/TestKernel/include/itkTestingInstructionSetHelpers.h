@@ -0,0 +1,127 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTestingInstructionSetHelpers_h
+#define itkTestingInstructionSetHelpers_h
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkSIMDInstructionSet.h"
+#include <algorithm>
+#include <cmath>
+
+/** \file itkTestingInstructionSetHelpers.h
+ * Helpers shared by the tests which compare the vectorized paths of the
+ * filters, selected by SIMDInstructionSet, with their scalar path.
+ *
+ * \ingroup ITKTestKernel
+ */
+
+namespace itk
+{
+namespace Testing
+{
+
+/** Create an image of the given size filled with values drawn uniformly
+ * in [minimum, maximum), always with the same seed. */
+template< typename TImage >
+typename TImage::Pointer CreateRandomTestImage( const typename TImage::SizeType & size,
+                                                double minimum, double maximum )
+{
+  typedef Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions( size );
+  image->Allocate();
+  ImageRegionIterator< TImage > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    it.Set( static_cast< typename TImage::PixelType >( generator->GetUniformVariate( minimum, maximum ) ) );
+    }
+  return image;
+}
+
+/** Update the filter with each instruction set up to the supported one,
+ * and compare each output with the one of the scalar path. A pixel
+ * differs when it is further than tolerance * max(1, |expected|) from the
+ * expected value. Return false if more than allowedFraction of the pixels
+ * differ for any instruction set. */
+template< typename TFilter >
+bool CompareInstructionSets( const char *name, TFilter *filter, double tolerance, double allowedFraction = 0.0 )
+{
+  typedef typename TFilter::OutputImageType OutputImageType;
+  typedef SIMDInstructionSet                InstructionSet;
+
+  const InstructionSet::InstructionSetType maximumInstructionSet = InstructionSet::GetMaximumInstructionSet();
+  typename OutputImageType::Pointer reference;
+  bool passed = true;
+  for( int i = InstructionSet::Scalar; i <= InstructionSet::GetSupportedInstructionSet(); ++i )
+    {
+    const InstructionSet::InstructionSetType instructionSet = static_cast< InstructionSet::InstructionSetType >( i );
+    InstructionSet::SetMaximumInstructionSet( instructionSet );
+
+    filter->Modified();
+    filter->Update();
+    typename OutputImageType::Pointer output = filter->GetOutput();
+    output->DisconnectPipeline();
+    if( instructionSet == InstructionSet::Scalar )
+      {
+      reference = output;
+      continue;
+      }
+
+    SizeValueType                       differences = 0;
+    typename OutputImageType::IndexType firstIndex;
+    firstIndex.Fill( 0 );
+    double firstExpected = 0.0;
+    double firstValue = 0.0;
+    ImageRegionConstIterator< OutputImageType > rit( reference, reference->GetBufferedRegion() );
+    ImageRegionConstIterator< OutputImageType > oit( output, reference->GetBufferedRegion() );
+    for( ; !rit.IsAtEnd(); ++rit, ++oit )
+      {
+      const double expected = rit.Get();
+      const double value = oit.Get();
+      if( !( std::abs( value - expected ) <= tolerance * std::max( 1.0, std::abs( expected ) ) ) )
+        {
+        if( differences == 0 )
+          {
+          firstIndex = rit.GetIndex();
+          firstExpected = expected;
+          firstValue = value;
+          }
+        ++differences;
+        }
+      }
+    if( differences > allowedFraction * reference->GetBufferedRegion().GetNumberOfPixels() )
+      {
+      std::cerr << name << " with " << InstructionSet::GetInstructionSetName( instructionSet )
+                << ": " << differences << " pixels differ from the scalar path, the first one at "
+                << firstIndex << ": expected " << firstExpected << " but got " << firstValue << std::endl;
+      passed = false;
+      }
+    }
+  InstructionSet::SetMaximumInstructionSet( maximumInstructionSet );
+  return passed;
+}
+
+} // end namespace Testing
+} // end namespace itk
+
+#endif
@@ -239,6 +239,38 @@ public:
   virtual void TransformPoint( const InputPointType & inputPoint, OutputPointType & outputPoint,
     WeightsType & weights, ParameterIndexArrayType & indices, bool & inside ) const = 0;
 
+  /** Weights of each dimension, whose tensor product gives the
+   * interpolation weights over the support region of a point. */
+  typedef typename WeightsFunctionType::SeparableWeightsType SeparableWeightsType;
+
+  /** Compute the separable interpolation weights of a point, and the
+   * offset of the first coefficient of its support region in the
+   * buffer of the coefficient images. They only depend on the point
+   * and on the fixed parameters, so that points which are transformed
+   * repeatedly as the parameters change, e.g. the samples of a metric
+   * across the iterations of an optimizer, may compute them once and
+   * be transformed with TransformPointWithSeparableWeights().
+   * Returns false if the support region does not lie totally within
+   * the grid, in which case the displacement of the point is zero. */
+  bool ComputeSeparableWeights( const InputPointType & point, SeparableWeightsType & weights,
+                                OffsetValueType & supportOffset ) const;
+
+  /** Transform a point with the weights and the support offset computed
+   * by ComputeSeparableWeights() with the current fixed parameters, and
+   * with the current coefficients. \c inside is the value it returned. */
+  virtual OutputPointType TransformPointWithSeparableWeights( const InputPointType & point,
+                                                              const SeparableWeightsType & weights,
+                                                              OffsetValueType supportOffset,
+                                                              bool inside ) const;
+
+  /** Compute the Jacobian with respect to the parameters from the weights
+   * and the support offset computed by ComputeSeparableWeights(), as
+   * ComputeJacobianWithRespectToParameters() does from the point. */
+  void ComputeJacobianWithRespectToParametersWithSeparableWeights( const SeparableWeightsType & weights,
+                                                                   OffsetValueType supportOffset,
+                                                                   bool inside,
+                                                                   JacobianType & jacobian ) const;
+
   /** Get number of weights. */
   unsigned long GetNumberOfWeights() const
   {
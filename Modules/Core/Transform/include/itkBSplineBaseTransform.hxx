@@ -346,5 +346,163 @@ BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
   return outputPoint;
 }
 
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+bool
+BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
+::ComputeSeparableWeights( const InputPointType & point, SeparableWeightsType & weights,
+  OffsetValueType & supportOffset ) const
+{
+  supportOffset = 0;
+  if( !this->m_CoefficientImages[0]->GetBufferPointer() )
+    {
+    return false;
+    }
+
+  ContinuousIndexType index;
+  this->m_CoefficientImages[0]->TransformPhysicalPointToContinuousIndex( point, index );
+
+  // NOTE: if the support region does not lie totally within the grid
+  // we assume zero displacement, as TransformPoint() does
+  if( !this->InsideValidRegion( index ) )
+    {
+    return false;
+    }
+
+  IndexType supportIndex;
+  this->m_WeightsFunction->EvaluateSeparableWeights( index, weights, supportIndex );
+  supportOffset = this->m_CoefficientImages[0]->ComputeOffset( supportIndex );
+  return true;
+}
+
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+typename BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
+::OutputPointType
+BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
+::TransformPointWithSeparableWeights( const InputPointType & point, const SeparableWeightsType & weights,
+  OffsetValueType supportOffset, bool inside ) const
+{
+  OutputPointType outputPoint = point;
+  if( !inside )
+    {
+    return outputPoint;
+    }
+
+  const unsigned int     supportLength = SplineOrder + 1;
+  const OffsetValueType *offsetTable = this->m_CoefficientImages[0]->GetOffsetTable();
+  const PixelType *      coefficients[SpaceDimension];
+  ScalarType             displacement[SpaceDimension];
+  unsigned int           position[SpaceDimension];
+  for( unsigned int j = 0; j < SpaceDimension; j++ )
+    {
+    coefficients[j] = this->m_CoefficientImages[j]->GetBufferPointer() + supportOffset;
+    displacement[j] = NumericTraits<ScalarType>::ZeroValue();
+    position[j] = 0;
+    }
+
+  // Walk the lines of the support region along the first dimension, the
+  // weight of a coefficient being the product of the weights of its
+  // position in each dimension
+  OffsetValueType lineOffset = 0;
+  for(;; )
+    {
+    double lineWeight = 1.0;
+    for( unsigned int d = 1; d < SpaceDimension; d++ )
+      {
+      lineWeight *= weights[d][position[d]];
+      }
+    for( unsigned int j = 0; j < SpaceDimension; j++ )
+      {
+      const PixelType *line = coefficients[j] + lineOffset;
+      double           sum = 0.0;
+      for( unsigned int k = 0; k < supportLength; k++ )
+        {
+        sum += weights[0][k] * line[k];
+        }
+      displacement[j] += static_cast<ScalarType>( lineWeight * sum );
+      }
+
+    unsigned int d = 1;
+    for( ; d < SpaceDimension; d++ )
+      {
+      lineOffset += offsetTable[d];
+      if( ++position[d] < supportLength )
+        {
+        break;
+        }
+      position[d] = 0;
+      lineOffset -= supportLength * offsetTable[d];
+      }
+    if( d == SpaceDimension )
+      {
+      break;
+      }
+    }
+
+  for( unsigned int j = 0; j < SpaceDimension; j++ )
+    {
+    outputPoint[j] += displacement[j];
+    }
+  return outputPoint;
+}
+
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+void
+BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
+::ComputeJacobianWithRespectToParametersWithSeparableWeights( const SeparableWeightsType & weights,
+  OffsetValueType supportOffset, bool inside, JacobianType & jacobian ) const
+{
+  // Zero all components of jacobian
+  jacobian.SetSize( SpaceDimension, this->GetNumberOfParameters() );
+  jacobian.Fill( 0.0 );
+  if( !inside )
+    {
+    return;
+    }
+
+  const unsigned int     supportLength = SplineOrder + 1;
+  const OffsetValueType *offsetTable = this->m_CoefficientImages[0]->GetOffsetTable();
+  const SizeValueType    numberOfParametersPerDimension = this->GetNumberOfParametersPerDimension();
+  unsigned int           position[SpaceDimension];
+  for( unsigned int d = 0; d < SpaceDimension; d++ )
+    {
+    position[d] = 0;
+    }
+
+  // Walk the lines of the support region along the first dimension, as
+  // TransformPointWithSeparableWeights() does
+  OffsetValueType lineOffset = supportOffset;
+  for(;; )
+    {
+    double lineWeight = 1.0;
+    for( unsigned int d = 1; d < SpaceDimension; d++ )
+      {
+      lineWeight *= weights[d][position[d]];
+      }
+    for( unsigned int k = 0; k < supportLength; k++ )
+      {
+      for( unsigned int d = 0; d < SpaceDimension; d++ )
+        {
+        jacobian( d, lineOffset + k + d * numberOfParametersPerDimension ) = lineWeight * weights[0][k];
+        }
+      }
+
+    unsigned int d = 1;
+    for( ; d < SpaceDimension; d++ )
+      {
+      lineOffset += offsetTable[d];
+      if( ++position[d] < supportLength )
+        {
+        break;
+        }
+      position[d] = 0;
+      lineOffset -= supportLength * offsetTable[d];
+      }
+    if( d == SpaceDimension )
+      {
+      break;
+      }
+    }
+}
+
 } // namespace
 #endif
@@ -242,8 +242,9 @@ public:
   /** Interpolation weights function type. */
   typedef typename Superclass::WeightsFunctionType WeightsFunctionType;
 
-  typedef typename Superclass::WeightsType         WeightsType;
-  typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
+  typedef typename Superclass::WeightsType          WeightsType;
+  typedef typename Superclass::ContinuousIndexType  ContinuousIndexType;
+  typedef typename Superclass::SeparableWeightsType SeparableWeightsType;
 
   /** Parameter index array type. */
   typedef typename Superclass::ParameterIndexArrayType ParameterIndexArrayType;
@@ -260,6 +261,13 @@ public:
   virtual void TransformPoint( const InputPointType & inputPoint, OutputPointType & outputPoint,
     WeightsType & weights, ParameterIndexArrayType & indices, bool & inside ) const ITK_OVERRIDE;
 
+  /** Transform a point with precomputed separable weights, applying the
+   * bulk transform as TransformPoint() does. */
+  virtual OutputPointType TransformPointWithSeparableWeights( const InputPointType & point,
+                                                              const SeparableWeightsType & weights,
+                                                              OffsetValueType supportOffset,
+                                                              bool inside ) const ITK_OVERRIDE;
+
   virtual void ComputeJacobianWithRespectToParameters( const InputPointType &, JacobianType & ) const ITK_OVERRIDE;
 
   /** Return the number of parameters that completely define the Transfom */
@@ -581,6 +581,21 @@ BSplineDeformableTransform<TParametersValueType, NDimensions, VSplineOrder>
     }
 }
 
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+typename BSplineDeformableTransform<TParametersValueType, NDimensions, VSplineOrder>
+::OutputPointType
+BSplineDeformableTransform<TParametersValueType, NDimensions, VSplineOrder>
+::TransformPointWithSeparableWeights( const InputPointType & point, const SeparableWeightsType & weights,
+  OffsetValueType supportOffset, bool inside ) const
+{
+  if( this->m_BulkTransform )
+    {
+    return Superclass::TransformPointWithSeparableWeights(
+      this->m_BulkTransform->TransformPoint( point ), weights, supportOffset, inside );
+    }
+  return Superclass::TransformPointWithSeparableWeights( point, weights, supportOffset, inside );
+}
+
 // Compute the Jacobian in one position
 template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
 void
@@ -215,8 +215,9 @@ public:
   /** Interpolation weights function type. */
   typedef typename Superclass::WeightsFunctionType WeightsFunctionType;
 
-  typedef typename Superclass::WeightsType         WeightsType;
-  typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
+  typedef typename Superclass::WeightsType          WeightsType;
+  typedef typename Superclass::ContinuousIndexType  ContinuousIndexType;
+  typedef typename Superclass::SeparableWeightsType SeparableWeightsType;
 
   /** Parameter index array type. */
   typedef typename Superclass::ParameterIndexArrayType ParameterIndexArrayType;
@@ -20,9 +20,13 @@
 
 #include "itkConvolutionImageFilterBase.h"
 
+#include "itkFixedArray.h"
+#include "itkImageSource.h"
 #include "itkProgressAccumulator.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 
+#include <vector>
+
 namespace itk
 {
 /** \class ConvolutionImageFilter
@@ -42,6 +46,24 @@ namespace itk
  * The kernel can optionally be normalized to sum to 1 using
  * NormalizeOn(). Normalization is off by default.
  *
+ * The convolution is computed by one of several algorithms, set with
+ * SetAlgorithm(). SPATIAL computes the inner product of the kernel
+ * with the neighborhood of each pixel. SEPARABLE applies to kernels
+ * which are the outer product of one 1D kernel per dimension, such as
+ * Gaussian, box and Sobel kernels: the 1D kernels, found by singular
+ * value decompositions of the kernel, are applied one dimension after
+ * the other. FFT multiplies the Fourier transforms of the input and of
+ * the kernel with an FFTConvolutionImageFilter. AUTOMATIC selects
+ * SEPARABLE when the kernel is separable and its 1D kernels are cheaper
+ * than the whole kernel, otherwise FFT when the kernel has at least
+ * FFTMinimumKernelSize pixels, and SPATIAL otherwise. The default is
+ * SPATIAL, so that the output does not change unless another algorithm
+ * is requested. All the
+ * algorithms only read the input requested region, which is the output
+ * requested region padded by the kernel radius, so that the filter can
+ * be streamed. The results of the algorithms differ by the rounding of
+ * their floating point operations.
+ *
  * \warning This filter ignores the spacing, origin, and orientation
  * of the kernel image and treats them as identical to those in the
  * input image.
@@ -97,10 +119,38 @@ public:
   typedef typename OutputImageType::RegionType OutputRegionType;
   typedef typename KernelImageType::RegionType KernelRegionType;
 
+  /** The algorithms which compute the convolution. */
+  typedef enum
+  {
+    AUTOMATIC = 0,
+    SPATIAL,
+    SEPARABLE,
+    FFT
+  } AlgorithmType;
+
+  /** Set/get the algorithm which computes the convolution. When the
+   * kernel is not separable, SEPARABLE falls back to SPATIAL. Defaults
+   * to SPATIAL. */
+  itkSetEnumMacro(Algorithm, AlgorithmType);
+  itkGetEnumMacro(Algorithm, AlgorithmType);
+
+  /** Set/get the relative tolerance, on the Frobenius norm of the
+   * kernel, within which the kernel must be the outer product of 1D
+   * kernels to be separable. Defaults to 1e-6. */
+  itkSetMacro(SeparabilityTolerance, double);
+  itkGetConstMacro(SeparabilityTolerance, double);
+
+  /** Set/get the number of pixels of the non separable kernels from
+   * which AUTOMATIC uses the FFT. Defaults to 200. */
+  itkSetMacro(FFTMinimumKernelSize, SizeValueType);
+  itkGetConstMacro(FFTMinimumKernelSize, SizeValueType);
+
 protected:
   ConvolutionImageFilter();
   ~ConvolutionImageFilter() {}
 
+  void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
   /** ConvolutionImageFilter needs the entire image kernel, which in
    * general is going to be a different size then the output requested
    * region. As such, this filter needs to provide an implementation
@@ -124,6 +174,22 @@ protected:
   template< typename TImage >
   KernelSizeType GetKernelRadius(const TImage *kernelImage) const;
 
+  /** The 1D kernels of a separable kernel, in the order of the
+   * indices of the kernel image. */
+  typedef FixedArray< std::vector< double >, ImageDimension > SeparableKernelType;
+
+  /** Computes the 1D kernels whose outer product is the kernel, from the
+   * first singular vectors of the unfoldings of the kernel along each
+   * dimension. Returns false when the kernel differs from their outer
+   * product by more than the SeparabilityTolerance. */
+  template< typename TImage >
+  bool ComputeSeparableKernel(const TImage *kernelImage, SeparableKernelType & separableKernel) const;
+
+  /** The convolution by a separable kernel can be computed one dimension
+   * after the other only if the boundary condition extends the images
+   * independently along each dimension. */
+  bool GetBoundaryConditionIsSeparable() const;
+
 private:
   ConvolutionImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);         //purposely not implemented
@@ -131,6 +197,29 @@ private:
   template< typename TImage >
   void ComputeConvolution( const TImage *kernelImage,
                            ProgressAccumulator *progress );
+
+  template< typename TImage >
+  void ComputeSpatialConvolution( const TImage *kernelImage,
+                                  ProgressAccumulator *progress,
+                                  float progressWeight );
+
+  void ComputeSeparableConvolution( const SeparableKernelType & separableKernel,
+                                    ProgressAccumulator *progress,
+                                    float progressWeight );
+
+  template< typename TImage >
+  void ComputeFFTConvolution( const TImage *kernelImage,
+                              ProgressAccumulator *progress,
+                              float progressWeight );
+
+  /** Updates the last filter of the convolution minipipeline into the
+   * output of this filter, cropped to the valid region in VALID mode. */
+  void GraftOrCropOutput( ImageSource< OutputImageType > *convolutionFilter,
+                          ProgressAccumulator *progress );
+
+  AlgorithmType m_Algorithm;
+  double        m_SeparabilityTolerance;
+  SizeValueType m_FFTMinimumKernelSize;
 };
 }
 
@@ -21,13 +21,18 @@
 
 #include "itkConvolutionImageFilter.h"
 
+#include "itkConstantBoundaryCondition.h"
 #include "itkConstantPadImageFilter.h"
 #include "itkCropImageFilter.h"
+#include "itkFFTConvolutionImageFilter.h"
 #include "itkFlipImageFilter.h"
 #include "itkImageBase.h"
 #include "itkImageKernelOperator.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkNeighborhoodOperatorImageFilter.h"
 #include "itkNormalizeToConstantImageFilter.h"
+#include "itkPeriodicBoundaryCondition.h"
+#include "vnl/algo/vnl_svd.h"
 
 namespace itk
 {
@@ -35,6 +40,9 @@ template< typename TInputImage, typename TKernelImage, typename TOutputImage >
 ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
 ::ConvolutionImageFilter()
 {
+  m_Algorithm = Self::SPATIAL;
+  m_SeparabilityTolerance = 1e-6;
+  m_FFTMinimumKernelSize = 200;
 }
 
 template< typename TInputImage, typename TKernelImage, typename TOutputImage >
@@ -81,6 +89,74 @@ void
 ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
 ::ComputeConvolution( const TImage * kernelImage,
                       ProgressAccumulator * progress )
+{
+  float optionalFilterWeights = 0.0f;
+  if ( this->GetNormalize() )
+    {
+    optionalFilterWeights += 0.1f;
+    }
+
+  const KernelSizeType kernelSize = kernelImage->GetLargestPossibleRegion().GetSize();
+  SizeValueType        spatialCost = 1;
+  SizeValueType        separableCost = 0;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    spatialCost *= kernelSize[i];
+    if ( kernelSize[i] > 1 )
+      {
+      separableCost += kernelSize[i];
+      }
+    }
+
+  // Select the algorithm. The separable convolution makes a pass and
+  // an intermediate image per dimension, so it must save at least half
+  // of the operations of the spatial convolution.
+  AlgorithmType       algorithm = m_Algorithm;
+  SeparableKernelType separableKernel;
+  if ( algorithm == Self::AUTOMATIC || algorithm == Self::SEPARABLE )
+    {
+    const bool separable = this->GetBoundaryConditionIsSeparable()
+                           && this->ComputeSeparableKernel( kernelImage, separableKernel );
+    if ( algorithm == Self::SEPARABLE )
+      {
+      algorithm = separable ? Self::SEPARABLE : Self::SPATIAL;
+      }
+    else if ( separable && 2 * separableCost < spatialCost )
+      {
+      algorithm = Self::SEPARABLE;
+      }
+    else if ( spatialCost >= m_FFTMinimumKernelSize )
+      {
+      algorithm = Self::FFT;
+      }
+    else
+      {
+      algorithm = Self::SPATIAL;
+      }
+    }
+  itkDebugMacro( "Convolution algorithm: " << algorithm );
+
+  switch ( algorithm )
+    {
+    case Self::SEPARABLE:
+      this->ComputeSeparableConvolution( separableKernel, progress, 1.0f - optionalFilterWeights );
+      break;
+    case Self::FFT:
+      this->ComputeFFTConvolution( kernelImage, progress, 1.0f - optionalFilterWeights );
+      break;
+    default:
+      this->ComputeSpatialConvolution( kernelImage, progress, 1.0f - optionalFilterWeights );
+      break;
+    }
+}
+
+template< typename TInputImage, typename TKernelImage, typename TOutputImage >
+template< typename TImage >
+void
+ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
+::ComputeSpatialConvolution( const TImage * kernelImage,
+                             ProgressAccumulator * progress,
+                             float progressWeight )
 {
   typedef typename TImage::PixelType KernelImagePixelType;
   typedef ImageKernelOperator< KernelImagePixelType, ImageDimension > KernelOperatorType;
@@ -89,10 +165,6 @@ ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
   bool kernelNeedsPadding = this->GetKernelNeedsPadding();
 
   float optionalFilterWeights = 0.0f;
-  if ( this->GetNormalize() )
-    {
-    optionalFilterWeights += 0.1f;
-    }
   if ( this->GetKernelNeedsPadding() )
     {
     optionalFilterWeights += 0.1f;
@@ -120,7 +192,7 @@ ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
     kernelPadImageFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
     kernelPadImageFilter->ReleaseDataFlagOn();
     kernelPadImageFilter->SetInput( flipper->GetOutput() );
-    progress->RegisterInternalFilter( kernelPadImageFilter, 0.1f );
+    progress->RegisterInternalFilter( kernelPadImageFilter, 0.1f * progressWeight );
     kernelPadImageFilter->UpdateLargestPossibleRegion();
 
     kernelOperator.SetImageKernel( kernelPadImageFilter->GetOutput() );
@@ -146,8 +218,213 @@ ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
   convolutionFilter->SetInput( localInput );
   convolutionFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
   convolutionFilter->ReleaseDataFlagOn();
-  progress->RegisterInternalFilter( convolutionFilter, 1.0f - optionalFilterWeights );
+  progress->RegisterInternalFilter( convolutionFilter, ( 1.0f - optionalFilterWeights ) * progressWeight );
+
+  this->GraftOrCropOutput( convolutionFilter, progress );
+}
+
+template< typename TInputImage, typename TKernelImage, typename TOutputImage >
+void
+ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
+::ComputeSeparableConvolution( const SeparableKernelType & separableKernel,
+                               ProgressAccumulator * progress,
+                               float progressWeight )
+{
+  typedef typename NumericTraits< InputPixelType >::RealType RealPixelType;
+  typedef Image< RealPixelType, ImageDimension >             RealImageType;
+  typedef Image< double, ImageDimension >                    KernelFactorImageType;
+  typedef ImageKernelOperator< double, ImageDimension >      KernelOperatorType;
+
+  typedef NeighborhoodOperatorImageFilter< InputImageType, OutputImageType, double > SinglePassFilterType;
+  typedef NeighborhoodOperatorImageFilter< InputImageType, RealImageType, double >   FirstPassFilterType;
+  typedef NeighborhoodOperatorImageFilter< RealImageType, RealImageType, double >    IntermediatePassFilterType;
+  typedef NeighborhoodOperatorImageFilter< RealImageType, OutputImageType, double >  LastPassFilterType;
+
+  // One pass along each dimension where the kernel is not a single
+  // pixel, and at least one pass.
+  std::vector< unsigned int > passDimensions;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    if ( separableKernel[i].size() > 1 )
+      {
+      passDimensions.push_back( i );
+      }
+    }
+  if ( passDimensions.empty() )
+    {
+    passDimensions.push_back( 0 );
+    }
+  const unsigned int numberOfPasses = static_cast< unsigned int >( passDimensions.size() );
+
+  // The 1D operators, flipped and padded to an odd size as the kernel
+  // of the spatial convolution. The factors of the single pixel
+  // dimensions scale the first operator.
+  double scale = 1.0;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    if ( separableKernel[i].size() == 1 )
+      {
+      scale *= separableKernel[i][0];
+      }
+    }
+  std::vector< KernelOperatorType >                      operators( numberOfPasses );
+  std::vector< typename KernelFactorImageType::Pointer > factorImages( numberOfPasses );
+  std::vector< double >                                  factorSums( numberOfPasses, 0.0 );
+  for ( unsigned int p = 0; p < numberOfPasses; ++p )
+    {
+    const unsigned int            dimension = passDimensions[p];
+    const std::vector< double > & factor = separableKernel[dimension];
+    const SizeValueType           padSize = 1 - factor.size() % 2;
+
+    typename KernelFactorImageType::SizeType size;
+    size.Fill( 1 );
+    size[dimension] = factor.size() + padSize;
+    factorImages[p] = KernelFactorImageType::New();
+    factorImages[p]->SetRegions( size );
+    factorImages[p]->Allocate();
+    double *buffer = factorImages[p]->GetBufferPointer();
+    buffer[0] = 0.0;
+    for ( SizeValueType j = 0; j < factor.size(); ++j )
+      {
+      buffer[j + padSize] = factor[factor.size() - 1 - j] * ( p == 0 ? scale : 1.0 );
+      factorSums[p] += buffer[j + padSize];
+      }
+
+    KernelSizeType radius;
+    radius.Fill( 0 );
+    radius[dimension] = factor.size() / 2;
+    operators[p].SetImageKernel( factorImages[p] );
+    operators[p].CreateToRadius( radius );
+    }
+
+  // The passes after the first one filter images of real pixels. Along
+  // the dimension of a pass, the previous passes have transformed the
+  // boundary condition of the input the same way as the pixels.
+  ZeroFluxNeumannBoundaryCondition< RealImageType > neumannCondition;
+  PeriodicBoundaryCondition< RealImageType >        periodicCondition;
+  std::vector< ConstantBoundaryCondition< RealImageType > > constantConditions( numberOfPasses );
+  const ConstantBoundaryCondition< InputImageType > *inputConstantCondition =
+    dynamic_cast< const ConstantBoundaryCondition< InputImageType > * >( this->GetBoundaryCondition() );
+  std::vector< ImageBoundaryCondition< RealImageType > * > realConditions( numberOfPasses );
+  RealPixelType constant = NumericTraits< RealPixelType >::ZeroValue();
+  if ( inputConstantCondition )
+    {
+    constant = static_cast< RealPixelType >( inputConstantCondition->GetConstant() );
+    }
+  for ( unsigned int p = 1; p < numberOfPasses; ++p )
+    {
+    constant = static_cast< RealPixelType >( constant * factorSums[p - 1] );
+    if ( inputConstantCondition )
+      {
+      constantConditions[p].SetConstant( constant );
+      realConditions[p] = &constantConditions[p];
+      }
+    else if ( dynamic_cast< const PeriodicBoundaryCondition< InputImageType > * >( this->GetBoundaryCondition() ) )
+      {
+      realConditions[p] = &periodicCondition;
+      }
+    else
+      {
+      realConditions[p] = &neumannCondition;
+      }
+    }
+
+  typename InputImageType::Pointer localInput = InputImageType::New();
+  localInput->Graft( this->GetInput() );
+
+  const float passWeight = progressWeight / numberOfPasses;
+  if ( numberOfPasses == 1 )
+    {
+    typename SinglePassFilterType::Pointer pass = SinglePassFilterType::New();
+    pass->SetOperator( operators[0] );
+    pass->OverrideBoundaryCondition( this->GetBoundaryCondition() );
+    pass->SetInput( localInput );
+    pass->SetNumberOfThreads( this->GetNumberOfThreads() );
+    pass->ReleaseDataFlagOn();
+    progress->RegisterInternalFilter( pass, passWeight );
+
+    this->GraftOrCropOutput( pass, progress );
+    return;
+    }
+
+  typename FirstPassFilterType::Pointer firstPass = FirstPassFilterType::New();
+  firstPass->SetOperator( operators[0] );
+  firstPass->OverrideBoundaryCondition( this->GetBoundaryCondition() );
+  firstPass->SetInput( localInput );
+  firstPass->SetNumberOfThreads( this->GetNumberOfThreads() );
+  firstPass->ReleaseDataFlagOn();
+  progress->RegisterInternalFilter( firstPass, passWeight );
+
+  std::vector< typename IntermediatePassFilterType::Pointer > intermediatePasses;
+  RealImageType *realImage = firstPass->GetOutput();
+  for ( unsigned int p = 1; p + 1 < numberOfPasses; ++p )
+    {
+    typename IntermediatePassFilterType::Pointer pass = IntermediatePassFilterType::New();
+    pass->SetOperator( operators[p] );
+    pass->OverrideBoundaryCondition( realConditions[p] );
+    pass->SetInput( realImage );
+    pass->SetNumberOfThreads( this->GetNumberOfThreads() );
+    pass->ReleaseDataFlagOn();
+    progress->RegisterInternalFilter( pass, passWeight );
+    intermediatePasses.push_back( pass );
+    realImage = pass->GetOutput();
+    }
+
+  typename LastPassFilterType::Pointer lastPass = LastPassFilterType::New();
+  lastPass->SetOperator( operators[numberOfPasses - 1] );
+  lastPass->OverrideBoundaryCondition( realConditions[numberOfPasses - 1] );
+  lastPass->SetInput( realImage );
+  lastPass->SetNumberOfThreads( this->GetNumberOfThreads() );
+  lastPass->ReleaseDataFlagOn();
+  progress->RegisterInternalFilter( lastPass, passWeight );
+
+  this->GraftOrCropOutput( lastPass, progress );
+}
+
+template< typename TInputImage, typename TKernelImage, typename TOutputImage >
+template< typename TImage >
+void
+ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
+::ComputeFFTConvolution( const TImage * kernelImage,
+                         ProgressAccumulator * progress,
+                         float progressWeight )
+{
+  // The FFT convolution is computed over the buffered region of the
+  // input, which is the output requested region padded by the kernel
+  // radius, so that the filter streams as with the other algorithms.
+  // The boundary condition is applied at the border of this region,
+  // which only affects the pixels out of the output requested region,
+  // except at the border of the largest possible region.
+  typename InputImageType::Pointer localInput = InputImageType::New();
+  localInput->Graft( this->GetInput() );
+  localInput->SetLargestPossibleRegion( localInput->GetBufferedRegion() );
+  localInput->SetRequestedRegion( localInput->GetBufferedRegion() );
+
+  typedef FFTConvolutionImageFilter< InputImageType, TImage, OutputImageType > FFTConvolutionFilterType;
+  typename FFTConvolutionFilterType::Pointer convolutionFilter = FFTConvolutionFilterType::New();
+  convolutionFilter->SetInput( localInput );
+  convolutionFilter->SetKernelImage( kernelImage );
+  convolutionFilter->SetBoundaryCondition( this->GetBoundaryCondition() );
+  convolutionFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  convolutionFilter->ReleaseDataFlagOn();
+  progress->RegisterInternalFilter( convolutionFilter, progressWeight );
+
+  convolutionFilter->GetOutput()->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+  convolutionFilter->Update();
 
+  // Only take the buffer, as the largest possible region of the output
+  // of the minipipeline is the buffered region of the input.
+  OutputImageType *output = this->GetOutput();
+  output->SetBufferedRegion( convolutionFilter->GetOutput()->GetBufferedRegion() );
+  output->SetPixelContainer( convolutionFilter->GetOutput()->GetPixelContainer() );
+}
+
+template< typename TInputImage, typename TKernelImage, typename TOutputImage >
+void
+ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
+::GraftOrCropOutput( ImageSource< OutputImageType > * convolutionFilter,
+                     ProgressAccumulator * progress )
+{
   if ( this->GetOutputRegionMode() == Self::SAME )
     {
     // Graft the output of the convolution filter onto this filter's
@@ -164,6 +441,7 @@ ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
     typedef typename CropFilterType::SizeType                   CropSizeType;
 
     // Set up the crop sizes.
+    KernelSizeType radius = this->GetKernelRadius( this->GetKernelImage() );
     CropSizeType upperCropSize( radius );
     CropSizeType lowerCropSize( radius );
 
@@ -193,6 +471,98 @@ ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
     }
 }
 
+template< typename TInputImage, typename TKernelImage, typename TOutputImage >
+template< typename TImage >
+bool
+ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
+::ComputeSeparableKernel( const TImage * kernelImage,
+                          SeparableKernelType & separableKernel ) const
+{
+  const KernelSizeType kernelSize = kernelImage->GetLargestPossibleRegion().GetSize();
+
+  std::vector< double > kernel;
+  kernel.reserve( kernelImage->GetLargestPossibleRegion().GetNumberOfPixels() );
+  ImageRegionConstIterator< TImage > it( kernelImage, kernelImage->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    kernel.push_back( static_cast< double >( it.Get() ) );
+    }
+  const SizeValueType numberOfPixels = kernel.size();
+
+  // The first right singular vector of the unfolding of the kernel
+  // along a dimension, where each row holds the pixels of a line of the
+  // kernel along this dimension, is the best 1D kernel along it.
+  SizeValueType stride = 1;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    const SizeValueType size = kernelSize[i];
+    separableKernel[i].resize( size );
+    if ( size == 1 )
+      {
+      separableKernel[i][0] = 1.0;
+      continue;
+      }
+    vnl_matrix< double > unfolding( numberOfPixels / size, size );
+    for ( SizeValueType j = 0; j < numberOfPixels; ++j )
+      {
+      const SizeValueType row = j % stride + ( j / ( stride * size ) ) * stride;
+      unfolding( row, ( j / stride ) % size ) = kernel[j];
+      }
+    vnl_svd< double > svd( unfolding );
+    for ( SizeValueType j = 0; j < size; ++j )
+      {
+      separableKernel[i][j] = svd.V( j, 0 );
+      }
+    stride *= size;
+    }
+
+  // The 1D kernels have unit norms, so their outer product is scaled by
+  // its inner product with the kernel.
+  std::vector< double > product( numberOfPixels );
+  double                scale = 0.0;
+  double                squaredNorm = 0.0;
+  for ( SizeValueType j = 0; j < numberOfPixels; ++j )
+    {
+    product[j] = 1.0;
+    SizeValueType index = j;
+    for ( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      product[j] *= separableKernel[i][index % kernelSize[i]];
+      index /= kernelSize[i];
+      }
+    scale += product[j] * kernel[j];
+    squaredNorm += kernel[j] * kernel[j];
+    }
+  double squaredResidual = 0.0;
+  for ( SizeValueType j = 0; j < numberOfPixels; ++j )
+    {
+    const double difference = kernel[j] - scale * product[j];
+    squaredResidual += difference * difference;
+    }
+  if ( squaredResidual > m_SeparabilityTolerance * m_SeparabilityTolerance * squaredNorm )
+    {
+    return false;
+    }
+
+  for ( SizeValueType j = 0; j < separableKernel[0].size(); ++j )
+    {
+    separableKernel[0][j] *= scale;
+    }
+  return true;
+}
+
+template< typename TInputImage, typename TKernelImage, typename TOutputImage >
+bool
+ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
+::GetBoundaryConditionIsSeparable() const
+{
+  const ImageBoundaryCondition< InputImageType > *condition = this->GetBoundaryCondition();
+
+  return dynamic_cast< const ZeroFluxNeumannBoundaryCondition< InputImageType > * >( condition ) != ITK_NULLPTR
+         || dynamic_cast< const PeriodicBoundaryCondition< InputImageType > * >( condition ) != ITK_NULLPTR
+         || dynamic_cast< const ConstantBoundaryCondition< InputImageType > * >( condition ) != ITK_NULLPTR;
+}
+
 template< typename TInputImage, typename TKernelImage, typename TOutputImage >
 bool
 ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
@@ -291,5 +661,17 @@ ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
     kernelPtr->SetRequestedRegionToLargestPossibleRegion();
     }
 }
+
+template< typename TInputImage, typename TKernelImage, typename TOutputImage >
+void
+ConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Algorithm: " << m_Algorithm << std::endl;
+  os << indent << "SeparabilityTolerance: " << m_SeparabilityTolerance << std::endl;
+  os << indent << "FFTMinimumKernelSize: " << m_FFTMinimumKernelSize << std::endl;
+}
 }
 #endif
@@ -36,6 +36,21 @@ namespace itk
  * convolution theorem to accelerate the convolution computation when
  * the kernel is large.
  *
+ * By default, the whole input image is transformed at once. When
+ * Tiling is on, the filter only requests the output requested region
+ * padded by the kernel radius and by the TileMargin, and transforms
+ * this block of the input. The pixels of the block whose convolution
+ * is affected by the padding of the block are discarded, as in the
+ * overlap-save method, so that the filter can be streamed, for
+ * instance with a StreamingImageFilter, and only holds the Fourier
+ * transforms of a block in memory. The Fourier transform of the
+ * kernel is then kept between the blocks of the same size. The
+ * convolution of the blocks is exact, except with a
+ * PeriodicBoundaryCondition, which wraps around the blocks instead of
+ * the image. The filters which invert the convolution, such as the
+ * deconvolution filters, depend on the whole image, and need a
+ * TileMargin to approximate their output on each block.
+ *
  * \warning This filter ignores the spacing, origin, and orientation
  * of the kernel image and treats them as identical to those in the
  * input image.
@@ -105,6 +120,19 @@ public:
   itkSetMacro(SizeGreatestPrimeFactor, SizeValueType);
   itkGetMacro(SizeGreatestPrimeFactor, SizeValueType);
 
+  /** Set/get whether the output is computed from the block of the
+   * input which it depends on, instead of the whole input, so that the
+   * filter can be streamed. Defaults to false. */
+  itkSetMacro(Tiling, bool);
+  itkGetConstMacro(Tiling, bool);
+  itkBooleanMacro(Tiling);
+
+  /** Set/get the number of pixels by which the blocks of the input are
+   * padded, beyond the kernel radius, when Tiling is on. Defaults to
+   * zero, which is enough for the convolution. */
+  itkSetMacro(TileMargin, InputSizeType);
+  itkGetConstReferenceMacro(TileMargin, InputSizeType);
+
 protected:
   FFTConvolutionImageFilter();
   ~FFTConvolutionImageFilter() {}
@@ -122,7 +150,9 @@ protected:
    * general is going to be a different size than the output requested
    * region. As such, this filter needs to provide an implementation
    * for GenerateInputRequestedRegion() in order to inform the
-   * pipeline execution model.
+   * pipeline execution model. It requests the whole input, or the
+   * output requested region padded by the kernel radius and the
+   * TileMargin when Tiling is on.
    *
    * \sa ProcessObject::GenerateInputRequestedRegion()  */
   void GenerateInputRequestedRegion() ITK_OVERRIDE;
@@ -178,7 +208,8 @@ protected:
    * same, then this lower bound can be used to move the index of the
    * padded kernel and padded input so that they are the same. This
    * is important to avoid exceptions in filters that operate on these
-   * images. */
+   * images. The padding applies to the buffered region of the input,
+   * which is the largest possible region unless Tiling is on. */
   InputSizeType GetPadLowerBound() const;
 
   /** Get the pad size. */
@@ -194,6 +225,17 @@ private:
   void operator=(const Self &);         //purposely not implemented
 
   SizeValueType m_SizeGreatestPrimeFactor;
+
+  bool          m_Tiling;
+  InputSizeType m_TileMargin;
+
+  /** Fourier transform of the kernel, kept between the blocks when
+   * Tiling is on, with the kernel, its modified time and the size of
+   * the blocks it was computed for. */
+  InternalComplexImagePointerType m_TransformedKernel;
+  const KernelImageType *         m_TransformedKernelSource;
+  ModifiedTimeType                m_TransformedKernelMTime;
+  InputSizeType                   m_TransformedKernelPadSize;
 };
 }
 
@@ -31,6 +31,8 @@
 #include "itkNormalizeToConstantImageFilter.h"
 #include "itkMath.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -39,6 +41,12 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
 ::FFTConvolutionImageFilter()
 {
   m_SizeGreatestPrimeFactor = FFTFilterType::New()->GetSizeGreatestPrimeFactor();
+  m_Tiling = false;
+  m_TileMargin.Fill( 0 );
+  m_TransformedKernel = ITK_NULLPTR;
+  m_TransformedKernelSource = ITK_NULLPTR;
+  m_TransformedKernelMTime = 0;
+  m_TransformedKernelPadSize.Fill( 0 );
 }
 
 template< typename TInputImage, typename TKernelImage, typename TOutputImage, typename TInternalPrecision >
@@ -46,12 +54,29 @@ void
 FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
 ::GenerateInputRequestedRegion()
 {
-  // Request the largest possible region for both input images.
+  // Request the largest possible region for both input images, or the
+  // block of the input which the output requested region depends on.
   if ( this->GetInput() )
     {
     typename InputImageType::Pointer imagePtr =
       const_cast< InputImageType * >( this->GetInput() );
-    imagePtr->SetRequestedRegionToLargestPossibleRegion();
+    if ( m_Tiling && this->GetKernelImage() )
+      {
+      InputRegionType inputRegion = this->GetOutput()->GetRequestedRegion();
+      KernelSizeType kernelSize = this->GetKernelImage()->GetLargestPossibleRegion().GetSize();
+      InputSizeType radius;
+      for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        radius[i] = kernelSize[i] / 2 + m_TileMargin[i];
+        }
+      inputRegion.PadByRadius( radius );
+      inputRegion.Crop( imagePtr->GetLargestPossibleRegion() );
+      imagePtr->SetRequestedRegion( inputRegion );
+      }
+    else
+      {
+      imagePtr->SetRequestedRegionToLargestPossibleRegion();
+      }
     }
 
   if ( this->GetKernelImage() )
@@ -132,11 +157,17 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
            InternalImagePointerType & paddedInput,
            ProgressAccumulator * progress, float progressWeight)
 {
-  // Pad the image
+  // Pad the image. The padding applies to the buffered region, so
+  // that only the block of the input is transformed when Tiling is on.
   InputSizeType padSize = this->GetPadSize();
-  InputRegionType inputRegion = input->GetLargestPossibleRegion();
+  InputRegionType inputRegion = input->GetBufferedRegion();
   InputSizeType inputSize = inputRegion.GetSize();
 
+  typename InputImageType::Pointer localInput = InputImageType::New();
+  localInput->Graft( input );
+  localInput->SetLargestPossibleRegion( inputRegion );
+  localInput->SetRequestedRegion( inputRegion );
+
   typedef PadImageFilter< InputImageType, InputImageType > InputPadFilterType;
   typename InputPadFilterType::Pointer inputPadder = InputPadFilterType::New();
   inputPadder->SetBoundaryCondition( this->GetBoundaryCondition() );
@@ -155,7 +186,7 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
     }
   inputPadder->SetPadUpperBound( inputUpperBound );
   inputPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
-  inputPadder->SetInput( input );
+  inputPadder->SetInput( localInput );
   inputPadder->ReleaseDataFlagOn();
   progress->RegisterInternalFilter( inputPadder, 0.5f * progressWeight );
 
@@ -215,69 +246,89 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
     kernelUpperBound[i] = padSize[i] - kernelSize[i];
     }
 
-  InternalImagePointerType paddedKernelImage = ITK_NULLPTR;
-
-  float paddingWeight = 0.2f;
-  if ( this->GetNormalize() )
+  // When Tiling is on, the Fourier transform of the kernel is reused
+  // for the following blocks of the same size.
+  const ModifiedTimeType kernelMTime = std::max( kernel->GetMTime(), this->GetMTime() );
+  InternalComplexImagePointerType transformedKernel = ITK_NULLPTR;
+  if ( m_Tiling && m_TransformedKernel && m_TransformedKernelSource == kernel
+       && m_TransformedKernelMTime == kernelMTime && m_TransformedKernelPadSize == padSize )
     {
-    typedef NormalizeToConstantImageFilter< KernelImageType, InternalImageType >
-      NormalizeFilterType;
-    typename NormalizeFilterType::Pointer normalizeFilter = NormalizeFilterType::New();
-    normalizeFilter->SetConstant( NumericTraits< TInternalPrecision >::OneValue() );
-    normalizeFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
-    normalizeFilter->SetInput( kernel );
-    normalizeFilter->ReleaseDataFlagOn();
-    progress->RegisterInternalFilter( normalizeFilter,
-                                      0.2f * paddingWeight * progressWeight );
-
-    // Pad the kernel image with zeros.
-    typedef ConstantPadImageFilter< InternalImageType, InternalImageType > KernelPadType;
-    typedef typename KernelPadType::Pointer                                KernelPadPointer;
-    KernelPadPointer kernelPadder = KernelPadType::New();
-    kernelPadder->SetConstant( NumericTraits< TInternalPrecision >::ZeroValue() );
-    kernelPadder->SetPadUpperBound( kernelUpperBound );
-    kernelPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
-    kernelPadder->SetInput( normalizeFilter->GetOutput() );
-    kernelPadder->ReleaseDataFlagOn();
-    progress->RegisterInternalFilter( kernelPadder,
-                                      0.8f * paddingWeight * progressWeight );
-    paddedKernelImage = kernelPadder->GetOutput();
+    transformedKernel = m_TransformedKernel;
     }
   else
     {
-    // Pad the kernel image with zeros.
-    typedef ConstantPadImageFilter< KernelImageType, InternalImageType > KernelPadType;
-    typedef typename KernelPadType::Pointer                              KernelPadPointer;
-    KernelPadPointer kernelPadder = KernelPadType::New();
-    kernelPadder->SetConstant( NumericTraits< TInternalPrecision >::ZeroValue() );
-    kernelPadder->SetPadUpperBound( kernelUpperBound );
-    kernelPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
-    kernelPadder->SetInput( kernel );
-    kernelPadder->ReleaseDataFlagOn();
-    progress->RegisterInternalFilter( kernelPadder,
-                                      paddingWeight * progressWeight );
-    paddedKernelImage = kernelPadder->GetOutput();
-    }
+    InternalImagePointerType paddedKernelImage = ITK_NULLPTR;
 
-  // Shift the padded kernel image.
-  typedef CyclicShiftImageFilter< InternalImageType, InternalImageType > KernelShiftFilterType;
-  typename KernelShiftFilterType::Pointer kernelShifter = KernelShiftFilterType::New();
-  typename KernelShiftFilterType::OffsetType kernelShift;
-  for (unsigned int i = 0; i < ImageDimension; ++i)
-    {
-    kernelShift[i] = -(kernelSize[i] / 2);
+    float paddingWeight = 0.2f;
+    if ( this->GetNormalize() )
+      {
+      typedef NormalizeToConstantImageFilter< KernelImageType, InternalImageType >
+        NormalizeFilterType;
+      typename NormalizeFilterType::Pointer normalizeFilter = NormalizeFilterType::New();
+      normalizeFilter->SetConstant( NumericTraits< TInternalPrecision >::OneValue() );
+      normalizeFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+      normalizeFilter->SetInput( kernel );
+      normalizeFilter->ReleaseDataFlagOn();
+      progress->RegisterInternalFilter( normalizeFilter,
+                                        0.2f * paddingWeight * progressWeight );
+
+      // Pad the kernel image with zeros.
+      typedef ConstantPadImageFilter< InternalImageType, InternalImageType > KernelPadType;
+      typedef typename KernelPadType::Pointer                                KernelPadPointer;
+      KernelPadPointer kernelPadder = KernelPadType::New();
+      kernelPadder->SetConstant( NumericTraits< TInternalPrecision >::ZeroValue() );
+      kernelPadder->SetPadUpperBound( kernelUpperBound );
+      kernelPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
+      kernelPadder->SetInput( normalizeFilter->GetOutput() );
+      kernelPadder->ReleaseDataFlagOn();
+      progress->RegisterInternalFilter( kernelPadder,
+                                        0.8f * paddingWeight * progressWeight );
+      paddedKernelImage = kernelPadder->GetOutput();
+      }
+    else
+      {
+      // Pad the kernel image with zeros.
+      typedef ConstantPadImageFilter< KernelImageType, InternalImageType > KernelPadType;
+      typedef typename KernelPadType::Pointer                              KernelPadPointer;
+      KernelPadPointer kernelPadder = KernelPadType::New();
+      kernelPadder->SetConstant( NumericTraits< TInternalPrecision >::ZeroValue() );
+      kernelPadder->SetPadUpperBound( kernelUpperBound );
+      kernelPadder->SetNumberOfThreads( this->GetNumberOfThreads() );
+      kernelPadder->SetInput( kernel );
+      kernelPadder->ReleaseDataFlagOn();
+      progress->RegisterInternalFilter( kernelPadder,
+                                        paddingWeight * progressWeight );
+      paddedKernelImage = kernelPadder->GetOutput();
+      }
+
+    // Shift the padded kernel image.
+    typedef CyclicShiftImageFilter< InternalImageType, InternalImageType > KernelShiftFilterType;
+    typename KernelShiftFilterType::Pointer kernelShifter = KernelShiftFilterType::New();
+    typename KernelShiftFilterType::OffsetType kernelShift;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      kernelShift[i] = -(kernelSize[i] / 2);
+      }
+    kernelShifter->SetShift( kernelShift );
+    kernelShifter->SetNumberOfThreads( this->GetNumberOfThreads() );
+    kernelShifter->SetInput( paddedKernelImage );
+    kernelShifter->ReleaseDataFlagOn();
+    progress->RegisterInternalFilter( kernelShifter, 0.1f * progressWeight );
+
+    typename FFTFilterType::Pointer kernelFFTFilter = FFTFilterType::New();
+    kernelFFTFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+    kernelFFTFilter->SetInput( kernelShifter->GetOutput() );
+    progress->RegisterInternalFilter( kernelFFTFilter, 0.699f * progressWeight );
+    kernelFFTFilter->Update();
+
+    transformedKernel = kernelFFTFilter->GetOutput();
+    transformedKernel->DisconnectPipeline();
+
+    m_TransformedKernel = m_Tiling ? transformedKernel : ITK_NULLPTR;
+    m_TransformedKernelSource = kernel;
+    m_TransformedKernelMTime = kernelMTime;
+    m_TransformedKernelPadSize = padSize;
     }
-  kernelShifter->SetShift( kernelShift );
-  kernelShifter->SetNumberOfThreads( this->GetNumberOfThreads() );
-  kernelShifter->SetInput( paddedKernelImage );
-  kernelShifter->ReleaseDataFlagOn();
-  progress->RegisterInternalFilter( kernelShifter, 0.1f * progressWeight );
-
-  typename FFTFilterType::Pointer kernelFFTFilter = FFTFilterType::New();
-  kernelFFTFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
-  kernelFFTFilter->SetInput( kernelShifter->GetOutput() );
-  progress->RegisterInternalFilter( kernelFFTFilter, 0.699f * progressWeight );
-  kernelFFTFilter->Update();
 
   typedef ChangeInformationImageFilter< InternalComplexImageType > InfoFilterType;
   typename InfoFilterType::Pointer kernelInfoFilter = InfoFilterType::New();
@@ -285,7 +336,7 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
 
   typedef typename InfoFilterType::OutputImageOffsetValueType InfoOffsetValueType;
   const InputSizeType & inputLowerBound = this->GetPadLowerBound();
-  const InputIndexType & inputIndex = this->GetInput()->GetLargestPossibleRegion().GetIndex();
+  const InputIndexType & inputIndex = this->GetInput()->GetBufferedRegion().GetIndex();
   const KernelIndexType & kernelIndex = kernel->GetLargestPossibleRegion().GetIndex();
   InfoOffsetValueType kernelOffset[ImageDimension];
   for (int i = 0; i < ImageDimension; ++i)
@@ -294,7 +345,7 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
     }
   kernelInfoFilter->SetOutputOffset( kernelOffset );
   kernelInfoFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
-  kernelInfoFilter->SetInput( kernelFFTFilter->GetOutput() );
+  kernelInfoFilter->SetInput( transformedKernel );
   progress->RegisterInternalFilter( kernelInfoFilter, 0.001f * progressWeight );
   kernelInfoFilter->Update();
 
@@ -335,16 +386,10 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
   extractFilter->InPlaceOn();
   extractFilter->GraftOutput( this->GetOutput() );
 
-  // Set up the crop sizes.
-  if ( this->GetOutputRegionMode() == Self::SAME )
-    {
-    InputRegionType sameRegion = this->GetInput()->GetLargestPossibleRegion();
-    extractFilter->SetExtractionRegion( sameRegion );
-    }
-  else // OutputRegionMode == Self::VALID
-    {
-    extractFilter->SetExtractionRegion( this->GetValidRegion() );
-    }
+  // Only extract the output requested region, which is within the
+  // same or valid region, and within the block of the input when
+  // Tiling is on.
+  extractFilter->SetExtractionRegion( this->GetOutput()->GetRequestedRegion() );
 
   // Graft the minipipeline output to this filter.
   extractFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
@@ -371,7 +416,7 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
 ::GetPadLowerBound() const
 {
   typename InputImageType::ConstPointer inputImage = this->GetInput();
-  InputSizeType inputSize = inputImage->GetLargestPossibleRegion().GetSize();
+  InputSizeType inputSize = inputImage->GetBufferedRegion().GetSize();
   InputSizeType padSize = this->GetPadSize();
 
   InputSizeType inputLowerBound;
@@ -389,7 +434,7 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
 ::GetPadSize() const
 {
   typename InputImageType::ConstPointer inputImage = this->GetInput();
-  InputSizeType inputSize = inputImage->GetLargestPossibleRegion().GetSize();
+  InputSizeType inputSize = inputImage->GetBufferedRegion().GetSize();
   typename KernelImageType::ConstPointer kernelImage = this->GetKernelImage();
   KernelSizeType kernelSize = kernelImage->GetLargestPossibleRegion().GetSize();
 
@@ -425,6 +470,8 @@ FFTConvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPre
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "SizeGreatestPrimeFactor: " << m_SizeGreatestPrimeFactor << std::endl;
+  os << indent << "Tiling: " << m_Tiling << std::endl;
+  os << indent << "TileMargin: " << m_TileMargin << std::endl;
 }
 
 }
@@ -0,0 +1,147 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkConvolutionImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkPipelineMonitorImageFilter.h"
+#include "itkSimpleFilterWatcher.h"
+#include "itkStreamingImageFilter.h"
+
+int itkConvolutionImageFilterAlgorithmsTest(int argc, char * argv[])
+{
+
+  if ( argc < 5 )
+    {
+    std::cout << "Usage: " << argv[0]
+      << " inputImage kernelImage outputImage algorithm [normalizeImage] [outputRegionMode]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const int ImageDimension = 2;
+
+  typedef float                                  PixelType;
+  typedef itk::Image<PixelType, ImageDimension>  ImageType;
+  typedef itk::ImageFileReader<ImageType>        ReaderType;
+
+  ReaderType::Pointer reader1 = ReaderType::New();
+  reader1->SetFileName( argv[1] );
+
+  ReaderType::Pointer reader2 = ReaderType::New();
+  reader2->SetFileName( argv[2] );
+
+  typedef itk::ConvolutionImageFilter<ImageType> ConvolutionFilterType;
+  ConvolutionFilterType::Pointer convolver = ConvolutionFilterType::New();
+  convolver->SetInput( reader1->GetOutput() );
+  convolver->SetKernelImage( reader2->GetOutput() );
+
+  itk::SimpleFilterWatcher watcher(convolver, "filter");
+
+  if ( convolver->GetAlgorithm() != ConvolutionFilterType::SPATIAL )
+    {
+    std::cerr << "The default algorithm is not SPATIAL." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string algorithm( argv[4] );
+  if ( algorithm == "AUTOMATIC" )
+    {
+    convolver->SetAlgorithm( ConvolutionFilterType::AUTOMATIC );
+    }
+  else if ( algorithm == "SPATIAL" )
+    {
+    convolver->SetAlgorithm( ConvolutionFilterType::SPATIAL );
+    }
+  else if ( algorithm == "SEPARABLE" )
+    {
+    convolver->SetAlgorithm( ConvolutionFilterType::SEPARABLE );
+    }
+  else if ( algorithm == "FFT" )
+    {
+    convolver->SetAlgorithm( ConvolutionFilterType::FFT );
+    }
+  else
+    {
+    std::cerr << "Invalid algorithm '" << algorithm << "'." << std::endl;
+    std::cerr << "Valid values are AUTOMATIC, SPATIAL, SEPARABLE or FFT." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( argc >= 6 )
+    {
+    convolver->SetNormalize( static_cast<bool>( atoi( argv[5] ) ) );
+    }
+
+  if ( argc >= 7 )
+    {
+    std::string outputRegionMode( argv[6] );
+    if ( outputRegionMode == "SAME" )
+      {
+      convolver->SetOutputRegionModeToSame();
+      std::cout << "OutputRegionMode set to SAME." << std::endl;
+      }
+    else if ( outputRegionMode == "VALID" )
+      {
+      convolver->SetOutputRegionModeToValid();
+      std::cout << "OutputRegionMode set to VALID." << std::endl;
+      }
+    else
+      {
+      std::cerr << "Invalid OutputRegionMode '" << outputRegionMode << "'." << std::endl;
+      std::cerr << "Valid values are SAME or VALID." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // all the algorithms only read the requested region of the input
+  const unsigned int numberOfStreamDivisions = 3;
+  typedef itk::PipelineMonitorImageFilter<ImageType> MonitorFilterType;
+  MonitorFilterType::Pointer monitor = MonitorFilterType::New();
+  monitor->SetInput( convolver->GetOutput() );
+
+  typedef itk::StreamingImageFilter<ImageType, ImageType> StreamingFilterType;
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( monitor->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( numberOfStreamDivisions );
+
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( argv[3] );
+  writer->SetInput( streamer->GetOutput() );
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( !monitor->VerifyAllInputCanStream( numberOfStreamDivisions ) )
+    {
+    std::cerr << "The convolution did not stream as expected." << std::endl;
+    std::cerr << monitor;
+    return EXIT_FAILURE;
+    }
+
+  convolver->Print( std::cout );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFFTConvolutionImageFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkPipelineMonitorImageFilter.h"
+#include "itkSimpleFilterWatcher.h"
+#include "itkStreamingImageFilter.h"
+
+int itkFFTConvolutionImageFilterTilingTest(int argc, char * argv[])
+{
+
+  if ( argc < 5 )
+    {
+    std::cout << "Usage: " << argv[0]
+      << " inputImage kernelImage outputImage numberOfStreamDivisions [normalizeImage] [outputRegionMode]"
+      << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const int ImageDimension = 2;
+
+  typedef float                                  PixelType;
+  typedef itk::Image<PixelType, ImageDimension>  ImageType;
+  typedef itk::ImageFileReader<ImageType>        ReaderType;
+
+  ReaderType::Pointer reader1 = ReaderType::New();
+  reader1->SetFileName( argv[1] );
+
+  ReaderType::Pointer reader2 = ReaderType::New();
+  reader2->SetFileName( argv[2] );
+
+  // The caster generates exactly the requested region of each block, so
+  // that the monitor sees the regions requested by the convolution.
+  typedef itk::CastImageFilter<ImageType, ImageType> CastFilterType;
+  CastFilterType::Pointer caster = CastFilterType::New();
+  caster->SetInput( reader1->GetOutput() );
+  caster->InPlaceOff();
+
+  typedef itk::PipelineMonitorImageFilter<ImageType> MonitorFilterType;
+  MonitorFilterType::Pointer monitor = MonitorFilterType::New();
+  monitor->SetInput( caster->GetOutput() );
+
+  typedef itk::FFTConvolutionImageFilter<ImageType> ConvolutionFilterType;
+  ConvolutionFilterType::Pointer convolver = ConvolutionFilterType::New();
+  convolver->SetInput( monitor->GetOutput() );
+  convolver->SetKernelImage( reader2->GetOutput() );
+  convolver->TilingOn();
+
+  itk::SimpleFilterWatcher watcher(convolver, "filter");
+
+  const unsigned int numberOfStreamDivisions = atoi( argv[4] );
+
+  if ( argc >= 6 )
+    {
+    convolver->SetNormalize( static_cast<bool>( atoi( argv[5] ) ) );
+    }
+
+  if ( argc >= 7 )
+    {
+    std::string outputRegionMode( argv[6] );
+    if ( outputRegionMode == "SAME" )
+      {
+      convolver->SetOutputRegionModeToSame();
+      std::cout << "OutputRegionMode set to SAME." << std::endl;
+      }
+    else if ( outputRegionMode == "VALID" )
+      {
+      convolver->SetOutputRegionModeToValid();
+      std::cout << "OutputRegionMode set to VALID." << std::endl;
+      }
+    else
+      {
+      std::cerr << "Invalid OutputRegionMode '" << outputRegionMode << "'." << std::endl;
+      std::cerr << "Valid values are SAME or VALID." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  typedef itk::StreamingImageFilter<ImageType, ImageType> StreamingFilterType;
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( convolver->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( numberOfStreamDivisions );
+
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( argv[3] );
+  writer->SetInput( streamer->GetOutput() );
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The filter has two inputs, so the requested regions are propagated
+  // twice per block and VerifyAllInputCanStream does not apply.
+  if ( !monitor->VerifyInputFilterExecutedStreaming( numberOfStreamDivisions )
+       || !monitor->VerifyInputFilterBufferedRequestedRegions() )
+    {
+    std::cerr << "FFTConvolutionImageFilter failed to stream as expected!" << std::endl;
+    std::cerr << monitor;
+    return EXIT_FAILURE;
+    }
+
+  // Each block only needs its own region of the input, padded by the
+  // kernel radius.
+  MonitorFilterType::RegionVectorType regions = monitor->GetUpdatedBufferedRegions();
+  for ( unsigned int i = 0; i < regions.size(); ++i )
+    {
+    if ( regions[i] == reader1->GetOutput()->GetLargestPossibleRegion() )
+      {
+      std::cerr << "The whole input was requested for a block." << std::endl;
+      std::cerr << monitor;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
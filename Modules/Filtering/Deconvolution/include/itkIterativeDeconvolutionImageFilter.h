@@ -112,15 +112,6 @@ protected:
   virtual void Finish(ProgressAccumulator * progress,
                       float progressWeight);
 
-  /** This filter needs the entire image kernel, which in general is
-   * going to be a different size then the output requested region. As
-   * such, this filter needs to provide an implementation for
-   * GenerateInputRequestedRegion() in order to inform the pipeline
-   * execution model.
-   *
-   * \sa ProcessObject::GenerateInputRequestedRegion()  */
-  virtual void GenerateInputRequestedRegion() ITK_OVERRIDE;
-
   /** Generate the output image data. Uses a minipipeline, so
    * ThreadedGenerateData is not overridden. */
   virtual void GenerateData() ITK_OVERRIDE;
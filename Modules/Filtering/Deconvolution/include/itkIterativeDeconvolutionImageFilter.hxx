@@ -86,29 +86,6 @@ IterativeDeconvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInt
   m_TransferFunction = ITK_NULLPTR;
 }
 
-template< typename TInputImage, typename TKernelImage, typename TOutputImage, typename TInternalPrecision >
-void
-IterativeDeconvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
-::GenerateInputRequestedRegion()
-{
-  // Request the largest possible region for both input images.
-  if ( this->GetInput() )
-    {
-    typename InputImageType::Pointer imagePtr =
-      const_cast< InputImageType * >( this->GetInput() );
-    imagePtr->SetRequestedRegionToLargestPossibleRegion();
-    }
-
-  if ( this->GetKernelImage() )
-    {
-    // Input kernel is an image, cast away the constness so we can set
-    // the requested region.
-    typename KernelImageType::Pointer kernelPtr =
-      const_cast< KernelImageType * >( this->GetKernelImage() );
-    kernelPtr->SetRequestedRegionToLargestPossibleRegion();
-    }
-}
-
 template< typename TInputImage, typename TKernelImage, typename TOutputImage, typename TInternalPrecision >
 void
 IterativeDeconvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInternalPrecision >
@@ -118,13 +95,7 @@ IterativeDeconvolutionImageFilter< TInputImage, TKernelImage, TOutputImage, TInt
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter( this );
 
-  typename Superclass::InputImageConstPointer inputPtr = this->GetInput();
-  typename Superclass::OutputImagePointer outputPtr = this->GetOutput(0);
-
-  outputPtr->SetRequestedRegion( inputPtr->GetRequestedRegion() );
-  outputPtr->SetBufferedRegion( inputPtr->GetBufferedRegion() );
-  outputPtr->SetLargestPossibleRegion( inputPtr->GetLargestPossibleRegion() );
-  outputPtr->Allocate();
+  this->AllocateOutputs();
 
   // Set up progress tracking
   float iterationWeight = 0.8f / static_cast< float >( m_NumberOfIterations );
@@ -142,7 +142,7 @@ ParametricBlindLeastSquaresDeconvolutionImageFilter< TInputImage, TKernelImage,
     EstimateShiftFilterType::New();
   typename EstimateShiftFilterType::OffsetType shift;
   typename InternalImageType::SizeType inputSize =
-    this->GetInput()->GetLargestPossibleRegion().GetSize();
+    this->GetInput()->GetBufferedRegion().GetSize();
   for (unsigned int i = 0; i < InternalImageType::ImageDimension; ++i)
     {
     shift[i] = -(static_cast< typename EstimateShiftFilterType::OffsetValueType >( inputSize[i] ) / 2);
@@ -0,0 +1,167 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkCastImageFilter.h"
+#include "itkFFTConvolutionImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkLandweberDeconvolutionImageFilter.h"
+#include "itkPipelineMonitorImageFilter.h"
+#include "itkRichardsonLucyDeconvolutionImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkTikhonovDeconvolutionImageFilter.h"
+#include <cmath>
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+typedef itk::Image< float, Dimension > ImageType;
+
+/** Deconvolves the image as a whole, then by blocks with Tiling on and
+ * a margin around the blocks, and compares the outputs. The monitor
+ * checks that the filter only requests the blocks of its input. The
+ * deconvolution of a block only approximates the one of the image, so
+ * the mean difference is compared with the mean of the image. */
+template< typename TFilter >
+bool CheckTiling( const char *name, TFilter *filter, ImageType *image, ImageType *kernel, unsigned int margin )
+{
+  typedef itk::CastImageFilter< ImageType, ImageType >      CastFilterType;
+  typedef itk::PipelineMonitorImageFilter< ImageType >      MonitorFilterType;
+  typedef itk::StreamingImageFilter< ImageType, ImageType > StreamingFilterType;
+
+  const unsigned int numberOfStreamDivisions = 3;
+
+  CastFilterType::Pointer caster = CastFilterType::New();
+  caster->SetInput( image );
+  caster->InPlaceOff();
+  MonitorFilterType::Pointer monitor = MonitorFilterType::New();
+  monitor->SetInput( caster->GetOutput() );
+
+  filter->SetInput( monitor->GetOutput() );
+  filter->SetKernelImage( kernel );
+  filter->NormalizeOn();
+  filter->Update();
+  ImageType::Pointer reference = filter->GetOutput();
+  reference->DisconnectPipeline();
+
+  typename TFilter::InputSizeType tileMargin;
+  tileMargin.Fill( margin );
+  filter->SetTileMargin( tileMargin );
+  filter->TilingOn();
+  caster->Modified();
+  monitor->ClearPipelineSavedInformation();
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( filter->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( numberOfStreamDivisions );
+  streamer->Update();
+
+  bool passed = true;
+  // the filter has two inputs, so the requested regions are propagated
+  // twice per block and VerifyAllInputCanStream does not apply
+  if( !monitor->VerifyInputFilterExecutedStreaming( numberOfStreamDivisions )
+      || !monitor->VerifyInputFilterBufferedRequestedRegions() )
+    {
+    std::cerr << name << ": the filter failed to stream as expected" << std::endl;
+    passed = false;
+    }
+  MonitorFilterType::RegionVectorType regions = monitor->GetUpdatedBufferedRegions();
+  for( unsigned int i = 0; i < regions.size(); ++i )
+    {
+    if( regions[i] == image->GetLargestPossibleRegion() )
+      {
+      std::cerr << name << ": the whole input was requested for a block" << std::endl;
+      passed = false;
+      }
+    }
+
+  double difference = 0.0;
+  double mean = 0.0;
+  itk::ImageRegionConstIterator< ImageType > rit( reference, reference->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< ImageType > oit( streamer->GetOutput(), reference->GetBufferedRegion() );
+  for( ; !rit.IsAtEnd(); ++rit, ++oit )
+    {
+    difference += std::abs( oit.Get() - rit.Get() );
+    mean += rit.Get();
+    }
+  std::cout << name << ": mean difference " << difference / mean << " of the mean" << std::endl;
+  if( !( difference <= 0.01 * mean ) )
+    {
+    std::cerr << name << ": the output differs with Tiling" << std::endl;
+    passed = false;
+    }
+  return passed;
+}
+
+}
+
+/** Checks that the deconvolution filters can be streamed with Tiling
+ * on, with outputs close to the ones of the whole image. */
+int itkDeconvolutionImageFilterTilingTest( int argc, char * argv[] )
+{
+  if( argc < 3 )
+    {
+    std::cout << "Usage: " << argv[0] << " inputImage kernelImage" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader1 = ReaderType::New();
+  reader1->SetFileName( argv[1] );
+
+  ReaderType::Pointer reader2 = ReaderType::New();
+  reader2->SetFileName( argv[2] );
+  reader2->Update();
+  ImageType::Pointer kernel = reader2->GetOutput();
+
+  // the input blurred by the kernel, as in the other deconvolution tests
+  typedef itk::FFTConvolutionImageFilter< ImageType > ConvolutionFilterType;
+  ConvolutionFilterType::Pointer convolver = ConvolutionFilterType::New();
+  convolver->SetInput( reader1->GetOutput() );
+  convolver->SetKernelImage( kernel );
+  convolver->NormalizeOn();
+  convolver->Update();
+  ImageType::Pointer image = convolver->GetOutput();
+  image->DisconnectPipeline();
+
+  bool passed = true;
+
+  typedef itk::TikhonovDeconvolutionImageFilter< ImageType > TikhonovFilterType;
+  TikhonovFilterType::Pointer tikhonov = TikhonovFilterType::New();
+  tikhonov->SetRegularizationConstant( 0.01 );
+  passed &= CheckTiling( "Tikhonov", tikhonov.GetPointer(), image, kernel, 20 );
+
+  typedef itk::RichardsonLucyDeconvolutionImageFilter< ImageType > RichardsonLucyFilterType;
+  RichardsonLucyFilterType::Pointer richardsonLucy = RichardsonLucyFilterType::New();
+  richardsonLucy->SetNumberOfIterations( 5 );
+  passed &= CheckTiling( "RichardsonLucy", richardsonLucy.GetPointer(), image, kernel, 40 );
+
+  typedef itk::LandweberDeconvolutionImageFilter< ImageType > LandweberFilterType;
+  LandweberFilterType::Pointer landweber = LandweberFilterType::New();
+  landweber->SetNumberOfIterations( 5 );
+  landweber->SetAlpha( 0.5 );
+  passed &= CheckTiling( "Landweber", landweber.GetPointer(), image, kernel, 40 );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
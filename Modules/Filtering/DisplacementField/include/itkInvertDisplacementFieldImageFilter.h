@@ -31,6 +31,26 @@ namespace itk
  *
  * \brief Iteratively estimate the inverse field of a displacement field.
  *
+ * The inverse field is found by a fixed-point iteration, which composes the
+ * displacement field with the current inverse and moves the inverse against
+ * the error, until the mean or the maximum error norm falls below its
+ * threshold.  The iteration starts from the initial estimate if one is set,
+ * otherwise from the inverse computed by the previous update if
+ * \c UseWarmStart is on and the displacement field has the same region,
+ * otherwise from zero.  Warm starts suit the registration methods which
+ * invert a slightly different field at each of their iterations.
+ *
+ * The error at a voxel only depends on the inverse at that voxel.  If
+ * \c VoxelErrorToleranceThreshold is greater than zero, the voxels whose
+ * error norm falls below it are considered converged: they are neither
+ * updated nor evaluated again, and their last error is used for the
+ * stopping criteria.
+ *
+ * The displacement field is evaluated with a linear interpolation written
+ * for the buffer of the field when the interpolator is the default
+ * \c VectorLinearInterpolateImageFunction, and with the interpolator
+ * otherwise.
+ *
  * \author Nick Tustison
  * \author Brian Avants
  *
@@ -77,6 +97,7 @@ public:
   typedef VectorInterpolateImageFunction<InputFieldType, RealType>  InterpolatorType;
   typedef VectorLinearInterpolateImageFunction <InputFieldType, RealType>
                                                                     DefaultInterpolatorType;
+  typedef Image<unsigned char, ImageDimension>                      ActiveSetImageType;
 
   /** Get the interpolator. */
   itkGetModifiableObjectMacro( Interpolator, InterpolatorType );
@@ -133,6 +154,29 @@ public:
   itkSetMacro( EnforceBoundaryCondition, bool );
   itkGetMacro( EnforceBoundaryCondition, bool );
 
+  /* Set/Get whether to start from the inverse of the previous update, when
+   * no initial estimate is set.  The filter then keeps the buffer of the last
+   * output: it stays allocated when the output is released or regenerated,
+   * so the memory of one more inverse field is held until the next update
+   * without warm start, ReleaseWarmStartField() or the destruction of the
+   * filter.  Default is off. */
+  itkSetMacro( UseWarmStart, bool );
+  itkGetConstMacro( UseWarmStart, bool );
+  itkBooleanMacro( UseWarmStart );
+
+  /* Release the inverse field kept for the warm start.  The next update
+   * then starts from the initial estimate or from zero. */
+  void ReleaseWarmStartField();
+
+  /* Set/Get the error norm, in voxels, below which a voxel is converged and
+   * no longer updated.  Default is 0, which updates all the voxels at each
+   * iteration. */
+  itkSetMacro( VoxelErrorToleranceThreshold, RealType );
+  itkGetConstMacro( VoxelErrorToleranceThreshold, RealType );
+
+  /* Get the number of iterations of the last update */
+  itkGetConstMacro( ElapsedIterations, unsigned int );
+
 protected:
 
   /** Constructor */
@@ -154,6 +198,13 @@ private:
   InvertDisplacementFieldImageFilter( const Self& ); //purposely not implemented
   void operator=( const Self& );                 //purposely not implemented
 
+  typedef typename InputFieldType::PixelType                        InputVectorType;
+  typedef typename InputFieldType::OffsetValueType                  OffsetValueType;
+
+  /** Evaluate the displacement field at the point, and return zero outside
+   * the buffer of the field. */
+  void EvaluateDisplacementField( const PointType &, VectorType & ) const;
+
   /** The interpolator. */
   typename InterpolatorType::Pointer                m_Interpolator;
 
@@ -175,6 +226,21 @@ private:
   bool                                              m_EnforceBoundaryCondition;
   SimpleFastMutexLock                               m_Mutex;
 
+  bool                                              m_UseWarmStart;
+  RealType                                          m_VoxelErrorToleranceThreshold;
+  unsigned int                                      m_ElapsedIterations;
+  typename InverseDisplacementFieldType::Pointer    m_PreviousInverseField;
+  typename ActiveSetImageType::Pointer              m_ActiveSetImage;
+
+  // geometry of the displacement field for the linear interpolation
+  bool                                              m_UseLinearInterpolation;
+  const InputVectorType *                           m_FieldBuffer;
+  PointType                                         m_FieldOrigin;
+  DirectionType                                     m_FieldPhysicalPointToIndex;
+  IndexType                                         m_FieldStartIndex;
+  IndexType                                         m_FieldEndIndex;
+  OffsetValueType                                   m_FieldOffsetTable[ImageDimension + 1];
+
 };
 
 } // end namespace itk
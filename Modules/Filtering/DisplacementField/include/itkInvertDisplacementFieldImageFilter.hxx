@@ -20,11 +20,14 @@
 
 #include "itkInvertDisplacementFieldImageFilter.h"
 
-#include "itkComposeDisplacementFieldsImageFilter.h"
-#include "itkImageDuplicator.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
 #include "itkMutexLockHolder.h"
 
+#include <algorithm>
+#include <typeinfo>
+
 namespace itk
 {
 
@@ -45,7 +48,13 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
   m_MeanErrorNorm(0.0),
   m_Epsilon(0.0),
   m_DoThreadedEstimateInverse(false),
-  m_EnforceBoundaryCondition(true)
+  m_EnforceBoundaryCondition(true),
+  m_UseWarmStart(false),
+  m_VoxelErrorToleranceThreshold(0.0),
+  m_ElapsedIterations(0),
+  m_ActiveSetImage(ActiveSetImageType::New()),
+  m_UseLinearInterpolation(false),
+  m_FieldBuffer(ITK_NULLPTR)
 {
   this->SetNumberOfRequiredInputs( 1 );
 }
@@ -84,22 +93,28 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
 
   typename DisplacementFieldType::ConstPointer displacementField = this->GetInput();
 
-  typename InverseDisplacementFieldType::Pointer inverseDisplacementField;
+  typename InverseDisplacementFieldType::Pointer inverseDisplacementField = this->GetOutput();
+  const RegionType region = inverseDisplacementField->GetBufferedRegion();
 
-  if( this->GetInverseFieldInitialEstimate() )
+  const InverseDisplacementFieldType * initialEstimate = this->GetInverseFieldInitialEstimate();
+  if( !initialEstimate && this->m_UseWarmStart && this->m_PreviousInverseField.IsNotNull() &&
+    this->m_PreviousInverseField->GetBufferedRegion() == region )
     {
-    typedef ImageDuplicator<InverseDisplacementFieldType> DuplicatorType;
-    typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-    duplicator->SetInputImage( this->GetInverseFieldInitialEstimate() );
-    duplicator->Update();
-
-    inverseDisplacementField = duplicator->GetModifiableOutput();
+    initialEstimate = this->m_PreviousInverseField;
+    }
 
-    this->SetNthOutput( 0, inverseDisplacementField );
+  if( initialEstimate )
+    {
+    if( initialEstimate->GetBufferedRegion() != region )
+      {
+      itkExceptionMacro( "The initial estimate of the inverse field does not have the region of the output." );
+      }
+    std::copy( initialEstimate->GetBufferPointer(),
+      initialEstimate->GetBufferPointer() + region.GetNumberOfPixels(),
+      inverseDisplacementField->GetBufferPointer() );
     }
   else
     {
-    inverseDisplacementField = this->GetOutput();
     inverseDisplacementField->FillBuffer( zeroVector );
     }
 
@@ -108,13 +123,55 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     this->m_DisplacementFieldSpacing[d] = displacementField->GetSpacing()[d];
     }
 
-  this->m_ScaledNormImage->CopyInformation( displacementField );
-  this->m_ScaledNormImage->SetRegions( displacementField->GetRequestedRegion() );
+  // The default interpolator is replaced by a linear interpolation on the
+  // buffer of the field, which gives the same values.  A subclass of the
+  // default interpolator may evaluate the field differently, so the type
+  // must match exactly.
+  this->m_Interpolator->SetInputImage( displacementField );
+  this->m_UseLinearInterpolation =
+    ( typeid( *this->m_Interpolator.GetPointer() ) == typeid( DefaultInterpolatorType ) );
+
+  const typename DisplacementFieldType::RegionType fieldRegion = displacementField->GetBufferedRegion();
+  DirectionType scale;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    scale[d][d] = displacementField->GetSpacing()[d];
+    this->m_FieldStartIndex[d] = fieldRegion.GetIndex()[d];
+    this->m_FieldEndIndex[d] = fieldRegion.GetIndex()[d] + static_cast<IndexValueType>( fieldRegion.GetSize()[d] ) - 1;
+    }
+  this->m_FieldPhysicalPointToIndex = DirectionType( displacementField->GetDirection() * scale ).GetInverse();
+  this->m_FieldOrigin = displacementField->GetOrigin();
+  this->m_FieldBuffer = displacementField->GetBufferPointer();
+  for( unsigned int d = 0; d <= ImageDimension; d++ )
+    {
+    this->m_FieldOffsetTable[d] = displacementField->GetOffsetTable()[d];
+    }
+
+  // The composed field and the error norms are kept between the iterations,
+  // and hold the last error of the converged voxels.
+  this->m_ComposedField->CopyInformation( inverseDisplacementField );
+  this->m_ComposedField->SetRegions( region );
+  this->m_ComposedField->Allocate();
+
+  this->m_ScaledNormImage->CopyInformation( inverseDisplacementField );
+  this->m_ScaledNormImage->SetRegions( region );
   this->m_ScaledNormImage->Allocate(true); // initialize
                                                                   // buffer
                                                                   // to zero
 
-  SizeValueType numberOfPixelsInRegion = ( displacementField->GetRequestedRegion() ).GetNumberOfPixels();
+  if( this->m_VoxelErrorToleranceThreshold > NumericTraits<RealType>::ZeroValue() )
+    {
+    this->m_ActiveSetImage->CopyInformation( inverseDisplacementField );
+    this->m_ActiveSetImage->SetRegions( region );
+    this->m_ActiveSetImage->Allocate();
+    this->m_ActiveSetImage->FillBuffer( 1 );
+    }
+  else
+    {
+    this->m_ActiveSetImage->Initialize();
+    }
+
+  SizeValueType numberOfPixelsInRegion = region.GetNumberOfPixels();
   this->m_MaxErrorNorm = NumericTraits<RealType>::max();
   this->m_MeanErrorNorm = NumericTraits<RealType>::max();
   unsigned int iteration = 0;
@@ -126,17 +183,10 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     itkDebugMacro( "Iteration " << iteration << ": mean error norm = " << this->m_MeanErrorNorm
       << ", max error norm = " << this->m_MaxErrorNorm );
 
-    typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType> ComposerType;
-    typename ComposerType::Pointer composer = ComposerType::New();
-    composer->SetDisplacementField( displacementField );
-    composer->SetWarpingField( inverseDisplacementField );
-
-    this->m_ComposedField = composer->GetOutput();
-    this->m_ComposedField->Update();
-    this->m_ComposedField->DisconnectPipeline();
-
     /**
-     * Multithread processing to multiply each element of the composed field by 1 / spacing
+     * Multithread processing to compose the displacement field with the
+     * inverse field and to multiply each element of the composed field by
+     * 1 / spacing
      */
     this->m_MeanErrorNorm = NumericTraits<RealType>::ZeroValue();
     this->m_MaxErrorNorm = NumericTraits<RealType>::ZeroValue();
@@ -166,6 +216,103 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, &str1 );
     this->GetMultiThreader()->SingleMethodExecute();
     }
+  this->m_ElapsedIterations = iteration - 1;
+
+  if( this->m_UseWarmStart )
+    {
+    // share the buffer of the output, which the pipeline releases before
+    // the next update
+    this->m_PreviousInverseField = InverseDisplacementFieldType::New();
+    this->m_PreviousInverseField->CopyInformation( inverseDisplacementField );
+    this->m_PreviousInverseField->SetRegions( region );
+    this->m_PreviousInverseField->SetPixelContainer( inverseDisplacementField->GetPixelContainer() );
+    }
+  else
+    {
+    this->m_PreviousInverseField = ITK_NULLPTR;
+    }
+  this->m_FieldBuffer = ITK_NULLPTR;
+}
+
+template<typename TInputImage, typename TOutputImage>
+void
+InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::EvaluateDisplacementField( const PointType & point, VectorType & displacement ) const
+{
+  displacement.Fill( 0.0 );
+
+  if( !this->m_UseLinearInterpolation )
+    {
+    if( this->m_Interpolator->IsInsideBuffer( point ) )
+      {
+      const typename InterpolatorType::OutputType value = this->m_Interpolator->Evaluate( point );
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        displacement[d] = value[d];
+        }
+      }
+    return;
+    }
+
+  // continuous index, as in ImageBase::TransformPhysicalPointToContinuousIndex()
+  Vector<typename PointType::ValueType, ImageDimension> cvector;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    cvector[d] = point[d] - this->m_FieldOrigin[d];
+    }
+  cvector = this->m_FieldPhysicalPointToIndex * cvector;
+
+  // the weights and the offsets of the lower and upper neighbors along
+  // each dimension, clamped to the buffer as in VectorLinearInterpolateImageFunction
+  RealType weights[ImageDimension][2];
+  OffsetValueType offsets[ImageDimension][2];
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const RealType cindex = static_cast<RealType>( cvector[d] );
+    // Test for negative of a positive so we can catch NaN's.
+    if( !( cindex >= static_cast<RealType>( this->m_FieldStartIndex[d] - 0.5 ) &&
+      cindex < static_cast<RealType>( this->m_FieldEndIndex[d] + 0.5 ) ) )
+      {
+      return;
+      }
+    const IndexValueType baseIndex = Math::Floor<IndexValueType>( cindex );
+    const RealType distance = cindex - static_cast<RealType>( baseIndex );
+    weights[d][0] = 1.0 - distance;
+    weights[d][1] = distance;
+    offsets[d][0] = ( std::max( baseIndex, this->m_FieldStartIndex[d] ) - this->m_FieldStartIndex[d] )
+      * this->m_FieldOffsetTable[d];
+    offsets[d][1] = ( std::min( baseIndex + 1, this->m_FieldEndIndex[d] ) - this->m_FieldStartIndex[d] )
+      * this->m_FieldOffsetTable[d];
+    }
+
+  // the neighbors are visited in the order of VectorLinearInterpolateImageFunction
+  const InputVectorType * fieldBuffer = this->m_FieldBuffer;
+  RealType sum[ImageDimension];
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    sum[d] = NumericTraits<RealType>::ZeroValue();
+    }
+  for( unsigned int counter = 0; counter < ( 1u << ImageDimension ); counter++ )
+    {
+    RealType overlap = 1.0;
+    OffsetValueType offset = 0;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      const unsigned int upper = ( counter >> d ) & 1;
+      overlap *= weights[d][upper];
+      offset += offsets[d][upper];
+      }
+
+    const InputVectorType & neighbor = fieldBuffer[offset];
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      sum[d] += overlap * static_cast<RealType>( neighbor[d] );
+      }
+    }
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    displacement[d] = sum[d];
+    }
 }
 
 template<typename TInputImage, typename TOutputImage>
@@ -181,12 +328,30 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
   ImageRegionIterator<DisplacementFieldType> ItE( this->m_ComposedField, region );
   ImageRegionIterator<RealImageType> ItS( this->m_ScaledNormImage, region );
 
+  // the active set, if any, is walked with the other iterators
+  const bool active = ( this->m_ActiveSetImage->GetBufferPointer() != ITK_NULLPTR );
+  ImageRegionIterator<ActiveSetImageType> ItA;
+  if( active )
+    {
+    ItA = ImageRegionIterator<ActiveSetImageType>( this->m_ActiveSetImage, region );
+    }
+
   if( this->m_DoThreadedEstimateInverse )
     {
-    ImageRegionIterator<DisplacementFieldType> ItI( this->GetOutput(), region );
+    ImageRegionIteratorWithIndex<InverseDisplacementFieldType> ItI( this->GetOutput(), region );
 
     for( ItI.GoToBegin(), ItE.GoToBegin(), ItS.GoToBegin(); !ItI.IsAtEnd(); ++ItI, ++ItE, ++ItS )
       {
+      if( active )
+        {
+        const bool isActive = ItA.Get();
+        ++ItA;
+        if( !isActive )
+          {
+          continue;
+          }
+        }
+
       VectorType update = ItE.Get();
       RealType scaledNorm = ItS.Get();
 
@@ -201,7 +366,7 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
         {
         for( unsigned int d = 0; d < ImageDimension; d++ )
           {
-          if( index[d] == startIndex[d] || index[d] == static_cast<IndexValueType>( size[d] ) - startIndex[d] - 1 )
+          if( index[d] == startIndex[d] || index[d] == startIndex[d] + static_cast<IndexValueType>( size[d] ) - 1 )
             {
             ItI.Set( zeroVector );
             break;
@@ -212,6 +377,9 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     }
   else
     {
+    const InverseDisplacementFieldType * inverseField = this->GetOutput();
+    ImageRegionConstIteratorWithIndex<InverseDisplacementFieldType> ItI( inverseField, region );
+
     VectorType inverseSpacing;
     RealType localMean = NumericTraits<RealType>::ZeroValue();
     RealType localMax  = NumericTraits<RealType>::ZeroValue();
@@ -219,24 +387,59 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
       {
       inverseSpacing[d]=1.0/this->m_DisplacementFieldSpacing[d];
       }
-    for( ItE.GoToBegin(), ItS.GoToBegin(); !ItE.IsAtEnd(); ++ItE, ++ItS )
+
+    PointType pointIn1;
+    PointType pointIn2;
+    VectorType displacement;
+    for( ItI.GoToBegin(), ItE.GoToBegin(), ItS.GoToBegin(); !ItI.IsAtEnd(); ++ItI, ++ItE, ++ItS )
       {
-      const VectorType & displacement = ItE.Get();
       RealType scaledNorm = 0.0;
-      for( unsigned int d = 0; d < ImageDimension; ++d )
+      if( active && !ItA.Get() )
         {
-        scaledNorm += vnl_math_sqr( displacement[d] * inverseSpacing[d] );
+        // converged voxel, whose error does not change
+        scaledNorm = ItS.Get();
+        }
+      else
+        {
+        // compose the displacement field with the inverse field
+        inverseField->TransformIndexToPhysicalPoint( ItI.GetIndex(), pointIn1 );
+        const VectorType & inverse = ItI.Get();
+        for( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          pointIn2[d] = pointIn1[d] + inverse[d];
+          }
+        this->EvaluateDisplacementField( pointIn2, displacement );
+
+        VectorType error;
+        for( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          error[d] = static_cast<RealType>( ( pointIn2[d] + displacement[d] ) - pointIn1[d] );
+          }
+
+        for( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+          scaledNorm += vnl_math_sqr( error[d] * inverseSpacing[d] );
+          }
+        scaledNorm = std::sqrt( scaledNorm );
+
+        ItS.Set( scaledNorm );
+        ItE.Set( -error );
+
+        if( active && scaledNorm < this->m_VoxelErrorToleranceThreshold )
+          {
+          ItA.Set( 0 );
+          }
+        }
+      if( active )
+        {
+        ++ItA;
         }
-      scaledNorm = std::sqrt( scaledNorm );
 
       localMean += scaledNorm;
       if( localMax < scaledNorm )
         {
         localMax = scaledNorm;
         }
-
-      ItS.Set( scaledNorm );
-      ItE.Set( -displacement );
       }
       {
       MutexLockHolder<SimpleFastMutexLock> holder(m_Mutex);
@@ -249,6 +452,14 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     }
 }
 
+template<typename TInputImage, typename TOutputImage>
+void
+InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::ReleaseWarmStartField()
+{
+  this->m_PreviousInverseField = ITK_NULLPTR;
+}
+
 template<typename TInputImage, typename TOutputImage>
 void
 InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
@@ -261,6 +472,10 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
   os << "Maximum number of iterations: " << this->m_MaximumNumberOfIterations << std::endl;
   os << "Max error tolerance threshold: " << this->m_MaxErrorToleranceThreshold << std::endl;
   os << "Mean error tolerance threshold: " << this->m_MeanErrorToleranceThreshold << std::endl;
+  os << "Voxel error tolerance threshold: " << this->m_VoxelErrorToleranceThreshold << std::endl;
+  os << "Use warm start: " << this->m_UseWarmStart << std::endl;
+  os << "Warm start field kept: " << this->m_PreviousInverseField.IsNotNull() << std::endl;
+  os << "Elapsed iterations: " << this->m_ElapsedIterations << std::endl;
 }
 
 }  //end namespace itk
@@ -0,0 +1,300 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkInvertDisplacementFieldImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include <cmath>
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef itk::Vector< float, Dimension >                                         VectorType;
+typedef itk::Image< VectorType, Dimension >                                     DisplacementFieldType;
+typedef itk::InvertDisplacementFieldImageFilter< DisplacementFieldType >        InverterType;
+
+/** Evaluates the field with a linear interpolator, through the general
+ * interpolator interface of the filter. */
+class WrappedLinearInterpolator : public InverterType::InterpolatorType
+{
+public:
+  typedef WrappedLinearInterpolator               Self;
+  typedef InverterType::InterpolatorType          Superclass;
+  typedef itk::SmartPointer< Self >               Pointer;
+  typedef InverterType::DefaultInterpolatorType   LinearInterpolatorType;
+
+  itkNewMacro( Self );
+
+  virtual void SetInputImage( const DisplacementFieldType *field ) ITK_OVERRIDE
+  {
+    Superclass::SetInputImage( field );
+    m_LinearInterpolator->SetInputImage( field );
+  }
+
+  virtual OutputType EvaluateAtContinuousIndex( const ContinuousIndexType & index ) const ITK_OVERRIDE
+  {
+    return m_LinearInterpolator->EvaluateAtContinuousIndex( index );
+  }
+
+protected:
+  WrappedLinearInterpolator() : m_LinearInterpolator( LinearInterpolatorType::New() ) {}
+
+private:
+  LinearInterpolatorType::Pointer m_LinearInterpolator;
+};
+
+/** A subclass of the default interpolator which evaluates the field to
+ * zero, so that the inverse stays at zero. */
+class ZeroLinearInterpolator : public InverterType::DefaultInterpolatorType
+{
+public:
+  typedef ZeroLinearInterpolator                  Self;
+  typedef InverterType::DefaultInterpolatorType   Superclass;
+  typedef itk::SmartPointer< Self >               Pointer;
+
+  itkNewMacro( Self );
+
+  virtual OutputType EvaluateAtContinuousIndex( const ContinuousIndexType & ) const ITK_OVERRIDE
+  {
+    OutputType zero;
+    zero.Fill( 0.0 );
+    return zero;
+  }
+
+protected:
+  ZeroLinearInterpolator() {}
+};
+
+/** A smooth field which vanishes on the boundary, with a non-zero start
+ * index, an anisotropic spacing and a rotated direction. */
+DisplacementFieldType::Pointer CreateField( double amplitude )
+{
+  DisplacementFieldType::SizeType size;
+  size[0] = 32;
+  size[1] = 24;
+  size[2] = 20;
+  DisplacementFieldType::IndexType start;
+  start[0] = -4;
+  start[1] = 3;
+  start[2] = 0;
+  DisplacementFieldType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  spacing[2] = 0.75;
+  DisplacementFieldType::PointType origin;
+  origin[0] = 10.0;
+  origin[1] = -5.0;
+  origin[2] = 2.0;
+  DisplacementFieldType::DirectionType direction;
+  direction.SetIdentity();
+  const double angle = 0.3;
+  direction[0][0] = std::cos( angle );
+  direction[0][1] = -std::sin( angle );
+  direction[1][0] = std::sin( angle );
+  direction[1][1] = std::cos( angle );
+
+  DisplacementFieldType::Pointer field = DisplacementFieldType::New();
+  field->SetRegions( DisplacementFieldType::RegionType( start, size ) );
+  field->SetSpacing( spacing );
+  field->SetOrigin( origin );
+  field->SetDirection( direction );
+  field->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< DisplacementFieldType > it( field, field->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double window = 1.0;
+    double relative[Dimension];
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      relative[d] = static_cast< double >( it.GetIndex()[d] - start[d] ) / ( size[d] - 1 );
+      window *= std::sin( vnl_math::pi * relative[d] );
+      }
+    VectorType displacement;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      displacement[d] = amplitude * spacing[d] * window
+        * std::cos( 2.0 * vnl_math::pi * relative[( d + 1 ) % Dimension] );
+      }
+    it.Set( displacement );
+    }
+  return field;
+}
+
+/** Returns the largest difference between the components of the fields. */
+double CompareFields( const DisplacementFieldType *field, const DisplacementFieldType *reference )
+{
+  double maxDifference = 0.0;
+  itk::ImageRegionConstIterator< DisplacementFieldType > it( field, field->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< DisplacementFieldType > rit( reference, reference->GetLargestPossibleRegion() );
+  for( ; !rit.IsAtEnd(); ++it, ++rit )
+    {
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      maxDifference = std::max( maxDifference, static_cast< double >( std::abs( it.Get()[d] - rit.Get()[d] ) ) );
+      }
+    }
+  return maxDifference;
+}
+
+DisplacementFieldType::Pointer Invert( InverterType *inverter, const DisplacementFieldType *field )
+{
+  inverter->SetDisplacementField( field );
+  inverter->Update();
+  DisplacementFieldType::Pointer inverse = inverter->GetOutput();
+  inverse->DisconnectPipeline();
+  return inverse;
+}
+
+}
+
+/** Checks that the linear interpolation of the filter gives the same inverse
+ * as the interpolator and is not used for its subclasses, that warm starts
+ * converge in fewer iterations, and that the active set stays close to the
+ * full iteration. */
+int itkInvertDisplacementFieldImageFilterWarmStartTest( int, char* [] )
+{
+  bool passed = true;
+
+  DisplacementFieldType::Pointer field = CreateField( 2.0 );
+
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 4 };
+  for( unsigned int t = 0; t < 2; ++t )
+    {
+    // a fixed number of iterations
+    InverterType::Pointer linearInverter = InverterType::New();
+    linearInverter->SetNumberOfThreads( numbersOfThreads[t] );
+    linearInverter->SetMaximumNumberOfIterations( 10 );
+    linearInverter->SetMeanErrorToleranceThreshold( 0.0 );
+    linearInverter->SetMaxErrorToleranceThreshold( 0.0 );
+
+    InverterType::Pointer wrappedInverter = InverterType::New();
+    wrappedInverter->SetNumberOfThreads( numbersOfThreads[t] );
+    wrappedInverter->SetMaximumNumberOfIterations( 10 );
+    wrappedInverter->SetMeanErrorToleranceThreshold( 0.0 );
+    wrappedInverter->SetMaxErrorToleranceThreshold( 0.0 );
+    wrappedInverter->SetInterpolator( WrappedLinearInterpolator::New() );
+
+    DisplacementFieldType::Pointer linearInverse = Invert( linearInverter, field );
+    DisplacementFieldType::Pointer wrappedInverse = Invert( wrappedInverter, field );
+
+    const double difference = CompareFields( linearInverse, wrappedInverse );
+    std::cout << numbersOfThreads[t] << " threads: difference with the interpolator " << difference
+              << ", mean error " << linearInverter->GetMeanErrorNorm() << std::endl;
+    if( !( difference < 1e-5 ) || linearInverter->GetElapsedIterations() != 10 )
+      {
+      std::cerr << "the linear interpolation differs from the interpolator" << std::endl;
+      passed = false;
+      }
+
+    // a subclass of the default interpolator is evaluated through its interface
+    InverterType::Pointer zeroInverter = InverterType::New();
+    zeroInverter->SetNumberOfThreads( numbersOfThreads[t] );
+    zeroInverter->SetMaximumNumberOfIterations( 10 );
+    zeroInverter->SetInterpolator( ZeroLinearInterpolator::New() );
+    DisplacementFieldType::Pointer zeroInverse = Invert( zeroInverter, field );
+    DisplacementFieldType::Pointer zeroField = CreateField( 0.0 );
+    if( !( CompareFields( zeroInverse, zeroField ) == 0.0 ) )
+      {
+      std::cerr << "the subclass of the default interpolator is replaced by the linear interpolation" << std::endl;
+      passed = false;
+      }
+
+    // converged voxels are left out of the iteration
+    InverterType::Pointer activeSetInverter = InverterType::New();
+    activeSetInverter->SetNumberOfThreads( numbersOfThreads[t] );
+    activeSetInverter->SetMaximumNumberOfIterations( 10 );
+    activeSetInverter->SetMeanErrorToleranceThreshold( 0.0 );
+    activeSetInverter->SetMaxErrorToleranceThreshold( 0.0 );
+    activeSetInverter->SetVoxelErrorToleranceThreshold( 1e-4 );
+    DisplacementFieldType::Pointer activeSetInverse = Invert( activeSetInverter, field );
+
+    const double activeSetDifference = CompareFields( activeSetInverse, linearInverse );
+    std::cout << numbersOfThreads[t] << " threads: difference with the active set " << activeSetDifference
+              << ", mean error " << activeSetInverter->GetMeanErrorNorm() << std::endl;
+    if( !( activeSetDifference < 1e-3 ) ||
+        !( activeSetInverter->GetMeanErrorNorm() < linearInverter->GetMeanErrorNorm() + 1e-4 ) )
+      {
+      std::cerr << "the active set moves the inverse away from the full iteration" << std::endl;
+      passed = false;
+      }
+    }
+
+  // a field which changes slightly, as in the iterations of a registration
+  DisplacementFieldType::Pointer nextField = CreateField( 2.1 );
+
+  InverterType::Pointer warmInverter = InverterType::New();
+  warmInverter->SetMaximumNumberOfIterations( 50 );
+  warmInverter->UseWarmStartOn();
+  Invert( warmInverter, field );
+  const unsigned int firstIterations = warmInverter->GetElapsedIterations();
+  DisplacementFieldType::Pointer warmInverse = Invert( warmInverter, nextField );
+  const unsigned int warmIterations = warmInverter->GetElapsedIterations();
+
+  InverterType::Pointer coldInverter = InverterType::New();
+  coldInverter->SetMaximumNumberOfIterations( 50 );
+  DisplacementFieldType::Pointer coldInverse = Invert( coldInverter, nextField );
+  const unsigned int coldIterations = coldInverter->GetElapsedIterations();
+
+  const double warmDifference = CompareFields( warmInverse, coldInverse );
+  std::cout << "first field: " << firstIterations << " iterations; next field: " << warmIterations
+            << " iterations with a warm start, " << coldIterations << " iterations without, difference "
+            << warmDifference << std::endl;
+  if( !( warmIterations < coldIterations ) || coldIterations == 50 )
+    {
+    std::cerr << "the warm start does not save iterations" << std::endl;
+    passed = false;
+    }
+  const bool converged = warmInverter->GetMeanErrorNorm() <= warmInverter->GetMeanErrorToleranceThreshold()
+    || warmInverter->GetMaxErrorNorm() <= warmInverter->GetMaxErrorToleranceThreshold();
+  if( !( warmDifference < 0.1 ) || !converged )
+    {
+    std::cerr << "the warm start does not converge to the inverse" << std::endl;
+    passed = false;
+    }
+
+  // the released warm start field is no longer used
+  warmInverter->ReleaseWarmStartField();
+  Invert( warmInverter, nextField );
+  std::cout << "released warm start: " << warmInverter->GetElapsedIterations() << " iterations" << std::endl;
+  if( warmInverter->GetElapsedIterations() != coldIterations )
+    {
+    std::cerr << "the warm start field is not released" << std::endl;
+    passed = false;
+    }
+
+  // an initial estimate takes precedence over the warm start
+  warmInverter->SetInverseFieldInitialEstimate( coldInverse );
+  Invert( warmInverter, nextField );
+  std::cout << "initial estimate: " << warmInverter->GetElapsedIterations() << " iterations" << std::endl;
+  if( warmInverter->GetElapsedIterations() > warmIterations )
+    {
+    std::cerr << "the initial estimate is not used" << std::endl;
+    passed = false;
+    }
+  warmInverter->Print( std::cout );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
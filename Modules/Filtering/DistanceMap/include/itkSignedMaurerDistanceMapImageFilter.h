@@ -19,6 +19,7 @@
 #define itkSignedMaurerDistanceMapImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include <vector>
 
 namespace itk
 {
@@ -36,12 +37,23 @@ namespace itk
  *  output image is of type "int".  Obviously, if the user wishes to utilize
  *  the image spacing or to have a filter with the Euclidean distance (as
  *  opposed to the squared distance), output image types of float or double
- *  should be used.
+ *  should be used. The distances along the rows are computed with the real
+ *  type of the output pixel type (double for float and integer outputs),
+ *  so that the intermediate products do not overflow or lose precision on
+ *  large images, and a float output image can be used to halve the memory
+ *  of a double one.
  *
  *  The inside is considered as having negative distances. Outside is
  *  treated as having positive distances. To change the convention, use the
  *  InsideIsPositive(bool) function.
  *
+ *  \par Multithreading
+ *  The transform is made of one pass per dimension. Each pass processes the
+ *  rows of the image along its dimension independently, and the rows are
+ *  split between the threads. The output image is the only buffer of the
+ *  size of the image: the binary thresholding and the contour extraction
+ *  are run in place in it.
+ *
  *  \par Parameters
  *  Set/GetBackgroundValue specifies the background of the value of the
  *  input binary image. Normally this is zero and, as such, zero is the
@@ -116,6 +128,9 @@ public:
   typedef typename OutputImageType::SpacingType OutputSpacingType;
   typedef typename OutputImageType::RegionType  OutputImageRegionType;
 
+  /** Type used to compute the distances along the rows. */
+  typedef typename NumericTraits< OutputPixelType >::RealType OutputRealType;
+
   /** Set if the distance should be squared. */
   itkSetMacro(SquaredDistance, bool);
 
@@ -175,9 +190,10 @@ private:
   SignedMaurerDistanceMapImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                     //purposely not implemented
 
-  void Voronoi(unsigned int, OutputIndexType idx, OutputImageType *output );
-  bool Remove(OutputPixelType, OutputPixelType, OutputPixelType,
-              OutputPixelType, OutputPixelType, OutputPixelType);
+  void Voronoi(unsigned int, OutputIndexType idx, OutputImageType *output,
+               std::vector< OutputRealType > & g, std::vector< OutputRealType > & h);
+  bool Remove(OutputRealType, OutputRealType, OutputRealType,
+              OutputRealType, OutputRealType, OutputRealType);
 
   InputPixelType   m_BackgroundValue;
   InputSpacingType m_Spacing;
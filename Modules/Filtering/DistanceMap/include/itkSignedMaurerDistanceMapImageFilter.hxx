@@ -20,11 +20,11 @@
 
 #include "itkSignedMaurerDistanceMapImageFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkBinaryThresholdImageFilter.h"
 #include "itkBinaryContourImageFilter.h"
 #include "itkProgressReporter.h"
 #include "itkProgressAccumulator.h"
-#include "vnl/vnl_vector.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -183,27 +183,12 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        ThreadIdType threadId)
 {
-  OutputImageType      *outputImage = this->GetOutput();
-
-  InputRegionType region = outputRegionForThread;
-  InputSizeType   size   = region.GetSize();
-  InputIndexType  startIndex = outputRegionForThread.GetIndex();
+  OutputImageType *outputPtr = this->GetOutput();
 
-  OutputImageType      *outputPtr = this->GetOutput();
-
-  // compute the number of rows first, so we can setup a progress reporter
-  std::vector< InputSizeValueType > NumberOfRows;
-  for ( unsigned int i = 0; i < InputImageDimension; i++ )
-    {
-    NumberOfRows.push_back(1);
-    for ( unsigned int d = 0; d < InputImageDimension; d++ )
-      {
-      if ( d != i )
-        {
-        NumberOfRows[i] *= size[d];
-        }
-      }
-    }
+  // the region of the thread is not split along the current dimension, so
+  // it is made of whole rows, which are processed independently
+  OutputImageRegionType rowRegion = outputRegionForThread;
+  rowRegion.SetSize( m_CurrentDimension, 1 );
 
   // set the progress reporter. Use a pointer to be able to destroy it before
   // the creation of progress2
@@ -216,49 +201,21 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
   ProgressReporter *progress =
       new ProgressReporter(this,
                            threadId,
-                           NumberOfRows[m_CurrentDimension],
+                           rowRegion.GetNumberOfPixels(),
                            30,
                            0.33f + static_cast< float >( m_CurrentDimension * progressPerDimension ),
                            progressPerDimension);
 
-  // This variable provides the amount by which to divide the dimensionless index in order to get the index for each dimension.
-  vnl_vector< unsigned int > k(InputImageDimension - 1);
-  unsigned int count = 0;
-  k[count] = 1;
-  for ( unsigned int d = m_CurrentDimension + InputImageDimension - 1;
-         d > m_CurrentDimension + 1;
-         d-- )
-    {
-    k[count+1] = k[count] * size[d % InputImageDimension];
-    count++;
-    }
-  k.flip();
-
-  // The index is defined as the dimensionless index into the pixel.
-  // It must be divided by each dimension size in order to get the index for that dimension.
-  // The result of this division is the offsetIndex, which is the index offset relative to the region of this thread.
-  // The true pixel location (idx) is provided by the sum of the offsetIndex and the startIndex.
-  InputSizeValueType index;
-  OutputIndexType offsetIndex;
-  offsetIndex.Fill(0);
-  InputSizeValueType tempRow = NumberOfRows[m_CurrentDimension];
-  OutputIndexType idx;
-  idx.Fill(0);
-
-  for ( InputSizeValueType n = 0; n < tempRow; n++ )
-    {
-    index = n;
-    count = 0;
-    for ( unsigned int d = m_CurrentDimension + 1;
-         d < m_CurrentDimension + InputImageDimension; d++ )
-      {
-      offsetIndex[d % InputImageDimension] = static_cast< OutputIndexValueType >( static_cast< double >( index ) / static_cast< double >( k[count] ) );
-      idx[d % InputImageDimension] = offsetIndex[d % InputImageDimension] + static_cast< OutputIndexValueType >( startIndex[d % InputImageDimension] );
+  // the lower envelope of the parabolas is stored in buffers allocated once
+  // for all the rows of the thread
+  const OutputSizeValueType nd = outputPtr->GetRequestedRegion().GetSize()[m_CurrentDimension];
+  std::vector< OutputRealType > g( nd );
+  std::vector< OutputRealType > h( nd );
 
-      index %= k[count];
-      count++;
-      }
-    this->Voronoi(m_CurrentDimension, idx,outputImage);
+  ImageRegionConstIteratorWithIndex< OutputImageType > rowIt( outputPtr, rowRegion );
+  for ( rowIt.GoToBegin(); !rowIt.IsAtEnd(); ++rowIt )
+    {
+    this->Voronoi(m_CurrentDimension, rowIt.GetIndex(), outputPtr, g, h);
     progress->CompletedPixel();
     }
   delete progress;
@@ -281,8 +238,6 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
                                0.33f + static_cast< float >( ImageDimension * progressPerDimension ),
                                progressPerDimension);
 
-    typedef typename NumericTraits< OutputPixelType >::RealType OutputRealType;
-
     while ( !Ot.IsAtEnd() )
       {
       // cast to a real type is required on some platforms
@@ -323,59 +278,45 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
 template< typename TInputImage, typename TOutputImage >
 void
 SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
-::Voronoi(unsigned int d, OutputIndexType idx, OutputImageType *output)
+::Voronoi(unsigned int d, OutputIndexType idx, OutputImageType *output,
+          std::vector< OutputRealType > & g, std::vector< OutputRealType > & h)
 {
   OutputRegionType      oRegion = output->GetRequestedRegion();
   OutputSizeValueType   nd = oRegion.GetSize()[d];
 
-  vnl_vector< OutputPixelType > g(nd, 0 );
-  vnl_vector< OutputPixelType > h(nd, 0 );
-
-
   InputRegionType iRegion = m_InputCache->GetRequestedRegion();
   InputIndexType startIndex = iRegion.GetIndex();
 
-  OutputPixelType di;
+  // walk along the row in the buffers instead of calling GetPixel() and
+  // SetPixel() for each pixel
+  idx[d] = startIndex[d];
+  OutputPixelType *outputRow = output->GetBufferPointer() + output->ComputeOffset(idx);
+  const OffsetValueType outputStride = output->GetOffsetTable()[d];
+  const InputPixelType *inputRow = m_InputCache->GetBufferPointer() + m_InputCache->ComputeOffset(idx);
+  const OffsetValueType inputStride = m_InputCache->GetOffsetTable()[d];
+
+  const OutputRealType spacing = this->GetUseImageSpacing() ?
+    static_cast< OutputRealType >( this->m_Spacing[d] ) : NumericTraits< OutputRealType >::OneValue();
 
   int l = -1;
 
   for ( unsigned int i = 0; i < nd; i++ )
     {
-    idx[d] = i + startIndex[d];
-
-    di = output->GetPixel(idx);
-
-    OutputPixelType iw;
-
-    if ( this->GetUseImageSpacing() )
-      {
-      iw = static_cast< OutputPixelType >( i ) *
-           static_cast< OutputPixelType >( this->m_Spacing[d] );
-      }
-    else
-      {
-      iw  = static_cast< OutputPixelType >( i );
-      }
+    const OutputPixelType di = outputRow[i * outputStride];
 
     if ( di != NumericTraits< OutputPixelType >::max() )
       {
-      if ( l < 1 )
+      const OutputRealType iw = static_cast< OutputRealType >( i ) * spacing;
+      const OutputRealType dr = static_cast< OutputRealType >( di );
+
+      while ( ( l >= 1 )
+              && this->Remove(g[l - 1], g[l], dr, h[l - 1], h[l], iw) )
         {
-        l++;
-        g(l) = di;
-        h(l) = iw;
-        }
-      else
-        {
-        while ( ( l >= 1 )
-                && this->Remove(g(l - 1), g(l), di, h(l - 1), h(l), iw) )
-          {
-          l--;
-          }
-        l++;
-        g(l) = di;
-        h(l) = iw;
+        l--;
         }
+      l++;
+      g[l] = dr;
+      h[l] = iw;
       }
     }
 
@@ -390,23 +331,14 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
 
   for ( unsigned int i = 0; i < nd; i++ )
     {
-    OutputPixelType iw;
+    const OutputRealType iw = static_cast< OutputRealType >( i ) * spacing;
 
-    if ( this->GetUseImageSpacing() )
-      {
-      iw = static_cast< OutputPixelType >( i * this->m_Spacing[d] );
-      }
-    else
-      {
-      iw = static_cast< OutputPixelType >( i );
-      }
-
-    OutputPixelType d1 = vnl_math_abs( g(l) ) + ( h(l) - iw ) * ( h(l) - iw );
+    OutputRealType d1 = vnl_math_abs( g[l] ) + ( h[l] - iw ) * ( h[l] - iw );
 
     while ( l < ns )
       {
       // be sure to compute d2 *only* if l < ns
-      OutputPixelType d2 = vnl_math_abs( g(l + 1) ) + ( h(l + 1) - iw ) * ( h(l + 1) - iw );
+      OutputRealType d2 = vnl_math_abs( g[l + 1] ) + ( h[l + 1] - iw ) * ( h[l + 1] - iw );
       // then compare d1 and d2
       if ( d1 <= d2 )
         {
@@ -415,29 +347,15 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
       l++;
       d1 = d2;
       }
-    idx[d] = i + startIndex[d];
 
-    if ( m_InputCache->GetPixel(idx) != this->m_BackgroundValue )
+    const OutputPixelType value = static_cast< OutputPixelType >( d1 );
+    if ( ( inputRow[i * inputStride] != this->m_BackgroundValue ) == this->m_InsideIsPositive )
       {
-      if ( this->m_InsideIsPositive )
-        {
-        output->SetPixel(idx,  d1);
-        }
-      else
-        {
-        output->SetPixel(idx, -d1);
-        }
+      outputRow[i * outputStride] = value;
       }
     else
       {
-      if ( this->m_InsideIsPositive )
-        {
-        output->SetPixel(idx, -d1);
-        }
-      else
-        {
-        output->SetPixel(idx,  d1);
-        }
+      outputRow[i * outputStride] = -value;
       }
     }
 }
@@ -445,14 +363,14 @@ SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
 template< typename TInputImage, typename TOutputImage >
 bool
 SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
-::Remove(OutputPixelType d1, OutputPixelType d2, OutputPixelType df,
-         OutputPixelType x1, OutputPixelType x2, OutputPixelType xf)
+::Remove(OutputRealType d1, OutputRealType d2, OutputRealType df,
+         OutputRealType x1, OutputRealType x2, OutputRealType xf)
 {
-  OutputPixelType a = x2 - x1;
-  OutputPixelType b = xf - x2;
-  OutputPixelType c = xf - x1;
+  OutputRealType a = x2 - x1;
+  OutputRealType b = xf - x2;
+  OutputRealType c = xf - x1;
 
-  OutputPixelType value =
+  OutputRealType value =
       ( c * vnl_math_abs(d2) - b * vnl_math_abs(d1)
        - a * vnl_math_abs(df) - a * b * c );
 
@@ -0,0 +1,243 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSignedMaurerDistanceMapImageFilter.h"
+#include "itkConstNeighborhoodIterator.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+/** Computes the signed squared distance of each pixel to the closest
+ * object pixel with a background pixel in its full neighborhood. */
+template< typename TImage >
+std::vector< double > ComputeDistances( const TImage *image, const typename TImage::SpacingType & spacing )
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+  typedef typename TImage::IndexType IndexType;
+
+  typename itk::ConstNeighborhoodIterator< TImage >::RadiusType radius;
+  radius.Fill( 1 );
+  itk::ConstNeighborhoodIterator< TImage > nit( radius, image, image->GetLargestPossibleRegion() );
+  std::vector< IndexType > boundary;
+  for( nit.GoToBegin(); !nit.IsAtEnd(); ++nit )
+    {
+    if( nit.GetCenterPixel() == 0 )
+      {
+      continue;
+      }
+    for( unsigned int i = 0; i < nit.Size(); ++i )
+      {
+      bool inBounds;
+      if( nit.GetPixel( i, inBounds ) == 0 && inBounds )
+        {
+        boundary.push_back( nit.GetIndex() );
+        break;
+        }
+      }
+    }
+
+  std::vector< double > distances;
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double distance = itk::NumericTraits< double >::max();
+    for( unsigned int b = 0; b < boundary.size(); ++b )
+      {
+      double length = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        const double difference = ( it.GetIndex()[d] - boundary[b][d] ) * spacing[d];
+        length += difference * difference;
+        }
+      distance = std::min( distance, length );
+      }
+    distances.push_back( it.Get() != 0 ? -distance : distance );
+    }
+  return distances;
+}
+
+/** Checks the output of the filter against the distances computed by
+ * brute force, for several numbers of threads. Returns the output
+ * computed with the last number of threads. */
+template< typename TImage, typename TOutputImage >
+typename TOutputImage::Pointer CheckDistances( const char *name, const TImage *image,
+                                               bool squaredDistance, bool useImageSpacing, bool & passed )
+{
+  typedef itk::SignedMaurerDistanceMapImageFilter< TImage, TOutputImage > FilterType;
+
+  typename TImage::SpacingType spacing;
+  spacing.Fill( 1.0 );
+  if( useImageSpacing )
+    {
+    spacing = image->GetSpacing();
+    }
+  const std::vector< double > distances = ComputeDistances( image, spacing );
+
+  typename TOutputImage::Pointer output;
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 3, 8 };
+  for( unsigned int n = 0; n < 3; ++n )
+    {
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    filter->SetSquaredDistance( squaredDistance );
+    filter->SetUseImageSpacing( useImageSpacing );
+    filter->SetInsideIsPositive( false );
+    filter->SetNumberOfThreads( numbersOfThreads[n] );
+    filter->Update();
+    output = filter->GetOutput();
+
+    itk::ImageRegionConstIteratorWithIndex< TOutputImage > it( output, image->GetLargestPossibleRegion() );
+    unsigned int i = 0;
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it, ++i )
+      {
+      double expected = distances[i];
+      if( !squaredDistance )
+        {
+        expected = expected < 0.0 ? -std::sqrt( -expected ) : std::sqrt( expected );
+        }
+      if( !( std::abs( it.Get() - expected ) <= 1e-5 * std::max( 1.0, std::abs( expected ) ) ) )
+        {
+        std::cerr << name << ": the distance at " << it.GetIndex() << " is " << it.Get()
+                  << " instead of " << expected << " with " << numbersOfThreads[n] << " threads" << std::endl;
+        passed = false;
+        break;
+        }
+      }
+    }
+  return output;
+}
+
+template< unsigned int VDimension >
+int SignedMaurerDistanceMapImageFilterBruteForceTest( char * argv[] )
+{
+  typedef itk::Image< unsigned char, VDimension >  InputImageType;
+  typedef itk::Image< float, VDimension >          OutputImageType;
+  typedef itk::ImageFileReader< InputImageType >   ReaderType;
+  typedef itk::ImageFileWriter< OutputImageType >  WriterType;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  try
+    {
+    reader->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  bool passed = true;
+  CheckDistances< InputImageType, itk::Image< int, VDimension > >( "int squared", reader->GetOutput(),
+                                                                    true, false, passed );
+  CheckDistances< InputImageType, itk::Image< double, VDimension > >( "double squared", reader->GetOutput(),
+                                                                       true, true, passed );
+  typename OutputImageType::Pointer output =
+    CheckDistances< InputImageType, OutputImageType >( "float", reader->GetOutput(), false, true, passed );
+
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( output );
+  writer->SetFileName( argv[2] );
+  writer->UseCompressionOn();
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+}
+
+/** Checks SignedMaurerDistanceMapImageFilter against the distances
+ * computed by brute force, with integer, float and double outputs and
+ * several numbers of threads. */
+int itkSignedMaurerDistanceMapImageFilterBruteForceTest( int argc, char * argv[] )
+{
+  if( argc < 3 )
+    {
+    std::cerr << "Usage: " << argv[0] << " InputImage OutputImage [ImageDimension]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  int ImageDimension = 2;
+  if( argc >= 4 )
+    {
+    ImageDimension = atoi( argv[3] );
+    }
+
+  bool passed = true;
+  if( ImageDimension == 2 )
+    {
+    passed = SignedMaurerDistanceMapImageFilterBruteForceTest< 2 >( argv ) == EXIT_SUCCESS;
+    }
+  else if( ImageDimension == 3 )
+    {
+    passed = SignedMaurerDistanceMapImageFilterBruteForceTest< 3 >( argv ) == EXIT_SUCCESS;
+    }
+  else
+    {
+    std::cerr << "Unsupported dimension " << ImageDimension << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // a few points far from each other in a wide image, so that the products
+  // computed to compare the parabolas do not fit in an int
+  typedef itk::Image< unsigned char, 2 > WideImageType;
+  WideImageType::SizeType size;
+  size[0] = 4000;
+  size[1] = 600;
+  WideImageType::Pointer wideImage = WideImageType::New();
+  wideImage->SetRegions( size );
+  wideImage->Allocate();
+  wideImage->FillBuffer( 0 );
+  const itk::IndexValueType points[4][2] = { { 999, 96 }, { 58, 214 }, { 1829, 388 }, { 1711, 483 } };
+  for( unsigned int i = 0; i < 4; ++i )
+    {
+    WideImageType::IndexType index;
+    index[0] = points[i][0];
+    index[1] = points[i][1];
+    wideImage->SetPixel( index, 1 );
+    }
+  CheckDistances< WideImageType, itk::Image< int, 2 > >( "wide int squared", wideImage, true, false, passed );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
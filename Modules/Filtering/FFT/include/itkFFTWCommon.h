@@ -348,10 +348,97 @@ public:
   }
 
 
+  /** Get the plan from the plan cache of FFTWGlobalConfiguration, or
+   * create it with Plan_dft_r2c and add it to the cache. The plan must be
+   * executed with Execute_dft_r2c, possibly on other arrays with the same
+   * alignment. When \c cached is true, the cache owns the plan, which
+   * must not be destroyed; otherwise the cache was full, and the plan
+   * must be destroyed with DestroyPlan after its execution. */
+  static PlanType CachedPlan_dft_r2c(int rank,
+                                     const int *n,
+                                     PixelType *in,
+                                     ComplexType *out,
+                                     unsigned flags,
+                                     bool & cached,
+                                     int threads=1,
+                                     bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::PlanKey::REAL_TO_COMPLEX,
+      rank, n, 0, flags, threads, fftwf_alignment_of(in),
+      fftwf_alignment_of(reinterpret_cast< PixelType * >(out)), (void *)in == (void *)out );
+    PlanType plan;
+    cached = true;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = Plan_dft_r2c(rank, n, in, out, flags, threads, canDestroyInput);
+      cached = FFTWGlobalConfiguration::AddCachedPlan( key, plan );
+      }
+    return plan;
+  }
+
+  static PlanType CachedPlan_dft_c2r(int rank,
+                                     const int *n,
+                                     ComplexType *in,
+                                     PixelType *out,
+                                     unsigned flags,
+                                     bool & cached,
+                                     int threads=1,
+                                     bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::PlanKey::COMPLEX_TO_REAL,
+      rank, n, 0, flags, threads, fftwf_alignment_of(reinterpret_cast< PixelType * >(in)),
+      fftwf_alignment_of(out), (void *)in == (void *)out );
+    PlanType plan;
+    cached = true;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = Plan_dft_c2r(rank, n, in, out, flags, threads, canDestroyInput);
+      cached = FFTWGlobalConfiguration::AddCachedPlan( key, plan );
+      }
+    return plan;
+  }
+
+  static PlanType CachedPlan_dft(int rank,
+                                 const int *n,
+                                 ComplexType *in,
+                                 ComplexType *out,
+                                 int sign,
+                                 unsigned flags,
+                                 bool & cached,
+                                 int threads=1,
+                                 bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::PlanKey::COMPLEX_TO_COMPLEX,
+      rank, n, sign, flags, threads, fftwf_alignment_of(reinterpret_cast< PixelType * >(in)),
+      fftwf_alignment_of(reinterpret_cast< PixelType * >(out)), in == out );
+    PlanType plan;
+    cached = true;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = Plan_dft(rank, n, in, out, sign, flags, threads, canDestroyInput);
+      cached = FFTWGlobalConfiguration::AddCachedPlan( key, plan );
+      }
+    return plan;
+  }
+
+
   static void Execute(PlanType p)
   {
     fftwf_execute(p);
   }
+  /** Execute the plan on new arrays, which is thread safe. */
+  static void Execute_dft_r2c(PlanType p, PixelType *in, ComplexType *out)
+  {
+    fftwf_execute_dft_r2c(p, in, out);
+  }
+  static void Execute_dft_c2r(PlanType p, ComplexType *in, PixelType *out)
+  {
+    fftwf_execute_dft_c2r(p, in, out);
+  }
+  static void Execute_dft(PlanType p, ComplexType *in, ComplexType *out)
+  {
+    fftwf_execute_dft(p, in, out);
+  }
   static void DestroyPlan(PlanType p)
   {
     MutexLockHolder< FFTWGlobalConfiguration::MutexType > lock( FFTWGlobalConfiguration::GetLockMutex() );
@@ -651,10 +738,97 @@ public:
   }
 
 
+  /** Get the plan from the plan cache of FFTWGlobalConfiguration, or
+   * create it with Plan_dft_r2c and add it to the cache. The plan must be
+   * executed with Execute_dft_r2c, possibly on other arrays with the same
+   * alignment. When \c cached is true, the cache owns the plan, which
+   * must not be destroyed; otherwise the cache was full, and the plan
+   * must be destroyed with DestroyPlan after its execution. */
+  static PlanType CachedPlan_dft_r2c(int rank,
+                                     const int *n,
+                                     PixelType *in,
+                                     ComplexType *out,
+                                     unsigned flags,
+                                     bool & cached,
+                                     int threads=1,
+                                     bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::PlanKey::REAL_TO_COMPLEX,
+      rank, n, 0, flags, threads, fftw_alignment_of(in),
+      fftw_alignment_of(reinterpret_cast< PixelType * >(out)), (void *)in == (void *)out );
+    PlanType plan;
+    cached = true;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = Plan_dft_r2c(rank, n, in, out, flags, threads, canDestroyInput);
+      cached = FFTWGlobalConfiguration::AddCachedPlan( key, plan );
+      }
+    return plan;
+  }
+
+  static PlanType CachedPlan_dft_c2r(int rank,
+                                     const int *n,
+                                     ComplexType *in,
+                                     PixelType *out,
+                                     unsigned flags,
+                                     bool & cached,
+                                     int threads=1,
+                                     bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::PlanKey::COMPLEX_TO_REAL,
+      rank, n, 0, flags, threads, fftw_alignment_of(reinterpret_cast< PixelType * >(in)),
+      fftw_alignment_of(out), (void *)in == (void *)out );
+    PlanType plan;
+    cached = true;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = Plan_dft_c2r(rank, n, in, out, flags, threads, canDestroyInput);
+      cached = FFTWGlobalConfiguration::AddCachedPlan( key, plan );
+      }
+    return plan;
+  }
+
+  static PlanType CachedPlan_dft(int rank,
+                                 const int *n,
+                                 ComplexType *in,
+                                 ComplexType *out,
+                                 int sign,
+                                 unsigned flags,
+                                 bool & cached,
+                                 int threads=1,
+                                 bool canDestroyInput=false)
+  {
+    const FFTWGlobalConfiguration::PlanKey key( FFTWGlobalConfiguration::PlanKey::COMPLEX_TO_COMPLEX,
+      rank, n, sign, flags, threads, fftw_alignment_of(reinterpret_cast< PixelType * >(in)),
+      fftw_alignment_of(reinterpret_cast< PixelType * >(out)), in == out );
+    PlanType plan;
+    cached = true;
+    if( !FFTWGlobalConfiguration::GetCachedPlan( key, plan ) )
+      {
+      plan = Plan_dft(rank, n, in, out, sign, flags, threads, canDestroyInput);
+      cached = FFTWGlobalConfiguration::AddCachedPlan( key, plan );
+      }
+    return plan;
+  }
+
+
   static void Execute(PlanType p)
   {
     fftw_execute(p);
   }
+  /** Execute the plan on new arrays, which is thread safe. */
+  static void Execute_dft_r2c(PlanType p, PixelType *in, ComplexType *out)
+  {
+    fftw_execute_dft_r2c(p, in, out);
+  }
+  static void Execute_dft_c2r(PlanType p, ComplexType *in, PixelType *out)
+  {
+    fftw_execute_dft_c2r(p, in, out);
+  }
+  static void Execute_dft(PlanType p, ComplexType *in, ComplexType *out)
+  {
+    fftw_execute_dft(p, in, out);
+  }
   static void DestroyPlan(PlanType p)
   {
     MutexLockHolder< FFTWGlobalConfiguration::MutexType > lock( FFTWGlobalConfiguration::GetLockMutex() );
@@ -94,16 +94,23 @@ FFTWComplexToComplexFFTImageFilter< TImage >
     sizes[(ImageDimension - 1) - i] = inputSize[i];
     }
 
-  plan = FFTWProxyType::Plan_dft(ImageDimension,sizes,
-                                    in,
-                                    out,
-                                    transformDirection,
-                                    flags,
-                                    this->GetNumberOfThreads());
+  // the plan is owned by the plan cache, and reused by the filters which
+  // transform images of the same size, unless the cache is full
+  bool cached;
+  plan = FFTWProxyType::CachedPlan_dft(ImageDimension,sizes,
+                                       in,
+                                       out,
+                                       transformDirection,
+                                       flags,
+                                       cached,
+                                       this->GetNumberOfThreads());
   delete[] sizes;
 
-  FFTWProxyType::Execute(plan);
-  FFTWProxyType::DestroyPlan(plan);
+  FFTWProxyType::Execute_dft(plan, in, out);
+  if( !cached )
+    {
+    FFTWProxyType::DestroyPlan(plan);
+    }
 }
 
 
@@ -110,13 +110,19 @@ FFTWForwardFFTImageFilter< TInputImage, TOutputImage >
     sizes[(ImageDimension - 1) - i] = inputSize[i];
     }
 
-  plan = FFTWProxyType::Plan_dft_r2c(ImageDimension, sizes, in,
-                                     (typename FFTWProxyType::ComplexType*)
-                                     fftwOutput->GetBufferPointer(), flags,
-                                     this->GetNumberOfThreads());
+  typename FFTWProxyType::ComplexType * out =
+    (typename FFTWProxyType::ComplexType*) fftwOutput->GetBufferPointer();
+  // the plan is owned by the plan cache, and reused by the filters which
+  // transform images of the same size, unless the cache is full
+  bool cached;
+  plan = FFTWProxyType::CachedPlan_dft_r2c(ImageDimension, sizes, in, out, flags, cached,
+                                           this->GetNumberOfThreads());
   delete[] sizes;
-  FFTWProxyType::Execute(plan);
-  FFTWProxyType::DestroyPlan(plan);
+  FFTWProxyType::Execute_dft_r2c(plan, in, out);
+  if( !cached )
+    {
+    FFTWProxyType::DestroyPlan(plan);
+    }
 
   // Expand the half image to the full image size
   typedef HalfToFullHermitianImageFilter< OutputImageType > HalfToFullFilterType;
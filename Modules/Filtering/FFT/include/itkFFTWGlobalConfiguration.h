@@ -31,6 +31,8 @@
 #include "fftw3.h"
 #include <algorithm>
 #include <cctype>
+#include <map>
+#include <vector>
 
 //* The fftw utilities help control the various strategies
 //available for controlling optimizations for the FFTW library.
@@ -51,6 +53,10 @@
 //                             set, then ITK_FFTW_WISDOM_CACHE_BASE
 //                             is ignored.
 //
+//The plans created by the FFTW filters are kept in a process wide
+//cache, and executed on the buffers of the later filters which
+//transform images of the same size.
+//
 // The above behaviors can also be controlled by the application.
 //
 
@@ -154,6 +160,17 @@ private:
  * before calling FFTW unsafe functions. It also handle
  * cleanly the initialization and cleanup of FFTW.
  *
+ * The plans of the FFTW filters are kept in a plan cache shared by
+ * all the filters of the process. A plan is identified by a PlanKey,
+ * and is executed with the new-array execute functions of FFTW on the
+ * buffers of the filters, which must have the same alignment as the
+ * buffers the plan was created with. The FFTW execute functions are
+ * thread safe, so a cached plan can be executed by several filters at
+ * the same time. The numbers of plans found in the cache or created are
+ * counted, to check that the plans are reused. The cache holds at most
+ * MaximumPlanCacheSize plans: the plans created when it is full are not
+ * cached, and are destroyed by the filters after their execution.
+ *
  * This implementation was taken from the Insight Journal paper:
  * http://hdl.handle.net/10380/3154
  * or http://insight-journal.com/browse/publication/717
@@ -180,6 +197,67 @@ public:
   /** Get the mutex that protects calls to FFTW functions. */
   static SimpleFastMutexLock & GetLockMutex();
 
+  /** \class PlanKey
+   * \brief Identifies a plan of the plan cache.
+   *
+   * A plan can be executed on new arrays only if they have the same
+   * alignment, and are in place if the arrays of the plan are, so these
+   * are part of the key with the transform, its sizes, sign, flags and
+   * number of threads.
+   * \ingroup ITKFFT
+   */
+  class ITKFFT_EXPORT PlanKey
+  {
+  public:
+    typedef enum { REAL_TO_COMPLEX, COMPLEX_TO_REAL, COMPLEX_TO_COMPLEX } TransformType;
+
+    PlanKey( TransformType transform, int rank, const int *n, int sign, unsigned flags, int threads,
+             int inputAlignment, int outputAlignment, bool inPlace );
+
+    bool operator<( const PlanKey & other ) const
+    {
+      return m_Values < other.m_Values;
+    }
+
+  private:
+    std::vector< int > m_Values;
+  };
+
+#if defined(ITK_USE_FFTWF)
+  /** Get the plan of the key from the plan cache. Returns false, and
+   * counts a miss, if there is no such plan. */
+  static bool GetCachedPlan( const PlanKey & key, fftwf_plan & plan );
+
+  /** Add a plan to the plan cache, which then owns it, and return true.
+   * If a plan was added for the same key in the meantime, the new plan is
+   * destroyed and replaced by the cached one. Return false if the cache
+   * is full: the plan is not cached, and must be destroyed by the caller
+   * after its execution. */
+  static bool AddCachedPlan( const PlanKey & key, fftwf_plan & plan );
+#endif
+#if defined(ITK_USE_FFTWD)
+  static bool GetCachedPlan( const PlanKey & key, fftw_plan & plan );
+  static bool AddCachedPlan( const PlanKey & key, fftw_plan & plan );
+#endif
+
+  /** Destroy the plans of the plan cache, and reset the numbers of hits
+   * and misses. No filter must be executing a cached plan. */
+  static void ClearPlanCache();
+
+  /** Get the number of plans in the plan cache. */
+  static SizeValueType GetPlanCacheSize();
+
+  /** Set/Get the maximum number of plans in the plan cache, 64 by
+   * default. Lowering it does not destroy the cached plans: call
+   * ClearPlanCache() for this. */
+  static void SetMaximumPlanCacheSize( const SizeValueType & v );
+  static SizeValueType GetMaximumPlanCacheSize();
+
+  /** Get the number of plans found in the plan cache, and the number of
+   * plans which had to be created, since the last ClearPlanCache. */
+  static SizeValueType GetNumberOfPlanCacheHits();
+  static SizeValueType GetNumberOfPlanCacheMisses();
+
   /** Set/Get wether a new wisdom is available compared to the
    * initial state. If a new wisdom is available, the wisdoms
    * may be written to the cache file
@@ -293,13 +371,35 @@ private:
    * the program exits. */
   itkFactorylessNewMacro(Self);
 
+  /** Destroy the cached plans and reset the counts. */
+  void DestroyCachedPlans();
+
+  /** Get the number of cached plans, with m_Lock held. */
+  SizeValueType GetPlanCacheSizeWithoutLock() const;
+
   FFTWGlobalConfiguration(const Self &); //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
   static Pointer                m_Instance;
   static SimpleFastMutexLock    m_CreationLock;
 
+#if defined(ITK_USE_FFTWF)
+  typedef std::map< PlanKey, fftwf_plan > FloatPlanCacheType;
+#endif
+#if defined(ITK_USE_FFTWD)
+  typedef std::map< PlanKey, fftw_plan >  DoublePlanCacheType;
+#endif
+
   SimpleFastMutexLock           m_Lock;
+#if defined(ITK_USE_FFTWF)
+  FloatPlanCacheType            m_FloatPlanCache;
+#endif
+#if defined(ITK_USE_FFTWD)
+  DoublePlanCacheType           m_DoublePlanCache;
+#endif
+  SizeValueType                 m_NumberOfPlanCacheHits;
+  SizeValueType                 m_NumberOfPlanCacheMisses;
+  SizeValueType                 m_MaximumPlanCacheSize;
   bool                          m_NewWisdomAvailable;
   int                           m_PlanRigor;
   bool                          m_WriteWisdomCache;
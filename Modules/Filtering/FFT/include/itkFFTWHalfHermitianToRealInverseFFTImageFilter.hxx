@@ -94,9 +94,12 @@ FFTWHalfHermitianToRealInverseFFTImageFilter< TInputImage, TOutputImage >
     {
     sizes[(ImageDimension - 1) - i] = outputSize[i];
     }
-  plan = FFTWProxyType::Plan_dft_c2r( ImageDimension, sizes, in, out, m_PlanRigor,
-                                      this->GetNumberOfThreads(),
-                                      !m_CanUseDestructiveAlgorithm );
+  // The plan is owned by the plan cache, and reused by the filters which
+  // transform images of the same size, unless the cache is full.
+  bool cached;
+  plan = FFTWProxyType::CachedPlan_dft_c2r( ImageDimension, sizes, in, out, m_PlanRigor, cached,
+                                            this->GetNumberOfThreads(),
+                                            !m_CanUseDestructiveAlgorithm );
   if( !m_CanUseDestructiveAlgorithm )
     {
     // complex<double> and double[2] types are compatible memory layouts.
@@ -106,10 +109,13 @@ FFTWHalfHermitianToRealInverseFFTImageFilter< TInputImage, TOutputImage >
                inputPtr->GetBufferPointer()+totalInputSize,
                reinterpret_cast< typename InputImageType::PixelType * > (in) );
     }
-  FFTWProxyType::Execute( plan );
+  FFTWProxyType::Execute_dft_c2r( plan, in, out );
+  if( !cached )
+    {
+    FFTWProxyType::DestroyPlan( plan );
+    }
 
   // Some cleanup.
-  FFTWProxyType::DestroyPlan( plan );
   if( !m_CanUseDestructiveAlgorithm )
     {
     delete[] in;
@@ -92,12 +92,16 @@ FFTWInverseFFTImageFilter< TInputImage, TOutputImage >
     sizes[(ImageDimension - 1) - i] = outputSize[i];
     }
 
-  plan = FFTWProxyType::Plan_dft_c2r( ImageDimension, sizes, in, out, m_PlanRigor,
-                                      this->GetNumberOfThreads(), false );
-  FFTWProxyType::Execute( plan );
-
-  // Some cleanup.
-  FFTWProxyType::DestroyPlan( plan );
+  // The plan is owned by the plan cache, and reused by the filters which
+  // transform images of the same size, unless the cache is full.
+  bool cached;
+  plan = FFTWProxyType::CachedPlan_dft_c2r( ImageDimension, sizes, in, out, m_PlanRigor, cached,
+                                            this->GetNumberOfThreads(), false );
+  FFTWProxyType::Execute_dft_c2r( plan, in, out );
+  if( !cached )
+    {
+    FFTWProxyType::DestroyPlan( plan );
+    }
 }
 
 template <typename TInputImage, typename TOutputImage>
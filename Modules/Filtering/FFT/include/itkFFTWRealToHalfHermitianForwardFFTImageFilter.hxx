@@ -93,11 +93,17 @@ FFTWRealToHalfHermitianForwardFFTImageFilter< TInputImage, TOutputImage >
     sizes[(ImageDimension - 1) - i] = inputSize[i];
     }
 
-  plan = FFTWProxyType::Plan_dft_r2c(ImageDimension, sizes, in, out, flags,
-                                    this->GetNumberOfThreads());
+  // the plan is owned by the plan cache, and reused by the filters which
+  // transform images of the same size, unless the cache is full
+  bool cached;
+  plan = FFTWProxyType::CachedPlan_dft_r2c(ImageDimension, sizes, in, out, flags, cached,
+                                           this->GetNumberOfThreads());
   delete[] sizes;
-  FFTWProxyType::Execute(plan);
-  FFTWProxyType::DestroyPlan(plan);
+  FFTWProxyType::Execute_dft_r2c(plan, in, out);
+  if( !cached )
+    {
+    FFTWProxyType::DestroyPlan(plan);
+    }
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -31,6 +31,7 @@
 #endif
 
 # include "itkObjectFactory.h"
+# include "itkMutexLockHolder.h"
 
 namespace itk
 {
@@ -406,7 +407,10 @@ HardwareWisdomFilenameGenerator
 
 
 FFTWGlobalConfiguration
-::FFTWGlobalConfiguration():m_NewWisdomAvailable(false),
+::FFTWGlobalConfiguration():m_NumberOfPlanCacheHits(0),
+  m_NumberOfPlanCacheMisses(0),
+  m_MaximumPlanCacheSize(64),
+  m_NewWisdomAvailable(false),
   m_PlanRigor(0),
   m_WriteWisdomCache(false),
   m_ReadWisdomCache(true),
@@ -550,6 +554,8 @@ FFTWGlobalConfiguration
       }
 #endif
     }
+  // the cached plans must be destroyed before the cleanup of fftw
+  this->DestroyCachedPlans();
 #if defined(ITK_USE_FFTWF)
   fftwf_cleanup_threads();
   fftwf_cleanup();
@@ -757,6 +763,190 @@ FFTWGlobalConfiguration
   return GetInstance()->m_Lock;
 }
 
+FFTWGlobalConfiguration::PlanKey
+::PlanKey( TransformType transform, int rank, const int *n, int sign, unsigned flags, int threads,
+           int inputAlignment, int outputAlignment, bool inPlace ):
+  m_Values( n, n + rank )
+{
+  m_Values.push_back( transform );
+  m_Values.push_back( rank );
+  m_Values.push_back( sign );
+  m_Values.push_back( static_cast< int >( flags ) );
+  m_Values.push_back( threads );
+  m_Values.push_back( inputAlignment );
+  m_Values.push_back( outputAlignment );
+  m_Values.push_back( inPlace );
+}
+
+#if defined(ITK_USE_FFTWF)
+bool
+FFTWGlobalConfiguration
+::GetCachedPlan( const PlanKey & key, fftwf_plan & plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  FloatPlanCacheType::const_iterator it = instance->m_FloatPlanCache.find( key );
+  if( it == instance->m_FloatPlanCache.end() )
+    {
+    ++instance->m_NumberOfPlanCacheMisses;
+    return false;
+    }
+  ++instance->m_NumberOfPlanCacheHits;
+  plan = it->second;
+  return true;
+}
+
+bool
+FFTWGlobalConfiguration
+::AddCachedPlan( const PlanKey & key, fftwf_plan & plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  FloatPlanCacheType::const_iterator it = instance->m_FloatPlanCache.find( key );
+  if( it != instance->m_FloatPlanCache.end() )
+    {
+    fftwf_destroy_plan( plan );
+    plan = it->second;
+    return true;
+    }
+  if( instance->GetPlanCacheSizeWithoutLock() >= instance->m_MaximumPlanCacheSize )
+    {
+    return false;
+    }
+  instance->m_FloatPlanCache.insert( FloatPlanCacheType::value_type( key, plan ) );
+  return true;
+}
+#endif
+
+#if defined(ITK_USE_FFTWD)
+bool
+FFTWGlobalConfiguration
+::GetCachedPlan( const PlanKey & key, fftw_plan & plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  DoublePlanCacheType::const_iterator it = instance->m_DoublePlanCache.find( key );
+  if( it == instance->m_DoublePlanCache.end() )
+    {
+    ++instance->m_NumberOfPlanCacheMisses;
+    return false;
+    }
+  ++instance->m_NumberOfPlanCacheHits;
+  plan = it->second;
+  return true;
+}
+
+bool
+FFTWGlobalConfiguration
+::AddCachedPlan( const PlanKey & key, fftw_plan & plan )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  DoublePlanCacheType::const_iterator it = instance->m_DoublePlanCache.find( key );
+  if( it != instance->m_DoublePlanCache.end() )
+    {
+    fftw_destroy_plan( plan );
+    plan = it->second;
+    return true;
+    }
+  if( instance->GetPlanCacheSizeWithoutLock() >= instance->m_MaximumPlanCacheSize )
+    {
+    return false;
+    }
+  instance->m_DoublePlanCache.insert( DoublePlanCacheType::value_type( key, plan ) );
+  return true;
+}
+#endif
+
+void
+FFTWGlobalConfiguration
+::ClearPlanCache()
+{
+  GetInstance()->DestroyCachedPlans();
+}
+
+void
+FFTWGlobalConfiguration
+::DestroyCachedPlans()
+{
+  MutexLockHolder< MutexType > lock( m_Lock );
+#if defined(ITK_USE_FFTWF)
+  for( FloatPlanCacheType::iterator it = m_FloatPlanCache.begin(); it != m_FloatPlanCache.end(); ++it )
+    {
+    fftwf_destroy_plan( it->second );
+    }
+  m_FloatPlanCache.clear();
+#endif
+#if defined(ITK_USE_FFTWD)
+  for( DoublePlanCacheType::iterator it = m_DoublePlanCache.begin(); it != m_DoublePlanCache.end(); ++it )
+    {
+    fftw_destroy_plan( it->second );
+    }
+  m_DoublePlanCache.clear();
+#endif
+  m_NumberOfPlanCacheHits = 0;
+  m_NumberOfPlanCacheMisses = 0;
+}
+
+SizeValueType
+FFTWGlobalConfiguration
+::GetPlanCacheSizeWithoutLock() const
+{
+  SizeValueType size = 0;
+#if defined(ITK_USE_FFTWF)
+  size += m_FloatPlanCache.size();
+#endif
+#if defined(ITK_USE_FFTWD)
+  size += m_DoublePlanCache.size();
+#endif
+  return size;
+}
+
+SizeValueType
+FFTWGlobalConfiguration
+::GetPlanCacheSize()
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  return instance->GetPlanCacheSizeWithoutLock();
+}
+
+void
+FFTWGlobalConfiguration
+::SetMaximumPlanCacheSize( const SizeValueType & v )
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  instance->m_MaximumPlanCacheSize = v;
+}
+
+SizeValueType
+FFTWGlobalConfiguration
+::GetMaximumPlanCacheSize()
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  return instance->m_MaximumPlanCacheSize;
+}
+
+SizeValueType
+FFTWGlobalConfiguration
+::GetNumberOfPlanCacheHits()
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  return instance->m_NumberOfPlanCacheHits;
+}
+
+SizeValueType
+FFTWGlobalConfiguration
+::GetNumberOfPlanCacheMisses()
+{
+  Pointer instance = GetInstance();
+  MutexLockHolder< MutexType > lock( instance->m_Lock );
+  return instance->m_NumberOfPlanCacheMisses;
+}
+
 void
 FFTWGlobalConfiguration
 ::SetNewWisdomAvailable( const bool & v )
@@ -0,0 +1,215 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkComplexToComplexFFTImageFilter.h"
+#include "itkFFTWComplexToComplexFFTImageFilter.h"
+#include "itkFFTWHalfHermitianToRealInverseFFTImageFilter.h"
+#include "itkFFTWRealToHalfHermitianForwardFFTImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+
+namespace
+{
+
+template< typename TPixel >
+class PlanCacheChecker
+{
+public:
+  typedef itk::Image< TPixel, 3 >                                                RealImageType;
+  typedef itk::Image< std::complex< TPixel >, 3 >                                ComplexImageType;
+  typedef itk::FFTWRealToHalfHermitianForwardFFTImageFilter< RealImageType >     ForwardFilterType;
+  typedef itk::FFTWHalfHermitianToRealInverseFFTImageFilter< ComplexImageType >  InverseFilterType;
+  typedef itk::FFTWComplexToComplexFFTImageFilter< ComplexImageType >            ComplexFilterType;
+
+  typename RealImageType::Pointer m_Image;
+  unsigned int                    m_NumberOfRoundTrips;
+  bool                            m_Passed;
+
+  PlanCacheChecker( const typename RealImageType::SizeType & size ):
+    m_NumberOfRoundTrips( 0 ),
+    m_Passed( true )
+  {
+    m_Image = RealImageType::New();
+    m_Image->SetRegions( size );
+    m_Image->Allocate();
+    itk::ImageRegionIterator< RealImageType > it( m_Image, m_Image->GetLargestPossibleRegion() );
+    unsigned int i = 0;
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it, ++i )
+      {
+      it.Set( static_cast< TPixel >( ( i * 7919 ) % 101 ) );
+      }
+  }
+
+  /** Transforms the image forward with a half Hermitian transform,
+   * forward and backward with complex transforms, and backward to a real
+   * image, which must be the input image. */
+  bool RoundTrip( itk::ThreadIdType numberOfThreads )
+  {
+    typename ForwardFilterType::Pointer forward = ForwardFilterType::New();
+    forward->SetInput( m_Image );
+    forward->SetNumberOfThreads( numberOfThreads );
+    typename ComplexFilterType::Pointer complexForward = ComplexFilterType::New();
+    complexForward->SetInput( forward->GetOutput() );
+    complexForward->SetNumberOfThreads( numberOfThreads );
+    typename ComplexFilterType::Pointer complexInverse = ComplexFilterType::New();
+    complexInverse->SetInput( complexForward->GetOutput() );
+    complexInverse->SetTransformDirection( ComplexFilterType::INVERSE );
+    complexInverse->SetNumberOfThreads( numberOfThreads );
+    typename InverseFilterType::Pointer inverse = InverseFilterType::New();
+    inverse->SetInput( complexInverse->GetOutput() );
+    inverse->SetActualXDimensionIsOdd( m_Image->GetLargestPossibleRegion().GetSize()[0] % 2 != 0 );
+    inverse->SetNumberOfThreads( numberOfThreads );
+    inverse->Update();
+
+    itk::ImageRegionConstIterator< RealImageType > it( m_Image, m_Image->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< RealImageType > oit( inverse->GetOutput(), m_Image->GetLargestPossibleRegion() );
+    for( ; !it.IsAtEnd(); ++it, ++oit )
+      {
+      if( std::abs( oit.Get() - it.Get() ) > 1.0e-3 )
+        {
+        std::cerr << "The round trip gives " << oit.Get() << " instead of " << it.Get()
+                  << " at " << it.GetIndex() << std::endl;
+        return false;
+        }
+      }
+    return true;
+  }
+
+  static ITK_THREAD_RETURN_TYPE ThreadedRoundTrip( void *arg )
+  {
+    itk::MultiThreader::ThreadInfoStruct *info = static_cast< itk::MultiThreader::ThreadInfoStruct * >( arg );
+    PlanCacheChecker *checker = static_cast< PlanCacheChecker * >( info->UserData );
+    for( unsigned int i = 0; i < checker->m_NumberOfRoundTrips; ++i )
+      {
+      if( !checker->RoundTrip( 1 ) )
+        {
+        // only written to false, so no lock is needed
+        checker->m_Passed = false;
+        }
+      }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+};
+
+/** Checks that the plans are created once and then found in the cache,
+ * when the image is transformed several times by new filters, and by
+ * several threads at the same time, and that the cache keeps at most
+ * MaximumPlanCacheSize plans. */
+template< typename TPixel >
+bool CheckPlanCache( const char *name )
+{
+  typedef PlanCacheChecker< TPixel > CheckerType;
+  typename CheckerType::RealImageType::SizeType size;
+  size[0] = 45;
+  size[1] = 32;
+  size[2] = 27;
+  CheckerType checker( size );
+
+  itk::FFTWGlobalConfiguration::ClearPlanCache();
+
+  bool passed = checker.RoundTrip( 2 );
+  const itk::SizeValueType misses = itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheMisses();
+  if( misses != 4 || itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheHits() != 0 )
+    {
+    std::cerr << name << ": " << misses << " misses and " << itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheHits()
+              << " hits instead of 4 misses for the first round trip" << std::endl;
+    passed = false;
+    }
+
+  // the plans of the first round trip are reused, except the ones of the
+  // buffers which happen to have another alignment
+  const unsigned int numberOfRoundTrips = 10;
+  for( unsigned int i = 0; i < numberOfRoundTrips; ++i )
+    {
+    passed &= checker.RoundTrip( 2 );
+    }
+
+  // the threads share the plans created with one thread
+  checker.m_NumberOfRoundTrips = 5;
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( 4 );
+  threader->SetSingleMethod( CheckerType::ThreadedRoundTrip, &checker );
+  threader->SingleMethodExecute();
+  passed &= checker.m_Passed;
+
+  const itk::SizeValueType hits = itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheHits();
+  const itk::SizeValueType allMisses = itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheMisses();
+  const itk::SizeValueType requests = 4 * ( 1 + numberOfRoundTrips + threader->GetNumberOfThreads() * 5 );
+  if( hits + allMisses != requests || hits < requests / 2 )
+    {
+    std::cerr << name << ": " << hits << " hits and " << allMisses << " misses for " << requests
+              << " plans" << std::endl;
+    passed = false;
+    }
+  if( itk::FFTWGlobalConfiguration::GetPlanCacheSize() > allMisses )
+    {
+    std::cerr << name << ": " << itk::FFTWGlobalConfiguration::GetPlanCacheSize()
+              << " plans in the cache for " << allMisses << " misses" << std::endl;
+    passed = false;
+    }
+
+  itk::FFTWGlobalConfiguration::ClearPlanCache();
+  if( itk::FFTWGlobalConfiguration::GetPlanCacheSize() != 0
+      || itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheHits() != 0
+      || itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheMisses() != 0 )
+    {
+    std::cerr << name << ": the plan cache was not cleared" << std::endl;
+    passed = false;
+    }
+
+  // the plans which do not fit in the cache are destroyed by the filters
+  const itk::SizeValueType maximumPlanCacheSize = itk::FFTWGlobalConfiguration::GetMaximumPlanCacheSize();
+  itk::FFTWGlobalConfiguration::SetMaximumPlanCacheSize( 2 );
+  for( unsigned int i = 0; i < 3; ++i )
+    {
+    passed &= checker.RoundTrip( 1 );
+    }
+  if( itk::FFTWGlobalConfiguration::GetPlanCacheSize() != 2
+      || itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheHits() < 2 )
+    {
+    std::cerr << name << ": " << itk::FFTWGlobalConfiguration::GetPlanCacheSize() << " plans in the cache and "
+              << itk::FFTWGlobalConfiguration::GetNumberOfPlanCacheHits() << " hits with at most 2 plans"
+              << std::endl;
+    passed = false;
+    }
+  itk::FFTWGlobalConfiguration::SetMaximumPlanCacheSize( maximumPlanCacheSize );
+  itk::FFTWGlobalConfiguration::ClearPlanCache();
+  return passed;
+}
+
+}
+
+int itkFFTWPlanCacheTest( int, char* [] )
+{
+  bool passed = true;
+#ifdef ITK_USE_FFTWF
+  passed &= CheckPlanCache< float >( "float" );
+#endif
+#ifdef ITK_USE_FFTWD
+  passed &= CheckPlanCache< double >( "double" );
+#endif
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -24,6 +24,7 @@
 #include "itkFastMarchingTraits.h"
 
 #include <queue>
+#include <vector>
 #include <functional>
 
 namespace itk
@@ -40,12 +41,29 @@ namespace itk
  *
  * Updates are preformed using an entropy satisfy scheme where only
  * "upwind" neighborhoods are used. This implementation of Fast Marching
- * uses a std::priority_queue to locate the next proper node to
+ * uses a priority queue to locate the next proper node to
  * update.
  *
  * Fast Marching sweeps through N points in (N log N) steps to obtain
  * the arrival time value as the front propagates through the domain.
  *
+ * \par Priority queues:
+ * The trial nodes are sorted by one of the queues given by SetTrialQueue():
+ * \li BinaryHeap (default): a std::priority_queue, where a node is pushed
+ * again each time its value decreases, and the outdated copies are skipped
+ * when they reach the top.
+ * \li IndexedBinaryHeap: a binary heap holding each trial node once,
+ * whose value is decreased in place. The heap stays as small as the
+ * front, but the filter must identify its nodes (GetNodeIdentifier()).
+ * \li BucketQueue: an untidy priority queue, where the nodes are sorted in
+ * buckets of width BucketWidth, and the nodes of a bucket are processed in
+ * any order. Pushing and popping a node takes a constant time, and the
+ * error on the arrival times is of the order of the width of the buckets.
+ * It is meant for speeds bounded away from zero: the number of buckets is
+ * the largest difference of values between two neighbors divided by the
+ * width. There are at most 65536 buckets: the nodes beyond them, such as
+ * the ones behind almost null speeds, are sorted by a binary heap.
+ *
  * The initial front is specified by two containers:
  * \li one containing the known nodes (Alive Nodes: nodes that are already
  * part of the object),
@@ -159,6 +177,25 @@ public:
     /** \c Strict */
     Strict };
 
+  /** \enum TrialQueueType */
+  enum TrialQueueType {
+    /** \c BinaryHeap */
+    BinaryHeap = 0,
+    /** \c IndexedBinaryHeap */
+    IndexedBinaryHeap,
+    /** \c BucketQueue */
+    BucketQueue };
+
+  /** Set/Get the priority queue used to sort the trial nodes. */
+  itkSetMacro( TrialQueue, TrialQueueType );
+  itkGetConstReferenceMacro( TrialQueue, TrialQueueType );
+
+  /** Set/Get the width of the buckets of the BucketQueue. If it is null
+   * (default), the width is the smallest difference of value between a
+   * node and its neighbors, when the subclass can compute it. */
+  itkSetMacro( BucketWidth, double );
+  itkGetConstMacro( BucketWidth, double );
+
   /** Set/Get the TopologyCheckType macro indicating whether the user
   wants to check topology (and which one). */
   itkSetMacro( TopologyCheck, TopologyCheckType );
@@ -244,6 +281,45 @@ protected:
 
   TopologyCheckType m_TopologyCheck;
 
+  TrialQueueType m_TrialQueue;
+  double         m_BucketWidth;
+
+  /** Trial nodes of the IndexedBinaryHeap, and their positions in the heap
+   * indexed by node identifier. */
+  std::vector< NodePairType >   m_IndexedHeap;
+  std::vector< IdentifierType > m_IndexedHeapPositions;
+
+  /** Circular array of buckets of the BucketQueue. The buckets are numbered
+   * from the value of their nodes, and m_FirstBucket and m_LastBucket
+   * bound the numbers of the non empty ones. The nodes which do not fit in
+   * the buckets are in m_Heap. */
+  typedef std::vector< NodePairType > BucketType;
+  std::vector< BucketType > m_Buckets;
+  SizeValueType             m_FirstBucket;
+  SizeValueType             m_LastBucket;
+  SizeValueType             m_NumberOfBucketNodes;
+  double                    m_CurrentBucketWidth;
+
+  /** \brief Insert a trial node in the priority queue, or decrease its
+   * value if it is already there. */
+  void PushTrialNode( const NodePairType& iNodePair );
+
+  /** \brief Remove the trial node with the smallest value from the priority
+   * queue.
+   * \return false if the queue is empty */
+  bool PopTrialNode( NodePairType& oNodePair );
+
+  /** \brief Remove all the trial nodes from the priority queue, and
+   * release its memory. */
+  void ClearTrialNodes();
+
+  /** \brief Get an identifier of the node between 0 and the total number of
+   * nodes, used by the IndexedBinaryHeap. */
+  virtual IdentifierType GetNodeIdentifier( const NodeType& iNode ) const;
+
+  /** \brief Get the width of the buckets when BucketWidth is null. */
+  virtual double GetDefaultBucketWidth( OutputDomainType* oDomain );
+
   /** \brief Get the total number of nodes in the domain */
   virtual IdentifierType GetTotalNumberOfNodes() const = 0;
 
@@ -302,6 +378,9 @@ protected:
   void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
 private:
+  void SiftUpIndexedHeap( IdentifierType iPosition );
+  void SiftDownIndexedHeap( IdentifierType iPosition );
+
   FastMarchingBase( const Self& );
   void operator = ( const Self& );
   };
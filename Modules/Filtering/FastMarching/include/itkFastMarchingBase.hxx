@@ -23,6 +23,7 @@
 
 #include "itkProgressReporter.h"
 #include "vnl/vnl_math.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -47,6 +48,12 @@ FastMarchingBase()
   m_LargeValue = NumericTraits< OutputPixelType >::max();
   m_TopologyValue = m_LargeValue;
   m_CollectPoints = false;
+  m_TrialQueue = BinaryHeap;
+  m_BucketWidth = 0.;
+  m_FirstBucket = 0;
+  m_LastBucket = 0;
+  m_NumberOfBucketNodes = 0;
+  m_CurrentBucketWidth = 1.;
   }
 // -----------------------------------------------------------------------------
 
@@ -68,6 +75,8 @@ PrintSelf( std::ostream & os, Indent indent ) const
   os << indent << "Speed constant: " << m_SpeedConstant << std::endl;
   os << indent << "Topology check: " << m_TopologyCheck << std::endl;
   os << indent << "Normalization Factor: " << m_NormalizationFactor << std::endl;
+  os << indent << "Trial queue: " << m_TrialQueue << std::endl;
+  os << indent << "Bucket width: " << m_BucketWidth << std::endl;
   }
 
 // -----------------------------------------------------------------------------
@@ -103,10 +112,7 @@ Initialize( OutputDomainType* oDomain )
     }
 
   // make sure the heap is empty
-  while ( !m_Heap.empty() )
-    {
-    m_Heap.pop();
-    }
+  this->ClearTrialNodes();
   /*
   while ( !m_Heap->Empty() )
     {
@@ -114,6 +120,19 @@ Initialize( OutputDomainType* oDomain )
     }
   */
 
+  if( m_TrialQueue == BucketQueue )
+    {
+    m_CurrentBucketWidth = m_BucketWidth;
+    if( m_CurrentBucketWidth <= 0. )
+      {
+      m_CurrentBucketWidth = this->GetDefaultBucketWidth( oDomain );
+      }
+    if( !( m_CurrentBucketWidth > 0. ) )
+      {
+      itkExceptionMacro( <<"The width of the buckets is null or negative" );
+      }
+    }
+
   this->InitializeOutput( oDomain );
 
   // By setting the output domain to the stopping criterion, we enable funky
@@ -141,7 +160,8 @@ GenerateData()
   try
     {
     //while( !m_Heap->Empty() )
-    while( !m_Heap.empty() )
+    NodePairType current_node_pair;
+    while( this->PopTrialNode( current_node_pair ) )
       {
       //PriorityQueueElementType element = m_Heap->Peek();
       //m_Heap->Pop();
@@ -149,10 +169,6 @@ GenerateData()
       //NodeType current_node = element.m_Element;
       //OutputPixelType current_value = element.m_Priority;
 
-
-      NodePairType current_node_pair = m_Heap.top();
-      m_Heap.pop();
-
       NodeType current_node = current_node_pair.GetNode();
       current_value = this->GetOutputValue( output, current_node );
 
@@ -194,10 +210,7 @@ GenerateData()
     // it.
     //
     // RELEASE MEMORY!!!
-    while( !m_Heap.empty() )
-      {
-      m_Heap.pop();
-      }
+    this->ClearTrialNodes();
     /*while( !m_Heap->Empty() )
       {
       m_Heap->Pop();
@@ -209,10 +222,7 @@ GenerateData()
   m_TargetReachedValue = current_value;
 
   // let's release some useless memory...
-  while( !m_Heap.empty() )
-    {
-    m_Heap.pop();
-    }
+  this->ClearTrialNodes();
   /*while( !m_Heap->Empty() )
     {
     m_Heap->Pop();
@@ -220,6 +230,253 @@ GenerateData()
   }
 // -----------------------------------------------------------------------------
 
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+void
+FastMarchingBase< TInput, TOutput >::
+PushTrialNode( const NodePairType& iNodePair )
+  {
+  switch( m_TrialQueue )
+    {
+    case IndexedBinaryHeap:
+      {
+      const IdentifierType id = this->GetNodeIdentifier( iNodePair.GetNode() );
+      const IdentifierType notInHeap = NumericTraits< IdentifierType >::max();
+      if( id >= m_IndexedHeapPositions.size() )
+        {
+        m_IndexedHeapPositions.resize( std::max( id + 1,
+          static_cast< IdentifierType >( this->GetTotalNumberOfNodes() ) ), notInHeap );
+        }
+      IdentifierType position = m_IndexedHeapPositions[id];
+      if( position == notInHeap )
+        {
+        position = m_IndexedHeap.size();
+        m_IndexedHeap.push_back( iNodePair );
+        m_IndexedHeapPositions[id] = position;
+        this->SiftUpIndexedHeap( position );
+        }
+      else if( iNodePair.GetValue() < m_IndexedHeap[position].GetValue() )
+        {
+        m_IndexedHeap[position].SetValue( iNodePair.GetValue() );
+        this->SiftUpIndexedHeap( position );
+        }
+      else
+        {
+        m_IndexedHeap[position].SetValue( iNodePair.GetValue() );
+        this->SiftDownIndexedHeap( position );
+        }
+      break;
+      }
+    case BucketQueue:
+      {
+      // the nodes too far from the ones of the buckets, such as the ones
+      // behind almost null speeds, are sorted by the binary heap, so that
+      // the number of buckets stays bounded
+      const SizeValueType maximumNumberOfBuckets = 65536;
+      const double position =
+        std::max( static_cast< double >( iNodePair.GetValue() ) / m_CurrentBucketWidth, 0. );
+      if( position < static_cast< double >( NumericTraits< SizeValueType >::max() / 2 ) )
+        {
+        const SizeValueType bucket = static_cast< SizeValueType >( position );
+        const SizeValueType firstBucket = ( m_NumberOfBucketNodes == 0 ) ? bucket : std::min( m_FirstBucket, bucket );
+        const SizeValueType lastBucket = ( m_NumberOfBucketNodes == 0 ) ? bucket : std::max( m_LastBucket, bucket );
+        if( lastBucket - firstBucket < maximumNumberOfBuckets )
+          {
+          const SizeValueType numberOfBuckets = m_Buckets.size();
+          if( lastBucket - firstBucket >= numberOfBuckets )
+            {
+            // move the buckets to a larger circular array
+            std::vector< BucketType > buckets( std::min( maximumNumberOfBuckets,
+              std::max( 2 * numberOfBuckets, lastBucket - firstBucket + 1 ) ) );
+            if( m_NumberOfBucketNodes > 0 )
+              {
+              for( SizeValueType b = m_FirstBucket; b <= m_LastBucket; ++b )
+                {
+                buckets[b % buckets.size()].swap( m_Buckets[b % numberOfBuckets] );
+                }
+              }
+            m_Buckets.swap( buckets );
+            }
+          m_FirstBucket = firstBucket;
+          m_LastBucket = lastBucket;
+          m_Buckets[bucket % m_Buckets.size()].push_back( iNodePair );
+          ++m_NumberOfBucketNodes;
+          break;
+          }
+        }
+      m_Heap.push( iNodePair );
+      break;
+      }
+    default:
+      m_Heap.push( iNodePair );
+    }
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+bool
+FastMarchingBase< TInput, TOutput >::
+PopTrialNode( NodePairType& oNodePair )
+  {
+  switch( m_TrialQueue )
+    {
+    case IndexedBinaryHeap:
+      {
+      if( m_IndexedHeap.empty() )
+        {
+        return false;
+        }
+      oNodePair = m_IndexedHeap.front();
+      m_IndexedHeapPositions[this->GetNodeIdentifier( oNodePair.GetNode() )] =
+        NumericTraits< IdentifierType >::max();
+      if( m_IndexedHeap.size() > 1 )
+        {
+        m_IndexedHeap.front() = m_IndexedHeap.back();
+        m_IndexedHeapPositions[this->GetNodeIdentifier( m_IndexedHeap.front().GetNode() )] = 0;
+        m_IndexedHeap.pop_back();
+        this->SiftDownIndexedHeap( 0 );
+        }
+      else
+        {
+        m_IndexedHeap.pop_back();
+        }
+      return true;
+      }
+    case BucketQueue:
+      {
+      if( m_NumberOfBucketNodes == 0 )
+        {
+        if( m_Heap.empty() )
+          {
+          return false;
+          }
+        oNodePair = m_Heap.top();
+        m_Heap.pop();
+        return true;
+        }
+      // the nodes of a bucket are processed in any order
+      BucketType *bucket = &m_Buckets[m_FirstBucket % m_Buckets.size()];
+      while( bucket->empty() )
+        {
+        ++m_FirstBucket;
+        bucket = &m_Buckets[m_FirstBucket % m_Buckets.size()];
+        }
+      // the nodes of the binary heap come first when they are below the
+      // first bucket
+      if( !m_Heap.empty()
+          && static_cast< double >( m_Heap.top().GetValue() ) < m_FirstBucket * m_CurrentBucketWidth )
+        {
+        oNodePair = m_Heap.top();
+        m_Heap.pop();
+        return true;
+        }
+      oNodePair = bucket->back();
+      bucket->pop_back();
+      --m_NumberOfBucketNodes;
+      return true;
+      }
+    default:
+      if( m_Heap.empty() )
+        {
+        return false;
+        }
+      oNodePair = m_Heap.top();
+      m_Heap.pop();
+      return true;
+    }
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+void
+FastMarchingBase< TInput, TOutput >::
+ClearTrialNodes()
+  {
+  m_Heap = PriorityQueueType();
+
+  std::vector< NodePairType >().swap( m_IndexedHeap );
+  std::vector< IdentifierType >().swap( m_IndexedHeapPositions );
+
+  std::vector< BucketType >().swap( m_Buckets );
+  m_FirstBucket = 0;
+  m_LastBucket = 0;
+  m_NumberOfBucketNodes = 0;
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+void
+FastMarchingBase< TInput, TOutput >::
+SiftUpIndexedHeap( IdentifierType iPosition )
+  {
+  const NodePairType nodePair = m_IndexedHeap[iPosition];
+  while( iPosition > 0 )
+    {
+    const IdentifierType parent = ( iPosition - 1 ) / 2;
+    if( !( nodePair < m_IndexedHeap[parent] ) )
+      {
+      break;
+      }
+    m_IndexedHeap[iPosition] = m_IndexedHeap[parent];
+    m_IndexedHeapPositions[this->GetNodeIdentifier( m_IndexedHeap[iPosition].GetNode() )] = iPosition;
+    iPosition = parent;
+    }
+  m_IndexedHeap[iPosition] = nodePair;
+  m_IndexedHeapPositions[this->GetNodeIdentifier( nodePair.GetNode() )] = iPosition;
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+void
+FastMarchingBase< TInput, TOutput >::
+SiftDownIndexedHeap( IdentifierType iPosition )
+  {
+  const NodePairType nodePair = m_IndexedHeap[iPosition];
+  const IdentifierType size = m_IndexedHeap.size();
+  while( 2 * iPosition + 1 < size )
+    {
+    IdentifierType child = 2 * iPosition + 1;
+    if( child + 1 < size && m_IndexedHeap[child + 1] < m_IndexedHeap[child] )
+      {
+      ++child;
+      }
+    if( !( m_IndexedHeap[child] < nodePair ) )
+      {
+      break;
+      }
+    m_IndexedHeap[iPosition] = m_IndexedHeap[child];
+    m_IndexedHeapPositions[this->GetNodeIdentifier( m_IndexedHeap[iPosition].GetNode() )] = iPosition;
+    iPosition = child;
+    }
+  m_IndexedHeap[iPosition] = nodePair;
+  m_IndexedHeapPositions[this->GetNodeIdentifier( nodePair.GetNode() )] = iPosition;
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+IdentifierType
+FastMarchingBase< TInput, TOutput >::
+GetNodeIdentifier( const NodeType& ) const
+  {
+  itkExceptionMacro( <<"The IndexedBinaryHeap is not supported by this filter" );
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+double
+FastMarchingBase< TInput, TOutput >::
+GetDefaultBucketWidth( OutputDomainType* )
+  {
+  itkExceptionMacro( <<"BucketWidth must be set to use the BucketQueue" );
+  }
+// -----------------------------------------------------------------------------
+
 } // end of namespace itk
 
 #endif
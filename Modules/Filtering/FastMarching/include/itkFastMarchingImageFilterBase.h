@@ -179,6 +179,14 @@ protected:
 
   IdentifierType GetTotalNumberOfNodes() const ITK_OVERRIDE;
 
+  /** Returns the offset of the node in the output buffer */
+  IdentifierType GetNodeIdentifier( const NodeType& iNode ) const ITK_OVERRIDE;
+
+  /** Returns the smallest difference of arrival time between a node and its
+   * upwind neighbors: the smallest spacing divided by the largest speed
+   * and by the square root of the dimension. */
+  double GetDefaultBucketWidth( OutputImageType* oImage ) ITK_OVERRIDE;
+
   void SetOutputValue( OutputImageType* oDomain,
                        const NodeType& iNode,
                        const OutputPixelType& iValue ) ITK_OVERRIDE;
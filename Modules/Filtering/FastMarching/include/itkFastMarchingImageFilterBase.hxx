@@ -136,6 +136,51 @@ GetTotalNumberOfNodes() const
   }
 // -----------------------------------------------------------------------------
 
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+IdentifierType
+FastMarchingImageFilterBase< TInput, TOutput >::
+GetNodeIdentifier( const NodeType& iNode ) const
+  {
+  return static_cast< IdentifierType >( m_LabelImage->ComputeOffset( iNode ) );
+  }
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+template< typename TInput, typename TOutput >
+double
+FastMarchingImageFilterBase< TInput, TOutput >::
+GetDefaultBucketWidth( OutputImageType* oImage )
+  {
+  const OutputSpacingType & spacing = oImage->GetSpacing();
+  double minSpacing = spacing[0];
+  for( unsigned int j = 1; j < ImageDimension; j++ )
+    {
+    minSpacing = vnl_math_min( minSpacing, static_cast< double >( spacing[j] ) );
+    }
+
+  // the speed is one without speed image, see Solve()
+  double maxSpeed = 1.0;
+  const InputImageType* input = this->GetInput();
+  if( input )
+    {
+    maxSpeed = 0.0;
+    ImageRegionConstIterator< InputImageType > it( input, input->GetBufferedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      maxSpeed = vnl_math_max( maxSpeed, static_cast< double >( it.Get() ) );
+      }
+    maxSpeed /= this->m_NormalizationFactor;
+    if( maxSpeed <= 0.0 )
+      {
+      itkExceptionMacro( <<"The speed is null everywhere" );
+      }
+    }
+
+  return minSpacing / ( maxSpeed * std::sqrt( static_cast< double >( ImageDimension ) ) );
+  }
+// -----------------------------------------------------------------------------
+
 // -----------------------------------------------------------------------------
 template< typename TInput, typename TOutput >
 void
@@ -244,7 +289,7 @@ UpdateValue( OutputImageType* oImage, const NodeType& iNode )
     this->SetLabelValueForGivenNode( iNode, Traits::Trial );
 
     // insert point into trial heap
-    this->m_Heap.push( NodePairType( iNode, outputPixel ) );
+    this->PushTrialNode( NodePairType( iNode, outputPixel ) );
     }
   }
 // -----------------------------------------------------------------------------
@@ -635,7 +680,7 @@ InitializeOutput( OutputImageType* oImage )
         this->SetOutputValue( oImage, idx, outputPixel );
 
         //this->m_Heap->Push( PriorityQueueElementType( idx, pointsIter->second ) );
-        this->m_Heap.push( pointsIter->Value() );
+        this->PushTrialNode( pointsIter->Value() );
         }
       ++pointsIter;
       }
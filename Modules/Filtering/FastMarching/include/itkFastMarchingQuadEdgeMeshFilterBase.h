@@ -113,6 +113,9 @@ protected:
 
   IdentifierType GetTotalNumberOfNodes() const ITK_OVERRIDE;
 
+  /** Returns the point identifier of the node */
+  IdentifierType GetNodeIdentifier( const NodeType& iNode ) const ITK_OVERRIDE;
+
   void SetOutputValue( OutputMeshType* oMesh,
                       const NodeType& iNode,
                       const OutputPixelType& iValue ) ITK_OVERRIDE;
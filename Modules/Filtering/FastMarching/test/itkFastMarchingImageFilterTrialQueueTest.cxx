@@ -0,0 +1,258 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFastMarchingImageFilterBase.h"
+#include "itkFastMarchingThresholdStoppingCriterion.h"
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkLabelContourImageFilter.h"
+#include "itkThresholdImageFilter.h"
+#include <cmath>
+
+// Runs the fast marching with the given trial queue, and checks its arrival
+// times against the ones of the default BinaryHeap. The arrival times of the
+// IndexedBinaryHeap must be the same, and the ones of the BucketQueue must
+// be close to them.
+template <unsigned int VDimension>
+int FastMarchingImageFilterTrialQueue( unsigned int argc, char *argv[] )
+{
+  typedef float                                        InternalPixelType;
+  typedef itk::Image< InternalPixelType, VDimension >  InternalImageType;
+  typedef unsigned char                                OutputPixelType;
+  typedef itk::Image< OutputPixelType, VDimension >    OutputImageType;
+
+  typedef itk::FastMarchingImageFilterBase< InternalImageType, InternalImageType > FastMarchingType;
+  typedef itk::FastMarchingThresholdStoppingCriterion< InternalImageType, InternalImageType >
+      CriterionType;
+
+  const InternalPixelType stoppingValue = atof( argv[5] );
+
+  typename FastMarchingType::TrialQueueType trialQueue;
+  const std::string trialQueueName( argv[6] );
+  if( trialQueueName == "IndexedBinaryHeap" )
+    {
+    trialQueue = FastMarchingType::IndexedBinaryHeap;
+    }
+  else if( trialQueueName == "BucketQueue" )
+    {
+    trialQueue = FastMarchingType::BucketQueue;
+    }
+  else
+    {
+    std::cerr << "Invalid trial queue '" << trialQueueName << "'." << std::endl;
+    std::cerr << "Valid values are IndexedBinaryHeap or BucketQueue." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileReader< InternalImageType > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[2] );
+
+  // the BucketQueue is meant for speeds bounded away from zero
+  typedef itk::ThresholdImageFilter< InternalImageType > SpeedThresholdType;
+  typename SpeedThresholdType::Pointer speedThreshold = SpeedThresholdType::New();
+  typename InternalImageType::Pointer speedImage = reader->GetOutput();
+  if( argc > 7 )
+    {
+    speedThreshold->SetInput( reader->GetOutput() );
+    speedThreshold->ThresholdBelow( atof( argv[7] ) );
+    speedThreshold->SetOutsideValue( atof( argv[7] ) );
+    speedImage = speedThreshold->GetOutput();
+    }
+
+  typedef typename FastMarchingType::LabelImageType LabelImageType;
+  typedef typename LabelImageType::PixelType        LabelType;
+
+  typedef itk::ImageFileReader< LabelImageType > LabelImageReaderType;
+  typename LabelImageReaderType::Pointer labelImageReader = LabelImageReaderType::New();
+  labelImageReader->SetFileName( argv[4] );
+
+  const LabelType labelZero = itk::NumericTraits< LabelType >::ZeroValue();
+
+  typedef itk::LabelContourImageFilter< LabelImageType, LabelImageType > ContourFilterType;
+  typename ContourFilterType::Pointer contour = ContourFilterType::New();
+  contour->SetInput( labelImageReader->GetOutput() );
+  contour->FullyConnectedOff();
+  contour->SetBackgroundValue( labelZero );
+
+  try
+    {
+    speedImage->Update();
+    contour->Update();
+    }
+  catch( itk::ExceptionObject & excep )
+    {
+    std::cerr << "Exception caught !" << std::endl;
+    std::cerr << excep << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef typename FastMarchingType::NodePairType           NodePairType;
+  typedef typename FastMarchingType::NodePairContainerType  NodePairContainerType;
+
+  typename NodePairContainerType::Pointer alivePoints = NodePairContainerType::New();
+  typename NodePairContainerType::Pointer trialPoints = NodePairContainerType::New();
+
+  itk::ImageRegionConstIteratorWithIndex< LabelImageType > itL( labelImageReader->GetOutput(),
+    labelImageReader->GetOutput()->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIteratorWithIndex< LabelImageType > itC( contour->GetOutput(),
+    contour->GetOutput()->GetLargestPossibleRegion() );
+  for( ; !itL.IsAtEnd(); ++itL, ++itC )
+    {
+    if( itC.Get() != labelZero )
+      {
+      trialPoints->push_back( NodePairType( itC.GetIndex(), 0. ) );
+      }
+    else if( itL.Get() != labelZero )
+      {
+      alivePoints->push_back( NodePairType( itL.GetIndex(), 0. ) );
+      }
+    }
+
+  const typename FastMarchingType::TrialQueueType trialQueues[2] = { FastMarchingType::BinaryHeap, trialQueue };
+  typename InternalImageType::Pointer arrivalTimes[2];
+  for( unsigned int q = 0; q < 2; ++q )
+    {
+    typename CriterionType::Pointer criterion = CriterionType::New();
+    criterion->SetThreshold( stoppingValue );
+
+    typename FastMarchingType::Pointer fastMarching = FastMarchingType::New();
+    fastMarching->SetInput( speedImage );
+    fastMarching->SetStoppingCriterion( criterion );
+    fastMarching->SetTrialPoints( trialPoints );
+    fastMarching->SetAlivePoints( alivePoints );
+    fastMarching->SetTopologyCheck( FastMarchingType::Nothing );
+    fastMarching->SetTrialQueue( trialQueues[q] );
+
+    try
+      {
+      fastMarching->Update();
+      }
+    catch( itk::ExceptionObject & excep )
+      {
+      std::cerr << "Exception caught !" << std::endl;
+      std::cerr << excep << std::endl;
+      return EXIT_FAILURE;
+      }
+    arrivalTimes[q] = fastMarching->GetOutput();
+    arrivalTimes[q]->DisconnectPipeline();
+    }
+
+  // an untidy bucket queue changes the arrival times by about the width of
+  // the buckets, the smallest spacing divided by the largest speed and by
+  // the square root of the dimension
+  double tolerance = 1e-4;
+  double bucketWidth = 0.0;
+  if( trialQueue == FastMarchingType::BucketQueue )
+    {
+    const typename InternalImageType::SpacingType & spacing = arrivalTimes[0]->GetSpacing();
+    double minSpacing = spacing[0];
+    for( unsigned int d = 1; d < VDimension; ++d )
+      {
+      minSpacing = std::min( minSpacing, static_cast< double >( spacing[d] ) );
+      }
+    double maxSpeed = 0.0;
+    itk::ImageRegionConstIterator< InternalImageType > sit( speedImage, speedImage->GetBufferedRegion() );
+    for( ; !sit.IsAtEnd(); ++sit )
+      {
+      maxSpeed = std::max( maxSpeed, static_cast< double >( sit.Get() ) );
+      }
+    bucketWidth = minSpacing / ( maxSpeed * std::sqrt( static_cast< double >( VDimension ) ) );
+    tolerance = 2.0 * bucketWidth;
+    }
+
+  // the nodes of the last bucket may be left out when the front stops, so
+  // the arrival times are compared below the stopping value only
+  double maxDifference = 0.0;
+  itk::ImageRegionConstIteratorWithIndex< InternalImageType > rit( arrivalTimes[0],
+    arrivalTimes[0]->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< InternalImageType > it( arrivalTimes[1], arrivalTimes[0]->GetBufferedRegion() );
+  for( ; !rit.IsAtEnd(); ++rit, ++it )
+    {
+    if( rit.Get() > stoppingValue - tolerance - bucketWidth )
+      {
+      continue;
+      }
+    const double difference = std::abs( static_cast< double >( it.Get() ) - rit.Get() );
+    if( difference > maxDifference )
+      {
+      maxDifference = difference;
+      if( !( difference <= tolerance ) )
+        {
+        std::cerr << "The arrival time at " << rit.GetIndex() << " is " << it.Get() << " with the "
+                  << trialQueueName << " instead of " << rit.Get() << " with the BinaryHeap" << std::endl;
+        }
+      }
+    }
+  std::cout << "Largest difference with the BinaryHeap: " << maxDifference << std::endl;
+
+  typedef itk::BinaryThresholdImageFilter< InternalImageType, OutputImageType > ThresholdingFilterType;
+  typename ThresholdingFilterType::Pointer thresholder = ThresholdingFilterType::New();
+  thresholder->SetLowerThreshold( 0.0 );
+  thresholder->SetUpperThreshold( stoppingValue );
+  thresholder->SetOutsideValue( 0 );
+  thresholder->SetInsideValue( 1 );
+  thresholder->SetInput( arrivalTimes[1] );
+
+  typedef itk::ImageFileWriter< OutputImageType > WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( thresholder->GetOutput() );
+  writer->SetFileName( argv[3] );
+
+  try
+    {
+    writer->Update();
+    }
+  catch( itk::ExceptionObject & excep )
+    {
+    std::cerr << "Exception caught !" << std::endl;
+    std::cerr << excep << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if( !( maxDifference <= tolerance ) )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+int itkFastMarchingImageFilterTrialQueueTest( int argc, char *argv[] )
+{
+  if( argc < 7 )
+    {
+    std::cerr << "Usage: " << argv[0] << " imageDimension";
+    std::cerr << " speedImage outputImage seedImage ";
+    std::cerr << " stoppingValue trialQueue [minimumSpeed]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  switch( atoi( argv[1] ) )
+   {
+   case 2:
+     return FastMarchingImageFilterTrialQueue<2>( argc, argv );
+   case 3:
+     return FastMarchingImageFilterTrialQueue<3>( argc, argv );
+   default:
+     std::cerr << "Unsupported dimension" << std::endl;
+     return EXIT_FAILURE;
+   }
+}
@@ -0,0 +1,194 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFastMarchingImageFilterBase.h"
+#include "itkFastMarchingThresholdStoppingCriterion.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+#include <cmath>
+
+namespace
+{
+
+/** Speed bounded between 0.5 and 2, varying smoothly. */
+template< typename TImage >
+typename TImage::Pointer CreateSpeedImage( const typename TImage::SizeType & size )
+{
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions( size );
+  image->Allocate();
+  typename TImage::SpacingType spacing;
+  for( unsigned int d = 0; d < TImage::ImageDimension; ++d )
+    {
+    spacing[d] = 1.0 + 0.25 * d;
+    }
+  image->SetSpacing( spacing );
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double phase = 0.0;
+    for( unsigned int d = 0; d < TImage::ImageDimension; ++d )
+      {
+      phase += 0.13 * ( d + 1 ) * it.GetIndex()[d];
+      }
+    it.Set( static_cast< typename TImage::PixelType >( 1.25 + 0.75 * std::sin( phase ) ) );
+    }
+  return image;
+}
+
+/** Cuts the speed image by walls of null speed along the first dimension,
+ * with holes of almost null speeds, so that the arrival times behind the
+ * walls are far beyond the ones in front of them. */
+template< typename TImage >
+void AddWalls( TImage *image )
+{
+  const typename TImage::SizeType & size = image->GetLargestPossibleRegion().GetSize();
+  const double holeSpeeds[2] = { 1.0e-3, 1.0e-6 };
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const typename TImage::IndexType & index = it.GetIndex();
+    for( unsigned int w = 0; w < 2; ++w )
+      {
+      if( static_cast< itk::SizeValueType >( index[0] ) == ( w + 1 ) * size[0] / 3 )
+        {
+        const bool hole = static_cast< itk::SizeValueType >( index[1] ) * 8 / size[1] == 3 + w;
+        it.Set( static_cast< typename TImage::PixelType >( hole ? holeSpeeds[w] : 0.0 ) );
+        }
+      }
+    }
+}
+
+/** Runs the fast marching from a few trial points with the binary heap,
+ * the indexed binary heap and the bucket queue, and reports their times.
+ * With walls, the trial points are in front of them.
+ * The arrival times of the indexed binary heap must be the ones of the
+ * binary heap, and the ones of the bucket queue must be close to them. */
+template< typename TImage >
+bool CheckTrialQueues( const char *name, TImage *speedImage, bool walls )
+{
+  typedef itk::FastMarchingImageFilterBase< TImage, TImage >               FilterType;
+  typedef itk::FastMarchingThresholdStoppingCriterion< TImage, TImage >    CriterionType;
+  typedef typename FilterType::NodePairType                                NodePairType;
+  typedef typename FilterType::NodePairContainerType                       NodePairContainerType;
+
+  typename NodePairContainerType::Pointer trial = NodePairContainerType::New();
+  const typename TImage::SizeType & size = speedImage->GetLargestPossibleRegion().GetSize();
+  for( unsigned int i = 0; i < 3; ++i )
+    {
+    typename TImage::IndexType index;
+    for( unsigned int d = 0; d < TImage::ImageDimension; ++d )
+      {
+      index[d] = ( ( i + 1 ) * ( d + 2 ) * size[d] ) / 7 % size[d];
+      }
+    if( walls )
+      {
+      index[0] = index[0] % ( size[0] / 3 );
+      }
+    trial->push_back( NodePairType( index, 0.0 ) );
+    }
+
+  const typename FilterType::TrialQueueType queues[3] =
+    { FilterType::BinaryHeap, FilterType::IndexedBinaryHeap, FilterType::BucketQueue };
+  const char * queueNames[3] = { "BinaryHeap", "IndexedBinaryHeap", "BucketQueue" };
+
+  typename TImage::Pointer outputs[3];
+  for( unsigned int q = 0; q < 3; ++q )
+    {
+    typename CriterionType::Pointer criterion = CriterionType::New();
+    criterion->SetThreshold( 1e38 );
+    typename FilterType::Pointer marcher = FilterType::New();
+    marcher->SetInput( speedImage );
+    marcher->SetTrialPoints( trial );
+    marcher->SetStoppingCriterion( criterion );
+    marcher->SetTrialQueue( queues[q] );
+    itk::TimeProbe probe;
+    probe.Start();
+    marcher->Update();
+    probe.Stop();
+    std::cout << name << " " << queueNames[q] << ": " << probe.GetTotal() << " " << probe.GetUnit() << std::endl;
+    outputs[q] = marcher->GetOutput();
+    outputs[q]->DisconnectPipeline();
+    }
+
+  bool passed = true;
+  for( unsigned int q = 1; q < 3; ++q )
+    {
+    // an untidy bucket queue changes the arrival times by about the width
+    // of the buckets, the smallest spacing divided by the largest speed and
+    // by the square root of the dimension
+    const double bucketWidth = 1.0 / ( 2.0 * std::sqrt( static_cast< double >( TImage::ImageDimension ) ) );
+    const double tolerance = ( queues[q] == FilterType::BucketQueue ) ? 2.0 * bucketWidth : 1e-4;
+    itk::ImageRegionConstIteratorWithIndex< TImage > rit( outputs[0], outputs[0]->GetBufferedRegion() );
+    itk::ImageRegionConstIteratorWithIndex< TImage > it( outputs[q], outputs[0]->GetBufferedRegion() );
+    for( ; !rit.IsAtEnd(); ++rit, ++it )
+      {
+      // the arrival times behind the walls are only accurate to the
+      // precision of float
+      const double reference = rit.Get();
+      const double difference = std::abs( static_cast< double >( it.Get() ) - reference );
+      if( !( difference <= tolerance + 1.0e-6 * std::abs( reference ) ) )
+        {
+        std::cerr << name << ": the arrival time of the " << queueNames[q] << " at " << rit.GetIndex()
+                  << " is " << it.Get() << " instead of " << reference << " with the BinaryHeap" << std::endl;
+        passed = false;
+        break;
+        }
+      }
+    }
+  return passed;
+}
+
+}
+
+/** Compares the times of the trial queues of the fast marching, and
+ * checks their arrival times, with a smooth speed and with walls of null
+ * and almost null speeds. */
+int itkFastMarchingTrialQueueBenchmark( int, char* [] )
+{
+  typedef itk::Image< float, 2 > Image2DType;
+  typedef itk::Image< float, 3 > Image3DType;
+
+  bool passed = true;
+
+  Image2DType::SizeType size2D;
+  size2D[0] = 300;
+  size2D[1] = 250;
+  Image2DType::Pointer speed2D = CreateSpeedImage< Image2DType >( size2D );
+  passed &= CheckTrialQueues( "2D", speed2D.GetPointer(), false );
+  AddWalls( speed2D.GetPointer() );
+  passed &= CheckTrialQueues( "2D walls", speed2D.GetPointer(), true );
+
+  Image3DType::SizeType size3D;
+  size3D[0] = 60;
+  size3D[1] = 55;
+  size3D[2] = 50;
+  Image3DType::Pointer speed3D = CreateSpeedImage< Image3DType >( size3D );
+  passed &= CheckTrialQueues( "3D", speed3D.GetPointer(), false );
+  AddWalls( speed3D.GetPointer() );
+  passed &= CheckTrialQueues( "3D walls", speed3D.GetPointer(), true );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -20,6 +20,8 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "itkSimpleDataObjectDecorator.h"
+#include "itkPixelwiseFusionStage.h"
+#include <vector>
 
 namespace itk
 {
@@ -36,7 +38,15 @@ namespace itk
  * the pipeline. The SetConstant() and GetConstant() methods are provided as shortcuts
  * to set or get the constant value without manipulating the decorator.
  *
+ * When the images are itk::Image of arithmetic pixel types, the functor
+ * is applied to whole scanlines by a vectorized loop.
+ *
+ * The inputs which are outputs of other pixel-wise filters, and have
+ * their PixelwiseFusion flag on, are fused as described in
+ * UnaryFunctorImageFilter.
+ *
  * \sa UnaryFunctorImageFilter TernaryFunctorImageFilter
+ * \sa ScanlineFunctorKernels PixelwiseFusionStage
  *
  * \ingroup IntensityImageFilters   MultiThreaded
  * \ingroup ITKImageFilterBase
@@ -49,7 +59,8 @@ namespace itk
 template< typename TInputImage1, typename TInputImage2,
           typename TOutputImage, typename TFunction    >
 class BinaryFunctorImageFilter:
-  public InPlaceImageFilter< TInputImage1, TOutputImage >
+  public InPlaceImageFilter< TInputImage1, TOutputImage >,
+  public PixelwiseFusionStage< TOutputImage::ImageDimension >
 {
 public:
   /** Standard class typedefs. */
@@ -168,10 +179,47 @@ public:
   // End concept checking
 #endif
 
+  /** Set/Get whether the filter may be fused into the pixel-wise filter
+   * which consumes its output. The fused filter does not execute: it
+   * invokes no StartEvent, ProgressEvent or EndEvent, and its output is
+   * left released, so that it executes normally if its output is then
+   * requested by another filter. Off by default.
+   * \sa PixelwiseFusionStage */
+  itkSetMacro(PixelwiseFusion, bool);
+  itkGetConstMacro(PixelwiseFusion, bool);
+  itkBooleanMacro(PixelwiseFusion);
+
+  /** The filter does not run in place while it fuses its first input. */
+  virtual bool CanRunInPlace() const ITK_OVERRIDE;
+
 protected:
   BinaryFunctorImageFilter();
   virtual ~BinaryFunctorImageFilter() {}
 
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  typedef PixelwiseFusionStage< TOutputImage::ImageDimension > FusionStageType;
+
+  /** Whether each output pixel only depends on the input pixels at the
+   * same index, through the functor, so that the filter can be fused.
+   * True for BinaryFunctorImageFilter itself. Subclasses which override
+   * ThreadedGenerateData() must not return true. */
+  virtual bool IsPixelwise() const;
+
+  /** Fuse the inputs when possible, and update them otherwise. */
+  virtual void UpdateInputs() ITK_OVERRIDE;
+
+  /** Prepare the fused inputs around the execution. */
+  virtual void GenerateData() ITK_OVERRIDE;
+
+  /** PixelwiseFusionStage interface. */
+  virtual bool CanBeFused() const ITK_OVERRIDE;
+  virtual void UpdateFusedInputs() ITK_OVERRIDE;
+  virtual void PrepareFusedExecution(ThreadIdType numberOfThreads, SizeValueType maximumLength) ITK_OVERRIDE;
+  virtual void GenerateFusedScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                                     void *scanline, ThreadIdType threadId) ITK_OVERRIDE;
+  virtual void FinishFusedExecution() ITK_OVERRIDE;
+
   /** BinaryFunctorImageFilter can be implemented as a multithreaded filter.
    * Therefore, this implementation provides a ThreadedGenerateData() routine
    * which is called for each processing thread. The output image data is
@@ -193,7 +241,20 @@ private:
   BinaryFunctorImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);           //purposely not implemented
 
+  void PrepareFusedInputs(ThreadIdType numberOfThreads, SizeValueType maximumLength);
+
+  void FinishFusedInputs();
+
+  void GenerateScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                        OutputImagePixelType *scanline, ThreadIdType threadId);
+
   FunctorType m_Functor;
+
+  bool                                               m_PixelwiseFusion;
+  FusionStageType *                                  m_FusedInput1;
+  FusionStageType *                                  m_FusedInput2;
+  std::vector< std::vector< Input1ImagePixelType > > m_FusedInput1Scanlines;
+  std::vector< std::vector< Input2ImagePixelType > > m_FusedInput2Scanlines;
 };
 } // end namespace itk
 
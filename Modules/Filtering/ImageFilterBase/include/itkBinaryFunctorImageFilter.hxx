@@ -20,8 +20,9 @@
 
 #include "itkBinaryFunctorImageFilter.h"
 #include "itkImageScanlineIterator.h"
+#include "itkScanlineFunctorKernels.h"
 #include "itkProgressReporter.h"
-
+#include <typeinfo>
 
 namespace itk
 {
@@ -31,7 +32,10 @@ namespace itk
 template< typename TInputImage1, typename TInputImage2,
           typename TOutputImage, typename TFunction  >
 BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
-::BinaryFunctorImageFilter()
+::BinaryFunctorImageFilter() :
+  m_PixelwiseFusion(false),
+  m_FusedInput1(ITK_NULLPTR),
+  m_FusedInput2(ITK_NULLPTR)
 {
   this->SetNumberOfRequiredInputs(2);
   this->InPlaceOff();
@@ -221,16 +225,39 @@ BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
     }
   const size_t numberOfLinesToProcess = outputRegionForThread.GetNumberOfPixels() / size0;
 
+  // The scanlines of the fused inputs are computed by the upstream filters
+  if( m_FusedInput1 || m_FusedInput2 )
+    {
+    ProgressReporter progress( this, threadId, numberOfLinesToProcess );
+    ImageScanlineConstIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
+    while ( !outputIt.IsAtEnd() )
+      {
+      this->GenerateScanline( outputIt.GetIndex(), size0,
+                              ScanlineImageTraits< TOutputImage >::GetScanline( outputPtr, outputIt.GetIndex() ),
+                              threadId );
+      outputIt.NextLine();
+      progress.CompletedPixel(); // potential exception thrown here
+      }
+    return;
+    }
+
   if( inputPtr1 && inputPtr2 )
     {
+    ProgressReporter progress( this, threadId, numberOfLinesToProcess );
+
+    // Contiguous scanlines of arithmetic pixels are processed by a
+    // vectorized loop
+    if ( ScanlineFunctorKernels::Binary( m_Functor, inputPtr1, inputPtr2,
+                                         outputPtr, outputRegionForThread, progress ) )
+      {
+      return;
+      }
+
     ImageScanlineConstIterator< TInputImage1 > inputIt1(inputPtr1, outputRegionForThread);
     ImageScanlineConstIterator< TInputImage2 > inputIt2(inputPtr2, outputRegionForThread);
     ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
 
 
-    ProgressReporter progress( this, threadId, numberOfLinesToProcess );
-
-
     while ( !inputIt1.IsAtEnd() )
       {
       while ( !inputIt1.IsAtEndOfLine() )
@@ -249,12 +276,18 @@ BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
     }
   else if( inputPtr1 )
     {
-    ImageScanlineConstIterator< TInputImage1 > inputIt1(inputPtr1, outputRegionForThread);
-    ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
-
     const Input2ImagePixelType & input2Value = this->GetConstant2();
     ProgressReporter progress( this, threadId, numberOfLinesToProcess );
 
+    if ( ScanlineFunctorKernels::BinaryWithConstant2( m_Functor, inputPtr1, input2Value,
+                                                      outputPtr, outputRegionForThread, progress ) )
+      {
+      return;
+      }
+
+    ImageScanlineConstIterator< TInputImage1 > inputIt1(inputPtr1, outputRegionForThread);
+    ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
+
     while ( !inputIt1.IsAtEnd() )
       {
       while ( !inputIt1.IsAtEndOfLine() )
@@ -270,12 +303,17 @@ BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
     }
   else if( inputPtr2 )
     {
-    ImageScanlineConstIterator< TInputImage2 > inputIt2(inputPtr2, outputRegionForThread);
-    ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
-
     const Input1ImagePixelType & input1Value = this->GetConstant1();
     ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
 
+    if ( ScanlineFunctorKernels::BinaryWithConstant1( m_Functor, input1Value, inputPtr2,
+                                                      outputPtr, outputRegionForThread, progress ) )
+      {
+      return;
+      }
+
+    ImageScanlineConstIterator< TInputImage2 > inputIt2(inputPtr2, outputRegionForThread);
+    ImageScanlineIterator< TOutputImage > outputIt(outputPtr, outputRegionForThread);
 
     while ( !inputIt2.IsAtEnd() )
       {
@@ -295,6 +333,253 @@ BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
     itkGenericExceptionMacro(<<"At most one of the inputs can be a constant.");
     }
 }
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+bool
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::CanRunInPlace() const
+{
+  return Superclass::CanRunInPlace() && m_FusedInput1 == ITK_NULLPTR;
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+bool
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::IsPixelwise() const
+{
+  return typeid( *this ) == typeid( Self );
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+bool
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::CanBeFused() const
+{
+  return ScanlineImageTraits< TInputImage1 >::IsContiguousArithmetic
+         && ScanlineImageTraits< TInputImage2 >::IsContiguousArithmetic
+         && ScanlineImageTraits< TOutputImage >::IsContiguousArithmetic
+         && this->IsPixelwise();
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::UpdateInputs()
+{
+  m_FusedInput1 = ITK_NULLPTR;
+  m_FusedInput2 = ITK_NULLPTR;
+  if ( this->CanBeFused() )
+    {
+    m_FusedInput1 = FusionStageType::GetFusableSource( this->ProcessObject::GetInput(0) );
+    m_FusedInput2 = FusionStageType::GetFusableSource( this->ProcessObject::GetInput(1) );
+    }
+  if ( !m_FusedInput1 && !m_FusedInput2 )
+    {
+    Superclass::UpdateInputs();
+    return;
+    }
+
+  try
+    {
+    const typename Superclass::NameArray names = this->GetInputNames();
+    for ( typename Superclass::NameArray::const_iterator it = names.begin(); it != names.end(); ++it )
+      {
+      DataObject *input = this->ProcessObject::GetInput(*it);
+      if ( input == ITK_NULLPTR
+           || ( m_FusedInput1 && input == this->ProcessObject::GetInput(0) )
+           || ( m_FusedInput2 && input == this->ProcessObject::GetInput(1) ) )
+        {
+        continue;
+        }
+      input->PropagateRequestedRegion();
+      input->UpdateOutputData();
+      }
+    if ( m_FusedInput1 )
+      {
+      m_FusedInput1->UpdateFusedInputs();
+      }
+    if ( m_FusedInput2 && m_FusedInput2 != m_FusedInput1 )
+      {
+      m_FusedInput2->UpdateFusedInputs();
+      }
+    }
+  catch ( ... )
+    {
+    this->FinishFusedInputs();
+    throw;
+    }
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::GenerateData()
+{
+  if ( !m_FusedInput1 && !m_FusedInput2 )
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  // the fused inputs are released even if the execution fails
+  try
+    {
+    this->PrepareFusedInputs( this->GetNumberOfThreads(), this->GetOutput()->GetRequestedRegion().GetSize(0) );
+    Superclass::GenerateData();
+    }
+  catch ( ... )
+    {
+    this->FinishFusedInputs();
+    throw;
+    }
+  this->FinishFusedInputs();
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::UpdateFusedInputs()
+{
+  this->UpdateInputs();
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::PrepareFusedExecution(ThreadIdType numberOfThreads, SizeValueType maximumLength)
+{
+  this->PrepareFusedInputs(numberOfThreads, maximumLength);
+  // the functor may be set up from the parameters of the filter
+  this->BeforeThreadedGenerateData();
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::GenerateFusedScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                        void *scanline, ThreadIdType threadId)
+{
+  this->GenerateScanline( index, length, static_cast< OutputImagePixelType * >( scanline ), threadId );
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::FinishFusedExecution()
+{
+  this->FinishFusedInputs();
+  this->ProcessObject::ReleaseInputs();
+  // the output was not generated: mark it released, so that it is
+  // updated normally when another consumer requests it
+  this->GetOutput()->ReleaseData();
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::PrepareFusedInputs(ThreadIdType numberOfThreads, SizeValueType maximumLength)
+{
+  if ( m_FusedInput1 )
+    {
+    m_FusedInput1->PrepareFusedExecution(numberOfThreads, maximumLength);
+    m_FusedInput1Scanlines.assign( numberOfThreads, std::vector< Input1ImagePixelType >(maximumLength) );
+    }
+  if ( m_FusedInput2 )
+    {
+    // both inputs may be the output of the same filter
+    if ( m_FusedInput2 != m_FusedInput1 )
+      {
+      m_FusedInput2->PrepareFusedExecution(numberOfThreads, maximumLength);
+      }
+    m_FusedInput2Scanlines.assign( numberOfThreads, std::vector< Input2ImagePixelType >(maximumLength) );
+    }
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::FinishFusedInputs()
+{
+  if ( m_FusedInput1 )
+    {
+    m_FusedInput1->FinishFusedExecution();
+    }
+  if ( m_FusedInput2 && m_FusedInput2 != m_FusedInput1 )
+    {
+    m_FusedInput2->FinishFusedExecution();
+    }
+  m_FusedInput1 = ITK_NULLPTR;
+  m_FusedInput2 = ITK_NULLPTR;
+  std::vector< std::vector< Input1ImagePixelType > >().swap(m_FusedInput1Scanlines);
+  std::vector< std::vector< Input2ImagePixelType > >().swap(m_FusedInput2Scanlines);
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::GenerateScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                   OutputImagePixelType *scanline, ThreadIdType threadId)
+{
+  const TInputImage1 *inputPtr1 =
+    dynamic_cast< const TInputImage1 * >( ProcessObject::GetInput(0) );
+  const TInputImage2 *inputPtr2 =
+    dynamic_cast< const TInputImage2 * >( ProcessObject::GetInput(1) );
+
+  const Input1ImagePixelType *input1 = ITK_NULLPTR;
+  if ( m_FusedInput1 )
+    {
+    Input1ImagePixelType *inputScanline = &m_FusedInput1Scanlines[threadId][0];
+    m_FusedInput1->GenerateFusedScanline(index, length, inputScanline, threadId);
+    input1 = inputScanline;
+    }
+  else if ( inputPtr1 )
+    {
+    input1 = ScanlineImageTraits< TInputImage1 >::GetScanline(inputPtr1, index);
+    }
+
+  const Input2ImagePixelType *input2 = ITK_NULLPTR;
+  if ( m_FusedInput2 )
+    {
+    Input2ImagePixelType *inputScanline = &m_FusedInput2Scanlines[threadId][0];
+    m_FusedInput2->GenerateFusedScanline(index, length, inputScanline, threadId);
+    input2 = inputScanline;
+    }
+  else if ( inputPtr2 )
+    {
+    input2 = ScanlineImageTraits< TInputImage2 >::GetScanline(inputPtr2, index);
+    }
+
+  if ( input1 && input2 )
+    {
+    void ( *line )(FunctorType &, const Input1ImagePixelType *, const Input2ImagePixelType *,
+                   OutputImagePixelType *, SizeValueType);
+    ScanlineFunctorKernels::SelectBinaryLine(line);
+    line(m_Functor, input1, input2, scanline, length);
+    }
+  else if ( input1 )
+    {
+    void ( *line )(FunctorType &, const Input1ImagePixelType *, const Input2ImagePixelType &,
+                   OutputImagePixelType *, SizeValueType);
+    ScanlineFunctorKernels::SelectBinaryWithConstant2Line(line);
+    line(m_Functor, input1, this->GetConstant2(), scanline, length);
+    }
+  else
+    {
+    void ( *line )(FunctorType &, const Input1ImagePixelType &, const Input2ImagePixelType *,
+                   OutputImagePixelType *, SizeValueType);
+    ScanlineFunctorKernels::SelectBinaryWithConstant1Line(line);
+    line(m_Functor, this->GetConstant1(), input2, scanline, length);
+    }
+}
+
+template< typename TInputImage1, typename TInputImage2, typename TOutputImage, typename TFunction  >
+void
+BinaryFunctorImageFilter< TInputImage1, TInputImage2, TOutputImage, TFunction >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "PixelwiseFusion: " << ( m_PixelwiseFusion ? "On" : "Off" ) << std::endl;
+}
 } // end namespace itk
 
 #endif
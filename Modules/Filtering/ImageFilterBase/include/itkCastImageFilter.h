@@ -135,6 +135,12 @@ protected:
 
   void GenerateData() ITK_OVERRIDE;
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
   void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) ITK_OVERRIDE;
 
 private:
@@ -57,6 +57,14 @@ CastImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        ThreadIdType threadId)
 {
+  // the scanlines of a fused input are computed by the upstream filter,
+  // and converted by the functor
+  if ( this->HasFusedInput() )
+    {
+    Superclass::ThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+    }
+
   const TInputImage *inputPtr = this->GetInput();
   TOutputImage *outputPtr = this->GetOutput(0);
 
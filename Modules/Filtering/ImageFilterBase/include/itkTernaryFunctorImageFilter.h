@@ -30,7 +30,11 @@ namespace itk
  * and the type of the output image.  It is also parameterized by the
  * operation to be applied, using a Functor style.
  *
+ * When the images are itk::Image of arithmetic pixel types, the functor
+ * is applied to whole scanlines by a vectorized loop.
+ *
  * \sa BinaryFunctorImageFilter UnaryFunctorImageFilter
+ * \sa ScanlineFunctorKernels
  *
  * \ingroup IntensityImageFilters MultiThreaded
  * \ingroup ITKImageFilterBase
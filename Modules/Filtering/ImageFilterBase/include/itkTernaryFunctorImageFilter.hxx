@@ -20,6 +20,7 @@
 
 #include "itkTernaryFunctorImageFilter.h"
 #include "itkImageScanlineIterator.h"
+#include "itkScanlineFunctorKernels.h"
 #include "itkProgressReporter.h"
 
 namespace itk
@@ -125,15 +126,23 @@ TernaryFunctorImageFilter< TInputImage1, TInputImage2, TInputImage3, TOutputImag
     dynamic_cast< const TInputImage3 * >( ( ProcessObject::GetInput(2) ) );
   OutputImagePointer outputPtr = this->GetOutput(0);
 
+  const size_t numberOfLinesToProcess = outputRegionForThread.GetNumberOfPixels() / size0;
+  ProgressReporter progress( this, threadId, numberOfLinesToProcess );
+
+  // Contiguous scanlines of arithmetic pixels are processed by a
+  // vectorized loop
+  if ( ScanlineFunctorKernels::Ternary( m_Functor, inputPtr1.GetPointer(), inputPtr2.GetPointer(),
+                                        inputPtr3.GetPointer(), outputPtr.GetPointer(),
+                                        outputRegionForThread, progress ) )
+    {
+    return;
+    }
 
   ImageScanlineConstIterator< TInputImage1 > inputIt1(inputPtr1, outputRegionForThread);
   ImageScanlineConstIterator< TInputImage2 > inputIt2(inputPtr2, outputRegionForThread);
   ImageScanlineConstIterator< TInputImage3 > inputIt3(inputPtr3, outputRegionForThread);
   ImageScanlineIterator< TOutputImage >      outputIt(outputPtr, outputRegionForThread);
 
-  const size_t numberOfLinesToProcess = outputRegionForThread.GetNumberOfPixels() / size0;
-  ProgressReporter progress( this, threadId, numberOfLinesToProcess );
-
   while ( !inputIt1.IsAtEnd() )
     {
     while ( !inputIt1.IsAtEndOfLine() )
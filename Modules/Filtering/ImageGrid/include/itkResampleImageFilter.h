@@ -24,6 +24,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkExtrapolateImageFunction.h"
 #include "itkLinearInterpolateImageFunction.h"
+#include "itkResampleScanlineKernels.h"
 #include "itkSize.h"
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkDataObjectDecorator.h"
@@ -50,6 +51,14 @@ namespace itk
  * NearestNeighborInterpolateImageFunction< InputImageType,
  * TCoordRep > would be a better choice.
  *
+ * With a linear transform and the LinearInterpolateImageFunction or
+ * NearestNeighborInterpolateImageFunction interpolators, when the input
+ * and output are itk::Image of arithmetic pixel types of dimension 3 or
+ * less, each output scanline is computed at once: the span of the
+ * scanline which maps inside the input buffer is found once, then
+ * interpolated by a vectorized loop (see ResampleScanlineKernels).
+ * SIMDInstructionSet::Scalar disables this path.
+ *
  * If an sample is taken from outside the image domain, the default behavior is
  * to use a default pixel value.  If different behavior is desired, an
  * extrapolator function can be set with SetExtrapolator().
@@ -332,6 +341,18 @@ protected:
                                           outputRegionForThread,
                                           ThreadIdType threadId);
 
+  /** Implementation for resampling with linear transformation types
+   * and the linear or nearest neighbor interpolators, which interpolates
+   * the part of each scanline inside the input buffer at once. Used by
+   * LinearThreadedGenerateData() when the images are supported by
+   * ResampleScanlineKernels, and not by the subclasses of this filter:
+   * the kernels cast the interpolated values without calling
+   * CastPixelWithBoundsChecking().
+   */
+  virtual void LinearScanlineThreadedGenerateData(const OutputImageRegionType &
+                                                  outputRegionForThread,
+                                                  ThreadIdType threadId);
+
   virtual PixelType CastPixelWithBoundsChecking( const InterpolatorOutputType value,
                                                  const ComponentType minComponent,
                                                  const ComponentType maxComponent) const;
@@ -354,6 +375,12 @@ private:
   IndexType       m_OutputStartIndex;     // output image start index
   bool            m_UseReferenceImage;
 
+  typedef ResampleScanlineKernels< InputImageType, OutputImageType, TTransformPrecisionType > ScanlineKernelsType;
+
+  // Whether and how LinearThreadedGenerateData() interpolates whole
+  // scanlines, set up in BeforeThreadedGenerateData()
+  bool                                            m_UseScanlineKernels;
+  typename ScanlineKernelsType::InterpolationType m_ScanlineInterpolation;
 };
 } // end namespace itk
 
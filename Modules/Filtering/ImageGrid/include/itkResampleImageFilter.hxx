@@ -26,6 +26,8 @@
 #include "itkImageScanlineIterator.h"
 #include "itkSpecialCoordinatesImage.h"
 #include "itkDefaultConvertPixelTraits.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include <typeinfo>
 
 namespace itk
 {
@@ -37,7 +39,9 @@ template< typename TInputImage,
           typename TInterpolatorPrecisionType,
           typename TTransformPrecisionType >
 ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
-::ResampleImageFilter()
+::ResampleImageFilter() :
+  m_UseScanlineKernels(false),
+  m_ScanlineInterpolation(ScanlineKernelsType::LinearInterpolation)
 {
   m_OutputOrigin.Fill(0.0);
   m_OutputSpacing.Fill(1.0);
@@ -68,6 +72,10 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
 
   m_DefaultPixelValue
     = NumericTraits<PixelType>::ZeroValue( m_DefaultPixelValue );
+
+  // ThreadedGenerateData only touches the region it is given, so the
+  // output can be over-decomposed for work stealing
+  this->SetSupportsWorkStealing(true);
 }
 
 /**
@@ -196,6 +204,33 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
                                          zeroComponent );
       }
     }
+
+  // The linear and nearest neighbor interpolators are applied to whole
+  // scanlines by LinearThreadedGenerateData, when the images allow it.
+  // Subclasses of the interpolators may change their behavior, so only
+  // the exact types qualify. Likewise, the kernels cast the interpolated
+  // values as CastPixelWithBoundsChecking does, which a subclass of this
+  // filter may override.
+  typedef NearestNeighborInterpolateImageFunction< InputImageType, TInterpolatorPrecisionType >
+  NearestNeighborInterpolatorType;
+
+  m_UseScanlineKernels = false;
+  if ( ScanlineKernelsType::IsSupported()
+       && SIMDInstructionSet::GetInstructionSet() != SIMDInstructionSet::Scalar
+       && typeid( *this ) == typeid( Self ) )
+    {
+    const std::type_info & interpolatorType = typeid( *m_Interpolator.GetPointer() );
+    if ( interpolatorType == typeid( LinearInterpolatorType ) )
+      {
+      m_UseScanlineKernels = true;
+      m_ScanlineInterpolation = ScanlineKernelsType::LinearInterpolation;
+      }
+    else if ( interpolatorType == typeid( NearestNeighborInterpolatorType ) )
+      {
+      m_UseScanlineKernels = true;
+      m_ScanlineInterpolation = ScanlineKernelsType::NearestNeighborInterpolation;
+      }
+    }
 }
 
 /**
@@ -402,6 +437,12 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
                              outputRegionForThread,
                              ThreadIdType threadId)
 {
+  if ( m_UseScanlineKernels )
+    {
+    this->LinearScanlineThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+    }
+
   // Get the output pointers
   OutputImageType *outputPtr = this->GetOutput();
 
@@ -532,6 +573,132 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
     } //while( !outIt.IsAtEnd() )
 }
 
+/**
+ * LinearScanlineThreadedGenerateData
+ */
+template< typename TInputImage,
+          typename TOutputImage,
+          typename TInterpolatorPrecisionType,
+          typename TTransformPrecisionType >
+void
+ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::LinearScanlineThreadedGenerateData(const OutputImageRegionType &
+                                     outputRegionForThread,
+                                     ThreadIdType threadId)
+{
+  typedef typename ScanlineKernelsType::ContinuousIndexType KernelIndexType;
+
+  OutputImageType *     outputPtr = this->GetOutput();
+  const InputImageType *inputPtr = this->GetInput();
+  const TransformType * transformPtr = this->GetTransform();
+
+  typedef ImageScanlineIterator< TOutputImage > OutputIterator;
+  OutputIterator outIt(outputPtr, outputRegionForThread);
+
+  const typename OutputImageRegionType::SizeType &regionSize = outputRegionForThread.GetSize();
+  const SizeValueType numberOfLinesToProcess = outputRegionForThread.GetNumberOfPixels() / regionSize[0];
+
+  // Support for progress methods/callbacks
+  ProgressReporter progress( this,
+                             threadId,
+                             numberOfLinesToProcess );
+
+  // Min/max values of the output pixel type AND these values
+  // represented as the output type of the interpolator
+  const PixelComponentType minValue =  NumericTraits< PixelComponentType >::NonpositiveMin();
+  const PixelComponentType maxValue =  NumericTraits< PixelComponentType >::max();
+
+  typedef typename InterpolatorType::OutputType OutputType;
+  const ComponentType minOutputValue = static_cast< ComponentType >( minValue );
+  const ComponentType maxOutputValue = static_cast< ComponentType >( maxValue );
+
+  // The bounds tested by the interpolator for IsInsideBuffer()
+  KernelIndexType lower;
+  KernelIndexType upper;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    lower[d] = m_Interpolator->GetStartContinuousIndex()[d];
+    upper[d] = m_Interpolator->GetEndContinuousIndex()[d];
+    }
+
+  PointType                outputPoint;
+  PointType                inputPoint;
+  ContinuousInputIndexType inputIndex;
+  ContinuousInputIndexType nextInputIndex;
+
+  // The delta along a scanline in continuous index space of the input
+  // image, found as in LinearThreadedGenerateData
+  IndexType index = outIt.GetIndex();
+  outputPtr->TransformIndexToPhysicalPoint(index, outputPoint);
+  inputPoint = transformPtr->TransformPoint(outputPoint);
+  inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
+  ++index[0];
+  outputPtr->TransformIndexToPhysicalPoint(index, outputPoint);
+  inputPoint = transformPtr->TransformPoint(outputPoint);
+  inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, nextInputIndex);
+
+  KernelIndexType start;
+  KernelIndexType delta;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    delta[d] = nextInputIndex[d] - inputIndex[d];
+    }
+
+  while ( !outIt.IsAtEnd() )
+    {
+    // The continuous index of the first pixel of the scanline in the
+    // input image, the others being at start + k * delta
+    index = outIt.GetIndex();
+    outputPtr->TransformIndexToPhysicalPoint(index, outputPoint);
+    inputPoint = transformPtr->TransformPoint(outputPoint);
+    inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      start[d] = inputIndex[d];
+      }
+
+    PixelType *scanline = ScanlineImageTraits< TOutputImage >::GetScanline(outputPtr, index);
+
+    // Interpolate the span of the scanline inside the input buffer
+    SizeValueType begin;
+    SizeValueType end;
+    ScanlineKernelsType::ComputeInsideSpan(start, delta, regionSize[0], lower, upper, begin, end);
+    ScanlineKernelsType::Interpolate(m_ScanlineInterpolation, inputPtr, start, delta, begin, end, scanline);
+
+    // The pixels on either side of the span are outside the buffer
+    for ( SizeValueType k = 0; k < regionSize[0]; ++k )
+      {
+      if ( k == begin && begin < end )
+        {
+        k = end - 1;
+        continue;
+        }
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        inputIndex[d] = start[d] + static_cast< TTransformPrecisionType >( k ) * delta[d];
+        }
+
+      OutputType value;
+      if ( m_Interpolator->IsInsideBuffer(inputIndex) )
+        {
+        value = m_Interpolator->EvaluateAtContinuousIndex(inputIndex);
+        scanline[k] = this->CastPixelWithBoundsChecking( value, minOutputValue, maxOutputValue );
+        }
+      else if ( m_Extrapolator.IsNull() )
+        {
+        scanline[k] = m_DefaultPixelValue; // default background value
+        }
+      else
+        {
+        value = m_Extrapolator->EvaluateAtContinuousIndex( inputIndex );
+        scanline[k] = this->CastPixelWithBoundsChecking( value, minOutputValue, maxOutputValue );
+        }
+      }
+    progress.CompletedPixel();
+    outIt.NextLine();
+    }
+}
+
 /**
  * Inform pipeline of necessary input image region
  *
@@ -0,0 +1,355 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkResampleScanlineKernels_h
+#define itkResampleScanlineKernels_h
+
+#include "itkScanlineFunctorKernels.h"
+#include "itkContinuousIndex.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+/** \class ResampleScanlineKernels
+ * \brief Interpolates whole output scanlines of ResampleImageFilter for
+ * linear transforms, with the vector instructions selected at run time.
+ *
+ * With a linear transform, the continuous indices of the input traced by
+ * an output scanline are start + k * delta. The span of the scanline
+ * which maps inside the input buffer is computed once per scanline, so
+ * the interpolation of the pixels of the span needs neither the bounds
+ * check nor the virtual call of the interpolator. The span is
+ * interpolated by a loop over raw pointers, with the linear or nearest
+ * neighbor interpolation of LinearInterpolateImageFunction and
+ * NearestNeighborInterpolateImageFunction, which the compiler vectorizes.
+ * As in ScanlineFunctorKernels, the loop is compiled for the baseline
+ * instructions and, with GCC and Clang on x86, for AVX2 and AVX-512.
+ *
+ * The kernels are only available, IsSupported() returning true, when
+ * the input and output images are itk::Image of arithmetic pixel types
+ * of the same dimension, at most 3.
+ *
+ * \sa ResampleImageFilter
+ * \sa ScanlineFunctorKernels SIMDInstructionSet
+ * \ingroup ITKImageGrid
+ */
+template< typename TInputImage, typename TOutputImage, typename TCoordRep,
+          bool VSupported = ScanlineImageTraits< TInputImage >::IsContiguousArithmetic
+                            && ScanlineImageTraits< TOutputImage >::IsContiguousArithmetic
+                            && TInputImage::ImageDimension == TOutputImage::ImageDimension
+                            && TInputImage::ImageDimension <= 3 >
+class ResampleScanlineKernels
+{
+public:
+  typedef enum { LinearInterpolation, NearestNeighborInterpolation } InterpolationType;
+
+  typedef ContinuousIndex< TCoordRep, TInputImage::ImageDimension > ContinuousIndexType;
+
+  static bool IsSupported()
+  {
+    return false;
+  }
+
+  static void ComputeInsideSpan(const ContinuousIndexType &, const ContinuousIndexType &, SizeValueType,
+                                const ContinuousIndexType &, const ContinuousIndexType &,
+                                SizeValueType & begin, SizeValueType & end)
+  {
+    begin = 0;
+    end = 0;
+  }
+
+  static void Interpolate(InterpolationType, const TInputImage *, const ContinuousIndexType &,
+                          const ContinuousIndexType &, SizeValueType, SizeValueType,
+                          typename TOutputImage::PixelType *)
+  {
+  }
+};
+
+template< typename TInputImage, typename TOutputImage, typename TCoordRep >
+class ResampleScanlineKernels< TInputImage, TOutputImage, TCoordRep, true >
+{
+public:
+  typedef enum { LinearInterpolation, NearestNeighborInterpolation } InterpolationType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef ContinuousIndex< TCoordRep, ImageDimension > ContinuousIndexType;
+  typedef typename TInputImage::PixelType              InputPixelType;
+  typedef typename TOutputImage::PixelType             OutputPixelType;
+
+  /** Type of the interpolated values, as in LinearInterpolateImageFunction. */
+  typedef typename NumericTraits< InputPixelType >::RealType RealType;
+
+  static bool IsSupported()
+  {
+    return true;
+  }
+
+  /** Compute the span [begin, end) of the positions start + k * delta,
+   * 0 <= k < length, which are inside [lower, upper) along every
+   * dimension, like for InterpolateImageFunction::IsInsideBuffer(). The
+   * positions before begin and from end on are outside the buffer. */
+  static void ComputeInsideSpan(const ContinuousIndexType & start, const ContinuousIndexType & delta,
+                                SizeValueType length,
+                                const ContinuousIndexType & lower, const ContinuousIndexType & upper,
+                                SizeValueType & begin, SizeValueType & end)
+  {
+    // estimate the span from the bounds along each dimension
+    double first = 0.0;
+    double last = static_cast< double >( length );
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      // delta is zero along the dimensions which the scanline does not
+      // cross, e.g. with an identity transform: divide only by a nonzero
+      // delta, so that no floating-point exception is raised
+      if ( delta[d] > 0.0 )
+        {
+        const double lowerSteps = ( static_cast< double >( lower[d] ) - start[d] ) / delta[d];
+        const double upperSteps = ( static_cast< double >( upper[d] ) - start[d] ) / delta[d];
+        first = std::max( first, std::ceil(lowerSteps) );
+        last = std::min( last, std::ceil(upperSteps) );
+        }
+      else if ( delta[d] < 0.0 )
+        {
+        const double lowerSteps = ( static_cast< double >( lower[d] ) - start[d] ) / delta[d];
+        const double upperSteps = ( static_cast< double >( upper[d] ) - start[d] ) / delta[d];
+        first = std::max( first, std::floor(upperSteps) + 1.0 );
+        last = std::min( last, std::floor(lowerSteps) + 1.0 );
+        }
+      else if ( !( start[d] >= lower[d] && start[d] < upper[d] ) )
+        {
+        last = 0.0;
+        }
+      }
+    // the bounds exclude the whole scanline
+    if ( !( first < last ) )
+      {
+      begin = 0;
+      end = 0;
+      return;
+      }
+    begin = static_cast< SizeValueType >( first );
+    end = static_cast< SizeValueType >( last );
+
+    // the positions computed as in Interpolate() may round across the
+    // bounds, so adjust the ends of the span to them
+    while ( begin < end && !IsInside(start, delta, begin, lower, upper) )
+      {
+      ++begin;
+      }
+    while ( end > begin && !IsInside(start, delta, end - 1, lower, upper) )
+      {
+      --end;
+      }
+    if ( begin == end )
+      {
+      return;
+      }
+    while ( begin > 0 && IsInside(start, delta, begin - 1, lower, upper) )
+      {
+      --begin;
+      }
+    while ( end < length && IsInside(start, delta, end, lower, upper) )
+      {
+      ++end;
+      }
+  }
+
+  /** Interpolate the input at the positions start + k * delta, for k in
+   * [begin, end), into scanline[k]. The positions must be inside the
+   * buffer, as computed by ComputeInsideSpan(). The values are clamped
+   * to the range of the output pixel type, as ResampleImageFilter does. */
+  static void Interpolate(InterpolationType interpolation, const TInputImage *input,
+                          const ContinuousIndexType & start, const ContinuousIndexType & delta,
+                          SizeValueType begin, SizeValueType end, OutputPixelType *scanline)
+  {
+    if ( begin >= end )
+      {
+      return;
+      }
+    BufferType buffer;
+    buffer.Pixels = input->GetBufferPointer();
+    const typename TInputImage::RegionType & region = input->GetBufferedRegion();
+    const OffsetValueType *offsetTable = input->GetOffsetTable();
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      buffer.Start[d] = start[d];
+      buffer.Delta[d] = delta[d];
+      buffer.First[d] = region.GetIndex(d);
+      buffer.Last[d] = region.GetIndex(d) + static_cast< OffsetValueType >( region.GetSize(d) ) - 1;
+      buffer.Strides[d] = offsetTable[d];
+      }
+    buffer.Minimum = static_cast< RealType >( NumericTraits< OutputPixelType >::NonpositiveMin() );
+    buffer.Maximum = static_cast< RealType >( NumericTraits< OutputPixelType >::max() );
+
+    void ( *line )(const BufferType &, SizeValueType, SizeValueType, OutputPixelType *) =
+      interpolation == LinearInterpolation ? &LinearLoop : &NearestNeighborLoop;
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+    switch ( SIMDInstructionSet::GetInstructionSet() )
+      {
+      case SIMDInstructionSet::AVX2:
+        line = interpolation == LinearInterpolation ? &LinearAVX2 : &NearestNeighborAVX2;
+        break;
+      case SIMDInstructionSet::AVX512:
+        line = interpolation == LinearInterpolation ? &LinearAVX512 : &NearestNeighborAVX512;
+        break;
+      default:
+        break;
+      }
+#endif
+    line(buffer, begin, end, scanline);
+  }
+
+private:
+  /** What the loops need to know about the input buffer and the
+   * scanline, in the coordinates of the input index. */
+  struct BufferType
+    {
+    const InputPixelType *Pixels;
+    TCoordRep             Start[ImageDimension];
+    TCoordRep             Delta[ImageDimension];
+    OffsetValueType       First[ImageDimension];
+    OffsetValueType       Last[ImageDimension];
+    OffsetValueType       Strides[ImageDimension];
+    RealType              Minimum;
+    RealType              Maximum;
+    };
+
+  static bool IsInside(const ContinuousIndexType & start, const ContinuousIndexType & delta, SizeValueType k,
+                       const ContinuousIndexType & lower, const ContinuousIndexType & upper)
+  {
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      const TCoordRep position = start[d] + static_cast< TCoordRep >( k ) * delta[d];
+      if ( !( position >= lower[d] && position < upper[d] ) )
+        {
+        return false;
+        }
+      }
+    return true;
+  }
+
+  static itkSIMDInlineMacro OutputPixelType CastWithBoundsChecking(const BufferType & buffer, RealType value)
+  {
+    // selects rather than branches, the clamped pixels being common
+    // with random data
+    value = value < buffer.Minimum ? buffer.Minimum : value;
+    value = value > buffer.Maximum ? buffer.Maximum : value;
+    return static_cast< OutputPixelType >( value );
+  }
+
+  /** The floor of a position near the buffer. Unlike std::floor(), the
+   * truncation is vectorized without SSE4.1. */
+  static itkSIMDInlineMacro OffsetValueType Floor(TCoordRep position)
+  {
+    const OffsetValueType truncated = static_cast< OffsetValueType >( position );
+    return truncated - ( static_cast< TCoordRep >( truncated ) > position ? 1 : 0 );
+  }
+
+  /** The loops, inlined in each variant so that they are vectorized
+   * with its instructions. The indices are clamped to the buffer, so
+   * that a position rounded differently by a variant is never read out
+   * of it. */
+  static itkSIMDInlineMacro void LinearLoop(const BufferType & buffer, SizeValueType begin, SizeValueType end,
+                                            OutputPixelType *scanline)
+  {
+    const unsigned int numberOfCorners = 1u << ImageDimension;
+    for ( SizeValueType k = begin; k < end; ++k )
+      {
+      OffsetValueType offset = 0;
+      OffsetValueType steps[ImageDimension];
+      TCoordRep       distances[ImageDimension];
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        const TCoordRep position = buffer.Start[d] + static_cast< TCoordRep >( k ) * buffer.Delta[d];
+        OffsetValueType base = Floor(position);
+        base = base < buffer.First[d] ? buffer.First[d] : ( base > buffer.Last[d] ? buffer.Last[d] : base );
+        const TCoordRep distance = position - static_cast< TCoordRep >( base );
+        distances[d] = distance > 0 ? distance : 0;
+        steps[d] = base < buffer.Last[d] ? buffer.Strides[d] : 0;
+        offset += ( base - buffer.First[d] ) * buffer.Strides[d];
+        }
+
+      // interpolate along the first dimension, then the second, ... as
+      // LinearInterpolateImageFunction does
+      RealType values[1u << ImageDimension];
+      for ( unsigned int c = 0; c < numberOfCorners; ++c )
+        {
+        OffsetValueType cornerOffset = offset;
+        for ( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+          cornerOffset += ( ( c >> d ) & 1u ) ? steps[d] : 0;
+          }
+        values[c] = static_cast< RealType >( buffer.Pixels[cornerOffset] );
+        }
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        for ( unsigned int c = 0; c < ( numberOfCorners >> ( d + 1 ) ); ++c )
+          {
+          values[c] = values[2 * c] + ( values[2 * c + 1] - values[2 * c] ) * distances[d];
+          }
+        }
+      scanline[k] = CastWithBoundsChecking(buffer, values[0]);
+      }
+  }
+
+  static itkSIMDInlineMacro void NearestNeighborLoop(const BufferType & buffer, SizeValueType begin,
+                                                     SizeValueType end, OutputPixelType *scanline)
+  {
+    for ( SizeValueType k = begin; k < end; ++k )
+      {
+      OffsetValueType offset = 0;
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        const TCoordRep position = buffer.Start[d] + static_cast< TCoordRep >( k ) * buffer.Delta[d];
+        // rounds half integers up, as Math::RoundHalfIntegerUp()
+        OffsetValueType nearest = Floor( position + static_cast< TCoordRep >( 0.5 ) );
+        nearest = nearest < buffer.First[d] ? buffer.First[d]
+                  : ( nearest > buffer.Last[d] ? buffer.Last[d] : nearest );
+        offset += ( nearest - buffer.First[d] ) * buffer.Strides[d];
+        }
+      scanline[k] = CastWithBoundsChecking( buffer, static_cast< RealType >( buffer.Pixels[offset] ) );
+      }
+  }
+
+#if defined( ITK_HAS_SIMD_TARGET_DISPATCH )
+#define itkResampleScanlineKernelsVariantsMacro(suffix, instructions)                                     \
+  itkSIMDTargetMacro(instructions) static void Linear##suffix(const BufferType & buffer,                  \
+                                                              SizeValueType begin, SizeValueType end,     \
+                                                              OutputPixelType *scanline)                  \
+  {                                                                                                       \
+    LinearLoop(buffer, begin, end, scanline);                                                             \
+  }                                                                                                       \
+  itkSIMDTargetMacro(instructions) static void NearestNeighbor##suffix(const BufferType & buffer,         \
+                                                                       SizeValueType begin,               \
+                                                                       SizeValueType end,                 \
+                                                                       OutputPixelType *scanline)         \
+  {                                                                                                       \
+    NearestNeighborLoop(buffer, begin, end, scanline);                                                    \
+  }
+
+  itkResampleScanlineKernelsVariantsMacro(AVX2, "avx2")
+  itkResampleScanlineKernelsVariantsMacro(AVX512, "avx512f,avx512bw,avx512dq,avx512vl")
+
+#undef itkResampleScanlineKernelsVariantsMacro
+#endif
+};
+} // end namespace itk
+
+#endif
@@ -0,0 +1,276 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkResampleImageFilter.h"
+#include "itkAffineTransform.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkNearestNeighborExtrapolateImageFunction.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingInstructionSetHelpers.h"
+#include "itkFloatingPointExceptions.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+typedef itk::Image< float, 3 >         FloatImageType;
+typedef itk::Image< short, 3 >         ShortImageType;
+typedef itk::Image< unsigned char, 3 > UCharImageType;
+typedef itk::Image< float, 2 >         Float2DImageType;
+
+template< typename TImage >
+typename TImage::Pointer CreateRandomImage( double minimum, double maximum )
+{
+  typename TImage::SizeType size;
+  size.Fill( 64 );
+  size[0] = 97;
+  typename TImage::Pointer image = itk::Testing::CreateRandomTestImage< TImage >( size, minimum, maximum );
+  typename TImage::SpacingType spacing;
+  spacing.Fill( 1.5 );
+  image->SetSpacing( spacing );
+  return image;
+}
+
+/** A rotation about the center of the image, with a translation which
+ * moves part of the output outside of the input. */
+template< unsigned int VDimension >
+typename itk::AffineTransform< double, VDimension >::Pointer CreateTransform( const itk::ImageBase< VDimension > *image )
+{
+  typedef itk::AffineTransform< double, VDimension > TransformType;
+  typename TransformType::Pointer transform = TransformType::New();
+  typename TransformType::InputPointType center;
+  const typename itk::ImageBase< VDimension >::RegionType region = image->GetLargestPossibleRegion();
+  for( unsigned int d = 0; d < VDimension; ++d )
+    {
+    center[d] = 0.5 * image->GetSpacing()[d] * region.GetSize( d );
+    }
+  transform->SetCenter( center );
+  transform->Rotate( 0, 1, 0.3 );
+  if( VDimension > 2 )
+    {
+    transform->Rotate( 1, 2, -0.2 );
+    }
+  typename TransformType::OutputVectorType translation;
+  translation.Fill( 7.3 );
+  transform->Translate( translation );
+  return transform;
+}
+
+/** Resamples with the scanline kernels of each instruction set, and
+ * compares the outputs with the one of the scalar path. The positions
+ * along a scanline are computed slightly differently by the two paths, so
+ * a few pixels at the border of the input, or rounded to another integer,
+ * may differ. Checks as well that the output is partly outside of the
+ * input, so that the border of the span is exercised. */
+template< typename TFilter >
+bool CheckFilter( const char *name, TFilter *filter, double tolerance )
+{
+  typedef typename TFilter::OutputImageType OutputImageType;
+
+  bool passed = itk::Testing::CompareInstructionSets( name, filter, tolerance, 1.0e-4 );
+
+  filter->Update();
+  const OutputImageType *output = filter->GetOutput();
+  itk::SizeValueType outside = 0;
+  itk::ImageRegionConstIterator< OutputImageType > it( output, output->GetBufferedRegion() );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    if( it.Get() == filter->GetDefaultPixelValue() )
+      {
+      ++outside;
+      }
+    }
+  if( outside == 0 || outside == output->GetBufferedRegion().GetNumberOfPixels() )
+    {
+    std::cerr << name << ": the output should be partly outside of the input" << std::endl;
+    passed = false;
+    }
+  return passed;
+}
+
+/** Clamps the resampled values to [-50, 50]. */
+class ClampingResampleImageFilter : public itk::ResampleImageFilter< FloatImageType, FloatImageType >
+{
+public:
+  typedef ClampingResampleImageFilter                                Self;
+  typedef itk::ResampleImageFilter< FloatImageType, FloatImageType > Superclass;
+  typedef itk::SmartPointer< Self >                                  Pointer;
+  itkNewMacro( Self );
+
+protected:
+  ClampingResampleImageFilter() {}
+
+  virtual PixelType CastPixelWithBoundsChecking( const InterpolatorOutputType value,
+                                                 const ComponentType minComponent,
+                                                 const ComponentType maxComponent ) const ITK_OVERRIDE
+  {
+    const PixelType pixel = Superclass::CastPixelWithBoundsChecking( value, minComponent, maxComponent );
+    return std::max( -50.0f, std::min( 50.0f, pixel ) );
+  }
+};
+
+}
+
+/** Compares the scanline and per pixel paths of ResampleImageFilter with
+ * affine transforms and the linear and nearest neighbor interpolators,
+ * and checks that the subclasses which override CastPixelWithBoundsChecking
+ * are not resampled by the scanline path. */
+int itkResampleImageFilterScanlineTest( int, char* [] )
+{
+  std::cout << "Supported instruction set: "
+            << itk::SIMDInstructionSet::GetInstructionSetName( itk::SIMDInstructionSet::GetSupportedInstructionSet() )
+            << std::endl;
+
+  FloatImageType::Pointer   floatImage = CreateRandomImage< FloatImageType >( -100.0, 100.0 );
+  ShortImageType::Pointer   shortImage = CreateRandomImage< ShortImageType >( -2000.0, 2000.0 );
+  Float2DImageType::Pointer float2DImage = CreateRandomImage< Float2DImageType >( -100.0, 100.0 );
+
+  bool passed = true;
+
+  typedef itk::ResampleImageFilter< FloatImageType, FloatImageType > FloatResampleType;
+  FloatResampleType::Pointer linear = FloatResampleType::New();
+  linear->SetInput( floatImage );
+  linear->SetTransform( CreateTransform< 3 >( floatImage ) );
+  linear->SetOutputParametersFromImage( floatImage );
+  linear->SetDefaultPixelValue( -1000.0f );
+  passed &= CheckFilter( "Linear", linear.GetPointer(), 1.0e-4 );
+
+  // with an identity transform the scanlines do not cross the other
+  // dimensions, which must not raise a floating-point exception
+  typedef itk::AffineTransform< double, 3 > AffineTransformType;
+  FloatResampleType::Pointer identity = FloatResampleType::New();
+  identity->SetInput( floatImage );
+  identity->SetTransform( AffineTransformType::New() );
+  identity->SetOutputParametersFromImage( floatImage );
+  const bool floatingPointExceptions = itk::FloatingPointExceptions::GetEnabled();
+  itk::FloatingPointExceptions::Enable();
+  identity->Update();
+  itk::FloatingPointExceptions::SetEnabled( floatingPointExceptions );
+  itk::ImageRegionConstIterator< FloatImageType > init( floatImage, floatImage->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< FloatImageType > idit( identity->GetOutput(), floatImage->GetBufferedRegion() );
+  for( ; !init.IsAtEnd(); ++init, ++idit )
+    {
+    if( !( std::abs( idit.Get() - init.Get() ) <= 1.0e-4 * std::max( 1.0f, std::abs( init.Get() ) ) ) )
+      {
+      std::cerr << "Identity: expected " << init.Get() << " at " << init.GetIndex()
+                << " but got " << idit.Get() << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  // the values are clamped to the output pixel type
+  typedef itk::ResampleImageFilter< ShortImageType, UCharImageType >            UCharResampleType;
+  typedef itk::NearestNeighborInterpolateImageFunction< ShortImageType, double > NearestType;
+  UCharResampleType::Pointer nearest = UCharResampleType::New();
+  nearest->SetInput( shortImage );
+  nearest->SetInterpolator( NearestType::New() );
+  nearest->SetTransform( CreateTransform< 3 >( shortImage ) );
+  nearest->SetOutputParametersFromImage( shortImage );
+  nearest->SetDefaultPixelValue( 7 );
+  passed &= CheckFilter( "NearestShortToUChar", nearest.GetPointer(), 0.0 );
+
+  UCharResampleType::Pointer linearToUChar = UCharResampleType::New();
+  linearToUChar->SetInput( shortImage );
+  linearToUChar->SetTransform( CreateTransform< 3 >( shortImage ) );
+  linearToUChar->SetOutputParametersFromImage( shortImage );
+  linearToUChar->SetDefaultPixelValue( 7 );
+  passed &= CheckFilter( "LinearShortToUChar", linearToUChar.GetPointer(), 1.0 );
+
+  // an output region which does not start at the buffer origin
+  FloatImageType::RegionType region = floatImage->GetLargestPossibleRegion();
+  region.SetIndex( 0, 5 );
+  region.SetSize( 0, 80 );
+  region.SetIndex( 2, 10 );
+  region.SetSize( 2, 30 );
+  FloatResampleType::Pointer linearRegion = FloatResampleType::New();
+  linearRegion->SetInput( floatImage );
+  linearRegion->SetTransform( CreateTransform< 3 >( floatImage ) );
+  linearRegion->SetOutputParametersFromImage( floatImage );
+  linearRegion->SetDefaultPixelValue( -1000.0f );
+  linearRegion->GetOutput()->SetRequestedRegion( region );
+  passed &= CheckFilter( "LinearRequestedRegion", linearRegion.GetPointer(), 1.0e-4 );
+
+  // the pixels outside of the span are extrapolated
+  typedef itk::ResampleImageFilter< Float2DImageType, Float2DImageType >           Float2DResampleType;
+  typedef itk::NearestNeighborExtrapolateImageFunction< Float2DImageType, double > ExtrapolatorType;
+  Float2DResampleType::Pointer extrapolated = Float2DResampleType::New();
+  extrapolated->SetInput( float2DImage );
+  extrapolated->SetTransform( CreateTransform< 2 >( float2DImage ) );
+  extrapolated->SetOutputParametersFromImage( float2DImage );
+  extrapolated->SetExtrapolator( ExtrapolatorType::New() );
+  extrapolated->SetDefaultPixelValue( -1000.0f );
+  itk::SIMDInstructionSet::SetMaximumInstructionSet( itk::SIMDInstructionSet::Scalar );
+  extrapolated->Update();
+  Float2DImageType::Pointer expected = extrapolated->GetOutput();
+  expected->DisconnectPipeline();
+  itk::SIMDInstructionSet::SetMaximumInstructionSet( itk::SIMDInstructionSet::AVX512 );
+  extrapolated->Update();
+  unsigned int differences = 0;
+  itk::ImageRegionConstIterator< Float2DImageType > eit( expected, expected->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< Float2DImageType > xit( extrapolated->GetOutput(), expected->GetBufferedRegion() );
+  for( ; !eit.IsAtEnd(); ++eit, ++xit )
+    {
+    if( xit.Get() == -1000.0f || !( std::abs( xit.Get() - eit.Get() ) <= 1.0e-4 * std::max( 1.0f, std::abs( eit.Get() ) ) ) )
+      {
+      ++differences;
+      }
+    }
+  if( differences > expected->GetBufferedRegion().GetNumberOfPixels() * 1.0e-4 )
+    {
+    std::cerr << "Extrapolated: " << differences << " pixels differ from the scalar path" << std::endl;
+    passed = false;
+    }
+
+  // the override of CastPixelWithBoundsChecking is applied to each pixel
+  ClampingResampleImageFilter::Pointer clamping = ClampingResampleImageFilter::New();
+  clamping->SetInput( floatImage );
+  clamping->SetTransform( CreateTransform< 3 >( floatImage ) );
+  clamping->SetOutputParametersFromImage( floatImage );
+  clamping->SetDefaultPixelValue( -1000.0f );
+  clamping->Update();
+  unsigned int unclamped = 0;
+  unsigned int clamped = 0;
+  itk::ImageRegionConstIterator< FloatImageType > cit( clamping->GetOutput(), clamping->GetOutput()->GetBufferedRegion() );
+  for( ; !cit.IsAtEnd(); ++cit )
+    {
+    if( cit.Get() != -1000.0f && std::abs( cit.Get() ) > 50.0f )
+      {
+      ++unclamped;
+      }
+    if( std::abs( cit.Get() ) == 50.0f )
+      {
+      ++clamped;
+      }
+    }
+  if( unclamped != 0 || clamped == 0 )
+    {
+    std::cerr << "Clamping: " << unclamped << " pixels were not cast by the subclass" << std::endl;
+    passed = false;
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
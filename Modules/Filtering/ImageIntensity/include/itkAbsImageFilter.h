@@ -105,6 +105,12 @@ protected:
   AbsImageFilter() {}
   virtual ~AbsImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
 private:
   AbsImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &); //purposely not implemented
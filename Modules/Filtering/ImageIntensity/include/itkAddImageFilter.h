@@ -147,6 +147,12 @@ protected:
   AddImageFilter() {}
   virtual ~AddImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
 private:
   AddImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &); //purposely not implemented
@@ -173,6 +173,12 @@ protected:
   ClampImageFilter();
   virtual ~ClampImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
   void GenerateData() ITK_OVERRIDE;
 
   void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
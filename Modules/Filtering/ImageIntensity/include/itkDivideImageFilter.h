@@ -131,6 +131,16 @@ protected:
   DivideImageFilter() {}
   virtual ~DivideImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it,
+   * unless it has to report a null constant denominator. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    const typename Superclass::DecoratedInput2ImagePixelType *input
+       = dynamic_cast< const typename Superclass::DecoratedInput2ImagePixelType * >(
+        this->ProcessObject::GetInput(1) );
+    return input == ITK_NULLPTR || input->Get() != itk::NumericTraits< typename TInputImage2::PixelType >::ZeroValue();
+  }
+
   void GenerateData() ITK_OVERRIDE
     {
     const typename Superclass::DecoratedInput2ImagePixelType *input
@@ -101,6 +101,12 @@ protected:
   ExpImageFilter() {}
   virtual ~ExpImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
 private:
   ExpImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &); //purposely not implemented
@@ -196,6 +196,12 @@ protected:
   IntensityWindowingImageFilter();
   virtual ~IntensityWindowingImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
 private:
   IntensityWindowingImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);                //purposely not implemented
@@ -97,6 +97,12 @@ protected:
   LogImageFilter() {}
   virtual ~LogImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
 private:
   LogImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &); //purposely not implemented
@@ -106,6 +106,12 @@ protected:
   MultiplyImageFilter() {}
   virtual ~MultiplyImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
 private:
   MultiplyImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);      //purposely not implemented
@@ -19,7 +19,9 @@
 #define itkShiftScaleImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include "itkPixelwiseFusionStage.h"
 #include "itkArray.h"
+#include <vector>
 
 namespace itk
 {
@@ -31,13 +33,20 @@ namespace itk
  * are performed in the precison of the input pixel's RealType. Before
  * assigning the computed value to the output pixel, the value is clamped
  * at the NonpositiveMin and max of the pixel type.
+ *
+ * The filter takes part in the fusion of the pixel-wise filters, as
+ * described in UnaryFunctorImageFilter, when the images are itk::Image of
+ * arithmetic pixel types.
+ *
+ * \sa PixelwiseFusionStage
  * \ingroup IntensityImageFilters
  *
  * \ingroup ITKImageIntensity
  */
 template< typename TInputImage, typename TOutputImage >
 class ShiftScaleImageFilter:
-  public ImageToImageFilter< TInputImage, TOutputImage >
+  public ImageToImageFilter< TInputImage, TOutputImage >,
+  public PixelwiseFusionStage< TOutputImage::ImageDimension >
 {
 public:
   /** Standard class typedefs. */
@@ -93,6 +102,17 @@ public:
   itkGetConstMacro(UnderflowCount, long);
   itkGetConstMacro(OverflowCount, long);
 
+  /** Set/Get whether the filter may be fused into the pixel-wise filter
+   * which consumes its output. The fused filter does not execute: it
+   * invokes no StartEvent, ProgressEvent or EndEvent, and its output is
+   * left released, so that it executes normally if its output is then
+   * requested by another filter. The underflow and overflow counts are still computed.
+   * Off by default.
+   * \sa PixelwiseFusionStage */
+  itkSetMacro(PixelwiseFusion, bool);
+  itkGetConstMacro(PixelwiseFusion, bool);
+  itkBooleanMacro(PixelwiseFusion);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   // Begin concept checking
   itkConceptMacro( OutputHasNumericTraitsCheck,
@@ -120,10 +140,37 @@ protected:
                              outputRegionForThread,
                              ThreadIdType threadId) ITK_OVERRIDE;
 
+  typedef PixelwiseFusionStage< TOutputImage::ImageDimension > FusionStageType;
+  typedef PixelwiseFusionStage< TInputImage::ImageDimension >  InputFusionStageType;
+
+  /** Fuse the input when possible, and update it otherwise. */
+  virtual void UpdateInputs() ITK_OVERRIDE;
+
+  /** Prepare the fused input around the execution. */
+  virtual void GenerateData() ITK_OVERRIDE;
+
+  /** PixelwiseFusionStage interface. */
+  virtual bool CanBeFused() const ITK_OVERRIDE;
+  virtual void UpdateFusedInputs() ITK_OVERRIDE;
+  virtual void PrepareFusedExecution(ThreadIdType numberOfThreads, SizeValueType maximumLength) ITK_OVERRIDE;
+  virtual void GenerateFusedScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                                     void *scanline, ThreadIdType threadId) ITK_OVERRIDE;
+  virtual void FinishFusedExecution() ITK_OVERRIDE;
+
 private:
   ShiftScaleImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);        //purposely not implemented
 
+  void InitializeCounts(ThreadIdType numberOfThreads);
+
+  void PrepareFusedInput(ThreadIdType numberOfThreads, SizeValueType maximumLength);
+
+  void FinishFusedInput();
+
+  /** Shift and scale the length pixels of the scanline at index. */
+  void GenerateScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                        OutputImagePixelType *scanline, ThreadIdType threadId);
+
   RealType m_Shift;
   RealType m_Scale;
 
@@ -135,6 +182,10 @@ private:
 
   const TInputImage *m_InputImage;
   TOutputImage      *m_OutputImage;
+
+  bool                                              m_PixelwiseFusion;
+  InputFusionStageType *                            m_FusedInput;
+  std::vector< std::vector< InputImagePixelType > > m_FusedInputScanlines;
 };
 } // end namespace itk
 
@@ -20,8 +20,11 @@
 #include "itkShiftScaleImageFilter.h"
 
 #include "itkImageRegionIterator.h"
+#include "itkImageScanlineIterator.h"
+#include "itkScanlineFunctorKernels.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
+#include <typeinfo>
 
 namespace itk
 {
@@ -37,6 +40,8 @@ ShiftScaleImageFilter< TInputImage, TOutputImage >
   m_ThreadOverflow.SetSize(1);
   m_InputImage = ITK_NULLPTR;
   m_OutputImage = ITK_NULLPTR;
+  m_PixelwiseFusion = false;
+  m_FusedInput = ITK_NULLPTR;
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -49,15 +54,21 @@ void
 ShiftScaleImageFilter< TInputImage, TOutputImage >
 ::BeforeThreadedGenerateData()
 {
-  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  this->InitializeCounts( this->GetNumberOfThreads() );
+  m_InputImage = this->GetInput();
+  m_OutputImage = this->GetOutput();
+}
 
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::InitializeCounts(ThreadIdType numberOfThreads)
+{
   //  Allocate and initialize the thread temporaries
   m_ThreadUnderflow.SetSize(numberOfThreads);
   m_ThreadUnderflow.Fill(0);
   m_ThreadOverflow.SetSize(numberOfThreads);
   m_ThreadOverflow.Fill(0);
-  m_InputImage = this->GetInput();
-  m_OutputImage = this->GetOutput();
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -65,7 +76,8 @@ void
 ShiftScaleImageFilter< TInputImage, TOutputImage >
 ::AfterThreadedGenerateData()
 {
-  ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  // a fused execution may use another number of threads
+  const ThreadIdType numberOfThreads = m_ThreadUnderflow.Size();
 
   m_UnderflowCount = 0;
   m_OverflowCount = 0;
@@ -84,6 +96,27 @@ ShiftScaleImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        ThreadIdType threadId)
 {
+  // The scanlines of a fused input are computed by the upstream filter
+  if ( m_FusedInput )
+    {
+    const SizeValueType length = outputRegionForThread.GetSize(0);
+    if ( length == 0 )
+      {
+      return;
+      }
+    ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / length );
+    ImageScanlineConstIterator< TOutputImage > ot(this->m_OutputImage, outputRegionForThread);
+    while ( !ot.IsAtEnd() )
+      {
+      this->GenerateScanline( ot.GetIndex(), length,
+                              ScanlineImageTraits< TOutputImage >::GetScanline( this->m_OutputImage, ot.GetIndex() ),
+                              threadId );
+      ot.NextLine();
+      progress.CompletedPixel();
+      }
+    return;
+    }
+
   RealType value;
 
   ImageRegionConstIterator< TInputImage > it (this->m_InputImage, outputRegionForThread);
@@ -117,6 +150,187 @@ ShiftScaleImageFilter< TInputImage, TOutputImage >
     }
 }
 
+template< typename TInputImage, typename TOutputImage >
+bool
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::CanBeFused() const
+{
+  // a subclass may compute its pixels otherwise
+  return (unsigned int)TInputImage::ImageDimension == (unsigned int)TOutputImage::ImageDimension
+         && ScanlineImageTraits< TInputImage >::IsContiguousArithmetic
+         && ScanlineImageTraits< TOutputImage >::IsContiguousArithmetic
+         && typeid( *this ) == typeid( Self );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::UpdateInputs()
+{
+  m_FusedInput = ITK_NULLPTR;
+  if ( this->CanBeFused() )
+    {
+    m_FusedInput = InputFusionStageType::GetFusableSource( this->ProcessObject::GetInput(0) );
+    }
+  if ( !m_FusedInput )
+    {
+    Superclass::UpdateInputs();
+    return;
+    }
+
+  try
+    {
+    m_FusedInput->UpdateFusedInputs();
+    }
+  catch ( ... )
+    {
+    this->FinishFusedInput();
+    throw;
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  if ( !m_FusedInput )
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  // the fused input is released even if the execution fails
+  try
+    {
+    this->PrepareFusedInput( this->GetNumberOfThreads(), this->GetOutput()->GetRequestedRegion().GetSize(0) );
+    Superclass::GenerateData();
+    }
+  catch ( ... )
+    {
+    this->FinishFusedInput();
+    throw;
+    }
+  this->FinishFusedInput();
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::UpdateFusedInputs()
+{
+  this->UpdateInputs();
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::PrepareFusedExecution(ThreadIdType numberOfThreads, SizeValueType maximumLength)
+{
+  this->PrepareFusedInput(numberOfThreads, maximumLength);
+  this->InitializeCounts(numberOfThreads);
+  m_InputImage = this->GetInput();
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::GenerateFusedScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                        void *scanline, ThreadIdType threadId)
+{
+  this->GenerateScanline( index, length, static_cast< OutputImagePixelType * >( scanline ), threadId );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::FinishFusedExecution()
+{
+  this->AfterThreadedGenerateData();
+  this->FinishFusedInput();
+  this->ProcessObject::ReleaseInputs();
+  // the output was not generated: mark it released, so that it is
+  // updated normally when another consumer requests it
+  this->GetOutput()->ReleaseData();
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::PrepareFusedInput(ThreadIdType numberOfThreads, SizeValueType maximumLength)
+{
+  if ( m_FusedInput )
+    {
+    m_FusedInput->PrepareFusedExecution(numberOfThreads, maximumLength);
+    m_FusedInputScanlines.assign( numberOfThreads, std::vector< InputImagePixelType >(maximumLength) );
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::FinishFusedInput()
+{
+  if ( m_FusedInput )
+    {
+    m_FusedInput->FinishFusedExecution();
+    m_FusedInput = ITK_NULLPTR;
+    std::vector< std::vector< InputImagePixelType > >().swap(m_FusedInputScanlines);
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+ShiftScaleImageFilter< TInputImage, TOutputImage >
+::GenerateScanline(const typename FusionStageType::IndexType & index, SizeValueType length,
+                   OutputImagePixelType *scanline, ThreadIdType threadId)
+{
+  // the dimensions match when the filter is fused
+  typename TInputImage::IndexType inputIndex;
+  inputIndex.Fill(0);
+  for ( unsigned int i = 0; i < TInputImage::ImageDimension && i < TOutputImage::ImageDimension; ++i )
+    {
+    inputIndex[i] = index[i];
+    }
+
+  const InputImagePixelType *input;
+  if ( m_FusedInput )
+    {
+    InputImagePixelType *inputScanline = &m_FusedInputScanlines[threadId][0];
+    m_FusedInput->GenerateFusedScanline(inputIndex, length, inputScanline, threadId);
+    input = inputScanline;
+    }
+  else
+    {
+    input = ScanlineImageTraits< TInputImage >::GetScanline(m_InputImage, inputIndex);
+    }
+
+  const RealType shift = m_Shift;
+  const RealType scale = m_Scale;
+  long           underflow = 0;
+  long           overflow = 0;
+  for ( SizeValueType i = 0; i < length; ++i )
+    {
+    const RealType value = ( static_cast< RealType >( input[i] ) + shift ) * scale;
+    if ( value < NumericTraits< OutputImagePixelType >::NonpositiveMin() )
+      {
+      scanline[i] = NumericTraits< OutputImagePixelType >::NonpositiveMin();
+      ++underflow;
+      }
+    else if ( value > NumericTraits< OutputImagePixelType >::max() )
+      {
+      scanline[i] = NumericTraits< OutputImagePixelType >::max();
+      ++overflow;
+      }
+    else
+      {
+      scanline[i] = static_cast< OutputImagePixelType >( value );
+      }
+    }
+  m_ThreadUnderflow[threadId] += underflow;
+  m_ThreadOverflow[threadId] += overflow;
+}
+
 template< typename TInputImage, typename TOutputImage >
 void
 ShiftScaleImageFilter< TInputImage, TOutputImage >
@@ -129,6 +343,7 @@ ShiftScaleImageFilter< TInputImage, TOutputImage >
   os << indent << "Computed values follow:" << std::endl;
   os << indent << "UnderflowCount: "  << m_UnderflowCount << std::endl;
   os << indent << "OverflowCount: "  << m_OverflowCount << std::endl;
+  os << indent << "PixelwiseFusion: " << ( m_PixelwiseFusion ? "On" : "Off" ) << std::endl;
 }
 } // end namespace itk
 #endif
@@ -99,6 +99,12 @@ protected:
   SqrtImageFilter() {}
   virtual ~SqrtImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
 private:
   SqrtImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
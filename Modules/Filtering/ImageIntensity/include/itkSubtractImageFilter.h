@@ -130,6 +130,12 @@ protected:
   SubtractImageFilter() {}
   virtual ~SubtractImageFilter() {}
 
+  /** The filter can be fused with the pixel-wise filters around it. */
+  virtual bool IsPixelwise() const ITK_OVERRIDE
+  {
+    return true;
+  }
+
 private:
   SubtractImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);      //purposely not implemented
@@ -0,0 +1,193 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAddImageFilter.h"
+#include "itkDivideImageFilter.h"
+#include "itkMultiplyImageFilter.h"
+#include "itkSubtractImageFilter.h"
+#include "itkAbsImageFilter.h"
+#include "itkSqrtImageFilter.h"
+#include "itkExpImageFilter.h"
+#include "itkLogImageFilter.h"
+#include "itkClampImageFilter.h"
+#include "itkIntensityWindowingImageFilter.h"
+#include "itkTernaryAddImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingInstructionSetHelpers.h"
+
+namespace
+{
+
+typedef itk::Image< float, 3 >         FloatImageType;
+typedef itk::Image< short, 3 >         ShortImageType;
+typedef itk::Image< unsigned char, 3 > UCharImageType;
+
+/** An odd width, so that the vector loops have remainders. */
+template< typename TImage >
+typename TImage::Pointer CreateRandomImage( double minimum, double maximum )
+{
+  typename TImage::SizeType size;
+  size[0] = 253;
+  size[1] = 128;
+  size[2] = 64;
+  return itk::Testing::CreateRandomTestImage< TImage >( size, minimum, maximum );
+}
+
+}
+
+/** Compares the vectorized and scalar paths of the functor filters. */
+int itkFunctorImageFilterVectorizationTest( int, char* [] )
+{
+  std::cout << "Supported instruction set: "
+            << itk::SIMDInstructionSet::GetInstructionSetName( itk::SIMDInstructionSet::GetSupportedInstructionSet() )
+            << std::endl;
+
+  FloatImageType::Pointer float1 = CreateRandomImage< FloatImageType >( 0.5, 100.0 );
+  FloatImageType::Pointer float2 = CreateRandomImage< FloatImageType >( 0.5, 100.0 );
+  FloatImageType::Pointer float3 = CreateRandomImage< FloatImageType >( -10.0, 10.0 );
+  ShortImageType::Pointer short1 = CreateRandomImage< ShortImageType >( -2000.0, 2000.0 );
+  ShortImageType::Pointer short2 = CreateRandomImage< ShortImageType >( -10.0, 10.0 );
+
+  bool passed = true;
+
+  typedef itk::AddImageFilter< FloatImageType > AddType;
+  AddType::Pointer add = AddType::New();
+  add->SetInput1( float1 );
+  add->SetInput2( float2 );
+  passed &= itk::Testing::CompareInstructionSets( "Add", add.GetPointer(), 0.0 );
+
+  AddType::Pointer addConstant = AddType::New();
+  addConstant->SetInput1( float1 );
+  addConstant->SetConstant2( 3.5f );
+  passed &= itk::Testing::CompareInstructionSets( "AddConstant", addConstant.GetPointer(), 0.0 );
+
+  typedef itk::SubtractImageFilter< FloatImageType > SubtractType;
+  SubtractType::Pointer subtract = SubtractType::New();
+  subtract->SetConstant1( 7.0f );
+  subtract->SetInput2( float2 );
+  passed &= itk::Testing::CompareInstructionSets( "SubtractFromConstant", subtract.GetPointer(), 0.0 );
+
+  typedef itk::MultiplyImageFilter< ShortImageType > MultiplyType;
+  MultiplyType::Pointer multiply = MultiplyType::New();
+  multiply->SetInput1( short1 );
+  multiply->SetInput2( short2 );
+  passed &= itk::Testing::CompareInstructionSets( "MultiplyShort", multiply.GetPointer(), 0.0 );
+
+  typedef itk::DivideImageFilter< FloatImageType, FloatImageType, FloatImageType > DivideType;
+  DivideType::Pointer divide = DivideType::New();
+  divide->SetInput1( float1 );
+  divide->SetInput2( float2 );
+  passed &= itk::Testing::CompareInstructionSets( "Divide", divide.GetPointer(), 0.0 );
+
+  typedef itk::AbsImageFilter< ShortImageType, ShortImageType > AbsType;
+  AbsType::Pointer abs = AbsType::New();
+  abs->SetInput( short1 );
+  passed &= itk::Testing::CompareInstructionSets( "AbsShort", abs.GetPointer(), 0.0 );
+
+  typedef itk::SqrtImageFilter< FloatImageType, FloatImageType > SqrtType;
+  SqrtType::Pointer sqrt = SqrtType::New();
+  sqrt->SetInput( float1 );
+  passed &= itk::Testing::CompareInstructionSets( "Sqrt", sqrt.GetPointer(), 1.0e-6 );
+
+  typedef itk::ExpImageFilter< FloatImageType, FloatImageType > ExpType;
+  ExpType::Pointer exp = ExpType::New();
+  exp->SetInput( float3 );
+  passed &= itk::Testing::CompareInstructionSets( "Exp", exp.GetPointer(), 1.0e-6 );
+
+  typedef itk::LogImageFilter< FloatImageType, FloatImageType > LogType;
+  LogType::Pointer log = LogType::New();
+  log->SetInput( float1 );
+  passed &= itk::Testing::CompareInstructionSets( "Log", log.GetPointer(), 1.0e-6 );
+
+  typedef itk::ClampImageFilter< FloatImageType, ShortImageType > ClampType;
+  ClampType::Pointer clamp = ClampType::New();
+  clamp->SetInput( float3 );
+  clamp->SetBounds( -5, 5 );
+  passed &= itk::Testing::CompareInstructionSets( "ClampFloatToShort", clamp.GetPointer(), 0.0 );
+
+  // a multiply-add may be contracted, and rounded differently
+  typedef itk::IntensityWindowingImageFilter< ShortImageType, UCharImageType > WindowingType;
+  WindowingType::Pointer windowing = WindowingType::New();
+  windowing->SetInput( short1 );
+  windowing->SetWindowMinimum( -1000 );
+  windowing->SetWindowMaximum( 1000 );
+  windowing->SetOutputMinimum( 0 );
+  windowing->SetOutputMaximum( 255 );
+  passed &= itk::Testing::CompareInstructionSets( "WindowingShortToUChar", windowing.GetPointer(), 1.0 );
+
+  typedef itk::TernaryAddImageFilter< FloatImageType, FloatImageType, FloatImageType, FloatImageType > TernaryAddType;
+  TernaryAddType::Pointer ternaryAdd = TernaryAddType::New();
+  ternaryAdd->SetInput1( float1 );
+  ternaryAdd->SetInput2( float2 );
+  ternaryAdd->SetInput3( float3 );
+  passed &= itk::Testing::CompareInstructionSets( "TernaryAdd", ternaryAdd.GetPointer(), 1.0e-6 );
+
+  // a requested region smaller than the buffers: the scanlines do not
+  // start at the beginning of the buffer lines
+  FloatImageType::RegionType region = float1->GetLargestPossibleRegion();
+  region.SetIndex( 0, 5 );
+  region.SetSize( 0, 200 );
+  region.SetIndex( 1, 3 );
+  region.SetSize( 1, 100 );
+  AddType::Pointer addRegion = AddType::New();
+  addRegion->SetInput1( float1 );
+  addRegion->SetInput2( float2 );
+  addRegion->GetOutput()->SetRequestedRegion( region );
+  passed &= itk::Testing::CompareInstructionSets( "AddRequestedRegion", addRegion.GetPointer(), 0.0 );
+
+  // running in place: the output is the first input
+  itk::SIMDInstructionSet::SetMaximumInstructionSet( itk::SIMDInstructionSet::Scalar );
+  add->SetInput1( float1 );
+  add->Update();
+  FloatImageType::Pointer expected = add->GetOutput();
+  expected->DisconnectPipeline();
+  itk::SIMDInstructionSet::SetMaximumInstructionSet( itk::SIMDInstructionSet::AVX512 );
+  AddType::Pointer addInPlace = AddType::New();
+  addInPlace->SetInput1( float1 );
+  addInPlace->SetInput2( float2 );
+  addInPlace->InPlaceOn();
+  const float *inputBuffer = float1->GetBufferPointer();
+  addInPlace->Update();
+  FloatImageType::Pointer inPlaceOutput = addInPlace->GetOutput();
+  if( inPlaceOutput->GetBufferPointer() != inputBuffer )
+    {
+    std::cerr << "Add did not run in place" << std::endl;
+    passed = false;
+    }
+  itk::ImageRegionConstIterator< FloatImageType > eit( expected, expected->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< FloatImageType > iit( inPlaceOutput, expected->GetBufferedRegion() );
+  for( ; !eit.IsAtEnd(); ++eit, ++iit )
+    {
+    if( iit.Get() != eit.Get() )
+      {
+      std::cerr << "In place Add: expected " << eit.Get() << " at " << eit.GetIndex()
+                << " but got " << iit.Get() << std::endl;
+      passed = false;
+      break;
+      }
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
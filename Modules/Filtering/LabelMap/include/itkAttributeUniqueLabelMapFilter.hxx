@@ -21,6 +21,7 @@
 #include "itkAttributeUniqueLabelMapFilter.h"
 #include "itkProgressReporter.h"
 #include  <queue>
+#include  <deque>
 
 namespace itk {
 
@@ -30,6 +30,15 @@ namespace itk
  * LabelImageToLabelMapFilter converts a label image to a label collection image.
  * The labels are the same in the input and the output image.
  *
+ * Each thread finds the objects of its runs through a dense label to object
+ * index when the labels are small enough non negative integers, instead of
+ * searching them in the label map. The index is kept about as small as the
+ * label map, so that sparse labels are still searched in the label map.
+ * The lines found by the threads are then appended to the objects of the
+ * output with a single allocation per object and per thread. The storage
+ * of the LabelMap itself, a std::map of objects whose lines are in a
+ * std::deque, is unchanged.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * This implementation was taken from the Insight Journal paper:
@@ -22,6 +22,7 @@
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 #include "itkImageLinearConstIteratorWithIndex.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -90,6 +91,17 @@ LabelImageToLabelMapFilter< TInputImage, TOutputImage >
 {
   ProgressReporter progress( this, threadId, regionForThread.GetNumberOfPixels() );
 
+  OutputImageType *image = m_TemporaryImages[threadId];
+
+  // the dense index of the objects of the thread. It only grows while it
+  // has at most 8 entries per object of the thread, or 1024 entries, so
+  // that it takes no more memory than the nodes of the label map; the
+  // objects of the other labels are found in the label map.
+  typedef typename LabelObjectType::SizeValueType SizeValueType;
+  const SizeValueType minimumIndexSize = 1024;
+  const SizeValueType entriesPerObject = 8;
+  std::vector< LabelObjectType * > labelObjects;
+
   typedef ImageLinearConstIteratorWithIndex< InputImageType > InputLineIteratorType;
   InputLineIteratorType it(this->GetInput(), regionForThread);
   it.SetDirection(0);
@@ -115,7 +127,41 @@ LabelImageToLabelMapFilter< TInputImage, TOutputImage >
           ++it;
           }
         // create the run length object to go in the vector
-        m_TemporaryImages[threadId]->SetLine(idx, length, value);
+        const OutputImagePixelType label = static_cast< OutputImagePixelType >( value );
+        const bool indexable = NumericTraits< OutputImagePixelType >::is_integer
+                               && NumericTraits< OutputImagePixelType >::IsNonnegative(label)
+                               && label != m_BackgroundValue;
+        const SizeValueType l = indexable ? static_cast< SizeValueType >( label ) : 0;
+        if ( indexable
+             && ( l < labelObjects.size()
+                  || l < std::max( minimumIndexSize, entriesPerObject * ( image->GetNumberOfLabelObjects() + 1 ) ) ) )
+          {
+          if ( l >= labelObjects.size() )
+            {
+            labelObjects.resize(l + 1, ITK_NULLPTR);
+            }
+          if ( labelObjects[l] == ITK_NULLPTR )
+            {
+            // the object may have been added before the index was large
+            // enough for its label
+            if ( image->HasLabel(label) )
+              {
+              labelObjects[l] = image->GetLabelObject(label);
+              }
+            else
+              {
+              typename LabelObjectType::Pointer labelObject = LabelObjectType::New();
+              labelObject->SetLabel(label);
+              image->AddLabelObject(labelObject);
+              labelObjects[l] = labelObject;
+              }
+            }
+          labelObjects[l]->AddLine(idx, length);
+          }
+        else
+          {
+          image->SetLine(idx, length, label);
+          }
         }
       else
         {
@@ -146,6 +192,7 @@ LabelImageToLabelMapFilter< TInputImage, TOutputImage >
         {
         // merge the lines in the output's object
         LabelObjectType * lo = output->GetLabelObject( labelObject->GetLabel() );
+        lo->ReserveLines( lo->GetNumberOfLines() + labelObject->GetNumberOfLines() );
         typename LabelObjectType::ConstLineIterator lit( labelObject );
         while( ! lit.IsAtEnd() )
           {
@@ -30,6 +30,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkFastMutexLock.h"
+#include <vector>
 
 namespace itk
 {
@@ -42,6 +43,11 @@ namespace itk
  * With that class, the developer doesn't need to take care of iterating over all the objects in
  * the image, or to manage by hand the threads.
  *
+ * The objects are given to the threads by blocks, the largest objects first. The
+ * blocks shrink as the remaining number of pixels decreases, so that the threads
+ * end at about the same time even when a few objects are much larger than the
+ * others, without locking a mutex for each object.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * This implementation was taken from the Insight Journal paper:
@@ -124,7 +130,17 @@ private:
   LabelMapFilter(const Self &); //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
-  typename InputImageType::Iterator m_LabelObjectIterator;
+  /** The objects to process, the largest first, and the sums of their
+   * costs: m_CumulatedCosts[i] is the cost of the i first objects. */
+  std::vector< LabelObjectType * > m_LabelObjects;
+  std::vector< SizeValueType >     m_CumulatedCosts;
+
+  typedef std::pair< SizeValueType, LabelObjectType * > CostAndLabelObjectType;
+  static bool HasGreaterCost(const CostAndLabelObjectType & a, const CostAndLabelObjectType & b)
+  {
+    return a.first > b.first;
+  }
+
   float                             m_InverseNumberOfLabelObjects;
   SizeValueType                     m_NumberOfLabelObjectsProcessed;
 };
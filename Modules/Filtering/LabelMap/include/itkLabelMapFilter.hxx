@@ -29,6 +29,7 @@
 #define itkLabelMapFilter_hxx
 #include "itkLabelMapFilter.h"
 #include "itkMutexLockHolder.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -76,9 +77,31 @@ void
 LabelMapFilter< TInputImage, TOutputImage >
 ::BeforeThreadedGenerateData()
 {
-  // initialize the iterator
-  m_LabelObjectIterator =  typename InputImageType::Iterator(this->GetLabelMap());
-//  m_LabelObjectIterator = typename InputImageType::Iterator(this->GetLabelMap());
+  // list the objects, with their number of pixels as an estimation of the
+  // cost of their processing
+  std::vector< CostAndLabelObjectType > costs;
+  costs.reserve( this->GetLabelMap()->GetNumberOfLabelObjects() );
+  for ( typename InputImageType::Iterator it( this->GetLabelMap() ); !it.IsAtEnd(); ++it )
+    {
+    LabelObjectType *labelObject = it.GetLabelObject();
+    costs.push_back( CostAndLabelObjectType( labelObject->Size() + 1, labelObject ) );
+    }
+
+  // process the largest objects first, so the small ones can fill the gaps
+  // at the end. The objects of the same size are kept in label order.
+  if ( this->GetNumberOfThreads() > 1 )
+    {
+    std::stable_sort( costs.begin(), costs.end(), HasGreaterCost );
+    }
+
+  m_LabelObjects.resize( costs.size() );
+  m_CumulatedCosts.resize( costs.size() + 1 );
+  m_CumulatedCosts[0] = 0;
+  for ( SizeValueType i = 0; i < costs.size(); i++ )
+    {
+    m_LabelObjects[i] = costs[i].second;
+    m_CumulatedCosts[i + 1] = m_CumulatedCosts[i] + costs[i].first;
+    }
 
   // and the mutex
   m_LabelObjectContainerLock = FastMutexLock::New();
@@ -92,6 +115,9 @@ void
 LabelMapFilter< TInputImage, TOutputImage >
 ::AfterThreadedGenerateData()
 {
+  m_LabelObjects.clear();
+  m_CumulatedCosts.clear();
+
   this->UpdateProgress(1.0);
 }
 
@@ -100,51 +126,59 @@ void
 LabelMapFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData( const OutputImageRegionType &, ThreadIdType threadId )
 {
+  const SizeValueType numberOfLabelObjects = m_LabelObjects.size();
+  const SizeValueType numberOfBlocksPerThread = 4;
+  const SizeValueType numberOfThreads = this->GetNumberOfThreads();
+
   while ( true )
     {
-    LabelObjectType *labelObject;
+    SizeValueType begin;
+    SizeValueType end;
     // begin mutex lock
     {
     MutexLockHolder< FastMutexLock > lock(*m_LabelObjectContainerLock );
 
-    if ( m_LabelObjectIterator.IsAtEnd() )
+    if ( m_NumberOfLabelObjectsProcessed >= numberOfLabelObjects )
       {
       // mutex lock holder deleted
       return;
       }
 
-    // get the label object
-    labelObject = m_LabelObjectIterator.GetLabelObject();
-
-    // increment the iterator now, so it will not be invalidated if the object
-    // is destroyed
-    ++m_LabelObjectIterator;
-    ++m_NumberOfLabelObjectsProcessed;
-
-    // unlock the mutex, so the other threads can get an object
+    // take the objects up to a fraction of the remaining cost, and at
+    // least one object
+    begin = m_NumberOfLabelObjectsProcessed;
+    const SizeValueType remainingCost = m_CumulatedCosts[numberOfLabelObjects] - m_CumulatedCosts[begin];
+    const SizeValueType blockCost = remainingCost / ( numberOfBlocksPerThread * numberOfThreads );
+    end = std::upper_bound( m_CumulatedCosts.begin() + begin + 1, m_CumulatedCosts.end(),
+                            m_CumulatedCosts[begin] + blockCost ) - m_CumulatedCosts.begin() - 1;
+    end = std::max( end, begin + 1 );
+    m_NumberOfLabelObjectsProcessed = end;
+
+    // unlock the mutex, so the other threads can get some objects
     }
     // end mutex lock
 
-
-    // and run the user defined method for that object
-    this->ThreadedProcessLabelObject(labelObject);
-
-    if (threadId==0)
+    for ( SizeValueType i = begin; i < end; i++ )
       {
-      const float progress = m_InverseNumberOfLabelObjects*m_NumberOfLabelObjectsProcessed;
-      this->UpdateProgress(progress);
+      // run the user defined method for that object
+      this->ThreadedProcessLabelObject( m_LabelObjects[i] );
+
+      // all threads needs to check the abort flag
+      if ( this->GetAbortGenerateData() )
+        {
+        std::string    msg;
+        ProcessAborted e(__FILE__, __LINE__);
+        msg += "Object " + std::string(this->GetNameOfClass() ) + ": AbortGenerateDataOn";
+        e.SetDescription(msg);
+        throw e;
+        }
       }
 
-    // all threads needs to check the abort flag
-    if ( this->GetAbortGenerateData() )
+    if (threadId==0)
       {
-      std::string    msg;
-      ProcessAborted e(__FILE__, __LINE__);
-      msg += "Object " + std::string(this->GetNameOfClass() ) + ": AbortGenerateDataOn";
-      e.SetDescription(msg);
-      throw e;
+      const float progress = m_InverseNumberOfLabelObjects*end;
+      this->UpdateProgress(progress);
       }
-
     }
 }
 
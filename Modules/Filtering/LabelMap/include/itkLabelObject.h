@@ -18,7 +18,7 @@
 #ifndef itkLabelObject_h
 #define itkLabelObject_h
 
-#include <deque>
+#include <vector>
 #include "itkLightObject.h"
 #include "itkLabelObjectLine.h"
 #include "itkWeakPointer.h"
@@ -33,7 +33,9 @@ namespace itk
  * It should be used associated with the LabelMap.
  *
  * LabelObject store mainly 2 things: the label of the object, and a set of lines
- * which are part of the object.
+ * which are part of the object. The lines are stored contiguously, so they are
+ * cheap to iterate; ReserveLines() avoids the reallocations when the number of
+ * lines is known before they are added.
  * No attribute is available in that class, so this class can be used as a base class
  * to implement a label object with attribute, or when no attribute is needed (see the
  * reconstruction filters for an example. If a simple attribute is needed,
@@ -129,6 +131,13 @@ public:
    */
   void AddLine(const LineType & line);
 
+  /**
+   * Allocate the memory for the given number of lines, so that the lines
+   * can be added without reallocation. The lines already in the object are
+   * kept.
+   */
+  void ReserveLines(SizeValueType numberOfLines);
+
   SizeValueType GetNumberOfLines() const;
 
   const LineType & GetLine(SizeValueType i) const;
@@ -243,7 +252,7 @@ public:
     }
 
   private:
-    typedef typename std::deque< LineType >            LineContainerType;
+    typedef typename std::vector< LineType >           LineContainerType;
     typedef typename LineContainerType::const_iterator InternalIteratorType;
     InternalIteratorType m_Iterator;
     InternalIteratorType m_Begin;
@@ -338,7 +347,7 @@ public:
 
   private:
 
-    typedef typename std::deque< LineType >            LineContainerType;
+    typedef typename std::vector< LineType >           LineContainerType;
     typedef typename LineContainerType::const_iterator InternalIteratorType;
     void NextValidLine()
     {
@@ -367,7 +376,7 @@ private:
   LabelObject(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
-  typedef typename std::deque< LineType >    LineContainerType;
+  typedef typename std::vector< LineType >   LineContainerType;
 
   LineContainerType m_LineContainer;
   LabelType         m_Label;
@@ -200,6 +200,14 @@ LabelObject< TLabel, VImageDimension >
   m_LineContainer.push_back(line);
 }
 
+template< typename TLabel, unsigned int VImageDimension >
+void
+LabelObject< TLabel, VImageDimension >
+::ReserveLines(SizeValueType numberOfLines)
+{
+  m_LineContainer.reserve(numberOfLines);
+}
+
 template< typename TLabel, unsigned int VImageDimension >
 typename LabelObject< TLabel, VImageDimension >::SizeValueType
 LabelObject< TLabel, VImageDimension >
@@ -310,9 +318,11 @@ LabelObject< TLabel, VImageDimension >
 {
   if ( !m_LineContainer.empty() )
     {
-    // first copy the lines in another container and clear the current one
-    LineContainerType lineContainer = m_LineContainer;
-    m_LineContainer.clear();
+    // first move the lines in another container, without copying them,
+    // and make room for the optimized lines in the current one
+    LineContainerType lineContainer;
+    lineContainer.swap(m_LineContainer);
+    m_LineContainer.reserve(lineContainer.size());
 
     // reorder the lines
     typename Functor::LabelObjectLineComparator< LineType > comparator;
@@ -115,7 +115,8 @@ public:
   itkGetConstReferenceMacro(ComputePerimeter, bool);
   itkBooleanMacro(ComputePerimeter);
 
-  /** Set the label image */
+  /** Set the label image. The label image is not needed anymore to compute
+   * the Feret diameter, which is now computed from the lines of the objects. */
   void SetLabelImage(const TLabelImage *input)
   {
     m_LabelImage = input;
@@ -142,6 +143,60 @@ private:
   LabelImageConstPointer m_LabelImage;
 
   void ComputeFeretDiameter(LabelObjectType *labelObject);
+
+  typedef std::vector< IndexType > IndexVectorType;
+
+  /** Orders the indexes by slice, then by the coordinates a and b inside
+   * the slices, where the slices are the planes of dimensions a and b. */
+  class SliceIndexCompare
+  {
+  public:
+    SliceIndexCompare(unsigned int a, unsigned int b): m_A(a), m_B(b) {}
+
+    bool InSameSlice(const IndexType & i1, const IndexType & i2) const
+    {
+      for ( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        if ( i != m_A && i != m_B && i1[i] != i2[i] )
+          {
+          return false;
+          }
+        }
+      return true;
+    }
+
+    bool operator()(const IndexType & i1, const IndexType & i2) const
+    {
+      for ( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        if ( i != m_A && i != m_B && i1[i] != i2[i] )
+          {
+          return i1[i] < i2[i];
+          }
+        }
+      if ( i1[m_A] != i2[m_A] )
+        {
+        return i1[m_A] < i2[m_A];
+        }
+      return i1[m_B] < i2[m_B];
+    }
+
+  private:
+    unsigned int m_A;
+    unsigned int m_B;
+  };
+
+  /** The z coordinate of the cross product of (i1 - i0) and (i2 - i0) in
+   * the plane of the dimensions a and b. */
+  static OffsetValueType Cross(const IndexType & i0, const IndexType & i1, const IndexType & i2,
+                               unsigned int a, unsigned int b)
+  {
+    return ( i1[a] - i0[a] ) * ( i2[b] - i0[b] ) - ( i1[b] - i0[b] ) * ( i2[a] - i0[a] );
+  }
+
+  /** Removes the indexes which are not vertices of the convex hull of the
+   * indexes of their slice, in the planes of the dimensions a and b. */
+  static void KeepSliceConvexHullVertices(IndexVectorType & idxList, unsigned int a, unsigned int b);
   void ComputePerimeter(LabelObjectType *labelObject);
 
   typedef itk::Offset<2>                                                          Offset2Type;
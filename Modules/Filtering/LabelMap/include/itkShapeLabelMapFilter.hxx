@@ -29,6 +29,7 @@
 #include "vnl/algo/vnl_real_eigensystem.h"
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 #include "vnl/vnl_math.h"
+#include <algorithm>
 #include <deque>
 #include <map>
 
@@ -48,22 +49,6 @@ ShapeLabelMapFilter< TImage, TLabelImage >
 ::BeforeThreadedGenerateData()
 {
   Superclass::BeforeThreadedGenerateData();
-
-  // Generate the label image, if needed
-  if ( m_ComputeFeretDiameter )
-    {
-    if ( !m_LabelImage )
-      {
-      // generate an image of the labelized image
-      typedef LabelMapToLabelImageFilter< TImage, LabelImageType > LCI2IType;
-      typename LCI2IType::Pointer lci2i = LCI2IType::New();
-      lci2i->SetInput( this->GetOutput() );
-      // Respect the number of threads of the filter
-      lci2i->SetNumberOfThreads( this->GetNumberOfThreads() );
-      lci2i->Update();
-      m_LabelImage = lci2i->GetOutput();
-      }
-    }
 }
 
 template< typename TImage, typename TLabelImage >
@@ -387,40 +372,31 @@ void
 ShapeLabelMapFilter< TImage, TLabelImage >
 ::ComputeFeretDiameter(LabelObjectType *labelObject)
 {
-  const LabelPixelType & label = labelObject->GetLabel();
-
-  typedef typename std::deque< IndexType > IndexListType;
-  IndexListType idxList;
-
-  typedef typename itk::ConstNeighborhoodIterator< LabelImageType > NeighborIteratorType;
-  SizeType neighborHoodRadius;
-  neighborHoodRadius.Fill(1);
-  NeighborIteratorType                        it( neighborHoodRadius, m_LabelImage, m_LabelImage->GetBufferedRegion() );
-  ConstantBoundaryCondition< LabelImageType > lcbc;
-  // Use label + 1 to have a label different of the current label on the border
-  lcbc.SetConstant(label + 1);
-  it.OverrideBoundaryCondition(&lcbc);
-  it.GoToBegin();
-
-  typedef typename NeighborIteratorType::NeighborIndexType   NeighborIndexType;
-
-  // Iterate over all the indexes
-  typename LabelObjectType::ConstIndexIterator iit( labelObject );
-  while( ! iit.IsAtEnd() )
+  // The two farthest pixels of the object are vertices of its convex hull.
+  // A pixel inside a line lies between the two ends of the line, so only
+  // the ends of the lines can be vertices of the convex hull.
+  IndexVectorType idxList;
+  idxList.reserve( 2 * labelObject->GetNumberOfLines() );
+  typename LabelObjectType::ConstLineIterator lit( labelObject );
+  while( ! lit.IsAtEnd() )
     {
-    // Move the iterator to the new location
-    it += iit.GetIndex() - it.GetIndex();
+    IndexType idx = lit.GetLine().GetIndex();
+    idxList.push_back( idx );
+    idx[0] += lit.GetLine().GetLength() - 1;
+    idxList.push_back( idx );
+    ++lit;
+    }
 
-    // Push the pixel in the list if it is on the border of the object
-    for ( NeighborIndexType i = 0; i < it.Size(); i++ )
+  // A vertex of the convex hull of the object is also a vertex of the convex
+  // hull of any subset which contains it, and in particular of the points
+  // of a 2D slice of the image. The points which are not on the convex hull
+  // of their slice are removed, slice orientation after slice orientation.
+  for ( unsigned int a = 0; a + 1 < ImageDimension; a++ )
+    {
+    for ( unsigned int b = a + 1; b < ImageDimension; b++ )
       {
-      if ( it.GetPixel(i) != label )
-        {
-        idxList.push_back( iit.GetIndex() );
-        break;
-        }
+      KeepSliceConvexHullVertices( idxList, a, b );
       }
-    ++iit;
     }
 
   ImageType *output = this->GetOutput();
@@ -429,19 +405,19 @@ ShapeLabelMapFilter< TImage, TLabelImage >
 
   // We can now search the feret diameter
   double feretDiameter = 0;
-  for ( typename IndexListType::const_iterator iIt1 = idxList.begin();
+  for ( typename IndexVectorType::const_iterator iIt1 = idxList.begin();
         iIt1 != idxList.end();
         iIt1++ )
     {
-    typename IndexListType::const_iterator iIt2 = iIt1;
+    typename IndexVectorType::const_iterator iIt2 = iIt1;
     for ( iIt2++; iIt2 != idxList.end(); iIt2++ )
       {
       // Compute the length between the 2 indexes
       double length = 0;
       for ( unsigned int i = 0; i < ImageDimension; i++ )
         {
-        const OffsetValueType indexDifference = ( iIt1->operator[](i) - iIt2->operator[](i) );
-        length += std::pow(indexDifference * spacing[i], 2);
+        const double difference = ( iIt1->operator[](i) - iIt2->operator[](i) ) * spacing[i];
+        length += difference * difference;
         }
       if ( feretDiameter < length )
         {
@@ -456,13 +432,75 @@ ShapeLabelMapFilter< TImage, TLabelImage >
   labelObject->SetFeretDiameter(feretDiameter);
 }
 
+template< typename TImage, typename TLabelImage >
+void
+ShapeLabelMapFilter< TImage, TLabelImage >
+::KeepSliceConvexHullVertices(IndexVectorType & idxList, unsigned int a, unsigned int b)
+{
+  // sort the points by slice, and by the a and b coordinates in the slices
+  SliceIndexCompare compare( a, b );
+  std::sort( idxList.begin(), idxList.end(), compare );
+  idxList.erase( std::unique( idxList.begin(), idxList.end() ), idxList.end() );
+
+  IndexVectorType vertices;
+  vertices.reserve( idxList.size() );
+  IndexVectorType hull;
+  typename IndexVectorType::const_iterator first = idxList.begin();
+  while ( first != idxList.end() )
+    {
+    typename IndexVectorType::const_iterator last = first;
+    while ( last != idxList.end() && compare.InSameSlice( *first, *last ) )
+      {
+      ++last;
+      }
+
+    const SizeValueType n = last - first;
+    if ( n <= 2 )
+      {
+      vertices.insert( vertices.end(), first, last );
+      }
+    else
+      {
+      // Andrew's monotone chain: lower hull, then upper hull. The
+      // collinear points are not kept.
+      hull.resize( 2 * n );
+      SizeValueType k = 0;
+      for ( typename IndexVectorType::const_iterator it = first; it != last; ++it )
+        {
+        while ( k >= 2 && Cross( hull[k - 2], hull[k - 1], *it, a, b ) <= 0 )
+          {
+          --k;
+          }
+        hull[k++] = *it;
+        }
+      const SizeValueType lower = k + 1;
+      for ( typename IndexVectorType::const_iterator it = last - 2; ; --it )
+        {
+        while ( k >= lower && Cross( hull[k - 2], hull[k - 1], *it, a, b ) <= 0 )
+          {
+          --k;
+          }
+        hull[k++] = *it;
+        if ( it == first )
+          {
+          break;
+          }
+        }
+      // the first point is at both ends of the hull
+      vertices.insert( vertices.end(), hull.begin(), hull.begin() + ( k - 1 ) );
+      }
+    first = last;
+    }
+  idxList.swap( vertices );
+}
+
 template< typename TImage, typename TLabelImage >
 void
 ShapeLabelMapFilter< TImage, TLabelImage >
 ::ComputePerimeter(LabelObjectType *labelObject)
 {
   // store the lines in a N-1D image of vectors
-  typedef std::deque< typename LabelObjectType::LineType > VectorLineType;
+  typedef std::vector< typename LabelObjectType::LineType > VectorLineType;
   typedef itk::Image< VectorLineType, ImageDimension - 1 > LineImageType;
   typename LineImageType::Pointer lineImage = LineImageType::New();
   typename LineImageType::IndexType lIdx;
@@ -511,33 +549,29 @@ ShapeLabelMapFilter< TImage, TLabelImage >
   typedef ConstShapedNeighborhoodIterator< LineImageType > LineImageIteratorType;
   LineImageIteratorType lIt( lSize, lineImage, lRegion ); // the original, non padded region
   setConnectivity( &lIt, true );
+
+  // the intercepts are counted for each neighbor, and stored in the map
+  // at the end, rather than searched in the map for each line
+  SizeValueType              axisIntercepts = 0;
+  std::vector< SizeValueType > neighborIntercepts( lIt.GetActiveIndexListSize(), 0 );
+  std::vector< SizeValueType > diagonalIntercepts( lIt.GetActiveIndexListSize(), 0 );
+
   for( lIt.GoToBegin(); !lIt.IsAtEnd(); ++lIt )
     {
     const VectorLineType & ls = lIt.GetCenterPixel();
 
     // there are two intercepts on the 0 axis for each line
-    OffsetType no;
-    no.Fill(0);
-    no[0] = 1;
-    // std::cout << no << "-> " << 2 * ls.size() << std::endl;
-    intercepts[no] += 2 * ls.size();
+    axisIntercepts += 2 * ls.size();
 
     // and look at the neighbors
     typename LineImageIteratorType::ConstIterator ci;
-    for (ci = lIt.Begin(); ci != lIt.End(); ci++)
+    SizeValueType n = 0;
+    for (ci = lIt.Begin(); ci != lIt.End(); ci++, n++)
       {
-          // std::cout << "-------------" << std::endl;
       // the vector of lines in the neighbor
       const VectorLineType & ns = ci.Get();
-      // prepare the offset to be stored in the intercepts map
-      typename LineImageType::OffsetType lno = ci.GetNeighborhoodOffset();
-      no[0] = 0;
-      for( int i=0; i<ImageDimension-1; i++ )
-        {
-        no[i+1] = vnl_math_abs(lno[i]);
-        }
-      OffsetType dno = no; // offset for the diagonal
-      dno[0] = 1;
+      SizeValueType & neighborCount = neighborIntercepts[n];
+      SizeValueType & diagonalCount = diagonalIntercepts[n];
 
       // now process the two lines to search the pixels on the contour of the object
       if( ls.empty() )
@@ -553,9 +587,9 @@ ShapeLabelMapFilter< TImage, TLabelImage >
           // std::cout << "ns.empty()" << std::endl;
           const typename LabelObjectType::LineType & l = *li;
           // add as much intercepts as the line size
-          intercepts[no] += l.GetLength();
+          neighborCount += l.GetLength();
           // and 2 times as much diagonal intercepts as the line size
-          intercepts[dno] += l.GetLength() * 2;
+          diagonalCount += l.GetLength() * 2;
           }
         }
       else
@@ -580,7 +614,7 @@ ShapeLabelMapFilter< TImage, TLabelImage >
           lMax = lMin + li->GetLength() - 1;
 
           // add as much intercepts as intersections of the 2 lines
-          intercepts[no] += vnl_math_max( lZero, vnl_math_min(lMax, nMax) - vnl_math_max(lMin, nMin) + 1 );
+          neighborCount += vnl_math_max( lZero, vnl_math_min(lMax, nMax) - vnl_math_max(lMin, nMin) + 1 );
           // std::cout << "============" << std::endl;
           // std::cout << "  lMin:" << lMin << " lMax:" << lMax << " nMin:" << nMin << " nMax:" << nMax;
           // std::cout << " count: " << vnl_math_max( 0l, vnl_math_min(lMax, nMax) - vnl_math_max(lMin, nMin) + 1 ) << std::endl;
@@ -588,9 +622,9 @@ ShapeLabelMapFilter< TImage, TLabelImage >
           // std::cout << vnl_math_max( lZero, vnl_math_min(lMax, nMax+1) - vnl_math_max(lMin, nMin+1) + 1 ) << std::endl;
           // std::cout << vnl_math_max( lZero, vnl_math_min(lMax, nMax-1) - vnl_math_max(lMin, nMin-1) + 1 ) << std::endl;
           // left diagonal intercepts
-          intercepts[dno] += vnl_math_max( lZero, vnl_math_min(lMax, nMax+1) - vnl_math_max(lMin, nMin+1) + 1 );
+          diagonalCount += vnl_math_max( lZero, vnl_math_min(lMax, nMax+1) - vnl_math_max(lMin, nMin+1) + 1 );
           // right diagonal intercepts
-          intercepts[dno] += vnl_math_max( lZero, vnl_math_min(lMax, nMax-1) - vnl_math_max(lMin, nMin-1) + 1 );
+          diagonalCount += vnl_math_max( lZero, vnl_math_min(lMax, nMax-1) - vnl_math_max(lMin, nMin-1) + 1 );
 
           // go to the next line or the next neighbor depending on where we are
           if(nMax <= lMax )
@@ -619,6 +653,28 @@ ShapeLabelMapFilter< TImage, TLabelImage >
       }
     }
 
+  // store the counts in the intercepts map
+  OffsetType no;
+  no.Fill(0);
+  no[0] = 1;
+  intercepts[no] += axisIntercepts;
+  typename LineImageIteratorType::ConstIterator ci;
+  SizeValueType n = 0;
+  for (ci = lIt.Begin(); ci != lIt.End(); ci++, n++)
+    {
+    // prepare the offset to be stored in the intercepts map
+    typename LineImageType::OffsetType lno = ci.GetNeighborhoodOffset();
+    no[0] = 0;
+    for( int i=0; i<ImageDimension-1; i++ )
+      {
+      no[i+1] = vnl_math_abs(lno[i]);
+      }
+    OffsetType dno = no; // offset for the diagonal
+    dno[0] = 1;
+    intercepts[no] += neighborIntercepts[n];
+    intercepts[dno] += diagonalIntercepts[n];
+    }
+
   // compute the perimeter based on the intercept counts
   double perimeter = PerimeterFromInterceptCount( intercepts, this->GetOutput()->GetSpacing() );
   labelObject->SetPerimeter( perimeter );
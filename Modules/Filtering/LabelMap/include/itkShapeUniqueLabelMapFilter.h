@@ -22,6 +22,7 @@
 #include "itkShapeLabelObjectAccessors.h"
 #include "itkProgressReporter.h"
 #include <queue>
+#include <deque>
 
 namespace itk
 {
@@ -0,0 +1,169 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+
+typedef itk::Image< unsigned short, Dimension >           ImageType;
+typedef itk::LabelObject< unsigned short, Dimension >     LabelObjectType;
+typedef itk::LabelMap< LabelObjectType >                  LabelMapType;
+typedef itk::LabelImageToLabelMapFilter< ImageType, LabelMapType > FilterType;
+
+/** Builds the label map line by line, in raster order, with SetLine(). */
+LabelMapType::Pointer CreateReference( const ImageType *image, unsigned short background )
+{
+  LabelMapType::Pointer map = LabelMapType::New();
+  map->SetBackgroundValue( background );
+  itk::ImageLinearConstIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  it.SetDirection( 0 );
+  for( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+    {
+    while( !it.IsAtEndOfLine() )
+      {
+      const unsigned short value = it.Get();
+      const ImageType::IndexType index = it.GetIndex();
+      LabelMapType::LengthType length = 0;
+      while( !it.IsAtEndOfLine() && it.Get() == value )
+        {
+        ++length;
+        ++it;
+        }
+      map->SetLine( index, length, value );
+      }
+    }
+  return map;
+}
+
+/** Checks that the label map has the same objects as the reference, with
+ * the same lines in the same order. */
+bool CompareLabelMaps( const LabelMapType *map, const LabelMapType *reference, itk::ThreadIdType numberOfThreads )
+{
+  if( map->GetNumberOfLabelObjects() != reference->GetNumberOfLabelObjects() )
+    {
+    std::cerr << numberOfThreads << " threads: " << map->GetNumberOfLabelObjects() << " objects instead of "
+              << reference->GetNumberOfLabelObjects() << std::endl;
+    return false;
+    }
+  LabelMapType::ConstIterator it( map );
+  LabelMapType::ConstIterator rit( reference );
+  for( ; !rit.IsAtEnd(); ++it, ++rit )
+    {
+    const LabelObjectType *labelObject = it.GetLabelObject();
+    const LabelObjectType *referenceObject = rit.GetLabelObject();
+    if( labelObject->GetLabel() != referenceObject->GetLabel()
+        || labelObject->GetNumberOfLines() != referenceObject->GetNumberOfLines() )
+      {
+      std::cerr << numberOfThreads << " threads: object " << labelObject->GetLabel() << " with "
+                << labelObject->GetNumberOfLines() << " lines instead of object " << referenceObject->GetLabel()
+                << " with " << referenceObject->GetNumberOfLines() << " lines" << std::endl;
+      return false;
+      }
+    for( LabelObjectType::SizeValueType i = 0; i < referenceObject->GetNumberOfLines(); ++i )
+      {
+      if( labelObject->GetLine( i ).GetIndex() != referenceObject->GetLine( i ).GetIndex()
+          || labelObject->GetLine( i ).GetLength() != referenceObject->GetLine( i ).GetLength() )
+        {
+        std::cerr << numberOfThreads << " threads: line " << i << " of object " << labelObject->GetLabel()
+                  << " starts at " << labelObject->GetLine( i ).GetIndex() << " instead of "
+                  << referenceObject->GetLine( i ).GetIndex() << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+}
+
+/** Checks that LabelImageToLabelMapFilter builds the same label objects,
+ * with their lines in raster order, whatever the number of threads, with
+ * close or sparse labels. */
+int itkLabelImageToLabelMapFilterTest2( int, char* [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  // blocks of labels cut by random runs, so that the objects have many
+  // lines spread over all the threads
+  ImageType::SizeType size;
+  size[0] = 120;
+  size[1] = 90;
+  size[2] = 70;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    unsigned short value = static_cast< unsigned short >( 1 + index[0] / 10 + 12 * ( index[1] / 15 ) + 72 * ( index[2] / 20 ) );
+    if( generator->GetIntegerVariate( 9 ) == 0 )
+      {
+      value = generator->GetIntegerVariate( 3 );
+      }
+    it.Set( value );
+    }
+
+  const unsigned short background = 0;
+  bool passed = true;
+  for( unsigned int sparse = 0; sparse < 2; ++sparse )
+    {
+    if( sparse )
+      {
+      // labels too far apart to be in the dense index of the objects
+      // until enough objects are found, so that some are first added to
+      // the label map
+      for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        if( it.Get() > 2 )
+          {
+          it.Set( static_cast< unsigned short >( it.Get() * 10 ) );
+          }
+        }
+      image->Modified();
+      }
+    LabelMapType::Pointer reference = CreateReference( image, background );
+
+    const itk::ThreadIdType numbersOfThreads[] = { 1, 2, 3, 8 };
+    for( unsigned int i = 0; i < 4; ++i )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( image );
+      filter->SetBackgroundValue( background );
+      filter->SetNumberOfThreads( numbersOfThreads[i] );
+      filter->Update();
+      passed &= CompareLabelMaps( filter->GetOutput(), reference, numbersOfThreads[i] );
+      }
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLabelImageToShapeLabelMapFilter.h"
+#include "itkImageFileReader.h"
+#include <cmath>
+
+namespace
+{
+
+/** Computes the shape attributes with one thread and with several threads,
+ * checks that the attributes are the same, and checks the Feret diameters
+ * against the largest distance between all the pixels of the objects. */
+template< typename TImage >
+bool CheckShapeAttributes( const char *name, TImage *image )
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+  typedef itk::LabelImageToShapeLabelMapFilter< TImage > FilterType;
+  typedef typename FilterType::OutputImageType           LabelMapType;
+  typedef typename LabelMapType::LabelObjectType         LabelObjectType;
+
+  typename LabelMapType::Pointer maps[2];
+  const itk::ThreadIdType numbersOfThreads[2] = { 1, 4 };
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    filter->ComputeFeretDiameterOn();
+    filter->ComputePerimeterOn();
+    filter->SetNumberOfThreads( numbersOfThreads[i] );
+    filter->Update();
+    maps[i] = filter->GetOutput();
+    maps[i]->DisconnectPipeline();
+    }
+
+  bool passed = true;
+  if( maps[0]->GetNumberOfLabelObjects() != maps[1]->GetNumberOfLabelObjects() )
+    {
+    std::cerr << name << ": " << maps[1]->GetNumberOfLabelObjects() << " objects instead of "
+              << maps[0]->GetNumberOfLabelObjects() << std::endl;
+    return false;
+    }
+  const typename TImage::SpacingType & spacing = image->GetSpacing();
+  for( unsigned int n = 0; n < maps[0]->GetNumberOfLabelObjects(); ++n )
+    {
+    const LabelObjectType *labelObject = maps[0]->GetNthLabelObject( n );
+    const LabelObjectType *threadedObject = maps[1]->GetNthLabelObject( n );
+    if( labelObject->GetNumberOfPixels() != threadedObject->GetNumberOfPixels()
+        || labelObject->GetFeretDiameter() != threadedObject->GetFeretDiameter()
+        || labelObject->GetPerimeter() != threadedObject->GetPerimeter()
+        || labelObject->GetCentroid() != threadedObject->GetCentroid() )
+      {
+      std::cerr << name << ": the attributes of object " << labelObject->GetLabel()
+                << " depend on the number of threads" << std::endl;
+      passed = false;
+      }
+
+    double feretDiameter = 0.0;
+    for( itk::SizeValueType i = 0; i < labelObject->Size(); ++i )
+      {
+      const typename TImage::IndexType i1 = labelObject->GetIndex( i );
+      for( itk::SizeValueType j = i + 1; j < labelObject->Size(); ++j )
+        {
+        const typename TImage::IndexType i2 = labelObject->GetIndex( j );
+        double length = 0.0;
+        for( unsigned int d = 0; d < Dimension; ++d )
+          {
+          const double difference = ( i1[d] - i2[d] ) * spacing[d];
+          length += difference * difference;
+          }
+        feretDiameter = std::max( feretDiameter, length );
+        }
+      }
+    feretDiameter = std::sqrt( feretDiameter );
+    if( std::abs( labelObject->GetFeretDiameter() - feretDiameter ) > 1e-9 * feretDiameter )
+      {
+      std::cerr << name << ": the Feret diameter of object " << labelObject->GetLabel() << " is "
+                << labelObject->GetFeretDiameter() << " instead of " << feretDiameter << std::endl;
+      passed = false;
+      }
+    }
+  return passed;
+}
+
+}
+
+/** Checks that the shape attributes do not depend on the number of
+ * threads, and that the Feret diameters computed from the convex hulls
+ * are the largest distances between the pixels of the objects. */
+int itkLabelImageToShapeLabelMapFilterTest2( int argc, char * argv[] )
+{
+  if( argc != 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " input" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Image< unsigned char, 2 >   ImageType;
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  reader->Update();
+
+  if( !CheckShapeAttributes( argv[1], reader->GetOutput() ) )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMedianHistogram_h
+#define itkMedianHistogram_h
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+
+#include <limits>
+#include <vector>
+
+namespace itk
+{
+namespace Function
+{
+/** \class MedianHistogram
+ * \brief Histogram of the pixels of a moving window which keeps track
+ * of their median.
+ *
+ * This histogram follows the interface of the RankHistogram of the
+ * moving histogram filters, for the median of integer pixels of at most
+ * 16 bits. It has one bin per pixel value, and a coarse bin per block
+ * of values, as in the constant time median filter of Perreault and
+ * Hebert. The median is moved from its previous value when the window
+ * changes, skipping whole blocks when their coarse bin allows it, so
+ * the cost per pixel does not depend on the size of the window.
+ *
+ * The median is the value which would be at the position N/2 of the N
+ * sorted pixels of the histogram, as given by std::nth_element.
+ *
+ * IsSupported is false for the other pixel types, for which the
+ * histogram does nothing.
+ *
+ * \sa MedianImageFilter
+ * \ingroup ITKSmoothing
+ */
+template< typename TInputPixel,
+          bool VIsSupported = std::numeric_limits< TInputPixel >::is_integer && sizeof( TInputPixel ) <= 2 >
+class MedianHistogram
+{
+public:
+  static const bool IsSupported = false;
+
+  void AddPixel(const TInputPixel &) {}
+
+  void RemovePixel(const TInputPixel &) {}
+
+  TInputPixel GetValue()
+  {
+    return TInputPixel();
+  }
+};
+
+/** \cond HIDE_SPECIALIZATION_DOCUMENTATION */
+template< typename TInputPixel >
+class MedianHistogram< TInputPixel, true >
+{
+public:
+  static const bool IsSupported = true;
+
+  MedianHistogram():
+    m_Bins(NumberOfBins, 0),
+    m_Blocks( ( NumberOfBins + BlockMask ) >> BlockShift, 0 ),
+    m_Median(0),
+    m_Below(0),
+    m_Entries(0)
+  {}
+
+  void AddPixel(const TInputPixel & p)
+  {
+    const SizeValueType bin = GetBin(p);
+
+    ++m_Bins[bin];
+    ++m_Blocks[bin >> BlockShift];
+    ++m_Entries;
+    if ( bin <= m_Median )
+      {
+      ++m_Below;
+      }
+  }
+
+  void RemovePixel(const TInputPixel & p)
+  {
+    const SizeValueType bin = GetBin(p);
+
+    itkAssertInDebugAndIgnoreInReleaseMacro( m_Bins[bin] > 0 );
+    --m_Bins[bin];
+    --m_Blocks[bin >> BlockShift];
+    --m_Entries;
+    if ( bin <= m_Median )
+      {
+      --m_Below;
+      }
+  }
+
+  /** Moves the median to the smallest bin such that at least N/2+1 of
+   * the pixels are in this bin or below. m_Below is the number of
+   * pixels in the bins up to m_Median included. */
+  TInputPixel GetValue()
+  {
+    itkAssertInDebugAndIgnoreInReleaseMacro( m_Entries > 0 );
+    const SizeValueType target = m_Entries / 2 + 1;
+
+    while ( m_Below < target )
+      {
+      const SizeValueType next = m_Median + 1;
+      if ( ( next & BlockMask ) == 0 && m_Below + m_Blocks[next >> BlockShift] < target )
+        {
+        m_Below += m_Blocks[next >> BlockShift];
+        m_Median = next + BlockMask;
+        }
+      else
+        {
+        m_Median = next;
+        m_Below += m_Bins[next];
+        }
+      }
+    while ( m_Below - m_Bins[m_Median] >= target )
+      {
+      m_Below -= m_Bins[m_Median];
+      if ( ( m_Median & BlockMask ) == 0 && m_Below - m_Blocks[( m_Median >> BlockShift ) - 1] >= target )
+        {
+        m_Below -= m_Blocks[( m_Median >> BlockShift ) - 1];
+        m_Median -= BlockMask + 2;
+        }
+      else
+        {
+        --m_Median;
+        }
+      }
+
+    return static_cast< TInputPixel >( static_cast< OffsetValueType >( m_Median )
+                                       + static_cast< OffsetValueType >( std::numeric_limits< TInputPixel >::min() ) );
+  }
+
+private:
+  typedef std::vector< SizeValueType > CountsType;
+
+  itkStaticConstMacro(NumberOfBins, SizeValueType,
+                      static_cast< SizeValueType >( static_cast< OffsetValueType >( std::numeric_limits< TInputPixel >::max() )
+                                                    - static_cast< OffsetValueType >( std::numeric_limits< TInputPixel >::min() ) ) + 1);
+  itkStaticConstMacro(BlockShift, unsigned int, sizeof( TInputPixel ) * 4);
+  itkStaticConstMacro(BlockMask, SizeValueType, ( static_cast< SizeValueType >( 1 ) << BlockShift ) - 1);
+
+  static SizeValueType GetBin(const TInputPixel & p)
+  {
+    return static_cast< SizeValueType >( static_cast< OffsetValueType >( p )
+                                         - static_cast< OffsetValueType >( std::numeric_limits< TInputPixel >::min() ) );
+  }
+
+  CountsType    m_Bins;
+  CountsType    m_Blocks;
+  SizeValueType m_Median;
+  SizeValueType m_Below;
+  SizeValueType m_Entries;
+};
+/** \endcond */
+
+} // end namespace Function
+} // end namespace itk
+
+#endif
@@ -25,6 +25,7 @@
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
+#include "itkImageScanlineIterator.h"
 
 #include <vector>
 #include <algorithm>
@@ -42,6 +43,17 @@ MedianImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        ThreadIdType threadId)
 {
+  SizeValueType neighborhoodSize = 1;
+  for ( unsigned int d = 0; d < InputImageDimension; ++d )
+    {
+    neighborhoodSize *= 2 * this->GetRadius()[d] + 1;
+    }
+  if ( HistogramType::IsSupported && neighborhoodSize >= HistogramNeighborhoodSize )
+    {
+    this->ThreadedGenerateDataWithHistogram(outputRegionForThread, threadId);
+    return;
+    }
+
   // Allocate output
   typename OutputImageType::Pointer output = this->GetOutput();
   typename  InputImageType::ConstPointer input  = this->GetInput();
@@ -94,6 +106,116 @@ MedianImageFilter< TInputImage, TOutputImage >
       }
     }
 }
+
+template< typename TInputImage, typename TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateDataWithHistogram(const OutputImageRegionType & outputRegionForThread,
+                                    ThreadIdType threadId)
+{
+  OutputImageType *                           output = this->GetOutput();
+  const InputImageType *                      input = this->GetInput();
+  const InputSizeType                         radius = this->GetRadius();
+  const InputImageRegionType                  bufferedRegion = input->GetBufferedRegion();
+  const typename InputImageType::IndexType    bufferedIndex = bufferedRegion.GetIndex();
+  const typename InputImageType::SizeType     bufferedSize = bufferedRegion.GetSize();
+  const OffsetValueType *                     offsetTable = input->GetOffsetTable();
+  const typename InputImageType::InternalPixelType *buffer = input->GetBufferPointer();
+
+  typename InputImageType::NeighborhoodAccessorFunctorType accessor = input->GetNeighborhoodAccessor();
+
+  const SizeValueType lineLength = outputRegionForThread.GetSize(0);
+  ProgressReporter    progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  // The offsets in the buffer of the rows of the neighborhood, at index
+  // 0 along dimension 0. The indices out of the buffer are clamped to its
+  // border, as with the ZeroFluxNeumannBoundaryCondition.
+  SizeValueType numberOfRows = 1;
+  for ( unsigned int d = 1; d < InputImageDimension; ++d )
+    {
+    numberOfRows *= 2 * radius[d] + 1;
+    }
+  std::vector< OffsetValueType > rows(numberOfRows);
+
+  const OffsetValueType first = bufferedIndex[0];
+  const OffsetValueType last = first + static_cast< OffsetValueType >( bufferedSize[0] ) - 1;
+  const OffsetValueType radius0 = static_cast< OffsetValueType >( radius[0] );
+
+  HistogramType histogram;
+
+  ImageScanlineIterator< OutputImageType > it(output, outputRegionForThread);
+  while ( !it.IsAtEnd() )
+    {
+    const typename OutputImageType::IndexType index = it.GetIndex();
+
+    OffsetValueType position[InputImageDimension];
+    for ( unsigned int d = 1; d < InputImageDimension; ++d )
+      {
+      position[d] = -static_cast< OffsetValueType >( radius[d] );
+      }
+    for ( SizeValueType r = 0; r < numberOfRows; ++r )
+      {
+      OffsetValueType offset = 0;
+      for ( unsigned int d = 1; d < InputImageDimension; ++d )
+        {
+        const OffsetValueType i = std::min( std::max( index[d] + position[d], bufferedIndex[d] ),
+                                            bufferedIndex[d] + static_cast< OffsetValueType >( bufferedSize[d] ) - 1 );
+        offset += ( i - bufferedIndex[d] ) * offsetTable[d];
+        }
+      rows[r] = offset - first;
+      for ( unsigned int d = 1; d < InputImageDimension; ++d )
+        {
+        if ( ++position[d] <= static_cast< OffsetValueType >( radius[d] ) )
+          {
+          break;
+          }
+        position[d] = -static_cast< OffsetValueType >( radius[d] );
+        }
+      }
+
+    // fill the histogram with the neighborhood of the first pixel, then
+    // move it by one column per pixel
+    const OffsetValueType begin = index[0];
+    const OffsetValueType end = begin + static_cast< OffsetValueType >( lineLength );
+    for ( OffsetValueType x = begin - radius0; x <= begin + radius0; ++x )
+      {
+      const OffsetValueType column = std::min( std::max( x, first ), last );
+      for ( SizeValueType r = 0; r < numberOfRows; ++r )
+        {
+        histogram.AddPixel( accessor.Get(buffer + rows[r] + column) );
+        }
+      }
+    for ( OffsetValueType x = begin; x < end; ++x )
+      {
+      it.Set( static_cast< OutputPixelType >( histogram.GetValue() ) );
+      ++it;
+
+      const OffsetValueType removed = std::min( std::max( x - radius0, first ), last );
+      const OffsetValueType added = std::min( std::max( x + radius0 + 1, first ), last );
+      if ( removed != added )
+        {
+        for ( SizeValueType r = 0; r < numberOfRows; ++r )
+          {
+          histogram.RemovePixel( accessor.Get(buffer + rows[r] + removed) );
+          histogram.AddPixel( accessor.Get(buffer + rows[r] + added) );
+          }
+        }
+      }
+
+    // empty the histogram for the next line
+    for ( OffsetValueType x = end - radius0; x <= end + radius0; ++x )
+      {
+      const OffsetValueType column = std::min( std::max( x, first ), last );
+      for ( SizeValueType r = 0; r < numberOfRows; ++r )
+        {
+        histogram.RemovePixel( accessor.Get(buffer + rows[r] + column) );
+        }
+      }
+
+    it.NextLine();
+    progress.CompletedPixel();
+    }
+}
 } // end namespace itk
 
 #endif
@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMedianImageFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+namespace
+{
+
+/** Creates an image of clusters of values, with noise, so that the
+ * medians move both by small steps and across blocks of the histogram. */
+template< typename TImage >
+typename TImage::Pointer CreateImage( const typename TImage::SizeType & size, double minimum, double maximum )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIterator< TImage > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double value = ( it.GetIndex()[0] / 16 + it.GetIndex()[1] / 8 ) % 3 == 0 ? minimum : 0.5 * ( minimum + maximum );
+    value += generator->GetUniformVariate( 0.0, 0.5 * ( maximum - minimum ) );
+    it.Set( static_cast< typename TImage::PixelType >( value ) );
+    }
+  return image;
+}
+
+/** Compares the medians of an integer image, computed with the histogram
+ * when the neighborhood is large enough, with the ones of the same image
+ * cast to double, computed by sorting the neighborhoods. */
+template< typename TImage >
+bool CheckMedian( const char *name, TImage *image, const typename TImage::SizeType & radius,
+                  const typename TImage::RegionType & requestedRegion, itk::ThreadIdType threads )
+{
+  typedef itk::Image< double, TImage::ImageDimension >       DoubleImageType;
+  typedef itk::MedianImageFilter< TImage, TImage >           MedianType;
+  typedef itk::CastImageFilter< TImage, DoubleImageType >    CastType;
+  typedef itk::MedianImageFilter< DoubleImageType, DoubleImageType > DoubleMedianType;
+
+  typename MedianType::Pointer median = MedianType::New();
+  median->SetInput( image );
+  median->SetRadius( radius );
+  median->SetNumberOfThreads( threads );
+  median->GetOutput()->SetRequestedRegion( requestedRegion );
+  median->Update();
+
+  typename CastType::Pointer cast = CastType::New();
+  cast->SetInput( image );
+  typename DoubleMedianType::Pointer doubleMedian = DoubleMedianType::New();
+  doubleMedian->SetInput( cast->GetOutput() );
+  doubleMedian->SetRadius( radius );
+  doubleMedian->SetNumberOfThreads( threads );
+  doubleMedian->GetOutput()->SetRequestedRegion( requestedRegion );
+  doubleMedian->Update();
+
+  itk::ImageRegionConstIterator< TImage >          it( median->GetOutput(), requestedRegion );
+  itk::ImageRegionConstIterator< DoubleImageType > dit( doubleMedian->GetOutput(), requestedRegion );
+  for( ; !it.IsAtEnd(); ++it, ++dit )
+    {
+    if( static_cast< double >( it.Get() ) != dit.Get() )
+      {
+      std::cerr << name << ": the median at " << it.GetIndex() << " is "
+                << static_cast< double >( it.Get() ) << " instead of " << dit.Get() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int itkMedianImageFilterHistogramTest( int, char* [] )
+{
+  typedef itk::Image< unsigned char, 2 >  UCharImageType;
+  typedef itk::Image< short, 2 >          ShortImageType;
+  typedef itk::Image< unsigned short, 3 > UShortImageType;
+  typedef itk::Image< char, 1 >           CharImageType;
+
+  bool passed = true;
+
+  UCharImageType::SizeType size2D;
+  size2D[0] = 211;
+  size2D[1] = 93;
+  UCharImageType::Pointer ucharImage = CreateImage< UCharImageType >( size2D, 0.0, 255.0 );
+  ShortImageType::Pointer shortImage = CreateImage< ShortImageType >( size2D, -30000.0, 30000.0 );
+
+  UCharImageType::SizeType radius2D;
+  radius2D[0] = 1;
+  radius2D[1] = 1;
+  passed &= CheckMedian( "UChar 3x3", ucharImage.GetPointer(), radius2D, ucharImage->GetLargestPossibleRegion(), 2 );
+  radius2D[0] = 7;
+  radius2D[1] = 3;
+  passed &= CheckMedian( "UChar 15x7", ucharImage.GetPointer(), radius2D, ucharImage->GetLargestPossibleRegion(), 3 );
+  passed &= CheckMedian( "Short 15x7", shortImage.GetPointer(), radius2D, shortImage->GetLargestPossibleRegion(), 3 );
+
+  // a requested region which does not start at the origin, and a
+  // neighborhood larger than the image along dimension 1
+  ShortImageType::RegionType region2D = shortImage->GetLargestPossibleRegion();
+  region2D.SetIndex( 0, 17 );
+  region2D.SetSize( 0, 150 );
+  region2D.SetIndex( 1, 40 );
+  region2D.SetSize( 1, 20 );
+  radius2D[0] = 2;
+  radius2D[1] = 60;
+  passed &= CheckMedian( "Short region", shortImage.GetPointer(), radius2D, region2D, 4 );
+
+  UShortImageType::SizeType size3D;
+  size3D[0] = 64;
+  size3D[1] = 64;
+  size3D[2] = 48;
+  UShortImageType::Pointer ushortImage = CreateImage< UShortImageType >( size3D, 0.0, 4095.0 );
+  UShortImageType::SizeType radius3D;
+  radius3D.Fill( 5 );
+  passed &= CheckMedian( "UShort 11x11x11", ushortImage.GetPointer(), radius3D,
+                         ushortImage->GetLargestPossibleRegion(), 1 );
+
+  CharImageType::SizeType size1D;
+  size1D[0] = 1000;
+  CharImageType::Pointer charImage = CreateImage< CharImageType >( size1D, -128.0, 127.0 );
+  CharImageType::SizeType radius1D;
+  radius1D[0] = 20;
+  passed &= CheckMedian( "Char 41", charImage.GetPointer(), radius1D, charImage->GetLargestPossibleRegion(), 2 );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,374 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAbsImageFilter.h"
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkIntensityWindowingImageFilter.h"
+#include "itkMaskImageFilter.h"
+#include "itkMultiplyImageFilter.h"
+#include "itkRescaleIntensityImageFilter.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkSqrtImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkCommand.h"
+
+namespace
+{
+
+typedef itk::Image< short, 3 >         ShortImageType;
+typedef itk::Image< float, 3 >         FloatImageType;
+typedef itk::Image< unsigned char, 3 > UCharImageType;
+
+/** Counts the executions of a filter. */
+class ExecutionCounter : public itk::Command
+{
+public:
+  typedef ExecutionCounter          Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+  itkNewMacro( Self );
+
+  unsigned int m_Count;
+
+  virtual void Execute( itk::Object *caller, const itk::EventObject & event ) ITK_OVERRIDE
+  {
+    Execute( (const itk::Object *)caller, event );
+  }
+
+  virtual void Execute( const itk::Object *, const itk::EventObject & event ) ITK_OVERRIDE
+  {
+    if( itk::StartEvent().CheckEvent( &event ) )
+      {
+      ++m_Count;
+      }
+  }
+
+protected:
+  ExecutionCounter() : m_Count( 0 ) {}
+};
+
+/** Aborts the filter at its first progress event. */
+class AbortCommand : public itk::Command
+{
+public:
+  typedef AbortCommand              Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+  itkNewMacro( Self );
+
+  virtual void Execute( itk::Object *caller, const itk::EventObject & ) ITK_OVERRIDE
+  {
+    static_cast< itk::ProcessObject * >( caller )->AbortGenerateDataOn();
+  }
+
+  virtual void Execute( const itk::Object *, const itk::EventObject & ) ITK_OVERRIDE
+  {
+  }
+};
+
+/** A chain of pixel-wise filters, broken by RescaleIntensityImageFilter
+ * which needs the extrema of its whole input:
+ *
+ *   input -> ShiftScale -> Cast -> Abs --------------> Multiply -> Sqrt -> BinaryThreshold -> Mask
+ *   input -> IntensityWindowing -> RescaleIntensity ---^                                      ^
+ *   input -> Cast ----------------------------------------------------------------------------'
+ *
+ * fuse sets the PixelwiseFusion flag of the pixel-wise filters, and
+ * releaseData the ReleaseDataFlag of the intermediate outputs.
+ */
+class Pipeline
+{
+public:
+  typedef itk::ShiftScaleImageFilter< ShortImageType, ShortImageType >                     ShiftScaleType;
+  typedef itk::CastImageFilter< ShortImageType, FloatImageType >                           CastType;
+  typedef itk::AbsImageFilter< FloatImageType, FloatImageType >                            AbsType;
+  typedef itk::IntensityWindowingImageFilter< ShortImageType, FloatImageType >             WindowingType;
+  typedef itk::RescaleIntensityImageFilter< FloatImageType, FloatImageType >               RescaleType;
+  typedef itk::MultiplyImageFilter< FloatImageType, FloatImageType, FloatImageType >       MultiplyType;
+  typedef itk::SqrtImageFilter< FloatImageType, FloatImageType >                           SqrtType;
+  typedef itk::BinaryThresholdImageFilter< FloatImageType, UCharImageType >                ThresholdType;
+  typedef itk::MaskImageFilter< FloatImageType, UCharImageType, FloatImageType >           MaskType;
+
+  Pipeline( ShortImageType *input, bool fuse, bool releaseData )
+  {
+    m_ShiftScale = ShiftScaleType::New();
+    m_ShiftScale->SetInput( input );
+    m_ShiftScale->SetShift( 100.0 );
+    m_ShiftScale->SetScale( 20.0 );
+    m_ShiftScale->SetPixelwiseFusion( fuse );
+    m_Cast = CastType::New();
+    m_Cast->SetInput( m_ShiftScale->GetOutput() );
+    m_Cast->SetPixelwiseFusion( fuse );
+    m_Abs = AbsType::New();
+    m_Abs->SetInput( m_Cast->GetOutput() );
+    m_Abs->SetPixelwiseFusion( fuse );
+    m_Windowing = WindowingType::New();
+    m_Windowing->SetInput( input );
+    m_Windowing->SetWindowMinimum( -1000 );
+    m_Windowing->SetWindowMaximum( 1000 );
+    m_Windowing->SetOutputMinimum( 0.0f );
+    m_Windowing->SetOutputMaximum( 1.0f );
+    m_Windowing->SetPixelwiseFusion( fuse );
+    m_Rescale = RescaleType::New();
+    m_Rescale->SetInput( m_Windowing->GetOutput() );
+    m_Rescale->SetOutputMinimum( 0.0f );
+    m_Rescale->SetOutputMaximum( 2.0f );
+    m_Multiply = MultiplyType::New();
+    m_Multiply->SetInput1( m_Abs->GetOutput() );
+    m_Multiply->SetInput2( m_Rescale->GetOutput() );
+    m_Multiply->SetPixelwiseFusion( fuse );
+    m_Sqrt = SqrtType::New();
+    m_Sqrt->SetInput( m_Multiply->GetOutput() );
+    m_Sqrt->SetPixelwiseFusion( fuse );
+    m_Threshold = ThresholdType::New();
+    m_Threshold->SetInput( m_Sqrt->GetOutput() );
+    m_Threshold->SetLowerThreshold( 5.0f );
+    m_Threshold->SetUpperThreshold( 30.0f );
+    m_Threshold->SetInsideValue( 1 );
+    m_Threshold->SetOutsideValue( 0 );
+    m_Threshold->SetPixelwiseFusion( fuse );
+    m_MaskedCast = CastType::New();
+    m_MaskedCast->SetInput( input );
+    m_MaskedCast->SetPixelwiseFusion( fuse );
+    m_Mask = MaskType::New();
+    m_Mask->SetInput( m_MaskedCast->GetOutput() );
+    m_Mask->SetMaskImage( m_Threshold->GetOutput() );
+    m_Mask->SetOutsideValue( -1.0f );
+
+    itk::ProcessObject *filters[] = { m_ShiftScale, m_Cast, m_Abs, m_Windowing, m_Rescale, m_Multiply,
+                                      m_Sqrt, m_Threshold, m_MaskedCast, m_Mask };
+    for( unsigned int i = 0; i < sizeof( filters ) / sizeof( filters[0] ); ++i )
+      {
+      m_Counters[i] = ExecutionCounter::New();
+      filters[i]->AddObserver( itk::StartEvent(), m_Counters[i] );
+      if( filters[i] != m_Mask.GetPointer() )
+        {
+        filters[i]->GetOutputs()[0]->SetReleaseDataFlag( releaseData );
+        }
+      }
+  }
+
+  unsigned int GetExecutions( unsigned int filter ) const
+  {
+    return m_Counters[filter]->m_Count;
+  }
+
+  static const char * GetName( unsigned int filter )
+  {
+    static const char *names[] = { "ShiftScale", "Cast", "Abs", "IntensityWindowing", "RescaleIntensity", "Multiply",
+                                   "Sqrt", "BinaryThreshold", "MaskedCast", "Mask" };
+    return names[filter];
+  }
+
+  ShiftScaleType::Pointer   m_ShiftScale;
+  CastType::Pointer         m_Cast;
+  AbsType::Pointer          m_Abs;
+  WindowingType::Pointer    m_Windowing;
+  RescaleType::Pointer      m_Rescale;
+  MultiplyType::Pointer     m_Multiply;
+  SqrtType::Pointer         m_Sqrt;
+  ThresholdType::Pointer    m_Threshold;
+  CastType::Pointer         m_MaskedCast;
+  MaskType::Pointer         m_Mask;
+  ExecutionCounter::Pointer m_Counters[10];
+};
+
+bool CompareImages( const char *name, const FloatImageType *expected, const FloatImageType *output )
+{
+  if( output->GetBufferedRegion() != expected->GetBufferedRegion() )
+    {
+    std::cerr << name << ": expected the region " << expected->GetBufferedRegion()
+              << " but got " << output->GetBufferedRegion() << std::endl;
+    return false;
+    }
+  itk::ImageRegionConstIterator< FloatImageType > eit( expected, expected->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< FloatImageType > oit( output, expected->GetBufferedRegion() );
+  for( ; !eit.IsAtEnd(); ++eit, ++oit )
+    {
+    if( oit.Get() != eit.Get() )
+      {
+      std::cerr << name << ": expected " << eit.Get() << " at " << eit.GetIndex()
+                << " but got " << oit.Get() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+/** Runs a chain of pixel-wise filters with and without fusion, and checks
+ * that the outputs are identical and that the fused filters did not
+ * execute. */
+int itkPixelwiseFilterFusionTest( int, char* [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  // an odd width, so that the vector loops have remainders
+  ShortImageType::SizeType size;
+  size[0] = 253;
+  size[1] = 128;
+  size[2] = 64;
+  ShortImageType::Pointer input = ShortImageType::New();
+  input->SetRegions( size );
+  input->Allocate();
+  itk::ImageRegionIterator< ShortImageType > it( input, input->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    it.Set( static_cast< short >( generator->GetUniformVariate( -2000.0, 2000.0 ) ) );
+    }
+
+  bool passed = true;
+  const unsigned int numberOfFilters = 10;
+
+  Pipeline reference( input, false, false );
+  reference.m_Mask->Update();
+
+  // the release of the intermediate outputs alone does not fuse the filters
+  Pipeline released( input, false, true );
+  released.m_Mask->Update();
+  passed &= CompareImages( "Released", reference.m_Mask->GetOutput(), released.m_Mask->GetOutput() );
+
+  Pipeline fused( input, true, false );
+  fused.m_Mask->Update();
+  passed &= CompareImages( "Fused", reference.m_Mask->GetOutput(), fused.m_Mask->GetOutput() );
+
+  // the filters which need their whole input, and the ones before them,
+  // execute; the pixel-wise filters after them are fused into Mask
+  const unsigned int expectedExecutions[] = { 0, 0, 0, 1, 1, 0, 0, 0, 0, 1 };
+  for( unsigned int i = 0; i < numberOfFilters; ++i )
+    {
+    if( reference.GetExecutions( i ) != 1 || released.GetExecutions( i ) != 1 )
+      {
+      std::cerr << Pipeline::GetName( i ) << " executed " << reference.GetExecutions( i ) << " and "
+                << released.GetExecutions( i ) << " times without fusion" << std::endl;
+      passed = false;
+      }
+    if( fused.GetExecutions( i ) != expectedExecutions[i] )
+      {
+      std::cerr << Pipeline::GetName( i ) << " executed " << fused.GetExecutions( i )
+                << " times instead of " << expectedExecutions[i] << " with fusion" << std::endl;
+      passed = false;
+      }
+    }
+  if( fused.m_Sqrt->GetOutput()->GetBufferPointer() != ITK_NULLPTR )
+    {
+    std::cerr << "The output of a fused filter was allocated" << std::endl;
+    passed = false;
+    }
+
+  // the fused ShiftScale still counts the clamped pixels
+  if( fused.m_ShiftScale->GetUnderflowCount() != reference.m_ShiftScale->GetUnderflowCount()
+      || fused.m_ShiftScale->GetOverflowCount() != reference.m_ShiftScale->GetOverflowCount()
+      || reference.m_ShiftScale->GetOverflowCount() == 0 )
+    {
+    std::cerr << "ShiftScale counted " << fused.m_ShiftScale->GetUnderflowCount() << " underflows and "
+              << fused.m_ShiftScale->GetOverflowCount() << " overflows instead of "
+              << reference.m_ShiftScale->GetUnderflowCount() << " and "
+              << reference.m_ShiftScale->GetOverflowCount() << std::endl;
+    passed = false;
+    }
+
+  // a modified parameter of a fused filter is taken into account
+  reference.m_Threshold->SetUpperThreshold( 20.0f );
+  reference.m_Mask->Update();
+  fused.m_Threshold->SetUpperThreshold( 20.0f );
+  fused.m_Mask->Update();
+  passed &= CompareImages( "Modified threshold", reference.m_Mask->GetOutput(), fused.m_Mask->GetOutput() );
+  if( fused.GetExecutions( 9 ) != 2 || fused.GetExecutions( 7 ) != 0 )
+    {
+    std::cerr << "Mask should have executed again, with BinaryThreshold fused" << std::endl;
+    passed = false;
+    }
+
+  // a requested region smaller than the largest possible region
+  FloatImageType::RegionType region = input->GetLargestPossibleRegion();
+  region.SetIndex( 0, 5 );
+  region.SetSize( 0, 200 );
+  region.SetIndex( 2, 10 );
+  region.SetSize( 2, 20 );
+  reference.m_Mask->GetOutput()->SetRequestedRegion( region );
+  reference.m_Mask->Modified();
+  reference.m_Mask->Update();
+  fused.m_Mask->GetOutput()->SetRequestedRegion( region );
+  fused.m_Mask->Modified();
+  fused.m_Mask->Update();
+  passed &= CompareImages( "Requested region", reference.m_Mask->GetOutput(), fused.m_Mask->GetOutput() );
+  if( fused.m_Mask->GetOutput()->GetBufferedRegion() != region )
+    {
+    std::cerr << "Mask did not generate the requested region" << std::endl;
+    passed = false;
+    }
+
+  // an aborted execution releases the fused inputs
+  fused.m_Mask->GetOutput()->SetRequestedRegion( input->GetLargestPossibleRegion() );
+  fused.m_Mask->Modified();
+  const unsigned long abortTag = fused.m_Mask->AddObserver( itk::ProgressEvent(), AbortCommand::New() );
+  bool aborted = false;
+  try
+    {
+    fused.m_Mask->Update();
+    }
+  catch( itk::ProcessAborted & )
+    {
+    aborted = true;
+    }
+  fused.m_Mask->RemoveObserver( abortTag );
+  if( !aborted || !fused.m_Mask->CanRunInPlace() )
+    {
+    std::cerr << "The aborted execution did not release the fused inputs" << std::endl;
+    passed = false;
+    }
+
+  // the output of Sqrt is kept when its fusion is turned off
+  fused.m_Sqrt->PixelwiseFusionOff();
+  fused.m_Mask->UpdateLargestPossibleRegion();
+  reference.m_Mask->UpdateLargestPossibleRegion();
+  passed &= CompareImages( "Kept output", reference.m_Mask->GetOutput(), fused.m_Mask->GetOutput() );
+  passed &= CompareImages( "Kept Sqrt output", reference.m_Sqrt->GetOutput(), fused.m_Sqrt->GetOutput() );
+
+  // the output of a fused filter is left released, and is generated by a
+  // normal execution when it is requested
+  if( !fused.m_Abs->GetOutput()->GetDataReleased() )
+    {
+    std::cerr << "The output of the fused Abs was not released" << std::endl;
+    passed = false;
+    }
+  fused.m_Abs->Update();
+  passed &= CompareImages( "Requested Abs output", reference.m_Abs->GetOutput(), fused.m_Abs->GetOutput() );
+  if( fused.GetExecutions( 2 ) != 1 )
+    {
+    std::cerr << "Abs executed " << fused.GetExecutions( 2 ) << " times instead of 1" << std::endl;
+    passed = false;
+    }
+  fused.m_ShiftScale->Print( std::cout );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -27,6 +27,7 @@
 #include "itkImageRegion.h"
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkSimpleDataObjectDecorator.h"
+#include "itkMemoryMappedFile.h"
 
 namespace itk
 {
@@ -127,6 +128,29 @@ public:
   itkGetConstReferenceMacro(UseStreaming, bool);
   itkBooleanMacro(UseStreaming);
 
+  /** Set/Get whether the pixels are mapped in memory from the file
+   * instead of being read. The pixels are then loaded by the operating
+   * system when they are first accessed, and only these ones are ever
+   * read. This is only possible when the ImageIO reports that the
+   * pixels are stored exactly as they would be read (see
+   * ImageIOBase::GetMemoryMappableData), that they need no conversion
+   * to the pixel type of the output, and that the requested region is
+   * contiguous in the file; otherwise the pixels are read as
+   * usual. Default is off. */
+  itkSetMacro(UseMemoryMapping, bool);
+  itkGetConstReferenceMacro(UseMemoryMapping, bool);
+  itkBooleanMacro(UseMemoryMapping);
+
+  /** Set/Get how the file is mapped when UseMemoryMapping is on. With
+   * MemoryMappedFile::CopyOnWrite, the default, the output can be
+   * modified without changing the file. With MemoryMappedFile::ReadOnly
+   * the pages are shared with the cache of the operating system, but
+   * the output must not be modified, for example by a filter running
+   * in place. */
+  typedef MemoryMappedFile::MappingModeType MemoryMappingModeType;
+  itkSetMacro(MemoryMappingMode, MemoryMappingModeType);
+  itkGetConstMacro(MemoryMappingMode, MemoryMappingModeType);
+
 protected:
   ImageFileReader();
   ~ImageFileReader();
@@ -142,6 +166,11 @@ protected:
     * will be thrown. */
   void TestFileExistanceAndReadability();
 
+  /** Map the pixels of the RequestedRegion of the output in memory
+   * from the file, if possible. Returns false if the pixels must be
+   * read instead. */
+  bool MapOutputFromFile();
+
   /** Does the real work. */
   virtual void GenerateData() ITK_OVERRIDE;
 
@@ -152,6 +181,9 @@ protected:
 
   bool m_UseStreaming;
 
+  bool                  m_UseMemoryMapping;
+  MemoryMappingModeType m_MemoryMappingMode;
+
 private:
   ImageFileReader(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
@@ -24,9 +24,11 @@
 #include "itkConvertPixelBuffer.h"
 #include "itkPixelTraits.h"
 #include "itkVectorImage.h"
+#include "itkMemoryMappedImportImageContainer.h"
 
 #include "itksys/SystemTools.hxx"
 #include <fstream>
+#include <algorithm>
 
 namespace itk
 {
@@ -38,6 +40,8 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
   this->SetFileName("");
   m_UserSpecifiedImageIO = false;
   m_UseStreaming = true;
+  m_UseMemoryMapping = false;
+  m_MemoryMappingMode = MemoryMappedFile::CopyOnWrite;
 }
 
 template< typename TOutputImage, typename ConvertPixelTraits >
@@ -55,6 +59,9 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
 
   os << indent << "UserSpecifiedImageIO flag: " << m_UserSpecifiedImageIO << "\n";
   os << indent << "m_UseStreaming: " << m_UseStreaming << "\n";
+  os << indent << "m_UseMemoryMapping: " << m_UseMemoryMapping << "\n";
+  os << indent << "m_MemoryMappingMode: "
+     << ( m_MemoryMappingMode == MemoryMappedFile::CopyOnWrite ? "CopyOnWrite" : "ReadOnly" ) << "\n";
 }
 
 template< typename TOutputImage, typename ConvertPixelTraits >
@@ -355,13 +362,6 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
 
   typename TOutputImage::Pointer output = this->GetOutput();
 
-  itkDebugMacro (<< "ImageFileReader::GenerateData() \n"
-                 << "Allocating the buffer with the EnlargedRequestedRegion \n"
-                 << output->GetRequestedRegion() << "\n");
-
-  // allocated the output image to the size of the enlarge requested region
-  this->AllocateOutputs();
-
   // Test if the file exists and if it can be opened.
   // An exception will be thrown otherwise, since we can't
   // successfully read the file. We catch the exception because some
@@ -384,6 +384,29 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
   itkDebugMacro (<< "Setting imageIO IORegion to: " << m_ActualIORegion);
   m_ImageIO->SetIORegion(m_ActualIORegion);
 
+  if ( m_UseMemoryMapping && this->MapOutputFromFile() )
+    {
+    this->UpdateProgress( 1.0f );
+    return;
+    }
+
+  // a container mapped by a previous update may be read-only, and
+  // Allocate() would reuse it
+  typedef typename TOutputImage::PixelContainer PixelContainerType;
+  typedef MemoryMappedImportImageContainer< typename PixelContainerType::ElementIdentifier,
+                                            typename PixelContainerType::Element > MappedPixelContainerType;
+  if ( dynamic_cast< MappedPixelContainerType * >( output->GetPixelContainer() ) != ITK_NULLPTR )
+    {
+    output->SetPixelContainer( PixelContainerType::New() );
+    }
+
+  itkDebugMacro (<< "ImageFileReader::GenerateData() \n"
+                 << "Allocating the buffer with the EnlargedRequestedRegion \n"
+                 << output->GetRequestedRegion() << "\n");
+
+  // allocated the output image to the size of the enlarge requested region
+  this->AllocateOutputs();
+
   char *loadBuffer = ITK_NULLPTR;
   // the size of the buffer is computed based on the actual number of
   // pixels to be read and the actual size of the pixels to be read
@@ -467,6 +490,87 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
   loadBuffer = ITK_NULLPTR;
 }
 
+template< typename TOutputImage, typename ConvertPixelTraits >
+bool
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::MapOutputFromFile()
+{
+  typename TOutputImage::Pointer output = this->GetOutput();
+  const ImageRegionType          requestedRegion = output->GetRequestedRegion();
+
+  typedef typename TOutputImage::PixelContainer PixelContainerType;
+  typedef typename PixelContainerType::Element  ElementType;
+  typedef MemoryMappedImportImageContainer< typename PixelContainerType::ElementIdentifier,
+                                            ElementType > MappedPixelContainerType;
+
+  // the pixels must need no conversion, and no copy because of a
+  // different dimension
+  const ImageIOBase::IOComponentType ioType =
+    ImageIOBase::MapPixelType< typename ConvertPixelTraits::ComponentType >::CType;
+  const SizeValueType bytesPerPixel =
+    m_ImageIO->GetComponentSize() * m_ImageIO->GetNumberOfComponents();
+  if ( m_ImageIO->GetComponentType() != ioType
+       || m_ImageIO->GetNumberOfComponents() != ConvertPixelTraits::GetNumberOfComponents()
+       || bytesPerPixel % sizeof( ElementType ) != 0
+       || requestedRegion.GetNumberOfPixels() == 0
+       || m_ActualIORegion.GetNumberOfPixels() != requestedRegion.GetNumberOfPixels() )
+    {
+    return false;
+    }
+
+  // the region must be contiguous in the file: the dimensions after the
+  // first one that is not complete must have a size of one
+  const unsigned int ioDimension =
+    std::min( m_ActualIORegion.GetImageDimension(), m_ImageIO->GetNumberOfDimensions() );
+  SizeValueType firstPixel = 0;
+  SizeValueType stride = 1;
+  bool          complete = true;
+  for ( unsigned int i = 0; i < ioDimension; ++i )
+    {
+    const SizeValueType size = m_ActualIORegion.GetSize(i);
+    if ( !complete && size > 1 )
+      {
+      return false;
+      }
+    firstPixel += m_ActualIORegion.GetIndex(i) * stride;
+    stride *= m_ImageIO->GetDimensions(i);
+    complete = ( size == m_ImageIO->GetDimensions(i) );
+    }
+
+  std::string           dataFileName;
+  ImageIOBase::SizeType dataOffset = 0;
+  if ( !m_ImageIO->GetMemoryMappableData(dataFileName, dataOffset) )
+    {
+    return false;
+    }
+  dataOffset += static_cast< ImageIOBase::SizeType >( firstPixel * bytesPerPixel );
+  if ( dataOffset % m_ImageIO->GetComponentSize() != 0 )
+    {
+    // the pixels would not be aligned in memory
+    return false;
+    }
+
+  typename MappedPixelContainerType::Pointer container = MappedPixelContainerType::New();
+  try
+    {
+    container->MapFile( dataFileName, dataOffset,
+                        requestedRegion.GetNumberOfPixels() * ( bytesPerPixel / sizeof( ElementType ) ),
+                        m_MemoryMappingMode );
+    }
+  catch ( ExceptionObject & err )
+    {
+    itkDebugMacro(<< "Cannot map " << dataFileName << ", the pixels are read instead: " << err);
+    return false;
+    }
+
+  itkDebugMacro(<< "Mapping the pixels of " << requestedRegion << " from " << dataFileName
+                << " at offset " << dataOffset);
+
+  output->SetBufferedRegion(requestedRegion);
+  output->SetPixelContainer(container);
+  return true;
+}
+
 template< typename TOutputImage, typename ConvertPixelTraits >
 void
 ImageFileReader< TOutputImage, ConvertPixelTraits >
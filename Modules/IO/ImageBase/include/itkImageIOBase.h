@@ -326,6 +326,19 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer) = 0;
 
+  /** Determine if the pixels of the file, as described by the last
+   * call to ReadImageInformation, are stored in a single file exactly
+   * as Read() would return them: uncompressed, contiguous, in the byte
+   * order of the machine and without rescaling. If so, the name of the
+   * file holding the pixels and the position of the first pixel in
+   * bytes are returned, so that the data can be mapped in memory
+   * instead of being read. Default is false. */
+  virtual bool GetMemoryMappableData(std::string & itkNotUsed(dataFileName),
+                                     SizeType & itkNotUsed(dataOffset))
+  {
+    return false;
+  }
+
   /*-------- This part of the interfaces deals with writing data ----- */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -0,0 +1,225 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkMemoryMappedImportImageContainer.h"
+#include "itkTestingImageIOHelpers.h"
+
+namespace
+{
+
+template< typename TImage >
+bool IsMapped( const TImage *image )
+{
+  typedef typename TImage::PixelContainer PixelContainerType;
+  typedef itk::MemoryMappedImportImageContainer< typename PixelContainerType::ElementIdentifier,
+                                                 typename PixelContainerType::Element > MappedContainerType;
+  const MappedContainerType *container =
+    dynamic_cast< const MappedContainerType * >( image->GetPixelContainer() );
+  return container != ITK_NULLPTR && container->IsMapped();
+}
+
+template< typename TImage >
+typename TImage::Pointer ReadRegion( const std::string & fileName, const typename TImage::RegionType & region,
+                                     bool useMemoryMapping, itk::MemoryMappedFile::MappingModeType mode )
+{
+  typedef itk::ImageFileReader< TImage > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+  reader->SetUseMemoryMapping( useMemoryMapping );
+  reader->SetMemoryMappingMode( mode );
+  reader->UpdateOutputInformation();
+  reader->GetOutput()->SetRequestedRegion( region );
+  reader->Update();
+  typename TImage::Pointer output = reader->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+// Writes an image, then reads it back with and without mapping the
+// file in memory
+template< typename TImage >
+bool MappedRead( const std::string & fileName )
+{
+  typename TImage::Pointer image = itk::Testing::CreateTestImage< TImage >();
+
+  typedef itk::ImageFileWriter< TImage > WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( fileName );
+  writer->SetInput( image );
+  writer->Update();
+
+  const typename TImage::RegionType largestRegion = image->GetLargestPossibleRegion();
+
+  // whole image, in both modes
+  const itk::MemoryMappedFile::MappingModeType modes[] =
+    { itk::MemoryMappedFile::ReadOnly, itk::MemoryMappedFile::CopyOnWrite };
+  for( unsigned int m = 0; m < 2; ++m )
+    {
+    typename TImage::Pointer mapped = ReadRegion< TImage >( fileName, largestRegion, true, modes[m] );
+    if( !IsMapped< TImage >( mapped ) )
+      {
+      std::cerr << fileName << " was not mapped" << std::endl;
+      return false;
+      }
+    if( !itk::Testing::SameRegion< TImage >( mapped, image.GetPointer(), largestRegion ) )
+      {
+      std::cerr << fileName << " mapped in memory differs" << std::endl;
+      return false;
+      }
+    }
+
+  // modifying a copy-on-write mapping does not modify the file
+  typename TImage::Pointer copyOnWrite =
+    ReadRegion< TImage >( fileName, largestRegion, true, itk::MemoryMappedFile::CopyOnWrite );
+  typename TImage::IndexType modifiedIndex;
+  modifiedIndex.Fill( 5 );
+  typename TImage::PixelType modifiedPixel;
+  itk::Testing::SetTestPixelValue( modifiedPixel, 7777 );
+  copyOnWrite->SetPixel( modifiedIndex, modifiedPixel );
+  typename TImage::Pointer unmapped =
+    ReadRegion< TImage >( fileName, largestRegion, false, itk::MemoryMappedFile::CopyOnWrite );
+  if( IsMapped< TImage >( unmapped ) )
+    {
+    std::cerr << fileName << " was mapped without UseMemoryMapping" << std::endl;
+    return false;
+    }
+  if( !itk::Testing::SameRegion< TImage >( unmapped, image.GetPointer(), largestRegion ) )
+    {
+    std::cerr << fileName << " was modified through a copy-on-write mapping" << std::endl;
+    return false;
+    }
+
+  // a slab is contiguous in the file
+  typename TImage::RegionType slab = largestRegion;
+  slab.SetIndex( 2, 4 );
+  slab.SetSize( 2, 5 );
+  typename TImage::Pointer mappedSlab =
+    ReadRegion< TImage >( fileName, slab, true, itk::MemoryMappedFile::ReadOnly );
+  if( mappedSlab->GetBufferedRegion() == slab && !IsMapped< TImage >( mappedSlab ) )
+    {
+    std::cerr << fileName << ": the slab " << slab << " was not mapped" << std::endl;
+    return false;
+    }
+  if( !itk::Testing::SameRegion< TImage >( mappedSlab, image.GetPointer(), slab ) )
+    {
+    std::cerr << fileName << " mapped slab differs" << std::endl;
+    return false;
+    }
+
+  // a block is not contiguous, it is read
+  typename TImage::RegionType block = slab;
+  block.SetIndex( 0, 3 );
+  block.SetSize( 0, 10 );
+  typename TImage::Pointer readBlock =
+    ReadRegion< TImage >( fileName, block, true, itk::MemoryMappedFile::ReadOnly );
+  if( readBlock->GetBufferedRegion() == block && IsMapped< TImage >( readBlock ) )
+    {
+    std::cerr << fileName << ": the block " << block << " was mapped" << std::endl;
+    return false;
+    }
+  if( !itk::Testing::SameRegion< TImage >( readBlock, image.GetPointer(), block ) )
+    {
+    std::cerr << fileName << " read block differs" << std::endl;
+    return false;
+    }
+
+  // the same reader maps, then reads into a new buffer
+  typedef itk::ImageFileReader< TImage > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+  reader->SetUseMemoryMapping( true );
+  reader->SetMemoryMappingMode( itk::MemoryMappedFile::ReadOnly );
+  reader->Update();
+  if( !IsMapped< TImage >( reader->GetOutput() ) )
+    {
+    std::cerr << fileName << " was not mapped by the reused reader" << std::endl;
+    return false;
+    }
+  reader->SetUseMemoryMapping( false );
+  reader->Update();
+  if( IsMapped< TImage >( reader->GetOutput() ) )
+    {
+    std::cerr << fileName << " is still mapped after the second update" << std::endl;
+    return false;
+    }
+  if( !itk::Testing::SameRegion< TImage >( reader->GetOutput(), image.GetPointer(), largestRegion ) )
+    {
+    std::cerr << fileName << " read by the reused reader differs" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
+
+int itkImageFileReaderMemoryMappingTest( int argc, char *argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputPrefix" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string prefix = argv[1];
+
+  typedef itk::Image< short, 3 >                   ImageType;
+  typedef itk::Image< unsigned char, 3 >           CharImageType;
+  typedef itk::Image< itk::Vector< float, 3 >, 3 > VectorImageType;
+
+  bool passed = true;
+  try
+    {
+    // the pixels of a .mha file are only aligned in memory for types of
+    // one byte, since the header has an arbitrary length
+    passed &= MappedRead< CharImageType >( prefix + ".mha" );
+    passed &= MappedRead< ImageType >( prefix + ".mhd" );
+    passed &= MappedRead< VectorImageType >( prefix + "Vector.mhd" );
+    passed &= MappedRead< ImageType >( prefix + ".nii" );
+
+    // a conversion is needed, the pixels are read
+    typedef itk::Image< float, 3 > FloatImageType;
+    typedef itk::ImageFileReader< ImageType > ReaderType;
+    ReaderType::Pointer baseline = ReaderType::New();
+    baseline->SetFileName( prefix + ".mhd" );
+    baseline->Update();
+    FloatImageType::Pointer converted = ReadRegion< FloatImageType >( prefix + ".mhd",
+      baseline->GetOutput()->GetLargestPossibleRegion(), true, itk::MemoryMappedFile::ReadOnly );
+    if( IsMapped< FloatImageType >( converted ) )
+      {
+      std::cerr << "Pixels needing a conversion were mapped" << std::endl;
+      passed = false;
+      }
+    passed &= itk::Testing::SameRegion< FloatImageType >( converted, baseline->GetOutput(),
+                                                          converted->GetLargestPossibleRegion() );
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << err << std::endl;
+    passed = false;
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
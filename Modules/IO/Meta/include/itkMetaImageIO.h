@@ -73,6 +73,11 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer) ITK_OVERRIDE;
 
+  /** The pixels of uncompressed binary files in the byte order of the
+   * machine, stored in the header file (LOCAL) or in a single data
+   * file, can be mapped in memory. */
+  virtual bool GetMemoryMappableData(std::string & dataFileName, SizeType & dataOffset) ITK_OVERRIDE;
+
   MetaImage * GetMetaImagePointer();
 
   /*-------- This part of the interfaces deals with writing data. ----- */
@@ -21,6 +21,7 @@
 #include "itkMetaDataObject.h"
 #include "itkIOCommon.h"
 #include "itksys/SystemTools.hxx"
+#include "itkByteSwapper.h"
 
 namespace itk
 {
@@ -487,6 +488,82 @@ void MetaImageIO::Read(void *buffer)
     }
 }
 
+bool MetaImageIO::GetMemoryMappableData(std::string & dataFileName, SizeType & dataOffset)
+{
+  if ( !m_MetaImage.BinaryData() || m_MetaImage.CompressedData() )
+    {
+    return false;
+    }
+
+  int elementSize;
+  MET_SizeOfType(m_MetaImage.ElementType(), &elementSize);
+  if ( static_cast< unsigned int >( elementSize * m_MetaImage.ElementNumberOfChannels() )
+       != this->GetComponentSize() * this->GetNumberOfComponents() )
+    {
+    return false;
+    }
+  if ( elementSize > 1
+       && m_MetaImage.BinaryDataByteOrderMSB() != ByteSwapper< int >::SystemIsBigEndian() )
+    {
+    return false;
+    }
+
+  // slices stored in a list of files, or in files named with a pattern,
+  // are not contiguous
+  const std::string elementDataFileName = m_MetaImage.ElementDataFileName();
+  if ( elementDataFileName.compare(0, 4, "LIST") == 0
+       || elementDataFileName.find('%') != std::string::npos )
+    {
+    return false;
+    }
+
+  bool local = false;
+  if ( elementDataFileName == "LOCAL"
+       || elementDataFileName == "Local"
+       || elementDataFileName == "local" )
+    {
+    local = true;
+    dataFileName = m_FileName;
+    }
+  else if ( itksys::SystemTools::FileIsFullPath( elementDataFileName.c_str() ) )
+    {
+    dataFileName = elementDataFileName;
+    }
+  else
+    {
+    const std::string path = itksys::SystemTools::GetFilenamePath(m_FileName);
+    dataFileName = path.empty() ? elementDataFileName : path + "/" + elementDataFileName;
+    }
+  // MetaImage also reads compressed data files with a .gz or .Z suffix
+  if ( !itksys::SystemTools::FileExists( dataFileName.c_str(), true ) )
+    {
+    return false;
+    }
+
+  // same logic as in MetaImage::M_ReadElements: the data is either at
+  // HeaderSize bytes, or at the end of the file
+  const int headerSize = m_MetaImage.HeaderSize();
+  if ( headerSize > 0 )
+    {
+    dataOffset = headerSize;
+    }
+  else if ( headerSize == -1 || local )
+    {
+    const SizeType fileSize = static_cast< SizeType >( itksys::SystemTools::FileLength( dataFileName.c_str() ) );
+    const SizeType dataSize = static_cast< SizeType >( this->GetImageSizeInBytes() );
+    if ( fileSize < dataSize )
+      {
+      return false;
+      }
+    dataOffset = fileSize - dataSize;
+    }
+  else
+    {
+    dataOffset = 0;
+    }
+  return true;
+}
+
 MetaImage * MetaImageIO::GetMetaImagePointer(void)
 {
   return &m_MetaImage;
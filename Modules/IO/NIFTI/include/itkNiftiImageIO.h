@@ -66,9 +66,22 @@ public:
   /** Set the spacing and dimension information for the set filename. */
   virtual void ReadImageInformation() ITK_OVERRIDE;
 
-  /** Reads the data from disk into the memory buffer provided. */
+  /** Reads the data from disk into the memory buffer provided. Only
+   * the rows of the IORegion are read from the file. */
   virtual void Read(void *buffer) ITK_OVERRIDE;
 
+  /** Nifti files can be read by region, except gzipped files, which
+   * would be decompressed again from the start for each region. */
+  virtual bool CanStreamRead() ITK_OVERRIDE
+  {
+    return nifti_is_gzfile( this->GetFileName() ) == 0;
+  }
+
+  /** The pixels of uncompressed, unscaled files in the byte order of
+   * the machine can be mapped in memory, except for vector and tensor
+   * pixels whose components are not interleaved in the file. */
+  virtual bool GetMemoryMappableData(std::string & dataFileName, SizeType & dataOffset) ITK_OVERRIDE;
+
   //-------- This part of the interfaces deals with writing data. -----
 
   /** Determine if the file can be written with this ImageIO implementation.
@@ -91,7 +104,9 @@ public:
   virtual void Write(const void *buffer) ITK_OVERRIDE;
 
   /** Calculate the region of the image that can be efficiently read
-   *  in response to a given requested region. */
+   *  in response to a given requested region. This is the requested
+   *  region when UseStreamedReading is on and the file is not gzipped,
+   *  the whole image otherwise. */
   virtual ImageIORegion
   GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const ITK_OVERRIDE;
 
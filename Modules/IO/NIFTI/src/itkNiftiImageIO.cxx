@@ -344,6 +344,11 @@ ImageIORegion
 NiftiImageIO
 ::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const
 {
+  // as in CanStreamRead, gzipped files are read as a whole
+  if ( !m_UseStreamedReading || nifti_is_gzfile( this->GetFileName() ) )
+    {
+    return Superclass::GenerateStreamableReadRegionFromRequestedRegion(requestedRegion);
+    }
   return requestedRegion;
 }
 
@@ -463,9 +468,25 @@ void NiftiImageIO::Read(void *buffer)
     // other dims out of the way
     _size[6] = _size[5];
     _size[5] = _size[4];
+    _origin[6] = _origin[5];
+    _origin[5] = _origin[4];
     // sizes = x y z t vecsize
     _size[4] = numComponents;
+    _origin[4] = 0;
     }
+  //
+  // nifti layout == itk layout for single, complex and color pixels
+  const bool sameLayout = numComponents == 1
+                          || this->GetPixelType() == COMPLEX
+                          || this->GetPixelType() == RGB
+                          || this->GetPixelType() == RGBA;
+  //
+  // if we're going to have to rescale pixels, and the on-disk
+  // pixel type is different than the pixel type reported to
+  // ImageFileReader, we have to up-promote the data to float
+  // before doing the rescale.
+  const bool castToFloat = this->MustRescale()
+                           && this->m_ComponentType != this->m_OnDiskComponentType;
   // Free memory if any was occupied already (incase of re-using the IO filter).
   if ( this->m_NiftiImage != ITK_NULLPTR )
     {
@@ -514,22 +535,14 @@ void NiftiImageIO::Read(void *buffer)
       }
     }
   unsigned int pixelSize = this->m_NiftiImage->nbyper;
-  //
-  // if we're going to have to rescale pixels, and the on-disk
-  // pixel type is different than the pixel type reported to
-  // ImageFileReader, we have to up-promote the data to float
-  // before doing the rescale.
-  //
-  if ( this->MustRescale()
-       && this->m_ComponentType != this->m_OnDiskComponentType )
+  if ( castToFloat )
     {
     pixelSize =
       static_cast< unsigned int >( this->GetNumberOfComponents() )
       * static_cast< unsigned int >( sizeof( float ) );
 
-    // Deal with correct management of 64bits platforms
-    const size_t imageSizeInComponents =
-      static_cast< size_t >( this->GetImageSizeInComponents() );
+    // Only the IORegion has been read
+    const size_t imageSizeInComponents = numElts * numComponents;
 
     //
     // allocate new buffer for floats. Malloc instead of new to
@@ -583,10 +596,7 @@ void NiftiImageIO::Read(void *buffer)
     }
   //
   // if single or complex, nifti layout == itk layout
-  if ( numComponents == 1
-       || this->GetPixelType() == COMPLEX
-       || this->GetPixelType() == RGB
-       || this->GetPixelType() == RGBA )
+  if ( sameLayout )
     {
     const size_t NumBytes = numElts * pixelSize;
     memcpy(buffer, data, NumBytes);
@@ -604,10 +614,11 @@ void NiftiImageIO::Read(void *buffer)
     // vec x y z t l m o
     const char *       niftibuf = (const char *)data;
     char *             itkbuf = (char *)buffer;
-    const size_t rowdist = this->m_NiftiImage->dim[1];
-    const size_t slicedist = rowdist * this->m_NiftiImage->dim[2];
-    const size_t volumedist = slicedist * this->m_NiftiImage->dim[3];
-    const size_t seriesdist = volumedist * this->m_NiftiImage->dim[4];
+    // the distances are those of the region that has been read
+    const size_t rowdist = _size[0];
+    const size_t slicedist = rowdist * _size[1];
+    const size_t volumedist = slicedist * _size[2];
+    const size_t seriesdist = volumedist * _size[3];
     //
     // as per ITK bug 0007485
     // NIfTI is lower triangular, ITK is upper triangular.
@@ -626,13 +637,13 @@ void NiftiImageIO::Read(void *buffer)
         vecOrder[i] = i;
         }
       }
-    for ( int t = 0; t < this->m_NiftiImage->dim[4]; t++ )
+    for ( int t = 0; t < _size[3]; t++ )
       {
-      for ( int z = 0; z < this->m_NiftiImage->dim[3]; z++ )
+      for ( int z = 0; z < _size[2]; z++ )
         {
-        for ( int y = 0; y < this->m_NiftiImage->dim[2]; y++ )
+        for ( int y = 0; y < _size[1]; y++ )
           {
-          for ( int x = 0; x < this->m_NiftiImage->dim[1]; x++ )
+          for ( int x = 0; x < _size[0]; x++ )
             {
             for ( unsigned int c = 0; c < numComponents; c++ )
               {
@@ -729,6 +740,42 @@ void NiftiImageIO::Read(void *buffer)
     }
 }
 
+bool
+NiftiImageIO
+::GetMemoryMappableData(std::string & dataFileName, SizeType & dataOffset)
+{
+  const unsigned int numComponents = this->GetNumberOfComponents();
+  // same test as in Read
+  const bool sameLayout = numComponents == 1
+                          || this->GetPixelType() == COMPLEX
+                          || this->GetPixelType() == RGB
+                          || this->GetPixelType() == RGBA;
+  if ( !sameLayout || this->MustRescale() )
+    {
+    return false;
+    }
+
+  // the header is released at the end of ReadImageInformation
+  nifti_image *header = nifti_image_read(this->GetFileName(), false);
+  if ( header == ITK_NULLPTR )
+    {
+    return false;
+    }
+  const bool mappable = header->iname != ITK_NULLPTR
+                        && !nifti_is_gzfile(header->iname)
+                        && header->iname_offset >= 0
+                        && ( header->nbyper == 1 || header->byteorder == nifti_short_order() )
+                        && static_cast< unsigned int >( header->nbyper )
+                           == this->GetComponentSize() * numComponents;
+  if ( mappable )
+    {
+    dataFileName = header->iname;
+    dataOffset = static_cast< SizeType >( header->iname_offset );
+    }
+  nifti_image_free(header);
+  return mappable;
+}
+
 // This method will only test if the header looks like an
 // Nifti Header.  Some code is redundant with ReadImageInformation
 // a StateMachine could provide a better implementation
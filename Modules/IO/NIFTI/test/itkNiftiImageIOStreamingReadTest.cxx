@@ -0,0 +1,56 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkNiftiImageIO.h"
+#include "itkTestingImageIOHelpers.h"
+
+int itkNiftiImageIOStreamingReadTest( int argc, char *argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputPrefix" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string prefix = argv[1];
+
+  const itk::NiftiImageIO::Pointer imageIO = itk::NiftiImageIO::New();
+
+  bool passed = true;
+  try
+    {
+    passed &= itk::Testing::StreamedRead< itk::Image< short, 3 > >( prefix + ".nii", imageIO );
+    // gzipped files are read as a whole
+    passed &= itk::Testing::StreamedRead< itk::Image< short, 3 > >( prefix + ".nii.gz", imageIO, false );
+    passed &= itk::Testing::StreamedRead< itk::Image< itk::Vector< float, 3 >, 3 > >( prefix + "Vector.nii", imageIO );
+    passed &= itk::Testing::StreamedRead< itk::Image< unsigned char, 4 > >( prefix + "4D.nii", imageIO );
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << err << std::endl;
+    passed = false;
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
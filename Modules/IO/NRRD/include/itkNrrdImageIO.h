@@ -65,6 +65,18 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer) ITK_OVERRIDE;
 
+  /** Raw data held in a single file, with the pixel components on the
+   * fastest axis, can be read by region. This is known after
+   * ReadImageInformation has been called. */
+  virtual bool CanStreamRead() ITK_OVERRIDE;
+
+  /** Calculate the region of the image that can be efficiently read
+   *  in response to a given requested region. This is the requested
+   *  region when the file can be streamed and UseStreamedReading is
+   *  on, the whole image otherwise. */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const ITK_OVERRIDE;
+
   /** Determine the file type. Returns true if this ImageIO can write the
    * file specified. */
   virtual bool CanWriteFile(const char *) ITK_OVERRIDE;
@@ -90,6 +102,11 @@ protected:
 private:
   NrrdImageIO(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
+
+  /** Reads the IORegion from the raw data, seeking over the rest. */
+  void StreamReadBufferAsBinary(void *buffer);
+
+  bool m_CanStreamRead;
 };
 } // end namespace itk
 
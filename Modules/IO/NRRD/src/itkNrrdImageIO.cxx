@@ -23,11 +23,45 @@
 #include "itkIOCommon.h"
 #include "itkFloatingPointExceptions.h"
 
+#include <algorithm>
+#include <cstdio>
+
 namespace itk
 {
 #define KEY_PREFIX "NRRD_"
 
-NrrdImageIO::NrrdImageIO()
+namespace
+{
+// fseek and ftell with 64 bits offsets, for data files over 2GB
+#if defined( _MSC_VER )
+typedef __int64 FileOffsetType;
+
+inline int FileSeek(FILE *file, FileOffsetType offset)
+{
+  return _fseeki64(file, offset, SEEK_SET);
+}
+
+inline FileOffsetType FileTell(FILE *file)
+{
+  return _ftelli64(file);
+}
+#else
+typedef off_t FileOffsetType;
+
+inline int FileSeek(FILE *file, FileOffsetType offset)
+{
+  return fseeko(file, offset, SEEK_SET);
+}
+
+inline FileOffsetType FileTell(FILE *file)
+{
+  return ftello(file);
+}
+#endif
+}
+
+NrrdImageIO::NrrdImageIO():
+  m_CanStreamRead(false)
 {
   this->SetNumberOfDimensions(3);
   this->AddSupportedWriteExtension(".nrrd");
@@ -233,6 +267,8 @@ void NrrdImageIO::ReadImageInformation()
   Nrrd *       nrrd = nrrdNew();
   NrrdIoState *nio = nrrdIoStateNew();
 
+  m_CanStreamRead = false;
+
   try
     {
 #ifndef __MINGW32__
@@ -412,6 +448,15 @@ void NrrdImageIO::ReadImageInformation()
                         << " dependent axis (not 1); not currently handled");
       }
 
+    // Uncompressed data in a single file is laid out like the ITK
+    // buffer when the components are on the fastest axis, so that a
+    // region can be read without reading the rest of the data
+    m_CanStreamRead = nrrdFormatNRRD == nio->format
+                      && nrrdEncodingRaw == nio->encoding
+                      && 1 == _nrrdDataFNNumber(nio)
+                      && ( 0 == rangeAxisNum || 0 == rangeAxisIdx[0] )
+                      && ImageIOBase::SYMMETRICSECONDRANKTENSOR != this->GetPixelType();
+
     double                spacing;
     double                spaceDir[NRRD_SPACE_DIM_MAX];
     std::vector< double > spaceDirStd(domainAxisNum);
@@ -699,8 +744,178 @@ void NrrdImageIO::ReadImageInformation()
     }
 }
 
+bool NrrdImageIO::CanStreamRead()
+{
+  return m_CanStreamRead;
+}
+
+ImageIORegion
+NrrdImageIO
+::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const
+{
+  if ( !m_UseStreamedReading || !m_CanStreamRead )
+    {
+    return Superclass::GenerateStreamableReadRegionFromRequestedRegion(requestedRegion);
+    }
+  return requestedRegion;
+}
+
+void NrrdImageIO::StreamReadBufferAsBinary(void *_buffer)
+{
+  Nrrd *       nrrd = nrrdNew();
+  NrrdIoState *nio = nrrdIoStateNew();
+
+#ifndef __MINGW32__
+  // nrrd causes exceptions on purpose, so mask them
+  bool saveFPEState(FloatingPointExceptions::GetEnabled() );
+  FloatingPointExceptions::Disable();
+#endif
+
+  // read the header again, and keep the data file open at the
+  // beginning of the data
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  nrrdIoStateSet(nio, nrrdIoStateKeepNrrdDataFileOpen, 1);
+  if ( nrrdLoad(nrrd, this->GetFileName(), nio) != 0 || !nio->dataFile )
+    {
+    char *err =  biffGetDone(NRRD); // would be nice to free(err)
+    nrrdNix(nrrd);
+    nrrdIoStateNix(nio);
+#ifndef __MINGW32__
+    FloatingPointExceptions::SetEnabled(saveFPEState);
+#endif
+    itkExceptionMacro("Read: Error reading "
+                      << this->GetFileName() << ":\n" << err);
+    }
+
+#ifndef __MINGW32__
+  // restore state
+  FloatingPointExceptions::SetEnabled(saveFPEState);
+#endif
+
+  FILE *               dataFile = nio->dataFile;
+  const FileOffsetType dataPosition = FileTell(dataFile);
+  const bool           swapBytes = nio->endian != airEndianUnknown
+                                   && nio->endian != airMyEndian();
+  nio->dataFile = ITK_NULLPTR;
+  nrrdIoStateNix(nio);
+
+  // dimensions missing from the region are read at index 0
+  const unsigned int numberOfDimensions =
+    std::max( this->GetNumberOfDimensions(), m_IORegion.GetImageDimension() );
+  std::vector< SizeValueType > dimensions(numberOfDimensions, 1);
+  std::vector< SizeValueType > regionSize(numberOfDimensions, 1);
+  std::vector< IndexValueType > regionIndex(numberOfDimensions, 0);
+  SizeValueType                 numberOfPixels = 1;
+  for ( unsigned int i = 0; i < numberOfDimensions; ++i )
+    {
+    if ( i < this->GetNumberOfDimensions() )
+      {
+      dimensions[i] = this->GetDimensions(i);
+      }
+    if ( i < m_IORegion.GetImageDimension() )
+      {
+      regionSize[i] = m_IORegion.GetSize(i);
+      regionIndex[i] = m_IORegion.GetIndex(i);
+      }
+    numberOfPixels *= regionSize[i];
+    }
+
+  // compute the number of contiguous bytes to be read
+  const size_t pixelSize = this->GetPixelSize();
+  size_t       sizeOfChunk = pixelSize;
+  unsigned int   movingDirection = 0;
+  do
+    {
+    sizeOfChunk *= regionSize[movingDirection];
+    ++movingDirection;
+    }
+  while ( movingDirection < numberOfDimensions
+          && regionSize[movingDirection - 1] == dimensions[movingDirection - 1] );
+
+  char *                        buffer = static_cast< char * >( _buffer );
+  const char *                  bufferEnd = buffer + numberOfPixels * pixelSize;
+  std::vector< IndexValueType > currentIndex = regionIndex;
+  bool                          readFailed = false;
+  while ( buffer < bufferEnd )
+    {
+    // calculate the position to seek to in the file
+    FileOffsetType seekPos = dataPosition;
+    FileOffsetType subDimensionQuantity = pixelSize;
+    for ( unsigned int i = 0; i < numberOfDimensions; ++i )
+      {
+      seekPos += subDimensionQuantity * currentIndex[i];
+      subDimensionQuantity *= dimensions[i];
+      }
+
+    if ( FileSeek(dataFile, seekPos) != 0
+         || fread(buffer, 1, sizeOfChunk, dataFile) != sizeOfChunk )
+      {
+      readFailed = true;
+      break;
+      }
+    buffer += sizeOfChunk;
+
+    if ( movingDirection == numberOfDimensions )
+      {
+      break;
+      }
+
+    // increment index to next chunk
+    ++currentIndex[movingDirection];
+    for ( unsigned int i = movingDirection; i < numberOfDimensions - 1; ++i )
+      {
+      // when reaching the end of the movingDirection dimension carry to
+      // higher dimensions
+      if ( static_cast< SizeValueType >( currentIndex[i] - regionIndex[i] ) >= regionSize[i] )
+        {
+        currentIndex[i] = regionIndex[i];
+        ++currentIndex[i + 1];
+        }
+      }
+    }
+  airFclose(dataFile);
+
+  if ( readFailed )
+    {
+    nrrdNix(nrrd);
+    itkExceptionMacro("Read: Error reading region " << m_IORegion
+                      << " from " << this->GetFileName());
+    }
+
+  if ( swapBytes && nrrdElementSize(nrrd) > 1 )
+    {
+    // wrap the ITK buffer as a one dimensional nrrd for swapping
+    const size_t numberOfElements = numberOfPixels * this->GetNumberOfComponents();
+    const int    type = nrrd->type;
+    nrrdEmpty(nrrd);
+    nrrdWrap_nva(nrrd, _buffer, type, 1, &numberOfElements);
+    nrrdSwapEndian(nrrd);
+    }
+  nrrdNix(nrrd);
+}
+
 void NrrdImageIO::Read(void *buffer)
 {
+  // Read just the IORegion when it is not the whole image
+  if ( m_CanStreamRead )
+    {
+    ImageIORegion largestRegion( m_IORegion.GetImageDimension() );
+    for ( unsigned int i = 0; i < largestRegion.GetImageDimension(); ++i )
+      {
+      largestRegion.SetSize( i, i < this->GetNumberOfDimensions() ? this->GetDimensions(i) : 1 );
+      }
+    bool wholeImage = largestRegion == m_IORegion;
+    for ( unsigned int i = m_IORegion.GetImageDimension(); i < this->GetNumberOfDimensions(); ++i )
+      {
+      wholeImage = wholeImage && this->GetDimensions(i) == 1;
+      }
+    if ( !wholeImage )
+      {
+      this->StreamReadBufferAsBinary(buffer);
+      return;
+      }
+    }
+
   Nrrd *       nrrd = nrrdNew();
   bool         nrrdAllocated;
 
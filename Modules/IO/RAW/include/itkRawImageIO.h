@@ -106,6 +106,10 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer) ITK_OVERRIDE;
 
+  /** Binary files in the byte order of the machine can be mapped in
+   * memory, the pixels start after the header. */
+  virtual bool GetMemoryMappableData(std::string & dataFileName, SizeType & dataOffset) ITK_OVERRIDE;
+
   /** Set/Get the Data mask. */
   itkGetConstReferenceMacro(ImageMask, unsigned short);
   void SetImageMask(unsigned long val)
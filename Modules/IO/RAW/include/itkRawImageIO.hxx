@@ -175,6 +175,27 @@ void RawImageIO< TPixel, VImageDimension >
   else if itkReadRawBytesAfterSwappingMacro(double, DOUBLE)
 }
 
+template< typename TPixel, unsigned int VImageDimension >
+bool RawImageIO< TPixel, VImageDimension >
+::GetMemoryMappableData(std::string & dataFileName, SizeType & dataOffset)
+{
+  if ( m_FileType != Binary )
+    {
+    return false;
+    }
+  const bool systemIsBigEndian = ByteSwapper< int >::SystemIsBigEndian();
+  if ( this->GetComponentSize() > 1
+       && ( ( m_ByteOrder == LittleEndian && systemIsBigEndian )
+            || ( m_ByteOrder == BigEndian && !systemIsBigEndian ) ) )
+    {
+    return false;
+    }
+
+  dataFileName = m_FileName;
+  dataOffset = static_cast< SizeType >( this->GetHeaderSize() );
+  return true;
+}
+
 template< typename TPixel, unsigned int VImageDimension >
 bool RawImageIO< TPixel, VImageDimension >
 ::CanWriteFile(const char *fname)
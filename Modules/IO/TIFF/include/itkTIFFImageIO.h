@@ -63,12 +63,26 @@ public:
   /** Set the spacing and dimension information for the set filename. */
   virtual void ReadImageInformation() ITK_OVERRIDE;
 
-  /** Reads the data from disk into the memory buffer provided. */
+  /** Reads the data from disk into the memory buffer provided. Only
+   * the pages and rows of the IORegion are decoded. */
   virtual void Read(void *buffer) ITK_OVERRIDE;
 
-  /** Reads 3D data from multi-pages tiff. */
+  /** Reads 3D data from multi-pages tiff. The pages of the IORegion
+   * are read. */
   virtual void ReadVolume(void *buffer);
 
+  /** Tiff files can be read by region. */
+  virtual bool CanStreamRead() ITK_OVERRIDE
+  {
+    return true;
+  }
+
+  /** Calculate the region of the image that can be efficiently read
+   *  in response to a given requested region. This is the requested
+   *  region when UseStreamedReading is on, the whole image otherwise. */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const ITK_OVERRIDE;
+
   /*-------- This part of the interfaces deals with writing data. ----- */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -168,15 +182,20 @@ private:
   TIFFImageIO(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
+  /** Reads the rows of the IORegion from the current page. */
   void ReadCurrentPage(void *out, size_t pixelOffset);
 
   template <typename TComponent>
   void ReadGenericImage(void *out,
                         unsigned int width,
-                        unsigned int height);
+                        unsigned int height,
+                        unsigned int startX,
+                        unsigned int startY,
+                        unsigned int sizeX,
+                        unsigned int sizeY);
 
   template <typename TComponent>
-    void RGBAImageToBuffer( void *out, const uint32_t *tempImage );
+    void RGBAImageToBuffer( void *out, const uint32_t *tempImage, size_t numberOfPixels );
 
   template <typename TType>
     void PutGrayscale( TType *to, TType * from,
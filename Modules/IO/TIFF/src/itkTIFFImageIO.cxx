@@ -23,6 +23,8 @@
 
 #include "itk_tiff.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -57,23 +59,23 @@ void TIFFImageIO::ReadGenericImage(void *out,
 
   if ( m_ComponentType == UCHAR )
     {
-    this->ReadGenericImage<unsigned char>(out, width, height);
+    this->ReadGenericImage<unsigned char>(out, width, height, 0, 0, width, height);
     }
   else if ( m_ComponentType == CHAR )
     {
-    this->ReadGenericImage<char>(out, width, height);
+    this->ReadGenericImage<char>(out, width, height, 0, 0, width, height);
     }
   else if ( m_ComponentType == USHORT )
     {
-    this->ReadGenericImage<unsigned short>(out, width, height);
+    this->ReadGenericImage<unsigned short>(out, width, height, 0, 0, width, height);
     }
   else if ( m_ComponentType == SHORT )
     {
-    this->ReadGenericImage<short>(out, width, height);
+    this->ReadGenericImage<short>(out, width, height, 0, 0, width, height);
     }
   else if ( m_ComponentType == FLOAT )
     {
-    this->ReadGenericImage<float>(out, width, height);
+    this->ReadGenericImage<float>(out, width, height, 0, 0, width, height);
     }
 }
 
@@ -141,10 +143,24 @@ unsigned int TIFFImageIO::GetFormat()
 /** Read a multipage tiff */
 void TIFFImageIO::ReadVolume(void *buffer)
 {
-  const int width  = m_InternalImage->m_Width;
-  const int height = m_InternalImage->m_Height;
+  // the pages of the IORegion, numbered without the ignored subfiles
+  unsigned int firstPage = 0;
+  unsigned int numberOfPages = 1;
+  size_t       pageSizeInComponents = static_cast< size_t >( m_InternalImage->m_Width )
+    * static_cast< size_t >( m_InternalImage->m_Height );
+  if ( m_IORegion.GetImageDimension() > 2 )
+    {
+    firstPage = static_cast< unsigned int >( m_IORegion.GetIndex(2) );
+    numberOfPages = static_cast< unsigned int >( m_IORegion.GetSize(2) );
+    pageSizeInComponents = static_cast< size_t >( m_IORegion.GetSize(0) )
+      * static_cast< size_t >( m_IORegion.GetSize(1) );
+    }
+  pageSizeInComponents *= static_cast< size_t >( this->GetNumberOfComponents() );
 
-  for ( unsigned int page = 0; page < m_InternalImage->m_NumberOfPages; page++ )
+  unsigned int page = 0;
+  for ( unsigned int directory = 0;
+        directory < m_InternalImage->m_NumberOfPages && page < firstPage + numberOfPages;
+        directory++ )
     {
     if ( m_InternalImage->m_IgnoredSubFiles > 0 )
       {
@@ -162,15 +178,34 @@ void TIFFImageIO::ReadVolume(void *buffer)
       }
 
 
-    const size_t pixelOffset = static_cast<size_t>(width)
-      * static_cast<size_t>(height)
-      * static_cast<size_t>(this->GetNumberOfComponents())
-      * static_cast<size_t>(page);
+    // the pages before the region are skipped without being decoded
+    if ( page >= firstPage )
+      {
+      const size_t pixelOffset = pageSizeInComponents
+        * static_cast<size_t>(page - firstPage);
 
-    ReadCurrentPage(buffer, pixelOffset);
+      ReadCurrentPage(buffer, pixelOffset);
+      }
+    ++page;
 
     TIFFReadDirectory(m_InternalImage->m_Image);
     }
+
+  if ( page < firstPage + numberOfPages )
+    {
+    itkExceptionMacro(<< "Cannot read page " << page << " of " << m_FileName);
+    }
+}
+
+ImageIORegion
+TIFFImageIO
+::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const
+{
+  if ( !m_UseStreamedReading )
+    {
+    return Superclass::GenerateStreamableReadRegionFromRequestedRegion(requestedRegion);
+    }
+  return requestedRegion;
 }
 
 void TIFFImageIO::Read(void *buffer)
@@ -1103,34 +1138,66 @@ void TIFFImageIO::ReadTIFFTags()
 
 void TIFFImageIO::ReadCurrentPage(void *buffer, size_t pixelOffset)
 {
-  const int width  = m_InternalImage->m_Width;
-  const int height = m_InternalImage->m_Height;
-
+  const unsigned int width  = m_InternalImage->m_Width;
+  const unsigned int height = m_InternalImage->m_Height;
+
+  // the part of the page in the IORegion
+  unsigned int startX = 0;
+  unsigned int startY = 0;
+  unsigned int sizeX = width;
+  unsigned int sizeY = height;
+  if ( m_IORegion.GetImageDimension() > 1 )
+    {
+    startX = static_cast< unsigned int >( m_IORegion.GetIndex(0) );
+    startY = static_cast< unsigned int >( m_IORegion.GetIndex(1) );
+    sizeX = static_cast< unsigned int >( m_IORegion.GetSize(0) );
+    sizeY = static_cast< unsigned int >( m_IORegion.GetSize(1) );
+    }
 
   if ( !m_InternalImage->CanRead() )
     {
-    uint32 *tempImage = ITK_NULLPTR;
-
-    if ( this->GetNumberOfComponents() == 4 &&
-         m_ComponentType == UCHAR )
-      {
-      tempImage = (uint32*)(buffer) + (pixelOffset/4);
-      }
-    else
+    if ( this->GetNumberOfComponents() != 4 ||
+         m_ComponentType != UCHAR )
       {
       itkExceptionMacro("Logic Error: Unexpected buffer type!")
       }
 
-    if ( !TIFFReadRGBAImageOriented(m_InternalImage->m_Image,
-                                    width, height,
-                                    tempImage, ORIENTATION_TOPLEFT, 1) )
+    unsigned char *out = (unsigned char *)(buffer) + pixelOffset;
+
+    if ( sizeX == width && sizeY == height )
       {
-      itkExceptionMacro(<< "Cannot read TIFF image or as a TIFF RGBA image");
+      // decode in place
+      uint32 *tempImage = (uint32*)(buffer) + (pixelOffset/4);
+
+      if ( !TIFFReadRGBAImageOriented(m_InternalImage->m_Image,
+                                      width, height,
+                                      tempImage, ORIENTATION_TOPLEFT, 1) )
+        {
+        itkExceptionMacro(<< "Cannot read TIFF image or as a TIFF RGBA image");
+        }
+
+      RGBAImageToBuffer<unsigned char>(out, tempImage, static_cast< size_t >( width ) * height);
       }
+    else
+      {
+      // the whole page is decoded, and the rows of the region are
+      // copied from it
+      std::vector< uint32 > tempImage( static_cast< size_t >( width ) * height );
 
-    unsigned char *out = (unsigned char *)(buffer) + pixelOffset;
-    RGBAImageToBuffer<unsigned char>(out, tempImage);
+      if ( !TIFFReadRGBAImageOriented(m_InternalImage->m_Image,
+                                      width, height,
+                                      &tempImage[0], ORIENTATION_TOPLEFT, 1) )
+        {
+        itkExceptionMacro(<< "Cannot read TIFF image or as a TIFF RGBA image");
+        }
 
+      for ( unsigned int y = 0; y < sizeY; ++y )
+        {
+        RGBAImageToBuffer<unsigned char>(out + static_cast< size_t >( y ) * sizeX * 4,
+                                         &tempImage[static_cast< size_t >( startY + y ) * width + startX],
+                                         sizeX);
+        }
+      }
     }
   else
     {
@@ -1142,31 +1209,31 @@ void TIFFImageIO::ReadCurrentPage(void *buffer, size_t pixelOffset)
       {
       unsigned short *volume = reinterpret_cast< unsigned short * >( buffer );
       volume += pixelOffset;
-      this->ReadGenericImage(volume, width, height);
+      this->ReadGenericImage< unsigned short >(volume, width, height, startX, startY, sizeX, sizeY);
       }
     else if ( m_ComponentType == SHORT )
       {
       short *volume = reinterpret_cast< short * >( buffer );
       volume += pixelOffset;
-      this->ReadGenericImage(volume, width, height);
+      this->ReadGenericImage< short >(volume, width, height, startX, startY, sizeX, sizeY);
       }
     else if ( m_ComponentType == CHAR )
       {
       char *volume = reinterpret_cast< char * >( buffer );
       volume += pixelOffset;
-      this->ReadGenericImage(volume, width, height);
+      this->ReadGenericImage< char >(volume, width, height, startX, startY, sizeX, sizeY);
       }
     else if ( m_ComponentType == FLOAT )
       {
       float *volume = reinterpret_cast< float * >( buffer );
       volume += pixelOffset;
-      this->ReadGenericImage(volume, width, height);
+      this->ReadGenericImage< float >(volume, width, height, startX, startY, sizeX, sizeY);
       }
     else
       {
       unsigned char *volume = reinterpret_cast< unsigned char * >( buffer );
       volume += pixelOffset;
-      this->ReadGenericImage(volume, width, height);
+      this->ReadGenericImage< unsigned char >(volume, width, height, startX, startY, sizeX, sizeY);
       }
     }
 
@@ -1175,7 +1242,11 @@ void TIFFImageIO::ReadCurrentPage(void *buffer, size_t pixelOffset)
 template <typename TComponent>
 void TIFFImageIO::ReadGenericImage(void *_out,
                                    unsigned int width,
-                                   unsigned int height)
+                                   unsigned int height,
+                                   unsigned int startX,
+                                   unsigned int startY,
+                                   unsigned int sizeX,
+                                   unsigned int sizeY)
 {
   typedef TComponent ComponentType;
 
@@ -1221,40 +1292,63 @@ void TIFFImageIO::ReadGenericImage(void *_out,
       break;
     }
 
-  for ( int row = 0; row < (int)height; ++row )
+  // Only the rows of the region are read, in increasing order so
+  // that compressed strips are not decoded more than once
+  const unsigned int firstRow = ( m_InternalImage->m_Orientation == ORIENTATION_TOPLEFT )
+                                ? startY : height - ( startY + sizeY );
+  const unsigned int endRow = firstRow + sizeY;
+  const size_t       fromStart = ( this->GetFormat() == TIFFImageIO::RGB_ ) ? startX * inc : startX;
+
+  // compressed strips can only be decoded from their first row
+  unsigned int row = firstRow;
+  if ( m_InternalImage->m_Compression != COMPRESSION_NONE )
+    {
+    uint32 rowsPerStrip = height;
+    TIFFGetFieldDefaulted(m_InternalImage->m_Image, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+    if ( rowsPerStrip > 0 )
+      {
+      row = ( firstRow / rowsPerStrip ) * rowsPerStrip;
+      }
+    }
+
+  for (; row < endRow; ++row )
     {
     if ( TIFFReadScanline(m_InternalImage->m_Image, buf, row, 0) <= 0 )
       {
       itkExceptionMacro(<< "Problem reading the row: " << row);
       }
+    if ( row < firstRow )
+      {
+      continue;
+      }
 
     if ( m_InternalImage->m_Orientation == ORIENTATION_TOPLEFT )
       {
-      image = out + (size_t) (row) * width * inc;
+      image = out + (size_t) ( row - startY ) * sizeX * inc;
       }
     else // bottom left
       {
-      image = out + (size_t) (width) * inc * ( height - ( row + 1 ) );
+      image = out + (size_t) (sizeX) * inc * ( height - ( row + 1 ) - startY );
       }
 
     switch ( this->GetFormat() )
       {
       case TIFFImageIO::GRAYSCALE:
         // check inverted
-        PutGrayscale<ComponentType>(image, static_cast< ComponentType * >( buf ), width, 1, 0, 0);
+        PutGrayscale<ComponentType>(image, static_cast< ComponentType * >( buf ) + fromStart, sizeX, 1, 0, 0);
         break;
       case TIFFImageIO::RGB_:
-        PutRGB_<ComponentType>(image, static_cast< ComponentType * >( buf ), width, 1, 0, 0);
+        PutRGB_<ComponentType>(image, static_cast< ComponentType * >( buf ) + fromStart, sizeX, 1, 0, 0);
         break;
 
       case TIFFImageIO::PALETTE_GRAYSCALE:
         switch ( m_InternalImage->m_BitsPerSample )
           {
           case 8:
-            PutPaletteGrayscale<ComponentType, unsigned char>(image, static_cast< unsigned char * >( buf ), width, 1, 0, 0);
+            PutPaletteGrayscale<ComponentType, unsigned char>(image, static_cast< unsigned char * >( buf ) + fromStart, sizeX, 1, 0, 0);
             break;
           case 16:
-            PutPaletteGrayscale<ComponentType, unsigned short>(image, static_cast< unsigned short * >( buf ), width, 1, 0, 0);
+            PutPaletteGrayscale<ComponentType, unsigned short>(image, static_cast< unsigned short * >( buf ) + fromStart, sizeX, 1, 0, 0);
             break;
           default:
             itkExceptionMacro(<<  "Sorry, can not handle image with "
@@ -1266,10 +1360,10 @@ void TIFFImageIO::ReadGenericImage(void *_out,
          switch ( m_InternalImage->m_BitsPerSample )
           {
           case 8:
-            PutPaletteRGB<ComponentType, unsigned char>(image, static_cast< unsigned char * >( buf ), width, 1, 0, 0);
+            PutPaletteRGB<ComponentType, unsigned char>(image, static_cast< unsigned char * >( buf ) + fromStart, sizeX, 1, 0, 0);
             break;
           case 16:
-            PutPaletteRGB<ComponentType, unsigned short>(image, static_cast< unsigned short * >( buf ), width, 1, 0, 0);
+            PutPaletteRGB<ComponentType, unsigned short>(image, static_cast< unsigned short * >( buf ) + fromStart, sizeX, 1, 0, 0);
             break;
           default:
             itkExceptionMacro(<<  "Sorry, can not handle image with "
@@ -1373,31 +1467,25 @@ void TIFFImageIO::PutPaletteGrayscale( TType *to, TFromType * from,
 
 
 template <typename TComponent>
-void  TIFFImageIO::RGBAImageToBuffer( void *out, const uint32_t *tempImage )
+void  TIFFImageIO::RGBAImageToBuffer( void *out, const uint32_t *tempImage, size_t numberOfPixels )
 {
   typedef TComponent ComponentType;
 
-  const int width  = m_InternalImage->m_Width;
-  const int height = m_InternalImage->m_Height;
-
   ComponentType *fimage = (ComponentType *)out;
 
-  for ( int yy = 0; yy < height; ++yy )
+  for ( size_t ii = 0; ii < numberOfPixels; ++ii )
     {
-    for ( int xx = 0; xx < width; ++xx )
-      {
-      const ComponentType red   = static_cast< ComponentType >( TIFFGetR(*tempImage) );
-      const ComponentType green = static_cast< ComponentType >( TIFFGetG(*tempImage) );
-      const ComponentType blue  = static_cast< ComponentType >( TIFFGetB(*tempImage) );
-      const ComponentType alpha = static_cast< ComponentType >( TIFFGetA(*tempImage) );
-
-      *( fimage  ) = red;
-      *( fimage + 1 ) = green;
-      *( fimage + 2 ) = blue;
-      *( fimage + 3 ) = alpha;
-      fimage += 4;
-      ++tempImage;
-      }
+    const ComponentType red   = static_cast< ComponentType >( TIFFGetR(*tempImage) );
+    const ComponentType green = static_cast< ComponentType >( TIFFGetG(*tempImage) );
+    const ComponentType blue  = static_cast< ComponentType >( TIFFGetB(*tempImage) );
+    const ComponentType alpha = static_cast< ComponentType >( TIFFGetA(*tempImage) );
+
+    *( fimage  ) = red;
+    *( fimage + 1 ) = green;
+    *( fimage + 2 ) = blue;
+    *( fimage + 3 ) = alpha;
+    fimage += 4;
+    ++tempImage;
     }
 }
 
@@ -19,6 +19,8 @@
 #define itkMorphologicalWatershedFromMarkersImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include <map>
+#include <vector>
 
 namespace itk
 {
@@ -63,6 +65,29 @@ namespace itk
  * Chapter 9.2 of Pierre Soille's book "Morphological Image Analysis:
  * Principles and Applications", Second Edition, Springer, 2003.
  *
+ * The pixels waiting to be flooded are stored in a hierarchical queue, a
+ * FIFO queue per gray level.  For integral pixel types of 8 or 16 bits,
+ * the queues are stored in an array indexed by gray level instead of a
+ * sorted map.
+ *
+ * \par Multithreading
+ * When NumberOfTiles is larger than one and MarkWatershedLine is off, the
+ * image is split along its last dimension into tiles which are flooded
+ * concurrently, each with its own hierarchical queue, from the markers
+ * they contain.  The flooding then goes on across the seams between the
+ * tiles, and in each tile, from the pixels which change.  The level of the
+ * flooding path of each pixel, its distance to the lowest pixel of that
+ * level and the neighbor it has been flooded from are kept for that.
+ * When several neighbors flood a pixel with paths as low, the pixel takes
+ * the label of the one with the shortest distance, and then the smallest
+ * label.  The sequential flooding takes the neighbor it has queued first
+ * instead, so the two segmentations may differ on the plateaus where two
+ * labels meet, but the tiled one does not depend on the number of tiles.
+ * The watershed lines stop the sequential flooding, so they are only
+ * drawn by the sequential flooding: with MarkWatershedLine, the image is
+ * flooded in one piece whatever NumberOfTiles.
+ * See SetNumberOfTiles().
+ *
  * This code was contributed in the Insight Journal paper:
  * "The watershed transform in ITK - discussion and new developments"
  * by Beare R., Lehmann G.
@@ -157,6 +182,23 @@ public:
   itkGetConstReferenceMacro(MarkWatershedLine, bool);
   itkBooleanMacro(MarkWatershedLine);
 
+  /**
+   * Set/Get the number of tiles the image is split into along its last
+   * dimension.  The tiles are flooded concurrently by the threads of the
+   * filter.  More tiles than threads balance the work better when the
+   * markers are unevenly spread.  The flooding needs three more images, of
+   * the levels, of the distances to the lowest pixels of the levels and of
+   * the neighbors the pixels are flooded from, when the image is split.
+   * The image is split only when MarkWatershedLine is off.
+   * Splitting is not free: with one thread, 2 tiles were about as fast as
+   * the sequential flooding, but 4 and 8 tiles were 1.3 to 2.4 times
+   * slower, so do not expect more than 2 tiles to be faster without
+   * several cores.
+   * Default is 1: the image is flooded sequentially in one piece.
+   */
+  itkSetClampMacro(NumberOfTiles, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfTiles, unsigned int);
+
 protected:
   MorphologicalWatershedFromMarkersImageFilter();
   ~MorphologicalWatershedFromMarkersImageFilter() {}
@@ -172,9 +214,127 @@ protected:
    * \sa ProcessObject::EnlargeOutputRequestedRegion() */
   void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) ITK_OVERRIDE;
 
-  /** The filter is single threaded. */
+  /** The filter is single threaded, unless NumberOfTiles is larger than
+   * one and MarkWatershedLine is off. */
   void GenerateData() ITK_OVERRIDE;
 
+  typedef typename LabelImageType::OffsetType OffsetType;
+
+  /** \class HierarchicalQueue
+   * FIFO queues of pixel indices, one per gray level, processed from the
+   * lowest level to the highest one.  The queue of the lowest level is
+   * given back as a whole, so that the pixels pushed back at that level
+   * during the flooding are appended to it.  The levels of the 8 and 16 bit
+   * integral pixel types index an array of queues; the other ones are
+   * sorted in a map.
+   * \ingroup ITKReview
+   */
+  class HierarchicalQueue
+  {
+  public:
+    typedef std::vector< IndexType > QueueType;
+
+    HierarchicalQueue();
+
+    void Push(const InputImagePixelType & value, const IndexType & index);
+
+    bool Empty() const
+    {
+      return m_Size == 0;
+    }
+
+    /** Swap the queue of the lowest level with queue, and return the
+     * level. */
+    InputImagePixelType PopLevel(QueueType & queue);
+
+  private:
+    typedef std::map< InputImagePixelType, QueueType > MapType;
+
+    static const bool UseArray = NumericTraits< InputImagePixelType >::is_integer
+                                 && sizeof( InputImagePixelType ) <= 2;
+
+    static SizeValueType GetBucket(const InputImagePixelType & value)
+    {
+      return static_cast< SizeValueType >( static_cast< OffsetValueType >( value )
+        - static_cast< OffsetValueType >( NumericTraits< InputImagePixelType >::NonpositiveMin() ) );
+    }
+
+    MapType                  m_Map;
+    std::vector< QueueType > m_Buckets;
+    SizeValueType            m_LowestBucket;
+    SizeValueType            m_Size;
+  };
+
+  /** The distance to the lowest pixel of the flooding level along the
+   * flooding path. */
+  typedef unsigned int                          DistanceType;
+  typedef Image< DistanceType, ImageDimension > DistanceImageType;
+
+  /** The position in the list of neighbor offsets of the pixel from which a
+   * pixel has been flooded. */
+  typedef unsigned char                       ParentType;
+  typedef Image< ParentType, ImageDimension > ParentImageType;
+
+  /** A pixel which has been flooded by another path than before. */
+  struct FloodedPixel
+  {
+    InputImagePixelType Level;
+    DistanceType        Distance;
+    IndexType           Index;
+  };
+
+  struct TileThreadStruct;
+  typedef void ( Self::*TileMethodType )(TileThreadStruct *, unsigned int);
+
+  /** The images and the tiles shared by the threads. */
+  struct TileThreadStruct
+  {
+    Pointer                                 Filter;
+    TileMethodType                          Method;
+    LabelImageRegionType                    Region;
+    LabelImageRegionType                    Interior;
+    std::vector< LabelImageRegionType >     TileRegions;
+    std::vector< OffsetType >               Offsets;
+    std::vector< OffsetValueType >          BufferOffsets;
+    const InputImagePixelType              *Input;
+    const LabelImagePixelType              *Markers;
+    LabelImagePixelType                    *Labels;
+    InputImagePixelType                    *Levels;
+    DistanceType                           *Distances;
+    ParentType                             *Parents;
+    const LabelImageType                   *Image;
+  };
+
+  /** Flood the image in tiles with several threads. */
+  void GenerateTiledData();
+
+  /** Flood a tile from the markers it contains. */
+  void FloodTile(TileThreadStruct *str, unsigned int tile);
+
+  /** Flood the neighbor of the pixel at index given by offset from that
+   * pixel, if that path is lower than the one of the neighbor, or as low
+   * and the pixel is flooded before the parent of the neighbor, or if the
+   * pixel is that parent and has another label.  Returns true and fills
+   * flooded if the neighbor has changed.  interior tells that all the
+   * neighbors of the pixel are in the image. */
+  static bool FloodNeighbor(TileThreadStruct *str, const IndexType & index, bool interior, unsigned int offset,
+                            FloodedPixel & flooded);
+
+  /** The pixels of region whose neighbors are all in region. */
+  static LabelImageRegionType GetInterior(const LabelImageRegionType & region);
+
+  /** Returns true if the pixel at offset a in the buffer is flooded before
+   * the pixel at offset b: a has a lower path, or a path as low and a
+   * shorter distance, or a path as low and as long and a smaller label. */
+  static bool IsFloodedBefore(const TileThreadStruct *str, OffsetValueType a, OffsetValueType b);
+
+  /** Call str->Method for a tile. */
+  static ITK_THREAD_RETURN_TYPE TileThreaderCallback(void *arg);
+
+  /** Execute str->Method for all the tiles with the threads of the
+   * filter. */
+  void ExecuteOnTiles(TileThreadStruct *str, TileMethodType method);
+
 private:
   //purposely not implemented
   MorphologicalWatershedFromMarkersImageFilter(const Self &);
@@ -183,6 +343,8 @@ private:
   bool m_FullyConnected;
 
   bool m_MarkWatershedLine;
+
+  unsigned int m_NumberOfTiles;
 }; // end of class
 } // end namespace itk
 
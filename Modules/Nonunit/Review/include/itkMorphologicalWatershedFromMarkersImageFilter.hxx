@@ -25,6 +25,8 @@
 #include "itkProgressReporter.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMultiThreader.h"
 #include "itkConstShapedNeighborhoodIterator.h"
 #include "itkConstantBoundaryCondition.h"
 #include "itkSize.h"
@@ -48,6 +50,7 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
   this->SetNumberOfRequiredInputs(2);
   m_FullyConnected = false;
   m_MarkWatershedLine = true;
+  m_NumberOfTiles = 1;
 }
 
 template< typename TInputImage, typename TLabelImage >
@@ -125,10 +128,19 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
     itkExceptionMacro(<< "Marker and input must have the same size.");
     }
 
+  // the tiles address the pixels of all the images with the same offsets,
+  // and store the positions of the 3^ImageDimension - 1 neighbors in a byte
+  if ( m_NumberOfTiles > 1 && !m_MarkWatershedLine && ImageDimension <= 5
+       && markerImage->GetBufferedRegion() == outputImage->GetBufferedRegion()
+       && inputImage->GetBufferedRegion() == outputImage->GetBufferedRegion() )
+    {
+    this->GenerateTiledData();
+    return;
+    }
+
   // FAH (in french: File d'Attente Hierarchique)
-  typedef std::queue< IndexType >                    QueueType;
-  typedef std::map< InputImagePixelType, QueueType > MapType;
-  MapType fah;
+  typedef typename HierarchicalQueue::QueueType QueueType;
+  HierarchicalQueue fah;
 
   // the radius which will be used for all the shaped iterators
   Size< ImageDimension > radius;
@@ -154,7 +166,7 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
 
   // iterator for the output image
   typedef ShapedNeighborhoodIterator< LabelImageType > OutputIteratorType;
-  typedef typename OutputIteratorType::OffsetType      OffsetType;
+  typedef typename OutputIteratorType::OffsetType      OutputOffsetType;
   typename OutputIteratorType::Iterator noIt;
   OutputIteratorType
   outputIt( radius, outputImage, outputImage->GetRequestedRegion() );
@@ -211,7 +223,7 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
         IndexType idx = markerIt.GetIndex();
 
         // move the iterators to the right place
-        OffsetType shift = idx - statusIt.GetIndex();
+        OutputOffsetType shift = idx - statusIt.GetIndex();
         statusIt += shift;
         inputIt += shift;
 
@@ -233,8 +245,8 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
             {
             // this neighbor is a background pixel and is not already
             // processed; add its index to fah
-            fah[niIt.Get()].push( markerIt.GetIndex()
-                                  + nmIt.GetNeighborhoodOffset() );
+            fah.Push( niIt.Get(), markerIt.GetIndex()
+                      + nmIt.GetNeighborhoodOffset() );
             // mark it as already in the fah to avoid adding it several times
             nsIt.Set(true);
             }
@@ -264,21 +276,19 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
     inputIt.GoToBegin();
 
     // and start flooding
-    while ( !fah.empty() )
+    QueueType currentQueue;
+    while ( !fah.Empty() )
       {
-      // store the current vars
-      InputImagePixelType currentValue = fah.begin()->first;
-      QueueType           currentQueue = fah.begin()->second;
-      // and remove them from the fah
-      fah.erase( fah.begin() );
+      // take the queue of the lowest level out of the fah; the pixels
+      // pushed at that level are appended to it
+      const InputImagePixelType currentValue = fah.PopLevel(currentQueue);
 
-      while ( !currentQueue.empty() )
+      for ( SizeValueType i = 0; i < currentQueue.size(); ++i )
         {
-        IndexType idx = currentQueue.front();
-        currentQueue.pop();
+        const IndexType idx = currentQueue[i];
 
         // move the iterators to the right place
-        OffsetType shift = idx - outputIt.GetIndex();
+        OutputOffsetType shift = idx - outputIt.GetIndex();
         outputIt += shift;
         statusIt += shift;
         inputIt += shift;
@@ -316,13 +326,13 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
               InputImagePixelType GrayVal = niIt.Get();
               if ( GrayVal <= currentValue )
                 {
-                currentQueue.push( inputIt.GetIndex()
-                                   + niIt.GetNeighborhoodOffset() );
+                currentQueue.push_back( inputIt.GetIndex()
+                                        + niIt.GetNeighborhoodOffset() );
                 }
               else
                 {
-                fah[GrayVal].push( inputIt.GetIndex()
-                                   + niIt.GetNeighborhoodOffset() );
+                fah.Push( GrayVal, inputIt.GetIndex()
+                          + niIt.GetNeighborhoodOffset() );
                 }
               // mark it as already in the fah
               nsIt.Set(true);
@@ -359,7 +369,7 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
       if ( markerPixel != bgLabel )
         {
         IndexType  idx = markerIt.GetIndex();
-        OffsetType shift = idx - inputIt.GetIndex();
+        OutputOffsetType shift = idx - inputIt.GetIndex();
         inputIt += shift;
 
         // this pixels belongs to a marker
@@ -378,7 +388,7 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
         if ( haveBgNeighbor )
           {
           // there is a background pixel in the neighborhood; add to fah
-          fah[inputIt.GetCenterPixel()].push( markerIt.GetIndex() );
+          fah.Push( inputIt.GetCenterPixel(), markerIt.GetIndex() );
           }
         else
           {
@@ -401,21 +411,19 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
     inputIt.GoToBegin();
 
     // and start flooding
-    while ( !fah.empty() )
+    QueueType currentQueue;
+    while ( !fah.Empty() )
       {
-      // store the current vars
-      InputImagePixelType currentValue = fah.begin()->first;
-      QueueType           currentQueue = fah.begin()->second;
-      // and remove them from the fah
-      fah.erase( fah.begin() );
+      // take the queue of the lowest level out of the fah; the pixels
+      // pushed at that level are appended to it
+      const InputImagePixelType currentValue = fah.PopLevel(currentQueue);
 
-      while ( !currentQueue.empty() )
+      for ( SizeValueType i = 0; i < currentQueue.size(); ++i )
         {
-        IndexType idx = currentQueue.front();
-        currentQueue.pop();
+        const IndexType idx = currentQueue[i];
 
         // move the iterators to the right place
-        OffsetType shift = idx - outputIt.GetIndex();
+        OutputOffsetType shift = idx - outputIt.GetIndex();
         outputIt += shift;
         inputIt += shift;
 
@@ -434,13 +442,13 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
             InputImagePixelType GrayVal = niIt.Get();
             if ( GrayVal <= currentValue )
               {
-              currentQueue.push( inputIt.GetIndex()
-                                 + noIt.GetNeighborhoodOffset() );
+              currentQueue.push_back( inputIt.GetIndex()
+                                      + noIt.GetNeighborhoodOffset() );
               }
             else
               {
-              fah[GrayVal].push( inputIt.GetIndex()
-                                 + noIt.GetNeighborhoodOffset() );
+              fah.Push( GrayVal, inputIt.GetIndex()
+                        + noIt.GetNeighborhoodOffset() );
               }
             progress.CompletedPixel();
             }
@@ -450,6 +458,451 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
     }
 }
 
+template< typename TInputImage, typename TLabelImage >
+void
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::GenerateTiledData()
+{
+  static const LabelImagePixelType bgLabel = NumericTraits< LabelImagePixelType >::ZeroValue();
+
+  LabelImagePointer outputImage = this->GetOutput();
+
+  // the level and the distance of the flooding path of each pixel, and the
+  // neighbor it has been flooded from
+  InputImagePointer levels = InputImageType::New();
+  levels->SetRegions( outputImage->GetBufferedRegion() );
+  levels->Allocate();
+  typename DistanceImageType::Pointer distances = DistanceImageType::New();
+  distances->SetRegions( outputImage->GetBufferedRegion() );
+  distances->Allocate();
+  typename ParentImageType::Pointer parents = ParentImageType::New();
+  parents->SetRegions( outputImage->GetBufferedRegion() );
+  parents->Allocate();
+
+  TileThreadStruct str;
+  str.Filter = this;
+  str.Region = outputImage->GetRequestedRegion();
+  str.Interior = Self::GetInterior(str.Region);
+  str.Input = this->GetInput()->GetBufferPointer();
+  str.Markers = this->GetMarkerImage()->GetBufferPointer();
+  str.Labels = outputImage->GetBufferPointer();
+  str.Levels = levels->GetBufferPointer();
+  str.Distances = distances->GetBufferPointer();
+  str.Parents = parents->GetBufferPointer();
+  str.Image = outputImage;
+
+  // the offsets of the neighbors, in the order of the shaped iterators
+  SizeValueType neighborhoodSize = 1;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    neighborhoodSize *= 3;
+    }
+  for ( SizeValueType n = 0; n < neighborhoodSize; ++n )
+    {
+    OffsetType    offset;
+    SizeValueType stride = n;
+    unsigned int  numberOfNonZeros = 0;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      offset[d] = static_cast< OffsetValueType >( stride % 3 ) - 1;
+      stride /= 3;
+      numberOfNonZeros += ( offset[d] != 0 );
+      }
+    if ( numberOfNonZeros == 1 || ( numberOfNonZeros > 1 && m_FullyConnected ) )
+      {
+      str.Offsets.push_back(offset);
+      str.BufferOffsets.push_back( outputImage->ComputeOffset( outputImage->GetBufferedRegion().GetIndex() + offset ) );
+      }
+    }
+
+  // split the image along its last dimension
+  const unsigned int  tileDimension = ImageDimension - 1;
+  const SizeValueType length = str.Region.GetSize(tileDimension);
+  const unsigned int  numberOfTiles = static_cast< unsigned int >(
+    std::max< SizeValueType >( 1, std::min< SizeValueType >( m_NumberOfTiles, length ) ) );
+  for ( unsigned int t = 0; t < numberOfTiles; ++t )
+    {
+    const IndexValueType begin = str.Region.GetIndex(tileDimension)
+                                 + static_cast< IndexValueType >( ( t * length ) / numberOfTiles );
+    const IndexValueType end = str.Region.GetIndex(tileDimension)
+                               + static_cast< IndexValueType >( ( ( t + 1 ) * length ) / numberOfTiles );
+    LabelImageRegionType tileRegion = str.Region;
+    tileRegion.SetIndex(tileDimension, begin);
+    tileRegion.SetSize(tileDimension, end - begin);
+    str.TileRegions.push_back(tileRegion);
+    }
+
+  // flood each tile from its own markers
+  this->ExecuteOnTiles(&str, &Self::FloodTile);
+  this->UpdateProgress(0.6f);
+
+  // Flood each side of the seams from the other one, and go on, by level,
+  // from the pixels which have changed.  Within a level, the pixels are
+  // taken in the order they change, so a pixel may be taken again when a
+  // shorter path reaches it later.
+  typedef typename HierarchicalQueue::QueueType QueueType;
+  HierarchicalQueue fah;
+  FloodedPixel      flooded;
+  for ( unsigned int t = 0; t + 1 < numberOfTiles; ++t )
+    {
+    for ( unsigned int side = 0; side < 2; ++side )
+      {
+      LabelImageRegionType seamRegion = str.TileRegions[t + side];
+      if ( side == 0 )
+        {
+        seamRegion.SetIndex( tileDimension, str.TileRegions[t + 1].GetIndex(tileDimension) - 1 );
+        }
+      seamRegion.SetSize(tileDimension, 1);
+      const OffsetValueType across = ( side == 0 ) ? 1 : -1;
+      for ( ImageRegionConstIteratorWithIndex< LabelImageType > it(outputImage, seamRegion); !it.IsAtEnd(); ++it )
+        {
+        for ( unsigned int o = 0; o < str.Offsets.size(); ++o )
+          {
+          if ( str.Offsets[o][tileDimension] == across
+               && Self::FloodNeighbor(&str, it.GetIndex(), false, o, flooded) )
+            {
+            fah.Push(flooded.Level, flooded.Index);
+            }
+          }
+        }
+      }
+    }
+  QueueType currentQueue;
+  while ( !fah.Empty() )
+    {
+    const InputImagePixelType currentValue = fah.PopLevel(currentQueue);
+    for ( SizeValueType i = 0; i < currentQueue.size(); ++i )
+      {
+      const IndexType       index = currentQueue[i];
+      const OffsetValueType offset = outputImage->ComputeOffset(index);
+      const bool            interior = str.Interior.IsInside(index);
+      if ( str.Levels[offset] != currentValue )
+        {
+        // already taken at a lower level
+        continue;
+        }
+      // the neighbor the pixel has been flooded from may have changed its
+      // label, and come after another one
+      const InputImagePixelType grayVal = str.Input[offset];
+      const DistanceType        distance = str.Distances[offset];
+      for ( unsigned int o = 0; o < str.Offsets.size(); ++o )
+        {
+        const OffsetValueType neighborOffset = offset - str.BufferOffsets[o];
+        if ( ( !interior && !str.Region.IsInside(index - str.Offsets[o]) )
+             || str.Labels[neighborOffset] == bgLabel
+             || !Self::IsFloodedBefore( &str, neighborOffset, offset - str.BufferOffsets[str.Parents[offset]] ) )
+          {
+          continue;
+          }
+        const InputImagePixelType level = str.Levels[neighborOffset];
+        if ( ( grayVal > level && currentValue == grayVal && distance == 0 )
+             || ( grayVal <= level && currentValue == level && distance == str.Distances[neighborOffset] + 1 ) )
+          {
+          str.Labels[offset] = str.Labels[neighborOffset];
+          str.Parents[offset] = static_cast< ParentType >( o );
+          }
+        }
+      for ( unsigned int o = 0; o < str.Offsets.size(); ++o )
+        {
+        if ( Self::FloodNeighbor(&str, index, interior, o, flooded) )
+          {
+          if ( flooded.Level == currentValue )
+            {
+            currentQueue.push_back(flooded.Index);
+            }
+          else
+            {
+            fah.Push(flooded.Level, flooded.Index);
+            }
+          }
+        }
+      }
+    }
+  this->UpdateProgress(1.0f);
+}
+
+template< typename TInputImage, typename TLabelImage >
+void
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::FloodTile(TileThreadStruct *str, unsigned int tile)
+{
+  static const LabelImagePixelType bgLabel = NumericTraits< LabelImagePixelType >::ZeroValue();
+
+  const LabelImageRegionType & tileRegion = str->TileRegions[tile];
+  const LabelImageRegionType   tileInterior = Self::GetInterior(tileRegion);
+  const unsigned int           numberOfOffsets = static_cast< unsigned int >( str->Offsets.size() );
+
+  // copy the markers, which are flooded at their own level
+  ImageRegionConstIteratorWithIndex< LabelImageType > it(str->Image, tileRegion);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const OffsetValueType offset = str->Image->ComputeOffset( it.GetIndex() );
+    str->Labels[offset] = str->Markers[offset];
+    str->Levels[offset] = str->Input[offset];
+    str->Distances[offset] = 0;
+    str->Parents[offset] = 0;
+    }
+
+  // the markers with a background neighbor in the tile start the flooding
+  HierarchicalQueue fah;
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const OffsetValueType offset = str->Image->ComputeOffset( it.GetIndex() );
+    if ( str->Markers[offset] == bgLabel )
+      {
+      continue;
+      }
+    for ( unsigned int o = 0; o < numberOfOffsets; ++o )
+      {
+      if ( tileRegion.IsInside( it.GetIndex() + str->Offsets[o] )
+           && str->Markers[offset + str->BufferOffsets[o]] == bgLabel )
+        {
+        fah.Push( str->Input[offset], it.GetIndex() );
+        break;
+        }
+      }
+    }
+
+  // Beucher's flooding, which keeps the level, the distance and the parent
+  // of each pixel.  The pixels are taken by level, then by distance, so a
+  // pixel is reached first by its lowest path, and all the others as low
+  // reach it before it is taken: it keeps the first flooded parent.
+  typename HierarchicalQueue::QueueType currentQueue;
+  while ( !fah.Empty() )
+    {
+    const InputImagePixelType currentValue = fah.PopLevel(currentQueue);
+    for ( SizeValueType i = 0; i < currentQueue.size(); ++i )
+      {
+      const IndexType       index = currentQueue[i];
+      const OffsetValueType offset = str->Image->ComputeOffset(index);
+      const bool            interior = tileInterior.IsInside(index);
+      for ( unsigned int o = 0; o < numberOfOffsets; ++o )
+        {
+        const IndexType neighbor = index + str->Offsets[o];
+        if ( !interior && !tileRegion.IsInside(neighbor) )
+          {
+          continue;
+          }
+        const OffsetValueType     neighborOffset = offset + str->BufferOffsets[o];
+        const InputImagePixelType grayVal = str->Input[neighborOffset];
+        if ( str->Labels[neighborOffset] != bgLabel )
+          {
+          if ( str->Markers[neighborOffset] == bgLabel
+               && str->Levels[neighborOffset] == std::max(grayVal, currentValue)
+               && str->Distances[neighborOffset] == ( grayVal <= currentValue ? str->Distances[offset] + 1 : 0 )
+               && Self::IsFloodedBefore( str, offset,
+                                         neighborOffset - str->BufferOffsets[str->Parents[neighborOffset]] ) )
+            {
+            str->Labels[neighborOffset] = str->Labels[offset];
+            str->Parents[neighborOffset] = static_cast< ParentType >( o );
+            }
+          continue;
+          }
+        str->Labels[neighborOffset] = str->Labels[offset];
+        str->Parents[neighborOffset] = static_cast< ParentType >( o );
+        if ( grayVal <= currentValue )
+          {
+          str->Levels[neighborOffset] = currentValue;
+          str->Distances[neighborOffset] = str->Distances[offset] + 1;
+          currentQueue.push_back(neighbor);
+          }
+        else
+          {
+          str->Levels[neighborOffset] = grayVal;
+          str->Distances[neighborOffset] = 0;
+          fah.Push(grayVal, neighbor);
+          }
+        }
+      }
+    }
+}
+
+template< typename TInputImage, typename TLabelImage >
+bool
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::FloodNeighbor(TileThreadStruct *str, const IndexType & index, bool interior, unsigned int o,
+                FloodedPixel & flooded)
+{
+  static const LabelImagePixelType bgLabel = NumericTraits< LabelImagePixelType >::ZeroValue();
+
+  flooded.Index = index + str->Offsets[o];
+  if ( !interior && !str->Region.IsInside(flooded.Index) )
+    {
+    return false;
+    }
+  const OffsetValueType offset = str->Image->ComputeOffset(index);
+  const OffsetValueType neighborOffset = offset + str->BufferOffsets[o];
+  if ( str->Labels[offset] == bgLabel || str->Markers[neighborOffset] != bgLabel )
+    {
+    return false;
+    }
+
+  flooded.Level = str->Levels[offset];
+  flooded.Distance = str->Distances[offset] + 1;
+  const InputImagePixelType grayVal = str->Input[neighborOffset];
+  if ( grayVal > flooded.Level )
+    {
+    flooded.Level = grayVal;
+    flooded.Distance = 0;
+    }
+
+  if ( str->Labels[neighborOffset] != bgLabel )
+    {
+    if ( flooded.Level > str->Levels[neighborOffset]
+         || ( flooded.Level == str->Levels[neighborOffset] && flooded.Distance > str->Distances[neighborOffset] ) )
+      {
+      return false;
+      }
+    if ( flooded.Level == str->Levels[neighborOffset] && flooded.Distance == str->Distances[neighborOffset] )
+      {
+      // a path as low: the neighbor changes only if its parent is this pixel
+      // and has another label, or if it comes after this pixel
+      const ParentType parent = str->Parents[neighborOffset];
+      if ( parent == o )
+        {
+        if ( str->Labels[neighborOffset] == str->Labels[offset] )
+          {
+          return false;
+          }
+        }
+      else if ( !Self::IsFloodedBefore(str, offset, neighborOffset - str->BufferOffsets[parent]) )
+        {
+        return false;
+        }
+      }
+    }
+
+  str->Labels[neighborOffset] = str->Labels[offset];
+  str->Levels[neighborOffset] = flooded.Level;
+  str->Distances[neighborOffset] = flooded.Distance;
+  str->Parents[neighborOffset] = static_cast< ParentType >( o );
+  return true;
+}
+
+template< typename TInputImage, typename TLabelImage >
+typename MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >::LabelImageRegionType
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::GetInterior(const LabelImageRegionType & region)
+{
+  LabelImageRegionType interior = region;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    const SizeValueType size = region.GetSize(d);
+    interior.SetIndex(d, region.GetIndex(d) + 1);
+    interior.SetSize(d, size > 2 ? size - 2 : 0);
+    }
+  return interior;
+}
+
+template< typename TInputImage, typename TLabelImage >
+bool
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::IsFloodedBefore(const TileThreadStruct *str, OffsetValueType a, OffsetValueType b)
+{
+  if ( str->Levels[a] != str->Levels[b] )
+    {
+    return str->Levels[a] < str->Levels[b];
+    }
+  if ( str->Distances[a] != str->Distances[b] )
+    {
+    return str->Distances[a] < str->Distances[b];
+    }
+  return str->Labels[a] < str->Labels[b];
+}
+
+template< typename TInputImage, typename TLabelImage >
+ITK_THREAD_RETURN_TYPE
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::TileThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  TileThreadStruct *str = static_cast< TileThreadStruct * >( info->UserData );
+  const ThreadIdType t = info->WorkUnitID;
+  if ( t < str->TileRegions.size() )
+    {
+    ( str->Filter->*( str->Method ) )( str, t );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TInputImage, typename TLabelImage >
+void
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::ExecuteOnTiles(TileThreadStruct *str, TileMethodType method)
+{
+  const unsigned int numberOfTiles = static_cast< unsigned int >( str->TileRegions.size() );
+  str->Method = method;
+
+  // the threads which are done take the tiles left by the others
+  // A local threader is used so that the MultiThreader of the filter
+  // keeps its number of threads.
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( std::min< ThreadIdType >( this->GetNumberOfThreads(), numberOfTiles ) );
+  threader->SetSingleMethod(Self::TileThreaderCallback, str);
+  threader->SetNumberOfWorkUnits(numberOfTiles);
+  threader->SingleMethodExecute();
+}
+
+template< typename TInputImage, typename TLabelImage >
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::HierarchicalQueue::HierarchicalQueue():
+  m_LowestBucket(0),
+  m_Size(0)
+{
+  if ( UseArray )
+    {
+    m_Buckets.resize( SizeValueType(1) << ( 8 * sizeof( InputImagePixelType ) ) );
+    m_LowestBucket = m_Buckets.size();
+    }
+}
+
+template< typename TInputImage, typename TLabelImage >
+void
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::HierarchicalQueue::Push(const InputImagePixelType & value, const IndexType & index)
+{
+  ++m_Size;
+  if ( UseArray )
+    {
+    const SizeValueType bucket = GetBucket(value);
+    m_Buckets[bucket].push_back(index);
+    m_LowestBucket = std::min(m_LowestBucket, bucket);
+    }
+  else
+    {
+    m_Map[value].push_back(index);
+    }
+}
+
+template< typename TInputImage, typename TLabelImage >
+typename MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >::InputImagePixelType
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::HierarchicalQueue::PopLevel(QueueType & queue)
+{
+  // release the queue of the previous level
+  QueueType().swap(queue);
+
+  InputImagePixelType value;
+  if ( UseArray )
+    {
+    while ( m_Buckets[m_LowestBucket].empty() )
+      {
+      ++m_LowestBucket;
+      }
+    queue.swap(m_Buckets[m_LowestBucket]);
+    value = static_cast< InputImagePixelType >( static_cast< OffsetValueType >( m_LowestBucket )
+      + static_cast< OffsetValueType >( NumericTraits< InputImagePixelType >::NonpositiveMin() ) );
+    }
+  else
+    {
+    value = m_Map.begin()->first;
+    queue.swap(m_Map.begin()->second);
+    m_Map.erase( m_Map.begin() );
+    }
+  m_Size -= queue.size();
+  return value;
+}
+
 template< typename TInputImage, typename TLabelImage >
 void
 MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
@@ -459,6 +912,7 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
 
   os << indent << "FullyConnected: "  << m_FullyConnected << std::endl;
   os << indent << "MarkWatershedLine: "  << m_MarkWatershedLine << std::endl;
+  os << indent << "NumberOfTiles: "  << m_NumberOfTiles << std::endl;
 }
 } // end namespace itk
 #endif
@@ -110,6 +110,14 @@ public:
   itkSetMacro(Level, InputImagePixelType);
   itkGetConstMacro(Level, InputImagePixelType);
 
+  /**
+   * Set/Get the number of tiles flooded concurrently by the watershed.
+   * The tiles are used only when MarkWatershedLine is off.  Default is 1.
+   * \sa MorphologicalWatershedFromMarkersImageFilter::SetNumberOfTiles()
+   */
+  itkSetClampMacro(NumberOfTiles, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfTiles, unsigned int);
+
 protected:
   MorphologicalWatershedImageFilter();
   ~MorphologicalWatershedImageFilter() {}
@@ -136,6 +144,8 @@ private:
   bool m_MarkWatershedLine;
 
   InputImagePixelType m_Level;
+
+  unsigned int m_NumberOfTiles;
 }; // end of class
 } // end namespace itk
 
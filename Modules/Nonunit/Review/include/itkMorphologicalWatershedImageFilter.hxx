@@ -43,6 +43,7 @@ MorphologicalWatershedImageFilter< TInputImage, TOutputImage >
   m_FullyConnected = false;
   m_MarkWatershedLine = true;
   m_Level = NumericTraits< InputImagePixelType >::ZeroValue();
+  m_NumberOfTiles = 1;
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -110,6 +111,8 @@ MorphologicalWatershedImageFilter< TInputImage, TOutputImage >
   wshed->SetMarkerImage( label->GetOutput() );
   wshed->SetFullyConnected(m_FullyConnected);
   wshed->SetMarkWatershedLine(m_MarkWatershedLine);
+  wshed->SetNumberOfTiles(m_NumberOfTiles);
+  wshed->SetNumberOfThreads( this->GetNumberOfThreads() );
 
   if ( m_Level != NumericTraits< InputImagePixelType >::ZeroValue() )
     {
@@ -160,6 +163,7 @@ MorphologicalWatershedImageFilter< TInputImage, TOutputImage >
   os << indent << "Level: "
      << static_cast< typename NumericTraits< InputImagePixelType >::PrintType >( m_Level )
      << std::endl;
+  os << indent << "NumberOfTiles: " << m_NumberOfTiles << std::endl;
 }
 } // end namespace itk
 #endif
@@ -0,0 +1,198 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMorphologicalWatershedFromMarkersImageFilter.h"
+#include "itkMorphologicalWatershedImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+
+namespace
+{
+
+/** Returns the number of pixels which differ. */
+template< typename TLabelImage >
+itk::SizeValueType CountDifferences( const TLabelImage *labels, const TLabelImage *reference )
+{
+  itk::SizeValueType numberOfDifferences = 0;
+  itk::ImageRegionConstIterator< TLabelImage > it( labels, reference->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< TLabelImage > rit( reference, reference->GetLargestPossibleRegion() );
+  for( ; !rit.IsAtEnd(); ++it, ++rit )
+    {
+    numberOfDifferences += ( it.Get() != rit.Get() );
+    }
+  return numberOfDifferences;
+}
+
+/** Checks that the markers keep their labels. */
+template< typename TLabelImage >
+bool CheckMarkers( const TLabelImage *labels, const TLabelImage *markers )
+{
+  itk::ImageRegionConstIterator< TLabelImage > it( labels, markers->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< TLabelImage > mit( markers, markers->GetLargestPossibleRegion() );
+  for( ; !mit.IsAtEnd(); ++it, ++mit )
+    {
+    if( mit.Get() != 0 && it.Get() != mit.Get() )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+/** Floods the input image from the markers in one piece, then in tiles
+ * with several numbers of threads.  Without the watershed lines, the tiled
+ * segmentation must not depend on the number of tiles, and may differ from
+ * the sequential one only on the plateaus where two labels meet (see
+ * MorphologicalWatershedFromMarkersImageFilter::SetNumberOfTiles()), so a
+ * small fraction of the pixels may differ.  With the watershed lines, the
+ * image is flooded in one piece whatever the number of tiles. */
+int itkMorphologicalWatershedFromMarkersImageFilterTest2( int argc, char * argv[] )
+{
+  if( argc < 3 )
+    {
+    std::cerr << "Usage: " << argv[0] << " inputImage markerImage [maximumFractionOfDifferences]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Image< unsigned char, 2 >   ImageType;
+  typedef itk::Image< unsigned short, 2 >  LabelImageType;
+  typedef itk::ImageFileReader< ImageType >      ReaderType;
+  typedef itk::ImageFileReader< LabelImageType > LabelReaderType;
+  typedef itk::MorphologicalWatershedFromMarkersImageFilter< ImageType, LabelImageType > FilterType;
+  typedef itk::MorphologicalWatershedImageFilter< ImageType, LabelImageType >            WatershedType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  LabelReaderType::Pointer markerReader = LabelReaderType::New();
+  markerReader->SetFileName( argv[2] );
+
+  try
+    {
+    reader->Update();
+    markerReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double maximumFractionOfDifferences = 0.0;
+  if( argc > 3 )
+    {
+    maximumFractionOfDifferences = atof( argv[3] );
+    }
+  const double numberOfPixels = reader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels();
+  const unsigned int numberOfTiles[] = { 2, 3, 7 };
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 2, 4 };
+
+  bool passed = true;
+  for( unsigned int m = 0; m < 2; ++m )
+    {
+    for( unsigned int f = 0; f < 2; ++f )
+      {
+      FilterType::Pointer reference = FilterType::New();
+      reference->SetInput( reader->GetOutput() );
+      reference->SetMarkerImage( markerReader->GetOutput() );
+      reference->SetMarkWatershedLine( m );
+      reference->SetFullyConnected( f );
+      reference->Update();
+
+      LabelImageType::Pointer firstTiled;
+      for( unsigned int t = 0; t < 3; ++t )
+        {
+        FilterType::Pointer filter = FilterType::New();
+        filter->SetInput( reader->GetOutput() );
+        filter->SetMarkerImage( markerReader->GetOutput() );
+        filter->SetMarkWatershedLine( m );
+        filter->SetFullyConnected( f );
+        filter->SetNumberOfTiles( numberOfTiles[t] );
+        filter->SetNumberOfThreads( numbersOfThreads[t] );
+        filter->GetMultiThreader()->SetNumberOfThreads( 5 );
+        filter->Update();
+
+        const itk::SizeValueType differences =
+          CountDifferences< LabelImageType >( filter->GetOutput(), reference->GetOutput() );
+        std::cout << "M" << m << "F" << f << ": " << differences << " pixels (a fraction of "
+                  << differences / numberOfPixels << ") differ with " << numberOfTiles[t] << " tiles and "
+                  << numbersOfThreads[t] << " threads" << std::endl;
+        if( !CheckMarkers< LabelImageType >( filter->GetOutput(), markerReader->GetOutput() ) )
+          {
+          std::cerr << "M" << m << "F" << f << ": a marker has lost its label with " << numberOfTiles[t]
+                    << " tiles" << std::endl;
+          passed = false;
+          }
+        if( differences > ( m ? 0.0 : maximumFractionOfDifferences * numberOfPixels ) )
+          {
+          std::cerr << "M" << m << "F" << f << ": the segmentation differs from the sequential one with "
+                    << numberOfTiles[t] << " tiles" << std::endl;
+          passed = false;
+          }
+        if( t == 0 )
+          {
+          firstTiled = filter->GetOutput();
+          firstTiled->DisconnectPipeline();
+          }
+        else if( CountDifferences< LabelImageType >( filter->GetOutput(), firstTiled ) != 0 )
+          {
+          std::cerr << "M" << m << "F" << f << ": the segmentation depends on the number of tiles" << std::endl;
+          passed = false;
+          }
+        // the tiles are flooded without changing the MultiThreader of the filter
+        if( filter->GetMultiThreader()->GetNumberOfThreads() != 5 )
+          {
+          std::cerr << "The filter changed the number of threads of its MultiThreader to "
+                    << filter->GetMultiThreader()->GetNumberOfThreads() << std::endl;
+          passed = false;
+          }
+        }
+      }
+    }
+
+  // the tiles are passed to the watershed from the regional minima
+  WatershedType::Pointer watershedReference = WatershedType::New();
+  watershedReference->SetInput( reader->GetOutput() );
+  watershedReference->SetMarkWatershedLine( false );
+  watershedReference->SetLevel( 10 );
+  watershedReference->Update();
+  WatershedType::Pointer watershed = WatershedType::New();
+  watershed->SetInput( reader->GetOutput() );
+  watershed->SetMarkWatershedLine( false );
+  watershed->SetLevel( 10 );
+  watershed->SetNumberOfTiles( 4 );
+  watershed->Update();
+  const itk::SizeValueType differences =
+    CountDifferences< LabelImageType >( watershed->GetOutput(), watershedReference->GetOutput() );
+  std::cout << "MorphologicalWatershedImageFilter: " << differences << " pixels differ with 4 tiles" << std::endl;
+  if( watershed->GetNumberOfTiles() != 4 || differences > maximumFractionOfDifferences * numberOfPixels )
+    {
+    std::cerr << "MorphologicalWatershedImageFilter: the tiles differ from the sequential flooding" << std::endl;
+    passed = false;
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -508,10 +508,8 @@ ANTSNeighborhoodCorrelationImageToImageMetricv4GetValueAndDerivativeThreader< TD
     JacobianReferenceType jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
 
     /** For dense transforms, this returns identity */
-    this->m_Associate->GetMovingTransform()->
-      ComputeJacobianWithRespectToParametersCachedTemporaries(scanMem.virtualPoint,
-                                                              jacobian,
-                                                              jacobianPositional);
+    this->m_Associate->ComputeMovingTransformJacobian( scanMem.virtualPoint,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].VirtualSample, jacobian, jacobianPositional );
 
     NumberOfParametersType numberOfLocalParameters = this->m_Associate->GetMovingTransform()->GetNumberOfLocalParameters();
 
@@ -295,10 +295,8 @@ CorrelationImageToImageMetricv4GetValueAndDerivativeThreader<TDomainPartitioner,
     JacobianReferenceType jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
 
     /** For dense transforms, this returns identity */
-    this->m_CorrelationAssociate->GetMovingTransform()->
-      ComputeJacobianWithRespectToParametersCachedTemporaries(virtualPoint,
-                                                              jacobian,
-                                                              jacobianPositional);
+    this->m_CorrelationAssociate->ComputeMovingTransformJacobian( virtualPoint,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].VirtualSample, jacobian, jacobianPositional );
 
     for (unsigned int par = 0; par < this->m_CorrelationAssociate->GetNumberOfLocalParameters(); par++)
       {
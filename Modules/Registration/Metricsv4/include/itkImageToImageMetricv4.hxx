@@ -67,6 +67,11 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   this->m_UseMovingImageGradientFilter = true;
   this->m_UseFixedSampledPointSet      = false;
 
+  this->m_UseCachingOfBSplineWeights = false;
+  this->m_MovingBSplineTransform = ITK_NULLPTR;
+  this->m_MovingBSplineCompositeTransform = ITK_NULLPTR;
+  this->m_BSplineWeightsCacheTransform = ITK_NULLPTR;
+
   this->m_FloatingPointCorrectionResolution = 1e6;
   this->m_UseFloatingPointCorrection = false;
 
@@ -152,6 +157,10 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
     this->MapFixedSampledPointSetToVirtual();
     }
 
+  /* The points of the virtual domain may have changed. */
+  this->m_BSplineWeightsCache.clear();
+  this->m_BSplineWeightsCacheTransform = ITK_NULLPTR;
+
   /* Inititialize interpolators. */
   itkDebugMacro("Initialize Interpolators");
   this->m_FixedInterpolator->SetInputImage( this->m_FixedImage );
@@ -280,6 +289,141 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
     /* Clear derivative final result. */
     this->m_DerivativeResult->Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
     }
+
+  /* The weights of the points only depend on the fixed parameters of the
+   * transform, which usually do not change between iterations. The weights
+   * are computed by the threads when the points are first transformed. */
+  this->m_MovingBSplineTransform = ITK_NULLPTR;
+  this->m_MovingBSplineCompositeTransform = ITK_NULLPTR;
+  if( this->m_UseCachingOfBSplineWeights )
+    {
+    const MovingBSplineTransformType * transform = this->GetOptimizedMovingBSplineTransform();
+    if( transform )
+      {
+      const SizeValueType numberOfPoints = this->GetNumberOfDomainPoints();
+      if( transform != this->m_BSplineWeightsCacheTransform
+          || this->m_BSplineWeightsCache.size() != numberOfPoints
+          || this->m_BSplineWeightsCacheFixedParameters != transform->GetFixedParameters() )
+        {
+        CachedBSplineWeightsType notComputed;
+        notComputed.SupportOffset = 0;
+        notComputed.Inside = false;
+        notComputed.IsComputed = false;
+        this->m_BSplineWeightsCache.assign( numberOfPoints, notComputed );
+        this->m_BSplineWeightsCacheTransform = transform;
+        this->m_BSplineWeightsCacheFixedParameters = transform->GetFixedParameters();
+        }
+      this->m_MovingBSplineTransform = transform;
+      this->m_MovingBSplineCompositeTransform =
+        dynamic_cast< const MovingCompositeTransformType * >( this->m_MovingTransform.GetPointer() );
+      }
+    }
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+const typename ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>::MovingBSplineTransformType *
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::GetOptimizedMovingBSplineTransform() const
+{
+  const MovingCompositeTransformType * composite =
+    dynamic_cast< const MovingCompositeTransformType * >( this->m_MovingTransform.GetPointer() );
+  if( composite == ITK_NULLPTR )
+    {
+    return dynamic_cast< const MovingBSplineTransformType * >( this->m_MovingTransform.GetPointer() );
+    }
+
+  // The last transform of the queue is the one applied first
+  const SizeValueType numberOfTransforms = composite->GetNumberOfTransforms();
+  if( numberOfTransforms == 0 || !composite->GetNthTransformToOptimize( numberOfTransforms - 1 ) )
+    {
+    return ITK_NULLPTR;
+    }
+  for( SizeValueType n = 0; n + 1 < numberOfTransforms; ++n )
+    {
+    if( composite->GetNthTransformToOptimize( n ) )
+      {
+      return ITK_NULLPTR;
+      }
+    }
+  return dynamic_cast< const MovingBSplineTransformType * >( composite->GetNthTransformConstPointer( numberOfTransforms - 1 ) );
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+void
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::TransformByOuterMovingTransforms( const MovingCompositeTransformType * composite,
+                                    typename MovingTransformType::OutputPointType & point,
+                                    JacobianType * outerJacobian, JacobianType & jacobianPositional ) const
+{
+  if( composite == ITK_NULLPTR )
+    {
+    return;
+    }
+  // The transforms before the B-spline transform in the queue are applied
+  // after it, from the back of the queue to its front
+  for( SizeValueType n = composite->GetNumberOfTransforms() - 1; n-- > 0; )
+    {
+    const typename MovingCompositeTransformType::TransformType * transform =
+      composite->GetNthTransformConstPointer( n );
+    if( outerJacobian )
+      {
+      transform->ComputeJacobianWithRespectToPosition( point, jacobianPositional );
+      *outerJacobian = jacobianPositional * ( *outerJacobian );
+      }
+    point = transform->TransformPoint( point );
+    }
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+typename ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>::CachedBSplineWeightsType &
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::GetCachedBSplineWeights( const typename MovingTransformType::OutputPointType & point, SizeValueType virtualSample ) const
+{
+  // Each point is processed by a single thread
+  CachedBSplineWeightsType & cached = this->m_BSplineWeightsCache[virtualSample];
+  if( !cached.IsComputed )
+    {
+    cached.Inside = this->m_MovingBSplineTransform->ComputeSeparableWeights( point, cached.Weights,
+                                                                            cached.SupportOffset );
+    cached.IsComputed = true;
+    }
+  return cached;
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+void
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::ComputeMovingTransformJacobian( const VirtualPointType & virtualPoint, SizeValueType virtualSample,
+                                  JacobianType & jacobian, JacobianType & jacobianPositional ) const
+{
+  if( this->m_MovingBSplineTransform == ITK_NULLPTR || virtualSample >= this->m_BSplineWeightsCache.size() )
+    {
+    this->m_MovingTransform->ComputeJacobianWithRespectToParametersCachedTemporaries( virtualPoint, jacobian,
+                                                                                      jacobianPositional );
+    return;
+    }
+
+  typename MovingTransformType::OutputPointType localVirtualPoint;
+  localVirtualPoint.CastFrom( virtualPoint );
+  const CachedBSplineWeightsType & cached = this->GetCachedBSplineWeights( localVirtualPoint, virtualSample );
+  this->m_MovingBSplineTransform->ComputeJacobianWithRespectToParametersWithSeparableWeights( cached.Weights,
+    cached.SupportOffset, cached.Inside, jacobian );
+
+  // The transforms applied after the B-spline transform map the Jacobian
+  // by their own Jacobian with respect to the position, as in
+  // CompositeTransform
+  if( cached.Inside && this->m_MovingBSplineCompositeTransform
+      && this->m_MovingBSplineCompositeTransform->GetNumberOfTransforms() > 1 )
+    {
+    typename MovingTransformType::OutputPointType point =
+      this->m_MovingBSplineTransform->TransformPointWithSeparableWeights( localVirtualPoint, cached.Weights,
+                                                                         cached.SupportOffset, cached.Inside );
+    JacobianType outerJacobian( MovingImageDimension, MovingImageDimension );
+    outerJacobian.set_identity();
+    this->TransformByOuterMovingTransforms( this->m_MovingBSplineCompositeTransform, point, &outerJacobian,
+                                            jacobianPositional );
+    jacobian = outerJacobian * jacobian;
+    }
 }
 
 template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
@@ -327,6 +471,19 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
                          const VirtualPointType & virtualPoint,
                          MovingImagePointType & mappedMovingPoint,
                          MovingImagePixelType & mappedMovingPixelValue ) const
+{
+  return this->TransformAndEvaluateMovingPoint( virtualPoint, NumericTraits< SizeValueType >::max(),
+                                                mappedMovingPoint, mappedMovingPixelValue );
+}
+
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+bool
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::TransformAndEvaluateMovingPoint(
+                         const VirtualPointType & virtualPoint,
+                         SizeValueType virtualSample,
+                         MovingImagePointType & mappedMovingPoint,
+                         MovingImagePixelType & mappedMovingPixelValue ) const
 {
   bool pointIsValid = true;
   mappedMovingPixelValue = NumericTraits<MovingImagePixelType>::ZeroValue();
@@ -341,7 +498,22 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   localVirtualPoint.CastFrom(virtualPoint);
   localMappedMovingPoint.CastFrom(mappedMovingPoint);
 
-  localMappedMovingPoint = this->m_MovingTransform->TransformPoint( localVirtualPoint );
+  if( this->m_MovingBSplineTransform && virtualSample < this->m_BSplineWeightsCache.size() )
+    {
+    const CachedBSplineWeightsType & cached = this->GetCachedBSplineWeights( localVirtualPoint, virtualSample );
+    localMappedMovingPoint = this->m_MovingBSplineTransform->TransformPointWithSeparableWeights( localVirtualPoint,
+      cached.Weights, cached.SupportOffset, cached.Inside );
+    if( this->m_MovingBSplineCompositeTransform )
+      {
+      JacobianType jacobianPositional;
+      this->TransformByOuterMovingTransforms( this->m_MovingBSplineCompositeTransform, localMappedMovingPoint,
+                                              ITK_NULLPTR, jacobianPositional );
+      }
+    }
+  else
+    {
+    localMappedMovingPoint = this->m_MovingTransform->TransformPoint( localVirtualPoint );
+    }
   mappedMovingPoint.CastFrom(localMappedMovingPoint);
 
   // check against the mask if one is assigned
@@ -516,6 +688,22 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
     }
 }
 
+template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+void
+ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::UpdateVirtualSampledPointSet()
+{
+  if( ! this->m_UseFixedSampledPointSet )
+    {
+    itkExceptionMacro("UseFixedSampledPointSet must be on to update the virtual sampled point set.");
+    }
+  this->MapFixedSampledPointSetToVirtual();
+
+  /* The weights of the previous points are not valid anymore. */
+  this->m_BSplineWeightsCache.clear();
+  this->m_BSplineWeightsCacheTransform = ITK_NULLPTR;
+}
+
 template<typename TFixedImage,typename TMovingImage,typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
 void
 ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
@@ -597,7 +785,8 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
      << indent << "GetUseFixedImageGradientFilter: " << this->GetUseFixedImageGradientFilter() << std::endl
      << indent << "GetUseMovingImageGradientFilter: " << this->GetUseMovingImageGradientFilter() << std::endl
      << indent << "UseFloatingPointCorrection: " << this->GetUseFloatingPointCorrection() << std::endl
-     << indent << "FloatingPointCorrectionResolution: " << this->GetFloatingPointCorrectionResolution() << std::endl;
+     << indent << "FloatingPointCorrectionResolution: " << this->GetFloatingPointCorrectionResolution() << std::endl
+     << indent << "UseCachingOfBSplineWeights: " << this->GetUseCachingOfBSplineWeights() << std::endl;
 
   itkPrintSelfObjectMacro( FixedImage );
   itkPrintSelfObjectMacro( MovingImage );
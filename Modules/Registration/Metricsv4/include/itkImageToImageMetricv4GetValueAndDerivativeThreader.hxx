@@ -36,12 +36,30 @@ ImageToImageMetricv4GetValueAndDerivativeThreader< ThreadedImageRegionPartitione
   typename VirtualImageType::ConstPointer virtualImage = this->m_Associate->GetVirtualImage();
   typedef ImageRegionConstIteratorWithIndex< VirtualImageType > IteratorType;
   VirtualPointType virtualPoint;
+
+  /* The points are identified by their offset in the virtual region. */
+  const unsigned int VirtualDimension = VirtualImageType::ImageDimension;
+  const typename VirtualImageType::RegionType virtualRegion = this->m_Associate->GetVirtualRegion();
+  SizeValueType strides[VirtualDimension];
+  strides[0] = 1;
+  for( unsigned int d = 1; d < VirtualDimension; ++d )
+    {
+    strides[d] = strides[d - 1] * virtualRegion.GetSize( d - 1 );
+    }
+  SizeValueType & virtualSample = this->m_GetValueAndDerivativePerThreadVariables[threadId].VirtualSample;
+
   for( IteratorType it( virtualImage, imageSubRegion ); !it.IsAtEnd(); ++it )
     {
     const VirtualIndexType & virtualIndex = it.GetIndex();
     virtualImage->TransformIndexToPhysicalPoint( virtualIndex, virtualPoint );
+    virtualSample = 0;
+    for( unsigned int d = 0; d < VirtualDimension; ++d )
+      {
+      virtualSample += static_cast< SizeValueType >( virtualIndex[d] - virtualRegion.GetIndex( d ) ) * strides[d];
+      }
     this->ProcessVirtualPoint( virtualIndex, virtualPoint, threadId );
     }
+  virtualSample = NumericTraits< SizeValueType >::max();
   //Finalize per thread actions
   this->m_Associate->FinalizeThread( threadId );
 }
@@ -61,12 +79,15 @@ ImageToImageMetricv4GetValueAndDerivativeThreader< ThreadedIndexedContainerParti
   const ElementIdentifierType end   = indexSubRange[1];
   VirtualIndexType virtualIndex;
   typename VirtualImageType::ConstPointer virtualImage = this->m_Associate->GetVirtualImage();
+  SizeValueType & virtualSample = this->m_GetValueAndDerivativePerThreadVariables[threadId].VirtualSample;
   for( ElementIdentifierType i = begin; i <= end; ++i )
     {
     const VirtualPointType & virtualPoint = virtualSampledPointSet->GetPoint( i );
     virtualImage->TransformPhysicalPointToIndex( virtualPoint, virtualIndex );
+    virtualSample = static_cast< SizeValueType >( i );
     this->ProcessVirtualPoint( virtualIndex, virtualPoint, threadId );
     }
+  virtualSample = NumericTraits< SizeValueType >::max();
   //Finalize per thread actions
   this->m_Associate->FinalizeThread( threadId );
 }
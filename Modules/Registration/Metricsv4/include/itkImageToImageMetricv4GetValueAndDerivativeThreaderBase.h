@@ -178,6 +178,10 @@ protected:
      * classes for efficiency. */
     JacobianType                 MovingTransformJacobian;
     JacobianType                 MovingTransformJacobianPositional;
+    /** The id of the point being processed among the points of the
+     * virtual domain, by which the metric caches values of the point,
+     * or NumericTraits< SizeValueType >::max() when unknown. */
+    SizeValueType                VirtualSample;
     };
   itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, GetValueAndDerivativePerThreadStruct,
                                             PaddedGetValueAndDerivativePerThreadStruct);
@@ -98,6 +98,7 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
   for (ThreadIdType thread = 0; thread < numThreadsUsed; ++thread)
     {
     this->m_GetValueAndDerivativePerThreadVariables[thread].NumberOfValidPoints = NumericTraits< SizeValueType >::ZeroValue();
+    this->m_GetValueAndDerivativePerThreadVariables[thread].VirtualSample = NumericTraits< SizeValueType >::max();
     this->m_GetValueAndDerivativePerThreadVariables[thread].Measure = NumericTraits< InternalComputationValueType >::ZeroValue();
     if( this->m_Associate->GetComputeDerivative() )
       {
@@ -217,7 +218,8 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
 
   try
     {
-    pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
+    pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].VirtualSample, mappedMovingPoint, mappedMovingPixelValue );
     if( pointIsValid &&
         this->m_Associate->GetComputeDerivative() &&
         this->m_Associate->GetGradientSourceIncludesMoving() )
@@ -158,10 +158,8 @@ JointHistogramMutualInformationGetValueAndDerivativeThreader< TDomainPartitioner
   JacobianReferenceType jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
 
   /** For dense transforms, this returns identity */
-  this->m_JointAssociate->GetMovingTransform()->
-    ComputeJacobianWithRespectToParametersCachedTemporaries(virtualPoint,
-                                                            jacobian,
-                                                            jacobianPositional);
+  this->m_JointAssociate->ComputeMovingTransformJacobian( virtualPoint,
+    this->m_GetValueAndDerivativePerThreadVariables[threadId].VirtualSample, jacobian, jacobianPositional );
 
   for ( NumberOfParametersType par = 0; par < this->GetCachedNumberOfLocalParameters(); par++ )
     {
@@ -154,6 +154,33 @@ public:
 
   virtual void Initialize(void) throw ( itk::ExceptionObject ) ITK_OVERRIDE;
 
+  /**
+   * Set/Get the way the derivative is computed with a transform that does
+   * not have local support. As with MattesMutualInformationImageToImageMetric,
+   * this is a trade-off between computation speed and memory:
+   *
+   * UseExplicitPDFDerivatives = True
+   * computes the derivatives of each bin of the joint PDF with respect to
+   * each parameter while sampling the joint PDF, and accumulates them in the
+   * derivative with a bin-specific weight once the joint PDF is known. Each
+   * thread stores (number of histogram bins)^2 times the number of
+   * parameters values, which is well suited for transforms with a small
+   * number of parameters.
+   *
+   * UseExplicitPDFDerivatives = False
+   * samples the joint PDF first, computes the weights of its bins, then
+   * samples the points a second time, each point adding its weighted
+   * contribution to a derivative per thread. The per-thread derivatives are
+   * summed by the threads in parallel, each section of the derivative being
+   * summed by one thread at a time. With a BSplineBaseTransform of order 3,
+   * a point only updates the parameters of the coefficients of its support
+   * region, so that the cost of a point does not depend on the number of
+   * parameters. This is well suited for transforms with a large number of
+   * parameters, such as BSplineTransforms. */
+  itkSetMacro(UseExplicitPDFDerivatives, bool);
+  itkGetConstReferenceMacro(UseExplicitPDFDerivatives, bool);
+  itkBooleanMacro(UseExplicitPDFDerivatives);
+
   /** The marginal PDFs are stored as std::vector. */
   //NOTE:  floating point precision is not as stable.
   // Double precision proves faster and more robust in real-world testing.
@@ -179,8 +206,8 @@ public:
   /**
    * Get the internal JointPDFDeriviative image that was used in
    * creating the metric derivative value.
-   * This is only created when a global support transform is used, and
-   * derivatives are requested.
+   * This is only created when a global support transform is used with
+   * UseExplicitPDFDerivatives ON, and derivatives are requested.
    */
   const typename JointPDFDerivativesType::Pointer GetJointPDFDerivatives () const
     {
@@ -228,6 +255,17 @@ protected:
    * and GetValueAndDerivative. */
   virtual void GetValueCommonAfterThreadedExecution();
 
+  /** Samples the points a second time to compute the derivative, when
+   * UseExplicitPDFDerivatives is OFF. */
+  virtual void GetValueAndDerivativeExecute() const ITK_OVERRIDE;
+
+  /** True if the derivatives of the joint PDF are not stored, i.e. with
+   * a transform without local support and UseExplicitPDFDerivatives OFF. */
+  bool UseImplicitPDFDerivatives() const
+    {
+    return ! this->m_UseExplicitPDFDerivatives && ! this->HasLocalSupport();
+    }
+
   OffsetValueType ComputeSingleFixedImageParzenWindowIndex( const FixedImagePixelType & value ) const;
 
   /** Variables to define the marginal and joint histograms. */
@@ -267,6 +305,16 @@ protected:
 
   PDFValueType m_JointPDFSum;
 
+  /** Flag to store the derivatives of the joint PDF. */
+  bool m_UseExplicitPDFDerivatives;
+
+  /** True while the points are sampled a second time to compute the
+   * derivative with the weights of the bins of the joint PDF. */
+  mutable bool m_ImplicitDerivativesSecondPass;
+
+  /** The derivative accumulated by each thread during the second pass. */
+  std::vector<DerivativeType> m_ThreaderDerivatives;
+
   /** Store the per-point local derivative result by parzen window bin.
    * For local-support transforms only. */
   mutable std::vector<DerivativeType>              m_LocalDerivativeByParzenBin;
@@ -281,6 +329,10 @@ private:
   std::vector< MutexLock::Pointer >  m_JointPDFSubsectionLocks;
   std::vector< MutexLock::Pointer >  m_JointPDFDerivativeSubsectionLocks;
 
+  /** Add the derivative of a thread to m_DerivativeResult, a section at a
+   * time, the other threads adding theirs to the other sections. */
+  void AccumulateThreaderDerivative( const ThreadIdType threadId );
+
   ThreadedIndexedContainerPartitioner::Pointer m_IndexedContainerPartitioner;
 };
 
@@ -53,7 +53,9 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
   m_ThreaderJointPDFDerivatives(0),
   m_AccumulatorJointPDF(ITK_NULLPTR),
   m_AccumulatorJointPDFDerivatives(ITK_NULLPTR),
-  m_JointPDFSum(0.0)
+  m_JointPDFSum(0.0),
+  m_UseExplicitPDFDerivatives(true),
+  m_ImplicitDerivativesSecondPass(false)
 {
   // We have our own GetValueAndDerivativeThreader's that we want
   // ImageToImageMetricv4 to use.
@@ -191,6 +193,12 @@ void
 MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
 ::InitializeThread( const ThreadIdType threadId )
 {
+  if( this->m_ImplicitDerivativesSecondPass )
+    {
+    this->m_ThreaderDerivatives[threadId].Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+    return;
+    }
+
   /* This block of code is from
      MattesMutualImageToImageMetric::GetValueAndDerivativeThreadPreProcess */
   std::fill(
@@ -243,7 +251,7 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
       }
     }
 
-  if( this->GetComputeDerivative()  &&  ! this->HasLocalSupport() )
+  if( this->GetComputeDerivative()  &&  ! this->HasLocalSupport()  &&  this->m_UseExplicitPDFDerivatives )
     {
     JointPDFDerivativesRegionType jointPDFDerivativesRegion;
       {
@@ -281,6 +289,12 @@ void
 MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
 ::FinalizeThread( const ThreadIdType threadId )
 {
+  if( this->m_ImplicitDerivativesSecondPass )
+    {
+    this->AccumulateThreaderDerivative( threadId );
+    return;
+    }
+
   const IndexValueType pdfNumberOfVoxels = this->m_NumberOfHistogramBins * this->m_NumberOfHistogramBins;
   const IndexValueType derivativeTotalElementSize = this->GetNumberOfLocalParameters() * pdfNumberOfVoxels;
 
@@ -303,7 +317,8 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
   const ThreadedIndexedContainerPartitioner::IndexRangeType completeDerivativeIndexRange = {
       {0, derivativeTotalElementSize - 1 } };
 
-  const bool needDerivativesComputation = ( this->GetComputeDerivative() && ( ! this->HasLocalSupport() ) );
+  const bool needDerivativesComputation = ( this->GetComputeDerivative() && ( ! this->HasLocalSupport() )
+                                            && this->m_UseExplicitPDFDerivatives );
   bool someWorkDelayed;
   do {
     someWorkDelayed = false; //This is set to true while some more work needs to be done
@@ -386,6 +401,79 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
   } while ( someWorkDelayed );
 }
 
+template <typename TFixedImage, typename TMovingImage, typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+void
+MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::AccumulateThreaderDerivative( const ThreadIdType threadId )
+{
+  const IndexValueType numberOfParameters = this->GetNumberOfParameters();
+  const ThreadedIndexedContainerPartitioner::IndexRangeType completeIndexRange = {
+      {0, numberOfParameters - 1 } };
+
+  // The partitioner may use fewer sections than requested, when they do not
+  // divide the parameters evenly.
+  const ThreadIdType requestedSubsections = static_cast< ThreadIdType >( std::min(
+    static_cast< IndexValueType >( m_JointPDFDerivativeSubsectionLocks.size() ), numberOfParameters ) );
+  ThreadedIndexedContainerPartitioner::IndexRangeType indexRange;
+  const IndexValueType numberOfSubsections = this->m_IndexedContainerPartitioner->PartitionDomain( 0,
+    requestedSubsections, completeIndexRange, indexRange );
+
+  std::vector<bool> isSectionDone(numberOfSubsections,false);
+
+  // Each thread starts with a different section, so that the threads which
+  // finish at the same time do not wait for each other.
+  DerivativeValueType * const derivativeStart = this->m_DerivativeResult->data_block();
+  DerivativeValueType const * const threadDerivativeStart = this->m_ThreaderDerivatives[threadId].data_block();
+  bool someWorkDelayed;
+  do {
+    someWorkDelayed = false;
+    for( IndexValueType s = 0; s < numberOfSubsections; ++s )
+      {
+      const IndexValueType subsection = ( s + threadId ) % numberOfSubsections;
+      if( ! isSectionDone[subsection] )
+        {
+        MutexLockHolder< MutexLock > lockHolder(*(m_JointPDFDerivativeSubsectionLocks[subsection]), true);
+        if(lockHolder.GetLockCaptured())
+          {
+          this->m_IndexedContainerPartitioner->PartitionDomain( static_cast< ThreadIdType >( subsection ),
+                                                                requestedSubsections, completeIndexRange, indexRange );
+          DerivativeValueType * derivative = derivativeStart + indexRange[0];
+          DerivativeValueType const * threadDerivative = threadDerivativeStart + indexRange[0];
+          DerivativeValueType const * const derivativeEnd = derivativeStart + indexRange[1];
+          while( derivative <= derivativeEnd )
+            {
+            *( derivative++ ) += *( threadDerivative++ );
+            }
+          isSectionDone[subsection] = true;
+          }
+        else
+          {
+          someWorkDelayed = true;
+          }
+        }
+      }
+  } while ( someWorkDelayed );
+}
+
+template <typename TFixedImage, typename TMovingImage, typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
+void
+MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputationValueType, TMetricTraits>
+::GetValueAndDerivativeExecute() const
+{
+  // The first pass samples the joint PDF and computes the value, and the
+  // derivative unless UseExplicitPDFDerivatives is OFF, in which case it
+  // computes the weights of the bins used by the second pass.
+  this->m_ImplicitDerivativesSecondPass = false;
+  this->Superclass::GetValueAndDerivativeExecute();
+
+  if( this->GetComputeDerivative() && this->UseImplicitPDFDerivatives() )
+    {
+    this->m_ImplicitDerivativesSecondPass = true;
+    this->Superclass::GetValueAndDerivativeExecute();
+    this->m_ImplicitDerivativesSecondPass = false;
+    }
+}
+
 
 template <typename TFixedImage, typename TMovingImage, typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
 void
@@ -475,7 +563,7 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
 
       if( this->GetComputeDerivative() )
         {
-        if( ! this->HasLocalSupport() )
+        if( ! this->HasLocalSupport() && this->m_UseExplicitPDFDerivatives )
           {
           // Collect global derivative contributions
 
@@ -494,7 +582,8 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
         else
           {
           // Collect the pRatio per pdf indecies.
-          // Will be applied subsequently to local-support derivative
+          // Will be applied subsequently to local-support derivative,
+          // or during the second pass of implicit derivatives
           const OffsetValueType index = movingIndex + (fixedIndex * this->m_NumberOfHistogramBins);
           this->m_PRatioArray[index] = pRatio * nFactor;
           }
@@ -534,7 +623,7 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
 ::GetValueCommonAfterThreadedExecution()
 {
   const ThreadIdType localNumberOfThreadsUsed = this->GetNumberOfThreadsUsed();
-  if( this->GetComputeDerivative() && ( ! this->HasLocalSupport() ) )
+  if( this->GetComputeDerivative() && ( ! this->HasLocalSupport() ) && this->m_UseExplicitPDFDerivatives )
     {
     // This entire block of code is used to accumulate the per-thread buffers into 1 thread.
     // For this thread, how many histogram elements are there?
@@ -578,6 +667,8 @@ MattesMutualInformationImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualI
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfHistogramBins: " << this->m_NumberOfHistogramBins << std::endl;
+  os << indent << "UseExplicitPDFDerivatives: " << this->m_UseExplicitPDFDerivatives << std::endl;
 }
 
 template <typename TFixedImage, typename TMovingImage, typename TVirtualImage, typename TInternalComputationValueType, typename TMetricTraits>
@@ -83,9 +83,15 @@ public:
 
   typedef typename TMattesMutualInformationMetric::JacobianType             JacobianType;
 
+  typedef typename TMattesMutualInformationMetric::MovingBSplineTransformType   MovingBSplineTransformType;
+  typedef typename TMattesMutualInformationMetric::MovingCompositeTransformType MovingCompositeTransformType;
+
 protected:
   MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader() :
-    m_MattesAssociate(ITK_NULLPTR)
+    m_MattesAssociate(ITK_NULLPTR),
+    m_MovingBSplineTransform(ITK_NULLPTR),
+    m_MovingBSplineCompositeTransform(ITK_NULLPTR),
+    m_NumberOfParametersPerDimension(0)
   {}
 
   virtual void BeforeThreadedExecution() ITK_OVERRIDE;
@@ -123,6 +129,15 @@ protected:
                              const PDFValueType &            cubicBSplineDerivativeValue,
                              DerivativeValueType *           localSupportDerivativeResultPtr) const;
 
+  /** Add the contribution of a point to the derivative of a thread, during
+   * the second pass of implicit derivatives. \c weight is the sum of the
+   * weights of the bins of the point by the derivatives of their Parzen
+   * window. */
+  virtual void ComputeImplicitDerivatives(const ThreadIdType &            threadId,
+                             const VirtualPointType &        virtualPoint,
+                             const MovingImageGradientType & movingGradient,
+                             const PDFValueType &            weight) const;
+
 private:
   MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader( const Self & ); // purposely not implemented
   void operator=( const Self & ); // purposely not implemented
@@ -130,6 +145,16 @@ private:
   /** Internal pointer to the Mattes metric object in use by this threader.
    *  This will avoid costly dynamic casting in tight loops. */
   TMattesMutualInformationMetric * m_MattesAssociate;
+
+  /** The optimized moving transform during the second pass of implicit
+   * derivatives, if it is a BSplineBaseTransform of order 3, whose
+   * Jacobian is sparse, alone or applied first by a composite moving
+   * transform, as in ImageRegistrationMethodv4, and the offset table of
+   * its coefficient images. */
+  const MovingBSplineTransformType *   m_MovingBSplineTransform;
+  const MovingCompositeTransformType * m_MovingBSplineCompositeTransform;
+  OffsetValueType                      m_CoefficientsOffsetTable[TMattesMutualInformationMetric::MovingImageDimension + 1];
+  NumberOfParametersType               m_NumberOfParametersPerDimension;
 };
 
 } // end namespace itk
@@ -44,6 +44,39 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
     itkExceptionMacro("Dynamic casting of associate pointer failed.");
     }
 
+  if( this->m_MattesAssociate->m_ImplicitDerivativesSecondPass )
+    {
+    /* The joint PDF and the weights of its bins are the ones of the first
+     * pass. Each thread only needs a derivative to accumulate in. */
+    const ThreadIdType numThreadsUsed = this->m_MattesAssociate->GetNumberOfThreadsUsed();
+    const NumberOfParametersType numberOfParameters = this->m_MattesAssociate->GetNumberOfParameters();
+    this->m_MattesAssociate->m_ThreaderDerivatives.resize( numThreadsUsed );
+    for( ThreadIdType threadId = 0; threadId < numThreadsUsed; ++threadId )
+      {
+      if( this->m_MattesAssociate->m_ThreaderDerivatives[threadId].Size() != numberOfParameters )
+        {
+        this->m_MattesAssociate->m_ThreaderDerivatives[threadId].SetSize( numberOfParameters );
+        }
+      }
+
+    this->m_MovingBSplineTransform = this->m_MattesAssociate->GetOptimizedMovingBSplineTransform();
+    this->m_MovingBSplineCompositeTransform = ITK_NULLPTR;
+    if( this->m_MovingBSplineTransform )
+      {
+      const MovingCompositeTransformType * composite =
+        dynamic_cast< const MovingCompositeTransformType * >( this->m_MattesAssociate->m_MovingTransform.GetPointer() );
+      if( composite && composite->GetNumberOfTransforms() > 1 )
+        {
+        this->m_MovingBSplineCompositeTransform = composite;
+        }
+      const OffsetValueType * offsetTable = this->m_MovingBSplineTransform->GetCoefficientImages()[0]->GetOffsetTable();
+      std::copy( offsetTable, offsetTable + TMattesMutualInformationMetric::MovingImageDimension + 1,
+                 this->m_CoefficientsOffsetTable );
+      this->m_NumberOfParametersPerDimension = this->m_MovingBSplineTransform->GetNumberOfParametersPerDimension();
+      }
+    return;
+    }
+
   /* Porting: these next blocks of code are from MattesMutualImageToImageMetric::Initialize */
 
   /*
@@ -169,6 +202,12 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
   //
   // Now allocate memory according to transform type
   //
+  if( this->m_MattesAssociate->UseImplicitPDFDerivatives() )
+    {
+    // The derivative is computed with the weights of the bins.
+    this->m_MattesAssociate->m_AccumulatorJointPDFDerivatives = ITK_NULLPTR;
+    }
+
   if( ! this->m_MattesAssociate->GetComputeDerivative() )
     {
     // We only need these if we're computing derivatives.
@@ -201,14 +240,19 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
   if(  this->m_MattesAssociate->GetComputeDerivative() && ! this->m_MattesAssociate->HasLocalSupport() )
     {
     // Don't need this with global transforms
-    this->m_MattesAssociate->m_PRatioArray.resize(0);
     this->m_MattesAssociate->m_JointPdfIndex1DArray.resize(0);
     this->m_MattesAssociate->m_LocalDerivativeByParzenBin.resize(0);
-    }
-
-  if( this->m_MattesAssociate->GetComputeDerivative()  &&  ! this->m_MattesAssociate->HasLocalSupport() )
-    {
-    this->m_MattesAssociate->m_ThreaderJointPDFDerivatives.resize(mattesAssociateNumThreadsUsed);
+    if( this->m_MattesAssociate->m_UseExplicitPDFDerivatives )
+      {
+      this->m_MattesAssociate->m_PRatioArray.resize(0);
+      this->m_MattesAssociate->m_ThreaderJointPDFDerivatives.resize(mattesAssociateNumThreadsUsed);
+      }
+    else
+      {
+      // The weights of the bins are used by the second pass
+      this->m_MattesAssociate->m_PRatioArray.assign( this->m_MattesAssociate->m_NumberOfHistogramBins * this->m_MattesAssociate->m_NumberOfHistogramBins, 0.0);
+      this->m_MattesAssociate->m_ThreaderJointPDFDerivatives.resize(0);
+      }
     }
 }
 
@@ -227,7 +271,9 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
                 DerivativeType &,
                 const ThreadIdType                 threadId) const
 {
-  const bool doComputeDerivative = this->m_MattesAssociate->GetComputeDerivative();
+  // With implicit derivatives, the first pass only samples the joint PDF
+  const bool doComputeDerivative = this->m_MattesAssociate->GetComputeDerivative()
+                                   && ! this->m_MattesAssociate->UseImplicitPDFDerivatives();
   /**
    * Compute this sample's contribution to the marginal
    *   and joint distributions.
@@ -265,6 +311,27 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
 
   const OffsetValueType fixedImageParzenWindowIndex = this->m_MattesAssociate->ComputeSingleFixedImageParzenWindowIndex( fixedImageValue );
 
+  if( this->m_MattesAssociate->m_ImplicitDerivativesSecondPass )
+    {
+    // The derivative of the metric with respect to the moving value of the
+    // point is the sum of the weights of its four bins by the derivatives of
+    // their Parzen window.
+    PDFValueType movingImageParzenWindowArg = static_cast<PDFValueType>( pdfMovingIndex ) - static_cast<PDFValueType>( movingImageParzenWindowTerm );
+    const PDFValueType *pRatio = &( this->m_MattesAssociate->m_PRatioArray[pdfMovingIndex
+      + ( fixedImageParzenWindowIndex * this->m_MattesAssociate->m_NumberOfHistogramBins )] );
+    PDFValueType weight = 0.0;
+    for( ; pdfMovingIndex <= pdfMovingIndexMax; ++pdfMovingIndex, ++pRatio, movingImageParzenWindowArg += 1.0 )
+      {
+      weight += *pRatio * this->m_MattesAssociate->m_CubicBSplineDerivativeKernel->Evaluate( movingImageParzenWindowArg );
+      }
+    if( weight != 0.0 )
+      {
+      this->ComputeImplicitDerivatives( threadId, virtualPoint, movingImageGradient, weight );
+      }
+    this->m_GetValueAndDerivativePerThreadVariables[threadId].NumberOfValidPoints++;
+    return false;
+    }
+
   // Since a zero-order BSpline (box car) kernel is used for
   // the fixed image marginal pdf, we need only increment the
   // fixedImageParzenWindowIndex by value of 1.0.
@@ -308,10 +375,8 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
   if( doComputeDerivative )
     {
     JacobianReferenceType jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
-    this->m_MattesAssociate->GetMovingTransform()->
-      ComputeJacobianWithRespectToParametersCachedTemporaries(virtualPoint,
-                                                              jacobian,
-                                                              jacobianPositional);
+    this->m_MattesAssociate->ComputeMovingTransformJacobian( virtualPoint,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].VirtualSample, jacobian, jacobianPositional );
     }
 
   SizeValueType movingParzenBin = 0;
@@ -421,6 +486,144 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
     }
 }
 
+template< typename TDomainPartitioner, typename TImageToImageMetric, typename TMattesMutualInformationMetric >
+void
+MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomainPartitioner, TImageToImageMetric, TMattesMutualInformationMetric >
+::ComputeImplicitDerivatives(const ThreadIdType &            threadId,
+                             const VirtualPointType &        virtualPoint,
+                             const MovingImageGradientType & movingImageGradient,
+                             const PDFValueType &            weight) const
+{
+  DerivativeValueType *derivative = this->m_MattesAssociate->m_ThreaderDerivatives[threadId].data_block();
+
+  if( this->m_MovingBSplineTransform == ITK_NULLPTR )
+    {
+    JacobianType & jacobian = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobian;
+    JacobianType & jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
+    this->m_MattesAssociate->GetMovingTransform()->
+      ComputeJacobianWithRespectToParametersCachedTemporaries(virtualPoint,
+                                                              jacobian,
+                                                              jacobianPositional);
+    for( NumberOfParametersType mu = 0, maxElement=this->GetCachedNumberOfLocalParameters(); mu < maxElement; ++mu )
+      {
+      PDFValueType innerProduct = 0.0;
+      for( SizeValueType dim = 0, lastDim = this->m_MattesAssociate->MovingImageDimension; dim < lastDim; ++dim )
+        {
+        innerProduct += jacobian[dim][mu] * movingImageGradient[dim];
+        }
+      derivative[mu] -= weight * innerProduct;
+      }
+    return;
+    }
+
+  // The Jacobian of the BSpline transform is zero, except for the
+  // coefficients of the support region of the point, where the derivative
+  // of each component of the point with respect to the coefficients of this
+  // component is their interpolation weight. The weights are the ones
+  // cached when the point was transformed, if any.
+  const unsigned int Dimension = TMattesMutualInformationMetric::MovingImageDimension;
+  const unsigned int supportLength = MovingBSplineTransformType::SplineOrder + 1;
+  typename MovingBSplineTransformType::SeparableWeightsType weights;
+  OffsetValueType supportOffset;
+  bool inside;
+  const SizeValueType virtualSample = this->m_GetValueAndDerivativePerThreadVariables[threadId].VirtualSample;
+  if( this->m_MattesAssociate->m_MovingBSplineTransform
+      && virtualSample < this->m_MattesAssociate->m_BSplineWeightsCache.size()
+      && this->m_MattesAssociate->m_BSplineWeightsCache[virtualSample].IsComputed )
+    {
+    const typename TMattesMutualInformationMetric::CachedBSplineWeightsType & cached =
+      this->m_MattesAssociate->m_BSplineWeightsCache[virtualSample];
+    weights = cached.Weights;
+    supportOffset = cached.SupportOffset;
+    inside = cached.Inside;
+    }
+  else
+    {
+    typename MovingBSplineTransformType::InputPointType point;
+    point.CastFrom( virtualPoint );
+    inside = this->m_MovingBSplineTransform->ComputeSeparableWeights( point, weights, supportOffset );
+    }
+  if( !inside )
+    {
+    return;
+    }
+
+  // The transforms applied after the B-spline transform by a composite
+  // moving transform map the gradient by the transpose of their Jacobian
+  // with respect to the position
+  PDFValueType movingGradient[Dimension];
+  for( unsigned int j = 0; j < Dimension; ++j )
+    {
+    movingGradient[j] = movingImageGradient[j];
+    }
+  if( this->m_MovingBSplineCompositeTransform )
+    {
+    typename MovingBSplineTransformType::InputPointType point;
+    point.CastFrom( virtualPoint );
+    point = this->m_MovingBSplineTransform->TransformPointWithSeparableWeights( point, weights, supportOffset, inside );
+    JacobianType & outerJacobian = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobian;
+    JacobianType & jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
+    outerJacobian.SetSize( Dimension, Dimension );
+    outerJacobian.set_identity();
+    this->m_MattesAssociate->TransformByOuterMovingTransforms( this->m_MovingBSplineCompositeTransform, point,
+                                                               &outerJacobian, jacobianPositional );
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      movingGradient[j] = 0.0;
+      for( unsigned int dim = 0; dim < Dimension; ++dim )
+        {
+        movingGradient[j] += outerJacobian[dim][j] * movingImageGradient[dim];
+        }
+      }
+    }
+
+  DerivativeValueType *coefficients[Dimension];
+  PDFValueType         gradient[Dimension];
+  unsigned int         position[Dimension];
+  for( unsigned int j = 0; j < Dimension; ++j )
+    {
+    coefficients[j] = derivative + j * this->m_NumberOfParametersPerDimension + supportOffset;
+    gradient[j] = weight * movingGradient[j];
+    position[j] = 0;
+    }
+
+  // Walk the lines of the support region along the first dimension
+  OffsetValueType lineOffset = 0;
+  for(;; )
+    {
+    PDFValueType lineWeight = 1.0;
+    for( unsigned int d = 1; d < Dimension; ++d )
+      {
+      lineWeight *= weights[d][position[d]];
+      }
+    for( unsigned int j = 0; j < Dimension; ++j )
+      {
+      DerivativeValueType *line = coefficients[j] + lineOffset;
+      const PDFValueType   lineGradient = lineWeight * gradient[j];
+      for( unsigned int k = 0; k < supportLength; ++k )
+        {
+        line[k] -= lineGradient * weights[0][k];
+        }
+      }
+
+    unsigned int d = 1;
+    for( ; d < Dimension; ++d )
+      {
+      lineOffset += this->m_CoefficientsOffsetTable[d];
+      if( ++position[d] < supportLength )
+        {
+        break;
+        }
+      position[d] = 0;
+      lineOffset -= supportLength * this->m_CoefficientsOffsetTable[d];
+      }
+    if( d == Dimension )
+      {
+      break;
+      }
+    }
+}
+
 template< typename TDomainPartitioner, typename TImageToImageMetric, typename TMattesMutualInformationMetric >
 void
 MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomainPartitioner, TImageToImageMetric, TMattesMutualInformationMetric >
@@ -436,6 +639,12 @@ MattesMutualInformationImageToImageMetricv4GetValueAndDerivativeThreader< TDomai
     this->m_MattesAssociate->m_NumberOfValidPoints += this->m_GetValueAndDerivativePerThreadVariables[threadId].NumberOfValidPoints;
     }
 
+  // The threads have added their derivatives in FinalizeThread().
+  if( this->m_MattesAssociate->m_ImplicitDerivativesSecondPass )
+    {
+    return;
+    }
+
   /* Porting: This code is from
    * MattesMutualInformationImageToImageMetric::GetValueAndDerivativeThreadPostProcess */
   /* Post-processing that is common the GetValue and GetValueAndDerivative */
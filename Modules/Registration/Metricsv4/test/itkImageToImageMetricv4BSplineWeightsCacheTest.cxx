@@ -0,0 +1,320 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkMattesMutualInformationImageToImageMetricv4.h"
+#include "itkBSplineTransform.h"
+#include "itkBSplineDeformableTransform.h"
+#include "itkAffineTransform.h"
+#include "itkCompositeTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <cmath>
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef itk::Image< double, Dimension >              ImageType;
+typedef itk::BSplineTransform< double, Dimension, 3 > BSplineTransformType;
+typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+ImageType::Pointer CreateImage( double phase )
+{
+  ImageType::SizeType size;
+  size.Fill( 32 );
+  ImageType::SpacingType spacing;
+  spacing.Fill( 1.25 );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double value = 100.0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      value += 30.0 * std::sin( 0.2 * it.GetIndex()[d] + phase * ( d + 1 ) );
+      }
+    it.Set( value );
+    }
+  return image;
+}
+
+void RandomizeParameters( BSplineTransformType *transform, GeneratorType *generator, double amplitude )
+{
+  BSplineTransformType::ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int p = 0; p < parameters.Size(); ++p )
+    {
+    parameters[p] = generator->GetUniformVariate( -amplitude, amplitude );
+    }
+  transform->SetParametersByValue( parameters );
+}
+
+bool IsClose( double a, double b, double tolerance )
+{
+  return std::abs( a - b ) <= tolerance * std::max( 1.0, std::max( std::abs( a ), std::abs( b ) ) );
+}
+
+/** Compares the points transformed with the separable weights with the
+ * points transformed by TransformPoint(), and the Jacobians computed from
+ * the weights with ComputeJacobianWithRespectToParameters(), inside and
+ * outside of the grid. */
+template< typename TTransform >
+bool CheckTransform( const char *name, const TTransform *transform, GeneratorType *generator )
+{
+  typename TTransform::SeparableWeightsType weights;
+  itk::OffsetValueType                      supportOffset;
+  unsigned int                              inside = 0;
+  for( unsigned int i = 0; i < 1000; ++i )
+    {
+    typename TTransform::InputPointType point;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      point[d] = generator->GetUniformVariate( -5.0, 55.0 );
+      }
+    const bool isInside = transform->ComputeSeparableWeights( point, weights, supportOffset );
+    inside += isInside;
+    const typename TTransform::OutputPointType expected = transform->TransformPoint( point );
+    const typename TTransform::OutputPointType cached =
+      transform->TransformPointWithSeparableWeights( point, weights, supportOffset, isInside );
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      if( !IsClose( cached[d], expected[d], 1.0e-12 ) )
+        {
+        std::cerr << name << ": " << point << " is transformed to " << cached
+                  << " with the separable weights instead of " << expected << std::endl;
+        return false;
+        }
+      }
+    typename TTransform::JacobianType expectedJacobian;
+    typename TTransform::JacobianType jacobian;
+    transform->ComputeJacobianWithRespectToParameters( point, expectedJacobian );
+    transform->ComputeJacobianWithRespectToParametersWithSeparableWeights( weights, supportOffset, isInside, jacobian );
+    if( jacobian.rows() != expectedJacobian.rows() || jacobian.cols() != expectedJacobian.cols()
+        || ( jacobian - expectedJacobian ).absolute_value_max() > 1.0e-12 )
+      {
+      std::cerr << name << ": the Jacobian at " << point << " differs with the separable weights" << std::endl;
+      return false;
+      }
+    }
+  if( inside == 0 || inside == 1000 )
+    {
+    std::cerr << name << ": the points should be partly inside of the grid" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+/** Evaluates the metrics with and without the caching of the weights, as
+ * the parameters change, then as the fixed parameters change. */
+template< typename TMetric >
+bool CheckMetric( const char *name, TMetric *cachedMetric, TMetric *metric, BSplineTransformType *transform,
+                  typename TMetric::MovingTransformType *movingTransform, GeneratorType *generator )
+{
+  for( unsigned int iteration = 0; iteration < 6; ++iteration )
+    {
+    if( iteration == 4 )
+      {
+      BSplineTransformType::MeshSizeType meshSize;
+      meshSize.Fill( 7 );
+      transform->SetTransformDomainMeshSize( meshSize );
+      // a composite transform counts the parameters again when modified
+      movingTransform->Modified();
+      }
+    RandomizeParameters( transform, generator, 2.0 );
+
+    typename TMetric::MeasureType    cachedValue;
+    typename TMetric::MeasureType    value;
+    typename TMetric::DerivativeType cachedDerivative;
+    typename TMetric::DerivativeType derivative;
+    cachedMetric->GetValueAndDerivative( cachedValue, cachedDerivative );
+    metric->GetValueAndDerivative( value, derivative );
+
+    if( !IsClose( cachedValue, value, 1.0e-8 ) )
+      {
+      std::cerr << name << ", iteration " << iteration << ": the value is " << cachedValue
+                << " with the cache instead of " << value << std::endl;
+      return false;
+      }
+    double maximum = 0.0;
+    for( unsigned int p = 0; p < derivative.Size(); ++p )
+      {
+      maximum = std::max( maximum, std::abs( derivative[p] ) );
+      }
+    for( unsigned int p = 0; p < derivative.Size(); ++p )
+      {
+      if( std::abs( cachedDerivative[p] - derivative[p] ) > 1.0e-8 * maximum )
+        {
+        std::cerr << name << ", iteration " << iteration << ": the derivative " << p << " is "
+                  << cachedDerivative[p] << " with the cache instead of " << derivative[p] << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+template< typename TMetric >
+bool CheckMetrics( const char *name, ImageType *fixedImage, ImageType *movingImage, GeneratorType *generator )
+{
+  BSplineTransformType::Pointer transform = BSplineTransformType::New();
+  BSplineTransformType::MeshSizeType meshSize;
+  meshSize.Fill( 5 );
+  BSplineTransformType::PhysicalDimensionsType dimensions;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    dimensions[d] = fixedImage->GetSpacing()[d] * ( fixedImage->GetLargestPossibleRegion().GetSize( d ) - 1 );
+    }
+  transform->SetTransformDomainOrigin( fixedImage->GetOrigin() );
+  transform->SetTransformDomainPhysicalDimensions( dimensions );
+  transform->SetTransformDomainMeshSize( meshSize );
+  RandomizeParameters( transform, generator, 2.0 );
+
+  // a fifth of the pixels, with a random offset
+  typedef typename TMetric::FixedSampledPointSetType PointSetType;
+  typename PointSetType::Pointer points = PointSetType::New();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( fixedImage, fixedImage->GetLargestPossibleRegion() );
+  unsigned int count = 0;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if( generator->GetIntegerVariate( 4 ) == 0 )
+      {
+      typename PointSetType::PointType point;
+      fixedImage->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        point[d] += generator->GetUniformVariate( -0.5, 0.5 );
+        }
+      points->SetPoint( count++, point );
+      }
+    }
+
+  // the B-spline transform alone, then optimized within a composite
+  // transform after an affine transform, as set by the registration methods
+  typedef itk::CompositeTransform< double, Dimension > CompositeTransformType;
+  typedef itk::AffineTransform< double, Dimension >    AffineTransformType;
+  AffineTransformType::Pointer affine = AffineTransformType::New();
+  affine->Rotate( 0, 1, 0.05 );
+  affine->Scale( 1.02 );
+  CompositeTransformType::Pointer composite = CompositeTransformType::New();
+  composite->AddTransform( affine );
+  composite->AddTransform( transform );
+  composite->SetOnlyMostRecentTransformToOptimizeOn();
+
+  bool passed = true;
+  for( unsigned int variant = 0; variant < 4; ++variant )
+    {
+    const bool sparse = ( variant & 1 ) != 0;
+    const bool isComposite = ( variant & 2 ) != 0;
+    transform->SetTransformDomainMeshSize( meshSize );
+    typename TMetric::MovingTransformType::Pointer movingTransform = transform.GetPointer();
+    if( isComposite )
+      {
+      composite->Modified();
+      movingTransform = composite.GetPointer();
+      }
+    typename TMetric::Pointer metrics[2];
+    for( unsigned int cached = 0; cached < 2; ++cached )
+      {
+      metrics[cached] = TMetric::New();
+      metrics[cached]->SetFixedImage( fixedImage );
+      metrics[cached]->SetMovingImage( movingImage );
+      metrics[cached]->SetMovingTransform( movingTransform );
+      metrics[cached]->SetUseCachingOfBSplineWeights( cached != 0 );
+      if( sparse )
+        {
+        metrics[cached]->SetFixedSampledPointSet( points );
+        metrics[cached]->UseFixedSampledPointSetOn();
+        }
+      metrics[cached]->Initialize();
+      }
+    const std::string metricName = std::string( name ) + ( sparse ? " sparse" : " dense" )
+      + ( isComposite ? " composite" : "" );
+    passed &= CheckMetric( metricName.c_str(), metrics[1].GetPointer(), metrics[0].GetPointer(), transform.GetPointer(),
+                           movingTransform.GetPointer(), generator );
+    }
+  return passed;
+}
+
+}
+
+/** Checks that the caching of the B-spline weights of the points of
+ * the virtual domain does not change the values and derivatives of the
+ * metrics, with the B-spline transform alone or within a composite
+ * transform. */
+int itkImageToImageMetricv4BSplineWeightsCacheTest( int, char* [] )
+{
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  ImageType::Pointer fixedImage = CreateImage( 0.0 );
+  ImageType::Pointer movingImage = CreateImage( 0.3 );
+
+  bool passed = true;
+
+  BSplineTransformType::Pointer bspline = BSplineTransformType::New();
+  BSplineTransformType::MeshSizeType meshSize;
+  meshSize.Fill( 4 );
+  BSplineTransformType::PhysicalDimensionsType dimensions;
+  dimensions.Fill( 50.0 );
+  bspline->SetTransformDomainPhysicalDimensions( dimensions );
+  bspline->SetTransformDomainMeshSize( meshSize );
+  RandomizeParameters( bspline, generator, 3.0 );
+  passed &= CheckTransform( "BSplineTransform", bspline.GetPointer(), generator );
+
+  // the bulk transform applies to the points outside of the grid too
+  typedef itk::BSplineDeformableTransform< double, Dimension, 3 > DeformableTransformType;
+  DeformableTransformType::Pointer deformable = DeformableTransformType::New();
+  DeformableTransformType::RegionType region;
+  DeformableTransformType::SizeType   size;
+  size.Fill( 7 );
+  region.SetSize( size );
+  DeformableTransformType::SpacingType spacing;
+  spacing.Fill( 10.0 );
+  DeformableTransformType::OriginType origin;
+  origin.Fill( -10.0 );
+  deformable->SetGridRegion( region );
+  deformable->SetGridSpacing( spacing );
+  deformable->SetGridOrigin( origin );
+  DeformableTransformType::ParametersType parameters( deformable->GetNumberOfParameters() );
+  for( unsigned int p = 0; p < parameters.Size(); ++p )
+    {
+    parameters[p] = generator->GetUniformVariate( -3.0, 3.0 );
+    }
+  deformable->SetParameters( parameters );
+  typedef itk::AffineTransform< double, Dimension > AffineTransformType;
+  AffineTransformType::Pointer bulk = AffineTransformType::New();
+  bulk->Rotate( 0, 1, 0.1 );
+  deformable->SetBulkTransform( bulk );
+  passed &= CheckTransform( "BSplineDeformableTransform", deformable.GetPointer(), generator );
+
+  typedef itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >         MeanSquaresMetricType;
+  typedef itk::MattesMutualInformationImageToImageMetricv4< ImageType, ImageType > MattesMetricType;
+  passed &= CheckMetrics< MeanSquaresMetricType >( "MeanSquares", fixedImage, movingImage, generator );
+  passed &= CheckMetrics< MattesMetricType >( "Mattes", fixedImage, movingImage, generator );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMattesMutualInformationImageToImageMetricv4.h"
+#include "itkBSplineTransform.h"
+#include "itkAffineTransform.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <cmath>
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+typedef itk::Image< float, Dimension >                                           ImageType;
+typedef itk::MattesMutualInformationImageToImageMetricv4< ImageType, ImageType > MetricType;
+typedef itk::BSplineTransform< double, Dimension, 3 >                            BSplineTransformType;
+typedef itk::AffineTransform< double, Dimension >                                AffineTransformType;
+typedef itk::Statistics::MersenneTwisterRandomVariateGenerator                   GeneratorType;
+
+BSplineTransformType::Pointer CreateBSplineTransform( const ImageType *image, unsigned int meshSize,
+                                                      GeneratorType *generator )
+{
+  BSplineTransformType::Pointer transform = BSplineTransformType::New();
+  BSplineTransformType::MeshSizeType mesh;
+  mesh.Fill( meshSize );
+  BSplineTransformType::PhysicalDimensionsType dimensions;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    dimensions[d] = image->GetSpacing()[d] * ( image->GetLargestPossibleRegion().GetSize( d ) - 1 );
+    }
+  transform->SetTransformDomainOrigin( image->GetOrigin() );
+  transform->SetTransformDomainPhysicalDimensions( dimensions );
+  transform->SetTransformDomainMeshSize( mesh );
+  BSplineTransformType::ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int p = 0; p < parameters.Size(); ++p )
+    {
+    parameters[p] = generator->GetUniformVariate( -1.0, 1.0 );
+    }
+  transform->SetParametersByValue( parameters );
+  return transform;
+}
+
+/** Computes the value and derivative with and without explicit PDF
+ * derivatives, and checks that they are the same. */
+bool CheckDerivatives( const char *name, ImageType *fixedImage, ImageType *movingImage,
+                       MetricType::MovingTransformType *transform, bool sparse, bool cached,
+                       itk::ThreadIdType numberOfThreads )
+{
+  typedef MetricType::FixedSampledPointSetType PointSetType;
+  PointSetType::Pointer points = PointSetType::New();
+  if( sparse )
+    {
+    GeneratorType::Pointer generator = GeneratorType::New();
+    generator->Initialize( 17 );
+    itk::ImageRegionIteratorWithIndex< ImageType > it( fixedImage, fixedImage->GetLargestPossibleRegion() );
+    unsigned int count = 0;
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      if( generator->GetIntegerVariate( 2 ) == 0 )
+        {
+        PointSetType::PointType point;
+        fixedImage->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+        points->SetPoint( count++, point );
+        }
+      }
+    }
+
+  MetricType::MeasureType    values[2];
+  MetricType::DerivativeType derivatives[2];
+  for( unsigned int useExplicit = 0; useExplicit < 2; ++useExplicit )
+    {
+    MetricType::Pointer metric = MetricType::New();
+    metric->SetFixedImage( fixedImage );
+    metric->SetMovingImage( movingImage );
+    metric->SetMovingTransform( transform );
+    metric->SetNumberOfHistogramBins( 32 );
+    metric->SetUseExplicitPDFDerivatives( useExplicit != 0 );
+    metric->SetUseCachingOfBSplineWeights( cached );
+    metric->SetMaximumNumberOfThreads( numberOfThreads );
+    if( sparse )
+      {
+      metric->SetFixedSampledPointSet( points );
+      metric->UseFixedSampledPointSetOn();
+      }
+    metric->Initialize();
+
+    // the second evaluation uses the cached weights, if any
+    for( unsigned int i = 0; i < 2; ++i )
+      {
+      metric->GetValueAndDerivative( values[useExplicit], derivatives[useExplicit] );
+      }
+
+    if( !useExplicit && metric->GetJointPDFDerivatives().IsNotNull() )
+      {
+      std::cerr << name << ": the joint PDF derivatives are allocated without explicit PDF derivatives" << std::endl;
+      return false;
+      }
+    // the threads add their joint PDFs in any order
+    if( !( std::abs( metric->GetValue() - values[useExplicit] ) <= 1e-10 * std::abs( values[useExplicit] ) ) )
+      {
+      std::cerr << name << ": GetValue() returns " << metric->GetValue() << " instead of " << values[useExplicit]
+                << std::endl;
+      return false;
+      }
+    }
+  if( !( std::abs( values[0] - values[1] ) <= 1e-10 * std::abs( values[1] ) ) )
+    {
+    std::cerr << name << ": the value is " << values[0] << " without explicit PDF derivatives instead of "
+              << values[1] << std::endl;
+    return false;
+    }
+  double maximum = 0.0;
+  for( unsigned int p = 0; p < derivatives[1].Size(); ++p )
+    {
+    maximum = std::max( maximum, std::abs( derivatives[1][p] ) );
+    }
+  if( maximum == 0.0 || derivatives[0].Size() != derivatives[1].Size() )
+    {
+    std::cerr << name << ": wrong derivative" << std::endl;
+    return false;
+    }
+  for( unsigned int p = 0; p < derivatives[1].Size(); ++p )
+    {
+    if( !( std::abs( derivatives[0][p] - derivatives[1][p] ) <= 1e-9 * maximum ) )
+      {
+      std::cerr << name << ": the derivative " << p << " is " << derivatives[0][p]
+                << " without explicit PDF derivatives instead of " << derivatives[1][p] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+/** Checks that MattesMutualInformationImageToImageMetricv4 computes the same
+ * value and derivative with and without explicit PDF derivatives, with
+ * BSpline and affine transforms, dense and sparse samplings, and one or
+ * several threads. */
+int itkMattesMutualInformationImageToImageMetricv4ImplicitDerivativesTest( int argc, char * argv[] )
+{
+  if( argc < 3 )
+    {
+    std::cerr << "Usage: " << argv[0] << " fixedImage movingImage" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer fixedReader = ReaderType::New();
+  fixedReader->SetFileName( argv[1] );
+  ReaderType::Pointer movingReader = ReaderType::New();
+  movingReader->SetFileName( argv[2] );
+
+  try
+    {
+    fixedReader->Update();
+    movingReader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::Pointer fixedImage = fixedReader->GetOutput();
+  ImageType::Pointer movingImage = movingReader->GetOutput();
+
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  BSplineTransformType::Pointer bspline = CreateBSplineTransform( fixedImage, 5, generator );
+  AffineTransformType::Pointer affine = AffineTransformType::New();
+  affine->Rotate2D( 0.05 );
+  AffineTransformType::OutputVectorType translation;
+  translation.Fill( 0.7 );
+  affine->Translate( translation );
+
+  bool passed = true;
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 4 };
+  for( unsigned int t = 0; t < 2; ++t )
+    {
+    for( unsigned int sparse = 0; sparse < 2; ++sparse )
+      {
+      for( unsigned int cached = 0; cached < 2; ++cached )
+        {
+        passed &= CheckDerivatives( "BSplineTransform", fixedImage, movingImage, bspline, sparse, cached,
+                                    numbersOfThreads[t] );
+        }
+      passed &= CheckDerivatives( "AffineTransform", fixedImage, movingImage, affine, sparse, false,
+                                  numbersOfThreads[t] );
+      }
+    }
+
+  // a finer grid, with many more parameters than histogram bins
+  BSplineTransformType::Pointer fineBSpline = CreateBSplineTransform( fixedImage, 20, generator );
+  passed &= CheckDerivatives( "fine BSplineTransform", fixedImage, movingImage, fineBSpline, false, true, 4 );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
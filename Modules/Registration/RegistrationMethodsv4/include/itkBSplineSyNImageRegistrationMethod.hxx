@@ -165,29 +165,35 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
 
     typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType> ComposerType;
 
+    this->m_OptimizationPhaseTimeProbes[Superclass::COMPOSITION].Start();
     typename ComposerType::Pointer fixedComposer = ComposerType::New();
     fixedComposer->SetDisplacementField( fixedToMiddleSmoothUpdateField );
     fixedComposer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
     fixedComposer->Update();
 
-    DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp = this->BSplineSmoothDisplacementField( fixedComposer->GetOutput(),
-      this->m_FixedToMiddleTransform->GetNumberOfControlPointsForTheTotalField(), ITK_NULLPTR, ITK_NULLPTR );
-
     typename ComposerType::Pointer movingComposer = ComposerType::New();
     movingComposer->SetDisplacementField( movingToMiddleSmoothUpdateField );
     movingComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
     movingComposer->Update();
+    this->m_OptimizationPhaseTimeProbes[Superclass::COMPOSITION].Stop();
+
+    this->m_OptimizationPhaseTimeProbes[Superclass::TOTAL_FIELD_SMOOTHING].Start();
+    DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp = this->BSplineSmoothDisplacementField( fixedComposer->GetOutput(),
+      this->m_FixedToMiddleTransform->GetNumberOfControlPointsForTheTotalField(), ITK_NULLPTR, ITK_NULLPTR );
 
     DisplacementFieldPointer movingToMiddleSmoothTotalFieldTmp = this->BSplineSmoothDisplacementField( movingComposer->GetOutput(),
       this->m_MovingToMiddleTransform->GetNumberOfControlPointsForTheTotalField(), ITK_NULLPTR, ITK_NULLPTR );
+    this->m_OptimizationPhaseTimeProbes[Superclass::TOTAL_FIELD_SMOOTHING].Stop();
 
     // Iteratively estimate the inverse fields.
 
+    this->m_OptimizationPhaseTimeProbes[Superclass::INVERSION].Start();
     DisplacementFieldPointer fixedToMiddleSmoothTotalFieldInverse = this->InvertDisplacementField( fixedToMiddleSmoothTotalFieldTmp, this->m_FixedToMiddleTransform->GetInverseDisplacementField() );
     DisplacementFieldPointer fixedToMiddleSmoothTotalField = this->InvertDisplacementField( fixedToMiddleSmoothTotalFieldInverse, fixedToMiddleSmoothTotalFieldTmp );
 
     DisplacementFieldPointer movingToMiddleSmoothTotalFieldInverse = this->InvertDisplacementField( movingToMiddleSmoothTotalFieldTmp, this->m_MovingToMiddleTransform->GetInverseDisplacementField() );
     DisplacementFieldPointer movingToMiddleSmoothTotalField = this->InvertDisplacementField( movingToMiddleSmoothTotalFieldInverse, movingToMiddleSmoothTotalFieldTmp );
+    this->m_OptimizationPhaseTimeProbes[Superclass::INVERSION].Stop();
 
     // Assign the displacement fields and their inverses to the proper transforms.
     this->m_FixedToMiddleTransform->SetDisplacementField( fixedToMiddleSmoothTotalField );
@@ -221,6 +227,8 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
 
   typename WeightedMaskImageType::Pointer weightedMask = ITK_NULLPTR;
 
+  // The gradient of a point set metric is fitted by the B-spline smoothing,
+  // which is timed with the update field smoothing.
   if( this->m_Metric->GetMetricCategory() == MetricType::POINT_SET_METRIC )
     {
     const DisplacementVectorType zeroVector( 0.0 );
@@ -241,11 +249,13 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
 
     dynamic_cast<PointSetMetricType *>( this->m_Metric.GetPointer() )->SetCalculateValueAndDerivativeInTangentSpace( true );
 
+    this->m_OptimizationPhaseTimeProbes[Superclass::METRIC_GRADIENT].Start();
     this->m_Metric->Initialize();
     dynamic_cast<PointSetMetricType *>( this->m_Metric.GetPointer() )->
       SetStoreDerivativeAsSparseFieldForLocalSupportTransforms( false );
     typename ImageMetricType::DerivativeType metricDerivative;
     this->m_Metric->GetValueAndDerivative( value, metricDerivative );
+    this->m_OptimizationPhaseTimeProbes[Superclass::METRIC_GRADIENT].Stop();
 
     typename BSplinePointSetType::Pointer gradientPointSet = BSplinePointSetType::New();
     gradientPointSet->Initialize();
@@ -270,8 +280,10 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
 
         ++It;
         }
+      this->m_OptimizationPhaseTimeProbes[Superclass::UPDATE_FIELD_SMOOTHING].Start();
       updateField = this->BSplineSmoothDisplacementField( metricGradientField,
         this->m_FixedToMiddleTransform->GetNumberOfControlPointsForTheUpdateField(), weightedMask, gradientPointSet );
+      this->m_OptimizationPhaseTimeProbes[Superclass::UPDATE_FIELD_SMOOTHING].Stop();
       }
     else
       {
@@ -280,8 +292,10 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
     }
   else
     {
+    this->m_OptimizationPhaseTimeProbes[Superclass::METRIC_GRADIENT].Start();
     metricGradientField = this->ComputeMetricGradientField(
         fixedImages, fixedPointSets, fixedTransform, movingImages, movingPointSets, movingTransform, mask, value );
+    this->m_OptimizationPhaseTimeProbes[Superclass::METRIC_GRADIENT].Stop();
 
     if( mask )
       {
@@ -299,11 +313,15 @@ BSplineSyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, T
       weightedMask->Update();
       weightedMask->DisconnectPipeline();
       }
+    this->m_OptimizationPhaseTimeProbes[Superclass::UPDATE_FIELD_SMOOTHING].Start();
     updateField = this->BSplineSmoothDisplacementField( metricGradientField,
       this->m_FixedToMiddleTransform->GetNumberOfControlPointsForTheUpdateField(), weightedMask, ITK_NULLPTR );
+    this->m_OptimizationPhaseTimeProbes[Superclass::UPDATE_FIELD_SMOOTHING].Stop();
     }
 
+  this->m_OptimizationPhaseTimeProbes[Superclass::UPDATE_FIELD_SCALING].Start();
   DisplacementFieldPointer scaledUpdateField = this->ScaleUpdateField( updateField );
+  this->m_OptimizationPhaseTimeProbes[Superclass::UPDATE_FIELD_SCALING].Stop();
 
   return scaledUpdateField;
 }
@@ -25,6 +25,7 @@
 #include "itkObjectToObjectMetricBase.h"
 #include "itkObjectToObjectMultiMetricv4.h"
 #include "itkObjectToObjectOptimizerBase.h"
+#include "itkImageRegistrationPyramidCache.h"
 #include "itkImageToImageMetricv4.h"
 #include "itkPointSetToPointSetMetricv4.h"
 #include "itkShrinkImageFilter.h"
@@ -164,6 +165,9 @@ public:
   typedef Array<SizeValueType>                                        ShrinkFactorsArrayType;
 
   typedef Array<RealType>                                             SmoothingSigmasArrayType;
+
+  typedef ImageRegistrationPyramidCache<FixedImageType, MovingImageType, VirtualImageType> PyramidCacheType;
+  typedef typename PyramidCacheType::Pointer                          PyramidCachePointer;
   typedef Array<RealType>                                             MetricSamplingPercentageArrayType;
 
   /** Transform adaptor typedefs */
@@ -178,8 +182,21 @@ public:
   /** Weights type for the optimizer. */
   typedef typename OptimizerType::ScalesType                          OptimizerWeightsType;
 
-  /** enum type for metric sampling strategy */
-  enum MetricSamplingStrategyType { NONE, REGULAR, RANDOM };
+  /** enum type for metric sampling strategy
+   *
+   *   \li NONE: the metric uses all the points of the virtual domain.
+   *   \li REGULAR: every n-th voxel of the virtual domain, randomly perturbed.
+   *   \li RANDOM: voxels drawn at random, randomly perturbed.
+   *   \li LOW_DISCREPANCY: points of a Halton sequence over the virtual
+   *       domain, which cover the domain more evenly than random points,
+   *       so that fewer points give the same accuracy.
+   *   \li GRADIENT_WEIGHTED: voxels drawn with a probability that is the
+   *       average of a uniform probability and of a probability proportional
+   *       to the gradient magnitude of the fixed image, randomly perturbed.
+   *       The samples concentrate on the edges, which drive the registration,
+   *       while the flat regions are still sampled.
+   */
+  enum MetricSamplingStrategyType { NONE, REGULAR, RANDOM, LOW_DISCREPANCY, GRADIENT_WEIGHTED };
 
   typedef typename ImageMetricType::FixedSampledPointSetType          MetricSamplePointSetType;
 
@@ -261,6 +278,33 @@ public:
   itkSetMacro( MetricSamplingPercentagePerLevel, MetricSamplingPercentageArrayType );
   itkGetConstMacro( MetricSamplingPercentagePerLevel, MetricSamplingPercentageArrayType );
 
+  /**
+   * Set/Get whether new metric samples are drawn at each iteration of the
+   * optimizer, rather than once per level. The metric then sees a different
+   * subset of the virtual domain at each iteration, which is the
+   * stochastic gradient approach: with a small sampling percentage, the
+   * errors of the gradients average out across the iterations instead of
+   * biasing the optimization towards the points of a fixed subset. The
+   * sequence of a LOW_DISCREPANCY strategy continues from one iteration to
+   * the next, so that the successive samples fill the gaps of the previous
+   * ones.
+   *
+   * The samples are drawn again after each iteration, so this is only
+   * supported with a plain GradientDescentOptimizerv4Template, whose
+   * iterations evaluate the metric once. The optimizers which compare the
+   * metric values or the gradients of several evaluations, such as the line
+   * search, conjugate gradient, regular step and quasi-Newton optimizers,
+   * would compare values computed on different samples. With any other
+   * optimizer, a warning is issued and the samples are drawn once per
+   * level. The convergence window of the gradient descent also compares
+   * the metric values of successive iterations, which are noisier with new
+   * samples: rely on the number of iterations, or use a larger
+   * ConvergenceWindowSize. Off by default.
+   */
+  itkSetMacro( ResampleMetricSamplePointsEachIteration, bool );
+  itkGetConstMacro( ResampleMetricSamplePointsEachIteration, bool );
+  itkBooleanMacro( ResampleMetricSamplePointsEachIteration );
+
   /** Set/Get the initial fixed transform. */
   itkSetGetDecoratedObjectInputMacro( FixedInitialTransform, InitialTransformType );
 
@@ -342,7 +386,8 @@ public:
 
   /**
    * Set/Get the smoothing sigmas for each level.  At each resolution level, a gaussian smoothing
-   * filter (specifically, the \c itkDiscreteGaussianImageFilter) is applied.  Sigma values are
+   * filter (specifically, the \c itkDiscreteGaussianImageFilter, or the
+   * \c itkSmoothingRecursiveGaussianImageFilter, see SetUseRecursiveGaussianSmoothing()) is applied.  Sigma values are
    * specified according to the option \c m_SmoothingSigmasAreSpecifiedInPhysicalUnits.
    */
   itkSetMacro( SmoothingSigmasPerLevel, SmoothingSigmasArrayType );
@@ -356,6 +401,25 @@ public:
   itkGetConstMacro( SmoothingSigmasAreSpecifiedInPhysicalUnits, bool );
   itkBooleanMacro( SmoothingSigmasAreSpecifiedInPhysicalUnits );
 
+  /**
+   * Set/Get whether to smooth the images with the \c itkSmoothingRecursiveGaussianImageFilter
+   * instead of the \c itkDiscreteGaussianImageFilter.  The cost of the recursive filter does not
+   * depend on the sigma, which makes it faster for large sigmas, but the images must then have at
+   * least four voxels along each dimension.  Off by default.
+   */
+  itkSetMacro( UseRecursiveGaussianSmoothing, bool );
+  itkGetConstMacro( UseRecursiveGaussianSmoothing, bool );
+  itkBooleanMacro( UseRecursiveGaussianSmoothing );
+
+  /**
+   * Set/Get the cache of the smoothed images and of the shrunk virtual domains.  The stages
+   * of a multistage registration can share a cache so that the levels common to several
+   * stages are computed once.  Without a cache (default), each level is computed and then
+   * released.
+   */
+  itkSetObjectMacro( PyramidCache, PyramidCacheType );
+  itkGetModifiableObjectMacro( PyramidCache, PyramidCacheType );
+
   /** Make a DataObject of the correct type to be used as the specified output. */
   typedef ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
   using Superclass::MakeOutput;
@@ -454,6 +518,17 @@ protected:
   /** Get metric samples. */
   virtual void SetMetricSamplePoints();
 
+  /** Draw new metric samples during the optimization, and map them to
+   * the virtual domain of the initialized metrics. */
+  virtual void ResampleMetricSamplePoints();
+
+  /** Compute the sampling weight of each voxel of the virtual domain for
+   * the GRADIENT_WEIGHTED strategy, from the gradient magnitude of the
+   * fixed image of the metric. */
+  void ComputeGradientSamplingWeights( const ImageMetricType *, const VirtualImageType *,
+    const typename VirtualImageType::RegionType &, const typename ImageMetricType::FixedImageMaskType *,
+    std::vector<RealType> & ) const;
+
   SizeValueType                                                   m_CurrentLevel;
   SizeValueType                                                   m_NumberOfLevels;
   SizeValueType                                                   m_CurrentIteration;
@@ -476,11 +551,19 @@ protected:
   MetricPointer                                                   m_Metric;
   MetricSamplingStrategyType                                      m_MetricSamplingStrategy;
   MetricSamplingPercentageArrayType                               m_MetricSamplingPercentagePerLevel;
+  bool                                                            m_ResampleMetricSamplePointsEachIteration;
+  /** Number of times the metric samples were drawn at the current level. */
+  SizeValueType                                                   m_MetricSamplingCount;
+  /** Sampling weight of each voxel of the virtual domain per metric, with
+   * the GRADIENT_WEIGHTED strategy, computed once per level. */
+  std::vector< std::vector<RealType> >                            m_MetricSamplingWeights;
   SizeValueType                                                   m_NumberOfMetrics;
   int                                                             m_FirstImageMetricIndex;
   std::vector<ShrinkFactorsPerDimensionContainerType>             m_ShrinkFactorsPerLevel;
   SmoothingSigmasArrayType                                        m_SmoothingSigmasPerLevel;
   bool                                                            m_SmoothingSigmasAreSpecifiedInPhysicalUnits;
+  bool                                                            m_UseRecursiveGaussianSmoothing;
+  PyramidCachePointer                                             m_PyramidCache;
 
   TransformParametersAdaptorsContainerType                        m_TransformParametersAdaptorsPerLevel;
 
@@ -499,6 +582,9 @@ private:
 
   bool                                                            m_InitializeCenterOfLinearOutputTransform;
 
+  /** The i-th element of the van der Corput sequence in the given base. */
+  static RealType RadicalInverse( SizeValueType, unsigned int );
+
   // helper function to create the right kind of concrete transform
   template<typename TTransform>
   static void MakeOutputTransform(SmartPointer<TTransform> &ptr)
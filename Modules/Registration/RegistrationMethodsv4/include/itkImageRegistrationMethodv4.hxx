@@ -20,6 +20,8 @@
 
 #include "itkImageRegistrationMethodv4.h"
 
+#include "itkCommand.h"
+#include "itkDefaultConvertPixelTraits.h"
 #include "itkDiscreteGaussianImageFilter.h"
 #include "itkGradientDescentOptimizerv4.h"
 #include "itkImageRandomConstIteratorWithIndex.h"
@@ -30,6 +32,8 @@
 #include "itkMersenneTwisterRandomVariateGenerator.h"
 #include "itkRegistrationParameterScalesFromPhysicalShift.h"
 
+#include <typeinfo>
+
 namespace itk
 {
 /**
@@ -120,10 +124,14 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   this->m_SmoothingSigmasPerLevel[2] = 0;
 
   this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits = true;
+  this->m_UseRecursiveGaussianSmoothing = false;
+  this->m_PyramidCache = ITK_NULLPTR;
 
   this->m_MetricSamplingStrategy = NONE;
   this->m_MetricSamplingPercentagePerLevel.SetSize( this->m_NumberOfLevels );
   this->m_MetricSamplingPercentagePerLevel.Fill( 1.0 );
+  this->m_ResampleMetricSamplePointsEachIteration = false;
+  this->m_MetricSamplingCount = 0;
 }
 
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
@@ -436,12 +444,16 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   typename VirtualImageType::Pointer currentLevelVirtualDomainImage = ITK_NULLPTR;
   if( this->m_VirtualDomainImage.IsNotNull() )
     {
-    typename ShrinkFilterType::Pointer shrinkFilter = ShrinkFilterType::New();
-    shrinkFilter->SetShrinkFactors( this->m_ShrinkFactorsPerLevel[level] );
-    shrinkFilter->SetInput( this->m_VirtualDomainImage );
-
-    currentLevelVirtualDomainImage = shrinkFilter->GetOutput();
-    currentLevelVirtualDomainImage->Update();
+    if( this->m_PyramidCache.IsNotNull() )
+      {
+      currentLevelVirtualDomainImage = this->m_PyramidCache->GetShrunkVirtualDomainImage(
+        this->m_VirtualDomainImage, this->m_ShrinkFactorsPerLevel[level] );
+      }
+    else
+      {
+      currentLevelVirtualDomainImage = PyramidCacheType::ShrinkVirtualDomainImage(
+        this->m_VirtualDomainImage, this->m_ShrinkFactorsPerLevel[level] );
+      }
     }
   else
     {
@@ -574,41 +586,21 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
         ( this->m_Metric->GetMetricCategory() == MetricType::MULTI_METRIC &&
           multiMetric->GetMetricQueue()[n]->GetMetricCategory() == MetricType::IMAGE_METRIC ) )
       {
-      typedef DiscreteGaussianImageFilter<FixedImageType, FixedImageType> FixedImageSmoothingFilterType;
-      typename FixedImageSmoothingFilterType::Pointer fixedImageSmoothingFilter = FixedImageSmoothingFilterType::New();
-      if( this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits == true )
+      const RealType sigma = this->m_SmoothingSigmasPerLevel[level];
+      if( this->m_PyramidCache.IsNotNull() )
         {
-        fixedImageSmoothingFilter->SetUseImageSpacingOn();
+        this->m_FixedSmoothImages[n] = this->m_PyramidCache->GetSmoothedFixedImage( this->GetFixedImage( n ),
+          sigma, this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits, this->m_UseRecursiveGaussianSmoothing );
+        this->m_MovingSmoothImages[n] = this->m_PyramidCache->GetSmoothedMovingImage( this->GetMovingImage( n ),
+          sigma, this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits, this->m_UseRecursiveGaussianSmoothing );
         }
       else
         {
-        fixedImageSmoothingFilter->SetUseImageSpacingOff();
+        this->m_FixedSmoothImages[n] = PyramidCacheType::SmoothImage( this->GetFixedImage( n ),
+          sigma, this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits, this->m_UseRecursiveGaussianSmoothing );
+        this->m_MovingSmoothImages[n] = PyramidCacheType::SmoothImage( this->GetMovingImage( n ),
+          sigma, this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits, this->m_UseRecursiveGaussianSmoothing );
         }
-      fixedImageSmoothingFilter->SetVariance( vnl_math_sqr( this->m_SmoothingSigmasPerLevel[level] ) );
-      fixedImageSmoothingFilter->SetMaximumError( 0.01 );
-      fixedImageSmoothingFilter->SetInput( this->GetFixedImage( n ) );
-
-      this->m_FixedSmoothImages[n] = fixedImageSmoothingFilter->GetOutput();
-      this->m_FixedSmoothImages[n]->Update();
-      this->m_FixedSmoothImages[n]->DisconnectPipeline();
-
-      typedef DiscreteGaussianImageFilter<MovingImageType, MovingImageType> MovingImageSmoothingFilterType;
-      typename MovingImageSmoothingFilterType::Pointer movingImageSmoothingFilter = MovingImageSmoothingFilterType::New();
-      if( this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits == true )
-        {
-        movingImageSmoothingFilter->SetUseImageSpacingOn();
-        }
-      else
-        {
-        movingImageSmoothingFilter->SetUseImageSpacingOff();
-        }
-      movingImageSmoothingFilter->SetVariance( vnl_math_sqr( this->m_SmoothingSigmasPerLevel[level] ) );
-      movingImageSmoothingFilter->SetMaximumError( 0.01 );
-      movingImageSmoothingFilter->SetInput( this->GetMovingImage( n ) );
-
-      this->m_MovingSmoothImages[n] = movingImageSmoothingFilter->GetOutput();
-      this->m_MovingSmoothImages[n]->Update();
-      this->m_MovingSmoothImages[n]->DisconnectPipeline();
 
       // Update the image metric
 
@@ -659,6 +651,8 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
   if( this->m_MetricSamplingStrategy != NONE )
     {
+    this->m_MetricSamplingCount = 0;
+    this->m_MetricSamplingWeights.clear();
     this->SetMetricSamplePoints();
     }
 
@@ -763,7 +757,28 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
     this->m_Metric->Initialize();
 
+    unsigned long resampleObserverTag = 0;
+    bool resample = this->m_ResampleMetricSamplePointsEachIteration && this->m_MetricSamplingStrategy != NONE;
+    if( resample && typeid( *this->m_Optimizer.GetPointer() ) != typeid( GradientDescentOptimizerv4Template<RealType> ) )
+      {
+      itkWarningMacro( "ResampleMetricSamplePointsEachIteration is only supported with "
+                       "GradientDescentOptimizerv4Template. The metric samples are drawn once per level." );
+      resample = false;
+      }
+    if( resample )
+      {
+      typedef SimpleMemberCommand<Self> ResampleCommandType;
+      typename ResampleCommandType::Pointer resampleCommand = ResampleCommandType::New();
+      resampleCommand->SetCallbackFunction( this, &Self::ResampleMetricSamplePoints );
+      resampleObserverTag = this->m_Optimizer->AddObserver( IterationEvent(), resampleCommand );
+      }
+
     this->m_Optimizer->StartOptimization();
+
+    if( resample )
+      {
+      this->m_Optimizer->RemoveObserver( resampleObserverTag );
+      }
     }
 }
 
@@ -902,7 +917,7 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
     typedef typename Statistics::MersenneTwisterRandomVariateGenerator RandomizerType;
     typename RandomizerType::Pointer randomizer = RandomizerType::New();
-    randomizer->SetSeed( 1234 );
+    randomizer->SetSeed( 1234 + this->m_MetricSamplingCount );
 
     unsigned long index = 0;
 
@@ -960,6 +975,96 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
           }
         break;
         }
+      case LOW_DISCREPANCY:
+        {
+        const unsigned int primes[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29 };
+        if( ImageDimension > sizeof( primes ) / sizeof( primes[0] ) )
+          {
+          itkExceptionMacro( "The LOW_DISCREPANCY sampling strategy supports up to "
+            << sizeof( primes ) / sizeof( primes[0] ) << " dimensions." );
+          }
+        const unsigned long totalVirtualDomainVoxels = virtualDomainRegion.GetNumberOfPixels();
+        const unsigned long sampleCount = static_cast<unsigned long>( static_cast<float>( totalVirtualDomainVoxels ) * this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] );
+
+        // continue the sequence of the previous samples of the level, and
+        // skip its first element, which is the corner of the domain
+        const SizeValueType first = 1 + this->m_MetricSamplingCount * sampleCount;
+        for( SizeValueType i = first; i < first + sampleCount; ++i )
+          {
+          ContinuousIndex<typename SamplePointType::ValueType, ImageDimension> cindex;
+          for( unsigned int d = 0; d < ImageDimension; d++ )
+            {
+            cindex[d] = virtualDomainRegion.GetIndex()[d] - 0.5
+              + virtualDomainRegion.GetSize()[d] * RadicalInverse( i, primes[d] );
+            }
+          SamplePointType point;
+          virtualImage->TransformContinuousIndexToPhysicalPoint( cindex, point );
+          if( !fixedMaskImage || fixedMaskImage->IsInside( point ) )
+            {
+            samplePointSet->SetPoint( index, point );
+            ++index;
+            }
+          }
+        break;
+        }
+      case GRADIENT_WEIGHTED:
+        {
+        const ImageMetricType * imageMetric = multiMetric
+          ? dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )
+          : dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() );
+        if( this->m_MetricSamplingWeights.size() != numberOfLocalMetrics )
+          {
+          this->m_MetricSamplingWeights.resize( numberOfLocalMetrics );
+          }
+        std::vector<RealType> & weights = this->m_MetricSamplingWeights[n];
+        if( weights.empty() )
+          {
+          this->ComputeGradientSamplingWeights( imageMetric, virtualImage, virtualDomainRegion, fixedMaskImage, weights );
+          }
+
+        RealType totalWeight = NumericTraits<RealType>::ZeroValue();
+        for( SizeValueType v = 0; v < weights.size(); ++v )
+          {
+          totalWeight += weights[v];
+          }
+        const unsigned long totalVirtualDomainVoxels = virtualDomainRegion.GetNumberOfPixels();
+        const unsigned long sampleCount = static_cast<unsigned long>( static_cast<float>( totalVirtualDomainVoxels ) * this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] );
+        if( sampleCount == 0 || totalWeight <= NumericTraits<RealType>::ZeroValue() )
+          {
+          break;
+          }
+
+        // systematic sampling: a voxel is drawn as many times as the
+        // regularly spaced positions that fall in its share of the
+        // cumulated weights
+        const RealType step = totalWeight / static_cast<RealType>( sampleCount );
+        RealType position = randomizer->GetUniformVariate( 0.0, step );
+        RealType cumulatedWeight = NumericTraits<RealType>::ZeroValue();
+        SizeValueType v = 0;
+        ImageRegionConstIteratorWithIndex<VirtualDomainImageType> It( virtualImage, virtualDomainRegion );
+        for( It.GoToBegin(); !It.IsAtEnd(); ++It, ++v )
+          {
+          cumulatedWeight += weights[v];
+          while( position < cumulatedWeight )
+            {
+            position += step;
+            SamplePointType point;
+            virtualImage->TransformIndexToPhysicalPoint( It.GetIndex(), point );
+
+            // randomly perturb the point within a voxel (approximately)
+            for( unsigned int d = 0; d < ImageDimension; d++ )
+              {
+              point[d] += randomizer->GetNormalVariate() * oneThirdVirtualSpacing[d];
+              }
+            if( !fixedMaskImage || fixedMaskImage->IsInside( point ) )
+              {
+              samplePointSet->SetPoint( index, point );
+              ++index;
+              }
+            }
+          }
+        break;
+        }
       default:
         {
         itkExceptionMacro( "Invalid sampling strategy requested." );
@@ -977,6 +1082,139 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
       dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->SetUseFixedSampledPointSet( true );
       }
     }
+  ++this->m_MetricSamplingCount;
+}
+
+/**
+ * Compute the GRADIENT_WEIGHTED sampling weights of the virtual voxels
+ */
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::ComputeGradientSamplingWeights( const ImageMetricType * imageMetric, const VirtualImageType * virtualImage,
+  const typename VirtualImageType::RegionType & virtualDomainRegion,
+  const typename ImageMetricType::FixedImageMaskType * fixedMaskImage, std::vector<RealType> & weights ) const
+{
+  typedef typename ImageMetricType::FixedImageType                   MetricFixedImageType;
+  typedef typename MetricFixedImageType::PixelType                   MetricFixedPixelType;
+  typedef DefaultConvertPixelTraits<MetricFixedPixelType>            PixelConvertType;
+  typedef typename ImageMetricType::FixedTransformType               MetricFixedTransformType;
+
+  const MetricFixedImageType * fixedImage = imageMetric->GetFixedImage();
+  const MetricFixedTransformType * fixedTransform = imageMetric->GetFixedTransform();
+  const typename MetricFixedImageType::RegionType & fixedRegion = fixedImage->GetBufferedRegion();
+  const typename MetricFixedImageType::IndexType fixedUpperIndex = fixedRegion.GetUpperIndex();
+  const typename MetricFixedImageType::SpacingType & fixedSpacing = fixedImage->GetSpacing();
+
+  // the voxels outside of the fixed image or of the mask are marked with a
+  // negative weight, and are never drawn
+  weights.clear();
+  weights.reserve( virtualDomainRegion.GetNumberOfPixels() );
+  RealType sumOfMagnitudes = NumericTraits<RealType>::ZeroValue();
+  SizeValueType numberOfInsideVoxels = 0;
+  ImageRegionConstIteratorWithIndex<VirtualImageType> It( virtualImage, virtualDomainRegion );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    typename MetricFixedTransformType::InputPointType virtualPoint;
+    virtualImage->TransformIndexToPhysicalPoint( It.GetIndex(), virtualPoint );
+    typename MetricFixedImageType::IndexType fixedIndex;
+    if( ( fixedMaskImage && !fixedMaskImage->IsInside( virtualPoint ) )
+      || !fixedImage->TransformPhysicalPointToIndex( fixedTransform->TransformPoint( virtualPoint ), fixedIndex ) )
+      {
+      weights.push_back( -NumericTraits<RealType>::OneValue() );
+      continue;
+      }
+
+    // central differences, one-sided at the borders of the fixed image
+    RealType squaredMagnitude = NumericTraits<RealType>::ZeroValue();
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      typename MetricFixedImageType::IndexType lowerIndex = fixedIndex;
+      typename MetricFixedImageType::IndexType upperIndex = fixedIndex;
+      if( lowerIndex[d] > fixedRegion.GetIndex()[d] )
+        {
+        --lowerIndex[d];
+        }
+      if( upperIndex[d] < fixedUpperIndex[d] )
+        {
+        ++upperIndex[d];
+        }
+      if( upperIndex[d] == lowerIndex[d] )
+        {
+        continue;
+        }
+      const RealType distance = ( upperIndex[d] - lowerIndex[d] ) * fixedSpacing[d];
+      const MetricFixedPixelType lowerPixel = fixedImage->GetPixel( lowerIndex );
+      const MetricFixedPixelType upperPixel = fixedImage->GetPixel( upperIndex );
+      for( unsigned int c = 0; c < PixelConvertType::GetNumberOfComponents( upperPixel ); c++ )
+        {
+        const RealType difference = ( static_cast<RealType>( PixelConvertType::GetNthComponent( c, upperPixel ) )
+          - static_cast<RealType>( PixelConvertType::GetNthComponent( c, lowerPixel ) ) ) / distance;
+        squaredMagnitude += difference * difference;
+        }
+      }
+    const RealType magnitude = std::sqrt( squaredMagnitude );
+    weights.push_back( magnitude );
+    sumOfMagnitudes += magnitude;
+    ++numberOfInsideVoxels;
+    }
+
+  // Mix the gradient magnitudes half and half with a uniform weight, their
+  // mean, so that the flat regions keep half of their uniform share of the
+  // samples. A flat image is sampled uniformly.
+  RealType uniformWeight = NumericTraits<RealType>::OneValue();
+  if( numberOfInsideVoxels > 0 && sumOfMagnitudes > NumericTraits<RealType>::ZeroValue() )
+    {
+    uniformWeight = sumOfMagnitudes / static_cast<RealType>( numberOfInsideVoxels );
+    }
+  for( SizeValueType v = 0; v < weights.size(); ++v )
+    {
+    weights[v] = ( weights[v] < NumericTraits<RealType>::ZeroValue() )
+      ? NumericTraits<RealType>::ZeroValue() : weights[v] + uniformWeight;
+    }
+}
+
+/**
+ * Draw new metric samples during the optimization
+ */
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::ResampleMetricSamplePoints()
+{
+  this->SetMetricSamplePoints();
+
+  // the metrics are already initialized, and map their new samples to the
+  // virtual domain themselves
+  MultiMetricType * multiMetric = dynamic_cast<MultiMetricType *>( this->m_Metric.GetPointer() );
+  if( multiMetric )
+    {
+    for( SizeValueType n = 0; n < multiMetric->GetNumberOfMetrics(); n++ )
+      {
+      dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() )->UpdateVirtualSampledPointSet();
+      }
+    }
+  else
+    {
+    dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() )->UpdateVirtualSampledPointSet();
+    }
+}
+
+/**
+ * The i-th element of the van der Corput sequence in the given base
+ */
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+typename ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>::RealType
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::RadicalInverse( SizeValueType i, unsigned int base )
+{
+  RealType value = NumericTraits<RealType>::ZeroValue();
+  RealType digitWeight = NumericTraits<RealType>::OneValue() / base;
+  for( ; i > 0; i /= base, digitWeight /= base )
+    {
+    value += ( i % base ) * digitWeight;
+    }
+  return value;
 }
 
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
@@ -1087,6 +1325,13 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
     {
     os << indent2 << "Smoothing sigmas are specified in voxel units." << std::endl;
     }
+  os << indent << "UseRecursiveGaussianSmoothing: "
+     << ( this->m_UseRecursiveGaussianSmoothing ? "On" : "Off" ) << std::endl;
+  if( this->m_PyramidCache.IsNotNull() )
+    {
+    os << indent << "Pyramid cache: " << std::endl;
+    this->m_PyramidCache->Print( os, indent2 );
+    }
 
   if( this->m_OptimizerWeights.Size() > 0 )
     {
@@ -1102,6 +1347,9 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
     }
   os << std::endl;
 
+  os << indent << "ResampleMetricSamplePointsEachIteration: "
+     << ( this->m_ResampleMetricSamplePointsEachIteration ? "On" : "Off" ) << std::endl;
+
   os << indent << "InPlace: " << ( this->m_InPlace ? "On" : "Off" ) << std::endl;
 
   os << indent << "InitializeCenterOfLinearOutputTransform: "
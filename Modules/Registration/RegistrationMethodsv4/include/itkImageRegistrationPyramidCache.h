@@ -0,0 +1,175 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkImageRegistrationPyramidCache_h
+#define itkImageRegistrationPyramidCache_h
+
+#include "itkObject.h"
+#include "itkShrinkImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class ImageRegistrationPyramidCache
+ * \brief Cache of the smoothed images and of the shrunk virtual domains of
+ * the levels of a multi-resolution registration.
+ *
+ * At each level, ImageRegistrationMethodv4 smooths the fixed and moving
+ * images and shrinks the virtual domain.  The stages of a multistage
+ * registration, e.g. rigid, affine then SyN, usually have the same images
+ * and the same smoothing sigmas and shrink factors, and therefore compute
+ * the same pyramid again in each stage.  When the stages share a cache,
+ * through ImageRegistrationMethodv4::SetPyramidCache(), each level of the
+ * pyramid is computed once.
+ *
+ * The smoothed images are keyed by the input image, its modification time,
+ * the smoothing sigma, the units of the sigma and the smoothing filter.  The
+ * shrunk virtual domains are keyed by the geometry of the virtual domain and
+ * the shrink factors.  The cache holds the images until Clear() is called,
+ * or until the cache is deleted.
+ *
+ * The cached images are shared by the registration methods, which must not
+ * modify them.
+ *
+ * \sa ImageRegistrationMethodv4
+ *
+ * \ingroup ITKRegistrationMethodsv4
+ */
+template<typename TFixedImage, typename TMovingImage = TFixedImage, typename TVirtualImage = TFixedImage>
+class ImageRegistrationPyramidCache
+:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageRegistrationPyramidCache             Self;
+  typedef Object                                    Superclass;
+  typedef SmartPointer<Self>                        Pointer;
+  typedef SmartPointer<const Self>                  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** ImageDimension constants */
+  itkStaticConstMacro( ImageDimension, unsigned int, TFixedImage::ImageDimension );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ImageRegistrationPyramidCache, Object );
+
+  /** Input typedefs for the images. */
+  typedef TFixedImage                                                 FixedImageType;
+  typedef typename FixedImageType::Pointer                            FixedImagePointer;
+  typedef TMovingImage                                                MovingImageType;
+  typedef typename MovingImageType::Pointer                           MovingImagePointer;
+  typedef TVirtualImage                                               VirtualImageType;
+  typedef typename VirtualImageType::Pointer                          VirtualImagePointer;
+
+  typedef double                                                      RealType;
+
+  typedef ShrinkImageFilter<VirtualImageType, VirtualImageType>       ShrinkFilterType;
+  typedef typename ShrinkFilterType::ShrinkFactorsType                ShrinkFactorsType;
+
+  /** Get the fixed image smoothed with the given sigma, either in physical
+   * units or in voxels, with the \c itkDiscreteGaussianImageFilter or,
+   * if \c useRecursiveGaussian is true, with the
+   * \c itkSmoothingRecursiveGaussianImageFilter. */
+  FixedImagePointer GetSmoothedFixedImage( const FixedImageType *, RealType sigma,
+    bool sigmaIsSpecifiedInPhysicalUnits, bool useRecursiveGaussian );
+
+  /** Get the moving image smoothed with the given sigma. */
+  MovingImagePointer GetSmoothedMovingImage( const MovingImageType *, RealType sigma,
+    bool sigmaIsSpecifiedInPhysicalUnits, bool useRecursiveGaussian );
+
+  /** Get the virtual domain shrunk by the given factors. */
+  VirtualImagePointer GetShrunkVirtualDomainImage( const VirtualImageType *, const ShrinkFactorsType & );
+
+  /** Release all the cached images. */
+  void Clear();
+
+  /** Get the number of images found in the cache. */
+  itkGetConstMacro( NumberOfHits, SizeValueType );
+
+  /** Get the number of images that were computed and added to the cache. */
+  itkGetConstMacro( NumberOfMisses, SizeValueType );
+
+  /** Smooth the image with the given sigma, without caching the result.
+   * A zero sigma always uses the \c itkDiscreteGaussianImageFilter, which
+   * then copies the image.  The \c itkSmoothingRecursiveGaussianImageFilter
+   * costs the same whatever the sigma, whereas the cost of the discrete
+   * Gaussian kernel grows with the sigma, but it needs at least four voxels
+   * along each dimension. */
+  template<typename TImage>
+  static typename TImage::Pointer SmoothImage( const TImage *, RealType sigma,
+    bool sigmaIsSpecifiedInPhysicalUnits, bool useRecursiveGaussian );
+
+  /** Shrink the virtual domain by the given factors, without caching the
+   * result. */
+  static VirtualImagePointer ShrinkVirtualDomainImage( const VirtualImageType *, const ShrinkFactorsType & );
+
+protected:
+  ImageRegistrationPyramidCache();
+  virtual ~ImageRegistrationPyramidCache() {}
+
+  virtual void PrintSelf( std::ostream & os, Indent indent ) const ITK_OVERRIDE;
+
+private:
+  ImageRegistrationPyramidCache( const Self & );   //purposely not implemented
+  void operator=( const Self & );                  //purposely not implemented
+
+  /** A smoothed image and its key.  The input is held so that another
+   * image cannot be allocated at its address. */
+  template<typename TImage>
+  struct SmoothedImageEntry
+    {
+    typename TImage::ConstPointer   Input;
+    ModifiedTimeType                InputTime;
+    RealType                        Sigma;
+    bool                            SigmaIsSpecifiedInPhysicalUnits;
+    bool                            UseRecursiveGaussian;
+    typename TImage::Pointer        Output;
+    };
+
+  /** A shrunk virtual domain and its key. */
+  struct ShrunkImageEntry
+    {
+    typename VirtualImageType::PointType     Origin;
+    typename VirtualImageType::SpacingType   Spacing;
+    typename VirtualImageType::DirectionType Direction;
+    typename VirtualImageType::RegionType    Region;
+    ShrinkFactorsType                        ShrinkFactors;
+    VirtualImagePointer                      Output;
+    };
+
+  template<typename TImage>
+  typename TImage::Pointer GetSmoothedImage( std::vector<SmoothedImageEntry<TImage> > &, const TImage *,
+    RealType, bool, bool );
+
+  std::vector<SmoothedImageEntry<FixedImageType> >   m_FixedImageEntries;
+  std::vector<SmoothedImageEntry<MovingImageType> >  m_MovingImageEntries;
+  std::vector<ShrunkImageEntry>                      m_VirtualDomainImageEntries;
+
+  SizeValueType                                      m_NumberOfHits;
+  SizeValueType                                      m_NumberOfMisses;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageRegistrationPyramidCache.hxx"
+#endif
+
+#endif
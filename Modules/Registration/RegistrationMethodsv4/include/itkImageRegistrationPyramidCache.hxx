@@ -0,0 +1,225 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkImageRegistrationPyramidCache_hxx
+#define itkImageRegistrationPyramidCache_hxx
+
+#include "itkImageRegistrationPyramidCache.h"
+
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+
+namespace itk
+{
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::ImageRegistrationPyramidCache() :
+  m_NumberOfHits( 0 ),
+  m_NumberOfMisses( 0 )
+{
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+typename ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>::FixedImagePointer
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::GetSmoothedFixedImage( const FixedImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits,
+  bool useRecursiveGaussian )
+{
+  return this->GetSmoothedImage( this->m_FixedImageEntries, image, sigma, sigmaIsSpecifiedInPhysicalUnits,
+    useRecursiveGaussian );
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+typename ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>::MovingImagePointer
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::GetSmoothedMovingImage( const MovingImageType * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits,
+  bool useRecursiveGaussian )
+{
+  return this->GetSmoothedImage( this->m_MovingImageEntries, image, sigma, sigmaIsSpecifiedInPhysicalUnits,
+    useRecursiveGaussian );
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+template<typename TImage>
+typename TImage::Pointer
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::GetSmoothedImage( std::vector<SmoothedImageEntry<TImage> > & entries, const TImage * image, RealType sigma,
+  bool sigmaIsSpecifiedInPhysicalUnits, bool useRecursiveGaussian )
+{
+  if( !image )
+    {
+    itkExceptionMacro( "The image to smooth is not present." );
+    }
+
+  for( typename std::vector<SmoothedImageEntry<TImage> >::const_iterator it = entries.begin();
+    it != entries.end(); ++it )
+    {
+    if( it->Input.GetPointer() == image && it->InputTime == image->GetMTime() && it->Sigma == sigma &&
+      it->SigmaIsSpecifiedInPhysicalUnits == sigmaIsSpecifiedInPhysicalUnits &&
+      it->UseRecursiveGaussian == useRecursiveGaussian )
+      {
+      ++this->m_NumberOfHits;
+      return it->Output;
+      }
+    }
+
+  SmoothedImageEntry<TImage> entry;
+  entry.Input = image;
+  entry.InputTime = image->GetMTime();
+  entry.Sigma = sigma;
+  entry.SigmaIsSpecifiedInPhysicalUnits = sigmaIsSpecifiedInPhysicalUnits;
+  entry.UseRecursiveGaussian = useRecursiveGaussian;
+  entry.Output = SmoothImage( image, sigma, sigmaIsSpecifiedInPhysicalUnits, useRecursiveGaussian );
+  entries.push_back( entry );
+  ++this->m_NumberOfMisses;
+
+  return entry.Output;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+template<typename TImage>
+typename TImage::Pointer
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::SmoothImage( const TImage * image, RealType sigma, bool sigmaIsSpecifiedInPhysicalUnits,
+  bool useRecursiveGaussian )
+{
+  typename TImage::Pointer smoothImage;
+
+  if( useRecursiveGaussian && sigma > NumericTraits<RealType>::ZeroValue() )
+    {
+    typedef SmoothingRecursiveGaussianImageFilter<TImage, TImage> SmoothingFilterType;
+    typename SmoothingFilterType::Pointer smoothingFilter = SmoothingFilterType::New();
+
+    // the recursive filter always takes its sigmas in physical units
+    typename SmoothingFilterType::SigmaArrayType sigmas;
+    for( unsigned int d = 0; d < TImage::ImageDimension; d++ )
+      {
+      sigmas[d] = sigmaIsSpecifiedInPhysicalUnits ? sigma : sigma * image->GetSpacing()[d];
+      }
+    smoothingFilter->SetSigmaArray( sigmas );
+    smoothingFilter->SetInput( image );
+
+    smoothImage = smoothingFilter->GetOutput();
+    smoothImage->Update();
+    smoothImage->DisconnectPipeline();
+    }
+  else
+    {
+    typedef DiscreteGaussianImageFilter<TImage, TImage> SmoothingFilterType;
+    typename SmoothingFilterType::Pointer smoothingFilter = SmoothingFilterType::New();
+    if( sigmaIsSpecifiedInPhysicalUnits == true )
+      {
+      smoothingFilter->SetUseImageSpacingOn();
+      }
+    else
+      {
+      smoothingFilter->SetUseImageSpacingOff();
+      }
+    smoothingFilter->SetVariance( vnl_math_sqr( sigma ) );
+    smoothingFilter->SetMaximumError( 0.01 );
+    smoothingFilter->SetInput( image );
+
+    smoothImage = smoothingFilter->GetOutput();
+    smoothImage->Update();
+    smoothImage->DisconnectPipeline();
+    }
+
+  return smoothImage;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+typename ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>::VirtualImagePointer
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::GetShrunkVirtualDomainImage( const VirtualImageType * image, const ShrinkFactorsType & shrinkFactors )
+{
+  if( !image )
+    {
+    itkExceptionMacro( "The virtual domain image is not present." );
+    }
+
+  // The registration methods create a new virtual domain image in each
+  // stage, so the virtual domains are compared by their geometry.
+  for( typename std::vector<ShrunkImageEntry>::const_iterator it = this->m_VirtualDomainImageEntries.begin();
+    it != this->m_VirtualDomainImageEntries.end(); ++it )
+    {
+    if( it->ShrinkFactors == shrinkFactors && it->Region == image->GetLargestPossibleRegion() &&
+      it->Origin == image->GetOrigin() && it->Spacing == image->GetSpacing() &&
+      it->Direction == image->GetDirection() )
+      {
+      ++this->m_NumberOfHits;
+      return it->Output;
+      }
+    }
+
+  ShrunkImageEntry entry;
+  entry.Origin = image->GetOrigin();
+  entry.Spacing = image->GetSpacing();
+  entry.Direction = image->GetDirection();
+  entry.Region = image->GetLargestPossibleRegion();
+  entry.ShrinkFactors = shrinkFactors;
+  entry.Output = ShrinkVirtualDomainImage( image, shrinkFactors );
+  this->m_VirtualDomainImageEntries.push_back( entry );
+  ++this->m_NumberOfMisses;
+
+  return entry.Output;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+typename ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>::VirtualImagePointer
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::ShrinkVirtualDomainImage( const VirtualImageType * image, const ShrinkFactorsType & shrinkFactors )
+{
+  typename ShrinkFilterType::Pointer shrinkFilter = ShrinkFilterType::New();
+  shrinkFilter->SetShrinkFactors( shrinkFactors );
+  shrinkFilter->SetInput( image );
+
+  VirtualImagePointer shrunkImage = shrinkFilter->GetOutput();
+  shrunkImage->Update();
+  shrunkImage->DisconnectPipeline();
+
+  return shrunkImage;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+void
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::Clear()
+{
+  this->m_FixedImageEntries.clear();
+  this->m_MovingImageEntries.clear();
+  this->m_VirtualDomainImageEntries.clear();
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TVirtualImage>
+void
+ImageRegistrationPyramidCache<TFixedImage, TMovingImage, TVirtualImage>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Number of cached fixed images: " << this->m_FixedImageEntries.size() << std::endl;
+  os << indent << "Number of cached moving images: " << this->m_MovingImageEntries.size() << std::endl;
+  os << indent << "Number of cached virtual domain images: " << this->m_VirtualDomainImageEntries.size()
+     << std::endl;
+  os << indent << "Number of hits: " << this->m_NumberOfHits << std::endl;
+  os << indent << "Number of misses: " << this->m_NumberOfMisses << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -21,6 +21,9 @@
 #include "itkImageRegistrationMethodv4.h"
 
 #include "itkDisplacementFieldTransform.h"
+#include "itkTimeProbe.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -55,6 +58,12 @@ namespace itk
  * The method evolved since that time with crucial contributions from Gang Song and
  * Nick Tustison. Though similar in spirit, this implementation is not identical.
  *
+ * The Gaussian smoothing and the scaling of the displacement fields are
+ * separable line passes split over the threads of the filter, and the blend
+ * with the unsmoothed field and the boundary conditions are applied in the
+ * last pass.  The time of each phase of the iterations is measured, see
+ * GetOptimizationPhaseTimeProbe().
+ *
  * \todo Need to allow the fixed image to have a composite transform.
  *
  * \author Nick Tustison
@@ -135,6 +144,17 @@ public:
 
   typedef Array<SizeValueType>                                        NumberOfIterationsArrayType;
 
+  /** The phases of an iteration whose times are measured. */
+  enum OptimizationPhaseType {
+    METRIC_GRADIENT = 0,
+    UPDATE_FIELD_SMOOTHING,
+    UPDATE_FIELD_SCALING,
+    COMPOSITION,
+    TOTAL_FIELD_SMOOTHING,
+    INVERSION,
+    NUMBER_OF_OPTIMIZATION_PHASES
+  };
+
   /** Set/Get the learning rate. */
   itkSetMacro( LearningRate, RealType );
   itkGetConstMacro( LearningRate, RealType );
@@ -186,6 +206,15 @@ public:
   itkSetObjectMacro( FixedToMiddleTransform, OutputTransformType);
   itkSetObjectMacro( MovingToMiddleTransform, OutputTransformType);
 
+  /** Get the time probe of a phase of the iterations.  The probes are reset
+   * at the start of the registration and accumulate over all the levels.
+   * The probe of a phase which is not run by the registration method has
+   * no stops. */
+  const TimeProbe & GetOptimizationPhaseTimeProbe( OptimizationPhaseType phase ) const;
+
+  /** Get the name of a phase of the iterations. */
+  static const char * GetOptimizationPhaseName( OptimizationPhaseType phase );
+
 protected:
   SyNImageRegistrationMethod();
   virtual ~SyNImageRegistrationMethod();
@@ -214,6 +243,20 @@ protected:
   virtual DisplacementFieldPointer GaussianSmoothDisplacementField( const DisplacementFieldType *, const RealType );
   virtual DisplacementFieldPointer InvertDisplacementField( const DisplacementFieldType *, const DisplacementFieldType * = ITK_NULLPTR );
 
+  /** Return a field with the information and the buffered region of the
+   * given field.  The field of a previous iteration is reused when it is no
+   * longer referenced outside of this class, so that the smoothed and the
+   * scaled fields are not allocated at each iteration.  The pixels are not
+   * initialized.
+   *
+   * A field of the pool is considered free as soon as the pool holds the
+   * only reference to it.  The caller must therefore keep the returned
+   * SmartPointer, or hand the field to an object which keeps it (e.g. a
+   * transform), as long as it uses the pixels: a raw pointer does not
+   * prevent the next call from returning, and overwriting, the same field.
+   * The fields of the pool are released at the end of GenerateData(). */
+  DisplacementFieldPointer AllocateDisplacementField( const DisplacementFieldType * );
+
   RealType                                                        m_LearningRate;
 
   OutputTransformPointer                                          m_MovingToMiddleTransform;
@@ -226,12 +269,60 @@ protected:
   bool                                                            m_DownsampleImagesForMetricDerivatives;
   bool                                                            m_AverageMidPointGradients;
 
+  TimeProbe                                                       m_OptimizationPhaseTimeProbes[NUMBER_OF_OPTIMIZATION_PHASES];
+
 private:
   SyNImageRegistrationMethod( const Self & );   //purposely not implemented
   void operator=( const Self & );               //purposely not implemented
 
+  typedef typename DisplacementFieldType::RegionType              RegionType;
+
+  /** Data shared by the threads which smooth or scale a displacement field. */
+  struct FieldThreadStruct
+    {
+    const DisplacementFieldType *  Input;
+    DisplacementFieldType *        Output;
+    const DisplacementFieldType *  Field;
+    RegionType                     Region;
+    unsigned int                   Direction;
+    std::vector<RealType>          Kernel;
+    RealType                       SmoothingWeight;
+    RealType                       Scale;
+    std::vector<RealType>          MaximumNorms;
+    };
+
+  /** Split the region of the structure among the threads, and return
+   * whether the thread has a piece. */
+  static bool GetThreadRegion( const MultiThreader::ThreadInfoStruct *, RegionType & );
+
+  /** Convolve the lines of the region along the direction with the kernel.
+   * The lines are copied with zero flux Neumann boundaries, so that the
+   * input and the output may be the same field.  If the field is set, the
+   * result is blended with it and the boundary is set to zero. */
+  static ITK_THREAD_RETURN_TYPE SmoothingThreaderCallback( void * );
+
+  /** Compute the largest norm, in voxels, of the displacements of each thread. */
+  static ITK_THREAD_RETURN_TYPE MaximumNormThreaderCallback( void * );
+
+  /** Multiply the displacements by the scale. */
+  static ITK_THREAD_RETURN_TYPE ScalingThreaderCallback( void * );
+
+  /** Run the callback on the threads of the filter. */
+  void ExecuteFieldThreads( ThreadFunctionType, FieldThreadStruct & );
+
+  /** Release the buffers kept between the iterations: the metric
+   * derivative, the identity transform of the downsampled metric and the
+   * pool of fields of AllocateDisplacementField(). */
+  void ReleaseIterationBuffers();
+
   RealType                                                        m_GaussianSmoothingVarianceForTheUpdateField;
   RealType                                                        m_GaussianSmoothingVarianceForTheTotalField;
+
+  typedef typename ImageMetricType::DerivativeType                MetricDerivativeType;
+  MetricDerivativeType                                            m_MetricDerivative;
+  DisplacementFieldTransformPointer                               m_IdentityDisplacementFieldTransform;
+
+  std::vector<DisplacementFieldPointer>                           m_DisplacementFieldPool;
 };
 } // end namespace itk
 
@@ -23,11 +23,10 @@
 #include "itkComposeDisplacementFieldsImageFilter.h"
 #include "itkGaussianOperator.h"
 #include "itkImageMaskSpatialObject.h"
+#include "itkImageRegionSplitterSlowDimension.h"
 #include "itkImportImageFilter.h"
 #include "itkInvertDisplacementFieldImageFilter.h"
 #include "itkIterationReporter.h"
-#include "itkMultiplyImageFilter.h"
-#include "itkVectorNeighborhoodOperatorImageFilter.h"
 #include "itkWindowConvergenceMonitoringFunction.h"
 
 namespace itk
@@ -196,11 +195,12 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
 
     if ( this->m_AverageMidPointGradients )
       {
-      ImageRegionIteratorWithIndex<DisplacementFieldType> ItF( fixedToMiddleSmoothUpdateField, fixedToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
-      for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
+      ImageRegionIterator<DisplacementFieldType> ItF( fixedToMiddleSmoothUpdateField, fixedToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
+      ImageRegionIterator<DisplacementFieldType> ItM( movingToMiddleSmoothUpdateField, movingToMiddleSmoothUpdateField->GetLargestPossibleRegion() );
+      for( ItF.GoToBegin(), ItM.GoToBegin(); !ItF.IsAtEnd(); ++ItF, ++ItM )
         {
-        ItF.Set( ItF.Get() - movingToMiddleSmoothUpdateField->GetPixel( ItF.GetIndex() ) );
-        movingToMiddleSmoothUpdateField->SetPixel( ItF.GetIndex(), -ItF.Get() );
+        ItF.Set( ItF.Get() - ItM.Get() );
+        ItM.Set( -ItF.Get() );
         }
       }
 
@@ -208,29 +208,37 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
 
     typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType> ComposerType;
 
+    this->m_OptimizationPhaseTimeProbes[COMPOSITION].Start();
     typename ComposerType::Pointer fixedComposer = ComposerType::New();
     fixedComposer->SetDisplacementField( fixedToMiddleSmoothUpdateField );
     fixedComposer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
+    fixedComposer->SetNumberOfThreads( this->GetNumberOfThreads() );
     fixedComposer->Update();
 
-    DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
-      fixedComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
-
     typename ComposerType::Pointer movingComposer = ComposerType::New();
     movingComposer->SetDisplacementField( movingToMiddleSmoothUpdateField );
     movingComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
+    movingComposer->SetNumberOfThreads( this->GetNumberOfThreads() );
     movingComposer->Update();
+    this->m_OptimizationPhaseTimeProbes[COMPOSITION].Stop();
+
+    this->m_OptimizationPhaseTimeProbes[TOTAL_FIELD_SMOOTHING].Start();
+    DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
+      fixedComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
 
     DisplacementFieldPointer movingToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
       movingComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
+    this->m_OptimizationPhaseTimeProbes[TOTAL_FIELD_SMOOTHING].Stop();
 
     // Iteratively estimate the inverse fields.
 
+    this->m_OptimizationPhaseTimeProbes[INVERSION].Start();
     DisplacementFieldPointer fixedToMiddleSmoothTotalFieldInverse = this->InvertDisplacementField( fixedToMiddleSmoothTotalFieldTmp, this->m_FixedToMiddleTransform->GetInverseDisplacementField() );
     DisplacementFieldPointer fixedToMiddleSmoothTotalField = this->InvertDisplacementField( fixedToMiddleSmoothTotalFieldInverse, fixedToMiddleSmoothTotalFieldTmp );
 
     DisplacementFieldPointer movingToMiddleSmoothTotalFieldInverse = this->InvertDisplacementField( movingToMiddleSmoothTotalFieldTmp, this->m_MovingToMiddleTransform->GetInverseDisplacementField() );
     DisplacementFieldPointer movingToMiddleSmoothTotalField = this->InvertDisplacementField( movingToMiddleSmoothTotalFieldInverse, movingToMiddleSmoothTotalFieldTmp );
+    this->m_OptimizationPhaseTimeProbes[INVERSION].Stop();
 
     // Assign the displacement fields and their inverses to the proper transforms.
     this->m_FixedToMiddleTransform->SetDisplacementField( fixedToMiddleSmoothTotalField );
@@ -259,13 +267,19 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
   const TransformBaseType * fixedTransform, const MovingImagesContainerType movingImages, const PointSetsContainerType movingPointSets,
   const TransformBaseType * movingTransform, const FixedImageMaskType * mask, MeasureType & value )
 {
+  this->m_OptimizationPhaseTimeProbes[METRIC_GRADIENT].Start();
   DisplacementFieldPointer metricGradientField = this->ComputeMetricGradientField(
       fixedImages, fixedPointSets, fixedTransform, movingImages, movingPointSets, movingTransform, mask, value );
+  this->m_OptimizationPhaseTimeProbes[METRIC_GRADIENT].Stop();
 
+  this->m_OptimizationPhaseTimeProbes[UPDATE_FIELD_SMOOTHING].Start();
   DisplacementFieldPointer updateField = this->GaussianSmoothDisplacementField( metricGradientField,
     this->m_GaussianSmoothingVarianceForTheUpdateField );
+  this->m_OptimizationPhaseTimeProbes[UPDATE_FIELD_SMOOTHING].Stop();
 
+  this->m_OptimizationPhaseTimeProbes[UPDATE_FIELD_SCALING].Start();
   DisplacementFieldPointer scaledUpdateField = this->ScaleUpdateField( updateField );
+  this->m_OptimizationPhaseTimeProbes[UPDATE_FIELD_SCALING].Stop();
 
   return scaledUpdateField;
 }
@@ -387,17 +401,32 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
 
   if( this->m_DownsampleImagesForMetricDerivatives && this->m_Metric->GetMetricCategory() != MetricType::POINT_SET_METRIC )
     {
-    const DisplacementVectorType zeroVector( 0.0 );
+    // The identity transform is kept as long as the virtual domain does not
+    // change, i.e. during all the iterations of a level.
+    const DisplacementFieldType * identityField = ITK_NULLPTR;
+    if( this->m_IdentityDisplacementFieldTransform.IsNotNull() )
+      {
+      identityField = this->m_IdentityDisplacementFieldTransform->GetDisplacementField();
+      }
+    if( !identityField ||
+      identityField->GetLargestPossibleRegion() != virtualDomainImage->GetLargestPossibleRegion() ||
+      identityField->GetOrigin() != virtualDomainImage->GetOrigin() ||
+      identityField->GetSpacing() != virtualDomainImage->GetSpacing() ||
+      identityField->GetDirection() != virtualDomainImage->GetDirection() )
+      {
+      const DisplacementVectorType zeroVector( 0.0 );
 
-    typename DisplacementFieldType::Pointer identityField = DisplacementFieldType::New();
-    identityField->CopyInformation( virtualDomainImage );
-    identityField->SetRegions( virtualDomainImage->GetLargestPossibleRegion() );
-    identityField->Allocate();
-    identityField->FillBuffer( zeroVector );
+      typename DisplacementFieldType::Pointer newIdentityField = DisplacementFieldType::New();
+      newIdentityField->CopyInformation( virtualDomainImage );
+      newIdentityField->SetRegions( virtualDomainImage->GetLargestPossibleRegion() );
+      newIdentityField->Allocate();
+      newIdentityField->FillBuffer( zeroVector );
 
-    DisplacementFieldTransformPointer identityDisplacementFieldTransform = DisplacementFieldTransformType::New();
-    identityDisplacementFieldTransform->SetDisplacementField( identityField );
-    identityDisplacementFieldTransform->SetInverseDisplacementField( identityField );
+      this->m_IdentityDisplacementFieldTransform = DisplacementFieldTransformType::New();
+      this->m_IdentityDisplacementFieldTransform->SetDisplacementField( newIdentityField );
+      this->m_IdentityDisplacementFieldTransform->SetInverseDisplacementField( newIdentityField );
+      }
+    DisplacementFieldTransformType * identityDisplacementFieldTransform = this->m_IdentityDisplacementFieldTransform;
 
     if( this->m_Metric->GetMetricCategory() == MetricType::MULTI_METRIC )
       {
@@ -413,9 +442,14 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
 
   this->m_Metric->Initialize();
 
-  typedef typename ImageMetricType::DerivativeType MetricDerivativeType;
+  // The derivative is kept between the iterations, to avoid allocating it
+  // each time.
   const typename MetricDerivativeType::SizeValueType metricDerivativeSize = virtualDomainImage->GetLargestPossibleRegion().GetNumberOfPixels() * ImageDimension;
-  MetricDerivativeType metricDerivative( metricDerivativeSize );
+  MetricDerivativeType & metricDerivative = this->m_MetricDerivative;
+  if( metricDerivative.Size() != metricDerivativeSize )
+    {
+    metricDerivative.SetSize( metricDerivativeSize );
+    }
 
   metricDerivative.Fill( NumericTraits<typename MetricDerivativeType::ValueType>::ZeroValue() );
   this->m_Metric->GetValueAndDerivative( value, metricDerivative );
@@ -443,17 +477,15 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
   gradientField->SetRegions( virtualDomainImage->GetRequestedRegion() );
   gradientField->Allocate();
 
-  ImageRegionIterator<DisplacementFieldType> ItG( gradientField, gradientField->GetRequestedRegion() );
-
-  SizeValueType count = 0;
-  for( ItG.GoToBegin(); !ItG.IsAtEnd(); ++ItG )
+  DisplacementVectorType * gradientBuffer = gradientField->GetBufferPointer();
+  const typename MetricDerivativeType::ValueType * derivativeBuffer = metricDerivative.data_block();
+  const SizeValueType numberOfPixels = gradientField->GetBufferedRegion().GetNumberOfPixels();
+  for( SizeValueType n = 0; n < numberOfPixels; n++ )
     {
-    DisplacementVectorType displacement;
     for( SizeValueType d = 0; d < ImageDimension; d++ )
       {
-      displacement[d] = metricDerivative[count++];
+      gradientBuffer[n][d] = static_cast<RealType>( *derivativeBuffer++ );
       }
-    ItG.Set( displacement );
     }
 
   return gradientField;
@@ -464,25 +496,18 @@ typename SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform,
 SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
 ::ScaleUpdateField( const DisplacementFieldType * updateField )
 {
-  typename DisplacementFieldType::SpacingType spacing = updateField->GetSpacing();
-  ImageRegionConstIterator<DisplacementFieldType> ItF( updateField, updateField->GetLargestPossibleRegion() );
+  FieldThreadStruct str;
+  str.Input = updateField;
+  str.Output = ITK_NULLPTR;
+  str.Field = ITK_NULLPTR;
+  str.Region = updateField->GetBufferedRegion();
+  str.MaximumNorms.assign( this->GetNumberOfThreads(), NumericTraits<RealType>::NonpositiveMin() );
+  this->ExecuteFieldThreads( Self::MaximumNormThreaderCallback, str );
 
   RealType maxNorm = NumericTraits<RealType>::NonpositiveMin();
-  for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
+  for( unsigned int n = 0; n < str.MaximumNorms.size(); n++ )
     {
-    DisplacementVectorType vector = ItF.Get();
-
-    RealType localNorm = 0;
-    for( SizeValueType d = 0; d < ImageDimension; d++ )
-      {
-      localNorm += vnl_math_sqr( vector[d] / spacing[d] );
-      }
-    localNorm = std::sqrt( localNorm );
-
-    if( localNorm > maxNorm )
-      {
-      maxNorm = localNorm;
-      }
+    maxNorm = std::max( maxNorm, str.MaximumNorms[n] );
     }
 
   RealType scale = this->m_LearningRate;
@@ -491,16 +516,11 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
     scale /= maxNorm;
     }
 
-  typedef Image<RealType, ImageDimension> RealImageType;
-
-  typedef MultiplyImageFilter<DisplacementFieldType, RealImageType, DisplacementFieldType> MultiplierType;
-  typename MultiplierType::Pointer multiplier = MultiplierType::New();
-  multiplier->SetInput( updateField );
-  multiplier->SetConstant( scale );
+  DisplacementFieldPointer scaledUpdateField = this->AllocateDisplacementField( updateField );
 
-  typename DisplacementFieldType::Pointer scaledUpdateField = multiplier->GetOutput();
-  scaledUpdateField->Update();
-  scaledUpdateField->DisconnectPipeline();
+  str.Output = scaledUpdateField;
+  str.Scale = scale;
+  this->ExecuteFieldThreads( Self::ScalingThreaderCallback, str );
 
   return scaledUpdateField;
 }
@@ -530,91 +550,319 @@ typename SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform,
 SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
 ::GaussianSmoothDisplacementField( const DisplacementFieldType * field, const RealType variance )
 {
-  typedef ImageDuplicator<DisplacementFieldType> DuplicatorType;
-  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage( field );
-  duplicator->Update();
-
-  DisplacementFieldPointer smoothField = duplicator->GetModifiableOutput();
-
   if( variance <= 0.0 )
     {
+    typedef ImageDuplicator<DisplacementFieldType> DuplicatorType;
+    typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
+    duplicator->SetInputImage( field );
+    duplicator->Update();
+
+    DisplacementFieldPointer smoothField = duplicator->GetModifiableOutput();
     return smoothField;
     }
 
+  const RegionType region = field->GetBufferedRegion();
+
+  DisplacementFieldPointer smoothField = this->AllocateDisplacementField( field );
+
+  //make sure boundary does not move
+  RealType weight1 = 1.0;
+  if( variance < 0.5 )
+    {
+    weight1 = 1.0 - 1.0 * ( variance / 0.5 );
+    }
+
   typedef GaussianOperator<RealType, ImageDimension> GaussianSmoothingOperatorType;
   GaussianSmoothingOperatorType gaussianSmoothingOperator;
 
-  typedef VectorNeighborhoodOperatorImageFilter<DisplacementFieldType, DisplacementFieldType> GaussianSmoothingSmootherType;
-  typename GaussianSmoothingSmootherType::Pointer smoother = GaussianSmoothingSmootherType::New();
+  // The first pass reads the field and the next ones smooth the output in
+  // place.  The last pass also blends the smoothed field with the field.
+  FieldThreadStruct str;
+  str.Output = smoothField;
+  str.SmoothingWeight = weight1;
 
-  for( SizeValueType d = 0; d < ImageDimension; d++ )
+  for( unsigned int d = 0; d < ImageDimension; d++ )
     {
     // smooth along this dimension
     gaussianSmoothingOperator.SetDirection( d );
     gaussianSmoothingOperator.SetVariance( variance );
     gaussianSmoothingOperator.SetMaximumError( 0.001 );
-    gaussianSmoothingOperator.SetMaximumKernelWidth( smoothField->GetRequestedRegion().GetSize()[d] );
+    gaussianSmoothingOperator.SetMaximumKernelWidth( region.GetSize()[d] );
     gaussianSmoothingOperator.CreateDirectional();
 
-    // todo: make sure we only smooth within the buffered region
-    smoother->SetOperator( gaussianSmoothingOperator );
-    smoother->SetInput( smoothField );
-    try
+    str.Kernel.assign( gaussianSmoothingOperator.Begin(), gaussianSmoothingOperator.End() );
+    str.Input = ( d == 0 ) ? field : smoothField.GetPointer();
+    str.Field = ( d == ImageDimension - 1 ) ? field : ITK_NULLPTR;
+    str.Direction = d;
+
+    // the threads process whole lines along the direction
+    str.Region = region;
+    str.Region.SetSize( d, 1 );
+
+    this->ExecuteFieldThreads( Self::SmoothingThreaderCallback, str );
+    }
+
+  return smoothField;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+void
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ExecuteFieldThreads( ThreadFunctionType callback, FieldThreadStruct & str )
+{
+  this->GetMultiThreader()->SetNumberOfThreads( this->GetNumberOfThreads() );
+  this->GetMultiThreader()->SetSingleMethod( callback, &str );
+  this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+bool
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::GetThreadRegion( const MultiThreader::ThreadInfoStruct * info, RegionType & threadRegion )
+{
+  const FieldThreadStruct * str = static_cast<const FieldThreadStruct *>( info->UserData );
+
+  ImageRegionSplitterSlowDimension::Pointer splitter = ImageRegionSplitterSlowDimension::New();
+  const unsigned int numberOfSplits = splitter->GetNumberOfSplits( str->Region, info->NumberOfThreads );
+  if( info->ThreadID >= numberOfSplits )
+    {
+    return false;
+    }
+  threadRegion = str->Region;
+  splitter->GetSplit( info->ThreadID, numberOfSplits, threadRegion );
+  return true;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+ITK_THREAD_RETURN_TYPE
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::SmoothingThreaderCallback( void * arg )
+{
+  const MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const FieldThreadStruct * str = static_cast<const FieldThreadStruct *>( info->UserData );
+
+  RegionType threadRegion;
+  if( !Self::GetThreadRegion( info, threadRegion ) )
+    {
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  const DisplacementFieldType * output = str->Output;
+  const RegionType & region = output->GetBufferedRegion();
+  const unsigned int direction = str->Direction;
+  const SizeValueType length = region.GetSize()[direction];
+  const OffsetValueType stride = output->GetOffsetTable()[direction];
+
+  const SizeValueType kernelSize = str->Kernel.size();
+  const SizeValueType radius = kernelSize / 2;
+  const RealType * kernel = &( str->Kernel[0] );
+
+  const DisplacementVectorType * inputBuffer = str->Input->GetBufferPointer();
+  DisplacementVectorType * outputBuffer = str->Output->GetBufferPointer();
+  const DisplacementVectorType * fieldBuffer = str->Field ? str->Field->GetBufferPointer() : ITK_NULLPTR;
+
+  const RealType weight1 = str->SmoothingWeight;
+  const RealType weight2 = 1.0 - weight1;
+  const DisplacementVectorType zeroVector( 0.0 );
+
+  // the line, padded with copies of its end points
+  std::vector<DisplacementVectorType> line( length + 2 * radius );
+
+  ImageRegionConstIteratorWithIndex<DisplacementFieldType> It( output, threadRegion );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    const typename DisplacementFieldType::IndexType index = It.GetIndex();
+    const OffsetValueType start = output->ComputeOffset( index );
+
+    const DisplacementVectorType * in = inputBuffer + start;
+    for( SizeValueType i = 0; i < length; i++, in += stride )
+      {
+      line[radius + i] = *in;
+      }
+    for( SizeValueType i = 0; i < radius; i++ )
+      {
+      line[i] = line[radius];
+      line[radius + length + i] = line[radius + length - 1];
+      }
+
+    bool isOnBoundary = false;
+    if( fieldBuffer )
       {
-      smoother->Update();
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        if( d != direction && ( index[d] == region.GetIndex()[d] ||
+          index[d] == region.GetIndex()[d] + static_cast<OffsetValueType>( region.GetSize()[d] ) - 1 ) )
+          {
+          isOnBoundary = true;
+          break;
+          }
+        }
       }
-    catch( ExceptionObject & exc )
+
+    DisplacementVectorType * out = outputBuffer + start;
+    for( SizeValueType i = 0; i < length; i++, out += stride )
       {
-      std::string msg( "Caught exception: " );
-      msg += exc.what();
-      itkExceptionMacro( << msg );
+      DisplacementVectorType sum( 0.0 );
+      const DisplacementVectorType * neighbor = &( line[i] );
+      for( SizeValueType k = 0; k < kernelSize; k++ )
+        {
+        for( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          sum[d] += kernel[k] * neighbor[k][d];
+          }
+        }
+      if( fieldBuffer )
+        {
+        if( isOnBoundary || i == 0 || i == length - 1 )
+          {
+          sum = zeroVector;
+          }
+        else
+          {
+          sum = sum * weight1 + fieldBuffer[start + i * stride] * weight2;
+          }
+        }
+      *out = sum;
       }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
 
-    smoothField = smoother->GetOutput();
-    smoothField->Update();
-    smoothField->DisconnectPipeline();
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+ITK_THREAD_RETURN_TYPE
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::MaximumNormThreaderCallback( void * arg )
+{
+  const MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  FieldThreadStruct * str = static_cast<FieldThreadStruct *>( info->UserData );
+
+  RegionType threadRegion;
+  if( !Self::GetThreadRegion( info, threadRegion ) )
+    {
+    return ITK_THREAD_RETURN_VALUE;
     }
 
-  const DisplacementVectorType zeroVector( 0.0 );
+  const typename DisplacementFieldType::SpacingType spacing = str->Input->GetSpacing();
 
-  //make sure boundary does not move
-  RealType weight1 = 1.0;
-  if( variance < 0.5 )
+  RealType maxNorm = NumericTraits<RealType>::NonpositiveMin();
+  ImageRegionConstIterator<DisplacementFieldType> ItF( str->Input, threadRegion );
+  for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
     {
-    weight1 = 1.0 - 1.0 * ( variance / 0.5 );
+    const DisplacementVectorType & vector = ItF.Value();
+
+    RealType localNorm = 0;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      localNorm += vnl_math_sqr( vector[d] / spacing[d] );
+      }
+    maxNorm = std::max( maxNorm, localNorm );
     }
-  RealType weight2 = 1.0 - weight1;
+  if( maxNorm > NumericTraits<RealType>::ZeroValue() )
+    {
+    maxNorm = std::sqrt( maxNorm );
+    }
+  str->MaximumNorms[info->ThreadID] = maxNorm;
+
+  return ITK_THREAD_RETURN_VALUE;
+}
 
-  const typename DisplacementFieldType::RegionType region = field->GetLargestPossibleRegion();
-  const typename DisplacementFieldType::SizeType size = region.GetSize();
-  const typename DisplacementFieldType::IndexType startIndex = region.GetIndex();
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+ITK_THREAD_RETURN_TYPE
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ScalingThreaderCallback( void * arg )
+{
+  const MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const FieldThreadStruct * str = static_cast<const FieldThreadStruct *>( info->UserData );
+
+  RegionType threadRegion;
+  if( !Self::GetThreadRegion( info, threadRegion ) )
+    {
+    return ITK_THREAD_RETURN_VALUE;
+    }
 
-  ImageRegionConstIteratorWithIndex<DisplacementFieldType> ItF( field, field->GetLargestPossibleRegion() );
-  ImageRegionIteratorWithIndex<DisplacementFieldType> ItS( smoothField, smoothField->GetLargestPossibleRegion() );
+  ImageRegionConstIterator<DisplacementFieldType> ItF( str->Input, threadRegion );
+  ImageRegionIterator<DisplacementFieldType> ItS( str->Output, threadRegion );
   for( ItF.GoToBegin(), ItS.GoToBegin(); !ItF.IsAtEnd(); ++ItF, ++ItS )
     {
-    typename DisplacementFieldType::IndexType index = ItF.GetIndex();
-    bool isOnBoundary = false;
-    for ( unsigned int d = 0; d < ImageDimension; d++ )
+    ItS.Set( ItF.Value() * str->Scale );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+typename SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>::DisplacementFieldPointer
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::AllocateDisplacementField( const DisplacementFieldType * field )
+{
+  // A field of the pool referenced only by the pool is free.  The free
+  // fields of another size, e.g. of a previous level, are released.
+  DisplacementFieldPointer allocatedField;
+  typename std::vector<DisplacementFieldPointer>::iterator it = this->m_DisplacementFieldPool.begin();
+  while( it != this->m_DisplacementFieldPool.end() )
+    {
+    if( ( *it )->GetReferenceCount() > 1 )
       {
-      if( index[d] == startIndex[d] || index[d] == static_cast<IndexValueType>( size[d] ) - startIndex[d] - 1 )
-        {
-        isOnBoundary = true;
-        break;
-        }
+      ++it;
       }
-    if( isOnBoundary )
+    else if( allocatedField.IsNull() && ( *it )->GetBufferedRegion() == field->GetBufferedRegion() )
       {
-      ItS.Set( zeroVector );
+      allocatedField = *it;
+      ++it;
       }
     else
       {
-      ItS.Set( ItS.Get() * weight1 + ItF.Get() * weight2 );
+      it = this->m_DisplacementFieldPool.erase( it );
       }
     }
 
-  return smoothField;
+  if( allocatedField.IsNull() )
+    {
+    allocatedField = DisplacementFieldType::New();
+    allocatedField->SetRegions( field->GetBufferedRegion() );
+    allocatedField->Allocate();
+    this->m_DisplacementFieldPool.push_back( allocatedField );
+    }
+  allocatedField->CopyInformation( field );
+
+  return allocatedField;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+const TimeProbe &
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::GetOptimizationPhaseTimeProbe( OptimizationPhaseType phase ) const
+{
+  if( phase >= NUMBER_OF_OPTIMIZATION_PHASES )
+    {
+    itkExceptionMacro( "Invalid optimization phase." );
+    }
+  return this->m_OptimizationPhaseTimeProbes[phase];
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+const char *
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::GetOptimizationPhaseName( OptimizationPhaseType phase )
+{
+  switch( phase )
+    {
+    case METRIC_GRADIENT:
+      return "metric gradient";
+    case UPDATE_FIELD_SMOOTHING:
+      return "update field smoothing";
+    case UPDATE_FIELD_SCALING:
+      return "update field scaling";
+    case COMPOSITION:
+      return "composition";
+    case TOTAL_FIELD_SMOOTHING:
+      return "total field smoothing";
+    case INVERSION:
+      return "inversion";
+    default:
+      return "unknown";
+    }
 }
 
 /*
@@ -627,39 +875,65 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
 {
   this->AllocateOutputs();
 
-  for( this->m_CurrentLevel = 0; this->m_CurrentLevel < this->m_NumberOfLevels; this->m_CurrentLevel++ )
+  for( unsigned int phase = 0; phase < NUMBER_OF_OPTIMIZATION_PHASES; phase++ )
     {
-    this->InitializeRegistrationAtEachLevel( this->m_CurrentLevel );
+    this->m_OptimizationPhaseTimeProbes[phase].Reset();
+    }
 
-    // The base class adds the transform to be optimized at initialization.
-    // However, since this class handles its own optimization, we remove it
-    // to optimize separately.  We then add it after the optimization loop.
+  // The buffers kept between the iterations are released when the
+  // registration ends, even on an exception.
+  try
+    {
+    for( this->m_CurrentLevel = 0; this->m_CurrentLevel < this->m_NumberOfLevels; this->m_CurrentLevel++ )
+      {
+      this->InitializeRegistrationAtEachLevel( this->m_CurrentLevel );
 
-    this->m_CompositeTransform->RemoveTransform();
+      // The base class adds the transform to be optimized at initialization.
+      // However, since this class handles its own optimization, we remove it
+      // to optimize separately.  We then add it after the optimization loop.
 
-    this->StartOptimization();
+      this->m_CompositeTransform->RemoveTransform();
 
-    this->m_CompositeTransform->AddTransform( this->m_OutputTransform );
-    }
+      this->StartOptimization();
+
+      this->m_CompositeTransform->AddTransform( this->m_OutputTransform );
+      }
 
-  typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType, DisplacementFieldType> ComposerType;
+    typedef ComposeDisplacementFieldsImageFilter<DisplacementFieldType, DisplacementFieldType> ComposerType;
 
-  typename ComposerType::Pointer composer = ComposerType::New();
-  composer->SetDisplacementField( this->m_MovingToMiddleTransform->GetInverseDisplacementField() );
-  composer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
-  composer->Update();
+    typename ComposerType::Pointer composer = ComposerType::New();
+    composer->SetDisplacementField( this->m_MovingToMiddleTransform->GetInverseDisplacementField() );
+    composer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
+    composer->Update();
 
-  typename ComposerType::Pointer inverseComposer = ComposerType::New();
-  inverseComposer->SetDisplacementField( this->m_FixedToMiddleTransform->GetInverseDisplacementField() );
-  inverseComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
-  inverseComposer->Update();
+    typename ComposerType::Pointer inverseComposer = ComposerType::New();
+    inverseComposer->SetDisplacementField( this->m_FixedToMiddleTransform->GetInverseDisplacementField() );
+    inverseComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
+    inverseComposer->Update();
 
-  this->m_OutputTransform->SetDisplacementField( composer->GetOutput() );
-  this->m_OutputTransform->SetInverseDisplacementField( inverseComposer->GetOutput() );
+    this->m_OutputTransform->SetDisplacementField( composer->GetOutput() );
+    this->m_OutputTransform->SetInverseDisplacementField( inverseComposer->GetOutput() );
+    }
+  catch( ... )
+    {
+    this->ReleaseIterationBuffers();
+    throw;
+    }
+  this->ReleaseIterationBuffers();
 
   this->GetTransformOutput()->Set(this->m_OutputTransform);
 }
 
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+void
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ReleaseIterationBuffers()
+{
+  this->m_MetricDerivative.SetSize( 0 );
+  this->m_IdentityDisplacementFieldTransform = ITK_NULLPTR;
+  this->m_DisplacementFieldPool.clear();
+}
+
 /*
  * PrintSelf
  */
@@ -676,6 +950,15 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
   os << indent << "Convergence window size: " << this->m_ConvergenceWindowSize << std::endl;
   os << indent << "Gaussian smoothing variance for the update field: " << this->m_GaussianSmoothingVarianceForTheUpdateField << std::endl;
   os << indent << "Gaussian smoothing variance for the total field: " << this->m_GaussianSmoothingVarianceForTheTotalField << std::endl;
+  for( unsigned int phase = 0; phase < NUMBER_OF_OPTIMIZATION_PHASES; phase++ )
+    {
+    if( this->m_OptimizationPhaseTimeProbes[phase].GetNumberOfStops() == 0 )
+      {
+      continue;
+      }
+    os << indent << "Time of the " << Self::GetOptimizationPhaseName( static_cast<OptimizationPhaseType>( phase ) )
+       << ": " << this->m_OptimizationPhaseTimeProbes[phase].GetTotal() << " s" << std::endl;
+    }
 }
 
 } // end namespace itk
@@ -0,0 +1,250 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkMattesMutualInformationImageToImageMetricv4.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkBSplineTransform.h"
+#include "itkAffineTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include <cmath>
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+typedef itk::Image< double, Dimension >                                              ImageType;
+typedef itk::BSplineTransform< double, Dimension, 3 >                                BSplineTransformType;
+typedef itk::AffineTransform< double, Dimension >                                    AffineTransformType;
+typedef itk::ImageRegistrationMethodv4< ImageType, ImageType, BSplineTransformType > RegistrationType;
+typedef itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >                 MeanSquaresMetricType;
+typedef itk::MattesMutualInformationImageToImageMetricv4< ImageType, ImageType >     MattesMetricType;
+
+/** A metric which records whether the B-spline weights were cached at the
+ * last iteration. */
+template< typename TMetric >
+class BSplineWeightsCacheCheckingMetric : public TMetric
+{
+public:
+  typedef BSplineWeightsCacheCheckingMetric Self;
+  typedef TMetric                           Superclass;
+  typedef itk::SmartPointer< Self >         Pointer;
+  typedef itk::SmartPointer< const Self >   ConstPointer;
+
+  itkNewMacro( Self );
+  itkTypeMacro( BSplineWeightsCacheCheckingMetric, TMetric );
+
+  bool GetBSplineWeightsCached() const
+  {
+    return this->m_BSplineWeightsCached;
+  }
+
+protected:
+  BSplineWeightsCacheCheckingMetric() : m_BSplineWeightsCached( false ) {}
+  ~BSplineWeightsCacheCheckingMetric() {}
+
+  virtual void InitializeForIteration() const ITK_OVERRIDE
+  {
+    Superclass::InitializeForIteration();
+    this->m_BSplineWeightsCached = this->m_MovingBSplineTransform != ITK_NULLPTR;
+  }
+
+private:
+  mutable bool m_BSplineWeightsCached;
+};
+
+/** The PDF derivatives of MattesMutualInformationImageToImageMetricv4
+ * are only computed in a second pass, which has its own B-spline Jacobian,
+ * when they are not explicit. */
+void SetUseExplicitPDFDerivatives( MeanSquaresMetricType *, bool )
+{
+}
+
+void SetUseExplicitPDFDerivatives( MattesMetricType *metric, bool useExplicitPDFDerivatives )
+{
+  metric->SetUseExplicitPDFDerivatives( useExplicitPDFDerivatives );
+}
+
+ImageType::Pointer CreateImage( double phase )
+{
+  ImageType::SizeType size;
+  size.Fill( 64 );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double value = 100.0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      value += 30.0 * std::sin( 0.15 * it.GetIndex()[d] + phase * ( d + 1 ) );
+      }
+    it.Set( value );
+    }
+  return image;
+}
+
+/** Registers the images with a B-spline transform applied before an affine
+ * moving initial transform, and returns the parameters of the B-spline
+ * transform. */
+template< typename TMetric >
+BSplineTransformType::ParametersType Register( ImageType *fixedImage, ImageType *movingImage,
+                                               bool useCachingOfBSplineWeights, bool useExplicitPDFDerivatives,
+                                               bool & cached )
+{
+  BSplineTransformType::Pointer transform = BSplineTransformType::New();
+  BSplineTransformType::PhysicalDimensionsType dimensions;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    dimensions[d] = fixedImage->GetSpacing()[d] * ( fixedImage->GetLargestPossibleRegion().GetSize( d ) - 1 );
+    }
+  BSplineTransformType::MeshSizeType meshSize;
+  meshSize.Fill( 4 );
+  transform->SetTransformDomainOrigin( fixedImage->GetOrigin() );
+  transform->SetTransformDomainPhysicalDimensions( dimensions );
+  transform->SetTransformDomainMeshSize( meshSize );
+  transform->SetIdentity();
+
+  AffineTransformType::Pointer affine = AffineTransformType::New();
+  AffineTransformType::InputPointType center;
+  center.Fill( 31.5 );
+  affine->SetCenter( center );
+  affine->Rotate2D( 0.05 );
+  affine->Scale( 1.02 );
+
+  typedef BSplineWeightsCacheCheckingMetric< TMetric > MetricType;
+  typename MetricType::Pointer metric = MetricType::New();
+  metric->SetUseCachingOfBSplineWeights( useCachingOfBSplineWeights );
+  SetUseExplicitPDFDerivatives( metric.GetPointer(), useExplicitPDFDerivatives );
+
+  typedef itk::GradientDescentOptimizerv4 OptimizerType;
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  optimizer->SetLearningRate( 1.0e-4 );
+  optimizer->SetNumberOfIterations( 10 );
+  optimizer->SetDoEstimateLearningRateOnce( false );
+  optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetMetric( metric );
+  registration->SetOptimizer( optimizer );
+  registration->SetInitialTransform( transform );
+  registration->InPlaceOn();
+  registration->SetMovingInitialTransform( affine );
+
+  RegistrationType::ShrinkFactorsArrayType shrinkFactors( 1 );
+  shrinkFactors.Fill( 1 );
+  RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 1 );
+  smoothingSigmas.Fill( 0 );
+  registration->SetNumberOfLevels( 1 );
+  registration->SetShrinkFactorsPerLevel( shrinkFactors );
+  registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+
+  registration->Update();
+  cached = metric->GetBSplineWeightsCached();
+  return transform->GetParameters();
+}
+
+/** Registers the images with and without the cache, with explicit and
+ * implicit PDF derivatives, and checks that the parameters are the ones
+ * of the registration with the dense Jacobian of the composite transform,
+ * i.e. without the cache and with explicit PDF derivatives. */
+template< typename TMetric >
+bool CheckRegistration( const char *name, ImageType *fixedImage, ImageType *movingImage )
+{
+  bool                                 cached = false;
+  BSplineTransformType::ParametersType parameters = Register< TMetric >( fixedImage, movingImage, false, true, cached );
+  if( cached )
+    {
+    std::cerr << name << ": the B-spline weights should be cached only when asked to" << std::endl;
+    return false;
+    }
+  double maximum = 0.0;
+  for( unsigned int p = 0; p < parameters.Size(); ++p )
+    {
+    maximum = std::max( maximum, std::abs( parameters[p] ) );
+    }
+  if( maximum == 0.0 )
+    {
+    std::cerr << name << ": the registration did not change the parameters" << std::endl;
+    return false;
+    }
+
+  for( unsigned int v = 1; v < 4; ++v )
+    {
+    const bool useCachingOfBSplineWeights = v & 1;
+    const bool useExplicitPDFDerivatives = v < 2;
+    BSplineTransformType::ParametersType otherParameters =
+      Register< TMetric >( fixedImage, movingImage, useCachingOfBSplineWeights, useExplicitPDFDerivatives, cached );
+    if( cached != useCachingOfBSplineWeights )
+      {
+      std::cerr << name << ": the B-spline weights should be cached within the composite transform of the"
+                << " registration method only when asked to" << std::endl;
+      return false;
+      }
+    for( unsigned int p = 0; p < parameters.Size(); ++p )
+      {
+      // the threads of the metric add their contributions in any order
+      if( std::abs( otherParameters[p] - parameters[p] ) > 1.0e-6 * maximum )
+        {
+        std::cerr << name << ": the parameter " << p << " is " << otherParameters[p]
+                  << ( useCachingOfBSplineWeights ? " with" : " without" ) << " the cache and with "
+                  << ( useExplicitPDFDerivatives ? "explicit" : "implicit" ) << " PDF derivatives instead of "
+                  << parameters[p] << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+}
+
+/** Registers two images with a B-spline transform and an affine moving
+ * initial transform, which ImageRegistrationMethodv4 composes in a
+ * CompositeTransform, and checks that the metrics cache the B-spline
+ * weights and compute the sparse Jacobian of the B-spline transform with
+ * the same result as the dense Jacobian of the composite transform. */
+int itkImageRegistrationMethodv4BSplineWeightsCacheTest( int, char* [] )
+{
+  ImageType::Pointer fixedImage = CreateImage( 0.0 );
+  ImageType::Pointer movingImage = CreateImage( 0.2 );
+
+  bool passed = true;
+  try
+    {
+    passed &= CheckRegistration< MeanSquaresMetricType >( "MeanSquares", fixedImage, movingImage );
+    passed &= CheckRegistration< MattesMetricType >( "MattesMutualInformation", fixedImage, movingImage );
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    passed = false;
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkRegularStepGradientDescentOptimizerv4.h"
+#include "itkTranslationTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include <cmath>
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+typedef itk::Image< float, Dimension >                                              ImageType;
+typedef itk::TranslationTransform< double, Dimension >                              TransformType;
+typedef itk::ImageRegistrationMethodv4< ImageType, ImageType, TransformType >       RegistrationType;
+typedef RegistrationType::ImageMetricType                                           ImageMetricType;
+
+/** A few blobs on a flat background, shifted by the given offset. */
+ImageType::Pointer CreateImage( const double offset[Dimension] )
+{
+  ImageType::SizeType size;
+  size.Fill( 80 );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  const double centers[4][Dimension] = { { 25.0, 30.0 }, { 50.0, 22.0 }, { 40.0, 55.0 }, { 58.0, 48.0 } };
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    image->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    double value = 10.0;
+    for( unsigned int b = 0; b < 4; ++b )
+      {
+      double squaredDistance = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        const double x = point[d] - centers[b][d] - offset[d];
+        squaredDistance += x * x;
+        }
+      value += ( 50.0 + 20.0 * b ) * std::exp( -squaredDistance / ( 2.0 * ( 16.0 + 9.0 * b ) ) );
+      }
+    it.Set( static_cast< ImageType::PixelType >( value ) );
+    }
+  return image;
+}
+
+/** Registers the images with the given sampling strategy and optimizer,
+ * and checks that the translation is recovered. */
+bool CheckStrategy( const char *name, RegistrationType::MetricSamplingStrategyType strategy, bool resample,
+                    bool regularStep, ImageType *fixedImage, ImageType *movingImage,
+                    const double offset[Dimension],
+                    ImageMetricType::FixedSampledPointSetType::PointType & lastSample )
+{
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+
+  RegistrationType::ShrinkFactorsArrayType shrinkFactors( 1 );
+  shrinkFactors[0] = 1;
+  RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 1 );
+  smoothingSigmas[0] = 0;
+  registration->SetNumberOfLevels( 1 );
+  registration->SetShrinkFactorsPerLevel( shrinkFactors );
+  registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+
+  RegistrationType::MetricSamplingPercentageArrayType samplingPercentage( 1 );
+  samplingPercentage[0] = 0.05;
+  registration->SetMetricSamplingStrategy( strategy );
+  registration->SetMetricSamplingPercentagePerLevel( samplingPercentage );
+  registration->SetResampleMetricSamplePointsEachIteration( resample );
+
+  // the regular step optimizer compares the gradients of successive
+  // iterations, so the samples are drawn once with it
+  typedef itk::RegularStepGradientDescentOptimizerv4< double > RegularStepOptimizerType;
+  typedef itk::GradientDescentOptimizerv4                      GradientDescentOptimizerType;
+  GradientDescentOptimizerType::Pointer optimizer;
+  if( regularStep )
+    {
+    RegularStepOptimizerType::Pointer regularStepOptimizer = RegularStepOptimizerType::New();
+    regularStepOptimizer->SetLearningRate( 2.0 );
+    regularStepOptimizer->SetRelaxationFactor( 0.7 );
+    regularStepOptimizer->SetMinimumStepLength( 0.01 );
+    optimizer = regularStepOptimizer;
+    }
+  else
+    {
+    optimizer = GradientDescentOptimizerType::New();
+    optimizer->SetLearningRate( 1.0 );
+    optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+    optimizer->SetDoEstimateLearningRateOnce( false );
+    }
+  optimizer->SetNumberOfIterations( 200 );
+  registration->SetOptimizer( optimizer );
+
+  try
+    {
+    registration->Update();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << name << ": " << e << std::endl;
+    return false;
+    }
+
+  const ImageMetricType *metric = dynamic_cast< const ImageMetricType * >( registration->GetMetric() );
+  const ImageMetricType::FixedSampledPointSetType *samples = metric->GetFixedSampledPointSet();
+  lastSample = samples->GetPoint( 0 );
+
+  const TransformType::ParametersType parameters = registration->GetOutput()->Get()->GetParameters();
+  std::cout << name << ( regularStep ? " with regular steps" : "" )
+            << ( resample ? " resampled each iteration" : "" ) << ": " << samples->GetNumberOfPoints()
+            << " samples, " << optimizer->GetCurrentIteration() << " iterations, translation " << parameters
+            << std::endl;
+
+  // the samples cover 5% of the virtual domain
+  const double numberOfVoxels = fixedImage->GetLargestPossibleRegion().GetNumberOfPixels();
+  if( !( samples->GetNumberOfPoints() >= 0.04 * numberOfVoxels
+         && samples->GetNumberOfPoints() <= 0.06 * numberOfVoxels ) )
+    {
+    std::cerr << name << ": wrong number of samples" << std::endl;
+    return false;
+    }
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    if( !( std::abs( parameters[d] - offset[d] ) < 0.25 ) )
+      {
+      std::cerr << name << ": the translation is " << parameters << " instead of " << offset[0] << ", "
+                << offset[1] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+/** Registers two translated images with each metric sampling strategy, with
+ * and without new samples at each iteration, with a plain gradient descent,
+ * and checks that the samples are drawn once per level with a regular step
+ * gradient descent. */
+int itkImageRegistrationMethodv4SamplingStrategiesTest( int, char* [] )
+{
+  const double noOffset[Dimension] = { 0.0, 0.0 };
+  const double offset[Dimension] = { 3.5, -2.25 };
+  ImageType::Pointer fixedImage = CreateImage( noOffset );
+  ImageType::Pointer movingImage = CreateImage( offset );
+
+  const RegistrationType::MetricSamplingStrategyType strategies[] =
+    { RegistrationType::REGULAR, RegistrationType::RANDOM, RegistrationType::LOW_DISCREPANCY,
+      RegistrationType::GRADIENT_WEIGHTED };
+  const char * names[] = { "REGULAR", "RANDOM", "LOW_DISCREPANCY", "GRADIENT_WEIGHTED" };
+
+  bool passed = true;
+  for( unsigned int s = 0; s < 4; ++s )
+    {
+    ImageMetricType::FixedSampledPointSetType::PointType lastSamples[2];
+    for( unsigned int resample = 0; resample < 2; ++resample )
+      {
+      passed &= CheckStrategy( names[s], strategies[s], resample, false, fixedImage, movingImage, offset,
+                               lastSamples[resample] );
+      }
+    // the samples of the last iteration are new ones
+    if( lastSamples[0] == lastSamples[1] )
+      {
+      std::cerr << names[s] << ": the samples are not drawn again at each iteration" << std::endl;
+      passed = false;
+      }
+
+    if( strategies[s] != RegistrationType::REGULAR )
+      {
+      continue;
+      }
+    for( unsigned int resample = 0; resample < 2; ++resample )
+      {
+      passed &= CheckStrategy( names[s], strategies[s], resample, true, fixedImage, movingImage, offset,
+                               lastSamples[resample] );
+      }
+    if( lastSamples[0] != lastSamples[1] )
+      {
+      std::cerr << names[s] << ": the samples are drawn again with a regular step gradient descent" << std::endl;
+      passed = false;
+      }
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkImageRegistrationPyramidCache.h"
+#include "itkRegularStepGradientDescentOptimizerv4.h"
+#include "itkTranslationTransform.h"
+#include "itkImageDuplicator.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include <cmath>
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+typedef itk::Image< float, Dimension >                                              ImageType;
+typedef itk::TranslationTransform< double, Dimension >                              TransformType;
+typedef itk::ImageRegistrationMethodv4< ImageType, ImageType, TransformType >       RegistrationType;
+typedef RegistrationType::PyramidCacheType                                          PyramidCacheType;
+
+/** Registers the images in three levels, and returns the translation. */
+TransformType::ParametersType Register( ImageType *fixedImage, ImageType *movingImage, PyramidCacheType *cache,
+                                        bool recursive )
+{
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetPyramidCache( cache );
+  registration->SetUseRecursiveGaussianSmoothing( recursive );
+
+  RegistrationType::ShrinkFactorsArrayType shrinkFactors( 3 );
+  shrinkFactors[0] = 4;
+  shrinkFactors[1] = 2;
+  shrinkFactors[2] = 1;
+  RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 3 );
+  smoothingSigmas[0] = 2;
+  smoothingSigmas[1] = 1;
+  smoothingSigmas[2] = 0;
+  registration->SetNumberOfLevels( 3 );
+  registration->SetShrinkFactorsPerLevel( shrinkFactors );
+  registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+  registration->SetSmoothingSigmasAreSpecifiedInPhysicalUnits( false );
+
+  typedef itk::RegularStepGradientDescentOptimizerv4< double > OptimizerType;
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  optimizer->SetLearningRate( 2.0 );
+  optimizer->SetRelaxationFactor( 0.7 );
+  optimizer->SetMinimumStepLength( 0.01 );
+  optimizer->SetNumberOfIterations( 50 );
+  registration->SetOptimizer( optimizer );
+
+  registration->Update();
+  return registration->GetOutput()->Get()->GetParameters();
+}
+
+/** Returns the mean absolute difference between the two images, away from
+ * the borders. */
+double CompareImages( const ImageType *image, const ImageType *reference, unsigned int margin )
+{
+  ImageType::RegionType region = reference->GetLargestPossibleRegion();
+  region.ShrinkByRadius( margin );
+  double sumOfDifferences = 0.0;
+  itk::ImageRegionConstIterator< ImageType > it( image, region );
+  itk::ImageRegionConstIterator< ImageType > rit( reference, region );
+  for( ; !rit.IsAtEnd(); ++it, ++rit )
+    {
+    sumOfDifferences += std::abs( static_cast< double >( it.Get() ) - rit.Get() );
+    }
+  return sumOfDifferences / region.GetNumberOfPixels();
+}
+
+}
+
+/** Registers the input image with a copy of it translated by its origin.
+ * Checks that two registration stages which share a pyramid cache compute
+ * each level once and give the same result as without the cache, and that
+ * the recursive Gaussian smoothing is close to the discrete Gaussian. */
+int itkImageRegistrationPyramidCacheTest( int argc, char * argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " inputImage" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  try
+    {
+    reader->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::Pointer fixedImage = reader->GetOutput();
+
+  // the moving image is the fixed image translated by offset voxels
+  const double offset[Dimension] = { 3.5, -2.25 };
+  typedef itk::ImageDuplicator< ImageType > DuplicatorType;
+  DuplicatorType::Pointer duplicator = DuplicatorType::New();
+  duplicator->SetInputImage( fixedImage );
+  duplicator->Update();
+  ImageType::Pointer movingImage = duplicator->GetModifiableOutput();
+  ImageType::PointType origin = fixedImage->GetOrigin();
+  double physicalOffset[Dimension];
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    physicalOffset[d] = offset[d] * fixedImage->GetSpacing()[d];
+    origin[d] += physicalOffset[d];
+    }
+  movingImage->SetOrigin( origin );
+
+  bool passed = true;
+
+  const TransformType::ParametersType reference = Register( fixedImage, movingImage, ITK_NULLPTR, false );
+
+  PyramidCacheType::Pointer cache = PyramidCacheType::New();
+  for( unsigned int stage = 0; stage < 2; ++stage )
+    {
+    const TransformType::ParametersType parameters = Register( fixedImage, movingImage, cache, false );
+    // the threads of the metric add their contributions in any order
+    if( !( std::abs( parameters[0] - reference[0] ) < 1e-6 && std::abs( parameters[1] - reference[1] ) < 1e-6 ) )
+      {
+      std::cerr << "the translation is " << parameters << " with the cache instead of " << reference << std::endl;
+      passed = false;
+      }
+    // three smoothed fixed images, moving images and virtual domains
+    if( cache->GetNumberOfMisses() != 9 || cache->GetNumberOfHits() != 9 * stage )
+      {
+      std::cerr << "stage " << stage << ": " << cache->GetNumberOfHits() << " hits and "
+                << cache->GetNumberOfMisses() << " misses instead of " << 9 * stage << " and 9" << std::endl;
+      passed = false;
+      }
+    }
+
+  // a modified image is smoothed again
+  movingImage->Modified();
+  Register( fixedImage, movingImage, cache, false );
+  if( cache->GetNumberOfMisses() != 12 || cache->GetNumberOfHits() != 15 )
+    {
+    std::cerr << "the modified moving image is not smoothed again" << std::endl;
+    passed = false;
+    }
+  cache->Clear();
+  cache->Print( std::cout );
+
+  // recursive Gaussian smoothing
+  const TransformType::ParametersType recursiveParameters = Register( fixedImage, movingImage, cache, true );
+  std::cout << "translation " << reference << " with the discrete Gaussian, " << recursiveParameters
+            << " with the recursive Gaussian" << std::endl;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    const double tolerance = 0.25 * fixedImage->GetSpacing()[d];
+    if( !( std::abs( recursiveParameters[d] - physicalOffset[d] ) < tolerance
+           && std::abs( reference[d] - physicalOffset[d] ) < tolerance ) )
+      {
+      std::cerr << "the translation is not recovered" << std::endl;
+      passed = false;
+      }
+    }
+
+  // the sigmas stay below the largest kernel of the discrete Gaussian
+  double range = 0.0;
+  for( itk::ImageRegionConstIterator< ImageType > it( fixedImage, fixedImage->GetLargestPossibleRegion() );
+       !it.IsAtEnd(); ++it )
+    {
+    range = std::max( range, static_cast< double >( it.Get() ) );
+    }
+  const double sigmas[] = { 1.0, 4.0, 0.5 };
+  const bool   physicalUnits[] = { false, false, true };
+  for( unsigned int s = 0; s < 3; ++s )
+    {
+    ImageType::Pointer discrete =
+      PyramidCacheType::SmoothImage( fixedImage.GetPointer(), sigmas[s], physicalUnits[s], false );
+    ImageType::Pointer recursive =
+      PyramidCacheType::SmoothImage( fixedImage.GetPointer(), sigmas[s], physicalUnits[s], true );
+    const double meanDifference = CompareImages( recursive, discrete, 16 );
+    std::cout << "sigma " << sigmas[s] << ( physicalUnits[s] ? " in physical units" : " in voxels" )
+              << ": mean difference " << meanDifference << std::endl;
+    if( !( meanDifference < 0.005 * range ) )
+      {
+      std::cerr << "the recursive Gaussian differs from the discrete Gaussian" << std::endl;
+      passed = false;
+      }
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
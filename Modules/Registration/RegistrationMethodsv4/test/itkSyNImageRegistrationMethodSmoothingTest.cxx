@@ -0,0 +1,289 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSyNImageRegistrationMethod.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkVectorNeighborhoodOperatorImageFilter.h"
+#include "itkGaussianOperator.h"
+#include "itkImageDuplicator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <cmath>
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+typedef itk::Image< float, Dimension >                                   ImageType;
+typedef itk::SyNImageRegistrationMethod< ImageType, ImageType >          RegistrationType;
+typedef RegistrationType::DisplacementFieldType                          DisplacementFieldType;
+typedef RegistrationType::DisplacementFieldPointer                       DisplacementFieldPointer;
+typedef RegistrationType::RealType                                       RealType;
+
+/** Gives access to the smoothing and the scaling of the displacement fields. */
+class SmoothingSyNImageRegistrationMethod : public RegistrationType
+{
+public:
+  typedef SmoothingSyNImageRegistrationMethod Self;
+  typedef RegistrationType                    Superclass;
+  typedef itk::SmartPointer< Self >           Pointer;
+
+  itkNewMacro( Self );
+
+  DisplacementFieldPointer Smooth( const DisplacementFieldType *field, RealType variance )
+  {
+    return this->GaussianSmoothDisplacementField( field, variance );
+  }
+
+  DisplacementFieldPointer Scale( const DisplacementFieldType *field )
+  {
+    return this->ScaleUpdateField( field );
+  }
+};
+
+/** Smooths the field with a neighborhood operator filter along each
+ * dimension, then blends the result with the field and sets the boundary to
+ * zero. */
+DisplacementFieldPointer ReferenceSmooth( const DisplacementFieldType *field, RealType variance )
+{
+  typedef itk::ImageDuplicator< DisplacementFieldType > DuplicatorType;
+  DuplicatorType::Pointer duplicator = DuplicatorType::New();
+  duplicator->SetInputImage( field );
+  duplicator->Update();
+  DisplacementFieldPointer smoothField = duplicator->GetModifiableOutput();
+
+  typedef itk::GaussianOperator< RealType, Dimension > OperatorType;
+  typedef itk::VectorNeighborhoodOperatorImageFilter< DisplacementFieldType, DisplacementFieldType > SmootherType;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    OperatorType gaussian;
+    gaussian.SetDirection( d );
+    gaussian.SetVariance( variance );
+    gaussian.SetMaximumError( 0.001 );
+    gaussian.SetMaximumKernelWidth( field->GetLargestPossibleRegion().GetSize()[d] );
+    gaussian.CreateDirectional();
+
+    SmootherType::Pointer smoother = SmootherType::New();
+    smoother->SetOperator( gaussian );
+    smoother->SetInput( smoothField );
+    smoother->Update();
+    smoothField = smoother->GetOutput();
+    smoothField->DisconnectPipeline();
+    }
+
+  const RealType weight1 = variance < 0.5 ? 1.0 - variance / 0.5 : 1.0;
+  const DisplacementFieldType::RegionType region = field->GetLargestPossibleRegion();
+  itk::ImageRegionIteratorWithIndex< DisplacementFieldType > it( smoothField, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const DisplacementFieldType::IndexType index = it.GetIndex();
+    bool isOnBoundary = false;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      if( index[d] == region.GetIndex()[d]
+          || index[d] == region.GetIndex()[d] + static_cast< itk::IndexValueType >( region.GetSize()[d] ) - 1 )
+        {
+        isOnBoundary = true;
+        }
+      }
+    if( isOnBoundary )
+      {
+      it.Set( DisplacementFieldType::PixelType( 0.0 ) );
+      }
+    else
+      {
+      it.Set( it.Get() * weight1 + field->GetPixel( index ) * ( 1.0 - weight1 ) );
+      }
+    }
+  return smoothField;
+}
+
+/** Returns the largest difference between the components of the fields. */
+double CompareFields( const DisplacementFieldType *field, const DisplacementFieldType *reference )
+{
+  if( field->GetLargestPossibleRegion() != reference->GetLargestPossibleRegion() )
+    {
+    return itk::NumericTraits< double >::max();
+    }
+  double maxDifference = 0.0;
+  itk::ImageRegionConstIteratorWithIndex< DisplacementFieldType > it( reference,
+    reference->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      maxDifference = std::max( maxDifference, std::abs( field->GetPixel( it.GetIndex() )[d] - it.Get()[d] ) );
+      }
+    }
+  return maxDifference;
+}
+
+ImageType::Pointer CreateImage( unsigned int size, double phase )
+{
+  ImageType::SizeType imageSize;
+  imageSize.Fill( size );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( imageSize );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double value = 100.0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      value += 30.0 * std::sin( 0.3 * it.GetIndex()[d] + phase * ( d + 1 ) );
+      }
+    it.Set( static_cast< ImageType::PixelType >( value ) );
+    }
+  return image;
+}
+
+}
+
+/** Checks that the threaded smoothing and scaling of the displacement fields
+ * of SyNImageRegistrationMethod give the same fields as the neighborhood
+ * operator filters, and that the times of the phases of the iterations are
+ * measured. */
+int itkSyNImageRegistrationMethodSmoothingTest( int, char* [] )
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  DisplacementFieldType::SizeType size;
+  size[0] = 23;
+  size[1] = 17;
+  size[2] = 11;
+  DisplacementFieldType::IndexType start;
+  start[0] = 3;
+  start[1] = -2;
+  start[2] = 0;
+  DisplacementFieldType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 0.5;
+  spacing[2] = 2.0;
+  DisplacementFieldType::RegionType region( start, size );
+  DisplacementFieldPointer field = DisplacementFieldType::New();
+  field->SetRegions( region );
+  field->SetSpacing( spacing );
+  field->Allocate();
+  itk::ImageRegionIteratorWithIndex< DisplacementFieldType > it( field, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    DisplacementFieldType::PixelType displacement;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      displacement[d] = generator->GetUniformVariate( -2.0, 2.0 );
+      }
+    it.Set( displacement );
+    }
+
+  bool passed = true;
+
+  // the largest variance truncates the kernels to the size of the field,
+  // which the Gaussian operator warns about
+  itk::Object::GlobalWarningDisplayOff();
+  const RealType variances[] = { 0.0, 0.25, 0.5, 3.0, 40.0 };
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 3, 8 };
+  for( unsigned int t = 0; t < 3; ++t )
+    {
+    SmoothingSyNImageRegistrationMethod::Pointer registration = SmoothingSyNImageRegistrationMethod::New();
+    registration->SetNumberOfThreads( numbersOfThreads[t] );
+    for( unsigned int v = 0; v < 5; ++v )
+      {
+      DisplacementFieldPointer smoothField = registration->Smooth( field, variances[v] );
+      DisplacementFieldPointer reference = variances[v] > 0.0 ? ReferenceSmooth( field, variances[v] ) : field;
+      const double difference = CompareFields( smoothField, reference );
+      std::cout << numbersOfThreads[t] << " threads, variance " << variances[v] << ": difference " << difference
+                << std::endl;
+      if( !( difference < 1e-12 ) )
+        {
+        std::cerr << "the smoothed field differs from the reference" << std::endl;
+        passed = false;
+        }
+      }
+
+    registration->SetLearningRate( 0.5 );
+    DisplacementFieldPointer scaledField = registration->Scale( field );
+    double maxNorm = 0.0;
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      double norm = 0.0;
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        norm += vnl_math_sqr( it.Get()[d] / spacing[d] );
+        }
+      maxNorm = std::max( maxNorm, std::sqrt( norm ) );
+      }
+    DisplacementFieldPointer reference = DisplacementFieldType::New();
+    reference->SetRegions( region );
+    reference->Allocate();
+    itk::ImageRegionIteratorWithIndex< DisplacementFieldType > rit( reference, region );
+    for( it.GoToBegin(), rit.GoToBegin(); !it.IsAtEnd(); ++it, ++rit )
+      {
+      rit.Set( it.Get() * ( 0.5 / maxNorm ) );
+      }
+    if( !( CompareFields( scaledField, reference ) < 1e-12 ) || scaledField->GetSpacing() != spacing )
+      {
+      std::cerr << numbersOfThreads[t] << " threads: the scaled field differs from the reference" << std::endl;
+      passed = false;
+      }
+    }
+
+  // a short registration, whose phases are all timed
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( CreateImage( 32, 0.0 ) );
+  registration->SetMovingImage( CreateImage( 32, 0.3 ) );
+  registration->SetMetric( itk::MeanSquaresImageToImageMetricv4< ImageType, ImageType >::New() );
+  registration->SetNumberOfLevels( 1 );
+  RegistrationType::ShrinkFactorsArrayType shrinkFactors( 1 );
+  shrinkFactors[0] = 1;
+  registration->SetShrinkFactorsPerLevel( shrinkFactors );
+  RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 1 );
+  smoothingSigmas[0] = 0;
+  registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+  RegistrationType::NumberOfIterationsArrayType numberOfIterations( 1 );
+  numberOfIterations[0] = 5;
+  registration->SetNumberOfIterationsPerLevel( numberOfIterations );
+  registration->SetConvergenceThreshold( -1.0 );
+  registration->Update();
+
+  const itk::SizeValueType iterationsPerPhase[] = { 10, 10, 10, 5, 5, 5 };
+  for( unsigned int phase = 0; phase < RegistrationType::NUMBER_OF_OPTIMIZATION_PHASES; ++phase )
+    {
+    const RegistrationType::OptimizationPhaseType optimizationPhase =
+      static_cast< RegistrationType::OptimizationPhaseType >( phase );
+    const itk::TimeProbe & probe = registration->GetOptimizationPhaseTimeProbe( optimizationPhase );
+    if( !( probe.GetNumberOfStops() > 0 ) || probe.GetNumberOfStops() != probe.GetNumberOfStarts()
+        || probe.GetNumberOfStarts() != iterationsPerPhase[phase] )
+      {
+      std::cerr << RegistrationType::GetOptimizationPhaseName( optimizationPhase ) << ": the phase was timed "
+                << probe.GetNumberOfStops() << " times instead of " << iterationsPerPhase[phase] << std::endl;
+      passed = false;
+      }
+    }
+  registration->Print( std::cout );
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -24,6 +24,7 @@
 #include <map>
 #include "itkProgressReporter.h"
 #include "itkBarrier.h"
+#include "itkAtomicInt.h"
 
 namespace itk
 {
@@ -45,9 +46,15 @@ namespace itk
  *
  * After the filter is executed, ObjectCount holds the number of connected components.
  *
+ * All the steps of the algorithm run in parallel: each thread encodes and
+ * labels the lines of its region, then the equivalences between the runs
+ * are recorded in a union-find structure which is updated with atomic
+ * compare-and-swap operations, so that the threads can link their labels
+ * to the ones of the neighbor regions concurrently. The output does not
+ * depend on the number of threads.
+ *
  * \sa ImageToImageFilter
  *
- * \ingroup SingleThreaded
  * \ingroup ITKConnectedComponents
  *
  * \wiki
@@ -168,9 +175,13 @@ protected:
     m_FullyConnected = false;
     m_ObjectCount = 0;
     m_BackgroundValue = NumericTraits< OutputImagePixelType >::ZeroValue();
+    m_UnionFind = ITK_NULLPTR;
   }
 
-  virtual ~ConnectedComponentImageFilter() {}
+  virtual ~ConnectedComponentImageFilter()
+  {
+    this->ClearUnion();
+  }
   void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
   /**
@@ -222,15 +233,28 @@ public:
 
   typedef std::vector< typename TInputImage::OffsetValueType > OffsetVec;
 
-  // the types to support union-find operations
-  typedef std::vector< LabelType > UnionFindType;
-  UnionFindType m_UnionFind;
-  UnionFindType m_Consecutive;
+  // the types to support union-find operations. The sets are linked
+  // concurrently by the threads, so the parents are atomic. They are
+  // stored in a plain array: a std::vector would copy construct each
+  // element, which costs a memory fence per label.
+  typedef AtomicInt< LabelType >   UnionFindElementType;
+  typedef std::vector< LabelType > ConsecutiveType;
+  UnionFindElementType *m_UnionFind;
+  ConsecutiveType       m_Consecutive;
 
   // functions to support union-find operations
   void InitUnion( SizeValueType size )
   {
-    m_UnionFind = UnionFindType(size + 1);
+    this->ClearUnion();
+    m_UnionFind = new UnionFindElementType[size + 1];
+    m_Consecutive = ConsecutiveType(size + 1);
+  }
+
+  void ClearUnion()
+  {
+    delete[] m_UnionFind;
+    m_UnionFind = ITK_NULLPTR;
+    m_Consecutive.clear();
   }
 
   void InsertSet(const LabelType label);
@@ -239,7 +263,8 @@ public:
 
   void LinkLabels(const LabelType lab1, const LabelType lab2);
 
-  SizeValueType CreateConsecutive();
+  void CreateConsecutive(const LabelType firstLabel, const SizeValueType numberOfLabels,
+                         SizeValueType firstObject);
 
   //////////////////
   bool CheckNeighbors(const OutputIndexType & A,
@@ -262,7 +287,7 @@ public:
   }
 
   typename std::vector< IdentifierType > m_NumberOfLabels;
-  typename std::vector< IdentifierType > m_FirstLineIdToJoin;
+  typename std::vector< IdentifierType > m_NumberOfRoots;
 
   typename Barrier::Pointer m_Barrier;
 
@@ -27,6 +27,7 @@
 #include "itkImageRegionIterator.h"
 #include "itkMaskImageFilter.h"
 #include "itkConnectedComponentAlgorithm.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -107,7 +108,8 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   const SizeValueType xsize = output->GetRequestedRegion().GetSize()[0];
   const SizeValueType linecount = pixelcount / xsize;
   m_LineMap.resize(linecount);
-  m_FirstLineIdToJoin.resize(nbOfThreads - 1);
+  m_NumberOfRoots.clear();
+  m_NumberOfRoots.resize(nbOfThreads, 0);
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
@@ -202,10 +204,16 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   // wait for the other threads to complete that part
   this->Wait();
 
-  // compute the total number of labels
+  // compute the total number of labels, and the first label of this
+  // thread so that the runs are labeled in raster order
   nbOfLabels = 0;
+  LabelType firstLabelForThread = 1;
   for ( ThreadIdType i = 0; i < nbOfThreads; i++ )
     {
+    if ( i == threadId )
+      {
+      firstLabelForThread = nbOfLabels + 1;
+      }
     nbOfLabels += m_NumberOfLabels[i];
     }
 
@@ -213,20 +221,22 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
     {
     // set up the union find structure
     InitUnion(nbOfLabels);
-    // insert all the labels into the structure -- an extra loop but
-    // saves complicating the ones that come later
-    typename LineMapType::iterator MapBegin = m_LineMap.begin();
-    typename LineMapType::iterator MapEnd = m_LineMap.end();
-    typename LineMapType::iterator LineIt = MapBegin;
-    SizeValueType label = 1;
-    for ( LineIt = MapBegin; LineIt != MapEnd; ++LineIt )
+    }
+
+  // wait for the other threads to complete that part
+  this->Wait();
+
+  // insert the labels of this thread into the structure -- an extra
+  // loop but saves complicating the ones that come later
+  const LineIdType lastLineIdForThread = firstLineIdForThread + linecountForThread;
+  LabelType        label = firstLabelForThread;
+  for ( SizeValueType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ++ThisIdx )
+    {
+    for ( typename lineEncoding::iterator cIt = m_LineMap[ThisIdx].begin(); cIt != m_LineMap[ThisIdx].end(); ++cIt )
       {
-      for ( typename lineEncoding::iterator cIt = LineIt->begin(); cIt != LineIt->end(); ++cIt )
-        {
-        cIt->label = label;
-        InsertSet(label);
-        label++;
-        }
+      cIt->label = label;
+      InsertSet(label);
+      label++;
       }
     }
 
@@ -234,26 +244,10 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   this->Wait();
 
   // now process the map and make appropriate entries in an equivalence
-  // table
-  // itkAssertInDebugAndIgnoreInReleaseMacro( linecount == m_LineMap.size() );
-  const SizeValueType pixelcount = output->GetRequestedRegion().GetNumberOfPixels();
-  const SizeValueType xsize = output->GetRequestedRegion().GetSize()[0];
-  const SizeValueType linecount = pixelcount / xsize;
-
-  SizeValueType lastLineIdForThread =  linecount;
-  SizeValueType nbOfLineIdToJoin = 0;
-  if ( threadId != nbOfThreads - 1 )
-    {
-    outputRegionForThreadSize = outputRegionForThread.GetSize();
-    outputRegionForThreadSize[splitAxis] -= 1;
-    lastLineIdForThread = firstLineIdForThread
-                          + RegionType(outputRegionIdx, outputRegionForThreadSize).GetNumberOfPixels() / xsizeForThread;
-    m_FirstLineIdToJoin[threadId] = lastLineIdForThread;
-    // found the number of line ids to join
-    nbOfLineIdToJoin =
-      RegionType( outputRegionIdx, outputRegionForThread.GetSize() ).GetNumberOfPixels() / xsizeForThread
-      - RegionType(outputRegionIdx, outputRegionForThreadSize).GetNumberOfPixels() / xsizeForThread;
-    }
+  // table. The first lines of the region are compared to the last lines
+  // of the previous thread: the links are atomic, so the seams are
+  // joined while the other threads are still working on their region.
+  const SizeValueType linecount = m_LineMap.size();
 
   for ( SizeValueType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ++ThisIdx )
     {
@@ -282,62 +276,42 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   // wait for the other threads to complete that part
   this->Wait();
 
-  while ( m_FirstLineIdToJoin.size() != 0 )
+  // all the sets are complete: count the roots of this thread
+  SizeValueType nbOfRoots = 0;
+  for ( LabelType lab = firstLabelForThread; lab < firstLabelForThread + m_NumberOfLabels[threadId]; ++lab )
     {
-    if ( threadId * 2 < static_cast<ThreadIdType>( m_FirstLineIdToJoin.size() ) )
+    if ( m_UnionFind[lab] == lab )
       {
-      for ( SizeValueType ThisIdx = m_FirstLineIdToJoin[threadId * 2];
-            ThisIdx < m_FirstLineIdToJoin[threadId * 2] + nbOfLineIdToJoin;
-            ++ThisIdx )
-        {
-        if ( !m_LineMap[ThisIdx].empty() )
-          {
-          for ( typename OffsetVec::const_iterator I = LineOffsets.begin();
-                I != LineOffsets.end(); ++I )
-            {
-            const OffsetValueType NeighIdx = ( *I ) + ThisIdx;
-            // check if the neighbor is in the map
-            if ( NeighIdx >= 0 && NeighIdx < static_cast<OffsetValueType>( linecount ) && !m_LineMap[NeighIdx].empty() )
-              {
-              // Now check whether they are really neighbors
-              const bool areNeighbors =
-                CheckNeighbors(m_LineMap[ThisIdx][0].where, m_LineMap[NeighIdx][0].where);
-              if ( areNeighbors )
-                {
-                // Compare the two lines
-                CompareLines(m_LineMap[ThisIdx], m_LineMap[NeighIdx]);
-                }
-              }
-            }
-          }
-        }
+      ++nbOfRoots;
       }
+    }
+  m_NumberOfRoots[threadId] = nbOfRoots;
 
-    this->Wait();
+  // wait for the other threads to complete that part
+  this->Wait();
 
-    if ( threadId == 0 )
+  // number the roots of this thread after the ones of the previous threads
+  SizeValueType objectCount = 0;
+  SizeValueType firstObjectForThread = 0;
+  for ( ThreadIdType i = 0; i < nbOfThreads; i++ )
+    {
+    if ( i == threadId )
       {
-      // remove the region already joined
-      typename std::vector< SizeValueType > newFirstLineIdToJoin;
-      for ( unsigned int i = 1; i < m_FirstLineIdToJoin.size(); i += 2 )
-        {
-        newFirstLineIdToJoin.push_back(m_FirstLineIdToJoin[i]);
-        }
-      m_FirstLineIdToJoin = newFirstLineIdToJoin;
+      firstObjectForThread = objectCount;
       }
-
-    this->Wait();
+    objectCount += m_NumberOfRoots[i];
     }
+  this->CreateConsecutive(firstLabelForThread, m_NumberOfLabels[threadId], firstObjectForThread);
 
   if ( threadId == 0 )
     {
-    m_ObjectCount = CreateConsecutive();
+    m_ObjectCount = objectCount;
     }
 
   this->Wait();
 
   // check for overflow exception here
-  if ( m_ObjectCount > static_cast< SizeValueType >(
+  if ( objectCount > static_cast< SizeValueType >(
          NumericTraits< OutputPixelType >::max() ) )
     {
     if ( threadId == 0 )
@@ -368,10 +342,6 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   ImageRegionIterator< OutputImageType > fend = oit;
   fend.GoToEnd();
 
-  lastLineIdForThread = firstLineIdForThread
-                        + RegionType( outputRegionIdx,
-                                      outputRegionForThread.GetSize() ).GetNumberOfPixels() / xsizeForThread;
-
   for ( SizeValueType ThisIdx = firstLineIdForThread; ThisIdx < lastLineIdForThread; ThisIdx++ )
     {
     // now fill the labelled sections
@@ -407,6 +377,8 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 ::AfterThreadedGenerateData()
 {
   m_NumberOfLabels.clear();
+  m_NumberOfRoots.clear();
+  this->ClearUnion();
   m_Barrier = ITK_NULLPTR;
   m_LineMap.clear();
   m_Input = ITK_NULLPTR;
@@ -594,29 +566,23 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
-SizeValueType
+void
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
-::CreateConsecutive()
+::CreateConsecutive(const LabelType firstLabel, const SizeValueType numberOfLabels,
+                    SizeValueType firstObject)
 {
-  m_Consecutive = UnionFindType( m_UnionFind.size() );
+  // the objects are numbered from 0, skipping the background value
+  const SizeValueType background = static_cast< SizeValueType >( m_BackgroundValue );
+  SizeValueType       object = firstObject;
 
-  SizeValueType CLab = 0;
-  SizeValueType count = 0;
-  for ( SizeValueType I = 1; I < m_UnionFind.size(); I++ )
+  for ( LabelType I = firstLabel; I < firstLabel + numberOfLabels; I++ )
     {
-    SizeValueType L = m_UnionFind[I];
-    if ( L == I )
+    if ( m_UnionFind[I] == I )
       {
-      if ( CLab == static_cast< SizeValueType >( m_BackgroundValue ) )
-        {
-        ++CLab;
-        }
-      m_Consecutive[L] = CLab;
-      ++CLab;
-      ++count;
+      m_Consecutive[I] = ( object < background ) ? object : object + 1;
+      ++object;
       }
     }
-  return count;
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
@@ -624,12 +590,26 @@ SizeValueType
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 ::LookupSet(const LabelType label)
 {
-  // recursively set the equivalence if necessary
-  if ( label != m_UnionFind[label] )
+  // The parent of a label is always a smaller label of the same set, so
+  // the path can be halved with a compare-and-swap while the other threads
+  // keep linking sets: a failed swap only means that the parent has
+  // already been moved closer to the root.
+  LabelType current = label;
+  for (;; )
     {
-    m_UnionFind[label] = this->LookupSet(m_UnionFind[label]);
+    LabelType parent = m_UnionFind[current];
+    if ( parent == current )
+      {
+      return current;
+      }
+    const LabelType grandParent = m_UnionFind[parent];
+    if ( grandParent == parent )
+      {
+      return parent;
+      }
+    m_UnionFind[current].compare_exchange_strong(parent, grandParent);
+    current = grandParent;
     }
-  return ( m_UnionFind[label] );
 }
 
 template< typename TInputImage, typename TOutputImage, typename TMaskImage >
@@ -637,16 +617,30 @@ void
 ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
 ::LinkLabels(const LabelType lab1, const LabelType lab2)
 {
-  SizeValueType E1 = this->LookupSet(lab1);
-  SizeValueType E2 = this->LookupSet(lab2);
+  LabelType E1 = lab1;
+  LabelType E2 = lab2;
 
-  if ( E1 < E2 )
+  for (;; )
     {
-    m_UnionFind[E2] = E1;
-    }
-  else
-    {
-    m_UnionFind[E1] = E2;
+    E1 = this->LookupSet(E1);
+    E2 = this->LookupSet(E2);
+    if ( E1 == E2 )
+      {
+      return;
+      }
+    // the smallest label stays the root, so the sets do not depend on the
+    // order in which the threads link them
+    if ( E1 > E2 )
+      {
+      std::swap(E1, E2);
+      }
+    // only succeeds if E2 is still a root; otherwise it has been linked by
+    // another thread in the meantime and the roots must be looked up again
+    LabelType expected = E2;
+    if ( m_UnionFind[E2].compare_exchange_strong(expected, E1) )
+      {
+      return;
+      }
     }
 }
 
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkConnectedComponentImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+// Check that the labels do not depend on the number of threads: the
+// components of a random image cross the boundaries of the regions
+// processed by the threads in many places.
+int itkConnectedComponentImageFilterThreadsTest( int, char* [] )
+{
+  typedef unsigned char                            InputPixelType;
+  typedef unsigned int                             OutputPixelType;
+  const unsigned int                               Dimension = 3;
+  typedef itk::Image< InputPixelType, Dimension >  InputImageType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+
+  typedef itk::ConnectedComponentImageFilter< InputImageType, OutputImageType > FilterType;
+
+  InputImageType::Pointer image = InputImageType::New();
+  InputImageType::SizeType size;
+  size[0] = 41;
+  size[1] = 37;
+  size[2] = 53;
+  image->SetRegions( size );
+  image->Allocate();
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize( 1234 );
+
+  bool passed = true;
+  for( unsigned int fullyConnected = 0; fullyConnected < 2; ++fullyConnected )
+    {
+    // keep the density below the percolation threshold of the
+    // connectivity, so that there are many objects
+    const double density = fullyConnected ? 0.08 : 0.25;
+    itk::ImageRegionIterator< InputImageType > it( image, image->GetLargestPossibleRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( generator->GetUniformVariate( 0.0, 1.0 ) < density ? 1 : 0 );
+      }
+    image->Modified();
+
+    FilterType::Pointer reference = FilterType::New();
+    reference->SetInput( image );
+    reference->SetFullyConnected( fullyConnected != 0 );
+    reference->SetNumberOfThreads( 1 );
+    reference->Update();
+
+    // the objects are labeled consecutively, in raster order
+    OutputPixelType nextLabel = 1;
+    itk::ImageRegionConstIterator< OutputImageType > rit( reference->GetOutput(),
+      reference->GetOutput()->GetLargestPossibleRegion() );
+    for( rit.GoToBegin(); !rit.IsAtEnd(); ++rit )
+      {
+      if( rit.Get() > nextLabel )
+        {
+        std::cerr << "Label " << rit.Get() << " found before label " << nextLabel << std::endl;
+        passed = false;
+        break;
+        }
+      if( rit.Get() == nextLabel )
+        {
+        ++nextLabel;
+        }
+      }
+    if( nextLabel - 1 != reference->GetObjectCount() )
+      {
+      std::cerr << "Found " << nextLabel - 1 << " labels but ObjectCount is "
+                << reference->GetObjectCount() << std::endl;
+      passed = false;
+      }
+    std::cout << "FullyConnected: " << fullyConnected
+              << " ObjectCount: " << reference->GetObjectCount() << std::endl;
+
+    const itk::ThreadIdType numberOfThreads[] = { 2, 3, 4, 7, 16, 53 };
+    for( unsigned int t = 0; t < sizeof( numberOfThreads ) / sizeof( numberOfThreads[0] ); ++t )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( image );
+      filter->SetFullyConnected( fullyConnected != 0 );
+      filter->SetNumberOfThreads( numberOfThreads[t] );
+      filter->Update();
+
+      if( filter->GetObjectCount() != reference->GetObjectCount() )
+        {
+        std::cerr << "ObjectCount with " << numberOfThreads[t] << " threads is "
+                  << filter->GetObjectCount() << " instead of " << reference->GetObjectCount() << std::endl;
+        passed = false;
+        }
+
+      itk::ImageRegionConstIterator< OutputImageType > oit( filter->GetOutput(),
+        filter->GetOutput()->GetLargestPossibleRegion() );
+      for( oit.GoToBegin(), rit.GoToBegin(); !oit.IsAtEnd(); ++oit, ++rit )
+        {
+        if( oit.Get() != rit.Get() )
+          {
+          std::cerr << "Different label at " << oit.GetIndex() << " with " << numberOfThreads[t]
+                    << " threads: " << oit.Get() << " instead of " << rit.Get() << std::endl;
+          passed = false;
+          break;
+          }
+        }
+      }
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
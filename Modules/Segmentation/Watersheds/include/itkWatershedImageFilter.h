@@ -138,6 +138,15 @@ namespace itk
  * Threshold and Level parameters are controlled through the class'
  * Get/SetThreshold() and Get/SetLevel() methods.
  *
+ * \par Multithreading
+ * The initial segmentation is computed by several threads when
+ * NumberOfTiles is larger than one.  The image is then split into tiles
+ * which are segmented concurrently as the chunks of a streamed segmentation,
+ * and which are joined with watershed::BoundaryResolver.  See
+ * watershed::Segmenter::SetNumberOfTiles() for the differences with the
+ * segmentation computed in one piece.  The merge tree and the relabeling are
+ * not multithreaded.
+ *
  * \par Notes on streaming the watershed segmentation code
  *  Coming soon... 12/06/01
  *
@@ -185,7 +194,8 @@ public:
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
-  /** Standard process object method.  This filter is not multithreaded. */
+  /** Standard process object method.  Only the initial segmentation is
+   * multithreaded, when NumberOfTiles is larger than one. */
   void GenerateData() ITK_OVERRIDE;
 
   /** Overloaded to link the input to this filter with the input of the
@@ -225,6 +235,13 @@ public:
 
   itkGetConstMacro(Level, double);
 
+  /** Set/Get the number of tiles the initial segmentation is split into, to
+   * compute it with several threads.  The default value is 1, which computes
+   * the initial segmentation in one piece with one thread. */
+  void SetNumberOfTiles(unsigned int);
+
+  itkGetConstMacro(NumberOfTiles, unsigned int);
+
   /** Get the basic segmentation from the Segmenter member filter. */
   typename watershed::Segmenter< InputImageType >::OutputImageType *
   GetBasicSegmentation()
@@ -280,6 +297,9 @@ private:
    *  level. */
   double m_Level;
 
+  /** The number of tiles processed concurrently by the segmenter. */
+  unsigned int m_NumberOfTiles;
+
   /** The component parts of the segmentation algorithm.  These objects
    * must save state between calls to GenerateData() so that the
    * computationally expensive execution of segment tree generation is
@@ -294,6 +314,7 @@ private:
 
   bool m_LevelChanged;
   bool m_ThresholdChanged;
+  bool m_NumberOfTilesChanged;
   bool m_InputChanged;
 
   TimeStamp m_GenerateDataMTime;
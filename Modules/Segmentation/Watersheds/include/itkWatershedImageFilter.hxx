@@ -70,9 +70,29 @@ WatershedImageFilter< TInputImage >
     }
 }
 
+template< typename TInputImage >
+void
+WatershedImageFilter< TInputImage >
+::SetNumberOfTiles(unsigned int val)
+{
+  if ( val < 1 )
+    {
+    val = 1;
+    }
+
+  if ( val != m_NumberOfTiles )
+    {
+    m_NumberOfTiles = val;
+    m_Segmenter->SetNumberOfTiles(m_NumberOfTiles);
+
+    m_NumberOfTilesChanged = true;
+    this->Modified();
+    }
+}
+
 template< typename TInputImage >
 WatershedImageFilter< TInputImage >
-::WatershedImageFilter():m_Threshold(0.0), m_Level(0.0)
+::WatershedImageFilter():m_Threshold(0.0), m_Level(0.0), m_NumberOfTiles(1)
 {
   // Set up the mini-pipeline for the first execution.
   m_Segmenter    = watershed::Segmenter< InputImageType >::New();
@@ -82,6 +102,7 @@ WatershedImageFilter< TInputImage >
   m_Segmenter->SetDoBoundaryAnalysis(false);
   m_Segmenter->SetSortEdgeLists(true);
   m_Segmenter->SetThreshold( this->GetThreshold() );
+  m_Segmenter->SetNumberOfTiles( this->GetNumberOfTiles() );
 
   m_TreeGenerator->SetInputSegmentTable( m_Segmenter->GetSegmentTable() );
   m_TreeGenerator->SetMerge(false);
@@ -103,6 +124,7 @@ WatershedImageFilter< TInputImage >
   m_InputChanged = true;
   m_LevelChanged = true;
   m_ThresholdChanged = true;
+  m_NumberOfTilesChanged = true;
 }
 
 template< typename TInputImage >
@@ -126,17 +148,27 @@ WatershedImageFilter< TInputImage >
   //
   //
 
+  // The tiles of the Segmenter are processed by the threads of this
+  // filter, so the Segmenter re-executes when the number of threads
+  // changes.
+  if ( m_Segmenter->GetNumberOfThreads() != this->GetNumberOfThreads() )
+    {
+    m_Segmenter->SetNumberOfThreads( this->GetNumberOfThreads() );
+    m_NumberOfTilesChanged = true;
+    }
+
   // If input changed, then Segmenter + Tree Generator + Relabeler need
   // to re-execute.  Plus, the HighestCalculatedFloodLevel must be reset
   // on the Tree Generator.
   //
-  // If the threshold changed, then Segmenter + Tree Generator +
-  // Relabeler need to re-execute.  Plus, the
+  // If the threshold or the number of tiles changed, then Segmenter +
+  // Tree Generator + Relabeler need to re-execute.  Plus, the
   // HighestCalculatedFloodLevel must be reset on the Tree Generator
   //
   if ( m_InputChanged
        || ( this->GetInput()->GetPipelineMTime() > m_GenerateDataMTime )
-       || m_ThresholdChanged )
+       || m_ThresholdChanged
+       || m_NumberOfTilesChanged )
     {
     m_Segmenter->PrepareOutputs();
     m_TreeGenerator->PrepareOutputs();
@@ -201,6 +233,7 @@ WatershedImageFilter< TInputImage >
   m_InputChanged = false;
   m_LevelChanged = false;
   m_ThresholdChanged = false;
+  m_NumberOfTilesChanged = false;
 }
 
 template< typename TInputImage >
@@ -211,6 +244,7 @@ WatershedImageFilter< TInputImage >
   Superclass::PrintSelf(os, indent);
   os << indent << "Threshold: " << m_Threshold << std::endl;
   os << indent << "Level: " << m_Level << std::endl;
+  os << indent << "NumberOfTiles: " << m_NumberOfTiles << std::endl;
 }
 } // end namespace itk
 
@@ -22,11 +22,15 @@
 #include "itkWatershedBoundary.h"
 #include "itkWatershedSegmentTable.h"
 #include "itkEquivalencyTable.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
 namespace watershed
 {
+template< typename TPixelType, unsigned int TDimension >
+class BoundaryResolver;
+
 /** \class Segmenter
  *
  * This filter implements the first step in the N-d watershed segmentation
@@ -80,6 +84,12 @@ namespace watershed
  * segments.  The assumption is that the ``shallow'' regions that this
  * thresholding eliminates are generally not of interest.
  *
+ * \par Multithreading
+ * When NumberOfTiles is larger than one and DoBoundaryAnalysis is false,
+ * the image is split along its last dimension into tiles which are
+ * segmented concurrently, as the chunks of a streamed segmentation, and
+ * which are joined with BoundaryResolver.  See SetNumberOfTiles().
+ *
  * \sa WatershedImageFilter
  * \ingroup WatershedSegmentation
  * \ingroup ITKWatersheds
@@ -171,7 +181,8 @@ public:
   void SetBoundary(BoundaryType *b)
   { this->ProcessObject::SetNthOutput(2, b); }
 
-  /** Standard non-threaded pipeline execution method. */
+  /** Standard pipeline execution method.  The image is segmented by
+   * several threads when NumberOfTiles is larger than one. */
   virtual void GenerateData() ITK_OVERRIDE;
 
   /** This method is necessary until the streaming mechanisms of the Itk
@@ -232,6 +243,25 @@ public:
   itkGetConstMacro(SortEdgeLists, bool);
   itkSetMacro(SortEdgeLists, bool);
 
+  /** Set/Get the number of tiles the image is split into along its last
+   * dimension when DoBoundaryAnalysis is false.  The tiles are segmented
+   * concurrently by the threads of the filter, with the boundary analysis of
+   * streamed chunks, and the segments which flow across the seams between
+   * the tiles are merged by a BoundaryResolver.  The adjacencies across the
+   * seams are then added to the segment table.  Only the tiles being
+   * segmented need a thresholded copy of their pixels, so using more tiles
+   * than threads reduces the memory used.
+   *
+   * The segments are the ones of the segmentation in one piece, with other
+   * labels, except in two cases.  A plateau which crosses a seam is kept as
+   * a segment of its own instead of being merged with its lowest neighbor,
+   * which the tree generator does at any positive flood level.  And a pixel
+   * of a seam with several directions of steepest descent may flow into
+   * another segment.  The default value is 1, which segments the image in
+   * one piece. */
+  itkSetClampMacro(NumberOfTiles, unsigned int, 1, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfTiles, unsigned int);
+
 protected:
   /** Structure storing information about image flat regions.
    * Flat regions are connected pixels of the same value.  */
@@ -271,6 +301,36 @@ protected:
 
   void operator=(const Self &) {}
 
+  /** Segments the requested region of the output image, as a chunk of the
+   * data set delimited by the LargestPossibleRegion.  The threshold level
+   * and the retaining wall are computed from the given extrema, which are
+   * the ones of the whole image when the image is split into tiles. */
+  void GenerateChunkData(InputImageType *input,
+                         InputPixelType minimum,
+                         InputPixelType maximum);
+
+  /** Segments the requested region of the output image in NumberOfTiles
+   * tiles, and joins the segmentations of the tiles. */
+  void GenerateTiledData(InputPixelType minimum, InputPixelType maximum);
+
+  /** The data shared by the threads segmenting the tiles. */
+  struct TileThreadStruct {
+    Pointer Filter;
+    InputImageTypePointer Input;
+    InputPixelType Minimum;
+    InputPixelType Maximum;
+    std::vector< Pointer > Tiles;
+    std::vector< ImageRegionType > TileRegions;
+    EquivalencyTable::Pointer EquivalentLabels;
+  };
+
+  /** Segments a tile and copies its labels to the output image. */
+  static ITK_THREAD_RETURN_TYPE SegmentTileThreaderCallback(void *arg);
+
+  /** Relabels the pixels of a tile in the output image with the
+   * equivalencies found across the seams. */
+  static ITK_THREAD_RETURN_TYPE RelabelTileThreaderCallback(void *arg);
+
   /** Constructs the connectivity list and the corresponding set of directional
    * Offset indices. */
   virtual void GenerateConnectivity();
@@ -372,6 +432,7 @@ private:
 
   bool            m_SortEdgeLists;
   bool            m_DoBoundaryAnalysis;
+  unsigned int    m_NumberOfTiles;
   double          m_Threshold;
   double          m_MaximumFloodLevel;
   IdentifierType  m_CurrentLabel;
@@ -19,8 +19,10 @@
 #define itkWatershedSegmenter_hxx
 
 #include "itkWatershedSegmenter.h"
+#include "itkWatershedBoundaryResolver.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkImageRegionIterator.h"
+#include <algorithm>
 #include <stack>
 #include <list>
 
@@ -50,8 +52,6 @@ void Segmenter< TInputImage >::GenerateData()
   // will be used in this algorithm.  Also re-initialize some temporary data
   // structures that may have been used in previous updates of this filter.
   //
-  unsigned int i;
-
   this->UpdateProgress(0.0);
   if ( m_DoBoundaryAnalysis == false )
     {
@@ -59,9 +59,40 @@ void Segmenter< TInputImage >::GenerateData()
     this->SetCurrentLabel(1);
     }
 
+  // Calculate the dynamic range of the input, from which the threshold
+  // level is computed.  Cap the maximum in the image so that we can always
+  // define a pixel value that is one greater than the maximum value in the
+  // image.
+  InputPixelType minimum, maximum;
+  Self::MinMax(this->GetInputImage(), this->GetOutputImage()->GetRequestedRegion(), minimum, maximum);
+  if ( NumericTraits< InputPixelType >::is_integer
+       && maximum == NumericTraits< InputPixelType >::max() )
+    {
+    maximum -= NumericTraits< InputPixelType >::OneValue();
+    }
+
+  if ( m_NumberOfTiles > 1 && m_DoBoundaryAnalysis == false
+       && this->GetOutputImage()->GetRequestedRegion() == this->GetLargestPossibleRegion() )
+    {
+    this->GenerateTiledData(minimum, maximum);
+    }
+  else
+    {
+    this->GenerateChunkData(this->GetInputImage(), minimum, maximum);
+    }
+
+  this->GetSegmentTable()->SetMaximumDepth(maximum - minimum);
+  this->UpdateProgress(1.0);
+}
+
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::GenerateChunkData(InputImageType *input, InputPixelType minimum, InputPixelType maximum)
+{
+  unsigned int i;
+
   flat_region_table_t flatRegions;
 
-  typename InputImageType::Pointer input   = this->GetInputImage();
   typename OutputImageType::Pointer output = this->GetOutputImage();
   typename BoundaryType::Pointer boundary  = this->GetBoundary();
 
@@ -162,8 +193,7 @@ void Segmenter< TInputImage >::GenerateData()
   thresholdImage->SetRequestedRegion(thresholdImageRegion);
   thresholdImage->Allocate();
 
-  // Now threshold the image. First we calculate the dynamic range of
-  // the input.  Then, the threshold operation clamps the lower
+  // Now threshold the image.  The threshold operation clamps the lower
   // intensity values at the prescribed threshold.  If the data is
   // integral, then any intensity at NumericTraits<>::max() is reduced
   // by one intensity value.  This allows the watershed algorithm to
@@ -172,19 +202,34 @@ void Segmenter< TInputImage >::GenerateData()
   // for local minima without requiring expensive boundary conditions.
   //
   //
-  InputPixelType minimum, maximum;
-  Self::MinMax(input, regionToProcess, minimum, maximum);
-  // cap the maximum in the image so that we can always define a pixel
-  // value that is one greater than the maximum value in the image.
-  if ( NumericTraits< InputPixelType >::is_integer
-       && maximum == NumericTraits< InputPixelType >::max() )
-    {
-    maximum -= NumericTraits< InputPixelType >::OneValue();
-    }
-  // threshold the image.
   Self::Threshold( thresholdImage, input, regionToProcess, regionToProcess,
                    static_cast< InputPixelType >( ( m_Threshold * ( maximum - minimum ) ) + minimum ) );
 
+  //
+  // The boundary flow analysis compares the pixels of the faces with their
+  // neighbors, so the padding along the true data set boundaries must
+  // already hold the value of the retaining wall.
+  //
+  if ( m_DoBoundaryAnalysis == true )
+    {
+    for ( i = 0; i < ImageDimension; ++i )
+      {
+      for ( unsigned int side = 0; side < 2; ++side )
+        {
+        if ( boundary->GetValid(i, side) == true ) { continue; }
+        typename ImageRegionType::IndexType pidx = thresholdImageRegion.GetIndex();
+        typename ImageRegionType::SizeType psz = thresholdImageRegion.GetSize();
+        if ( side == 1 )
+          {
+          pidx[i] += psz[i] - 1;
+          }
+        psz[i] = 1;
+        Self::SetInputImageValues( thresholdImage, ImageRegionType(pidx, psz),
+                                   maximum + NumericTraits< InputPixelType >::OneValue() );
+        }
+      }
+    }
+
   //
   // Redefine the regionToProcess in terms of the threshold image.  The region
   // to  process represents all the pixels contained within the 1 pixel padded
@@ -309,9 +354,281 @@ void Segmenter< TInputImage >::GenerateData()
   if ( m_SortEdgeLists == true )
           {  this->GetSegmentTable()->SortEdgeLists(); }
   this->UpdateProgress(0.8);
+}
 
-  this->GetSegmentTable()->SetMaximumDepth(maximum - minimum);
-  this->UpdateProgress(1.0);
+template< typename TInputImage >
+void Segmenter< TInputImage >
+::GenerateTiledData(InputPixelType minimum, InputPixelType maximum)
+{
+  typedef BoundaryResolver< InputPixelType, ImageDimension > BoundaryResolverType;
+
+  typename OutputImageType::Pointer output    = this->GetOutputImage();
+  typename SegmentTableType::Pointer segments = this->GetSegmentTable();
+  const ImageRegionType regionToProcess       = output->GetRequestedRegion();
+  const unsigned int    tileDimension         = ImageDimension - 1;
+
+  //
+  // The output image is padded like the threshold image of a single chunk.
+  //
+  ImageRegionType outputRegion = regionToProcess;
+  outputRegion.PadByRadius(1);
+  output->SetBufferedRegion(outputRegion);
+  output->Allocate();
+  Self::SetOutputImageValues(output, outputRegion, Self::NULL_LABEL);
+
+  //
+  // Split the region along its last dimension.  Each tile is segmented as a
+  // chunk which overlaps its neighbors by one pixel, and has at least two
+  // rows so that its seams do not share pixels.  Every label of a tile is
+  // then given to at least one of its pixels, so the tiles label their
+  // segments in disjoint ranges.
+  //
+  const SizeValueType length = regionToProcess.GetSize(tileDimension);
+  const unsigned int numberOfTiles = static_cast< unsigned int >(
+    std::max< SizeValueType >( 1, std::min< SizeValueType >( m_NumberOfTiles, length / 2 ) ) );
+
+  TileThreadStruct str;
+  str.Filter = this;
+  str.Input = this->GetInputImage();
+  str.Minimum = minimum;
+  str.Maximum = maximum;
+  IdentifierType label = 1;
+  for ( unsigned int t = 0; t < numberOfTiles; ++t )
+    {
+    const IndexValueType begin = regionToProcess.GetIndex(tileDimension)
+                                 + static_cast< IndexValueType >( ( t * length ) / numberOfTiles );
+    const IndexValueType end = regionToProcess.GetIndex(tileDimension)
+                               + static_cast< IndexValueType >( ( ( t + 1 ) * length ) / numberOfTiles );
+    ImageRegionType tileRegion = regionToProcess;
+    tileRegion.SetIndex(tileDimension, begin);
+    tileRegion.SetSize(tileDimension, end - begin);
+    str.TileRegions.push_back(tileRegion);
+
+    ImageRegionType chunkRegion = tileRegion;
+    if ( t > 0 )
+      {
+      chunkRegion.SetIndex(tileDimension, begin - 1);
+      chunkRegion.SetSize( tileDimension, chunkRegion.GetSize(tileDimension) + 1 );
+      }
+    if ( t < numberOfTiles - 1 )
+      {
+      chunkRegion.SetSize( tileDimension, chunkRegion.GetSize(tileDimension) + 1 );
+      }
+
+    Pointer tile = Self::New();
+    tile->SetLargestPossibleRegion(regionToProcess);
+    tile->SetThreshold(m_Threshold);
+    tile->SetDoBoundaryAnalysis(true);
+    tile->SetSortEdgeLists(false);
+    tile->SetCurrentLabel(label);
+    tile->GetOutputImage()->SetRequestedRegion(chunkRegion);
+    str.Tiles.push_back(tile);
+    label += tileRegion.GetNumberOfPixels();
+    }
+
+  //
+  // Segment the tiles.  When there are more tiles than threads, the
+  // threads which are done take the tiles left by the others.  A local
+  // threader is used so that the MultiThreader of the filter keeps its
+  // number of threads.
+  //
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( std::min< ThreadIdType >( this->GetNumberOfThreads(), numberOfTiles ) );
+  threader->SetSingleMethod(Self::SegmentTileThreaderCallback, &str);
+  threader->SetNumberOfWorkUnits(numberOfTiles);
+  threader->SingleMethodExecute();
+  this->UpdateProgress(0.6);
+
+  //
+  // Merge the labels of the segments which flow across the seams.  The
+  // boundaries are disconnected from the tiles so that the pipelines of the
+  // resolvers do not execute the tiles again.
+  //
+  std::vector< BoundaryTypePointer > boundaries;
+  for ( unsigned int t = 0; t < numberOfTiles; ++t )
+    {
+    boundaries.push_back( str.Tiles[t]->GetBoundary() );
+    boundaries[t]->DisconnectPipeline();
+    }
+  str.EquivalentLabels = EquivalencyTable::New();
+  for ( unsigned int t = 0; t + 1 < numberOfTiles; ++t )
+    {
+    typename BoundaryResolverType::Pointer resolver = BoundaryResolverType::New();
+    resolver->SetBoundaryA(boundaries[t]);
+    resolver->SetBoundaryB(boundaries[t + 1]);
+    resolver->SetFace(tileDimension);
+    resolver->Update();
+    EquivalencyTable::Pointer seamLabels = resolver->GetEquivalencyTable();
+    for ( EquivalencyTable::Iterator it = seamLabels->Begin(); it != seamLabels->End(); ++it )
+      {
+      str.EquivalentLabels->Add( ( *it ).first, ( *it ).second );
+      }
+    }
+  str.EquivalentLabels->Flatten();
+  boundaries.clear();
+
+  threader->SetSingleMethod(Self::RelabelTileThreaderCallback, &str);
+  threader->SetNumberOfWorkUnits(numberOfTiles);
+  threader->SingleMethodExecute();
+  this->UpdateProgress(0.7);
+
+  //
+  // Gather the segment tables of the tiles, joining the segments which have
+  // been merged.
+  //
+  segments->Clear();
+  typename SegmentTableType::segment_t newSegment;
+  for ( unsigned int t = 0; t < numberOfTiles; ++t )
+    {
+    typename SegmentTableType::Pointer tileSegments = str.Tiles[t]->GetSegmentTable();
+    for ( typename SegmentTableType::Iterator it = tileSegments->Begin(); it != tileSegments->End(); ++it )
+      {
+      const IdentifierType segmentLabel = str.EquivalentLabels->Lookup( ( *it ).first );
+      typename SegmentTableType::segment_t *segment = segments->Lookup(segmentLabel);
+      if ( segment == ITK_NULLPTR )
+        {
+        newSegment.min = ( *it ).second.min;
+        segments->Add(segmentLabel, newSegment);
+        segment = segments->Lookup(segmentLabel);
+        }
+      else if ( ( *it ).second.min < segment->min )
+        {
+        segment->min = ( *it ).second.min;
+        }
+      segment->edge_list.splice( segment->edge_list.end(), ( *it ).second.edge_list );
+      }
+    tileSegments->Clear();
+    }
+
+  //
+  // Find the edges between the segments across the seams.  As in
+  // UpdateSegmentTable(), the value of an edge is the maximum of the two
+  // adjacent pixel values, after thresholding.
+  //
+  const InputPixelType threshold =
+    static_cast< InputPixelType >( ( m_Threshold * ( maximum - minimum ) ) + minimum );
+  edge_table_hash_t seamEdges;
+  for ( unsigned int t = 0; t + 1 < numberOfTiles; ++t )
+    {
+    ImageRegionType faceA = str.TileRegions[t];
+    faceA.SetIndex( tileDimension, faceA.GetIndex(tileDimension) + faceA.GetSize(tileDimension) - 1 );
+    faceA.SetSize(tileDimension, 1);
+    ImageRegionType faceB = faceA;
+    faceB.SetIndex( tileDimension, faceA.GetIndex(tileDimension) + 1 );
+
+    ImageRegionConstIterator< InputImageType >  valueA(str.Input, faceA);
+    ImageRegionConstIterator< InputImageType >  valueB(str.Input, faceB);
+    ImageRegionConstIterator< OutputImageType > labelA(output, faceA);
+    ImageRegionConstIterator< OutputImageType > labelB(output, faceB);
+    for ( ; !labelA.IsAtEnd(); ++valueA, ++valueB, ++labelA, ++labelB )
+      {
+      const IdentifierType a = labelA.Get();
+      const IdentifierType b = labelB.Get();
+      if ( a == b ) { continue; }
+
+      InputPixelType height = std::max( valueA.Get(), valueB.Get() );
+      if ( height < threshold )
+        {
+        height = threshold;
+        }
+      else if ( NumericTraits< InputPixelType >::is_integer
+                && height == NumericTraits< InputPixelType >::max() )
+        {
+        height -= NumericTraits< InputPixelType >::OneValue();
+        }
+
+      edge_table_t & edgesA = seamEdges[a];
+      typename edge_table_t::iterator edge = edgesA.find(b);
+      if ( edge == edgesA.end() ) { edgesA.insert( typename edge_table_t::value_type(b, height) ); }
+      else if ( height < ( *edge ).second ) { ( *edge ).second = height; }
+
+      edge_table_t & edgesB = seamEdges[b];
+      edge = edgesB.find(a);
+      if ( edge == edgesB.end() ) { edgesB.insert( typename edge_table_t::value_type(a, height) ); }
+      else if ( height < ( *edge ).second ) { ( *edge ).second = height; }
+      }
+    }
+
+  //
+  // Relabel the edges of the segments, which may point to merged segments,
+  // and add the edges across the seams.  Only the lowest edge between two
+  // segments is kept.
+  //
+  edge_table_t edges;
+  for ( typename SegmentTableType::Iterator it = segments->Begin(); it != segments->End(); ++it )
+    {
+    edges.clear();
+    typename edge_table_hash_t::iterator seam = seamEdges.find( ( *it ).first );
+    if ( seam != seamEdges.end() )
+      {
+      edges.swap( ( *seam ).second );
+      }
+    typename SegmentTableType::edge_list_t & edgeList = ( *it ).second.edge_list;
+    for ( typename SegmentTableType::edge_list_t::const_iterator e = edgeList.begin(); e != edgeList.end(); ++e )
+      {
+      const IdentifierType neighbor = str.EquivalentLabels->Lookup(e->label);
+      if ( neighbor == ( *it ).first ) { continue; }
+      typename edge_table_t::iterator edge = edges.find(neighbor);
+      if ( edge == edges.end() ) { edges.insert( typename edge_table_t::value_type(neighbor, e->height) ); }
+      else if ( e->height < ( *edge ).second ) { ( *edge ).second = e->height; }
+      }
+    edgeList.clear();
+    for ( typename edge_table_t::const_iterator edge = edges.begin(); edge != edges.end(); ++edge )
+      {
+      edgeList.push_back( typename SegmentTableType::edge_pair_t( ( *edge ).first, ( *edge ).second ) );
+      }
+    }
+  this->UpdateProgress(0.8);
+
+  if ( m_SortEdgeLists == true )
+          {  segments->SortEdgeLists(); }
+
+  m_CurrentLabel = label;
+  this->ReleaseInputs();
+}
+
+template< typename TInputImage >
+ITK_THREAD_RETURN_TYPE
+Segmenter< TInputImage >
+::SegmentTileThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  TileThreadStruct *str = static_cast< TileThreadStruct * >( info->UserData );
+  const ThreadIdType t = info->WorkUnitID;
+  if ( t >= str->Tiles.size() )
+    {
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  // The input is not an input of the tile, so the tile never releases it.
+  Self *tile = str->Tiles[t];
+  tile->GenerateChunkData(str->Input, str->Minimum, str->Maximum);
+
+  // Copy the labels of the tile without its overlap, and free them.
+  ImageRegionConstIterator< OutputImageType > tileIt(tile->GetOutputImage(), str->TileRegions[t]);
+  ImageRegionIterator< OutputImageType > outputIt(str->Filter->GetOutputImage(), str->TileRegions[t]);
+  for ( ; !tileIt.IsAtEnd(); ++tileIt, ++outputIt )
+    {
+    outputIt.Set( tileIt.Get() );
+    }
+  tile->GetOutputImage()->ReleaseData();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename TInputImage >
+ITK_THREAD_RETURN_TYPE
+Segmenter< TInputImage >
+::RelabelTileThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  TileThreadStruct *str = static_cast< TileThreadStruct * >( info->UserData );
+  const ThreadIdType t = info->WorkUnitID;
+  if ( t < str->Tiles.size() )
+    {
+    Self::RelabelImage(str->Filter->GetOutputImage(), str->TileRegions[t], str->EquivalentLabels);
+    }
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template< typename TInputImage >
@@ -469,16 +786,19 @@ void Segmenter< TInputImage >
       searchIt.GoToBegin();
       labelIt.GoToBegin();
 
+      // The connectivity lists the neighbors from the lowest index to the
+      // highest one, so the neighbor below the face along dimension d is
+      // the (ImageDimension - 1 - d)th and the one above it is the
+      // (ImageDimension + d)th.
       if ( ( idx ).second == 0 )
         {
         // Low face
-        cPos = m_Connectivity.index[( idx ).first];
+        cPos = m_Connectivity.index[( ImageDimension - 1 ) - ( idx ).first];
         }
       else
         {
         // High face
-        cPos = m_Connectivity.index[( ImageDimension - 1 )
-                                    + ( ImageDimension - ( idx ).first )];
+        cPos = m_Connectivity.index[ImageDimension + ( idx ).first];
         }
 
       while ( !searchIt.IsAtEnd() )
@@ -630,13 +950,16 @@ void Segmenter< TInputImage >
   //
   // Algorithms assume this order to the connectivity.
   //
+  // The strides only depend on the radius of the neighborhood, so the
+  // connectivity does not need the input image.
+  //
   typename ConstNeighborhoodIterator< InputImageType >::RadiusType rad;
   for ( i = 0; i < ImageDimension; ++i )
     {
     rad[i] = 1;
     }
-  ConstNeighborhoodIterator< InputImageType > it( rad, this->GetInputImage(),
-                                                  this->GetInputImage()->GetRequestedRegion() );
+  Neighborhood< InputPixelType, ImageDimension > it;
+  it.SetRadius(rad);
   nSize   = it.Size();
   nCenter = nSize >> 1;
 
@@ -1353,6 +1676,7 @@ Segmenter< TInputImage >
   m_CurrentLabel = 1;
   m_DoBoundaryAnalysis = false;
   m_SortEdgeLists = true;
+  m_NumberOfTiles = 1;
   m_Connectivity.direction = ITK_NULLPTR;
   m_Connectivity.index = ITK_NULLPTR;
   typename OutputImageType::Pointer img =
@@ -1381,6 +1705,7 @@ Segmenter< TInputImage >
   Superclass::PrintSelf(os, indent);
   os << indent << "SortEdgeLists: " << m_SortEdgeLists << std::endl;
   os << indent << "DoBoundaryAnalysis: " << m_DoBoundaryAnalysis << std::endl;
+  os << indent << "NumberOfTiles: " << m_NumberOfTiles << std::endl;
   os << indent << "Threshold: " << m_Threshold << std::endl;
   os << indent << "MaximumFloodLevel: " << m_MaximumFloodLevel << std::endl;
   os << indent << "CurrentLabel: " << m_CurrentLabel << std::endl;
@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkWatershedImageFilter.h"
+#include "itkGradientMagnitudeRecursiveGaussianImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include <algorithm>
+#include <map>
+
+namespace
+{
+
+/** Returns the number of pixels which are not in the segment of labels
+ * that overlaps the most their segment of reference. */
+template< typename TLabelImage >
+itk::SizeValueType CountDifferences( const TLabelImage *labels, const TLabelImage *reference,
+                                     unsigned int & numberOfSegments )
+{
+  typedef typename TLabelImage::PixelType LabelType;
+  typedef std::map< LabelType, itk::SizeValueType > CountMapType;
+  std::map< LabelType, CountMapType > overlaps;
+  itk::ImageRegionConstIterator< TLabelImage > it( labels, reference->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< TLabelImage > rit( reference, reference->GetLargestPossibleRegion() );
+  for( ; !rit.IsAtEnd(); ++it, ++rit )
+    {
+    ++overlaps[rit.Get()][it.Get()];
+    }
+
+  itk::SizeValueType differences = 0;
+  for( typename std::map< LabelType, CountMapType >::const_iterator o = overlaps.begin(); o != overlaps.end(); ++o )
+    {
+    itk::SizeValueType total = 0;
+    itk::SizeValueType largest = 0;
+    for( typename CountMapType::const_iterator c = o->second.begin(); c != o->second.end(); ++c )
+      {
+      total += c->second;
+      largest = std::max( largest, c->second );
+      }
+    differences += total - largest;
+    }
+  numberOfSegments = static_cast< unsigned int >( overlaps.size() );
+  return differences;
+}
+
+}
+
+/** Segments the gradient magnitude of the input image in one piece, then
+ * in tiles with several numbers of threads, and checks that the segments
+ * match at several flood levels. The tiles may change the segments
+ * of the plateaus and of the pixels with several directions of steepest
+ * descent on the seams (see watershed::Segmenter::SetNumberOfTiles()), so
+ * a small fraction of the pixels may differ. */
+int itkWatershedImageFilterTest2( int argc, char * argv[] )
+{
+  if( argc < 3 )
+    {
+    std::cerr << "Usage: " << argv[0] << " inputImage threshold [maximumFractionOfDifferences]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Image< float, 2 >                                     ImageType;
+  typedef itk::ImageFileReader< ImageType >                          ReaderType;
+  typedef itk::GradientMagnitudeRecursiveGaussianImageFilter< ImageType, ImageType > GradientType;
+  typedef itk::WatershedImageFilter< ImageType >                     FilterType;
+  typedef FilterType::OutputImageType                                LabelImageType;
+  typedef itk::watershed::Segmenter< ImageType >                     SegmenterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  GradientType::Pointer gradient = GradientType::New();
+  gradient->SetInput( reader->GetOutput() );
+  gradient->SetSigma( 1.0 );
+
+  try
+    {
+    gradient->Update();
+    }
+  catch( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double threshold = atof( argv[2] );
+  double maximumFractionOfDifferences = 0.0;
+  if( argc > 3 )
+    {
+    maximumFractionOfDifferences = atof( argv[3] );
+    }
+  const double numberOfPixels = gradient->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels();
+  const double levels[] = { 0.0, 0.05, 0.2 };
+  const unsigned int numberOfTiles[] = { 2, 3, 7 };
+  const itk::ThreadIdType numbersOfThreads[] = { 1, 2, 4 };
+
+  bool passed = true;
+  for( unsigned int l = 0; l < 3; ++l )
+    {
+    FilterType::Pointer reference = FilterType::New();
+    reference->SetInput( gradient->GetOutput() );
+    reference->SetThreshold( threshold );
+    reference->SetLevel( levels[l] );
+    reference->SetNumberOfThreads( 1 );
+    reference->Update();
+
+    for( unsigned int t = 0; t < 3; ++t )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( gradient->GetOutput() );
+      filter->SetThreshold( threshold );
+      filter->SetLevel( levels[l] );
+      filter->SetNumberOfTiles( numberOfTiles[t] );
+      filter->SetNumberOfThreads( numbersOfThreads[t] );
+      filter->Update();
+
+      // a segment may be split or merged with another one
+      unsigned int numberOfSegments = 0;
+      unsigned int numberOfTiledSegments = 0;
+      const itk::SizeValueType differences = std::max(
+        CountDifferences< LabelImageType >( filter->GetOutput(), reference->GetOutput(), numberOfSegments ),
+        CountDifferences< LabelImageType >( reference->GetOutput(), filter->GetOutput(), numberOfTiledSegments ) );
+      std::cout << "level " << levels[l] << ": " << numberOfSegments << " segments, " << numberOfTiledSegments
+                << " in tiles, " << differences
+                << " pixels differ with " << numberOfTiles[t] << " tiles and " << numbersOfThreads[t]
+                << " threads" << std::endl;
+      if( differences > maximumFractionOfDifferences * numberOfPixels )
+        {
+        std::cerr << "level " << levels[l] << ": the segments differ with " << numberOfTiles[t]
+                  << " tiles" << std::endl;
+        passed = false;
+        }
+      }
+    }
+
+  // the tiles are segmented without changing the MultiThreader of the filter
+  SegmenterType::Pointer segmenter = SegmenterType::New();
+  segmenter->SetInputImage( gradient->GetOutput() );
+  segmenter->SetThreshold( threshold );
+  segmenter->SetNumberOfTiles( 7 );
+  segmenter->SetNumberOfThreads( 3 );
+  segmenter->GetMultiThreader()->SetNumberOfThreads( 5 );
+  segmenter->Update();
+  if( segmenter->GetMultiThreader()->GetNumberOfThreads() != 5 )
+    {
+    std::cerr << "The segmenter changed the number of threads of its MultiThreader to "
+              << segmenter->GetMultiThreader()->GetNumberOfThreads() << std::endl;
+    passed = false;
+    }
+
+  if( !passed )
+    {
+    std::cerr << "Test failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
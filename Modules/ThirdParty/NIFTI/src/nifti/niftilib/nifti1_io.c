@@ -6951,6 +6951,10 @@ int nifti_read_subregion_image( nifti_image * nim,
 
   /* get the file open */
   fp = nifti_image_load_prep( nim );
+  if(fp == NULL)
+    {
+    return -1;
+    }
   /* the current offset is just past the nifti header, save
    * location so that SEEK_SET can be used below
    */
@@ -7027,8 +7031,9 @@ int nifti_read_subregion_image( nifti_image * nim,
                 if(g_opts.debug > 1)
                   {
                   fprintf(stderr,"read of %d bytes failed\n",read_amount);
-                  return -1;
                   }
+                znzclose(fp);
+                return -1;
                 }
               bytes += nread;
               readptr += read_amount;
@@ -7039,6 +7044,7 @@ int nifti_read_subregion_image( nifti_image * nim,
       }
     }
   }
+  znzclose(fp);
   return bytes;
 }
 